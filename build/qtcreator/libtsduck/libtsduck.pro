@@ -70,6 +70,18 @@ HEADERS += \
     ../../../src/libtsduck/tsCTS4Template.h \
     ../../../src/libtsduck/tsCableDeliverySystemDescriptor.h \
     ../../../src/libtsduck/tsCerrReport.h \
+    ../../../src/libtsduck/tsPacketPacer.h \
+    ../../../src/libtsduck/tsRTPFECDecoder.h \
+    ../../../src/libtsduck/tsRTPFECEncoder.h \
+    ../../../src/libtsduck/tsRTPReorderBuffer.h \
+    ../../../src/libtsduck/tsRTPReorderHandlerInterface.h \
+    ../../../src/libtsduck/tsScramblingBitslice.h \
+    ../../../src/libtsduck/tsScramblingBitsliceTemplate.h \
+    ../../../src/libtsduck/tsSharedMemoryRing.h \
+    ../../../src/libtsduck/tsTSFileInputArgs.h \
+    ../../../src/libtsduck/tsTSFileOutputSegmented.h \
+    ../../../src/libtsduck/tsTSPacketHandlerInterface.h \
+    ../../../src/libtsduck/tsTableViews.h \
     ../../../src/libtsduck/tsUChar.h \
     ../../../src/libtsduck/tsCipherChaining.h \
     ../../../src/libtsduck/tsComponentDescriptor.h \
@@ -241,6 +253,7 @@ HEADERS += \
     ../../../src/libtsduck/tsTSFileOutput.h \
     ../../../src/libtsduck/tsTSFileOutputResync.h \
     ../../../src/libtsduck/tsTSPacket.h \
+    ../../../src/libtsduck/tsTSPacketMetadata.h \
     ../../../src/libtsduck/tsTSScanner.h \
     ../../../src/libtsduck/tsTableHandlerInterface.h \
     ../../../src/libtsduck/tsTables.h \
@@ -333,6 +346,7 @@ SOURCES += \
     ../../../src/libtsduck/tsBAT.cpp \
     ../../../src/libtsduck/tsBCD.cpp \
     ../../../src/libtsduck/tsBinaryTable.cpp \
+    ../../../src/libtsduck/tsBlockCipher.cpp \
     ../../../src/libtsduck/tsBouquetNameDescriptor.cpp \
     ../../../src/libtsduck/tsByteBlock.cpp \
     ../../../src/libtsduck/tsCADescriptor.cpp \
@@ -345,6 +359,16 @@ SOURCES += \
     ../../../src/libtsduck/tsCRC32.cpp \
     ../../../src/libtsduck/tsCableDeliverySystemDescriptor.cpp \
     ../../../src/libtsduck/tsCerrReport.cpp \
+    ../../../src/libtsduck/tsPacketPacer.cpp \
+    ../../../src/libtsduck/tsRTPFECDecoder.cpp \
+    ../../../src/libtsduck/tsRTPFECEncoder.cpp \
+    ../../../src/libtsduck/tsRTPReorderBuffer.cpp \
+    ../../../src/libtsduck/tsScramblingBitslice.cpp \
+    ../../../src/libtsduck/tsScramblingBitsliceAVX2.cpp \
+    ../../../src/libtsduck/tsSharedMemoryRing.cpp \
+    ../../../src/libtsduck/tsTSFileInputArgs.cpp \
+    ../../../src/libtsduck/tsTSFileOutputSegmented.cpp \
+    ../../../src/libtsduck/tsTableViews.cpp \
     ../../../src/libtsduck/tsUChar.cpp \
     ../../../src/libtsduck/tsCipherChaining.cpp \
     ../../../src/libtsduck/tsComponentDescriptor.cpp \
@@ -479,6 +503,7 @@ SOURCES += \
     ../../../src/libtsduck/tsTSFileOutput.cpp \
     ../../../src/libtsduck/tsTSFileOutputResync.cpp \
     ../../../src/libtsduck/tsTSPacket.cpp \
+    ../../../src/libtsduck/tsTSPacketMetadata.cpp \
     ../../../src/libtsduck/tsTSScanner.cpp \
     ../../../src/libtsduck/tsTablesDisplay.cpp \
     ../../../src/libtsduck/tsTablesDisplayArgs.cpp \
@@ -76,12 +76,14 @@ SUBDIRS += \
     tsplugin_rmorphan \
     tsplugin_scrambler \
     tsplugin_sdt \
+    tsplugin_shm \
     tsplugin_sifilter \
     tsplugin_skip \
     tsplugin_slice \
     tsplugin_stuffanalyze \
     tsplugin_svremove \
     tsplugin_svrename \
+    tsplugin_synthetic \
     tsplugin_t2mi \
     tsplugin_tables \
     tsplugin_time \
@@ -99,6 +101,7 @@ SUBDIRS += \
     tsfixcc \
     tsftrunc \
     tslsdvb \
+    tsnamescomp \
     tsp \
     tspacketize \
     tspsi \
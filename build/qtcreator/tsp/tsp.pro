@@ -6,6 +6,7 @@ SOURCES += \
     ../../../src/tstools/tspInputExecutor.cpp \
     ../../../src/tstools/tspJointTermination.cpp \
     ../../../src/tstools/tspListProcessors.cpp \
+    ../../../src/tstools/tspMetrics.cpp \
     ../../../src/tstools/tspOptions.cpp \
     ../../../src/tstools/tspOutputExecutor.cpp \
     ../../../src/tstools/tspPluginExecutor.cpp \
@@ -15,6 +16,7 @@ HEADERS += \
     ../../../src/tstools/tspInputExecutor.h \
     ../../../src/tstools/tspJointTermination.h \
     ../../../src/tstools/tspListProcessors.h \
+    ../../../src/tstools/tspMetrics.h \
     ../../../src/tstools/tspOptions.h \
     ../../../src/tstools/tspOutputExecutor.h \
     ../../../src/tstools/tspPluginExecutor.h \
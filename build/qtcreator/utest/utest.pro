@@ -8,6 +8,7 @@ QMAKE_POST_LINK += cp ../tsplugin_null/tsplugin_null.so . $$escape_expand(\\n\\t
 QMAKE_POST_LINK += cp ../tsplugin_skip/tsplugin_skip.so . $$escape_expand(\\n\\t)
 
 HEADERS += \
+    ../../../src/utest/utestBenchmark.h \
     ../../../src/utest/utestCppUnitMain.h \
     ../../../src/utest/utestCppUnitTest.h \
     ../../../src/utest/utestCppUnitThread.h
@@ -16,10 +17,12 @@ SOURCES += \
     ../../../src/utest/utest.cpp \
     ../../../src/utest/utestAlgorithm.cpp \
     ../../../src/utest/utestArgs.cpp \
+    ../../../src/utest/utestBenchmark.cpp \
     ../../../src/utest/utestBitStream.cpp \
     ../../../src/utest/utestByteBlock.cpp \
     ../../../src/utest/utestCppUnitMain.cpp \
     ../../../src/utest/utestCppUnitTest.cpp \
+    ../../../src/utest/utestCRC32.cpp \
     ../../../src/utest/utestCrypto.cpp \
     ../../../src/utest/utestDemux.cpp \
     ../../../src/utest/utestDirectShow.cpp \
@@ -31,28 +34,36 @@ SOURCES += \
     ../../../src/utest/utestGrid.cpp \
     ../../../src/utest/utestGuard.cpp \
     ../../../src/utest/utestInterrupt.cpp \
+    ../../../src/utest/utestMemoryUtils.cpp \
     ../../../src/utest/utestMessageQueue.cpp \
     ../../../src/utest/utestMonotonic.cpp \
     ../../../src/utest/utestMutex.cpp \
     ../../../src/utest/utestNames.cpp \
     ../../../src/utest/utestNetworking.cpp \
     ../../../src/utest/utestPacketizer.cpp \
+    ../../../src/utest/utestPESDemux.cpp \
     ../../../src/utest/utestPlatform.cpp \
     ../../../src/utest/utestPlugin.cpp \
+    ../../../src/utest/utestRTPFEC.cpp \
+    ../../../src/utest/utestRTPReorderBuffer.cpp \
     ../../../src/utest/utestReport.cpp \
     ../../../src/utest/utestResidentBuffer.cpp \
     ../../../src/utest/utestRing.cpp \
     ../../../src/utest/utestSafePtr.cpp \
     ../../../src/utest/utestScrambling.cpp \
     ../../../src/utest/utestSection.cpp \
+    ../../../src/utest/utestSharedMemoryRing.cpp \
     ../../../src/utest/utestSingleton.cpp \
     ../../../src/utest/utestStaticInstance.cpp \
     ../../../src/utest/utestSystemRandomGenerator.cpp \
     ../../../src/utest/utestSysUtils.cpp \
     ../../../src/utest/utestTablesFactory.cpp \
+    ../../../src/utest/utestTableViews.cpp \
     ../../../src/utest/utestThread.cpp \
     ../../../src/utest/utestThreadAttributes.cpp \
     ../../../src/utest/utestTime.cpp \
+    ../../../src/utest/utestTSAnalyzer.cpp \
+    ../../../src/utest/utestTSFile.cpp \
     ../../../src/utest/utestTSPacket.cpp \
     ../../../src/utest/utestUString.cpp \
     ../../../src/utest/utestVariable.cpp \
@@ -0,0 +1,143 @@
+#!/bin/bash
+#
+# Benchmark of tsp on a set of typical processing chains.
+# Each chain reads a synthetic transport stream from the input plugin
+# "synthetic" and drops all packets at the end. The throughput of each
+# chain is reported by "tsp --benchmark".
+#
+# A second measurement reports the throughput as a function of the length
+# of the chain: 1 to N instances of the same light plugin ("continuity"),
+# with the global mutex (default) and with option --lock-free. This is
+# the overhead of the packet handoff between plugin threads.
+#
+# Usage: tsp-benchmark.sh [options]
+#
+#   --packets count   : Number of packets per chain (default: 5,000,000).
+#   --max-length n    : Maximum chain length in the second measurement
+#                       (default: 8, zero means no chain length measurement).
+#   --repeat count    : Number of runs per chain, the best one is kept
+#                       to reduce the noise (default: 3).
+#   --reference file  : Compare with a previous result file and fail when
+#                       a chain is slower than the reference.
+#   --tolerance value : Accepted slow down in percent (default: 10).
+#   --output file     : Save the results (packets/s per chain) in a file
+#                       which can be used later as reference.
+#   --tsp path        : Path of the tsp executable. Default: the one which
+#                       is built in this source tree, if any, or the one in
+#                       the PATH.
+#
+
+SCRIPT=$(basename $0 .sh)
+SCRIPTDIR=$(cd $(dirname $0); pwd)
+info() { echo >&2 "$SCRIPT: $*"; }
+error() { echo >&2 "$SCRIPT: $*"; exit 1; }
+
+# Directories.
+ROOTDIR=$(cd $SCRIPTDIR/..; pwd)
+OBJDIR=release-$(uname -m)
+
+# Default values.
+PACKETS=5000000
+MAXLENGTH=8
+REPEAT=3
+REFERENCE=
+TOLERANCE=10
+OUTPUT=
+TSP=
+
+# Decode command line options.
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --packets) [[ $# -gt 1 ]] || error "missing value for $1"; PACKETS="$2"; shift ;;
+        --max-length) [[ $# -gt 1 ]] || error "missing value for $1"; MAXLENGTH="$2"; shift ;;
+        --repeat) [[ $# -gt 1 ]] || error "missing value for $1"; REPEAT="$2"; shift ;;
+        --reference) [[ $# -gt 1 ]] || error "missing value for $1"; REFERENCE="$2"; shift ;;
+        --tolerance) [[ $# -gt 1 ]] || error "missing value for $1"; TOLERANCE="$2"; shift ;;
+        --output) [[ $# -gt 1 ]] || error "missing value for $1"; OUTPUT="$2"; shift ;;
+        --tsp) [[ $# -gt 1 ]] || error "missing value for $1"; TSP="$2"; shift ;;
+        *) error "invalid option $1, see header of $0" ;;
+    esac
+    shift
+done
+
+# Locate tsp and the plugins. Prefer the binaries in the source tree.
+if [[ -z "$TSP" && -x "$ROOTDIR/src/tstools/$OBJDIR/tsp" ]]; then
+    TSP="$ROOTDIR/src/tstools/$OBJDIR/tsp"
+    export TSPLUGINS_PATH="$ROOTDIR/src/tsplugins/$OBJDIR:$ROOTDIR/src/libtsduck/$OBJDIR"
+    export LD_LIBRARY_PATH="$ROOTDIR/src/libtsduck/$OBJDIR${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+fi
+[[ -z "$TSP" ]] && TSP=$(which tsp 2>/dev/null)
+[[ -x "$TSP" ]] || error "tsp not found"
+[[ -z "$REFERENCE" || -f "$REFERENCE" ]] || error "$REFERENCE not found"
+
+# List of chains: name, then packet processors. All chains use the same input and output.
+INPUT="-I synthetic $PACKETS --services 4 --streams 3 --null-percent 5"
+OUTPUT_PLUGIN="-O drop"
+CHAINS=(
+    "empty|"
+    "continuity|-P continuity"
+    "filter|-P filter --pid 0x1000 --negate"
+    "remap|-P remap 0x1001=0x1101"
+    "svremove|-P svremove 2"
+    "analyze|-P analyze --output-file /dev/null"
+    "pes|-P pes"
+    "history|-P history --output-file /dev/null"
+    "chain|-P continuity -P remap 0x1001=0x1101 -P filter --pid 0x1000 --negate -P analyze --output-file /dev/null"
+)
+
+RESULTS=$(mktemp)
+trap "rm -f $RESULTS" EXIT
+STATUS=0
+
+# Run one chain: name, tsp options and plugins, print details (yes/no).
+# The best throughput of all runs is kept and compared with the reference.
+bench() {
+    local name="$1" args="$2" details="$3" rate=0 run runlog runrate log line ref
+    for ((run = 0; run < REPEAT; run++)); do
+        runlog=$("$TSP" --benchmark $args 2>&1) || error "tsp failed on chain $name: $runlog"
+        runrate=$(sed <<<"$runlog" -e '/tsp: benchmark: .* packets\/s/!d' -e 's/^.* ms, //' -e 's/ packets\/s.*$//' -e 's/,//g')
+        [[ -n "$runrate" ]] || error "no benchmark result for chain $name"
+        if [[ $runrate -gt $rate ]]; then
+            rate=$runrate
+            log=$runlog
+        fi
+    done
+    echo "$name $rate" >>$RESULTS
+    line=$(printf "%-20s %12d packets/s" $name $rate)
+    if [[ -n "$REFERENCE" ]]; then
+        ref=$(awk -v n=$name '$1 == n {print $2}' "$REFERENCE")
+        if [[ -n "$ref" ]]; then
+            line="$line, reference: $ref, $(( (rate - ref) * 100 / ref ))%"
+            if [[ $(( rate * 100 )) -lt $(( ref * (100 - TOLERANCE) )) ]]; then
+                line="$line, REGRESSION"
+                STATUS=1
+            fi
+        fi
+    fi
+    echo "$line"
+    if [[ $details == yes ]]; then
+        echo "                     latency: $(sed <<<"$log" -e '/latency percentiles:/!d' -e 's/^.*percentiles: //')"
+        sed <<<"$log" -e '/tsp: benchmark: plugin/!d' -e 's/^.*tsp: benchmark: /                     /'
+    fi
+    BENCH_RATE=$rate
+}
+
+for chain in "${CHAINS[@]}"; do
+    bench "${chain%%|*}" "$INPUT ${chain#*|} $OUTPUT_PLUGIN" yes
+done
+
+# Throughput as a function of the chain length, with and without lock-free handoff.
+[[ $MAXLENGTH -gt 0 ]] && echo "CPU's: $(nproc 2>/dev/null || echo unknown)"
+for ((length = 1; length <= MAXLENGTH; length++)); do
+    plugins=
+    for ((i = 0; i < length; i++)); do
+        plugins="$plugins -P continuity"
+    done
+    bench "length-$length" "$INPUT $plugins $OUTPUT_PLUGIN" no
+    mutex=$BENCH_RATE
+    bench "length-$length-lock-free" "--lock-free $INPUT $plugins $OUTPUT_PLUGIN" no
+    echo "                     lock-free / mutex: $(( BENCH_RATE * 100 / mutex ))%"
+done
+
+[[ -n "$OUTPUT" ]] && cp $RESULTS "$OUTPUT"
+exit $STATUS
@@ -0,0 +1,105 @@
+#!/bin/bash
+#
+# Test of tsp branches (option -B).
+#
+# 1. Correctness: two branches modify the same input packets differently.
+#    The output of each branch must be identical to the output of the same
+#    chain of plugins without branch, in global mutex and lock-free modes.
+#
+# 2. Scaling: the same number of analyze plugins is run in one chain and
+#    in separate branches. The throughput is reported for each count. On a
+#    multi-core system, the branches should scale better than the chain.
+#
+# Usage: tsp-branches-test.sh [options]
+#
+#   --packets count : Number of packets in each run (default: 1,000,000).
+#   --max-count n   : Maximum number of analyze plugins in the scaling
+#                     measurement (default: 4).
+#   --tsp path      : Path of the tsp executable. Default: the one which is
+#                     built in this source tree, if any, or the one in the
+#                     PATH.
+#
+# The exit status is non-zero if the correctness test fails.
+#
+
+SCRIPT=$(basename $0 .sh)
+SCRIPTDIR=$(cd $(dirname $0); pwd)
+info() { echo >&2 "$SCRIPT: $*"; }
+error() { echo >&2 "$SCRIPT: $*"; exit 1; }
+
+# Directories.
+ROOTDIR=$(cd $SCRIPTDIR/..; pwd)
+OBJDIR=release-$(uname -m)
+
+# Default values.
+PACKETS=1000000
+MAXCOUNT=4
+TSP=
+
+# Decode command line options.
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --packets) [[ $# -gt 1 ]] || error "missing value for $1"; PACKETS="$2"; shift ;;
+        --max-count) [[ $# -gt 1 ]] || error "missing value for $1"; MAXCOUNT="$2"; shift ;;
+        --tsp) [[ $# -gt 1 ]] || error "missing value for $1"; TSP="$2"; shift ;;
+        *) error "invalid option $1, see header of $0" ;;
+    esac
+    shift
+done
+
+# Locate tsp and the plugins. Prefer the binaries in the source tree.
+if [[ -z "$TSP" && -x "$ROOTDIR/src/tstools/$OBJDIR/tsp" ]]; then
+    TSP="$ROOTDIR/src/tstools/$OBJDIR/tsp"
+    export TSPLUGINS_PATH="$ROOTDIR/src/tsplugins/$OBJDIR:$ROOTDIR/src/libtsduck/$OBJDIR"
+    export LD_LIBRARY_PATH="$ROOTDIR/src/libtsduck/$OBJDIR${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+fi
+[[ -z "$TSP" ]] && TSP=$(which tsp 2>/dev/null)
+[[ -x "$TSP" ]] || error "tsp not found"
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+STATUS=0
+
+INPUT="-I synthetic $PACKETS --services 4 --streams 3 --null-percent 5"
+
+# The main chain remaps a PID, in place. The branch nullifies a PID, then drops all
+# null packets: the second processor must see the nullified packets as null packets.
+CHAIN1="-P remap 0x1001=0x1101"
+CHAIN2="-P filter --pid 0x1002 --negate --stuffing -P filter --pid 0x1FFF --negate"
+
+"$TSP" $INPUT $CHAIN1 -O file $TMPDIR/ref1.ts || error "tsp failed"
+"$TSP" $INPUT $CHAIN2 -O file $TMPDIR/ref2.ts || error "tsp failed"
+
+for mode in "" "--lock-free"; do
+    rm -f $TMPDIR/out1.ts $TMPDIR/out2.ts
+    "$TSP" $mode $INPUT $CHAIN1 -O file $TMPDIR/out1.ts -B $CHAIN2 -O file $TMPDIR/out2.ts || error "tsp failed"
+    for i in 1 2; do
+        if cmp -s $TMPDIR/ref$i.ts $TMPDIR/out$i.ts; then
+            echo "branch $i ${mode:-(global mutex)}: OK"
+        else
+            echo "branch $i ${mode:-(global mutex)}: output differs from the same chain without branch"
+            STATUS=1
+        fi
+    done
+done
+
+# Get the throughput in packets/s of a tsp command.
+rate() { "$TSP" --benchmark "$@" 2>&1 | sed -e '/tsp: benchmark: .* packets\/s/!d' -e 's/^.* ms, //' -e 's/ packets\/s.*$//' -e 's/,//g'; }
+
+ANALYZE="-P analyze --output-file /dev/null"
+echo "CPU's: $(nproc 2>/dev/null || echo unknown)"
+for ((count = 1; count <= MAXCOUNT; count++)); do
+    chain=
+    branches=
+    for ((i = 0; i < count; i++)); do
+        chain="$chain $ANALYZE"
+        [[ $i -gt 0 ]] && branches="$branches -B"
+        branches="$branches $ANALYZE -O drop"
+    done
+    rchain=$(rate $INPUT $chain -O drop)
+    rbranch=$(rate $INPUT $branches)
+    [[ -n "$rchain" && -n "$rbranch" ]] || error "no benchmark result"
+    printf "%d analyze: chain %12d packets/s, branches %12d packets/s, ratio %d%%\n" $count $rchain $rbranch $(( rbranch * 100 / rchain ))
+done
+
+exit $STATUS
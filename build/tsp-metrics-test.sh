@@ -0,0 +1,96 @@
+#!/bin/bash
+#
+# Test of the tsp metrics server (option --metrics-port).
+#
+# 1. The metrics are fetched during a run. All metrics must be present and
+#    the number of packets in and out of the plugins must be consistent.
+#
+# 2. A client connects to the metrics server and never sends its request.
+#    tsp must still terminate at the end of the stream.
+#
+# Usage: tsp-metrics-test.sh [options]
+#
+#   --port number : TCP port of the metrics server (default: 12380).
+#   --tsp path    : Path of the tsp executable. Default: the one which is
+#                   built in this source tree, if any, or the one in the
+#                   PATH.
+#
+# The exit status is non-zero if a test fails.
+#
+
+SCRIPT=$(basename $0 .sh)
+SCRIPTDIR=$(cd $(dirname $0); pwd)
+info() { echo >&2 "$SCRIPT: $*"; }
+error() { echo >&2 "$SCRIPT: $*"; exit 1; }
+
+# Directories.
+ROOTDIR=$(cd $SCRIPTDIR/..; pwd)
+OBJDIR=release-$(uname -m)
+
+# Default values.
+PORT=12380
+TSP=
+
+# Decode command line options.
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --port) [[ $# -gt 1 ]] || error "missing value for $1"; PORT="$2"; shift ;;
+        --tsp) [[ $# -gt 1 ]] || error "missing value for $1"; TSP="$2"; shift ;;
+        *) error "invalid option $1, see header of $0" ;;
+    esac
+    shift
+done
+
+# Locate tsp and the plugins. Prefer the binaries in the source tree.
+if [[ -z "$TSP" && -x "$ROOTDIR/src/tstools/$OBJDIR/tsp" ]]; then
+    TSP="$ROOTDIR/src/tstools/$OBJDIR/tsp"
+    export TSPLUGINS_PATH="$ROOTDIR/src/tsplugins/$OBJDIR:$ROOTDIR/src/libtsduck/$OBJDIR"
+    export LD_LIBRARY_PATH="$ROOTDIR/src/libtsduck/$OBJDIR${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+fi
+[[ -z "$TSP" ]] && TSP=$(which tsp 2>/dev/null)
+[[ -x "$TSP" ]] || error "tsp not found"
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+STATUS=0
+
+check() { if eval "$2"; then echo "$1: OK"; else echo "$1: FAILED"; STATUS=1; fi; }
+
+# A stream of about 3 seconds: 10,000 packets at 5 Mb/s.
+TSPCMD=("$TSP" --metrics-port 127.0.0.1:$PORT -I synthetic 10000 -P regulate --bitrate 5000000 -P count -O drop)
+
+# Fetch the metrics with an HTTP request, using bash network redirections.
+fetch() {
+    exec 3<>/dev/tcp/127.0.0.1/$PORT || return 1
+    printf 'GET /metrics HTTP/1.0\r\n\r\n' >&3
+    cat <&3
+    exec 3<&-
+}
+
+# 1. Metrics during a run.
+"${TSPCMD[@]}" 2>/dev/null &
+PID=$!
+sleep 2
+fetch >$TMPDIR/metrics.txt
+wait $PID
+
+for name in packets_total packets_in_total busy_seconds_total call_seconds_total wait_seconds_total window_count; do
+    check "metric tsp_plugin_$name" "grep -q '^tsp_plugin_$name{' $TMPDIR/metrics.txt"
+done
+value() { sed -e "/^tsp_plugin_$1{index=\"$2\"/!d" -e 's/^.* //' $TMPDIR/metrics.txt; }
+OUT_IN=$(value packets_in_total 3)
+COUNT_OUT=$(value packets_total 2)
+check "packets in output plugin ($OUT_IN) <= packets out of previous plugin ($COUNT_OUT)" "[[ -n '$OUT_IN' && '$OUT_IN' -gt 0 && '$OUT_IN' -le '$COUNT_OUT' ]]"
+
+# 2. Idle client at the end of the stream.
+START=$(date +%s)
+"${TSPCMD[@]}" 2>/dev/null &
+PID=$!
+sleep 1
+exec 4<>/dev/tcp/127.0.0.1/$PORT
+wait $PID
+END=$(date +%s)
+exec 4<&-
+check "termination with an idle client ($((END - START)) seconds)" "[[ $((END - START)) -le 5 ]]"
+
+exit $STATUS
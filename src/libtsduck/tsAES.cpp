@@ -14,8 +14,23 @@
 //----------------------------------------------------------------------------
 
 #include "tsAES.h"
+#include "tsSysUtils.h"
+#include "tsMemoryUtils.h"
 TSDUCK_SOURCE;
 
+// The AES-NI implementation is compiled on Intel x86 processors only, with
+// function-specific target options on GCC and LLVM. It is used only when
+// the processor supports it.
+#if (defined(TS_I386) || defined(TS_X86_64)) && (defined(TS_MSC) || defined(TS_GCC))
+    #define TS_AES_NI 1
+    #include <immintrin.h>
+    #if defined(TS_GCC)
+        #define TS_AESNI_TARGET __attribute__((target("aes,sse2")))
+    #else
+        #define TS_AESNI_TARGET
+    #endif
+#endif
+
 #define BYTE(x,n) (((x) >> (8 * (n))) & 255)
 
 namespace {
@@ -1012,6 +1027,84 @@ namespace {
 }
 
 
+//----------------------------------------------------------------------------
+// AES-NI implementation.
+//----------------------------------------------------------------------------
+
+#if defined(TS_AES_NI)
+namespace {
+
+    // Number of blocks which are processed in parallel. The latency of the
+    // AESENC/AESDEC instructions is much higher than their throughput, so
+    // processing independent blocks in an interleaved way fills the pipeline.
+    const size_t AESNI_PIPELINE = 8;
+
+    // Process N blocks in parallel. The round keys are in byte order.
+    // DECRYPT selects AESDEC with the equivalent inverse cipher key schedule.
+    template <bool DECRYPT, size_t N>
+    TS_AESNI_TARGET inline void ProcessNI(const __m128i* rk, int Nr, const uint8_t* in, uint8_t* out)
+    {
+        __m128i b[N];
+        for (size_t i = 0; i < N; ++i) {
+            b[i] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)), rk[0]);
+        }
+        for (int r = 1; r < Nr; ++r) {
+            for (size_t i = 0; i < N; ++i) {
+                b[i] = DECRYPT ? _mm_aesdec_si128(b[i], rk[r]) : _mm_aesenc_si128(b[i], rk[r]);
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            b[i] = DECRYPT ? _mm_aesdeclast_si128(b[i], rk[Nr]) : _mm_aesenclast_si128(b[i], rk[Nr]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), b[i]);
+        }
+    }
+
+    // Process any number of blocks.
+    template <bool DECRYPT>
+    TS_AESNI_TARGET void BlocksNI(const uint8_t* keys, int Nr, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i rk[ts::AES::MAX_ROUNDS + 1];
+        for (size_t r = 0; r <= ts::AES::MAX_ROUNDS; ++r) {
+            rk[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 16 * r));
+        }
+        while (count >= AESNI_PIPELINE) {
+            ProcessNI<DECRYPT, AESNI_PIPELINE>(rk, Nr, in, out);
+            in += 16 * AESNI_PIPELINE;
+            out += 16 * AESNI_PIPELINE;
+            count -= AESNI_PIPELINE;
+        }
+        if (count >= 4) {
+            ProcessNI<DECRYPT, 4>(rk, Nr, in, out);
+            in += 16 * 4;
+            out += 16 * 4;
+            count -= 4;
+        }
+        while (count > 0) {
+            ProcessNI<DECRYPT, 1>(rk, Nr, in, out);
+            in += 16;
+            out += 16;
+            count--;
+        }
+    }
+}
+#endif
+
+
+//----------------------------------------------------------------------------
+// Check if AES hardware acceleration is available on this system.
+//----------------------------------------------------------------------------
+
+bool ts::AES::IsAccelerated()
+{
+#if defined(TS_AES_NI)
+    static const bool accel = CPUHasFeature(CPU_AESNI);
+    return accel;
+#else
+    return false;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Schedule a new key. If rounds is zero, the default is used.
 // Return true on success, false on error.
@@ -1165,6 +1258,13 @@ bool ts::AES::setKey(const void* key_, size_t key_length, size_t rounds)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+    // Round keys in byte order for hardware acceleration. The decryption
+    // keys are already the equivalent inverse cipher schedule.
+    for (i = 0; i < 4 * (_Nr + 1); i++) {
+        PutUInt32(_eKb + 4 * i, _eK[i]);
+        PutUInt32(_dKb + 4 * i, _dK[i]);
+    }
+
     return true;
 }
 
@@ -1185,6 +1285,17 @@ bool ts::AES::encrypt(const void* plain, size_t plain_length,
     const uint8_t* pt = reinterpret_cast<const uint8_t*> (plain);
     uint8_t* ct = reinterpret_cast<uint8_t*> (cipher);
 
+    if (cipher_length != 0) {
+        *cipher_length = BLOCK_SIZE;
+    }
+
+#if defined(TS_AES_NI)
+    if (_accel) {
+        BlocksNI<false>(_eKb, _Nr, pt, ct, 1);
+        return true;
+    }
+#endif
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1289,10 +1400,6 @@ bool ts::AES::encrypt(const void* plain, size_t plain_length,
         rk[3];
     PutUInt32 (ct+12, s3);
 
-    if (cipher_length != 0) {
-        *cipher_length = BLOCK_SIZE;
-    }
-
     return true;
 }
 
@@ -1313,6 +1420,17 @@ bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
 
+    if (plain_length != 0) {
+        *plain_length = BLOCK_SIZE;
+    }
+
+#if defined(TS_AES_NI)
+    if (_accel) {
+        BlocksNI<true>(_dKb, _Nr, ct, pt, 1);
+        return true;
+    }
+#endif
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1418,11 +1536,35 @@ bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
         rk[3];
     PutUInt32 (pt+12, s3);
 
-    if (plain_length != 0) {
-        *plain_length = BLOCK_SIZE;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Multi-block encryption and decryption in ECB mode.
+// Use the AES-NI pipeline when available.
+//----------------------------------------------------------------------------
+
+bool ts::AES::encryptBlocks(const void* plain, void* cipher, size_t count)
+{
+#if defined(TS_AES_NI)
+    if (_accel) {
+        BlocksNI<false>(_eKb, _Nr, reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), count);
+        return true;
     }
+#endif
+    return BlockCipher::encryptBlocks(plain, cipher, count);
+}
 
-    return true;
+bool ts::AES::decryptBlocks(const void* cipher, void* plain, size_t count)
+{
+#if defined(TS_AES_NI)
+    if (_accel) {
+        BlocksNI<true>(_dKb, _Nr, reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), count);
+        return true;
+    }
+#endif
+    return BlockCipher::decryptBlocks(cipher, plain, count);
 }
 
 
@@ -1431,6 +1573,9 @@ bool ts::AES::decrypt(const void* cipher, size_t cipher_length,
 //----------------------------------------------------------------------------
 
 ts::AES::AES() :
-    _Nr(0)
+    _Nr(0),
+    _accel(IsAccelerated())
 {
+    TS_ZERO(_eKb);
+    TS_ZERO(_dKb);
 }
@@ -67,10 +67,37 @@ namespace ts {
         virtual bool decrypt(const void* cipher, size_t cipher_length,
                              void* plain, size_t plain_maxsize,
                              size_t* plain_length = 0) override;
+        virtual bool encryptBlocks(const void* plain, void* cipher, size_t count) override;
+        virtual bool decryptBlocks(const void* cipher, void* plain, size_t count) override;
+
+        //!
+        //! Check if AES hardware acceleration is available on this system.
+        //! Currently, this is the AES-NI instruction set on Intel x86 processors.
+        //! @return True if the AES instructions of the CPU are supported.
+        //!
+        static bool IsAccelerated();
+
+        //!
+        //! Enable or disable the usage of hardware acceleration.
+        //! By default, hardware acceleration is used when available.
+        //! Disabling it is mostly useful for testing and benchmarking the software implementation.
+        //! @param [in] on If true, use hardware acceleration when available.
+        //! If false, always use the software implementation.
+        //!
+        void setAcceleration(bool on) {_accel = on && IsAccelerated();}
+
+        //!
+        //! Check if hardware acceleration is currently used by this object.
+        //! @return True if hardware acceleration is currently used.
+        //!
+        bool getAcceleration() const {return _accel;}
 
     private:
         int      _Nr;     //!< Number of rounds
         uint32_t _eK[60]; //!< Scheduled encryption keys
         uint32_t _dK[60]; //!< Scheduled decryption keys
+        bool     _accel;  //!< Use hardware acceleration.
+        uint8_t  _eKb[BLOCK_SIZE * (MAX_ROUNDS + 1)];  //!< Encryption round keys in byte order, for hardware acceleration.
+        uint8_t  _dKb[BLOCK_SIZE * (MAX_ROUNDS + 1)];  //!< Decryption round keys in byte order, for hardware acceleration.
     };
 }
@@ -59,6 +59,8 @@ ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_,
     _demux(this),
     _ecm_streams(),
     _scrambled_streams(),
+    _batch_mode(false),
+    _batches(),
     _mutex(),
     _ecm_to_do(),
     _stop_thread(false)
@@ -103,6 +105,7 @@ bool ts::AbstractDescrambler::startDescrambler(bool           synchronous,
     _abort = false;
     _ecm_streams.clear();
     _scrambled_streams.clear();
+    _batches.clear();
 
     // Initialize the section demux.
     // If the service is known by name, filter the SDT, otherwise filter the PAT.
@@ -613,10 +616,12 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
             pecm->new_cw_odd = false;
         }
         else if (scv == SC_EVEN_KEY) {
+            decryptBatch(pecm->key_even);
             pecm->key_even.init(pecm->cw_even, _cw_mode);
             pecm->new_cw_even = false;
         }
         else {
+            decryptBatch(pecm->key_odd);
             pecm->key_odd.init(pecm->cw_odd, _cw_mode);
             pecm->new_cw_odd = false;
         }
@@ -639,8 +644,15 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
         ::memcpy(pl, tmp, pl_size);  // Flawfinder: ignore: memcpy()
     }
     else {
+        // In batch mode, the payload is descrambled later, with all other payloads using the same key.
         Scrambling& scr(scv == SC_EVEN_KEY ? pecm->key_even : pecm->key_odd);
-        scr.decrypt(pl, pl_size);
+        if (_batch_mode) {
+            const Scrambling::DataBlock block = {pl, pl_size};
+            _batches[&scr].push_back(block);
+        }
+        else {
+            scr.decrypt(pl, pl_size);
+        }
 
         // Trace CW change in PIDs
         if (scv != ss.last_scv) {
@@ -659,3 +671,44 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::AbstractDescrambler::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // The packets are processed one by one but the DVB-CSA payloads are accumulated
+    // per key and descrambled together, before a key is changed and at the end of
+    // the batch, before the packets are passed to the next plugin.
+    _batch_mode = !_aes128_dvs042;
+    const size_t result = ProcessorPlugin::processPacketBatch(pkts, mdata, count, status, flush, bitrate_changed);
+    decryptAllBatches();
+    _batch_mode = false;
+    return result;
+}
+
+
+//----------------------------------------------------------------------------
+// Descramble accumulated DVB-CSA payloads.
+//----------------------------------------------------------------------------
+
+void ts::AbstractDescrambler::decryptBatch(Scrambling& key)
+{
+    DataBlockBatchMap::iterator it = _batches.find(&key);
+    if (it != _batches.end() && !it->second.empty()) {
+        key.decrypt(&it->second[0], it->second.size());
+        it->second.clear();
+    }
+}
+
+void ts::AbstractDescrambler::decryptAllBatches()
+{
+    for (DataBlockBatchMap::iterator it = _batches.begin(); it != _batches.end(); ++it) {
+        if (!it->second.empty()) {
+            it->first->decrypt(&it->second[0], it->second.size());
+            it->second.clear();
+        }
+    }
+}
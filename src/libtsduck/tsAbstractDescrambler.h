@@ -76,6 +76,7 @@ namespace ts {
         virtual bool stop() override;
         virtual BitRate getBitrate() override {return 0;}
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     protected:
         //!
@@ -156,6 +157,7 @@ namespace ts {
         typedef SafePtr <ECMStream, NullMutex> ECMStreamPtr;
         typedef std::map <PID, ScrambledStream> ScrambledStreamMap;
         typedef std::map <PID, ECMStreamPtr> ECMStreamMap;
+        typedef std::map <Scrambling*, std::vector<Scrambling::DataBlock>> DataBlockBatchMap;
 
         // Abstract descrambler private data
         Scrambling::EntropyMode _cw_mode;
@@ -169,6 +171,8 @@ namespace ts {
         SectionDemux       _demux;             // Section demux
         ECMStreamMap       _ecm_streams;       // ECM streams, indexed by PID
         ScrambledStreamMap _scrambled_streams; // ECM streams, indexed by PID
+        bool               _batch_mode;        // Accumulate DVB-CSA payloads, see processPacketBatch()
+        DataBlockBatchMap  _batches;           // Payloads to descramble, indexed by DVB-CSA key
         Mutex              _mutex;             // Exclusive access to protected areas
         Condition          _ecm_to_do;         // Notify thread to process ECM
         // -- start of protected area --
@@ -220,6 +224,10 @@ namespace ts {
             }
         };
 
+        // Descramble all accumulated payloads for one DVB-CSA key or for all keys.
+        void decryptBatch(Scrambling&);
+        void decryptAllBatches();
+
         // Get the ECM stream for a PID, create it if non existent
         ECMStreamPtr getOrCreateECMStream (PID);
 
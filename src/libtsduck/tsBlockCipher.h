@@ -136,6 +136,34 @@ namespace ts {
                              void* plain, size_t plain_maxsize,
                              size_t* plain_length = 0) = 0;
 
+        //!
+        //! Encrypt several consecutive blocks of data, each block independently (ECB).
+        //!
+        //! This is the multi-block entry point which is used by chaining modes when
+        //! the blocks can be processed independently. The default implementation
+        //! encrypts one block at a time. Subclasses may override it to process
+        //! several blocks in parallel (pipelined hardware instructions for instance).
+        //!
+        //! @param [in] plain Address of plain text, @a count blocks of blockSize() bytes.
+        //! @param [out] cipher Address of buffer for cipher text, @a count blocks of blockSize() bytes.
+        //! Can be the same as @a plain (in-place encryption) but must not partially overlap.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocks(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several consecutive blocks of data, each block independently (ECB).
+        //!
+        //! @param [in] cipher Address of cipher text, @a count blocks of blockSize() bytes.
+        //! @param [out] plain Address of buffer for plain text, @a count blocks of blockSize() bytes.
+        //! Can be the same as @a cipher (in-place decryption) but must not partially overlap.
+        //! @param [in] count Number of blocks.
+        //! @return True on success, false on error.
+        //! @see encryptBlocks()
+        //!
+        virtual bool decryptBlocks(const void* cipher, void* plain, size_t count);
+
         //!
         //! Virtual destructor.
         //!
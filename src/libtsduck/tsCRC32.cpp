@@ -32,8 +32,22 @@
 //----------------------------------------------------------------------------
 
 #include "tsCRC32.h"
+#include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+// The PCLMUL implementation is compiled on Intel x86 processors only, with
+// function-specific target options on GCC and LLVM. It is used only when
+// the processor supports it.
+#if (defined(TS_I386) || defined(TS_X86_64)) && (defined(TS_MSC) || defined(TS_GCC))
+    #define TS_CRC32_PCLMUL 1
+    #include <immintrin.h>
+    #if defined(TS_GCC)
+        #define TS_PCLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+    #else
+        #define TS_PCLMUL_TARGET
+    #endif
+#endif
+
 
 // The FCS-32 generator polynomial:
 //     x**0 + x**1 + x**2 + x**4 + x**5 +
@@ -109,13 +123,180 @@ namespace {
     };
 }
 
+
+namespace {
+
+    // Additional tables for slicing-by-8 and constants for carry-less multiplication.
+    // Built once, on first use. Table 0 is fcstab_32. In table k, entry b is the CRC
+    // register after processing the byte b followed by k zero bytes.
+    class CRC32Tables
+    {
+    public:
+        uint32_t slice[8][256];
+        uint64_t x128;     // x^128 mod P
+        uint64_t x192;     // x^192 mod P
+        uint64_t x512;     // x^512 mod P
+        uint64_t x576;     // x^576 mod P
+        bool     pclmul;   // The PCLMUL algorithm can be used.
+
+        CRC32Tables() :
+            x128(XPowMod(128)),
+            x192(XPowMod(192)),
+            x512(XPowMod(512)),
+            x576(XPowMod(576)),
+            pclmul(false)
+        {
+            for (size_t b = 0; b < 256; ++b) {
+                slice[0][b] = fcstab_32[b];
+            }
+            for (size_t k = 1; k < 8; ++k) {
+                for (size_t b = 0; b < 256; ++b) {
+                    const uint32_t prev = slice[k-1][b];
+                    slice[k][b] = (prev << 8) ^ fcstab_32[prev >> 24];
+                }
+            }
+#if defined(TS_CRC32_PCLMUL)
+            pclmul = ts::CPUHasFeature(ts::CPU_PCLMUL) && ts::CPUHasFeature(ts::CPU_SSSE3);
+#endif
+        }
+
+        static const CRC32Tables& Instance()
+        {
+            static const CRC32Tables instance;
+            return instance;
+        }
+
+    private:
+        // Compute x^n modulo the generator polynomial.
+        static uint64_t XPowMod(size_t n)
+        {
+            uint32_t r = 1;
+            while (n-- > 0) {
+                r = (r & 0x80000000) != 0 ? (r << 1) ^ 0x04C11DB7 : r << 1;
+            }
+            return r;
+        }
+    };
+
+    // One byte at a time.
+    inline uint32_t AddBytewise(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        while (size-- > 0) {
+            fcs = (fcs << 8) ^ fcstab_32[((fcs >> 24) ^ (*cp++)) & 0xFF];
+        }
+        return fcs;
+    }
+
+    // Eight bytes at a time, then one byte at a time.
+    uint32_t AddSlicing8(const CRC32Tables& tab, uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        while (size >= 8) {
+            const uint32_t hi = fcs ^ ts::GetUInt32BE(cp);
+            const uint32_t lo = ts::GetUInt32BE(cp + 4);
+            fcs = tab.slice[7][hi >> 24] ^ tab.slice[6][(hi >> 16) & 0xFF] ^ tab.slice[5][(hi >> 8) & 0xFF] ^ tab.slice[4][hi & 0xFF] ^
+                  tab.slice[3][lo >> 24] ^ tab.slice[2][(lo >> 16) & 0xFF] ^ tab.slice[1][(lo >> 8) & 0xFF] ^ tab.slice[0][lo & 0xFF];
+            cp += 8;
+            size -= 8;
+        }
+        return AddBytewise(fcs, cp, size);
+    }
+
+#if defined(TS_CRC32_PCLMUL)
+
+    // Minimum data size for the PCLMUL algorithm.
+    const size_t PCLMUL_MIN_SIZE = 64;
+
+    // Multiply the high and low halves of a 128-bit polynomial by the two constants in k.
+    // The result is congruent to v * x^n modulo P when k contains x^(n+64) (low) and x^n (high).
+    TS_PCLMUL_TARGET inline __m128i Fold(__m128i v, __m128i k)
+    {
+        return _mm_xor_si128(_mm_clmulepi64_si128(v, k, 0x01), _mm_clmulepi64_si128(v, k, 0x10));
+    }
+
+    // Load 16 bytes as a 128-bit polynomial: the first bit is the highest degree coefficient.
+    TS_PCLMUL_TARGET inline __m128i Load(const uint8_t* cp, __m128i swap)
+    {
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cp)), swap);
+    }
+
+    // Process a multiple of 16 bytes, at least PCLMUL_MIN_SIZE, using four parallel
+    // 128-bit accumulators. The final 128-bit value is reduced to 32 bits using the
+    // slicing-by-8 tables: the CRC register for a message M is M * x^32 mod P.
+    TS_PCLMUL_TARGET uint32_t AddPCLMUL(const CRC32Tables& tab, uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i k128 = _mm_set_epi64x(int64_t(tab.x128), int64_t(tab.x192));
+        const __m128i k512 = _mm_set_epi64x(int64_t(tab.x512), int64_t(tab.x576));
+
+        // The current CRC register is combined with the first 32 bits of data.
+        __m128i a0 = _mm_xor_si128(Load(cp, swap), _mm_set_epi32(int(fcs), 0, 0, 0));
+        __m128i a1 = Load(cp + 16, swap);
+        __m128i a2 = Load(cp + 32, swap);
+        __m128i a3 = Load(cp + 48, swap);
+        cp += 64;
+        size -= 64;
+
+        while (size >= 64) {
+            a0 = _mm_xor_si128(Fold(a0, k512), Load(cp, swap));
+            a1 = _mm_xor_si128(Fold(a1, k512), Load(cp + 16, swap));
+            a2 = _mm_xor_si128(Fold(a2, k512), Load(cp + 32, swap));
+            a3 = _mm_xor_si128(Fold(a3, k512), Load(cp + 48, swap));
+            cp += 64;
+            size -= 64;
+        }
+
+        a1 = _mm_xor_si128(Fold(a0, k128), a1);
+        a2 = _mm_xor_si128(Fold(a1, k128), a2);
+        a3 = _mm_xor_si128(Fold(a2, k128), a3);
+
+        while (size >= 16) {
+            a3 = _mm_xor_si128(Fold(a3, k128), Load(cp, swap));
+            cp += 16;
+            size -= 16;
+        }
+
+        uint8_t buf[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buf), _mm_shuffle_epi8(a3, swap));
+        return AddSlicing8(tab, 0, buf, sizeof(buf));
+    }
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a CRC32 algorithm is available on this system.
+//----------------------------------------------------------------------------
+
+bool ts::CRC32::IsAvailable(Algorithm algo)
+{
+    return algo != PCLMUL || CRC32Tables::Instance().pclmul;
+}
+
+
+//----------------------------------------------------------------------------
 // Continue the computation of a data area, following a previous CRC32
+//----------------------------------------------------------------------------
 
-void ts::CRC32::add (const void* data, size_t size)
+void ts::CRC32::add(const void* data, size_t size, Algorithm algo)
 {
-    const uint8_t* cp = static_cast <const uint8_t*> (data);
+    const uint8_t* cp = static_cast<const uint8_t*>(data);
 
-    while (size-- > 0) {
-        _fcs = (_fcs << 8) ^ fcstab_32 [((_fcs >> 24) ^ (*cp++)) & 0xFF];
+    if (algo == BYTEWISE) {
+        _fcs = AddBytewise(_fcs, cp, size);
+        return;
     }
+
+    const CRC32Tables& tab(CRC32Tables::Instance());
+
+#if defined(TS_CRC32_PCLMUL)
+    if (tab.pclmul && (algo == PCLMUL || algo == DEFAULT) && size >= PCLMUL_MIN_SIZE) {
+        const size_t fold_size = size & ~size_t(15);
+        _fcs = AddPCLMUL(tab, _fcs, cp, fold_size);
+        cp += fold_size;
+        size -= fold_size;
+    }
+#endif
+
+    _fcs = AddSlicing8(tab, _fcs, cp, size);
 }
@@ -67,12 +67,42 @@ namespace ts {
             add(data, size);
         }
 
+        //!
+        //! Algorithms to compute the CRC32.
+        //! All algorithms produce the same result. Applications should use DEFAULT.
+        //! The other values are provided for tests and benchmarks.
+        //!
+        enum Algorithm {
+            DEFAULT,    //!< Fastest algorithm which is available on this system.
+            BYTEWISE,   //!< One byte at a time, using one 256-entry table (reference implementation).
+            SLICING8,   //!< Eight bytes at a time, using eight 256-entry tables ("slicing-by-8").
+            PCLMUL,     //!< Folding using carry-less multiplications, on Intel x86 processors with PCLMULQDQ.
+        };
+
         //!
         //! Continue the computation of a data area, following a previous CRC32.
         //! @param [in] data Address of area to analyze.
         //! @param [in] size Size in bytes of area to analyze.
         //!
-        void add(const void* data, size_t size);
+        void add(const void* data, size_t size)
+        {
+            add(data, size, DEFAULT);
+        }
+
+        //!
+        //! Continue the computation of a data area, following a previous CRC32, using a specific algorithm.
+        //! @param [in] data Address of area to analyze.
+        //! @param [in] size Size in bytes of area to analyze.
+        //! @param [in] algo Algorithm to use. If @a algo is not available on this system, use SLICING8.
+        //!
+        void add(const void* data, size_t size, Algorithm algo);
+
+        //!
+        //! Check if a CRC32 algorithm is available on this system.
+        //! @param [in] algo Algorithm to check.
+        //! @return True if @a algo is available.
+        //!
+        static bool IsAvailable(Algorithm algo);
 
         //!
         //! Get the value of the CRC32 as computed so far.
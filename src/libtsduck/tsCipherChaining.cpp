@@ -28,6 +28,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsCipherChaining.h"
+#include "tsMemoryUtils.h"
 TSDUCK_SOURCE;
 
 
@@ -41,7 +42,8 @@ ts::CipherChaining::CipherChaining (BlockCipher* cipher, size_t iv_min_blocks, s
     iv(iv_max_blocks * block_size),
     work(work_blocks * block_size),
     _iv_min_size(iv_min_blocks * block_size),
-    _iv_max_size(iv_max_blocks * block_size)
+    _iv_max_size(iv_max_blocks * block_size),
+    _pipeline((PIPELINE_BLOCKS + 2) * block_size)
 {
 }
 
@@ -110,3 +112,51 @@ bool ts::CipherChaining::setIV(const void* iv_data, size_t iv_length)
         return true;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Decrypt a sequence of complete blocks in CBC mode.
+//----------------------------------------------------------------------------
+
+bool ts::CipherChaining::decryptBlocksCBC(const uint8_t* ct, uint8_t* pt, size_t count, const uint8_t* previous, uint8_t* last)
+{
+    if (algo == 0 || block_size == 0 || _pipeline.size() < (PIPELINE_BLOCKS + 2) * block_size) {
+        return false;
+    }
+
+    // Layout of the work area: previous cipher block, decrypted blocks, next previous cipher block.
+    uint8_t* const chain = _pipeline.data();
+    uint8_t* const dec = chain + block_size;
+    uint8_t* const next = dec + PIPELINE_BLOCKS * block_size;
+
+    ::memcpy(chain, previous, block_size);
+
+    while (count > 0) {
+        const size_t n = std::min(count, PIPELINE_BLOCKS);
+        const size_t size = n * block_size;
+
+        // Decrypt all blocks of the group at once.
+        if (!algo->decryptBlocks(ct, dec, n)) {
+            return false;
+        }
+
+        // decrypted = previous-cipher XOR decrypted
+        MemXor(dec, dec, chain, block_size);
+        MemXor(dec + block_size, dec + block_size, ct, size - block_size);
+
+        // Save the last cipher block of the group before it is possibly overwritten
+        // by in-place decryption, then store the plain text.
+        ::memcpy(next, ct + size - block_size, block_size);
+        ::memcpy(pt, dec, size);
+        ::memcpy(chain, next, block_size);
+
+        ct += size;
+        pt += size;
+        count -= n;
+    }
+
+    if (last != 0) {
+        ::memcpy(last, chain, block_size);
+    }
+    return true;
+}
@@ -109,10 +109,34 @@ namespace ts {
                        size_t iv_max_blocks = 1,
                        size_t work_blocks = 1);
 
+        //!
+        //! Maximum number of blocks which are decrypted at once using BlockCipher::decryptBlocks().
+        //!
+        static const size_t PIPELINE_BLOCKS = 64;
+
+        //!
+        //! Decrypt a sequence of complete blocks in CBC mode.
+        //!
+        //! The block decryptions are independent in CBC mode. They are performed by groups
+        //! of up to PIPELINE_BLOCKS blocks using the multi-block entry point of the block
+        //! cipher, before the chaining XOR. In-place decryption is allowed.
+        //!
+        //! @param [in] cipher Address of cipher text, @a count blocks.
+        //! @param [out] plain Address of plain text buffer, @a count blocks. Can be the same
+        //! as @a cipher but must not partially overlap.
+        //! @param [in] count Number of blocks.
+        //! @param [in] previous Previous cipher block (typically the IV), one block.
+        //! @param [out] last If not zero, receives a copy of the last cipher block
+        //! (or @a previous if @a count is zero), one block.
+        //! @return True on success, false on error.
+        //!
+        bool decryptBlocksCBC(const uint8_t* cipher, uint8_t* plain, size_t count, const uint8_t* previous, uint8_t* last = 0);
+
     private:
         // Private fields
-        size_t _iv_min_size;  // IV min size in bytes
-        size_t _iv_max_size;  // IV max size in bytes
+        size_t    _iv_min_size;  // IV min size in bytes
+        size_t    _iv_max_size;  // IV max size in bytes
+        ByteBlock _pipeline;     // Work area for decryptBlocksCBC(): chain block, PIPELINE_BLOCKS blocks, saved block
 
         // Inaccesible operations
         CipherChaining(const CipherChaining&) = delete;
@@ -50,7 +50,11 @@ ts::CyclingPacketizer::CyclingPacketizer(PID pid, StuffingPolicy stuffing, BitRa
     _sched_packets(0),
     _current_cycle(1),
     _remain_in_cycle(0),
-    _cycle_end(UNDEFINED)
+    _cycle_end(UNDEFINED),
+    _replay_state(REPLAY_NONE),
+    _cycle_packets(),
+    _replay_index(0),
+    _replay_cycles(0)
 {
 }
 
@@ -120,6 +124,7 @@ void ts::CyclingPacketizer::addScheduledSection(const SectionDescPtr& sect)
 
 void ts::CyclingPacketizer::addSection(const SectionPtr& sect, MilliSecond rep_rate)
 {
+    stopReplay();
     SectionDescPtr desc(new SectionDesc(sect, rep_rate));
 
     if (rep_rate == 0 || _bitrate == 0) {
@@ -144,6 +149,7 @@ void ts::CyclingPacketizer::addSection(const SectionPtr& sect, MilliSecond rep_r
 
 void ts::CyclingPacketizer::removeSections(TID tid)
 {
+    stopReplay();
     removeSections(_sched_sections, tid, 0, false, true);
     removeSections(_other_sections, tid, 0, false, false);
 }
@@ -155,6 +161,7 @@ void ts::CyclingPacketizer::removeSections(TID tid)
 
 void ts::CyclingPacketizer::removeSections(TID tid, uint16_t tid_ext)
 {
+    stopReplay();
     removeSections(_sched_sections, tid, tid_ext, true, true);
     removeSections(_other_sections, tid, tid_ext, true, false);
 }
@@ -197,6 +204,7 @@ void ts::CyclingPacketizer::removeSections(SectionDescList& list, TID tid, uint1
 
 void ts::CyclingPacketizer::removeAll()
 {
+    stopReplay();
     _section_count = 0;
     _remain_in_cycle = 0;
     _sched_packets = 0;
@@ -229,7 +237,10 @@ void ts::CyclingPacketizer::setBitRate(BitRate new_bitrate)
         // Do not do anything if bitrate unchanged.
         return;
     }
-    else if (new_bitrate == 0) {
+
+    stopReplay();
+
+    if (new_bitrate == 0) {
         // Bitrate now unknown, unable to schedule sections, move them all
         // into the list of unscheduled sections.
         while (!_sched_sections.empty()) {
@@ -368,12 +379,122 @@ bool ts::CyclingPacketizer::doStuffing()
 
 bool ts::CyclingPacketizer::atCycleBoundary() const
 {
+    // When replaying, _cycle_end is not updated.
+    if (_replay_state == REPLAY_PLAY) {
+        return _replay_index == 0;
+    }
+
     // Coverity false positive:  _cycle_end + 1 overflows only if _cycle_end == UNDEFINED, which is excluded just before.
     // coverity[INTEGER_OVERFLOW]
     return atSectionBoundary() && _cycle_end != UNDEFINED && _cycle_end + 1 == sectionCount();
 }
 
 
+//----------------------------------------------------------------------------
+// Build the next MPEG packet for the list of sections.
+//----------------------------------------------------------------------------
+
+void ts::CyclingPacketizer::getNextPacket(TSPacket& pkt)
+{
+    if (_replay_state == REPLAY_PLAY) {
+        // Replay the recorded cycle. The provider is not called, its state
+        // is brought up to date by stopReplay() when something changes.
+        const CyclePacket& cp(_cycle_packets[_replay_index]);
+        pkt = cp.packet;
+        pkt.setPID(_pid);
+        pkt.setCC(_continuity);
+        _continuity = (_continuity + 1) & 0x0F;
+        _packet_count++;
+        _next_byte = cp.next_byte;
+        _section_out_count += cp.sections_out;
+        _section_in_count += cp.sections_in;
+        if (++_replay_index >= _cycle_packets.size()) {
+            _replay_index = 0;
+            _replay_cycles++;
+        }
+        return;
+    }
+
+    // Regular packetization.
+    const SectionCounter out_count = _section_out_count;
+    const SectionCounter in_count = _section_in_count;
+    Packetizer::getNextPacket(pkt);
+
+    if (_replay_state == REPLAY_RECORD) {
+        if (_cycle_packets.size() >= REPLAY_MAX_PACKETS) {
+            // Cycle too long, do not record it.
+            stopReplay();
+        }
+        else {
+            const CyclePacket cp = {pkt, _next_byte, _section_out_count - out_count, _section_in_count - in_count};
+            _cycle_packets.push_back(cp);
+        }
+    }
+
+    // A cycle which starts and ends at cycle boundaries without modification in
+    // between is identical to the next cycles. With scheduled sections, the
+    // content of a cycle depends on the packet count and cannot be reused.
+    if (_stuffing != NEVER && _section_count > 0 && _sched_sections.empty() && atCycleBoundary()) {
+        if (_replay_state == REPLAY_RECORD && !_cycle_packets.empty()) {
+            _replay_state = REPLAY_PLAY;
+            _replay_index = 0;
+            _replay_cycles = 0;
+        }
+        else {
+            _replay_state = REPLAY_RECORD;
+            _cycle_packets.clear();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Stop replaying or recording the cycle, bring the provider state up to date.
+//----------------------------------------------------------------------------
+
+void ts::CyclingPacketizer::stopReplay()
+{
+    if (_replay_state == REPLAY_PLAY) {
+
+        // The provider state is the one at the start of the first replayed cycle.
+        // Account for the complete cycles which were replayed since then.
+        if (_replay_cycles > 0) {
+            const PacketCounter cycle_packets = _cycle_packets.size();
+            SectionCounter cycle_sections = 0;
+            for (CyclePacketVector::const_iterator it = _cycle_packets.begin(); it != _cycle_packets.end(); ++it) {
+                cycle_sections += it->sections_in;
+            }
+            _current_cycle += _replay_cycles;
+            if (_cycle_end != UNDEFINED) {
+                _cycle_end += _replay_cycles * cycle_sections;
+            }
+            for (SectionDescList::iterator it = _other_sections.begin(); it != _other_sections.end(); ++it) {
+                (*it)->last_cycle += _replay_cycles;
+                (*it)->last_packet += _replay_cycles * cycle_packets;
+            }
+        }
+
+        // Rewind the counters at the start of the current cycle and packetize
+        // again the part of the current cycle which was replayed.
+        const size_t count = _replay_index;
+        for (size_t i = 0; i < count; ++i) {
+            _section_out_count -= _cycle_packets[i].sections_out;
+            _section_in_count -= _cycle_packets[i].sections_in;
+        }
+        _packet_count -= count;
+        _continuity = uint8_t((_continuity - count) & 0x0F);
+        _next_byte = 0;
+        TSPacket pkt;
+        for (size_t i = 0; i < count; ++i) {
+            Packetizer::getNextPacket(pkt);
+        }
+    }
+
+    _replay_state = REPLAY_NONE;
+    _cycle_packets.clear();
+}
+
+
 //----------------------------------------------------------------------------
 // Display the internal state of the packetizer SectionDesc, mainly for debug
 //----------------------------------------------------------------------------
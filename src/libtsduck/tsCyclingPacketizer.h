@@ -105,6 +105,7 @@ namespace ts {
         //!
         void setStuffingPolicy(StuffingPolicy sp)
         {
+            stopReplay();
             _stuffing = sp;
         }
 
@@ -204,6 +205,21 @@ namespace ts {
         //!
         bool atCycleBoundary() const;
 
+        //!
+        //! Build the next MPEG packet for the list of sections.
+        //! If there is no section to packetize, generate a null packet on PID_NULL.
+        //!
+        //! When the sections do not change, the packets of the last complete cycle are
+        //! reused for the next cycles, only the PID and continuity counter are updated.
+        //! This applies only when no section has a specific repetition rate and the
+        //! stuffing policy is not NEVER (otherwise a cycle may not end on a packet boundary).
+        //! This method hides Packetizer::getNextPacket(), do not call the latter on
+        //! a CyclingPacketizer.
+        //!
+        //! @param [out] packet The next TS packet.
+        //!
+        void getNextPacket(TSPacket& packet);
+
         // Inherited from Packetizer.
         virtual void reset() override;
         virtual std::ostream& display(std::ostream& strm) const override;
@@ -230,6 +246,23 @@ namespace ts {
             std::ostream& display(std::ostream&) const;
         };
 
+        // A packet of the recorded cycle and its effect on the packetizer state.
+        struct CyclePacket
+        {
+            TSPacket       packet;        // Packet content, PID and CC are updated when replayed
+            size_t         next_byte;     // Next byte to insert in current section after the packet
+            SectionCounter sections_out;  // Number of sections which were completed in the packet
+            SectionCounter sections_in;   // Number of sections which were provided in the packet
+        };
+        typedef std::vector<CyclePacket> CyclePacketVector;
+
+        // State of the cycle reuse.
+        enum ReplayState {
+            REPLAY_NONE,    // Regular packetization
+            REPLAY_RECORD,  // Regular packetization, recording the current cycle
+            REPLAY_PLAY     // Replaying the recorded cycle
+        };
+
         // Safe pointer for SectionDesc (not thread-safe)
         typedef SafePtr <SectionDesc, NullMutex> SectionDescPtr;
 
@@ -246,9 +279,20 @@ namespace ts {
         SectionCounter  _current_cycle;   // Cycle number (start at 1, always increasing)
         size_t          _remain_in_cycle; // Number of unsent sections in this cycle
         SectionCounter  _cycle_end;       // At end of cycle, contains the index of last section
+        ReplayState       _replay_state;  // State of the cycle reuse
+        CyclePacketVector _cycle_packets; // Recorded cycle
+        size_t            _replay_index;  // Index in _cycle_packets of next packet to replay
+        SectionCounter    _replay_cycles; // Number of complete cycles which were replayed
 
         static const SectionCounter UNDEFINED = ~SectionCounter(0);
 
+        // Maximum number of packets in a cycle which is recorded for reuse.
+        static const size_t REPLAY_MAX_PACKETS = 256;
+
+        // Stop replaying or recording the cycle, bring the provider state up to date.
+        // Must be called before any modification of the sections or the policy.
+        void stopReplay();
+
         // Insert a scheduled section in the list, sorted by due_packet,
         // after other sections with the same due_packet.
         void addScheduledSection(const SectionDescPtr&);
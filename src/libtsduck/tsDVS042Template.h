@@ -106,7 +106,7 @@ bool ts::DVS042<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
 {
     if (this->algo == 0 ||
         this->iv.size() != this->block_size ||
-        this->work.size() < this->block_size ||
+        this->work.size() < 2 * this->block_size ||
         cipher_length < this->block_size ||
         plain_maxsize < cipher_length) {
         return false;
@@ -115,39 +115,28 @@ bool ts::DVS042<CIPHER>::decrypt(const void* cipher, size_t cipher_length,
         *plain_length = cipher_length;
     }
 
-    // Decrypt all blocks in CBC mode, except the last one if partial
+    // Decrypt all blocks in CBC mode, except the last one if partial.
+    // Keep a copy of the last complete cipher block in work.
 
-    const uint8_t* previous = this->iv.data();
     const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
+    const size_t full_size = cipher_length - cipher_length % this->block_size;
 
-    while (cipher_length >= this->block_size) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
-            return false;
-        }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+    if (!this->decryptBlocksCBC(ct, pt, full_size / this->block_size, this->iv.data(), this->work.data())) {
+        return false;
     }
 
     // Process final block if incomplete
 
-    if (cipher_length > 0) {
-        // work = encrypt (Cn-1)
-        if (!this->algo->encrypt(previous, this->block_size, this->work.data(), this->block_size)) {
+    if (cipher_length > full_size) {
+        uint8_t* const mask = this->work.data() + this->block_size;
+        // mask = encrypt (Cn-1)
+        if (!this->algo->encrypt(this->work.data(), this->block_size, mask, this->block_size)) {
             return false;
         }
-        // Pn = work XOR Cn, truncated
-        for (size_t i = 0; i < cipher_length; ++i) {
-            pt[i] = this->work[i] ^ ct[i];
+        // Pn = mask XOR Cn, truncated
+        for (size_t i = full_size; i < cipher_length; ++i) {
+            pt[i] = mask[i - full_size] ^ ct[i];
         }
     }
     return true;
@@ -46,6 +46,7 @@ ts::ForkPipe::ForkPipe() :
     _synchronous(false),
     _ignore_abort(false),
     _broken_pipe(false),
+    _env(),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE),
     _process(INVALID_HANDLE_VALUE)
@@ -120,9 +121,28 @@ bool ts::ForkPipe::open(const UString& command, bool synchronous, size_t buffer_
     UString cmd(command);
     ::WCHAR* cmdp = const_cast<::WCHAR*>(cmd.wc_str());
 
+    // With additional environment variables, build a complete environment block
+    // for the child process: "name=value" strings, terminated by an empty string.
+    std::vector<::WCHAR> envblock;
+    if (!_env.empty()) {
+        Environment env;
+        GetEnvironment(env);
+        for (Environment::const_iterator it = _env.begin(); it != _env.end(); ++it) {
+            env[it->first] = it->second;
+        }
+        for (Environment::const_iterator it = env.begin(); it != env.end(); ++it) {
+            const UString var(it->first + u"=" + it->second);
+            envblock.insert(envblock.end(), var.begin(), var.end());
+            envblock.push_back(0);
+        }
+        envblock.push_back(0);
+    }
+
     // Create the process
     ::PROCESS_INFORMATION pi;
-    if (::CreateProcessW(NULL, cmdp, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi) == 0) {
+    const ::DWORD flags = envblock.empty() ? 0 : CREATE_UNICODE_ENVIRONMENT;
+    ::LPVOID envp = envblock.empty() ? NULL : &envblock[0];
+    if (::CreateProcessW(NULL, cmdp, NULL, NULL, TRUE, flags, envp, NULL, &si, &pi) == 0) {
         report.error(u"error creating pipe: %s", {ErrorCodeMessage()});
         return false;
     }
@@ -151,6 +171,13 @@ bool ts::ForkPipe::open(const UString& command, bool synchronous, size_t buffer_
         return false;
     }
 
+    // Prepare the command and the environment in UTF-8 before forking.
+    const std::string cmd(command.toUTF8());
+    std::vector<std::pair<std::string, std::string>> env;
+    for (Environment::const_iterator it = _env.begin(); it != _env.end(); ++it) {
+        env.push_back(std::make_pair(it->first.toUTF8(), it->second.toUTF8()));
+    }
+
     // Create the forked process
     if ((_fpid = ::fork()) < 0) {
         report.error(u"fork error: " + ErrorCodeMessage());
@@ -169,9 +196,13 @@ bool ts::ForkPipe::open(const UString& command, bool synchronous, size_t buffer_
         }
         // Close the now extraneous file descriptor.
         ::close(filedes[0]);
+        // Add the environment variables of the child process.
+        for (size_t i = 0; i < env.size(); ++i) {
+            ::setenv(env[i].first.c_str(), env[i].second.c_str(), 1);
+        }
         // Execute the command. Should not return.
         // Flawfinder: ignore: execl causes a new program to execute and is difficult to use safely.
-        ::execl("/bin/sh", "/bin/sh", "-c", command.toUTF8().c_str(), TS_NULL);
+        ::execl("/bin/sh", "/bin/sh", "-c", cmd.c_str(), TS_NULL);
         ::perror("exec error");
         ::exit(EXIT_FAILURE);
         assert(false); // should never get there
@@ -117,6 +117,18 @@ namespace ts {
             return _ignore_abort;
         }
 
+        //!
+        //! Set additional environment variables for the created process.
+        //! The variables are defined in the environment of the created process
+        //! only, the environment of the current process is not modified.
+        //! Must be called before open().
+        //! @param [in] env Environment variables to add or replace in the created process.
+        //!
+        void setEnvironment(const Environment& env)
+        {
+            _env = env;
+        }
+
         //!
         //! Write data to the pipe (received at process' standard input).
         //! @param [in] addr Address of the data to write.
@@ -131,6 +143,7 @@ namespace ts {
         bool     _synchronous;   // Wait for child process termination in stop()
         bool     _ignore_abort;  // Ignore early termination of child process
         bool     _broken_pipe;   // Pipe is broken, do not attempt to write
+        Environment _env;       // Additional environment variables of the child process
 #if defined(TS_WINDOWS)
         ::HANDLE _handle;        // Pipe output handle
         ::HANDLE _process;       // Handle to child process
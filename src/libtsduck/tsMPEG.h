@@ -1136,4 +1136,71 @@ namespace ts {
     //! See ETSI EN 302 765, section 5.1.7.
     //!
     const size_t T2_BBHEADER_SIZE = 10;
+
+    //---------------------------------------------------------------------
+    // RTP (Real-time Transport Protocol)
+    //---------------------------------------------------------------------
+
+    //!
+    //! Size in bytes of a fixed RTP header, without CSRC identifiers and extension.
+    //! @see RFC 3550, section 5.1.
+    //!
+    const size_t RTP_HEADER_SIZE = 12;
+
+    //!
+    //! RTP payload type for MPEG-2 transport streams.
+    //! @see RFC 3551, section 6.
+    //!
+    const uint8_t RTP_PT_MP2T = 33;
+
+    //!
+    //! RTP clock rate for MPEG-2 transport streams, in Hz.
+    //! @see RFC 2250, section 2.
+    //!
+    const uint32_t RTP_RATE_MP2T = 90000;
+
+    //---------------------------------------------------------------------
+    // SMPTE 2022-1 FEC (Forward Error Correction for RTP streams)
+    //---------------------------------------------------------------------
+
+    //!
+    //! Size in bytes of the FEC header, after the RTP header of an FEC packet.
+    //! @see SMPTE 2022-1, section 8.
+    //!
+    const size_t FEC_HEADER_SIZE = 16;
+
+    //!
+    //! RTP payload type of FEC packets (dynamic payload type).
+    //!
+    const uint8_t RTP_PT_FEC = 96;
+
+    //!
+    //! Offset of the UDP port of the column FEC flow from the UDP port of the media flow.
+    //!
+    const uint16_t FEC_COLUMN_PORT_OFFSET = 2;
+
+    //!
+    //! Offset of the UDP port of the row FEC flow from the UDP port of the media flow.
+    //!
+    const uint16_t FEC_ROW_PORT_OFFSET = 4;
+
+    //!
+    //! Maximum number of columns (L parameter) in an FEC matrix.
+    //!
+    const size_t FEC_MAX_COLUMNS = 20;
+
+    //!
+    //! Minimum number of rows (D parameter) in an FEC matrix.
+    //!
+    const size_t FEC_MIN_ROWS = 4;
+
+    //!
+    //! Maximum number of rows (D parameter) in an FEC matrix.
+    //!
+    const size_t FEC_MAX_ROWS = 20;
+
+    //!
+    //! Maximum number of media packets in an FEC matrix (L x D).
+    //!
+    const size_t FEC_MAX_MATRIX = 100;
 }
@@ -32,8 +32,21 @@
 //----------------------------------------------------------------------------
 
 #include "tsMemoryUtils.h"
+#include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+// On x86_64, SSE2 is always available and AVX2 is used when the processor supports it.
+// The AVX2 functions are compiled with function-specific target options on GCC and LLVM.
+#if defined(TS_X86_64) && (defined(TS_MSC) || defined(TS_GCC))
+    #define TS_START_CODE_SIMD 1
+    #include <immintrin.h>
+    #if defined(TS_GCC)
+        #define TS_AVX2_TARGET __attribute__((target("avx2")))
+    #else
+        #define TS_AVX2_TARGET
+    #endif
+#endif
+
 
 //----------------------------------------------------------------------------
 // Check if a memory area starts with the specified prefix
@@ -70,6 +83,134 @@ const void* ts::LocatePattern (const void* area, size_t area_size, const void* p
     return 0; // not found
 }
 
+//----------------------------------------------------------------------------
+// Locate the next sequence 00 00 xx with low <= xx <= high, where high <= 1.
+// This is the common part of start code prefix and NAL unit end detection.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Portable version, also used for the last bytes of the SIMD versions.
+    const uint8_t* LocateZeroZeroScalar(const uint8_t* p, const uint8_t* end, uint8_t low, uint8_t high)
+    {
+        // Since high <= 1, a byte greater than 1 cannot be part of any matching sequence.
+        while (end - p >= 3) {
+            if (p[2] > 1) {
+                p += 3;
+            }
+            else if (p[1] != 0) {
+                p += 2;
+            }
+            else if (p[0] == 0 && p[2] >= low && p[2] <= high) {
+                return p;
+            }
+            else {
+                p++;
+            }
+        }
+        return 0;
+    }
+
+#if defined(TS_START_CODE_SIMD)
+
+    // Index of the lowest bit which is set in a non-zero mask.
+    inline size_t LowestBit(uint32_t mask)
+    {
+    #if defined(TS_MSC)
+        unsigned long index = 0;
+        ::_BitScanForward(&index, mask);
+        return size_t(index);
+    #else
+        return size_t(__builtin_ctz(mask));
+    #endif
+    }
+
+    // SSE2 version, 16 positions at a time. The last positions are checked with
+    // a last block which overlaps the previous one (no match in the overlap).
+    const uint8_t* LocateZeroZeroSSE2(const uint8_t* p, const uint8_t* end, uint8_t low, uint8_t high)
+    {
+        if (end - p < 16 + 2) {
+            return LocateZeroZeroScalar(p, end, low, high);
+        }
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i vlow = _mm_set1_epi8(char(low));
+        const __m128i vrange = _mm_set1_epi8(char(high - low));
+        const uint8_t* const last = end - (16 + 2);
+        for (;;) {
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+            const __m128i b2 = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2)), vlow);
+            // b2 - low <= high - low (unsigned) <=> low <= b2 <= high
+            const __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+                                                _mm_cmpeq_epi8(_mm_min_epu8(b2, vrange), b2));
+            const uint32_t mask = uint32_t(_mm_movemask_epi8(match));
+            if (mask != 0) {
+                return p + LowestBit(mask);
+            }
+            if (p == last) {
+                return 0;
+            }
+            p = std::min(p + 16, last);
+        }
+    }
+
+    // AVX2 version, 32 positions at a time. Short areas and the last positions are
+    // processed in the same function, using the same overlapping last block. Calling
+    // the SSE2 version here would mix VEX and legacy SSE code, which is slow.
+    TS_AVX2_TARGET const uint8_t* LocateZeroZeroAVX2(const uint8_t* p, const uint8_t* end, uint8_t low, uint8_t high)
+    {
+        if (end - p < 32 + 2) {
+            return LocateZeroZeroScalar(p, end, low, high);
+        }
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i vlow = _mm256_set1_epi8(char(low));
+        const __m256i vrange = _mm256_set1_epi8(char(high - low));
+        const uint8_t* const last = end - (32 + 2);
+        for (;;) {
+            const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+            const __m256i b2 = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 2)), vlow);
+            const __m256i match = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)),
+                                                   _mm256_cmpeq_epi8(_mm256_min_epu8(b2, vrange), b2));
+            const uint32_t mask = uint32_t(_mm256_movemask_epi8(match));
+            if (mask != 0) {
+                return p + LowestBit(mask);
+            }
+            if (p == last) {
+                return 0;
+            }
+            p = std::min(p + 32, last);
+        }
+    }
+
+#endif
+
+    const uint8_t* LocateZeroZero(const void* area, size_t area_size, uint8_t low, uint8_t high)
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(area);
+        if (p == 0) {
+            return 0;
+        }
+    #if defined(TS_START_CODE_SIMD)
+        static const bool avx2 = ts::CPUHasFeature(ts::CPU_AVX2);
+        return avx2 ? LocateZeroZeroAVX2(p, p + area_size, low, high) : LocateZeroZeroSSE2(p, p + area_size, low, high);
+    #else
+        return LocateZeroZeroScalar(p, p + area_size, low, high);
+    #endif
+    }
+}
+
+const uint8_t* ts::LocateStartCodePrefix(const void* area, size_t area_size)
+{
+    return LocateZeroZero(area, area_size, 1, 1);
+}
+
+const uint8_t* ts::LocateNALUnitEnd(const void* area, size_t area_size)
+{
+    return LocateZeroZero(area, area_size, 0, 1);
+}
+
+
 //----------------------------------------------------------------------------
 // Check if a memory area contains all identical byte values.
 //----------------------------------------------------------------------------
@@ -89,3 +230,29 @@ bool ts::IdenticalBytes(const void * area, size_t area_size)
         return true;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Compute an exclusive OR over memory areas.
+//----------------------------------------------------------------------------
+
+void ts::MemXor(void* dest, const void* src1, const void* src2, size_t size)
+{
+    uint8_t* d = reinterpret_cast<uint8_t*>(dest);
+    const uint8_t* s1 = reinterpret_cast<const uint8_t*>(src1);
+    const uint8_t* s2 = reinterpret_cast<const uint8_t*>(src2);
+
+    // Process 64-bit words first. Using memcpy() avoids unaligned accesses,
+    // compilers translate it into simple (and often vectorized) loads and stores.
+    while (size >= 8) {
+        uint64_t w1, w2;
+        ::memcpy(&w1, s1, 8);
+        ::memcpy(&w2, s2, 8);
+        w1 ^= w2;
+        ::memcpy(d, &w1, 8);
+        d += 8; s1 += 8; s2 += 8; size -= 8;
+    }
+    while (size-- > 0) {
+        *d++ = *s1++ ^ *s2++;
+    }
+}
@@ -77,6 +77,26 @@ namespace ts {
     //!
     TSDUCKDLL const void* LocatePattern(const void* area, size_t area_size, const void* pattern, size_t pattern_size);
 
+    //!
+    //! Locate the next MPEG start code prefix (00 00 01) in a memory area.
+    //! This function is faster than LocatePattern(). It uses SIMD instructions when available.
+    //! @param [in] area Address of a memory area to check.
+    //! @param [in] area_size Size in bytes of the memory area.
+    //! @return Address of the first start code prefix in @a area or zero if not found.
+    //!
+    TSDUCKDLL const uint8_t* LocateStartCodePrefix(const void* area, size_t area_size);
+
+    //!
+    //! Locate the end of an AVC NAL unit in a memory area.
+    //! In an AVC byte stream (ISO 14496-10 Annex B), a NAL unit ends before the next
+    //! 3-byte sequence 00 00 00 or 00 00 01. This function is faster than LocatePattern().
+    //! It uses SIMD instructions when available.
+    //! @param [in] area Address of a memory area to check, typically the start of a NAL unit.
+    //! @param [in] area_size Size in bytes of the memory area.
+    //! @return Address of the first sequence 00 00 00 or 00 00 01 in @a area or zero if not found.
+    //!
+    TSDUCKDLL const uint8_t* LocateNALUnitEnd(const void* area, size_t area_size);
+
     //!
     //! Check if a memory area contains all identical byte values.
     //! @param [in] area Address of a memory area to check.
@@ -84,4 +104,13 @@ namespace ts {
     //! @return True if @a area_size is greater than 1 and all bytes in @a area are identical.
     //!
     TSDUCKDLL bool IdenticalBytes(const void* area, size_t area_size);
+
+    //!
+    //! Compute an exclusive OR over memory areas.
+    //! @param [out] dest Destination start address. Can be identical to @a src1 or @a src2.
+    //! @param [in] src1 Start address of the first area.
+    //! @param [in] src2 Start address of the second area.
+    //! @param [in] size Size in bytes of the memory areas.
+    //!
+    TSDUCKDLL void MemXor(void* dest, const void* src1, const void* src2, size_t size);
 }
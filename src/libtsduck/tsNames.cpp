@@ -30,6 +30,7 @@
 #include "tsNames.h"
 #include "tsMPEG.h"
 #include "tsSysUtils.h"
+#include "tsGuard.h"
 #include "tsFatal.h"
 #include "tsCerrReport.h"
 TSDUCK_SOURCE;
@@ -263,22 +264,88 @@ ts::UString ts::names::AC3ComponentType(uint8_t type, Flags flags)
 
 
 //----------------------------------------------------------------------------
-// Constructor (load the configuration file).
+// Layout of a binary index. All integers are big endian.
+// - Header: magic number and format version (8 bytes), number of sections
+//   (4 bytes), offset of the string pool (4 bytes).
+// - Section directory, sorted by lowercase section name: offset and size of
+//   the name in the string pool, number of bits, number of entries, offset of
+//   the first entry (4 bytes each).
+// - Entries of all sections, sorted by first value in each section: first
+//   value, last value (8 bytes each), offset and size of the name in the string
+//   pool (4 bytes each).
+// - String pool: all section and entry names in UTF-8, without separator.
 //----------------------------------------------------------------------------
 
-ts::Names::Names(const UString& fileName) :
+const ts::UChar* const ts::Names::INDEX_SUFFIX = u".bin";
+
+namespace {
+    const uint8_t INDEX_MAGIC[8] = {'T', 'S', 'N', 'A', 'M', 'E', 'S', 0x01};
+    const size_t INDEX_HEADER_SIZE = 16;
+    const size_t INDEX_SECTION_SIZE = 20;
+    const size_t INDEX_ENTRY_SIZE = 24;
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor. The configuration is loaded on first use.
+//----------------------------------------------------------------------------
+
+ts::Names::Names(const UString& fileName, bool useIndex) :
     _log(CERR),
-    _configFile(SearchConfigurationFile(fileName)),
+    _fileName(fileName),
+    _useIndex(useIndex),
+    _mutex(),
+    _loaded(false),
+    _configFile(),
     _configLines(0),
     _configErrors(0),
-    _sections()
+    _sections(),
+    _index(0),
+    _indexSize(0),
+    _indexData()
 {
-    // Locate the configuration file.
-    if (_configFile.empty()) {
-        // Cannot load configuration, names will not be available.
-        _log.error(u"configuration file 'tsduck.names' not found");
+}
+
+
+//----------------------------------------------------------------------------
+// Load the configuration file or binary index on first use.
+//----------------------------------------------------------------------------
+
+void ts::Names::load() const
+{
+    if (_loaded) {
         return;
     }
+    _loaded = true;
+
+    // Locate the configuration file and its binary index.
+    const UString textFile(SearchConfigurationFile(_fileName));
+    const UString indexFile(_useIndex ? SearchConfigurationFile(_fileName + INDEX_SUFFIX) : UString());
+
+    // Use the binary index, unless the text file is more recent.
+    if (!indexFile.empty() &&
+        (textFile.empty() || GetFileModificationTimeUTC(textFile) <= GetFileModificationTimeUTC(indexFile)) &&
+        mapIndex(indexFile))
+    {
+        _configFile = indexFile;
+    }
+    else if (textFile.empty()) {
+        // Cannot load configuration, names will not be available.
+        _log.error(u"configuration file '%s' not found", {_fileName});
+    }
+    else {
+        loadText(textFile);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Load the text configuration file.
+//----------------------------------------------------------------------------
+
+void ts::Names::loadText(const UString& fileName) const
+{
+    _configFile = fileName;
 
     // Open configuration file.
     const std::string fileUTF8(_configFile.toUTF8());
@@ -331,11 +398,247 @@ ts::Names::Names(const UString& fileName) :
 }
 
 
+//----------------------------------------------------------------------------
+// Map the binary index in memory. Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::Names::mapIndex(const UString& fileName) const
+{
+#if defined(TS_WINDOWS)
+
+    // The index is small enough to be read at once.
+    if (!_indexData.loadFromFile(fileName, std::numeric_limits<size_t>::max(), &_log)) {
+        return false;
+    }
+    _index = _indexData.data();
+    _indexSize = _indexData.size();
+
+#else
+
+    // Map the complete file. Only the pages of the searched sections are actually read.
+    const int fd = ::open(fileName.toUTF8().c_str(), O_RDONLY);
+    if (fd < 0) {
+        _log.error(u"error opening file %s: %s", {fileName, ErrorCodeMessage(LastErrorCode())});
+        return false;
+    }
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        base = ::mmap(0, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    const ErrorCode error_code = LastErrorCode();
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        _log.error(u"error mapping file %s: %s", {fileName, ErrorCodeMessage(error_code)});
+        return false;
+    }
+    _index = reinterpret_cast<const uint8_t*>(base);
+    _indexSize = size_t(st.st_size);
+
+#endif
+
+    // Check the structure of the index. The offsets of the names are checked during the search.
+    bool valid = _indexSize >= INDEX_HEADER_SIZE && ::memcmp(_index, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0;
+    if (valid) {
+        const size_t count = GetUInt32(_index + 8);
+        const size_t strings = GetUInt32(_index + 12);
+        valid = strings >= INDEX_HEADER_SIZE && strings <= _indexSize && count <= (strings - INDEX_HEADER_SIZE) / INDEX_SECTION_SIZE;
+        const size_t entries = INDEX_HEADER_SIZE + count * INDEX_SECTION_SIZE;
+        for (size_t i = 0; valid && i < count; ++i) {
+            const uint8_t* const sec = _index + INDEX_HEADER_SIZE + i * INDEX_SECTION_SIZE;
+            const size_t first = GetUInt32(sec + 16);
+            valid = first >= entries && first <= strings && GetUInt32(sec + 12) <= (strings - first) / INDEX_ENTRY_SIZE;
+        }
+    }
+    if (!valid) {
+        _log.error(u"%s: invalid names index", {fileName});
+        unmapIndex();
+    }
+    return valid;
+}
+
+
+//----------------------------------------------------------------------------
+// Unmap the binary index, if any.
+//----------------------------------------------------------------------------
+
+void ts::Names::unmapIndex() const
+{
+#if !defined(TS_WINDOWS)
+    if (_index != 0) {
+        ::munmap(const_cast<uint8_t*>(_index), _indexSize);
+    }
+#endif
+    _indexData.clear();
+    _index = 0;
+    _indexSize = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Get a section from its name, load it from binary index if necessary.
+//----------------------------------------------------------------------------
+
+const ts::Names::ConfigSection* ts::Names::getSection(const UString& sectionName) const
+{
+    // Normalize the section name.
+    const UString name(sectionName.toTrimmed().toLower());
+
+    Guard lock(_mutex);
+    load();
+
+    // Look for an already loaded section.
+    ConfigSectionMap::const_iterator it = _sections.find(name);
+    if (it != _sections.end()) {
+        return it->second;
+    }
+    else if (_index == 0) {
+        return 0;
+    }
+
+    // Binary search of the section in the directory of the binary index.
+    const std::string key(name.toUTF8());
+    const size_t strings = GetUInt32(_index + 12);
+    const uint8_t* const pool = _index + strings;
+    const size_t poolSize = _indexSize - strings;
+    size_t low = 0;
+    size_t high = GetUInt32(_index + 8);
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const uint8_t* const sec = _index + INDEX_HEADER_SIZE + mid * INDEX_SECTION_SIZE;
+        const size_t nameOffset = GetUInt32(sec);
+        const size_t nameSize = GetUInt32(sec + 4);
+        if (nameOffset > poolSize || nameSize > poolSize - nameOffset) {
+            break; // corrupted index
+        }
+        int cmp = ::memcmp(pool + nameOffset, key.data(), std::min(nameSize, key.size()));
+        if (cmp == 0) {
+            cmp = nameSize < key.size() ? -1 : (nameSize > key.size() ? 1 : 0);
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        }
+        else if (cmp > 0) {
+            high = mid;
+        }
+        else {
+            // Found the section, load it. The entries remain in the mapped index.
+            ConfigSection* section = new ConfigSection;
+            CheckNonNull(section);
+            section->bits = GetUInt32(sec + 8);
+            section->count = GetUInt32(sec + 12);
+            section->index = _index + GetUInt32(sec + 16);
+            section->strings = pool;
+            section->stringsSize = poolSize;
+            _sections.insert(std::make_pair(name, section));
+            return section;
+        }
+    }
+    return 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Accessors on the loaded configuration.
+//----------------------------------------------------------------------------
+
+ts::UString ts::Names::configurationFile() const
+{
+    Guard lock(_mutex);
+    load();
+    return _configFile;
+}
+
+bool ts::Names::isIndexed() const
+{
+    Guard lock(_mutex);
+    load();
+    return _index != 0;
+}
+
+size_t ts::Names::errorCount() const
+{
+    Guard lock(_mutex);
+    load();
+    return _configErrors;
+}
+
+
+//----------------------------------------------------------------------------
+// Save all names in a binary index.
+//----------------------------------------------------------------------------
+
+bool ts::Names::saveIndex(const UString& fileName, Report& report) const
+{
+    Guard lock(_mutex);
+    load();
+
+    if (_index != 0) {
+        report.error(u"%s is already a binary index", {_configFile});
+        return false;
+    }
+    else if (_configFile.empty()) {
+        report.error(u"configuration file '%s' not loaded", {_fileName});
+        return false;
+    }
+
+    // The sections are sorted by UTF-8 name, as searched in the binary index.
+    std::map<std::string, const ConfigSection*> sections;
+    for (ConfigSectionMap::const_iterator it = _sections.begin(); it != _sections.end(); ++it) {
+        sections.insert(std::make_pair(it->first.toUTF8(), it->second));
+    }
+
+    // Build the section directory, entries and string pool. Identical names are stored once.
+    const size_t entriesStart = INDEX_HEADER_SIZE + sections.size() * INDEX_SECTION_SIZE;
+    ByteBlock directory;
+    ByteBlock entries;
+    std::string pool;
+    std::map<std::string, size_t> poolOffsets;
+
+    for (std::map<std::string, const ConfigSection*>::const_iterator sec = sections.begin(); sec != sections.end(); ++sec) {
+        directory.appendUInt32(uint32_t(pool.size()));
+        directory.appendUInt32(uint32_t(sec->first.size()));
+        pool.append(sec->first);
+        directory.appendUInt32(uint32_t(sec->second->bits));
+        directory.appendUInt32(uint32_t(sec->second->entries.size()));
+        directory.appendUInt32(uint32_t(entriesStart + entries.size()));
+
+        for (ConfigEntryMap::const_iterator ent = sec->second->entries.begin(); ent != sec->second->entries.end(); ++ent) {
+            const std::string name(ent->second->name.toUTF8());
+            std::map<std::string, size_t>::const_iterator known = poolOffsets.find(name);
+            size_t offset = 0;
+            if (known != poolOffsets.end()) {
+                offset = known->second;
+            }
+            else {
+                offset = pool.size();
+                poolOffsets.insert(std::make_pair(name, offset));
+                pool.append(name);
+            }
+            entries.appendUInt64(ent->first);
+            entries.appendUInt64(ent->second->last);
+            entries.appendUInt32(uint32_t(offset));
+            entries.appendUInt32(uint32_t(name.size()));
+        }
+    }
+
+    // Build the complete index.
+    ByteBlock data(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    data.appendUInt32(uint32_t(sections.size()));
+    data.appendUInt32(uint32_t(entriesStart + entries.size()));
+    data.append(directory);
+    data.append(entries);
+    data.append(pool.data(), pool.size());
+
+    return data.saveToFile(fileName, &report);
+}
+
+
 //----------------------------------------------------------------------------
 // Decode a line as "first[-last] = name". Return true on success.
 //----------------------------------------------------------------------------
 
-bool ts::Names::decodeDefinition(const UString& line, ConfigSection* section)
+bool ts::Names::decodeDefinition(const UString& line, ConfigSection* section) const
 {
     // Check the presence of the '=' and in a valid section.
     const size_t equal = line.find(UChar('='));
@@ -394,6 +697,7 @@ ts::Names::~Names()
         delete it->second;
     }
     _sections.clear();
+    unmapIndex();
 }
 
 
@@ -414,7 +718,11 @@ ts::Names::ConfigEntry::ConfigEntry(Value l, const UString& n) :
 
 ts::Names::ConfigSection::ConfigSection() :
     bits(0),
-    entries()
+    entries(),
+    index(0),
+    count(0),
+    strings(0),
+    stringsSize(0)
 {
 }
 
@@ -472,6 +780,32 @@ void ts::Names::ConfigSection::addEntry(Value first, Value last, const UString&
 
 ts::UString ts::Names::ConfigSection::getName(Value val) const
 {
+    // Section from a binary index.
+    if (index != 0) {
+        // Binary search of the last entry with a first value not greater than 'val'.
+        size_t low = 0;
+        size_t high = count;
+        while (low < high) {
+            const size_t mid = low + (high - low) / 2;
+            if (GetUInt64(index + mid * INDEX_ENTRY_SIZE) <= val) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        if (low == 0) {
+            return UString();
+        }
+        const uint8_t* const entry = index + (low - 1) * INDEX_ENTRY_SIZE;
+        const size_t nameOffset = GetUInt32(entry + 16);
+        const size_t nameSize = GetUInt32(entry + 20);
+        if (val > GetUInt64(entry + 8) || nameOffset > stringsSize || nameSize > stringsSize - nameOffset) {
+            return UString();
+        }
+        return UString::FromUTF8(reinterpret_cast<const char*>(strings + nameOffset), nameSize);
+    }
+
     // Eliminate trivial cases which would cause issues with code below.
     if (entries.empty()) {
         return UString();
@@ -563,9 +897,8 @@ ts::UString ts::Names::Formatted(Value value, const UString& name, names::Flags
 
 ts::UString ts::Names::nameFromSection(const UString& sectionName, Value value, names::Flags flags, size_t bits) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    const ConfigSection* section = it == _sections.end() ? 0 : it->second;
+    // Get the section, load it if necessary.
+    const ConfigSection* section = getSection(sectionName);
 
     if (section == 0) {
         // Non-existent section, no name.
@@ -583,9 +916,8 @@ ts::UString ts::Names::nameFromSection(const UString& sectionName, Value value,
 
 ts::UString ts::Names::nameFromSectionWithFallback(const UString& sectionName, Value value1, Value value2, names::Flags flags, size_t bits) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    const ConfigSection* section = it == _sections.end() ? 0 : it->second;
+    // Get the section, load it if necessary.
+    const ConfigSection* section = getSection(sectionName);
 
     if (section == 0) {
         // Non-existent section, no name.
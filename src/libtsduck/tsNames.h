@@ -36,6 +36,8 @@
 #include "tsUString.h"
 #include "tsCASFamily.h"
 #include "tsReport.h"
+#include "tsByteBlock.h"
+#include "tsMutex.h"
 #include "tsStaticInstance.h"
 
 namespace ts {
@@ -328,16 +330,30 @@ namespace ts {
 
     //!
     //! A repository of names for MPEG/DVB entities.
+    //!
     //! All names are loaded from configuration files @em tsduck.*.names.
+    //! A configuration file can be compiled into a binary index with the same
+    //! name and suffix @em .bin (see the command @em tsnamescomp). When the
+    //! binary index is present and not older than the text file, it is mapped
+    //! in memory and the sections are searched in place, without parsing.
+    //! Otherwise, the text file is used. So, a modified text file always
+    //! overrides an older binary index.
+    //!
+    //! In all cases, the file is loaded on first use only, not when the object
+    //! is constructed. The sections of a binary index are individually loaded
+    //! on first use.
     //!
     class TSDUCKDLL Names
     {
     public:
         //!
         //! Constructor.
+        //! The configuration file is not loaded here, it is loaded on first use.
         //! @param [in] fileName Configuration file name. Typically without directory name.
+        //! @param [in] useIndex If true, use the binary index of the configuration
+        //! file when it is present and up to date. If false, always use the text file.
         //!
-        Names(const UString& fileName);
+        Names(const UString& fileName, bool useIndex = true);
 
         //!
         //! Virtual destructor.
@@ -349,23 +365,38 @@ namespace ts {
         //!
         typedef uint64_t Value;
 
+        //!
+        //! File name suffix of the binary index of a configuration file.
+        //!
+        static const UChar* const INDEX_SUFFIX;
+
         //!
         //! Get the complete path of the configuration file from which the names were loaded.
-        //! @return The complete path of the configuration file. Empty if does not exist.
+        //! @return The complete path of the configuration file or binary index. Empty if does not exist.
         //!
-        UString configurationFile() const
-        {
-            return _configFile;
-        }
+        UString configurationFile() const;
+
+        //!
+        //! Check if the names were loaded from a binary index.
+        //! @return True if the names were loaded from a binary index, false if they were
+        //! loaded from a text file or not loaded at all.
+        //!
+        bool isIndexed() const;
 
         //!
         //! Get the number of errors in the configuration file.
         //! @return The number of errors in the configuration file.
         //!
-        size_t errorCount() const
-        {
-            return _configErrors;
-        }
+        size_t errorCount() const;
+
+        //!
+        //! Save all names in a binary index.
+        //! The names must have been loaded from a text file.
+        //! @param [in] fileName Name of the binary index file to create.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool saveIndex(const UString& fileName, Report& report) const;
 
         //!
         //! Get a name from a specified section.
@@ -415,11 +446,17 @@ namespace ts {
 
         // Description of a configuration section.
         // The name of the section is the key in a map.
+        // A section from a text file contains a map of entries. A section from a
+        // binary index points to its sorted array of entries in the mapped index.
         class ConfigSection
         {
         public:
-            size_t          bits;     // Number of significant bits in values of the type.
-            ConfigEntryMap  entries;  // All entries, indexed by names.
+            size_t          bits;         // Number of significant bits in values of the type.
+            ConfigEntryMap  entries;      // All entries, indexed by names (text file only).
+            const uint8_t*  index;        // First entry in binary index, null for text file.
+            size_t          count;        // Number of entries in binary index.
+            const uint8_t*  strings;      // String pool of binary index.
+            size_t          stringsSize;  // Size in bytes of string pool.
 
             ConfigSection();
             ~ConfigSection();
@@ -437,8 +474,23 @@ namespace ts {
         // Map of configuration sections, indexed by name.
         typedef std::map<UString, ConfigSection*> ConfigSectionMap;
 
+        // Load the configuration file or binary index on first use. Must be called with mutex held.
+        void load() const;
+
+        // Load the text configuration file.
+        void loadText(const UString& fileName) const;
+
+        // Map the binary index in memory. Return true on success, false on error.
+        bool mapIndex(const UString& fileName) const;
+
+        // Unmap the binary index, if any.
+        void unmapIndex() const;
+
+        // Get a section from its name, null if not found. Load it from binary index if necessary.
+        const ConfigSection* getSection(const UString& sectionName) const;
+
         // Decode a line as "first[-last] = name". Return true on success, false on error.
-        bool decodeDefinition(const UString& line, ConfigSection* section);
+        bool decodeDefinition(const UString& line, ConfigSection* section) const;
 
         // Compute a number of hexa digits.
         static int HexaDigits(size_t bits);
@@ -446,12 +498,19 @@ namespace ts {
         // Compute the display mask
         static Value DisplayMask(size_t bits);
 
-        // Names private fields.
-        Report&          _log;           // Error logger.
-        const UString    _configFile;    // Configuration file path.
-        size_t           _configLines;   // Number of lines in configuration file.
-        size_t           _configErrors;  // Number of errors in configuration file.
-        ConfigSectionMap _sections;      // Configuration sections.
+        // Names private fields. All loaded data are mutable since they are lazily loaded on first use.
+        Report&                  _log;           // Error logger.
+        const UString            _fileName;      // Configuration file name, as specified.
+        const bool               _useIndex;      // Use binary index when available.
+        mutable Mutex            _mutex;         // Protect lazy loading.
+        mutable bool             _loaded;        // Configuration already loaded.
+        mutable UString          _configFile;    // Configuration file path.
+        mutable size_t           _configLines;   // Number of lines in configuration file.
+        mutable size_t           _configErrors;  // Number of errors in configuration file.
+        mutable ConfigSectionMap _sections;      // Configuration sections.
+        mutable const uint8_t*   _index;         // Binary index, null if none.
+        mutable size_t           _indexSize;     // Size in bytes of binary index.
+        mutable ByteBlock        _indexData;     // Binary index content, when not memory-mapped.
 
         // Inaccessible operations.
         Names() = delete;
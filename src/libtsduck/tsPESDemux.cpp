@@ -42,13 +42,20 @@ TSDUCK_SOURCE;
 
 namespace {
 
-    // Start code prefix for ISO 11172-2 (MPEG-1 video) and ISO 13818-2 (MPEG-2 video)
-    const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
-
-    // End of AVC NALunit delimiter
-    const uint8_t Zero3[] = {0x00, 0x00, 0x00};
+    // Size of the start code prefix 00 00 01 for ISO 11172-2 (MPEG-1 video),
+    // ISO 13818-2 (MPEG-2 video) and ISO 14496-10 (AVC). The end of an AVC
+    // NALunit is delimited by 00 00 00 or 00 00 01.
+    const size_t START_CODE_PREFIX_SIZE = 3;
+
+    // In streaming mode, the PES data are scanned by chunks of at most one TS payload,
+    // preceded by the last bytes of the previous chunk (a start code may span two TS packets).
+    const size_t STREAMING_CHUNK_SIZE = 184;
 }
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::PESDemux::DEFAULT_MAX_UNIT_SIZE;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -58,7 +65,9 @@ ts::PESDemux::PESDemux(PESHandlerInterface* pes_handler, const PIDSet& pid_filte
     SuperClass(pid_filter),
     _pes_handler(pes_handler),
     _pids(),
-    _packet_count(0)
+    _packet_count(0),
+    _streaming(false),
+    _max_unit_size(DEFAULT_MAX_UNIT_SIZE)
 {
 }
 
@@ -87,11 +96,47 @@ ts::PESDemux::PIDContext::PIDContext() :
     video(),
     avc(),
     ac3(),
-    ac3_count(0)
+    ac3_count(0),
+    content(CONTENT_UNKNOWN),
+    header_size(0),
+    payload_count(0),
+    in_unit(false),
+    unit_offset(0),
+    unit_size(0),
+    tail_size(0),
+    tail()
 {
 }
 
 
+//----------------------------------------------------------------------------
+// Reset the streaming state at the beginning of a PES packet.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::resetStreaming()
+{
+    content = CONTENT_UNKNOWN;
+    header_size = 0;
+    payload_count = 0;
+    in_unit = false;
+    unit_offset = 0;
+    unit_size = 0;
+    tail_size = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Set the streaming mode.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::setStreaming(bool on, size_t max_unit_size)
+{
+    _streaming = on;
+    _max_unit_size = std::max<size_t>(max_unit_size, 16);
+    reset();
+}
+
+
 //----------------------------------------------------------------------------
 // Reset the analysis context (partially built PES packets).
 //----------------------------------------------------------------------------
@@ -195,7 +240,12 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     // If at a unit start and the context exists, process previous PES packet in context
     if (pc_exists && pkt.getPUSI() && pci->second.sync) {
         // Process packet, invoke all handlers
-        processPESPacket (pid, pci->second);
+        if (_streaming) {
+            endStreamingPES(pid, pci->second);
+        }
+        else {
+            processPESPacket(pid, pci->second);
+        }
         // Recheck PID context in case it was reset by a handler
         pci = _pids.find (pid);
         pc_exists = pci != _pids.end();
@@ -224,9 +274,16 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
             PIDContext& pc(_pids[pid]);
             pc.continuity = pkt.getCC();
             pc.sync = true;
-            pc.ts->copy(pl, pl_size);
             pc.first_pkt = _packet_count;
             pc.last_pkt = _packet_count;
+            if (_streaming) {
+                pc.ts->clear();
+                pc.resetStreaming();
+                processStreamingData(pid, pc, pl, pl_size);
+            }
+            else {
+                pc.ts->copy(pl, pl_size);
+            }
         }
         else if (pc_exists) {
             // This PID does not contain PES packet, reset context
@@ -255,6 +312,13 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     }
     pc.continuity = pkt.getCC();
 
+    // In streaming mode, process the TS payload immediately.
+    if (_streaming) {
+        pc.last_pkt = _packet_count;
+        processStreamingData(pid, pc, pl, pl_size);
+        return;
+    }
+
     // Append the TS payload in PID context.
     size_t capacity = pc.ts->capacity();
     if (pc.ts->size() + pl_size > capacity) {
@@ -319,11 +383,11 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
             // The beginning of the payload is already a start code prefix.
             for (size_t offset = 0; offset < psize; ) {
                 // Look for next start code
-                const void* pnext = LocatePattern (pdata + offset + 1, psize - offset - 1, StartCodePrefix, sizeof(StartCodePrefix));
-                size_t next = pnext == 0 ? psize : reinterpret_cast <const uint8_t*> (pnext) - pdata;
-                // Invoke handler
+                const uint8_t* pnext = LocateStartCodePrefix (pdata + offset + 1, psize - offset - 1);
+                size_t next = pnext == 0 ? psize : pnext - pdata;
+                // Invoke handler (a start code prefix may be truncated at the end of the payload)
                 if (_pes_handler != 0) {
-                    _pes_handler->handleVideoStartCode (*this, pp, pdata[offset+3], offset, next - offset);
+                    _pes_handler->handleVideoStartCode (*this, pp, offset + 3 < psize ? pdata[offset+3] : 0, offset, next - offset);
                 }
                 // Accumulate info from video units to extract video attributes.
                 // If new attributes were found, invoke handler.
@@ -339,30 +403,18 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
         else if (pp.isAVC()) {
             for (size_t offset = 0; offset < psize; ) {
                 // Locate next access unit: starts with 00 00 01 (this start code is not part of the NALunit)
-                const uint8_t* p1 = reinterpret_cast <const uint8_t*> (LocatePattern (pdata + offset, psize - offset,
-                                                                                  StartCodePrefix, sizeof(StartCodePrefix)));
+                const uint8_t* p1 = LocateStartCodePrefix (pdata + offset, psize - offset);
                 if (p1 == 0) {
                     break;
                 }
-                offset = p1 - pdata + sizeof(StartCodePrefix);
-                // Locate end of access unit: ends with 00 00 00, 00 00 01 or end of
-                const uint8_t* p2 = reinterpret_cast <const uint8_t*> (LocatePattern (pdata + offset, psize - offset,
-                                                                                  StartCodePrefix, sizeof(StartCodePrefix)));
-                const uint8_t* p3 = reinterpret_cast <const uint8_t*> (LocatePattern (pdata + offset, psize - offset,
-                                                                                  Zero3, sizeof(Zero3)));
-                size_t nalunit_size;
-                if (p2 == 0 && p3 == 0) {
-                    nalunit_size = psize - offset;
-                }
-                else if (p2 == 0 || p3 < p2) {
-                    nalunit_size = p3 - pdata - offset;
-                }
-                else {
-                    nalunit_size = p2 - pdata - offset;
-                }
+                offset = p1 - pdata + START_CODE_PREFIX_SIZE;
+                // Locate end of access unit: ends with 00 00 00, 00 00 01 or end of PES payload.
+                // Both sequences are located in one single pass.
+                const uint8_t* p2 = LocateNALUnitEnd (pdata + offset, psize - offset);
+                const size_t nalunit_size = p2 == 0 ? psize - offset : p2 - pdata - offset;
                 // Invoke handler
                 if (_pes_handler != 0) {
-                    _pes_handler->handleAVCAccessUnit (*this, pp, pdata[offset] & 0x1F, offset, nalunit_size);
+                    _pes_handler->handleAVCAccessUnit (*this, pp, nalunit_size > 0 ? (pdata[offset] & 0x1F) : 0, offset, nalunit_size);
                 }
                 // Accumulate info from access units to extract video attributes.
                 // If new attributes were found, invoke handler.
@@ -400,3 +452,351 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
     }
     afterCallingHandler(true);
 }
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: process a part of the current PES packet.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::processStreamingData(PID pid, PIDContext& pc, const uint8_t* data, size_t size)
+{
+    // Mark that we are in the context of handlers.
+    beforeCallingHandler(pid);
+    try {
+        // Accumulate the PES header.
+        if (pc.header_size == 0) {
+            ByteBlock& hd(*pc.ts);
+            while (pc.header_size == 0) {
+                // Number of missing bytes to get the fixed part of the header,
+                // then the header data length (long header), then the full header.
+                size_t need = hd.size() < 6 ? 6 - hd.size() : 0;
+                if (need == 0 && IsLongHeaderSID(hd[3])) {
+                    need = hd.size() < 9 ? 9 - hd.size() : 9 + size_t(hd[8]) - hd.size();
+                }
+                if (need == 0) {
+                    pc.header_size = hd.size();
+                }
+                else if (size == 0) {
+                    break;
+                }
+                else {
+                    need = std::min(need, size);
+                    hd.append(data, need);
+                    data += need;
+                    size -= need;
+                }
+            }
+            if (pc.header_size == 0) {
+                // Header not yet complete, wait for next TS packet.
+                afterCallingHandler(true);
+                return;
+            }
+            if (_pes_handler != 0) {
+                PESPacket pp(pc.ts, pid);
+                pp.setFirstTSPacketIndex(pc.first_pkt);
+                pp.setLastTSPacketIndex(pc.last_pkt);
+                _pes_handler->handlePESHeader(*this, pp);
+            }
+        }
+
+        // Accumulate the beginning of the payload until the content can be identified.
+        // A video payload starts with 00 00 01 (MPEG-1/2) or 00 00 00 [00...] 01 (AVC).
+        // An AC-3 payload starts with 0B 77. Wait for a non-zero byte and a few bytes.
+        if (pc.content == CONTENT_UNKNOWN && size > 0) {
+            const size_t kept = pc.ts->size() - pc.header_size;
+            const size_t count = std::min(size, _max_unit_size - kept);
+            pc.ts->append(data, count);
+            data += count;
+            size -= count;
+            bool found = size > 0 || kept + count >= _max_unit_size;
+            for (size_t i = pc.header_size; !found && kept + count >= 4 && i < pc.ts->size(); ++i) {
+                found = (*pc.ts)[i] != 0;
+            }
+            if (found) {
+                identifyStreamingContent(pid, pc);
+            }
+        }
+
+        // Process the rest of the PES payload.
+        switch (pc.content) {
+            case CONTENT_MPEG2:
+            case CONTENT_AVC: {
+                processStreamingVideo(pid, pc, data, size);
+                break;
+            }
+            case CONTENT_AC3:
+            case CONTENT_AUDIO: {
+                // Keep the beginning of the audio frame. Analyze it when enough data are present.
+                const size_t kept = pc.ts->size() - pc.header_size;
+                pc.ts->append(data, std::min(size, _max_unit_size - kept));
+                if (pc.ts->size() - pc.header_size >= _max_unit_size) {
+                    processStreamingAudio(pid, pc);
+                }
+                break;
+            }
+            case CONTENT_UNKNOWN:
+            case CONTENT_OTHER:
+            default: {
+                break;
+            }
+        }
+    }
+    catch (...) {
+        afterCallingHandler(false);
+        throw;
+    }
+    afterCallingHandler(true);
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: terminate the current PES packet.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::endStreamingPES(PID pid, PIDContext& pc)
+{
+    // Ignore incomplete PES headers.
+    if (pc.header_size == 0) {
+        return;
+    }
+
+    // Mark that we are in the context of handlers.
+    beforeCallingHandler(pid);
+    try {
+        // Identify the content of very short PES packets.
+        if (pc.content == CONTENT_UNKNOWN) {
+            identifyStreamingContent(pid, pc);
+        }
+        switch (pc.content) {
+            case CONTENT_MPEG2:
+            case CONTENT_AVC: {
+                // The last unit extends up to the end of the PES payload.
+                if (pc.in_unit) {
+                    appendStreamingUnit(pc, pc.tail, pc.tail_size);
+                    processStreamingUnit(pid, pc);
+                }
+                pc.tail_size = 0;
+                break;
+            }
+            case CONTENT_AC3:
+            case CONTENT_AUDIO: {
+                processStreamingAudio(pid, pc);
+                break;
+            }
+            case CONTENT_UNKNOWN:
+            case CONTENT_OTHER:
+            default: {
+                break;
+            }
+        }
+    }
+    catch (...) {
+        afterCallingHandler(false);
+        throw;
+    }
+    afterCallingHandler(true);
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: identify the content of the PES packet using the
+// beginning of the payload.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::identifyStreamingContent(PID pid, PIDContext& pc)
+{
+    const PESPacket pp(pc.ts, pid);
+    if (!pp.isValid()) {
+        pc.content = CONTENT_OTHER;
+        return;
+    }
+
+    // Count valid PES packets
+    pc.pes_count++;
+
+    if (pp.isMPEG2Video()) {
+        pc.content = CONTENT_MPEG2;
+    }
+    else if (pp.isAVC()) {
+        pc.content = CONTENT_AVC;
+    }
+    else if (pp.isAC3()) {
+        // Count PES packets with potential AC-3 packet.
+        pc.ac3_count++;
+        pc.content = CONTENT_AC3;
+    }
+    else if (IsAudioSID(pp.getStreamId())) {
+        pc.content = CONTENT_AUDIO;
+    }
+    else {
+        pc.content = CONTENT_OTHER;
+    }
+
+    // On video PID's, the kept payload is now scanned like the rest of the PES payload.
+    if (pc.content == CONTENT_MPEG2 || pc.content == CONTENT_AVC) {
+        const ByteBlock payload(pp.payload(), pp.payloadSize());
+        pc.ts->resize(pc.header_size);
+        processStreamingVideo(pid, pc, payload.data(), payload.size());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: scan video data for start codes.
+// The last bytes of each chunk are kept in the tail of the context because
+// they may be the beginning of a start code which continues in the next chunk.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::processStreamingVideo(PID pid, PIDContext& pc, const uint8_t* data, size_t size)
+{
+    uint8_t buf[START_CODE_PREFIX_SIZE - 1 + STREAMING_CHUNK_SIZE];
+
+    while (size > 0) {
+        // Build the chunk to scan: tail of previous chunk, followed by new data.
+        const size_t count = std::min(size, STREAMING_CHUNK_SIZE);
+        const size_t n = pc.tail_size + count;
+        ::memcpy(buf, pc.tail, pc.tail_size);
+        ::memcpy(buf + pc.tail_size, data, count);
+        data += count;
+        size -= count;
+
+        // Offset of the chunk in the PES payload.
+        const size_t base = pc.payload_count - pc.tail_size;
+        pc.payload_count += count;
+
+        for (size_t cur = 0; ; ) {
+            if (!pc.in_unit || pc.content == CONTENT_MPEG2) {
+                // Locate next start code 00 00 01.
+                const uint8_t* p = LocateStartCodePrefix(buf + cur, n - cur);
+                if (p == 0) {
+                    // No start code, keep the last bytes for the next chunk.
+                    const size_t keep = std::min(n - cur, START_CODE_PREFIX_SIZE - 1);
+                    if (pc.in_unit) {
+                        appendStreamingUnit(pc, buf + cur, n - cur - keep);
+                    }
+                    ::memcpy(pc.tail, buf + n - keep, keep);
+                    pc.tail_size = keep;
+                    break;
+                }
+                const size_t next = p - buf;
+                if (pc.in_unit) {
+                    // End of previous MPEG-1/2 video unit.
+                    appendStreamingUnit(pc, buf + cur, next - cur);
+                    processStreamingUnit(pid, pc);
+                }
+                pc.in_unit = true;
+                if (pc.content == CONTENT_MPEG2) {
+                    // The MPEG-1/2 video unit starts with the start code.
+                    pc.unit_offset = base + next;
+                    appendStreamingUnit(pc, p, START_CODE_PREFIX_SIZE);
+                }
+                else {
+                    // The AVC access unit starts after the start code.
+                    pc.unit_offset = base + next + START_CODE_PREFIX_SIZE;
+                }
+                cur = next + START_CODE_PREFIX_SIZE;
+            }
+            else {
+                // Locate the end of the AVC access unit: 00 00 00 or 00 00 01.
+                const uint8_t* p = LocateNALUnitEnd(buf + cur, n - cur);
+                if (p == 0) {
+                    const size_t keep = std::min(n - cur, START_CODE_PREFIX_SIZE - 1);
+                    appendStreamingUnit(pc, buf + cur, n - cur - keep);
+                    ::memcpy(pc.tail, buf + n - keep, keep);
+                    pc.tail_size = keep;
+                    break;
+                }
+                const size_t next = p - buf;
+                appendStreamingUnit(pc, buf + cur, next - cur);
+                processStreamingUnit(pid, pc);
+                cur = next;
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: append data to the current video unit.
+// Only the beginning of the unit is kept.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::appendStreamingUnit(PIDContext& pc, const uint8_t* data, size_t size)
+{
+    const size_t kept = pc.ts->size() - pc.header_size;
+    if (kept < _max_unit_size) {
+        pc.ts->append(data, std::min(size, _max_unit_size - kept));
+    }
+    pc.unit_size += size;
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: process a complete video unit or AVC access unit.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::processStreamingUnit(PID pid, PIDContext& pc)
+{
+    // Build a PES packet object with the PES header and the beginning of the unit as payload.
+    PESPacket pp(pc.ts, pid);
+    pp.setFirstTSPacketIndex(pc.first_pkt);
+    pp.setLastTSPacketIndex(pc.last_pkt);
+    const uint8_t* const pdata = pp.payload();
+    const size_t psize = pp.payloadSize();
+
+    if (pc.content == CONTENT_MPEG2) {
+        // Invoke handler
+        if (_pes_handler != 0) {
+            _pes_handler->handleVideoStartCode(*this, pp, psize > START_CODE_PREFIX_SIZE ? pdata[START_CODE_PREFIX_SIZE] : 0, pc.unit_offset, pc.unit_size);
+        }
+        // Accumulate info from video units to extract video attributes.
+        // If new attributes were found, invoke handler.
+        if (pc.video.moreBinaryData(pdata, psize) && _pes_handler != 0) {
+            _pes_handler->handleNewVideoAttributes(*this, pp, pc.video);
+        }
+    }
+    else {
+        // Invoke handler
+        if (_pes_handler != 0) {
+            _pes_handler->handleAVCAccessUnit(*this, pp, psize > 0 ? (pdata[0] & 0x1F) : 0, pc.unit_offset, pc.unit_size);
+        }
+        // Accumulate info from access units to extract video attributes.
+        // If new attributes were found, invoke handler.
+        if (pc.avc.moreBinaryData(pdata, psize) && _pes_handler != 0) {
+            _pes_handler->handleNewAVCAttributes(*this, pp, pc.avc);
+        }
+    }
+
+    // Drop the unit, keep the PES header.
+    pc.ts->resize(pc.header_size);
+    pc.in_unit = false;
+    pc.unit_offset = 0;
+    pc.unit_size = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming mode: process the beginning of an audio PES payload.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::processStreamingAudio(PID pid, PIDContext& pc)
+{
+    PESPacket pp(pc.ts, pid);
+    pp.setFirstTSPacketIndex(pc.first_pkt);
+    pp.setLastTSPacketIndex(pc.last_pkt);
+
+    // Accumulate info from audio frames to extract audio attributes.
+    // If new attributes were found, invoke handler.
+    if (pc.content == CONTENT_AC3) {
+        if (pc.ac3.moreBinaryData(pp.payload(), pp.payloadSize()) && _pes_handler != 0) {
+            _pes_handler->handleNewAC3Attributes(*this, pp, pc.ac3);
+        }
+    }
+    else if (pc.audio.moreBinaryData(pp.payload(), pp.payloadSize()) && _pes_handler != 0) {
+        _pes_handler->handleNewAudioAttributes(*this, pp, pc.audio);
+    }
+
+    // Nothing more to analyze in this PES packet.
+    pc.content = CONTENT_OTHER;
+    pc.ts->resize(pc.header_size);
+}
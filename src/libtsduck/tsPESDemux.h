@@ -77,6 +77,50 @@ namespace ts {
             _pes_handler = h;
         }
 
+        //!
+        //! Default maximum number of bytes which are kept from each video unit, AVC access unit
+        //! or audio frame in streaming mode.
+        //!
+        static const size_t DEFAULT_MAX_UNIT_SIZE = 1024;
+
+        //!
+        //! Set the streaming mode.
+        //!
+        //! By default, the PES demux accumulates complete PES packets and analyzes them when
+        //! the next PES packet starts. On video PID's with unbounded PES packets, this means
+        //! several hundreds of kilobytes per PID and the analysis happens in bursts.
+        //!
+        //! In streaming mode, the PES packets are never buffered. The PES header, the video
+        //! start codes, the AVC access units and the audio frames are analyzed as soon as
+        //! the TS packets arrive. Only the PES header and the first @a max_unit_size bytes of
+        //! the current video unit or audio frame are kept for each PID. In this mode:
+        //! - PESHandlerInterface::handlePESPacket() is never invoked. PESHandlerInterface::handlePESHeader()
+        //!   is invoked instead when the PES header is complete.
+        //! - In PESHandlerInterface::handleVideoStartCode() and PESHandlerInterface::handleAVCAccessUnit(),
+        //!   the payload of the PES packet contains only the video unit or access unit, truncated to
+        //!   @a max_unit_size bytes. The parameters @a offset and @a size are the offset and the full
+        //!   size of the unit in the complete PES payload.
+        //! - In all attribute handlers, the payload of the PES packet contains only the unit or audio
+        //!   frame where the attributes were found, truncated to @a max_unit_size bytes.
+        //!
+        //! The demux is reset when the mode is changed.
+        //! @param [in] on True to enable the streaming mode, false to return to the default mode.
+        //! @param [in] max_unit_size Maximum number of bytes which are kept from each video unit
+        //! or audio frame in streaming mode. This must be large enough to contain video sequence
+        //! headers and AVC sequence parameter sets.
+        //!
+        void setStreaming(bool on, size_t max_unit_size = DEFAULT_MAX_UNIT_SIZE);
+
+        //!
+        //! Check if the demux is in streaming mode.
+        //! @return True if the demux is in streaming mode.
+        //! @see setStreaming()
+        //!
+        bool isStreaming() const
+        {
+            return _streaming;
+        }
+
         //!
         //! Get the current audio attributes on the specified PID.
         //! @param [in] pid The PID to check.
@@ -126,6 +170,16 @@ namespace ts {
         virtual void immediateResetPID(PID pid) override;
 
     private:
+        // Type of content of the current PES packet, in streaming mode.
+        enum StreamContent {
+            CONTENT_UNKNOWN,  // PES header not complete or content not yet identified
+            CONTENT_MPEG2,    // MPEG-1 or MPEG-2 video
+            CONTENT_AVC,      // AVC video
+            CONTENT_AC3,      // AC-3 audio
+            CONTENT_AUDIO,    // Other audio
+            CONTENT_OTHER     // Nothing more to analyze in this PES packet
+        };
+
         // This internal structure contains the analysis context for one PID.
         struct PIDContext
         {
@@ -141,11 +195,25 @@ namespace ts {
             AC3Attributes ac3;       // Current AC-3 attributes
             PacketCounter ac3_count; // Number of PES packets with contents which looks like AC-3
 
+            // Streaming mode only. The buffer "ts" contains the PES header, followed by the
+            // first bytes of the current video unit or audio frame.
+            StreamContent content;   // Type of content of the current PES packet
+            size_t header_size;      // PES header size, zero until the PES header is complete
+            size_t payload_count;    // Number of PES payload bytes scanned so far (video)
+            bool   in_unit;          // A video unit or AVC access unit is in progress
+            size_t unit_offset;      // Offset of the current unit in the PES payload
+            size_t unit_size;        // Current size of the current unit (may be larger than what is kept)
+            size_t tail_size;        // Number of bytes in tail
+            uint8_t tail[2];         // Last bytes of previous TS payload, possible start of a start code
+
             // Default constructor:
             PIDContext();
 
             // Called when packet synchronization is lost on the pid
-            void syncLost() {sync = false; ts->clear();}
+            void syncLost() {sync = false; ts->clear(); resetStreaming();}
+
+            // Reset the streaming state at the beginning of a PES packet.
+            void resetStreaming();
         };
 
         typedef std::map <PID, PIDContext> PIDContextMap;
@@ -156,10 +224,23 @@ namespace ts {
         // Process a complete PES packet
         void processPESPacket(PID, PIDContext&);
 
+        // Streaming mode: process a part of the current PES packet, terminate the current PES packet.
+        void processStreamingData(PID, PIDContext&, const uint8_t* data, size_t size);
+        void endStreamingPES(PID, PIDContext&);
+
+        // Streaming mode, called from the two previous methods only (handlers already protected).
+        void identifyStreamingContent(PID, PIDContext&);
+        void processStreamingVideo(PID, PIDContext&, const uint8_t* data, size_t size);
+        void appendStreamingUnit(PIDContext&, const uint8_t* data, size_t size);
+        void processStreamingUnit(PID, PIDContext&);
+        void processStreamingAudio(PID, PIDContext&);
+
         // Private members:
         PESHandlerInterface* _pes_handler;
         PIDContextMap        _pids;
         PacketCounter        _packet_count;    // number of TS packets in demultiplexed stream
+        bool                 _streaming;       // streaming mode, never buffer complete PES packets
+        size_t               _max_unit_size;   // maximum kept size of video units and audio frames in streaming mode
 
         // Inacessible operations
         PESDemux(const PESDemux&) = delete;
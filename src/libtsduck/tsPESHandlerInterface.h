@@ -57,6 +57,15 @@ namespace ts {
         //!
         virtual void handlePESPacket(PESDemux& demux, const PESPacket& packet) {}
 
+        //!
+        //! This hook is invoked in streaming mode when the header of a PES packet is complete.
+        //! The rest of the PES packet is not yet available.
+        //! @param [in,out] demux A reference to the PES demux.
+        //! @param [in] packet The PES packet, containing the PES header only (empty payload).
+        //! @see PESDemux::setStreaming()
+        //!
+        virtual void handlePESHeader(PESDemux& demux, const PESPacket& packet) {}
+
         //!
         //! This hook is invoked when a video start code is encountered.
         //! @param [in,out] demux A reference to the PES demux.
@@ -223,6 +223,62 @@ bool ts::PESPacket::operator== (const PESPacket& pp) const
 }
 
 
+//----------------------------------------------------------------------------
+// Offset of PTS and DTS in the packet. Return 0 if there is none.
+//----------------------------------------------------------------------------
+
+size_t ts::PESPacket::PTSOffset() const
+{
+    if (!hasLongHeader() || _header_size < 14) {
+        return 0;
+    }
+    const uint8_t* const h = _data->data();
+    const uint8_t pts_dts_flags = h[7] >> 6;
+    if ((pts_dts_flags & 0x02) == 0 ||
+        (pts_dts_flags == 0x02 && (h[9] & 0xF1) != 0x21) ||
+        (pts_dts_flags == 0x03 && (h[9] & 0xF1) != 0x31) ||
+        (h[11] & 0x01) != 0x01 ||
+        (h[13] & 0x01) != 0x01) {
+        return 0;
+    }
+    return 9;
+}
+
+size_t ts::PESPacket::DTSOffset() const
+{
+    if (!hasLongHeader() || _header_size < 19) {
+        return 0;
+    }
+    const uint8_t* const h = _data->data();
+    if ((h[7] & 0xC0) != 0xC0 ||
+        (h[9] & 0xF1) != 0x31 ||
+        (h[11] & 0x01) != 0x01 ||
+        (h[13] & 0x01) != 0x01 ||
+        (h[14] & 0xF1) != 0x11 ||
+        (h[16] & 0x01) != 0x01 ||
+        (h[18] & 0x01) != 0x01) {
+        return 0;
+    }
+    return 14;
+}
+
+
+//----------------------------------------------------------------------------
+// Get PTS or DTS at specified offset. Return 0 if offset is zero.
+//----------------------------------------------------------------------------
+
+uint64_t ts::PESPacket::getPDTS(size_t offset) const
+{
+    if (offset == 0) {
+        return 0;
+    }
+    else {
+        const uint8_t* const h = _data->data() + offset;
+        return (uint64_t(h[0] & 0x0E) << 29) | (uint64_t(GetUInt16(h + 1) & 0xFFFE) << 14) | (uint64_t(GetUInt16(h + 3)) >> 1);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Check if the PES packet contains MPEG-2 video (also applies to MPEG-1 video)
 //----------------------------------------------------------------------------
@@ -327,6 +327,42 @@ namespace ts {
             return _is_valid ? _data->size() - _header_size : 0;
         }
 
+        //!
+        //! Check if the PES header contains a Presentation Time Stamp (PTS).
+        //! @return True if the PES header contains a PTS.
+        //!
+        bool hasPTS() const
+        {
+            return PTSOffset() > 0;
+        }
+
+        //!
+        //! Check if the PES header contains a Decoding Time Stamp (DTS).
+        //! @return True if the PES header contains a DTS.
+        //!
+        bool hasDTS() const
+        {
+            return DTSOffset() > 0;
+        }
+
+        //!
+        //! Get the PTS - 33 bits.
+        //! @return The PTS or 0 if not found.
+        //!
+        uint64_t getPTS() const
+        {
+            return getPDTS(PTSOffset());
+        }
+
+        //!
+        //! Get the DTS - 33 bits.
+        //! @return The DTS or 0 if not found.
+        //!
+        uint64_t getDTS() const
+        {
+            return getPDTS(DTSOffset());
+        }
+
         //!
         //! Check if the PES packet contains MPEG-2 video.
         //! Also applies to MPEG-1 video.
@@ -367,6 +403,13 @@ namespace ts {
         // Initialize from a binary content.
         void initialize(const ByteBlockPtr&);
 
+        // Offset of PTS and DTS in the packet, zero if there is none.
+        size_t PTSOffset() const;
+        size_t DTSOffset() const;
+
+        // Get PTS or DTS at specified offset. Return 0 if offset is zero.
+        uint64_t getPDTS(size_t offset) const;
+
         // Inaccessible operations
         PESPacket(const PESPacket&) = delete;
     };
@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Pacing of TS packets at a given bitrate.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPacketPacer.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const ts::NanoSecond ts::PacketPacer::PRECISION;
+const ts::NanoSecond ts::PacketPacer::MAX_LATE;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::PacketPacer::PacketPacer() :
+    _next_send(),
+    _next_valid(false)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Wait until the next group of packets is due.
+//----------------------------------------------------------------------------
+
+size_t ts::PacketPacer::wait(BitRate bitrate, size_t packet_count, size_t group)
+{
+    assert(bitrate > 0);
+    group = std::max<size_t>(1, group);
+
+    Monotonic now;
+    now.getSystemTime();
+
+    // Start a new paced sequence the first time or when we are too late,
+    // after a stall of the input for instance.
+    if (!_next_valid || now - _next_send > MAX_LATE) {
+        _next_send = now;
+        _next_valid = true;
+    }
+
+    // Wait until the next group is due.
+    if (_next_send - now > PRECISION) {
+        _next_send.wait();
+        now = _next_send;
+    }
+
+    // Return all groups which are due now, including the ones within the timer precision.
+    const NanoSecond group_duration = (NanoSecPerSec * PKT_SIZE * 8 * NanoSecond(group)) / bitrate;
+    const NanoSecond late = now - _next_send + PRECISION;
+    const size_t group_count = late <= 0 ? 1 : size_t(1 + late / std::max<NanoSecond>(1, group_duration));
+    const size_t count = std::min(packet_count, group_count * group);
+
+    // Due time of next group.
+    _next_send += (NanoSecPerSec * PKT_SIZE * 8 * NanoSecond(count)) / bitrate;
+    return count;
+}
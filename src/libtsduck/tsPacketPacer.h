@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Pacing of TS packets at a given bitrate.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMonotonic.h"
+#include "tsMPEG.h"
+
+namespace ts {
+    //!
+    //! Pacing of TS packets at a given bitrate.
+    //!
+    //! The packets are sent by groups of a fixed number of packets, for instance one
+    //! UDP message. The due time of each group is computed from the bitrate as an
+    //! absolute monotonic deadline, so that timer inaccuracies do not accumulate.
+    //! The groups which are due within the timer precision are sent together. When
+    //! the application is late by more than a maximum lateness (after an input stall
+    //! for instance), the pacing restarts instead of catching up with a large burst.
+    //!
+    class TSDUCKDLL PacketPacer
+    {
+    public:
+        //!
+        //! Groups which are due within this precision are sent together (50 micro-seconds).
+        //!
+        static const NanoSecond PRECISION = 50000;
+
+        //!
+        //! Maximum lateness before the pacing restarts (100 milli-seconds).
+        //!
+        static const NanoSecond MAX_LATE = 100000000;
+
+        //!
+        //! Default constructor.
+        //!
+        PacketPacer();
+
+        //!
+        //! Restart the pacing. The next group of packets is due immediately.
+        //!
+        void reset()
+        {
+            _next_valid = false;
+        }
+
+        //!
+        //! Wait until the next group of packets is due.
+        //! The due time of the next group is updated, assuming that the returned
+        //! packets are immediately sent.
+        //! @param [in] bitrate Bitrate in bits/second. Must not be zero.
+        //! @param [in] packet_count Number of packets which remain to be sent.
+        //! @param [in] group Number of packets in a group.
+        //! @return Number of packets to send now: one or more groups which are due,
+        //! at most @a packet_count. A shorter last group is accounted on its actual size.
+        //!
+        size_t wait(BitRate bitrate, size_t packet_count, size_t group);
+
+    private:
+        Monotonic _next_send;   // Due time of next group.
+        bool      _next_valid;  // _next_send is valid.
+    };
+}
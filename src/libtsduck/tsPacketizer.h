@@ -166,6 +166,9 @@ namespace ts {
         virtual std::ostream& display(std::ostream& strm) const;
 
     private:
+        // CyclingPacketizer replays complete cycles and maintains the counters itself.
+        friend class CyclingPacketizer;
+
         // Private members:
         SectionProviderInterface* _provider;
         PID            _pid;
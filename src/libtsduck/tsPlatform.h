@@ -540,6 +540,7 @@
 #include <sched.h>
 #include <semaphore.h>
 #include <signal.h>
+#include <poll.h>
 #include <dlfcn.h>
 #include <pwd.h>
 
@@ -76,6 +76,28 @@ ts::ProcessorPlugin::ProcessorPlugin(TSP* tsp_,
 }
 
 
+//----------------------------------------------------------------------------
+// Default packet batch processing: process packets one by one.
+//----------------------------------------------------------------------------
+
+size_t ts::ProcessorPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    for (size_t n = 0; n < count; ++n) {
+        if (mdata[n].getDropped()) {
+            // Already dropped by a previous plugin.
+            status[n] = TSP_DROP;
+        }
+        else {
+            status[n] = processPacket(pkts[n], flush, bitrate_changed);
+            if (flush || status[n] == TSP_END) {
+                return n + 1;
+            }
+        }
+    }
+    return count;
+}
+
+
 //----------------------------------------------------------------------------
 // Report implementation.
 //----------------------------------------------------------------------------
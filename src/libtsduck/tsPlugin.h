@@ -37,6 +37,7 @@
 #include "tsAbortInterface.h"
 #include "tsReport.h"
 #include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
 
 namespace ts {
 
@@ -84,7 +85,7 @@ namespace ts {
         //! @c int data named @c tspInterfaceVersion which contains the current
         //! interface version at the time the library is built.
         //!
-        static const int API_VERSION = 5;
+        static const int API_VERSION = 6;
 
         //!
         //! Get the current input bitrate in bits/seconds.
@@ -408,6 +409,32 @@ namespace ts {
         //!
         virtual Status processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed) = 0;
 
+        //!
+        //! Packet batch processing interface.
+        //!
+        //! The main application invokes processPacketBatch() to let the shared
+        //! library process a contiguous array of TS packets. The default
+        //! implementation invokes processPacket() on each packet. Simple plugins
+        //! may override it to process the array in one single loop.
+        //!
+        //! Each packet comes with its metadata, in a parallel array. Packets which were
+        //! dropped by a previous plugin are marked as such in their metadata. They must
+        //! not be processed and their status must be TSP_DROP.
+        //! The processing of the array must stop after a packet which sets @a flush
+        //! or which returns TSP_END.
+        //!
+        //! @param [in,out] pkts Address of the first TS packet to process.
+        //! @param [in,out] mdata Address of the metadata of the first TS packet to process.
+        //! There are @a count elements, @a mdata[i] is the metadata of @a pkts[i].
+        //! @param [in] count Number of packets in @a pkts. Never zero.
+        //! @param [out] status Array of @a count processing status, one per packet.
+        //! @param [in,out] flush Initially set to false. Same as in processPacket().
+        //! @param [in,out] bitrate_changed Initially set to false. Same as in processPacket().
+        //! @return The number of processed packets, in the range 1 to @a count.
+        //! Only the first returned number of elements in @a status are significant.
+        //!
+        virtual size_t processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed);
+
         //!
         //! Constructor.
         //!
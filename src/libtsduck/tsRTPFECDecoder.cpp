@@ -0,0 +1,297 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  SMPTE 2022-1 FEC decoder for RTP streams.
+//
+//----------------------------------------------------------------------------
+
+#include "tsRTPFECDecoder.h"
+#include "tsMemoryUtils.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::RTPFECDecoder::DEFAULT_HISTORY;
+const size_t ts::RTPFECDecoder::MAX_PENDING;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::RTPFECDecoder::RTPFECDecoder(size_t history) :
+    _history(),
+    _last_valid(false),
+    _last_seq(0),
+    _pending(),
+    _recovered(),
+    _recovered_count(0)
+{
+    // Round the history size to a power of two, so that sequence numbers wrap consistently.
+    size_t size = 1;
+    while (size < history && size < 0x8000) {
+        size *= 2;
+    }
+    _history.resize(size);
+}
+
+
+//----------------------------------------------------------------------------
+// Reset the decoding state.
+//----------------------------------------------------------------------------
+
+void ts::RTPFECDecoder::reset()
+{
+    for (MediaVector::iterator it = _history.begin(); it != _history.end(); ++it) {
+        it->valid = false;
+    }
+    _last_valid = false;
+    _last_seq = 0;
+    _pending.clear();
+    _recovered.clear();
+    _recovered_count = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Check the content of the history.
+//----------------------------------------------------------------------------
+
+bool ts::RTPFECDecoder::hasMedia(uint16_t seq) const
+{
+    const Media& media(_history[seq & (_history.size() - 1)]);
+    return media.valid && media.seq == seq;
+}
+
+bool ts::RTPFECDecoder::isObsolete(uint16_t seq) const
+{
+    return _last_valid && int16_t(uint16_t(_last_seq - seq)) >= int(_history.size());
+}
+
+
+//----------------------------------------------------------------------------
+// Process a received media RTP packet.
+//----------------------------------------------------------------------------
+
+void ts::RTPFECDecoder::addMedia(uint16_t seq, uint8_t pt, uint32_t timestamp, const void* payload, size_t size)
+{
+    if (!_last_valid || int16_t(uint16_t(seq - _last_seq)) > 0) {
+        _last_valid = true;
+        _last_seq = seq;
+    }
+
+    // Ignore duplicated and previously recovered packets.
+    Media& media(slot(seq));
+    if (media.valid && media.seq == seq) {
+        return;
+    }
+    media.valid = true;
+    media.seq = seq;
+    media.pt = pt & 0x7F;
+    media.timestamp = timestamp;
+    media.payload.copy(payload, size);
+
+    // A late media packet may unlock pending FEC packets.
+    if (!_pending.empty()) {
+        recoverPending();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a received FEC packet.
+//----------------------------------------------------------------------------
+
+bool ts::RTPFECDecoder::addFEC(const void* packet, size_t size)
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(packet);
+
+    // Skip the RTP header, including CSRC identifiers and optional header extension.
+    if (size < RTP_HEADER_SIZE || (data[0] & 0xC0) != 0x80) {
+        return false;
+    }
+    size_t header = RTP_HEADER_SIZE + 4 * (data[0] & 0x0F);
+    if ((data[0] & 0x10) != 0) {
+        if (header + 4 > size) {
+            return false;
+        }
+        header += 4 + 4 * size_t(GetUInt16(data + header + 2));
+    }
+    if (header + FEC_HEADER_SIZE > size) {
+        return false;
+    }
+    data += header;
+    size -= header;
+
+    // Only the XOR type without extension is defined in SMPTE 2022-1.
+    FEC fec;
+    fec.snbase = GetUInt16(data);
+    fec.length = GetUInt16(data + 2);
+    fec.pt = data[4] & 0x7F;
+    fec.timestamp = GetUInt32(data + 8);
+    fec.offset = data[13];
+    fec.count = data[14];
+    if ((data[12] & 0xB8) != 0 || fec.offset == 0 || fec.count == 0) {
+        return false;
+    }
+    fec.payload.copy(data + FEC_HEADER_SIZE, size - FEC_HEADER_SIZE);
+
+    // Try to recover immediately, keep it for later otherwise.
+    if (recover(fec)) {
+        if (!_recovered.empty()) {
+            recoverPending();
+        }
+    }
+    else {
+        if (_pending.size() >= MAX_PENDING) {
+            _pending.pop_front();
+        }
+        _pending.push_back(FEC());
+        _pending.back().snbase = fec.snbase;
+        _pending.back().offset = fec.offset;
+        _pending.back().count = fec.count;
+        _pending.back().length = fec.length;
+        _pending.back().pt = fec.pt;
+        _pending.back().timestamp = fec.timestamp;
+        _pending.back().payload.swap(fec.payload);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Try to recover a media packet from an FEC packet.
+// Return true when the FEC packet is no longer useful.
+//----------------------------------------------------------------------------
+
+bool ts::RTPFECDecoder::recover(const FEC& fec)
+{
+    // Too old or too large for the history, cannot be used.
+    if (isObsolete(fec.snbase) || size_t(fec.count - 1) * fec.offset >= _history.size()) {
+        return true;
+    }
+
+    // Count missing media packets.
+    size_t missing_count = 0;
+    uint16_t missing = 0;
+    for (size_t i = 0; i < fec.count; ++i) {
+        const uint16_t seq = uint16_t(fec.snbase + i * fec.offset);
+        if (!hasMedia(seq)) {
+            missing = seq;
+            if (++missing_count > 1) {
+                // Cannot recover now, maybe later.
+                return false;
+            }
+        }
+    }
+    if (missing_count == 0) {
+        // Nothing to recover.
+        return true;
+    }
+
+    // A packet which is more recent than the last received media packet is probably
+    // not lost yet, the FEC packet was received first. Wait for the next media packets.
+    if (!_last_valid || int16_t(uint16_t(_last_seq - missing)) <= 0) {
+        return false;
+    }
+
+    // Rebuild the missing packet: exclusive OR of the FEC recovery fields and all other media packets.
+    Media& media(slot(missing));
+    media.payload = fec.payload;
+    media.pt = fec.pt;
+    media.timestamp = fec.timestamp;
+    uint16_t length = fec.length;
+    for (size_t i = 0; i < fec.count; ++i) {
+        const uint16_t seq = uint16_t(fec.snbase + i * fec.offset);
+        if (seq != missing) {
+            const Media& other(slot(seq));
+            length ^= uint16_t(other.payload.size());
+            media.pt ^= other.pt;
+            media.timestamp ^= other.timestamp;
+            MemXor(media.payload.data(), media.payload.data(), other.payload.data(), std::min(other.payload.size(), media.payload.size()));
+        }
+    }
+
+    // The recovered length cannot be larger than the FEC payload.
+    if (length > media.payload.size()) {
+        media.valid = false;
+        return true;
+    }
+    media.payload.resize(length);
+    media.valid = true;
+    media.seq = missing;
+    _recovered.push_back(missing);
+    _recovered_count++;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Retry all pending FEC packets until no more recovery is possible.
+//----------------------------------------------------------------------------
+
+void ts::RTPFECDecoder::recoverPending()
+{
+    bool more = true;
+    while (more) {
+        const size_t before = _recovered_count;
+        for (FECList::iterator it = _pending.begin(); it != _pending.end(); ) {
+            if (recover(*it)) {
+                it = _pending.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        more = _recovered_count > before;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next recovered media packet.
+//----------------------------------------------------------------------------
+
+bool ts::RTPFECDecoder::getRecovered(uint16_t& seq, uint8_t& pt, uint32_t& timestamp, const uint8_t*& payload, size_t& size)
+{
+    while (!_recovered.empty()) {
+        seq = _recovered.front();
+        _recovered.pop_front();
+        // The slot may have been reused by a more recent packet.
+        if (hasMedia(seq)) {
+            const Media& media(slot(seq));
+            pt = media.pt;
+            timestamp = media.timestamp;
+            payload = media.payload.data();
+            size = media.payload.size();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  SMPTE 2022-1 FEC decoder for RTP streams.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+#include "tsByteBlock.h"
+
+namespace ts {
+    //!
+    //! SMPTE 2022-1 FEC decoder for RTP streams.
+    //!
+    //! The payloads of the last received media packets are kept in a history
+    //! buffer. When an FEC packet is received and exactly one of the media
+    //! packets it protects is missing, the missing payload is rebuilt. The
+    //! recovered packet may in turn complete another row or column (2D FEC).
+    //! FEC packets which protect more than one missing packet are kept until
+    //! other FEC packets or late media packets make the recovery possible.
+    //!
+    //! The payload, payload length, payload type and time stamp of the missing
+    //! media packets are recovered from the corresponding recovery fields of
+    //! the FEC header. The structure of the FEC matrix does not need to be
+    //! known, each FEC packet describes the media packets it protects.
+    //!
+    //! The payload of each received media packet is copied once in the history
+    //! buffer because the caller's receive buffer is reused for the next packets.
+    //! Recovered packets are returned from the history buffer, without copy.
+    //!
+    //! @see SMPTE 2022-1, Forward Error Correction for Real-Time Video/Audio Transport over IP Networks.
+    //! @see RTPFECEncoder
+    //!
+    class TSDUCKDLL RTPFECDecoder
+    {
+    public:
+        //!
+        //! Default number of media packets in the history buffer.
+        //! This is enough for the largest FEC matrix when the column FEC packets
+        //! are sent during the next matrix.
+        //!
+        static const size_t DEFAULT_HISTORY = 512;
+
+        //!
+        //! Maximum number of FEC packets which are kept while waiting for more media packets.
+        //!
+        static const size_t MAX_PENDING = 2 * (FEC_MAX_COLUMNS + FEC_MAX_ROWS);
+
+        //!
+        //! Constructor.
+        //! @param [in] history Number of media packets in the history buffer.
+        //! Rounded up to a power of two.
+        //!
+        RTPFECDecoder(size_t history = DEFAULT_HISTORY);
+
+        //!
+        //! Reset the decoding state.
+        //!
+        void reset();
+
+        //!
+        //! Process a received media RTP packet.
+        //! @param [in] seq RTP sequence number of the media packet.
+        //! @param [in] pt RTP payload type of the media packet.
+        //! @param [in] timestamp RTP time stamp of the media packet.
+        //! @param [in] payload Address of the RTP payload of the media packet.
+        //! @param [in] size Size in bytes of the RTP payload.
+        //!
+        void addMedia(uint16_t seq, uint8_t pt, uint32_t timestamp, const void* payload, size_t size);
+
+        //!
+        //! Process a received FEC packet, from a column or row FEC flow.
+        //! @param [in] packet Address of the complete FEC packet, including RTP header.
+        //! @param [in] size Size in bytes of the FEC packet.
+        //! @return True if this is a valid FEC packet, false otherwise.
+        //!
+        bool addFEC(const void* packet, size_t size);
+
+        //!
+        //! Get the next recovered media packet.
+        //! @param [out] seq RTP sequence number of the recovered media packet.
+        //! @param [out] pt RTP payload type of the recovered media packet.
+        //! @param [out] timestamp RTP time stamp of the recovered media packet.
+        //! @param [out] payload Address of the RTP payload of the recovered media packet.
+        //! The payload remains valid until the next call to addMedia() or addFEC().
+        //! @param [out] size Size in bytes of the RTP payload.
+        //! @return True if a packet is returned, false if there is no recovered packet.
+        //!
+        bool getRecovered(uint16_t& seq, uint8_t& pt, uint32_t& timestamp, const uint8_t*& payload, size_t& size);
+
+        //!
+        //! Get the total number of recovered media packets.
+        //! @return The total number of recovered media packets since the last reset().
+        //!
+        PacketCounter recoveredCount() const {return _recovered_count;}
+
+    private:
+        // A media packet in the history buffer.
+        struct Media
+        {
+            Media() : valid(false), seq(0), pt(0), timestamp(0), payload() {}
+            bool      valid;     // Slot contains a media packet
+            uint16_t  seq;       // Sequence number
+            uint8_t   pt;        // Payload type
+            uint32_t  timestamp; // Time stamp
+            ByteBlock payload;   // Media payload
+        };
+
+        // A pending FEC packet.
+        struct FEC
+        {
+            FEC() : snbase(0), offset(0), count(0), length(0), pt(0), timestamp(0), payload() {}
+            uint16_t  snbase;    // Sequence number of first media packet
+            uint16_t  offset;    // Distance between protected media packets
+            uint16_t  count;     // Number of protected media packets
+            uint16_t  length;    // Length recovery
+            uint8_t   pt;        // Payload type recovery
+            uint32_t  timestamp; // Time stamp recovery
+            ByteBlock payload;   // Payload recovery
+        };
+
+        typedef std::vector<Media> MediaVector;
+        typedef std::list<FEC> FECList;
+
+        MediaVector          _history;          // Media packets, indexed by sequence number modulo size
+        bool                 _last_valid;       // _last_seq is valid
+        uint16_t             _last_seq;         // Most recent sequence number
+        FECList              _pending;          // FEC packets waiting for more media packets
+        std::deque<uint16_t> _recovered;        // Sequence numbers of recovered packets, not yet returned
+        PacketCounter        _recovered_count;  // Total number of recovered packets
+
+        // Get the history slot for a sequence number and check if it contains this media packet.
+        Media& slot(uint16_t seq) {return _history[seq & (_history.size() - 1)];}
+        bool hasMedia(uint16_t seq) const;
+
+        // Check if a sequence number is too old to be in the history.
+        bool isObsolete(uint16_t seq) const;
+
+        // Try to recover a media packet from an FEC packet.
+        // Return true when the FEC packet is no longer useful.
+        bool recover(const FEC& fec);
+
+        // Retry all pending FEC packets until no more recovery is possible.
+        void recoverPending();
+    };
+}
@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  SMPTE 2022-1 FEC encoder for RTP streams.
+//
+//----------------------------------------------------------------------------
+
+#include "tsRTPFECEncoder.h"
+#include "tsMemoryUtils.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructors.
+//----------------------------------------------------------------------------
+
+ts::RTPFECEncoder::RTPFECEncoder() :
+    _columns(0),
+    _rows(0),
+    _row_fec(false),
+    _index(0),
+    _col_seq(0),
+    _row_seq(0),
+    _col_groups(),
+    _row_group(),
+    _col_pending(),
+    _col_ready(),
+    _row_ready()
+{
+}
+
+ts::RTPFECEncoder::Group::Group() :
+    snbase(0),
+    length(0),
+    pt(0),
+    timestamp(0),
+    last_time(0),
+    payload()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Set the FEC matrix.
+//----------------------------------------------------------------------------
+
+bool ts::RTPFECEncoder::setMatrix(size_t columns, size_t rows, bool row_fec, Report& report)
+{
+    // Check the limits from SMPTE 2022-1. With 2D FEC, there are at least 4 columns.
+    if (columns > 0 && (columns > FEC_MAX_COLUMNS || (row_fec && columns < FEC_MIN_ROWS) ||
+                        rows < FEC_MIN_ROWS || rows > FEC_MAX_ROWS || columns * rows > FEC_MAX_MATRIX))
+    {
+        report.error(u"invalid FEC matrix, %d columns, %d rows", {columns, rows});
+        return false;
+    }
+
+    _columns = columns;
+    _rows = columns == 0 ? 0 : rows;
+    _row_fec = columns > 0 && row_fec;
+    _col_groups.resize(_columns);
+    reset();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Reset the encoding state.
+//----------------------------------------------------------------------------
+
+void ts::RTPFECEncoder::reset()
+{
+    _index = 0;
+    _col_pending.clear();
+    _col_ready.clear();
+    _row_ready.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Process one media RTP packet.
+//----------------------------------------------------------------------------
+
+void ts::RTPFECEncoder::addMedia(uint16_t seq, uint8_t pt, uint32_t timestamp, const void* payload, size_t size)
+{
+    if (_columns == 0) {
+        return;
+    }
+
+    const size_t col = _index % _columns;
+    const size_t row = _index / _columns;
+
+    // Start new column groups on the first row, a new row group on the first column.
+    if (row == 0) {
+        _col_groups[col].start(seq);
+    }
+    if (col == 0) {
+        _row_group.start(seq);
+    }
+
+    _col_groups[col].add(pt, timestamp, payload, size);
+    if (_row_fec) {
+        _row_group.add(pt, timestamp, payload, size);
+    }
+
+    // End of row.
+    if (_row_fec && col == _columns - 1) {
+        _row_ready.push_back(ByteBlock());
+        _row_group.build(_row_ready.back(), _row_seq++, true, 1, _columns);
+    }
+
+    // Release one column FEC packet of the previous matrix every D media packets.
+    if (++_index % _rows == 0 && !_col_pending.empty()) {
+        _col_ready.splice(_col_ready.end(), _col_pending, _col_pending.begin());
+    }
+
+    // End of matrix: build all column FEC packets.
+    if (_index == _columns * _rows) {
+        // Should be empty: one column FEC packet is released every D media packets.
+        _col_ready.splice(_col_ready.end(), _col_pending);
+        for (size_t i = 0; i < _columns; ++i) {
+            _col_pending.push_back(ByteBlock());
+            _col_groups[i].build(_col_pending.back(), _col_seq++, false, _columns, _rows);
+        }
+        _index = 0;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next FEC packets to send.
+//----------------------------------------------------------------------------
+
+bool ts::RTPFECEncoder::getColumnFEC(ByteBlock& packet)
+{
+    if (_col_ready.empty()) {
+        return false;
+    }
+    packet.swap(_col_ready.front());
+    _col_ready.pop_front();
+    return true;
+}
+
+bool ts::RTPFECEncoder::getRowFEC(ByteBlock& packet)
+{
+    if (_row_ready.empty()) {
+        return false;
+    }
+    packet.swap(_row_ready.front());
+    _row_ready.pop_front();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Protection group.
+//----------------------------------------------------------------------------
+
+void ts::RTPFECEncoder::Group::start(uint16_t seq)
+{
+    snbase = seq;
+    length = 0;
+    pt = 0;
+    timestamp = 0;
+    payload.clear();
+}
+
+void ts::RTPFECEncoder::Group::add(uint8_t pt_, uint32_t timestamp_, const void* payload_, size_t size)
+{
+    // The recovery fields are the exclusive OR of the media fields.
+    length ^= uint16_t(size);
+    pt ^= pt_;
+    timestamp ^= timestamp_;
+    last_time = timestamp_;
+
+    // Shorter payloads are padded with zeroes.
+    if (payload.size() < size) {
+        payload.resize(size, 0);
+    }
+    MemXor(payload.data(), payload.data(), payload_, size);
+}
+
+void ts::RTPFECEncoder::Group::build(ByteBlock& packet, uint16_t seq, bool row, size_t offset, size_t count) const
+{
+    packet.resize(RTP_HEADER_SIZE + FEC_HEADER_SIZE + payload.size());
+    uint8_t* data = packet.data();
+
+    // RTP header: version 2, no padding, no extension, no CSRC, no marker, SSRC zero.
+    data[0] = 0x80;
+    data[1] = RTP_PT_FEC;
+    PutUInt16(data + 2, seq);
+    PutUInt32(data + 4, last_time);
+    PutUInt32(data + 8, 0);
+    data += RTP_HEADER_SIZE;
+
+    // FEC header: E=1, mask=0, X=0, type=XOR, index=0, SNBase extension=0.
+    PutUInt16(data, snbase);
+    PutUInt16(data + 2, length);
+    data[4] = 0x80 | (pt & 0x7F);
+    data[5] = data[6] = data[7] = 0;
+    PutUInt32(data + 8, timestamp);
+    data[12] = row ? 0x40 : 0x00;
+    data[13] = uint8_t(offset);
+    data[14] = uint8_t(count);
+    data[15] = 0;
+    data += FEC_HEADER_SIZE;
+
+    ::memcpy(data, payload.data(), payload.size());
+}
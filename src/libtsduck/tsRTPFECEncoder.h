@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  SMPTE 2022-1 FEC encoder for RTP streams.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+#include "tsByteBlock.h"
+#include "tsReport.h"
+#include "tsCerrReport.h"
+
+namespace ts {
+    //!
+    //! SMPTE 2022-1 FEC encoder for RTP streams.
+    //!
+    //! The media RTP packets are logically arranged in a matrix of L columns and
+    //! D rows. One column FEC packet is generated per column of the matrix and,
+    //! optionally, one row FEC packet per row. Each FEC packet contains the
+    //! exclusive OR of the payloads of the media packets it protects. When one
+    //! media packet is lost in a column or a row, the receiver can rebuild it.
+    //!
+    //! The column FEC packets of a matrix are released one by one while the
+    //! next matrix is processed, to avoid bursts on the network. The row FEC
+    //! packet of a row is released as soon as the row is complete.
+    //!
+    //! The column FEC packets are normally sent on the UDP port of the media
+    //! flow plus 2 and the row FEC packets on the UDP port plus 4.
+    //!
+    //! @see SMPTE 2022-1, Forward Error Correction for Real-Time Video/Audio Transport over IP Networks.
+    //! @see RTPFECDecoder
+    //!
+    class TSDUCKDLL RTPFECEncoder
+    {
+    public:
+        //!
+        //! Constructor.
+        //! FEC generation is disabled until setMatrix() is called.
+        //!
+        RTPFECEncoder();
+
+        //!
+        //! Set the FEC matrix and reset the encoding state.
+        //! @param [in] columns Number of columns (L parameter). Zero disables FEC generation.
+        //! @param [in] rows Number of rows (D parameter).
+        //! @param [in] row_fec If true, also generate row FEC packets (2D FEC).
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false if the matrix is invalid.
+        //!
+        bool setMatrix(size_t columns, size_t rows, bool row_fec, Report& report = CERR);
+
+        //!
+        //! Check if FEC generation is enabled.
+        //! @return True if FEC generation is enabled.
+        //!
+        bool isEnabled() const {return _columns > 0;}
+
+        //!
+        //! Get the number of columns in the FEC matrix (L parameter).
+        //! @return The number of columns in the FEC matrix.
+        //!
+        size_t columns() const {return _columns;}
+
+        //!
+        //! Get the number of rows in the FEC matrix (D parameter).
+        //! @return The number of rows in the FEC matrix.
+        //!
+        size_t rows() const {return _rows;}
+
+        //!
+        //! Check if row FEC packets are generated (2D FEC).
+        //! @return True if row FEC packets are generated.
+        //!
+        bool rowFEC() const {return _row_fec;}
+
+        //!
+        //! Reset the encoding state. The next media packet starts a new matrix.
+        //! All pending FEC packets are dropped.
+        //!
+        void reset();
+
+        //!
+        //! Process one media RTP packet.
+        //! @param [in] seq RTP sequence number of the media packet.
+        //! @param [in] pt RTP payload type of the media packet.
+        //! @param [in] timestamp RTP time stamp of the media packet.
+        //! @param [in] payload Address of the RTP payload of the media packet.
+        //! @param [in] size Size in bytes of the RTP payload.
+        //!
+        void addMedia(uint16_t seq, uint8_t pt, uint32_t timestamp, const void* payload, size_t size);
+
+        //!
+        //! Get the next column FEC packet to send.
+        //! @param [out] packet Complete FEC packet, including RTP header, to send on the column FEC flow.
+        //! @return True if a packet is returned, false if there is no packet to send.
+        //!
+        bool getColumnFEC(ByteBlock& packet);
+
+        //!
+        //! Get the next row FEC packet to send.
+        //! @param [out] packet Complete FEC packet, including RTP header, to send on the row FEC flow.
+        //! @return True if a packet is returned, false if there is no packet to send.
+        //!
+        bool getRowFEC(ByteBlock& packet);
+
+    private:
+        // Protection group: one column or one row.
+        class Group
+        {
+        public:
+            uint16_t  snbase;     // Sequence number of first media packet
+            uint16_t  length;     // Length recovery
+            uint8_t   pt;         // Payload type recovery
+            uint32_t  timestamp;  // Time stamp recovery
+            uint32_t  last_time;  // Time stamp of last media packet
+            ByteBlock payload;    // Exclusive OR of payloads
+
+            // Constructor.
+            Group();
+
+            // Start a new group.
+            void start(uint16_t seq);
+
+            // Add a media packet in the group.
+            void add(uint8_t pt, uint32_t timestamp, const void* payload, size_t size);
+
+            // Build an FEC packet.
+            void build(ByteBlock& packet, uint16_t seq, bool row, size_t offset, size_t count) const;
+        };
+
+        typedef std::vector<Group> GroupVector;
+        typedef std::list<ByteBlock> PacketList;
+
+        size_t      _columns;     // Number of columns (L)
+        size_t      _rows;        // Number of rows (D)
+        bool        _row_fec;     // Generate row FEC
+        size_t      _index;       // Index of next media packet in the matrix
+        uint16_t    _col_seq;     // Next RTP sequence number in column FEC flow
+        uint16_t    _row_seq;     // Next RTP sequence number in row FEC flow
+        GroupVector _col_groups;  // Column groups of the current matrix
+        Group       _row_group;   // Current row group
+        PacketList  _col_pending; // Column FEC packets of the previous matrix, not yet released
+        PacketList  _col_ready;   // Column FEC packets to send
+        PacketList  _row_ready;   // Row FEC packets to send
+    };
+}
@@ -0,0 +1,233 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Reordering and loss detection of RTP messages.
+//
+//----------------------------------------------------------------------------
+
+#include "tsRTPReorderBuffer.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::RTPReorderBuffer::MAX_DEPTH;
+const int ts::RTPReorderBuffer::RESYNC_GAP;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::RTPReorderBuffer::RTPReorderBuffer(RTPReorderHandlerInterface* handler, size_t depth) :
+    _handler(handler),
+    _depth(0),
+    _valid(false),
+    _ssrc(0),
+    _next(0),
+    _held(0),
+    _slots(),
+    _received(0),
+    _lost(0),
+    _reordered(0),
+    _late(0)
+{
+    setDepth(depth);
+}
+
+
+//----------------------------------------------------------------------------
+// Set the reorder depth.
+//----------------------------------------------------------------------------
+
+void ts::RTPReorderBuffer::setDepth(size_t depth)
+{
+    _depth = std::min(depth, MAX_DEPTH);
+
+    // The size of the buffer is a power of two so that sequence numbers
+    // wrap consistently. It is larger than the reorder depth.
+    size_t slots = 0;
+    if (_depth > 0) {
+        for (slots = 1; slots <= _depth; slots *= 2) {}
+    }
+    _slots.clear();
+    _slots.resize(slots);
+    reset();
+}
+
+
+//----------------------------------------------------------------------------
+// Reset the state and the counters.
+//----------------------------------------------------------------------------
+
+void ts::RTPReorderBuffer::reset()
+{
+    for (SlotVector::iterator it = _slots.begin(); it != _slots.end(); ++it) {
+        it->valid = false;
+    }
+    _valid = false;
+    _ssrc = 0;
+    _next = 0;
+    _held = 0;
+    _received = _lost = _reordered = _late = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Invoke the handler.
+//----------------------------------------------------------------------------
+
+void ts::RTPReorderBuffer::deliver(uint16_t seq, const uint8_t* payload, size_t size)
+{
+    if (_handler != 0) {
+        _handler->handleRTPPayload(*this, seq, payload, size);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a received RTP message.
+//----------------------------------------------------------------------------
+
+void ts::RTPReorderBuffer::add(uint16_t seq, uint32_t ssrc, const void* payload, size_t size, Report& report)
+{
+    const uint8_t* const data = reinterpret_cast<const uint8_t*>(payload);
+    _received++;
+
+    // Synchronize on the first message and on any new synchronization source.
+    if (!_valid || ssrc != _ssrc) {
+        if (_valid) {
+            report.verbose(u"new RTP synchronization source 0x%X", {ssrc});
+            flush();
+        }
+        _valid = true;
+        _ssrc = ssrc;
+        _next = seq;
+    }
+
+    // Signed distance from the next expected sequence number.
+    int diff = int16_t(uint16_t(seq - _next));
+
+    // A very large gap is a restart of the stream, not a loss.
+    if (diff > RESYNC_GAP || diff < -RESYNC_GAP) {
+        report.verbose(u"RTP sequence discontinuity, expected %d, received %d", {_next, seq});
+        flush();
+        _next = seq;
+        diff = 0;
+    }
+
+    // Make room in the reorder window, declaring the oldest missing messages lost.
+    while (_depth > 0 && diff > int(_depth)) {
+        if (_held == 0) {
+            const int skip = diff - int(_depth);
+            _lost += skip;
+            _next = uint16_t(_next + skip);
+        }
+        else {
+            _lost++;
+            _next++;
+            drain();
+        }
+        diff = int16_t(uint16_t(seq - _next));
+    }
+
+    if (diff < 0) {
+        // Duplicated message or received after being declared lost.
+        // Without reordering, it is passed anyway.
+        _late++;
+        if (_depth == 0) {
+            deliver(seq, data, size);
+        }
+    }
+    else if (_depth == 0) {
+        // No reordering, only count missing messages.
+        if (diff > 0) {
+            report.debug(u"%d missing RTP packets before sequence number %d", {diff, seq});
+            _lost += diff;
+        }
+        _next = uint16_t(seq + 1);
+        deliver(seq, data, size);
+    }
+    else if (diff == 0) {
+        // Expected message. If some subsequent messages are already held, it was received out of order.
+        if (_held > 0) {
+            _reordered++;
+        }
+        _next++;
+        deliver(seq, data, size);
+        drain();
+    }
+    else {
+        // Hold the message until all previous ones are received or declared lost.
+        Slot& slot(_slots[seq & (_slots.size() - 1)]);
+        if (slot.valid) {
+            _late++;
+        }
+        else {
+            slot.valid = true;
+            slot.seq = seq;
+            slot.payload.copy(data, size);
+            _held++;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Deliver the held messages which are now in sequence.
+//----------------------------------------------------------------------------
+
+void ts::RTPReorderBuffer::drain()
+{
+    while (_held > 0) {
+        Slot& slot(_slots[_next & (_slots.size() - 1)]);
+        if (!slot.valid || slot.seq != _next) {
+            break;
+        }
+        slot.valid = false;
+        _held--;
+        _next++;
+        deliver(slot.seq, slot.payload.data(), slot.payload.size());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Deliver all held messages, declaring the missing ones as lost.
+//----------------------------------------------------------------------------
+
+void ts::RTPReorderBuffer::flush()
+{
+    while (_held > 0) {
+        drain();
+        if (_held > 0) {
+            _lost++;
+            _next++;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Reordering and loss detection of RTP messages.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsRTPReorderHandlerInterface.h"
+#include "tsMPEG.h"
+#include "tsByteBlock.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Reordering and loss detection of RTP messages, using their sequence numbers.
+    //!
+    //! The payloads of the RTP messages are passed to add() in reception order.
+    //! They are delivered to a handler in sequence number order. When a message
+    //! is received out of order, the subsequent messages are held in the buffer
+    //! until the missing ones arrive or until @a depth later messages are
+    //! received. Then, the missing messages are declared lost. A message which
+    //! is received after being declared lost is late and is dropped. A message
+    //! which is received twice is dropped the second time.
+    //!
+    //! With a depth of zero, there is no reordering. The messages are delivered
+    //! in reception order and the missing ones are only counted.
+    //!
+    //! The first message and any new synchronization source (SSRC) define the
+    //! next expected sequence number. A very large gap in the sequence numbers
+    //! is considered as a restart of the stream, not a loss.
+    //!
+    class TSDUCKDLL RTPReorderBuffer
+    {
+    public:
+        //!
+        //! Maximum reorder depth in RTP messages.
+        //!
+        static const size_t MAX_DEPTH = 256;
+
+        //!
+        //! A sequence number gap larger than this is a restart of the RTP stream.
+        //!
+        static const int RESYNC_GAP = 1024;
+
+        //!
+        //! Constructor.
+        //! @param [in] handler The object to invoke when the payloads are available in sequence.
+        //! @param [in] depth Reorder depth in RTP messages, zero means no reordering.
+        //!
+        RTPReorderBuffer(RTPReorderHandlerInterface* handler = 0, size_t depth = 0);
+
+        //!
+        //! Replace the handler.
+        //! @param [in] handler The object to invoke when the payloads are available in sequence.
+        //!
+        void setHandler(RTPReorderHandlerInterface* handler) {_handler = handler;}
+
+        //!
+        //! Set the reorder depth. The buffer is reset.
+        //! @param [in] depth Reorder depth in RTP messages, zero means no reordering.
+        //! The maximum is MAX_DEPTH.
+        //!
+        void setDepth(size_t depth);
+
+        //!
+        //! Get the reorder depth.
+        //! @return The reorder depth in RTP messages.
+        //!
+        size_t depth() const {return _depth;}
+
+        //!
+        //! Reset the state and the counters. The held messages are dropped.
+        //!
+        void reset();
+
+        //!
+        //! Process a received RTP message.
+        //! The handler is invoked for all payloads which are now in sequence, including this one.
+        //! @param [in] seq RTP sequence number of the message.
+        //! @param [in] ssrc RTP synchronization source of the message.
+        //! @param [in] payload Address of the RTP payload of the message.
+        //! @param [in] size Size in bytes of the RTP payload.
+        //! @param [in,out] report Where to report stream discontinuities (verbose level).
+        //!
+        void add(uint16_t seq, uint32_t ssrc, const void* payload, size_t size, Report& report);
+
+        //!
+        //! Deliver all held messages, declaring the missing ones as lost.
+        //!
+        void flush();
+
+        //!
+        //! Check if the buffer is synchronized on an RTP stream.
+        //! @return True if at least one message was received since the last reset.
+        //!
+        bool isSynchronized() const {return _valid;}
+
+        //!
+        //! Get the synchronization source of the current RTP stream.
+        //! @return The SSRC of the current RTP stream.
+        //!
+        uint32_t ssrc() const {return _ssrc;}
+
+        //!
+        //! Get the number of held messages.
+        //! @return The number of messages which wait for missing previous ones.
+        //!
+        size_t heldCount() const {return _held;}
+
+        //!
+        //! Get the number of received messages.
+        //! @return The number of messages which were passed to add() since the last reset.
+        //!
+        PacketCounter receivedCount() const {return _received;}
+
+        //!
+        //! Get the number of lost messages.
+        //! @return The number of messages which were never received before being declared lost.
+        //!
+        PacketCounter lostCount() const {return _lost;}
+
+        //!
+        //! Get the number of reordered messages.
+        //! @return The number of times a missing message was received after some subsequent ones.
+        //!
+        PacketCounter reorderedCount() const {return _reordered;}
+
+        //!
+        //! Get the number of duplicated or late messages.
+        //! @return The number of messages which were received twice or after being declared lost.
+        //!
+        PacketCounter lateCount() const {return _late;}
+
+    private:
+        // A message which is held in the reorder buffer.
+        struct Slot {
+            Slot() : valid(false), seq(0), payload() {}
+            bool      valid;    // The slot contains a message
+            uint16_t  seq;      // RTP sequence number of the message
+            ByteBlock payload;  // Payload of the message
+        };
+        typedef std::vector<Slot> SlotVector;
+
+        RTPReorderHandlerInterface* _handler;
+        size_t        _depth;      // Reorder depth in messages, zero means no reordering
+        bool          _valid;      // The stream state is initialized
+        uint32_t      _ssrc;       // Current synchronization source
+        uint16_t      _next;       // Next expected sequence number
+        size_t        _held;       // Number of messages in the reorder buffer
+        SlotVector    _slots;      // Reorder buffer, indexed by sequence number modulo its size
+        PacketCounter _received;   // Number of received messages
+        PacketCounter _lost;       // Number of missing messages
+        PacketCounter _reordered;  // Number of messages received out of order and reordered
+        PacketCounter _late;       // Number of duplicated or too late messages
+
+        // Invoke the handler.
+        void deliver(uint16_t seq, const uint8_t* payload, size_t size);
+
+        // Deliver the held messages which are now in sequence.
+        void drain();
+
+        // Inaccessible operations
+        RTPReorderBuffer(const RTPReorderBuffer&) = delete;
+        RTPReorderBuffer& operator=(const RTPReorderBuffer&) = delete;
+    };
+}
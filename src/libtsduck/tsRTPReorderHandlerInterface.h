@@ -0,0 +1,64 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Abstract interface to receive the RTP payloads from an RTPReorderBuffer.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+
+    class RTPReorderBuffer;
+
+    //!
+    //! Abstract interface to receive the RTP payloads from an RTPReorderBuffer.
+    //! The payloads are delivered in sequence number order.
+    //!
+    class TSDUCKDLL RTPReorderHandlerInterface
+    {
+    public:
+        //!
+        //! This hook is invoked when the next RTP payload in sequence is available.
+        //! @param [in,out] buffer A reference to the RTP reorder buffer.
+        //! @param [in] seq RTP sequence number of the message.
+        //! @param [in] payload Address of the RTP payload. This is either the address
+        //! which was passed to RTPReorderBuffer::add() or an internal copy of it.
+        //! @param [in] size Size in bytes of the RTP payload.
+        //!
+        virtual void handleRTPPayload(RTPReorderBuffer& buffer, uint16_t seq, const uint8_t* payload, size_t size) = 0;
+
+        //!
+        //! Virtual destructor.
+        //!
+        virtual ~RTPReorderHandlerInterface() {}
+    };
+}
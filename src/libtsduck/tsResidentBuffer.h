@@ -49,8 +49,10 @@ namespace ts {
         //! Abort application if memory allocation fails.
         //! Do not abort if memory locking fails.
         //! @param [in] elem_count Number of @a T elements.
+        //! @param [in] numa_node If not negative, the buffer is allocated on this NUMA
+        //! node when possible (see ts::SetMemoryNUMANode()).
         //!
-        ResidentBuffer(size_t elem_count);
+        ResidentBuffer(size_t elem_count, int numa_node = -1);
 
         //!
         //! Destructor.
@@ -75,6 +77,16 @@ namespace ts {
             return _error_code;
         }
 
+        //!
+        //! Get error code when the placement on a NUMA node failed.
+        //! @return The system error code when the placement on the NUMA node
+        //! failed, SYS_SUCCESS if the placement succeeded or no NUMA node was requested.
+        //!
+        ErrorCode numaErrorCode() const
+        {
+            return _numa_error_code;
+        }
+
         //!
         //! Return base address of the buffer.
         //! @return The address of the first @a T element in the buffer.
@@ -108,6 +120,7 @@ namespace ts {
         size_t    _elem_count;       // Element count in locked region
         bool      _is_locked;        // False if mlock failed.
         ErrorCode _error_code;       // Lock error code
+        ErrorCode _numa_error_code;  // NUMA node placement error code
     };
 
 }
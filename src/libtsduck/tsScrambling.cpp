@@ -10,6 +10,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsScrambling.h"
+#include "tsScramblingBitslice.h"
 TSDUCK_SOURCE;
 
 // Operations on 64-bit areas.
@@ -568,6 +569,117 @@ void ts::Scrambling::BlockCipher::encipher (const uint8_t *bd, uint8_t *ib)
 }
 
 
+//----------------------------------------------------------------------------
+// Block cipher on packed 64-bit values.
+//
+// R[1]..R[8] are the bytes 0..7 of a little-endian 64-bit value. One round
+// of the block cipher becomes a shift, a multiplication which spreads one
+// byte in several bytes (there is no carry) and a lookup in a table which
+// combines the S-box and the permutation at their respective positions.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Spread R[1] in bytes R[2], R[3], R[4], R[8] (encipher).
+    const uint64_t ENC_SPREAD = TS_UCONST64(0x0100000001010100);
+
+    // Spread R[8] in bytes R[1], R[3], R[4], R[5] (decipher).
+    const uint64_t DEC_SPREAD = TS_UCONST64(0x0000000101010001);
+
+    // Round tables, indexed by S-box input.
+    struct BlockTables
+    {
+        uint64_t enc[256];  // sbox_out in R[8], perm_out in R[6]
+        uint64_t dec[256];  // sbox_out in R[1], R[3], R[4], R[5], perm_out in R[7]
+
+        BlockTables()
+        {
+            for (size_t i = 0; i < 256; ++i) {
+                const uint64_t sbox_out = block_sbox[i];
+                const uint64_t perm_out = uint64_t(block_perm[sbox_out]);
+                enc[i] = (sbox_out << 56) | (perm_out << 40);
+                dec[i] = (sbox_out * DEC_SPREAD) | (perm_out << 48);
+            }
+        }
+
+        static const BlockTables& Instance()
+        {
+            static const BlockTables instance;
+            return instance;
+        }
+    };
+
+    // Maximum number of interleaved blocks.
+    const size_t MAX_INTERLEAVE = 4;
+
+    // Process N independent blocks. N is a compile-time constant so that the
+    // compiler keeps all blocks in registers.
+    template <size_t N>
+    void EncipherN(const int* kk, uint64_t* blocks)
+    {
+        const uint64_t* const tab = BlockTables::Instance().enc;
+        uint64_t R[N];
+        for (size_t n = 0; n < N; ++n) {
+            R[n] = blocks[n];
+        }
+        // Loop over kk[1]..kk[56].
+        for (int i = 1; i <= 56; i++) {
+            const uint64_t k = uint64_t(kk[i]);
+            for (size_t n = 0; n < N; ++n) {
+                const uint64_t r = R[n];
+                R[n] = (r >> 8) ^ ((r & 0xFF) * ENC_SPREAD) ^ tab[(r >> 56) ^ k];
+            }
+        }
+        for (size_t n = 0; n < N; ++n) {
+            blocks[n] = R[n];
+        }
+    }
+
+    template <size_t N>
+    void DecipherN(const int* kk, uint64_t* blocks)
+    {
+        const uint64_t* const tab = BlockTables::Instance().dec;
+        uint64_t R[N];
+        for (size_t n = 0; n < N; ++n) {
+            R[n] = blocks[n];
+        }
+        // Loop over kk[56]..kk[1].
+        for (int i = 56; i > 0; i--) {
+            const uint64_t k = uint64_t(kk[i]);
+            for (size_t n = 0; n < N; ++n) {
+                const uint64_t r = R[n];
+                R[n] = (r << 8) ^ ((r >> 56) * DEC_SPREAD) ^ tab[((r >> 48) & 0xFF) ^ k];
+            }
+        }
+        for (size_t n = 0; n < N; ++n) {
+            blocks[n] = R[n];
+        }
+    }
+}
+
+void ts::Scrambling::BlockCipher::encipher(uint64_t* blocks, size_t count) const
+{
+    switch (count) {
+        case 4: EncipherN<4>(_kk, blocks); break;
+        case 3: EncipherN<3>(_kk, blocks); break;
+        case 2: EncipherN<2>(_kk, blocks); break;
+        case 1: EncipherN<1>(_kk, blocks); break;
+        default: assert(count == 0); break;
+    }
+}
+
+void ts::Scrambling::BlockCipher::decipher(uint64_t* blocks, size_t count) const
+{
+    switch (count) {
+        case 4: DecipherN<4>(_kk, blocks); break;
+        case 3: DecipherN<3>(_kk, blocks); break;
+        case 2: DecipherN<2>(_kk, blocks); break;
+        case 1: DecipherN<1>(_kk, blocks); break;
+        default: assert(count == 0); break;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Set the control word for subsequent encrypt/decrypt operations
 //----------------------------------------------------------------------------
@@ -707,3 +819,216 @@ void ts::Scrambling::decrypt (uint8_t* data, size_t size)
         }
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Batch engines.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Minimum number of data blocks in a batch to use the bitsliced engines.
+    // Below this, the bitsliced stream cipher is slower than processing the
+    // data blocks one by one because most lanes are unused.
+    const size_t BITSLICE_MIN_COUNT = 4;
+
+    // Select the bitsliced engine for the next 'count' data blocks and return its number
+    // of lanes. Return zero if the data blocks shall be processed one by one.
+    size_t SelectEngine(ts::Scrambling::Engine engine, size_t count, ts::ScramblingBitslice::KeystreamFunction& keystream)
+    {
+        if (engine == ts::Scrambling::DEFAULT && count >= BITSLICE_MIN_COUNT) {
+            // A run of the AVX2 engine is more expensive than a run of the SSE2 engine.
+            // Use it only when the data blocks do not fit in the SSE2 engine.
+            if (count > 128 && ts::ScramblingBitslice::Has256()) {
+                engine = ts::Scrambling::BITSLICE256;
+            }
+            else if (ts::ScramblingBitslice::Has128()) {
+                engine = ts::Scrambling::BITSLICE128;
+            }
+            else {
+                engine = ts::Scrambling::BITSLICE64;
+            }
+        }
+        if (engine == ts::Scrambling::BITSLICE256 && ts::ScramblingBitslice::Has256()) {
+            keystream = ts::ScramblingBitslice::Keystream256;
+            return 256;
+        }
+        else if (engine == ts::Scrambling::BITSLICE128 && ts::ScramblingBitslice::Has128()) {
+            keystream = ts::ScramblingBitslice::Keystream128;
+            return 128;
+        }
+        else if (engine == ts::Scrambling::BITSLICE64) {
+            keystream = ts::ScramblingBitslice::Keystream64;
+            return 64;
+        }
+        else if (engine != ts::Scrambling::SCALAR && engine != ts::Scrambling::DEFAULT) {
+            // Unavailable engine, use the default one.
+            return SelectEngine(ts::Scrambling::DEFAULT, count, keystream);
+        }
+        else {
+            return 0;
+        }
+    }
+}
+
+bool ts::Scrambling::IsAvailable(Engine engine)
+{
+    switch (engine) {
+        case BITSLICE128: return ScramblingBitslice::Has128();
+        case BITSLICE256: return ScramblingBitslice::Has256();
+        default: return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt or decrypt a batch of data blocks.
+//----------------------------------------------------------------------------
+
+void ts::Scrambling::encrypt(const DataBlock* blocks, size_t count, Engine engine)
+{
+    processBatch(blocks, count, engine, true);
+}
+
+void ts::Scrambling::decrypt(const DataBlock* blocks, size_t count, Engine engine)
+{
+    processBatch(blocks, count, engine, false);
+}
+
+void ts::Scrambling::processBatch(const DataBlock* blocks, size_t count, Engine engine, bool encrypt)
+{
+    assert(_init);
+
+    // Stream cipher initialization blocks and keystream of all lanes.
+    std::vector<uint64_t> iv;
+    std::vector<uint64_t> ks;
+
+    // Process the batch in chunks of at most the number of lanes of the engine.
+    while (count > 0) {
+
+        ScramblingBitslice::KeystreamFunction keystream = 0;
+        const size_t lanes = SelectEngine(engine, count, keystream);
+
+        // Small batches are processed one data block at a time.
+        if (lanes == 0) {
+            for (size_t n = 0; n < count; ++n) {
+                if (encrypt) {
+                    this->encrypt(blocks[n].data, blocks[n].size);
+                }
+                else {
+                    this->decrypt(blocks[n].data, blocks[n].size);
+                }
+            }
+            return;
+        }
+
+        const size_t chunk = std::min(count, lanes);
+        iv.resize(lanes);
+        ks.resize(lanes * MAX_NBLOCKS);
+        size_t ks_blocks = 0;
+
+        // Packets smaller than 8 bytes are left unscrambled and their lanes are unused.
+        for (size_t l = 0; l < lanes; ++l) {
+            iv[l] = 0;
+            if (l < chunk && blocks[l].size >= 8) {
+                assert(blocks[l].size / 8 <= MAX_NBLOCKS);
+                ks_blocks = std::max(ks_blocks, (blocks[l].size - 1) / 8);
+            }
+        }
+
+        if (encrypt) {
+            // Perform block cipher in reverse CBC mode, interleaving the chains of
+            // groups of data blocks. After the last block is the IV (zero in DVB-CSA).
+            for (size_t l0 = 0; l0 < chunk; l0 += MAX_INTERLEAVE) {
+                const size_t group = std::min(chunk - l0, MAX_INTERLEAVE);
+                size_t nblocks[MAX_INTERLEAVE];
+                size_t max_nblocks = 0;
+                for (size_t g = 0; g < group; ++g) {
+                    nblocks[g] = blocks[l0 + g].size / 8;
+                    max_nblocks = std::max(max_nblocks, nblocks[g]);
+                }
+                for (size_t i = max_nblocks; i-- > 0; ) {
+                    uint64_t ib[MAX_INTERLEAVE];
+                    size_t lane[MAX_INTERLEAVE];
+                    size_t active = 0;
+                    for (size_t g = 0; g < group; ++g) {
+                        if (i < nblocks[g]) {
+                            lane[active] = l0 + g;
+                            ib[active++] = GetUInt64LE(blocks[l0 + g].data + 8 * i) ^ iv[l0 + g];
+                        }
+                    }
+                    _block.encipher(ib, active);
+                    for (size_t a = 0; a < active; ++a) {
+                        PutUInt64LE(blocks[lane[a]].data + 8 * i, ib[a]);
+                        iv[lane[a]] = ib[a];
+                    }
+                }
+            }
+            // The scrambled first blocks are now used to initialize the stream cipher.
+        }
+        else {
+            // The first block is scrambled using the block cipher only.
+            // Its scrambled value is used to initialize the stream cipher.
+            for (size_t l = 0; l < chunk; ++l) {
+                if (blocks[l].size >= 8) {
+                    iv[l] = GetUInt64LE(blocks[l].data);
+                }
+            }
+        }
+
+        // Generate the keystreams of all lanes.
+        if (ks_blocks > 0) {
+            keystream(_key, &iv[0], &ks[0], ks_blocks);
+        }
+
+        for (size_t l = 0; l < chunk; ++l) {
+            uint8_t* const data = blocks[l].data;
+            const size_t nblocks = blocks[l].size / 8;
+            const size_t rsize = blocks[l].size % 8;
+            if (nblocks == 0) {
+                continue;
+            }
+
+            if (encrypt) {
+                // Stream cipher, skipping the first block.
+                for (size_t i = 1; i < nblocks; ++i) {
+                    PutUInt64LE(data + 8 * i, GetUInt64LE(data + 8 * i) ^ ks[(i - 1) * lanes + l]);
+                }
+            }
+            else {
+                // Intermediate blocks: ib[0] = first block, ib[i] = block[i] xor stream[i-1].
+                // Plain block[i] = decipher(ib[i]) xor ib[i+1], the last ib is the IV (zero).
+                // The block decipher operations are independent, interleave them.
+                uint64_t ib[MAX_INTERLEAVE + 1];
+                uint64_t out[MAX_INTERLEAVE];
+                ib[0] = iv[l];
+                for (size_t i0 = 0; i0 < nblocks; i0 += MAX_INTERLEAVE) {
+                    const size_t group = std::min(nblocks - i0, MAX_INTERLEAVE);
+                    for (size_t g = 1; g <= group; ++g) {
+                        const size_t i = i0 + g;
+                        ib[g] = i < nblocks ? GetUInt64LE(data + 8 * i) ^ ks[(i - 1) * lanes + l] : 0;
+                    }
+                    for (size_t g = 0; g < group; ++g) {
+                        out[g] = ib[g];
+                    }
+                    _block.decipher(out, group);
+                    for (size_t g = 0; g < group; ++g) {
+                        PutUInt64LE(data + 8 * (i0 + g), out[g] ^ ib[g + 1]);
+                    }
+                    ib[0] = ib[group];
+                }
+            }
+
+            // Cipher residue, if any.
+            if (rsize > 0) {
+                const uint64_t stream = ks[(nblocks - 1) * lanes + l];
+                for (size_t i = 0; i < rsize; ++i) {
+                    data[8 * nblocks + i] ^= uint8_t(stream >> (8 * i));
+                }
+            }
+        }
+
+        blocks += chunk;
+        count -= chunk;
+    }
+}
@@ -0,0 +1,117 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  Bitsliced DVB-CSA stream cipher, 64-bit and SSE2 engines.
+//
+//----------------------------------------------------------------------------
+
+#include "tsScramblingBitslice.h"
+TSDUCK_SOURCE;
+
+// The SSE2 engine is compiled on Intel x86_64 processors only, where SSE2 is
+// part of the base instruction set.
+#if defined(TS_X86_64) && (defined(TS_MSC) || defined(TS_GCC))
+    #define TS_CSA_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace {
+
+    // 64 lanes in a 64-bit integer.
+    struct Word64
+    {
+        uint64_t v;
+        static const size_t GROUPS = 1;
+        static Word64 Make(uint64_t x) {Word64 w; w.v = x; return w;}
+        static Word64 Zero() {return Make(0);}
+        static Word64 Ones() {return Make(~TS_UCONST64(0));}
+        static Word64 Load(const uint64_t* p) {return Make(*p);}
+        void store(uint64_t* p) const {*p = v;}
+    };
+
+    inline Word64 operator&(const Word64& a, const Word64& b) {return Word64::Make(a.v & b.v);}
+    inline Word64 operator|(const Word64& a, const Word64& b) {return Word64::Make(a.v | b.v);}
+    inline Word64 operator^(const Word64& a, const Word64& b) {return Word64::Make(a.v ^ b.v);}
+    inline Word64 operator~(const Word64& a) {return Word64::Make(~a.v);}
+
+#if defined(TS_CSA_SSE2)
+
+    // 128 lanes in an SSE2 register.
+    struct Word128
+    {
+        __m128i v;
+        static const size_t GROUPS = 2;
+        static Word128 Make(__m128i x) {Word128 w; w.v = x; return w;}
+        static Word128 Zero() {return Make(_mm_setzero_si128());}
+        static Word128 Ones() {return Make(_mm_set1_epi32(-1));}
+        static Word128 Load(const uint64_t* p) {return Make(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));}
+        void store(uint64_t* p) const {_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);}
+    };
+
+    inline Word128 operator&(const Word128& a, const Word128& b) {return Word128::Make(_mm_and_si128(a.v, b.v));}
+    inline Word128 operator|(const Word128& a, const Word128& b) {return Word128::Make(_mm_or_si128(a.v, b.v));}
+    inline Word128 operator^(const Word128& a, const Word128& b) {return Word128::Make(_mm_xor_si128(a.v, b.v));}
+    inline Word128 operator~(const Word128& a) {return Word128::Make(_mm_xor_si128(a.v, _mm_set1_epi32(-1)));}
+
+#endif
+}
+
+#include "tsScramblingBitsliceTemplate.h"
+
+
+//----------------------------------------------------------------------------
+// 64-bit engine.
+//----------------------------------------------------------------------------
+
+void ts::ScramblingBitslice::Keystream64(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks)
+{
+    StreamCipherBitslice<Word64>(key).keystream(iv, ks, blocks);
+}
+
+
+//----------------------------------------------------------------------------
+// SSE2 engine.
+//----------------------------------------------------------------------------
+
+bool ts::ScramblingBitslice::Has128()
+{
+#if defined(TS_CSA_SSE2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ts::ScramblingBitslice::Keystream128(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks)
+{
+#if defined(TS_CSA_SSE2)
+    StreamCipherBitslice<Word128>(key).keystream(iv, ks, blocks);
+#else
+    assert(false);
+#endif
+}
@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//!
+//!  @file
+//!  Bitsliced implementations of the DVB-CSA stream cipher (internal use only).
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Bitsliced implementations of the DVB-CSA stream cipher.
+    //!
+    //! This class is used internally by ts::Scrambling to generate the stream cipher
+    //! keystreams of many packets in parallel. Each bit of a machine word holds the
+    //! state of the stream cipher for one packet ("lane"). All packets use the same
+    //! control word but each of them initializes the stream cipher with its own first
+    //! block of scrambled data.
+    //!
+    //! Applications should not use this class, use the batch API of ts::Scrambling.
+    //!
+    class ScramblingBitslice
+    {
+    public:
+        //!
+        //! Profile of a keystream generation function.
+        //! @param [in] key Address of the control word, after entropy reduction. Its size must be ts::Scrambling::KEY_SIZE.
+        //! @param [in] iv Array of initialization blocks, one per lane, the first byte of each block in the
+        //! least significant byte of the 64-bit value. The array size must be the number of lanes of the engine.
+        //! @param [out] ks Returned keystream. Block @a b of lane @a l is at index @a b * lanes + @a l,
+        //! using the same byte order as @a iv. The array size must be @a blocks times the number of lanes.
+        //! @param [in] blocks Number of 8-byte keystream blocks to generate per lane.
+        //!
+        typedef void (*KeystreamFunction)(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks);
+
+        //!
+        //! Generate keystreams for 64 lanes using 64-bit integers (all platforms).
+        //! @see KeystreamFunction
+        //!
+        static void Keystream64(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks);
+
+        //!
+        //! Check if the 128-lane SSE2 engine is compiled in this version of TSDuck.
+        //! @return True if Keystream128() can be used.
+        //!
+        static bool Has128();
+
+        //!
+        //! Generate keystreams for 128 lanes using SSE2 registers (Intel x86_64 only).
+        //! @see KeystreamFunction
+        //!
+        static void Keystream128(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks);
+
+        //!
+        //! Check if the 256-lane AVX2 engine can be used on this system.
+        //! @return True if Keystream256() is compiled and the processor supports AVX2.
+        //!
+        static bool Has256();
+
+        //!
+        //! Generate keystreams for 256 lanes using AVX2 registers (Intel x86_64 only).
+        //! @see KeystreamFunction
+        //!
+        static void Keystream256(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks);
+    };
+}
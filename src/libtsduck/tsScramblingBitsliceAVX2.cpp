@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  Bitsliced DVB-CSA stream cipher, AVX2 engine.
+//
+//  This source file is compiled with the AVX2 instruction set enabled, using
+//  function-specific target options on GCC and LLVM. Only the code of the
+//  engine is compiled with these options, after all header files are included,
+//  and it is used only when the processor supports AVX2.
+//
+//----------------------------------------------------------------------------
+
+#include "tsScramblingBitslice.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_X86_64) && (defined(TS_MSC) || defined(TS_GCC))
+    #define TS_CSA_AVX2 1
+    #include <immintrin.h>
+    #if defined(TS_LLVM)
+        #pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+    #elif defined(TS_GCC)
+        #pragma GCC push_options
+        #pragma GCC target("avx2")
+    #endif
+#endif
+
+#if defined(TS_CSA_AVX2)
+
+namespace {
+
+    // 256 lanes in an AVX2 register.
+    struct Word256
+    {
+        __m256i v;
+        static const size_t GROUPS = 4;
+        static Word256 Make(__m256i x) {Word256 w; w.v = x; return w;}
+        static Word256 Zero() {return Make(_mm256_setzero_si256());}
+        static Word256 Ones() {return Make(_mm256_set1_epi32(-1));}
+        static Word256 Load(const uint64_t* p) {return Make(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));}
+        void store(uint64_t* p) const {_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);}
+    };
+
+    inline Word256 operator&(const Word256& a, const Word256& b) {return Word256::Make(_mm256_and_si256(a.v, b.v));}
+    inline Word256 operator|(const Word256& a, const Word256& b) {return Word256::Make(_mm256_or_si256(a.v, b.v));}
+    inline Word256 operator^(const Word256& a, const Word256& b) {return Word256::Make(_mm256_xor_si256(a.v, b.v));}
+    inline Word256 operator~(const Word256& a) {return Word256::Make(_mm256_xor_si256(a.v, _mm256_set1_epi32(-1)));}
+}
+
+#include "tsScramblingBitsliceTemplate.h"
+
+namespace {
+    void Keystream256Impl(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks)
+    {
+        StreamCipherBitslice<Word256>(key).keystream(iv, ks, blocks);
+    }
+}
+
+#if defined(TS_LLVM)
+    #pragma clang attribute pop
+#elif defined(TS_GCC)
+    #pragma GCC pop_options
+#endif
+
+#endif // TS_CSA_AVX2
+
+
+//----------------------------------------------------------------------------
+// AVX2 engine.
+//----------------------------------------------------------------------------
+
+bool ts::ScramblingBitslice::Has256()
+{
+#if defined(TS_CSA_AVX2)
+    return CPUHasFeature(CPU_AVX2);
+#else
+    return false;
+#endif
+}
+
+void ts::ScramblingBitslice::Keystream256(const uint8_t* key, const uint64_t* iv, uint64_t* ks, size_t blocks)
+{
+#if defined(TS_CSA_AVX2)
+    Keystream256Impl(key, iv, ks, blocks);
+#else
+    assert(false);
+#endif
+}
@@ -0,0 +1,490 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  Bitsliced DVB-CSA stream cipher, generic code for all word sizes.
+//
+//  This file is included by the source files which instantiate the engines
+//  for a given word type, after the definition of that word type. It must
+//  not be included anywhere else. All code is in an anonymous namespace so
+//  that each engine is compiled with the instruction set of its own source
+//  file, without sharing any inline function with other source files.
+//
+//  A word type W must provide the following features:
+//  - Binary operators &, |, ^ and unary operator ~.
+//  - static const size_t GROUPS: number of 64-bit lane groups in a word.
+//  - static W Zero(), static W Ones(): all bits cleared or set.
+//  - static W Load(const uint64_t* p): load GROUPS 64-bit values, p[g] holds lanes 64*g to 64*g+63.
+//  - void store(uint64_t* p) const: reverse operation of Load().
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+
+namespace {
+
+    //------------------------------------------------------------------------
+    // Transpose a 64x64 bit matrix in place: bit j of a[i] becomes bit i of a[j].
+    //------------------------------------------------------------------------
+
+    inline void Transpose64(uint64_t* a)
+    {
+        uint64_t m = TS_UCONST64(0x00000000FFFFFFFF);
+        for (size_t j = 32; j != 0; j >>= 1, m ^= m << j) {
+            for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                const uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+                a[k] ^= t << j;
+                a[k | j] ^= t;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // The seven s-boxes of the stream cipher, 5 input bits, 2 output bits.
+    // Each output bit is the algebraic normal form of the s-box table. The
+    // monomials are named after their variables, m310 = x3 & x1 & x0.
+    //------------------------------------------------------------------------
+
+    template <class W>
+    inline void SBox1(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& o1, W& o0)
+    {
+        const W m10 = x1 & x0;
+        const W m20 = x2 & x0;
+        const W m21 = x2 & x1;
+        const W m30 = x3 & x0;
+        const W m31 = x3 & x1;
+        const W m32 = x3 & x2;
+        const W m40 = x4 & x0;
+        const W m42 = x4 & x2;
+        const W m43 = x4 & x3;
+        const W m310 = m31 & x0;
+        const W m320 = m32 & x0;
+        const W m321 = m32 & x1;
+        const W m41 = x4 & x1;
+        const W m410 = m41 & x0;
+        const W m421 = m42 & x1;
+        const W m431 = m43 & x1;
+        const W m432 = m43 & x2;
+        const W m4310 = m431 & x0;
+        const W m4320 = m432 & x0;
+        const W m4321 = m432 & x1;
+        o1 = ~(x0 ^ x1 ^ m10 ^ m20 ^ m21 ^ m30 ^ m31 ^ m32 ^ m320 ^ m321 ^ x4 ^ m410 ^ m42 ^ m421 ^ m43 ^ m431 ^ m4310 ^ m432 ^ m4321);
+        o0 = x1 ^ m20 ^ x3 ^ m30 ^ m310 ^ m40 ^ m43 ^ m431 ^ m432 ^ m4320;
+    }
+
+    template <class W>
+    inline void SBox2(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& o1, W& o0)
+    {
+        const W m20 = x2 & x0;
+        const W m21 = x2 & x1;
+        const W m42 = x4 & x2;
+        const W m43 = x4 & x3;
+        const W m210 = m21 & x0;
+        const W m31 = x3 & x1;
+        const W m310 = m31 & x0;
+        const W m32 = x3 & x2;
+        const W m320 = m32 & x0;
+        const W m41 = x4 & x1;
+        const W m410 = m41 & x0;
+        const W m421 = m42 & x1;
+        const W m430 = m43 & x0;
+        const W m431 = m43 & x1;
+        const W m432 = m43 & x2;
+        const W m4310 = m431 & x0;
+        const W m4320 = m432 & x0;
+        o1 = ~(x0 ^ x1 ^ m20 ^ m21 ^ m210 ^ x3 ^ m421 ^ m430 ^ m431 ^ m4310 ^ m432);
+        o0 = ~(x1 ^ x2 ^ m20 ^ m310 ^ m320 ^ m410 ^ m42 ^ m43 ^ m4310 ^ m4320);
+    }
+
+    template <class W>
+    inline void SBox3(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& o1, W& o0)
+    {
+        const W m10 = x1 & x0;
+        const W m20 = x2 & x0;
+        const W m21 = x2 & x1;
+        const W m30 = x3 & x0;
+        const W m31 = x3 & x1;
+        const W m32 = x3 & x2;
+        const W m41 = x4 & x1;
+        const W m42 = x4 & x2;
+        const W m210 = m21 & x0;
+        const W m310 = m31 & x0;
+        const W m321 = m32 & x1;
+        const W m410 = m41 & x0;
+        const W m420 = m42 & x0;
+        const W m421 = m42 & x1;
+        const W m43 = x4 & x3;
+        const W m430 = m43 & x0;
+        const W m432 = m43 & x2;
+        const W m4210 = m421 & x0;
+        const W m4321 = m432 & x1;
+        o1 = ~(x0 ^ x1 ^ m20 ^ m21 ^ m210 ^ x3 ^ m30 ^ m31 ^ m310 ^ m32 ^ m321 ^ x4 ^ m41 ^ m410 ^ m42 ^ m420 ^ m421 ^ m4210 ^ m430 ^ m432 ^ m4321);
+        o0 = x1 ^ m10 ^ m20 ^ x3 ^ x4;
+    }
+
+    template <class W>
+    inline void SBox4(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& o1, W& o0)
+    {
+        const W m10 = x1 & x0;
+        const W m30 = x3 & x0;
+        const W m32 = x3 & x2;
+        const W m40 = x4 & x0;
+        const W m41 = x4 & x1;
+        const W m43 = x4 & x3;
+        const W m21 = x2 & x1;
+        const W m210 = m21 & x0;
+        const W m31 = x3 & x1;
+        const W m310 = m31 & x0;
+        const W m321 = m32 & x1;
+        const W m430 = m43 & x0;
+        const W m432 = m43 & x2;
+        const W m42 = x4 & x2;
+        const W m421 = m42 & x1;
+        const W m4210 = m421 & x0;
+        const W m431 = m43 & x1;
+        const W m4310 = m431 & x0;
+        const W m4321 = m432 & x1;
+        o1 = ~(x0 ^ m10 ^ x2 ^ m210 ^ x3 ^ m321 ^ x4 ^ m40 ^ m41 ^ m4210 ^ m43 ^ m430 ^ m4310 ^ m432 ^ m4321);
+        o0 = ~(x1 ^ m10 ^ x2 ^ m30 ^ m310 ^ m32 ^ m40 ^ m41 ^ m4210 ^ m43 ^ m430 ^ m4310 ^ m432 ^ m4321);
+    }
+
+    template <class W>
+    inline void SBox5(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& o1, W& o0)
+    {
+        const W m10 = x1 & x0;
+        const W m20 = x2 & x0;
+        const W m21 = x2 & x1;
+        const W m30 = x3 & x0;
+        const W m31 = x3 & x1;
+        const W m40 = x4 & x0;
+        const W m41 = x4 & x1;
+        const W m42 = x4 & x2;
+        const W m43 = x4 & x3;
+        const W m210 = m21 & x0;
+        const W m310 = m31 & x0;
+        const W m32 = x3 & x2;
+        const W m320 = m32 & x0;
+        const W m321 = m32 & x1;
+        const W m420 = m42 & x0;
+        const W m421 = m42 & x1;
+        const W m430 = m43 & x0;
+        const W m431 = m43 & x1;
+        const W m4210 = m421 & x0;
+        const W m4310 = m431 & x0;
+        const W m432 = m43 & x2;
+        const W m4320 = m432 & x0;
+        const W m4321 = m432 & x1;
+        o1 = ~(x0 ^ x1 ^ m10 ^ m20 ^ m21 ^ m210 ^ x3 ^ m30 ^ m310 ^ m320 ^ m321 ^ m40 ^ m41 ^ m42 ^ m421 ^ m4210 ^ m430 ^ m431 ^ m4320 ^ m4321);
+        o0 = m10 ^ x2 ^ m20 ^ m210 ^ m30 ^ m31 ^ m320 ^ m40 ^ m42 ^ m420 ^ m421 ^ m4210 ^ m43 ^ m430 ^ m431 ^ m4310;
+    }
+
+    template <class W>
+    inline void SBox6(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& o1, W& o0)
+    {
+        const W m20 = x2 & x0;
+        const W m21 = x2 & x1;
+        const W m31 = x3 & x1;
+        const W m32 = x3 & x2;
+        const W m210 = m21 & x0;
+        const W m310 = m31 & x0;
+        const W m320 = m32 & x0;
+        const W m321 = m32 & x1;
+        const W m41 = x4 & x1;
+        const W m410 = m41 & x0;
+        const W m42 = x4 & x2;
+        const W m421 = m42 & x1;
+        const W m43 = x4 & x3;
+        const W m430 = m43 & x0;
+        const W m4210 = m421 & x0;
+        const W m431 = m43 & x1;
+        const W m4310 = m431 & x0;
+        const W m432 = m43 & x2;
+        const W m4321 = m432 & x1;
+        o1 = x1 ^ m20 ^ m310 ^ m32 ^ m320 ^ x4 ^ m410 ^ m430;
+        o0 = x0 ^ x2 ^ m21 ^ m210 ^ m31 ^ m32 ^ m321 ^ m410 ^ m421 ^ m4210 ^ m4310 ^ m4321;
+    }
+
+    template <class W>
+    inline void SBox7(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& o1, W& o0)
+    {
+        const W m10 = x1 & x0;
+        const W m21 = x2 & x1;
+        const W m32 = x3 & x2;
+        const W m40 = x4 & x0;
+        const W m42 = x4 & x2;
+        const W m210 = m21 & x0;
+        const W m31 = x3 & x1;
+        const W m310 = m31 & x0;
+        const W m41 = x4 & x1;
+        const W m410 = m41 & x0;
+        const W m421 = m42 & x1;
+        const W m43 = x4 & x3;
+        const W m431 = m43 & x1;
+        const W m4210 = m421 & x0;
+        const W m4310 = m431 & x0;
+        const W m432 = m43 & x2;
+        const W m4321 = m432 & x1;
+        o1 = x0 ^ x1 ^ m10 ^ x2 ^ x3 ^ m310 ^ m40 ^ m410 ^ m42 ^ m421 ^ m4210 ^ m4310 ^ m4321;
+        o0 = x0 ^ m10 ^ x2 ^ m21 ^ m210 ^ x3 ^ m32 ^ x4 ^ m431 ^ m4310;
+    }
+
+    //------------------------------------------------------------------------
+    // Bitsliced stream cipher. Each bit position in a word is a lane.
+    //------------------------------------------------------------------------
+
+    template <class W>
+    class StreamCipherBitslice
+    {
+    public:
+        // Constructor: load the same key in all lanes.
+        StreamCipherBitslice(const uint8_t* key);
+
+        // Initialize each lane with its own first block, then generate keystream blocks.
+        // See ts::ScramblingBitslice::KeystreamFunction for the data layout.
+        void keystream(const uint64_t* iv, uint64_t* ks, size_t blocks);
+
+    private:
+        // A 4-bit register, one word per bit, b[0] is the least significant bit.
+        struct Nibble {
+            W b[4];
+        };
+
+        // Registers A and B are shifted one nibble per clock. Instead of moving
+        // ten nibbles at each clock, the registers slide down in a larger array
+        // and are moved back at the top once every SHIFT_DEPTH clocks.
+        static const size_t SHIFT_DEPTH = 32;
+
+        Nibble _A[SHIFT_DEPTH + 10];   // A[k] is _A[_pos + k - 1], k = 1 to 10
+        Nibble _B[SHIFT_DEPTH + 10];   // B[k] is _B[_pos + k - 1], k = 1 to 10
+        size_t _pos;
+        Nibble _X;
+        Nibble _Y;
+        Nibble _Z;
+        Nibble _D;
+        Nibble _E;
+        Nibble _F;
+        W      _p;
+        W      _q;
+        W      _r;
+
+        // One clock of the stream cipher. During initialization, inA and inB are the
+        // input nibbles for registers A and B. The two output bits are returned in hi and lo.
+        template <bool INIT>
+        void clock(const W* inA, const W* inB, W& hi, W& lo);
+
+        // Transpose 64 lanes x 64 bits between lane values and bit words.
+        static void ToBits(const uint64_t* lanes, W* bits);
+        static void FromBits(const W* bits, uint64_t* lanes);
+    };
+
+
+    //------------------------------------------------------------------------
+    // Constructor: load the key in registers A[1..8] and B[1..8].
+    //------------------------------------------------------------------------
+
+    template <class W>
+    StreamCipherBitslice<W>::StreamCipherBitslice(const uint8_t* key) :
+        _pos(SHIFT_DEPTH)
+    {
+        const W zero(W::Zero());
+        const W ones(W::Ones());
+
+        for (size_t k = 0; k < 10; ++k) {
+            for (size_t b = 0; b < 4; ++b) {
+                // Nibble k+1 is the high (even k) or low (odd k) nibble of a key byte.
+                const int abit = k >= 8 ? 0 : (key[k / 2] >> ((k % 2 == 0 ? 4 : 0) + b)) & 1;
+                const int bbit = k >= 8 ? 0 : (key[4 + k / 2] >> ((k % 2 == 0 ? 4 : 0) + b)) & 1;
+                _A[_pos + k].b[b] = abit ? ones : zero;
+                _B[_pos + k].b[b] = bbit ? ones : zero;
+            }
+        }
+        for (size_t b = 0; b < 4; ++b) {
+            _X.b[b] = _Y.b[b] = _Z.b[b] = _D.b[b] = _E.b[b] = _F.b[b] = zero;
+        }
+        _p = _q = _r = zero;
+    }
+
+
+    //------------------------------------------------------------------------
+    // One clock of the stream cipher.
+    //------------------------------------------------------------------------
+
+    template <class W>
+    template <bool INIT>
+    void StreamCipherBitslice<W>::clock(const W* inA, const W* inB, W& hi, W& lo)
+    {
+        // Move the registers back at the top of their arrays when needed.
+        if (_pos == 0) {
+            for (size_t k = 0; k < 10; ++k) {
+                _A[SHIFT_DEPTH + k] = _A[k];
+                _B[SHIFT_DEPTH + k] = _B[k];
+            }
+            _pos = SHIFT_DEPTH;
+        }
+
+        // Use 1-based indexes, as in the specification.
+        const Nibble* const A = _A + _pos - 1;
+        const Nibble* const B = _B + _pos - 1;
+
+        // From A[1]..A[10], 35 bits are selected as inputs to 7 s-boxes.
+        W s1h, s1l, s2h, s2l, s3h, s3l, s4h, s4l, s5h, s5l, s6h, s6l, s7h, s7l;
+        SBox1(A[4].b[0], A[1].b[2], A[6].b[1], A[7].b[3], A[9].b[0], s1h, s1l);
+        SBox2(A[2].b[1], A[3].b[2], A[6].b[3], A[7].b[0], A[9].b[1], s2h, s2l);
+        SBox3(A[1].b[3], A[2].b[0], A[5].b[1], A[5].b[3], A[6].b[2], s3h, s3l);
+        SBox4(A[3].b[3], A[1].b[1], A[2].b[3], A[4].b[2], A[8].b[0], s4h, s4l);
+        SBox5(A[5].b[2], A[4].b[3], A[6].b[0], A[8].b[1], A[9].b[2], s5h, s5l);
+        SBox6(A[3].b[1], A[4].b[1], A[5].b[0], A[7].b[2], A[9].b[3], s6h, s6l);
+        SBox7(A[2].b[2], A[3].b[0], A[7].b[1], A[8].b[2], A[8].b[3], s7h, s7l);
+
+        // Use 4x4 xor to produce extra nibble for T3.
+        Nibble extra_B;
+        extra_B.b[3] = B[3].b[0] ^ B[6].b[1] ^ B[7].b[2] ^ B[9].b[3];
+        extra_B.b[2] = B[6].b[0] ^ B[8].b[1] ^ B[3].b[3] ^ B[4].b[2];
+        extra_B.b[1] = B[5].b[3] ^ B[8].b[2] ^ B[4].b[0] ^ B[5].b[1];
+        extra_B.b[0] = B[9].b[2] ^ B[6].b[3] ^ B[3].b[1] ^ B[8].b[0];
+
+        // T1 and T2. The inputs and D are used only during initialization.
+        // If p=1, the result of T2 is rotated left.
+        Nibble next_A1;
+        Nibble next_B1;
+        for (size_t b = 0; b < 4; ++b) {
+            next_A1.b[b] = A[10].b[b] ^ _X.b[b];
+            next_B1.b[b] = B[7].b[b] ^ B[10].b[b] ^ _Y.b[b];
+            if (INIT) {
+                next_A1.b[b] = next_A1.b[b] ^ _D.b[b] ^ inA[b];
+                next_B1.b[b] = next_B1.b[b] ^ inB[b];
+            }
+        }
+        const W t0(next_B1.b[0]);
+        next_B1.b[0] = t0 ^ (_p & (t0 ^ next_B1.b[3]));
+        next_B1.b[3] = next_B1.b[3] ^ (_p & (next_B1.b[3] ^ next_B1.b[2]));
+        next_B1.b[2] = next_B1.b[2] ^ (_p & (next_B1.b[2] ^ next_B1.b[1]));
+        next_B1.b[1] = next_B1.b[1] ^ (_p & (next_B1.b[1] ^ t0));
+
+        // T3 and T4: D = E xor Z xor extra_B, F = (q ? Z + E + r : E), r is the carry.
+        W carry(_r);
+        for (size_t b = 0; b < 4; ++b) {
+            const W z(_Z.b[b]);
+            const W e(_E.b[b]);
+            _D.b[b] = e ^ z ^ extra_B.b[b];
+            _E.b[b] = _F.b[b];
+            _F.b[b] = e ^ (_q & (z ^ carry));
+            carry = (z & e) | (carry & (z ^ e));
+        }
+        _r = _r ^ (_q & (carry ^ _r));
+
+        // Shift registers A and B.
+        --_pos;
+        _A[_pos] = next_A1;
+        _B[_pos] = next_B1;
+
+        // New values of X, Y, Z, p, q from the s-boxes outputs.
+        _X.b[3] = s4l; _X.b[2] = s3l; _X.b[1] = s2h; _X.b[0] = s1h;
+        _Y.b[3] = s6l; _Y.b[2] = s5l; _Y.b[1] = s4h; _Y.b[0] = s3h;
+        _Z.b[3] = s2l; _Z.b[2] = s1l; _Z.b[1] = s6h; _Z.b[0] = s5h;
+        _p = s7h;
+        _q = s7l;
+
+        // The 2 output bits are a function of the 4 bits of D, xor 2 by 2.
+        hi = _D.b[3] ^ _D.b[2];
+        lo = _D.b[1] ^ _D.b[0];
+    }
+
+
+    //------------------------------------------------------------------------
+    // Transpose between lane values and bit words.
+    //------------------------------------------------------------------------
+
+    template <class W>
+    void StreamCipherBitslice<W>::ToBits(const uint64_t* lanes, W* bits)
+    {
+        uint64_t tmp[64 * W::GROUPS];
+        for (size_t g = 0; g < W::GROUPS; ++g) {
+            uint64_t col[64];
+            for (size_t i = 0; i < 64; ++i) {
+                col[i] = lanes[64 * g + i];
+            }
+            Transpose64(col);
+            for (size_t i = 0; i < 64; ++i) {
+                tmp[i * W::GROUPS + g] = col[i];
+            }
+        }
+        for (size_t i = 0; i < 64; ++i) {
+            bits[i] = W::Load(tmp + i * W::GROUPS);
+        }
+    }
+
+    template <class W>
+    void StreamCipherBitslice<W>::FromBits(const W* bits, uint64_t* lanes)
+    {
+        uint64_t tmp[64 * W::GROUPS];
+        for (size_t i = 0; i < 64; ++i) {
+            bits[i].store(tmp + i * W::GROUPS);
+        }
+        for (size_t g = 0; g < W::GROUPS; ++g) {
+            uint64_t* const col = lanes + 64 * g;
+            for (size_t i = 0; i < 64; ++i) {
+                col[i] = tmp[i * W::GROUPS + g];
+            }
+            Transpose64(col);
+        }
+    }
+
+
+    //------------------------------------------------------------------------
+    // Initialize each lane with its first block, then generate the keystream.
+    //------------------------------------------------------------------------
+
+    template <class W>
+    void StreamCipherBitslice<W>::keystream(const uint64_t* iv, uint64_t* ks, size_t blocks)
+    {
+        // Bit b of byte i of the blocks is at index 8*i+b.
+        W bits[64];
+        W hi, lo;
+
+        // Initialization: 8 bytes, 4 clocks per byte. The most significant nibble
+        // of the input byte goes to A on even clocks and to B on odd clocks.
+        ToBits(iv, bits);
+        for (size_t i = 0; i < 8; ++i) {
+            const W* const in1 = bits + 8 * i + 4;
+            const W* const in2 = bits + 8 * i;
+            for (size_t j = 0; j < 4; ++j) {
+                clock<true>(j % 2 == 0 ? in1 : in2, j % 2 == 0 ? in2 : in1, hi, lo);
+            }
+        }
+
+        // Generation: 2 bits per clock, most significant bits first.
+        for (size_t blk = 0; blk < blocks; ++blk) {
+            for (size_t i = 0; i < 8; ++i) {
+                for (size_t j = 0; j < 4; ++j) {
+                    clock<false>(0, 0, bits[8 * i + 7 - 2 * j], bits[8 * i + 6 - 2 * j]);
+                }
+            }
+            FromBits(bits, ks + blk * 64 * W::GROUPS);
+        }
+    }
+}
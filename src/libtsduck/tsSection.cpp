@@ -292,6 +292,24 @@ void ts::Section::initialize(const ByteBlockPtr& bbp, PID pid, CRC32::Validation
 }
 
 
+//----------------------------------------------------------------------------
+// Reload from full binary content.
+//----------------------------------------------------------------------------
+
+void ts::Section::reload(const void* content, size_t content_size, PID source_pid, CRC32::Validation crc_op)
+{
+    if (!_data.isNull() && _data.count() == 1) {
+        // The data buffer is not shared, reuse it.
+        ByteBlockPtr bbp(_data);
+        bbp->copy(content, content_size);
+        initialize(bbp, source_pid, crc_op);
+    }
+    else {
+        initialize(new ByteBlock(content, content_size), source_pid, crc_op);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Assignment. The section content is referenced, and thus shared
 // between the two section objects.
@@ -152,7 +152,9 @@ namespace ts {
 
         //!
         //! Reload from full binary content.
-        //! The content is copied into the section if valid.
+        //! The content is copied into the section if valid. If the previous
+        //! content of the section is not shared with another section, its
+        //! memory is reused.
         //! @param [in] content Address of the binary section data.
         //! @param [in] content_size Size in bytes of the section.
         //! @param [in] source_pid PID from which the section was read.
@@ -161,10 +163,7 @@ namespace ts {
         void reload(const void* content,
                     size_t content_size,
                     PID source_pid = PID_NULL,
-                    CRC32::Validation crc_op = CRC32::IGNORE)
-        {
-            initialize(new ByteBlock(content, content_size), source_pid, crc_op);
-        }
+                    CRC32::Validation crc_op = CRC32::IGNORE);
 
         //!
         //! Reload from full binary content.
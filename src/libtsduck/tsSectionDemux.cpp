@@ -142,6 +142,8 @@ ts::SectionDemux::SectionDemux(TableHandlerInterface* table_handler,
     _table_handler(table_handler),
     _section_handler(section_handler),
     _pids (),
+    _pid_index (),
+    _section_pool (),
     _status (),
     _packet_count (0)
 {
@@ -164,11 +166,110 @@ ts::SectionDemux::~SectionDemux ()
 void ts::SectionDemux::immediateReset()
 {
     _pids.clear();
+    std::fill(_pid_index.begin(), _pid_index.end(), static_cast<PIDContext*>(0));
 }
 
 void ts::SectionDemux::immediateResetPID(PID pid)
 {
     _pids.erase(pid);
+    if (pid < _pid_index.size()) {
+        _pid_index[pid] = 0;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Set the demux in high-throughput mode or back to normal mode.
+//----------------------------------------------------------------------------
+
+void ts::SectionDemux::setHighThroughput(bool on)
+{
+    if (!on) {
+        _pid_index.clear();
+        _section_pool.clear();
+    }
+    else if (_pid_index.empty()) {
+        // Build the direct index on existing PID contexts. The addresses
+        // of elements in a std::map remain valid until they are erased.
+        _pid_index.resize(PID_MAX, 0);
+        for (std::map<PID,PIDContext>::iterator it = _pids.begin(); it != _pids.end(); ++it) {
+            _pid_index[it->first] = &it->second;
+            it->second.ts.reserve(MAX_PRIVATE_SECTION_SIZE + PKT_SIZE);
+        }
+        _section_pool.reserve(SECTION_POOL_SIZE);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the context of a PID, create it if necessary.
+//----------------------------------------------------------------------------
+
+ts::SectionDemux::PIDContext& ts::SectionDemux::getPIDContext(PID pid)
+{
+    if (_pid_index.empty()) {
+        return _pids[pid];
+    }
+    else {
+        PIDContext*& pc(_pid_index[pid]);
+        if (pc == 0) {
+            pc = &_pids[pid];
+            // Preallocate the reassembly buffer: a section can start at the
+            // end of a packet and is at most MAX_PRIVATE_SECTION_SIZE bytes.
+            pc->ts.reserve(MAX_PRIVATE_SECTION_SIZE + PKT_SIZE);
+        }
+        return *pc;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a packet is identical to a remembered one, except the continuity
+// counter (low nibble of byte 3).
+//----------------------------------------------------------------------------
+
+bool ts::SectionDemux::PIDContext::isRepeated(const TSPacket& pkt) const
+{
+    for (size_t i = 0; i < repeat_count; ++i) {
+        const uint8_t* const b = repeats[i].b;
+        if (::memcmp(b + 4, pkt.b + 4, PKT_SIZE - 4) == 0 && ::memcmp(b, pkt.b, 3) == 0 && (b[3] & 0xF0) == (pkt.b[3] & 0xF0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Remember a packet which did not modify the tables.
+//----------------------------------------------------------------------------
+
+void ts::SectionDemux::PIDContext::addRepeated(const TSPacket& pkt)
+{
+    repeats[repeat_next] = pkt;
+    repeat_next = (repeat_next + 1) % REPEAT_PACKETS;
+    if (repeat_count < REPEAT_PACKETS) {
+        repeat_count++;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get a new section object, from the recycling pool in high-throughput mode.
+//----------------------------------------------------------------------------
+
+ts::SectionPtr ts::SectionDemux::newSection(const uint8_t* data, size_t size, PID pid)
+{
+    if (_section_pool.empty()) {
+        return new Section(data, size, pid, CRC32::CHECK);
+    }
+    else {
+        // Reuse the section object and its data buffer.
+        SectionPtr sect(_section_pool.back());
+        _section_pool.pop_back();
+        sect->reload(data, size, pid, CRC32::CHECK);
+        return sect;
+    }
 }
 
 
@@ -197,7 +298,7 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
     // The PID context is created if did not exist.
 
     PID pid = pkt.getPID();
-    PIDContext& pc(_pids[pid]);
+    PIDContext& pc(getPIDContext(pid));
 
     // If TS packet is scrambled, we cannot decode it and we loose
     // synchronization on this PID (usually, PID's carrying sections
@@ -226,6 +327,17 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
 
     pc.continuity = pkt.getCC ();
 
+    // A packet which contains only complete sections and which is identical to
+    // a recent one is ignored when the tables of the PID were not modified since:
+    // the sections are the same versions and are already known. This is typical
+    // of the repetitions of the PAT and PMT's. Not applicable when all sections
+    // are passed to a section handler.
+
+    if (_section_handler == 0 && pc.sync && pc.ts.empty() && pkt.getPUSI() && pc.isRepeated(pkt)) {
+        pc.pusi_pkt_index = _packet_count;
+        return;
+    }
+
     // Locate TS packet payload
 
     size_t header_size = pkt.getHeaderSize ();
@@ -278,6 +390,13 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         return;
     }
 
+    // The packet can be remembered as a repeated one if it starts with a section,
+    // contains only complete sections and does not modify any table.
+
+    const bool repeat_candidate = _section_handler == 0 && pc.ts.empty() && pkt.getPUSI() && pointer_field == 0;
+    const uint64_t errors = _status.inv_sect_index + _status.wrong_crc;
+    bool modified = false;
+
     // If no previous synchronization, skip incomplete sections
 
     if (!pc.sync) {
@@ -400,10 +519,14 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                 tc.sect_expected = size_t (last_section_number) + 1;
                 tc.sect_received = 0;
                 tc.sects.resize (tc.sect_expected);
-                // Mark all section entries as unused
+                // Mark all section entries as unused. Only drop our references,
+                // the sections of the previous version may be kept by the application.
                 for (size_t si = 0; si < tc.sect_expected; si++) {
-                    tc.sects[si].reset();
+                    tc.sects[si].clear();
                 }
+                // The tables of the PID are modified, forget the repeated packets.
+                pc.repeat_count = pc.repeat_next = 0;
+                modified = true;
             }
 
             // Check that the total number of sections in the table
@@ -420,7 +543,7 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             SectionPtr sect_ptr;
 
             if (section_ok && (_section_handler != 0 || tc.sects[section_number].isNull())) {
-                sect_ptr = new Section (ts_start, section_length, pid, CRC32::CHECK);
+                sect_ptr = newSection(ts_start, section_length, pid);
                 sect_ptr->setFirstTSPacketIndex (pusi_pkt_index);
                 sect_ptr->setLastTSPacketIndex (_packet_count);
                 if (!sect_ptr->isValid()) {
@@ -445,6 +568,8 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                     // Save the section
                     tc.sects[section_number] = sect_ptr;
                     tc.sect_received++;
+                    pc.repeat_count = pc.repeat_next = 0;
+                    modified = true;
 
                     // If the table is completed and a handler is present, build the table.
                     if (tc.sect_received == tc.sect_expected && _table_handler != 0) {
@@ -464,6 +589,12 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                 afterCallingHandler(false);
                 throw;
             }
+
+            // In high-throughput mode, recycle the section object if nobody kept a reference.
+            if (!sect_ptr.isNull() && sect_ptr.count() == 1 && !_pid_index.empty() && _section_pool.size() < SECTION_POOL_SIZE) {
+                _section_pool.push_back(sect_ptr);
+            }
+
             if (afterCallingHandler(true)) {
                 return;  // the PID of this packet or the complete demux was reset.
             }
@@ -491,6 +622,10 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
     if (ts_size <= 0) {
         // TS buffer becomes empty
         pc.ts.clear();
+        // Remember the packet if it did not modify the tables, without error.
+        if (repeat_candidate && !modified && errors == _status.inv_sect_index + _status.wrong_crc) {
+            pc.addRepeated(pkt);
+        }
     }
     else if (ts_start > pc.ts.data()) {
         // Remove start of TS buffer
@@ -90,6 +90,33 @@ namespace ts {
             _section_handler = h;
         }
 
+        //!
+        //! Set the demux in high-throughput mode or back to normal mode.
+        //!
+        //! In high-throughput mode, the contexts of the PID's are directly indexed by
+        //! PID value, the packet reassembly buffers are preallocated to the maximum
+        //! section size and the Section objects which are passed to the section handler
+        //! are recycled when the handler did not keep a reference to them. This uses
+        //! more memory but avoids most dynamic memory allocations when demuxing
+        //! section-heavy streams such as EIT's.
+        //!
+        //! In both modes, a section handler shall not keep a reference or a pointer
+        //! to the Section object after returning. To keep a section, copy it.
+        //!
+        //! @param [in] on True to set high-throughput mode, false to revert to normal mode.
+        //!
+        void setHighThroughput(bool on);
+
+        //!
+        //! Check if the demux is in high-throughput mode.
+        //! @return True if the demux is in high-throughput mode.
+        //! @see setHighThroughput()
+        //!
+        bool highThroughput() const
+        {
+            return !_pid_index.empty();
+        }
+
         //!
         //! Demux status information.
         //! It contains error counters.
@@ -181,6 +208,9 @@ namespace ts {
             }
         };
 
+        // Maximum number of repeated packets which are remembered per PID.
+        static const size_t REPEAT_PACKETS = 4;
+
         // This internal structure contains the analysis context for one PID.
         struct PIDContext
         {
@@ -189,6 +219,9 @@ namespace ts {
             ByteBlock ts;                      // TS payload buffer
             std::map <ETID, ETIDContext> tids; // TID analysis contexts
             PacketCounter pusi_pkt_index;      // Index of last PUSI packet in this PID
+            TSPacket repeats[REPEAT_PACKETS];  // Recent packets with complete sections which did not modify the tables
+            size_t repeat_count;               // Number of valid packets in repeats
+            size_t repeat_next;                // Index in repeats of the next packet to replace
 
             // Default constructor:
             PIDContext() :
@@ -196,7 +229,10 @@ namespace ts {
                 sync(false),
                 ts(),
                 tids(),
-                pusi_pkt_index(0)
+                pusi_pkt_index(0),
+                repeats(),
+                repeat_count(0),
+                repeat_next(0)
             {
             }
 
@@ -206,12 +242,29 @@ namespace ts {
                 sync = false;
                 ts.clear();
             }
+
+            // Check if a packet is identical to a remembered one, except the continuity counter.
+            bool isRepeated(const TSPacket& pkt) const;
+
+            // Remember a packet which did not modify the tables.
+            void addRepeated(const TSPacket& pkt);
         };
 
+        // Get the context of a PID, create it if necessary.
+        PIDContext& getPIDContext(PID pid);
+
+        // Get a new section object, from the recycling pool in high-throughput mode.
+        SectionPtr newSection(const uint8_t* data, size_t size, PID pid);
+
+        // Maximum number of unused sections in the recycling pool.
+        static const size_t SECTION_POOL_SIZE = 16;
+
         // Private members:
         TableHandlerInterface*   _table_handler;
         SectionHandlerInterface* _section_handler;
         std::map<PID,PIDContext> _pids;
+        std::vector<PIDContext*> _pid_index;       // PID_MAX direct pointers into _pids in high-throughput mode, empty otherwise
+        SectionPtrVector         _section_pool;    // unused sections to recycle in high-throughput mode
         Status                   _status;
         PacketCounter            _packet_count;    // number of TS packets in demultiplexed stream
 
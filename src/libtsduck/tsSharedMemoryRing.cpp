@@ -0,0 +1,509 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Ring of TS packets in shared memory between two processes.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedMemoryRing.h"
+#include "tsSysUtils.h"
+#include "tsTime.h"
+#include "tsNullReport.h"
+TSDUCK_SOURCE;
+
+const size_t ts::SharedMemoryRing::DEFAULT_PACKET_COUNT;
+const ts::MilliSecond ts::SharedMemoryRing::ATTACH_TIMEOUT;
+const ts::UChar* const ts::SharedMemoryRing::ENV_NAME = u"TSDUCK_SHM_RING";
+
+// Magic number at the beginning of the shared memory, "TSRG".
+#define RING_MAGIC 0x54535247
+
+// Polling interval when waiting for the other process.
+#define RING_POLL_MS 100
+
+
+//----------------------------------------------------------------------------
+// Header of the shared memory. The packet area follows, aligned on a page.
+// All counters are protected by the process-shared mutex. On Linux, the mutex
+// is robust, a terminated owner is reported as EOWNERDEAD to the next locker.
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+struct ts::SharedMemoryRing::Header
+{
+    uint32_t          magic;          // RING_MAGIC when initialized.
+    uint32_t          packet_count;   // Number of packets in the ring.
+    uint64_t          data_offset;    // Offset of the packet area from the header.
+    ::pthread_mutex_t mutex;          // Protects all fields below.
+    ::pthread_cond_t  cond;           // Signaled on any change.
+    uint64_t          written;        // Total number of packets published by the writer.
+    uint64_t          read;           // Total number of packets released by the reader.
+    ::pid_t           writer_pid;     // Process id of the writer.
+    ::pid_t           reader_pid;     // Process id of the reader, zero until attached.
+    bool              writer_closed;  // No more packets from the writer.
+    bool              reader_closed;  // No more reads from the reader.
+};
+#else
+struct ts::SharedMemoryRing::Header
+{
+    uint32_t magic;
+};
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryRing::SharedMemoryRing() :
+    _name(),
+    _writer(false),
+    _header(0),
+    _map_size(0),
+    _packets(0)
+{
+}
+
+ts::SharedMemoryRing::~SharedMemoryRing()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Create a new ring as the writer.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryRing::create(const UString& name, size_t packet_count, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared memory ring already open");
+        return false;
+    }
+
+#if defined(TS_WINDOWS)
+
+    report.error(u"shared memory packet rings are not implemented on Windows");
+    return false;
+
+#else
+
+    static int counter = 0;
+
+    // POSIX shared memory names start with a slash.
+    if (name.empty()) {
+        _name = UString::Format(u"/tsduck-ring-%d-%d", {CurrentProcessId(), counter++});
+    }
+    else {
+        _name = name.startWith(u"/") ? name : u"/" + name;
+    }
+
+    if (packet_count == 0 || packet_count > 0xFFFFFFFF) {
+        report.error(u"invalid number of packets in shared memory ring: %'d", {packet_count});
+        return false;
+    }
+
+    const size_t page = MemoryPageSize();
+    const size_t data_offset = ((sizeof(Header) + page - 1) / page) * page;
+    _map_size = data_offset + ((packet_count * PKT_SIZE + page - 1) / page) * page;
+
+    const int fd = ::shm_open(_name.toUTF8().c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        report.error(u"error creating shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+    if (::ftruncate(fd, ::off_t(_map_size)) < 0) {
+        report.error(u"error resizing shared memory %s: %s", {_name, ErrorCodeMessage()});
+        ::close(fd);
+        ::shm_unlink(_name.toUTF8().c_str());
+        return false;
+    }
+    void* addr = ::mmap(0, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        report.error(u"error mapping shared memory %s: %s", {_name, ErrorCodeMessage()});
+        ::shm_unlink(_name.toUTF8().c_str());
+        return false;
+    }
+
+    _writer = true;
+    _header = reinterpret_cast<Header*>(addr);
+    _packets = reinterpret_cast<TSPacket*>(reinterpret_cast<uint8_t*>(addr) + data_offset);
+
+    // Initialize the process-shared synchronization objects.
+    ::pthread_mutexattr_t mattr;
+    ::pthread_condattr_t cattr;
+    bool success =
+        ::pthread_mutexattr_init(&mattr) == 0 &&
+        ::pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED) == 0 &&
+#if defined(TS_LINUX)
+        ::pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST) == 0 &&
+#endif
+        ::pthread_mutex_init(&_header->mutex, &mattr) == 0 &&
+        ::pthread_condattr_init(&cattr) == 0 &&
+        ::pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED) == 0 &&
+        ::pthread_cond_init(&_header->cond, &cattr) == 0;
+    if (!success) {
+        report.error(u"error initializing process-shared synchronization in %s", {_name});
+        unmap();
+        ::shm_unlink(_name.toUTF8().c_str());
+        return false;
+    }
+
+    _header->packet_count = uint32_t(packet_count);
+    _header->data_offset = data_offset;
+    _header->written = 0;
+    _header->read = 0;
+    _header->writer_pid = ::getpid();
+    _header->reader_pid = 0;
+    _header->writer_closed = false;
+    _header->reader_closed = false;
+    _header->magic = RING_MAGIC;
+
+    report.debug(u"created shared memory ring %s, %'d packets", {_name, packet_count});
+    return true;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Attach to an existing ring as the reader.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryRing::attach(const UString& name, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared memory ring already open");
+        return false;
+    }
+
+#if defined(TS_WINDOWS)
+
+    report.error(u"shared memory packet rings are not implemented on Windows");
+    return false;
+
+#else
+
+    _name = name.startWith(u"/") ? name : u"/" + name;
+
+    const int fd = ::shm_open(_name.toUTF8().c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        report.error(u"error opening shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+    struct ::stat st;
+    if (::fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(Header)) {
+        report.error(u"invalid shared memory %s", {_name});
+        ::close(fd);
+        return false;
+    }
+    _map_size = size_t(st.st_size);
+    void* addr = ::mmap(0, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        report.error(u"error mapping shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+
+    _writer = false;
+    _header = reinterpret_cast<Header*>(addr);
+    if (_header->magic != RING_MAGIC || _header->data_offset + uint64_t(_header->packet_count) * PKT_SIZE > _map_size) {
+        report.error(u"shared memory %s is not a TS packet ring", {_name});
+        unmap();
+        return false;
+    }
+    _packets = reinterpret_cast<TSPacket*>(reinterpret_cast<uint8_t*>(addr) + _header->data_offset);
+
+    // Only one reader is allowed.
+    lock(report);
+    const bool busy = _header->reader_pid != 0;
+    if (!busy) {
+        _header->reader_pid = ::getpid();
+        ::pthread_cond_broadcast(&_header->cond);
+    }
+    ::pthread_mutex_unlock(&_header->mutex);
+
+    if (busy) {
+        report.error(u"shared memory ring %s already has a reader", {_name});
+        unmap();
+        return false;
+    }
+
+    // Now that both processes have a mapping, remove the name of the shared memory.
+    // The memory is freed when both processes have unmapped it.
+    ::shm_unlink(_name.toUTF8().c_str());
+
+    report.debug(u"attached to shared memory ring %s, %'d packets", {_name, _header->packet_count});
+    return true;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Close the ring.
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryRing::close(Report& report)
+{
+    if (!isOpen()) {
+        return true;
+    }
+
+#if !defined(TS_WINDOWS)
+    lock(report);
+    if (_writer) {
+        _header->writer_closed = true;
+        ::pthread_cond_broadcast(&_header->cond);
+        // The reader removes the name of the shared memory when it attaches.
+        // Give a late reader a chance to attach and get the remaining packets.
+        const Time start(Time::CurrentUTC());
+        while (_header->reader_pid == 0 && Time::CurrentUTC() - start < ATTACH_TIMEOUT) {
+            wait(report);
+        }
+    }
+    else {
+        _header->reader_closed = true;
+        ::pthread_cond_broadcast(&_header->cond);
+    }
+    const bool attached = _header->reader_pid != 0;
+    ::pthread_mutex_unlock(&_header->mutex);
+
+    if (_writer && !attached) {
+        report.debug(u"no reader attached to shared memory ring %s", {_name});
+        ::shm_unlink(_name.toUTF8().c_str());
+    }
+#endif
+
+    report.debug(u"closing shared memory ring %s", {_name});
+    unmap();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Release the mapping.
+//----------------------------------------------------------------------------
+
+void ts::SharedMemoryRing::unmap()
+{
+#if !defined(TS_WINDOWS)
+    if (_header != 0) {
+        ::munmap(_header, _map_size);
+    }
+#endif
+    _header = 0;
+    _packets = 0;
+    _map_size = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Lock the mutex and wait on the condition variable.
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+
+void ts::SharedMemoryRing::lock(Report& report)
+{
+    if (::pthread_mutex_lock(&_header->mutex) == EOWNERDEAD) {
+        recover(report);
+    }
+}
+
+// Wait for a polling interval. Must be called with the mutex held.
+void ts::SharedMemoryRing::wait(Report& report)
+{
+    ::timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += RING_POLL_MS * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    if (::pthread_cond_timedwait(&_header->cond, &_header->mutex, &ts) == EOWNERDEAD) {
+        recover(report);
+    }
+}
+
+// The mutex was acquired but its previous owner terminated while holding it.
+// Only the peer process can be the previous owner: consider it as closed.
+void ts::SharedMemoryRing::recover(Report& report)
+{
+#if defined(TS_LINUX)
+    ::pthread_mutex_consistent(&_header->mutex);
+#endif
+    if (_writer) {
+        report.error(u"reader of shared memory ring %s terminated while holding the lock", {_name});
+        _header->reader_closed = true;
+    }
+    else {
+        report.error(u"writer of shared memory ring %s terminated while holding the lock", {_name});
+        _header->writer_closed = true;
+    }
+    ::pthread_cond_broadcast(&_header->cond);
+}
+
+// Check if a process is still alive.
+namespace {
+    bool ProcessAlive(::pid_t pid)
+    {
+        return ::kill(pid, 0) == 0 || errno != ESRCH;
+    }
+}
+
+#endif
+
+
+//----------------------------------------------------------------------------
+// Writer: get a contiguous free area in the ring.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedMemoryRing::getWriteArea(TSPacket*& area, Report& report)
+{
+    area = 0;
+    if (!isOpen() || !_writer) {
+        report.error(u"shared memory ring not open for writing");
+        return 0;
+    }
+
+#if defined(TS_WINDOWS)
+    return 0;
+#else
+    size_t count = 0;
+    const Time start(Time::CurrentUTC());
+
+    lock(report);
+    for (;;) {
+        if (_header->reader_closed) {
+            report.debug(u"reader of shared memory ring %s has closed", {_name});
+            break;
+        }
+        const uint64_t size = _header->packet_count;
+        const uint64_t free = size - (_header->written - _header->read);
+        if (free > 0) {
+            const size_t index = size_t(_header->written % size);
+            count = size_t(std::min<uint64_t>(free, size - index));
+            area = _packets + index;
+            break;
+        }
+        // The ring is full, wait for the reader.
+        wait(report);
+        if (_header->reader_pid != 0 && !ProcessAlive(_header->reader_pid)) {
+            report.error(u"reader of shared memory ring %s has terminated", {_name});
+            break;
+        }
+        if (_header->reader_pid == 0 && Time::CurrentUTC() - start > ATTACH_TIMEOUT) {
+            report.error(u"no reader attached to shared memory ring %s", {_name});
+            break;
+        }
+    }
+    ::pthread_mutex_unlock(&_header->mutex);
+    return count;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Writer: publish packets.
+//----------------------------------------------------------------------------
+
+void ts::SharedMemoryRing::commitWrite(size_t count)
+{
+#if !defined(TS_WINDOWS)
+    if (isOpen() && _writer && count > 0) {
+        lock(NULLREP);
+        _header->written += count;
+        ::pthread_cond_broadcast(&_header->cond);
+        ::pthread_mutex_unlock(&_header->mutex);
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Reader: get a contiguous area of available packets.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedMemoryRing::getReadArea(const TSPacket*& area, Report& report)
+{
+    area = 0;
+    if (!isOpen() || _writer) {
+        report.error(u"shared memory ring not open for reading");
+        return 0;
+    }
+
+#if defined(TS_WINDOWS)
+    return 0;
+#else
+    size_t count = 0;
+
+    lock(report);
+    for (;;) {
+        const uint64_t size = _header->packet_count;
+        const uint64_t avail = _header->written - _header->read;
+        if (avail > 0) {
+            const size_t index = size_t(_header->read % size);
+            count = size_t(std::min<uint64_t>(avail, size - index));
+            area = _packets + index;
+            break;
+        }
+        if (_header->writer_closed) {
+            // End of stream.
+            break;
+        }
+        // The ring is empty, wait for the writer.
+        wait(report);
+        if (!_header->writer_closed && _header->written == _header->read && !ProcessAlive(_header->writer_pid)) {
+            report.error(u"writer of shared memory ring %s has terminated", {_name});
+            break;
+        }
+    }
+    ::pthread_mutex_unlock(&_header->mutex);
+    return count;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Reader: release packets.
+//----------------------------------------------------------------------------
+
+void ts::SharedMemoryRing::commitRead(size_t count)
+{
+#if !defined(TS_WINDOWS)
+    if (isOpen() && !_writer && count > 0) {
+        lock(NULLREP);
+        _header->read += count;
+        ::pthread_cond_broadcast(&_header->cond);
+        ::pthread_mutex_unlock(&_header->mutex);
+    }
+#endif
+}
@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//!
+//!  @file
+//!  Ring of TS packets in shared memory between two processes.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Ring of TS packets in shared memory between two processes on the same host.
+    //!
+    //! One process, the writer, creates the ring. Another process, the reader,
+    //! attaches to the ring using its name. There is exactly one writer and one
+    //! reader. The packets are directly produced in the shared memory by the
+    //! writer and consumed by the reader, without copy through a pipe.
+    //!
+    //! The writer gets a contiguous free area using getWriteArea(), fills some
+    //! packets and publishes them using commitWrite(). Symmetrically, the reader
+    //! gets a contiguous area of available packets using getReadArea() and
+    //! releases them using commitRead(). The synchronization uses a process-shared
+    //! mutex and condition variable, only once per area, not once per packet.
+    //! On Linux, the mutex is robust: if one process terminates while holding
+    //! the mutex, the other one recovers it and considers its peer as closed.
+    //!
+    //! This class is implemented on UNIX systems only. On Windows, all operations
+    //! fail with an error.
+    //!
+    class TSDUCKDLL SharedMemoryRing
+    {
+    public:
+        //!
+        //! Default number of packets in the ring (approximately 6 MB).
+        //!
+        static const size_t DEFAULT_PACKET_COUNT = 32768;
+
+        //!
+        //! Name of the environment variable which is used to pass the name of the ring to a child process.
+        //!
+        static const UChar* const ENV_NAME;
+
+        //!
+        //! Maximum time the writer waits for a reader to attach, on a full ring or when closing the ring.
+        //!
+        static const MilliSecond ATTACH_TIMEOUT = 10000;
+
+        //!
+        //! Default constructor.
+        //!
+        SharedMemoryRing();
+
+        //!
+        //! Destructor.
+        //!
+        ~SharedMemoryRing();
+
+        //!
+        //! Create a new ring as the writer.
+        //! @param [in] name Name of the shared memory. If empty, a unique name is built.
+        //! @param [in] packet_count Number of packets in the ring.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool create(const UString& name, size_t packet_count, Report& report);
+
+        //!
+        //! Attach to an existing ring as the reader.
+        //! @param [in] name Name of the shared memory, as used by the writer.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool attach(const UString& name, Report& report);
+
+        //!
+        //! Close the ring.
+        //! When the writer closes the ring, the reader gets the remaining packets
+        //! and then an end of stream. When the reader closes the ring, the writer
+        //! gets an error on the next write. The name of the shared memory is removed
+        //! as soon as the reader is attached. If no reader is attached when the writer
+        //! closes the ring, the writer waits for a reader during at most ATTACH_TIMEOUT
+        //! so that a late reader still gets the packets. The memory is freed when both
+        //! processes have closed the ring.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Check if the ring is open.
+        //! @return True if the ring is open.
+        //!
+        bool isOpen() const
+        {
+            return _header != 0;
+        }
+
+        //!
+        //! Get the name of the shared memory.
+        //! @return The name of the shared memory.
+        //!
+        UString name() const
+        {
+            return _name;
+        }
+
+        //!
+        //! Writer: get a contiguous free area in the ring, wait for the reader if the ring is full.
+        //! @param [out] area Address of the first free packet in the ring.
+        //! @param [in,out] report Where to report errors.
+        //! @return Number of contiguous free packets at @a area, zero on error or if the reader is gone.
+        //!
+        size_t getWriteArea(TSPacket*& area, Report& report);
+
+        //!
+        //! Writer: publish packets which were written in the area from getWriteArea().
+        //! @param [in] count Number of packets to publish.
+        //!
+        void commitWrite(size_t count);
+
+        //!
+        //! Reader: get a contiguous area of available packets, wait for the writer if the ring is empty.
+        //! @param [out] area Address of the first available packet in the ring.
+        //! @param [in,out] report Where to report errors.
+        //! @return Number of contiguous packets at @a area, zero at end of stream or on error.
+        //!
+        size_t getReadArea(const TSPacket*& area, Report& report);
+
+        //!
+        //! Reader: release packets which were read in the area from getReadArea().
+        //! @param [in] count Number of packets to release.
+        //!
+        void commitRead(size_t count);
+
+    private:
+        struct Header;          // Header of the shared memory, defined in implementation.
+        UString   _name;        // Name of the shared memory.
+        bool      _writer;      // This is the writer side.
+        Header*   _header;      // Address of the mapped shared memory, zero when closed.
+        size_t    _map_size;    // Size of the mapped shared memory.
+        TSPacket* _packets;     // Address of the packet area.
+
+        // Release the mapping.
+        void unmap();
+
+        // Lock the mutex / wait on the condition variable for a polling interval (mutex held).
+        // Recover the mutex if its owner process terminated while holding it.
+        void lock(Report& report);
+        void wait(Report& report);
+        void recover(Report& report);
+
+        // Inaccessible operations
+        SharedMemoryRing(const SharedMemoryRing&) = delete;
+        SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+    };
+}
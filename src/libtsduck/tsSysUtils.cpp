@@ -41,6 +41,17 @@ TSDUCK_SOURCE;
 #include "tsComUtils.h"
 #endif
 
+#if defined(TS_LINUX)
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+#if defined(TS_MSC) && (defined(TS_I386) || defined(TS_X86_64))
+#include <intrin.h>
+#elif defined(TS_GCC) && (defined(TS_I386) || defined(TS_X86_64))
+#include <cpuid.h>
+#endif
+
 #if defined(TS_MAC)
 #include <sys/resource.h>
 #include <mach/mach.h>
@@ -348,6 +359,150 @@ size_t ts::MemoryPageSize()
 }
 
 
+//----------------------------------------------------------------------------
+// Check if the processor supports an instruction set extension.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Processor features, as a bit mask of 1 << CPUFeature, computed once.
+    uint32_t GetCPUFeatures()
+    {
+        uint32_t features = 0;
+
+#if (defined(TS_MSC) || defined(TS_GCC)) && (defined(TS_I386) || defined(TS_X86_64))
+
+        // CPUID leaf 1: ECX = basic feature flags. Leaf 7: EBX = extended feature flags.
+        uint32_t max_leaf = 0, ecx1 = 0, ebx7 = 0;
+#if defined(TS_MSC)
+        int regs[4];
+        ::__cpuid(regs, 0);
+        max_leaf = uint32_t(regs[0]);
+        if (max_leaf >= 1) {
+            ::__cpuid(regs, 1);
+            ecx1 = uint32_t(regs[2]);
+        }
+        if (max_leaf >= 7) {
+            ::__cpuidex(regs, 7, 0);
+            ebx7 = uint32_t(regs[1]);
+        }
+#else
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        max_leaf = ::__get_cpuid_max(0, 0);
+        if (max_leaf >= 1) {
+            __cpuid(1, eax, ebx, ecx, edx);
+            ecx1 = ecx;
+        }
+        if (max_leaf >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            ebx7 = ebx;
+        }
+#endif
+
+        if ((ecx1 & (1 << 9)) != 0) {
+            features |= 1 << ts::CPU_SSSE3;
+        }
+        if ((ecx1 & (1 << 19)) != 0) {
+            features |= 1 << ts::CPU_SSE41;
+        }
+        if ((ecx1 & (1 << 1)) != 0) {
+            features |= 1 << ts::CPU_PCLMUL;
+        }
+        if ((ecx1 & (1 << 25)) != 0) {
+            features |= 1 << ts::CPU_AESNI;
+        }
+
+        // AVX2 also requires the operating system to save the YMM registers (OSXSAVE and XCR0).
+        if ((ecx1 & (1 << 27)) != 0 && (ecx1 & (1 << 28)) != 0 && (ebx7 & (1 << 5)) != 0) {
+#if defined(TS_MSC)
+            const uint64_t xcr0 = ::_xgetbv(0);
+#else
+            uint32_t xcr0_lo = 0, xcr0_hi = 0;
+            __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+            const uint64_t xcr0 = (uint64_t(xcr0_hi) << 32) | xcr0_lo;
+#endif
+            if ((xcr0 & 0x06) == 0x06) {
+                features |= 1 << ts::CPU_AVX2;
+            }
+        }
+
+#endif
+        return features;
+    }
+}
+
+bool ts::CPUHasFeature(CPUFeature feature)
+{
+    static const uint32_t features = GetCPUFeatures();
+    return (features & (1 << feature)) != 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the NUMA node of a CPU.
+//----------------------------------------------------------------------------
+
+int ts::NUMANodeOfCPU(size_t cpu)
+{
+#if defined(TS_WINDOWS)
+
+    ::UCHAR node = 0;
+    return cpu < 256 && ::GetNumaProcessorNode(::UCHAR(cpu), &node) && node != 0xFF ? int(node) : -1;
+
+#elif defined(TS_LINUX)
+
+    // The sysfs directory of a CPU contains a link "nodeN" to its NUMA node.
+    const std::string pattern("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/node*");
+    ::glob_t gl;
+    int node = -1;
+    if (::glob(pattern.c_str(), 0, 0, &gl) == 0) {
+        if (gl.gl_pathc > 0) {
+            const char* name = ::strrchr(gl.gl_pathv[0], '/');
+            if (name != 0 && ::sscanf(name, "/node%d", &node) != 1) {
+                node = -1;
+            }
+        }
+        ::globfree(&gl);
+    }
+    return node;
+
+#else
+
+    return -1;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Place a memory area on a preferred NUMA node.
+//----------------------------------------------------------------------------
+
+ts::ErrorCode ts::SetMemoryNUMANode(void* address, size_t size, int node)
+{
+#if defined(TS_LINUX)
+
+    // The kernel uses one bit less than the specified maximum number of nodes.
+    if (node < 0 || node >= int(8 * sizeof(unsigned long) - 1)) {
+        return EINVAL;
+    }
+
+    // There is no libc wrapper for mbind() without libnuma, use the system call.
+    const unsigned long mask = 1UL << node;
+    const long status = ::syscall(SYS_mbind, address, size, MPOL_PREFERRED, &mask, 8 * sizeof(mask), MPOL_MF_MOVE);
+    return status == 0 ? SYS_SUCCESS : LastErrorCode();
+
+#elif defined(TS_WINDOWS)
+
+    return ERROR_NOT_SUPPORTED;
+
+#else
+
+    return ENOTSUP;
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Get current process id
 //----------------------------------------------------------------------------
@@ -783,6 +938,35 @@ void ts::GetProcessMetrics(ProcessMetrics& metrics)
 }
 
 
+//----------------------------------------------------------------------------
+// Get the CPU time of the calling thread.
+//----------------------------------------------------------------------------
+
+ts::NanoSecond ts::GetThreadCPUTime()
+{
+#if defined(TS_WINDOWS)
+
+    ::FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (::GetThreadTimes(::GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time) == 0) {
+        return -1;
+    }
+    // FILETIME values are in units of 100 nanoseconds.
+    const uint64_t kernel = (uint64_t(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+    const uint64_t user = (uint64_t(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+    return NanoSecond(kernel + user) * 100;
+
+#else
+
+    ::timespec ts;
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return -1;
+    }
+    return NanoSecond(ts.tv_sec) * NanoSecPerSec + NanoSecond(ts.tv_nsec);
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Ignore SIGPIPE. On UNIX systems: writing to a broken pipe returns an
 // error instead of killing the process. On Windows systems: does nothing.
@@ -207,6 +207,45 @@ namespace ts {
     //!
     TSDUCKDLL size_t MemoryPageSize();
 
+    //!
+    //! Processor instruction set extensions which are used by accelerated implementations.
+    //!
+    enum CPUFeature {
+        CPU_SSSE3,    //!< Intel x86: Supplemental SSE3 instructions.
+        CPU_SSE41,    //!< Intel x86: SSE 4.1 instructions.
+        CPU_PCLMUL,   //!< Intel x86: carry-less multiplication instruction (PCLMULQDQ).
+        CPU_AESNI,    //!< Intel x86: AES instructions (AES-NI).
+        CPU_AVX2,     //!< Intel x86: AVX2 instructions, including operating system support.
+    };
+
+    //!
+    //! Check if the processor supports an instruction set extension.
+    //! The processor is queried only once.
+    //! @param [in] feature The instruction set extension to check.
+    //! @return True if the processor supports @a feature, false otherwise.
+    //! Always false on processors of another architecture.
+    //!
+    TSDUCKDLL bool CPUHasFeature(CPUFeature feature);
+
+    //!
+    //! Get the NUMA node of a CPU.
+    //! @param [in] cpu CPU index, starting at zero.
+    //! @return The NUMA node of @a cpu or -1 if unknown or if the system has no NUMA support.
+    //!
+    TSDUCKDLL int NUMANodeOfCPU(size_t cpu);
+
+    //!
+    //! Place a memory area on a preferred NUMA node.
+    //! The pages of the area which are not yet in physical memory will be allocated on
+    //! the node when first touched. The pages which are already allocated are moved when
+    //! possible. The area shall be aligned on a memory page. Implemented on Linux only.
+    //! @param [in] address Address of the memory area.
+    //! @param [in] size Size in bytes of the memory area.
+    //! @param [in] node The NUMA node to use.
+    //! @return A system-specific error code, SYS_SUCCESS on success.
+    //!
+    TSDUCKDLL ErrorCode SetMemoryNUMANode(void* address, size_t size, int node);
+
     //!
     //! Integer type for process identifier
     //!
@@ -486,6 +525,12 @@ namespace ts {
     //!
     TSDUCKDLL void GetProcessMetrics(ProcessMetrics& metrics);
 
+    //!
+    //! Get the CPU time of the calling thread (user and system).
+    //! @return The CPU time of the calling thread in nanoseconds or -1 on error.
+    //!
+    TSDUCKDLL NanoSecond GetThreadCPUTime();
+
     //!
     //! Ensure that writing to a broken pipe does not kill the current process.
     //!
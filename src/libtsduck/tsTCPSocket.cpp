@@ -225,6 +225,24 @@ bool ts::TCPSocket::setNoDelay(bool active, Report& report)
 }
 
 
+bool ts::TCPSocket::setReceiveTimeout(MilliSecond timeout, Report& report)
+{
+    report.debug(u"setting socket receive timeout to %'d ms", {timeout});
+#if defined(TS_WINDOWS)
+    ::DWORD param = ::DWORD(timeout); // Actual socket option is a DWORD in milliseconds on Windows.
+#else
+    ::timeval param;
+    param.tv_sec = ::time_t(timeout / MilliSecPerSec);
+    param.tv_usec = suseconds_t((timeout % MilliSecPerSec) * 1000);
+#endif
+    if (::setsockopt(_sock, SOL_SOCKET, SO_RCVTIMEO, TS_SOCKOPT_T(&param), sizeof(param)) != 0) {
+        report.error(u"error setting socket receive timeout: %s", {SocketErrorCodeMessage()});
+        return false;
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Bind to a local address and port.
 //----------------------------------------------------------------------------
@@ -157,6 +157,15 @@ namespace ts {
         //!
         bool setNoDelay(bool active, Report& report = CERR);
 
+        //!
+        //! Set a timeout on receive operations.
+        //! When no data is received during this time, the receive operation fails.
+        //! @param [in] timeout Timeout in milliseconds. Zero means no timeout (the default).
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool setReceiveTimeout(MilliSecond timeout, Report& report = CERR);
+
         //!
         //! Bind to a local address and port.
         //!
@@ -88,18 +88,25 @@ ts::TSAnalyzer::TSAnalyzer(BitRate bitrate_hint) :
     _preceding_suspects(0),
     _min_error_before_suspect(1),
     _max_consecutive_suspects(1),
+    _slots(PID_MAX),
     _demux(this, this),
     _pes_demux(this),
     _t2mi_demux(this)
 {
+    // The analyzer collects all sections on all PSI PID's.
+    _demux.setHighThroughput(true);
+
+    // Only the audio/video attributes are needed, complete PES packets are not buffered.
+    _pes_demux.setStreaming(true);
+
     // Specify the PID filters to collect PSI tables.
-    _demux.addPID(PID_PAT);
-    _demux.addPID(PID_CAT);
-    _demux.addPID(PID_TSDT);
-    _demux.addPID(PID_NIT);
-    _demux.addPID(PID_RST);
-    _demux.addPID(PID_SDT);  // also BAT
-    _demux.addPID(PID_TDT);  // also TOT
+    addSectionPID(PID_PAT);
+    addSectionPID(PID_CAT);
+    addSectionPID(PID_TSDT);
+    addSectionPID(PID_NIT);
+    addSectionPID(PID_RST);
+    addSectionPID(PID_SDT);  // also BAT
+    addSectionPID(PID_TDT);  // also TOT
 }
 
 
@@ -162,11 +169,18 @@ void ts::TSAnalyzer::reset()
     _demux.reset();
     _pes_demux.reset();
 
+    // The PID contexts are gone, the section demux filter is reset.
+    // The T2-MI demux is not reset, keep its routes.
+    for (PIDSlotVector::iterator it = _slots.begin(); it != _slots.end(); ++it) {
+        it->context = 0;
+        it->route &= ~ROUTE_SECTIONS;
+    }
+
     // Specify the PID filters to collect PSI tables.
-    _demux.addPID(PID_PAT);
-    _demux.addPID(PID_CAT);
-    _demux.addPID(PID_SDT);  // also BAT
-    _demux.addPID(PID_TDT);  // also TOT
+    addSectionPID(PID_PAT);
+    addSectionPID(PID_CAT);
+    addSectionPID(PID_SDT);  // also BAT
+    addSectionPID(PID_TDT);  // also TOT
 }
 
 
@@ -444,7 +458,10 @@ ts::TSAnalyzer::PIDContextPtr ts::TSAnalyzer::getPID(PID pid, const UString& des
     const PIDContextPtr p(_pids[pid]);
     if (p.isNull()) {
         // The PID was not yet used, map entry just created.
-        return _pids[pid] = new PIDContext(pid, description);
+        PIDContextPtr& np(_pids[pid]);
+        np = new PIDContext(pid, description);
+        _slots[pid].context = np.pointer();
+        return np;
     }
     else {
         return p;
@@ -452,6 +469,23 @@ ts::TSAnalyzer::PIDContextPtr ts::TSAnalyzer::getPID(PID pid, const UString& des
 }
 
 
+//----------------------------------------------------------------------------
+// Add a PID to the section demux or T2-MI demux and update the dispatch table.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::addSectionPID(PID pid)
+{
+    _demux.addPID(pid);
+    _slots[pid].route |= ROUTE_SECTIONS;
+}
+
+void ts::TSAnalyzer::addT2MIPID(PID pid)
+{
+    _t2mi_demux.addPID(pid);
+    _slots[pid].route |= ROUTE_T2MI;
+}
+
+
 //----------------------------------------------------------------------------
 //  Return a service context. Allocate a new entry if service not found.
 //----------------------------------------------------------------------------
@@ -551,31 +585,23 @@ void ts::TSAnalyzer::handleTable(SectionDemux&, const BinaryTable& table)
     // Process specific tables
     switch (tid) {
         case TID_PAT: {
-            PAT pat(table);
-            if (pid == PID_PAT && pat.isValid()) {
-                analyzePAT(pat);
+            if (pid == PID_PAT) {
+                analyzePAT(table);
             }
             break;
         }
         case TID_CAT: {
-            CAT cat(table);
-            if (pid == PID_CAT && cat.isValid()) {
-                analyzeCAT(cat);
+            if (pid == PID_CAT) {
+                analyzeCAT(table);
             }
             break;
         }
         case TID_PMT: {
-            PMT pmt(table);
-            if (pmt.isValid()) {
-                analyzePMT(pid, pmt);
-            }
+            analyzePMT(pid, table);
             break;
         }
         case TID_SDT_ACT: {
-            SDT sdt(table);
-            if (sdt.isValid()) {
-                analyzeSDT(sdt);
-            }
+            analyzeSDT(table);
             break;
         }
         case TID_TDT: {
@@ -603,27 +629,39 @@ void ts::TSAnalyzer::handleTable(SectionDemux&, const BinaryTable& table)
 // Analyze a PAT
 //----------------------------------------------------------------------------
 
-void ts::TSAnalyzer::analyzePAT(const PAT& pat)
+void ts::TSAnalyzer::analyzePAT(const BinaryTable& table)
 {
-    // Get the transport stream id
-    _ts_id = pat.ts_id;
-    _ts_id_valid = true;
-
-    // Get all PMT PID's for all services
-    for (PAT::ServiceMap::const_iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
-        uint16_t service_id(it->first);
-        PID pmt_pid(it->second);
-        // Register the PMT PID
-        PIDContextPtr ps(getPID(pmt_pid));
-        ps->description = u"PMT";
-        ps->addService(service_id);
-        ps->is_pmt_pid = true;
-        ps->carry_section = true;
-        // Add a filter on the referenced PID to get the PMT
-        _demux.addPID(pmt_pid);
-        // Describe the service
-        ServiceContextPtr svp(getService(service_id));
-        svp->pmt_pid = pmt_pid;
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
+
+        const PATView pat(*table.sectionAt(si));
+        if (!pat.isValid()) {
+            continue;
+        }
+
+        // Get the transport stream id
+        _ts_id = pat.tsId();
+        _ts_id_valid = true;
+
+        // Get all PMT PID's for all services
+        const PATView::ProgramLoop programs(pat.programs());
+        for (PATView::ProgramLoop::const_iterator it = programs.begin(); it != programs.end(); ++it) {
+            const uint16_t service_id = it->serviceId();
+            const PID pmt_pid = it->pmtPID();
+            if (service_id == 0) {
+                continue; // NIT PID
+            }
+            // Register the PMT PID
+            PIDContextPtr ps(getPID(pmt_pid));
+            ps->description = u"PMT";
+            ps->addService(service_id);
+            ps->is_pmt_pid = true;
+            ps->carry_section = true;
+            // Add a filter on the referenced PID to get the PMT
+            addSectionPID(pmt_pid);
+            // Describe the service
+            ServiceContextPtr svp(getService(service_id));
+            svp->pmt_pid = pmt_pid;
+        }
     }
 }
 
@@ -632,10 +670,15 @@ void ts::TSAnalyzer::analyzePAT(const PAT& pat)
 // Analyze a CAT
 //----------------------------------------------------------------------------
 
-void ts::TSAnalyzer::analyzeCAT(const CAT& cat)
+void ts::TSAnalyzer::analyzeCAT(const BinaryTable& table)
 {
     // Analyze the CA descritors to find EMM PIDs
-    analyzeDescriptors(cat.descs);
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
+        const Section& sect(*table.sectionAt(si));
+        if (sect.isValid() && sect.tableId() == TID_CAT) {
+            analyzeDescriptors(DescriptorLoopView(sect.payload(), sect.payloadSize()));
+        }
+    }
 }
 
 
@@ -643,52 +686,65 @@ void ts::TSAnalyzer::analyzeCAT(const CAT& cat)
 // Analyze a PMT
 //----------------------------------------------------------------------------
 
-void ts::TSAnalyzer::analyzePMT(PID pid, const PMT& pmt)
+void ts::TSAnalyzer::analyzePMT(PID pid, const BinaryTable& table)
 {
     // Count the number of PMT's on this PID
-    PIDContextPtr ps(getPID(pid));
-    ps->pmt_cnt++;
+    PIDContextPtr pmt_ps(getPID(pid));
+    pmt_ps->pmt_cnt++;
 
-    // Get service description
-    ServiceContextPtr svp(getService(pmt.service_id));
+    // A PMT normally has only one section but all sections are analyzed.
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
 
-    // Check that this PMT was expected on this PID
-    if (svp->pmt_pid != pid) {
-        // PAT/PMT inconsistency: Found a PMT on a PID which was not
-        // referenced as a PMT PID in the PAT.
-        ps->addService(pmt.service_id);
-        ps->description = u"PMT";
-    }
-
-    // Locate PCR PID
-    if (pmt.pcr_pid != 0 && pmt.pcr_pid != PID_NULL) {
-        svp->pcr_pid = pmt.pcr_pid;
-        // This PID is the PCR PID for this service. Initial description
-        // will normally be replaced later by "Audio", "Video", etc.
-        // Some encoders, however, generate a dedicated PID for PCR's.
-        ps = getPID(pmt.pcr_pid, u"PCR (not otherwise referenced)");
-        ps->is_pcr_pid = true;
-        ps->addService(pmt.service_id);
-    }
-
-    // Process "program info" list of descriptors.
-    analyzeDescriptors(pmt.descs, svp.pointer());
-
-    // Process all "elementary stream info"
-    for (PMT::StreamMap::const_iterator it = pmt.streams.begin(); it != pmt.streams.end(); ++it) {
-        const PID es_pid = it->first;
-        const PMT::Stream& stream(it->second);
-        ps = getPID(es_pid);
-        ps->addService(pmt.service_id);
-        ps->carry_audio = ps->carry_audio || IsAudioST(stream.stream_type);
-        ps->carry_video = ps->carry_video || IsVideoST(stream.stream_type);
-        ps->carry_pes = ps->carry_pes || IsPES(stream.stream_type);
-        if (!ps->carry_section && !ps->carry_t2mi && IsSectionST(stream.stream_type)) {
-            ps->carry_section = true;
-            _demux.addPID(es_pid);
+        const PMTView pmt(*table.sectionAt(si));
+        if (!pmt.isValid()) {
+            continue;
+        }
+        const uint16_t service_id = pmt.serviceId();
+        const PID pcr_pid = pmt.pcrPID();
+
+        // Get service description
+        ServiceContextPtr svp(getService(service_id));
+
+        // Check that this PMT was expected on this PID
+        if (svp->pmt_pid != pid) {
+            // PAT/PMT inconsistency: Found a PMT on a PID which was not
+            // referenced as a PMT PID in the PAT.
+            pmt_ps->addService(service_id);
+            pmt_ps->description = u"PMT";
+        }
+
+        // Locate PCR PID
+        PIDContextPtr ps;
+        if (pcr_pid != 0 && pcr_pid != PID_NULL) {
+            svp->pcr_pid = pcr_pid;
+            // This PID is the PCR PID for this service. Initial description
+            // will normally be replaced later by "Audio", "Video", etc.
+            // Some encoders, however, generate a dedicated PID for PCR's.
+            ps = getPID(pcr_pid, u"PCR (not otherwise referenced)");
+            ps->is_pcr_pid = true;
+            ps->addService(service_id);
+        }
+
+        // Process "program info" list of descriptors.
+        analyzeDescriptors(pmt.descriptors(), svp.pointer());
+
+        // Process all "elementary stream info"
+        const PMTView::StreamLoop streams(pmt.streams());
+        for (PMTView::StreamLoop::const_iterator it = streams.begin(); it != streams.end(); ++it) {
+            const PID es_pid = it->pid();
+            const uint8_t stream_type = it->streamType();
+            ps = getPID(es_pid);
+            ps->addService(service_id);
+            ps->carry_audio = ps->carry_audio || IsAudioST(stream_type);
+            ps->carry_video = ps->carry_video || IsVideoST(stream_type);
+            ps->carry_pes = ps->carry_pes || IsPES(stream_type);
+            if (!ps->carry_section && !ps->carry_t2mi && IsSectionST(stream_type)) {
+                ps->carry_section = true;
+                addSectionPID(es_pid);
+            }
+            ps->description = names::StreamType(stream_type);
+            analyzeDescriptors(it->descriptors(), svp.pointer(), ps.pointer());
         }
-        ps->description = names::StreamType(stream.stream_type);
-        analyzeDescriptors(stream.descs, svp.pointer(), ps.pointer());
     }
 }
 
@@ -697,23 +753,32 @@ void ts::TSAnalyzer::analyzePMT(PID pid, const PMT& pmt)
 // Analyze an SDT
 //----------------------------------------------------------------------------
 
-void ts::TSAnalyzer::analyzeSDT(const SDT& sdt)
+void ts::TSAnalyzer::analyzeSDT(const BinaryTable& table)
 {
-    // Register characteristics of all services
-    for (SDT::ServiceMap::const_iterator it = sdt.services.begin(); it != sdt.services.end(); ++it) {
-
-        ServiceContextPtr svp(getService(it->first)); // it->first = map key = service id
-        svp->orig_netw_id = sdt.onetw_id;
-        svp->service_type = it->second.serviceType();
-
-        // Replace names only if they are not empty.
-        const UString provider(it->second.providerName());
-        const UString name(it->second.serviceName());
-        if (!provider.empty()) {
-            svp->provider = provider;
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
+
+        const SDTView sdt(*table.sectionAt(si));
+        if (!sdt.isValid()) {
+            continue;
         }
-        if (!name.empty()) {
-            svp->name = name;
+
+        // Register characteristics of all services
+        const SDTView::ServiceLoop services(sdt.services());
+        for (SDTView::ServiceLoop::const_iterator it = services.begin(); it != services.end(); ++it) {
+
+            ServiceContextPtr svp(getService(it->serviceId()));
+            svp->orig_netw_id = sdt.originalNetworkId();
+            svp->service_type = it->serviceType();
+
+            // Replace names only if they are not empty.
+            const UString provider(it->providerName());
+            const UString name(it->serviceName());
+            if (!provider.empty()) {
+                svp->provider = provider;
+            }
+            if (!name.empty()) {
+                svp->name = name;
+            }
         }
     }
 }
@@ -788,16 +853,16 @@ ts::UString ts::TSAnalyzer::PIDContext::fullDescription(bool include_attributes)
 //  If ps is not 0, we are in the description of this PID in a PMT.
 //----------------------------------------------------------------------------
 
-void ts::TSAnalyzer::analyzeDescriptors(const DescriptorList& descs, ServiceContext* svp, PIDContext* ps)
+void ts::TSAnalyzer::analyzeDescriptors(const DescriptorLoopView& descs, ServiceContext* svp, PIDContext* ps)
 {
-    for (size_t di = 0; di < descs.count(); ++di) {
+    for (DescriptorLoopView::const_iterator it = descs.begin(); it != descs.end(); ++it) {
 
-        const uint8_t* data(descs[di]->payload());
-        size_t size(descs[di]->payloadSize());
+        const uint8_t* data(it->payload());
+        size_t size(it->payloadSize());
 
-        switch (descs[di]->tag()) {
+        switch (it->tag()) {
             case DID_CA: {
-                analyzeCADescriptor(*descs[di], svp, ps);
+                analyzeCADescriptor(*it, svp, ps);
                 break;
             }
             case DID_LANGUAGE: {
@@ -921,7 +986,7 @@ void ts::TSAnalyzer::analyzeDescriptors(const DescriptorList& descs, ServiceCont
 //  If svp is 0, we are in the CAT.
 //----------------------------------------------------------------------------
 
-void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext* svp, PIDContext* ps)
+void ts::TSAnalyzer::analyzeCADescriptor(const DescriptorView& desc, ServiceContext* svp, PIDContext* ps)
 {
     const uint8_t* data(desc.payload());
     size_t size(desc.payloadSize());
@@ -950,7 +1015,7 @@ void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext*
             eps->cas_id = ca_sysid;
             eps->cas_operators.insert(opi);
             eps->carry_section = true;
-            _demux.addPID(ca_pid);
+            addSectionPID(ca_pid);
             eps->description = UString::Format(u"MediaGuard ECM for OPI %d (0x%X)", {opi, opi});
             data += 15; size -= 15;
         }
@@ -967,7 +1032,7 @@ void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext*
         eps->cas_id = ca_sysid;
         eps->cas_operators.insert(opi);
         eps->carry_section = true;
-        _demux.addPID(ca_pid);
+        addSectionPID(ca_pid);
         eps->description = UString::Format(u"MediaGuard EMM for OPI %d (0x%X), EMM types: 0x%X", {opi, opi, etypes});
     }
 
@@ -981,7 +1046,7 @@ void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext*
         eps->carry_emm = true;
         eps->cas_id = ca_sysid;
         eps->carry_section = true;
-        _demux.addPID(ca_pid);
+        addSectionPID(ca_pid);
         eps->description = u"MediaGuard Individual EMM";
 
         while (nb_opi > 0 && size >= 4) {
@@ -993,7 +1058,7 @@ void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext*
             eps1->cas_id = ca_sysid;
             eps1->cas_operators.insert(opi);
             eps1->carry_section = true;
-            _demux.addPID(ca_pid);
+            addSectionPID(ca_pid);
             eps1->description = UString::Format(u"MediaGuard Group EMM for OPI %d (0x%X)", {opi, opi});
             data += 4; size -= 4; nb_opi--;
         }
@@ -1008,7 +1073,7 @@ void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext*
         eps->carry_emm = true;
         eps->cas_id = ca_sysid;
         eps->carry_section = true;
-        _demux.addPID(ca_pid);
+        addSectionPID(ca_pid);
         eps->description = u"SafeAccess EMM";
 
         while (size >= 2) {
@@ -1031,7 +1096,7 @@ void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext*
         eps->referenced = true;
         eps->cas_id = ca_sysid;
         eps->carry_section = true;
-        _demux.addPID(ca_pid);
+        addSectionPID(ca_pid);
 
         if (svp == 0) {
             // No service, this is an EMM PID
@@ -1073,7 +1138,7 @@ void ts::TSAnalyzer::analyzeCADescriptor(const Descriptor& desc, ServiceContext*
         eps->referenced = true;
         eps->cas_id = ca_sysid;
         eps->carry_section = true;
-        _demux.addPID(ca_pid);
+        addSectionPID(ca_pid);
 
         if (svp == 0) {
             // No service, this is an EMM PID
@@ -1155,7 +1220,7 @@ void ts::TSAnalyzer::handleT2MINewPID(T2MIDemux& demux, const PMT& pmt, PID pid,
     pc->carry_section = false;
 
     // And demux all T2-MI packets.
-    _t2mi_demux.addPID(pid);
+    addT2MIPID(pid);
 }
 
 
@@ -1248,13 +1313,23 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
     _preceding_errors = 0;
     _preceding_suspects = 0;
 
-    // Feed packets into the various demux
-    _demux.feedPacket(pkt);
-    _pes_demux.feedPacket(pkt);
-    _t2mi_demux.feedPacket(pkt);
+    // Route the packet to the demux which need it, using one single PID lookup.
+    // PSI PID's never carry PES packets. The T2-MI demux needs PSI PID's to
+    // locate T2-MI streams in PMT's.
+    const PID pid = pkt.getPID();
+    const PIDSlot& slot(_slots[pid]);
+    if ((slot.route & ROUTE_SECTIONS) != 0) {
+        _demux.feedPacket(pkt);
+    }
+    else {
+        _pes_demux.feedPacket(pkt);
+    }
+    if (slot.route != 0) {
+        _t2mi_demux.feedPacket(pkt);
+    }
 
     // Get PID context
-    PIDContextPtr ps(getPID(pkt.getPID()));
+    PIDContext* const ps = slot.context != 0 ? slot.context : getPID(pid).pointer();
     ps->ts_pkt_cnt++;
 
     // Accumulate stat from packet
@@ -44,6 +44,7 @@
 #include "tsSDT.h"
 #include "tsTDT.h"
 #include "tsTOT.h"
+#include "tsTableViews.h"
 #include "tsTime.h"
 #include "tsUString.h"
 #include "tsSafePtr.h"
@@ -432,8 +433,28 @@ namespace ts {
         // Constant string "Unreferenced"
         static const UString UNREFERENCED;
 
+        // Demux routing flags in a PID slot.
+        enum {
+            ROUTE_SECTIONS = 0x01,  // PID is filtered by the section demux.
+            ROUTE_T2MI     = 0x02,  // PID is filtered by the T2-MI demux.
+        };
+
+        // Per-PID dispatch slot, directly indexed by PID value.
+        // The PID context is owned by _pids, the slot only caches its address.
+        struct PIDSlot
+        {
+            PIDContext* context;  // PID context, zero if not yet allocated.
+            uint8_t     route;    // Combination of ROUTE_* flags.
+            PIDSlot() : context(0), route(0) {}
+        };
+        typedef std::vector<PIDSlot> PIDSlotVector;
+
         // Check if a PID context exists.
-        bool pidExists(PID pid) const {return _pids.find(pid) != _pids.end();}
+        bool pidExists(PID pid) const {return _slots[pid].context != 0;}
+
+        // Add a PID to the section demux or T2-MI demux and update the dispatch table.
+        void addSectionPID(PID pid);
+        void addT2MIPID(PID pid);
 
         // Return a PID context. Allocate a new entry if PID not found.
         PIDContextPtr getPID(PID pid, const UString& description = UNREFERENCED);
@@ -444,24 +465,25 @@ namespace ts {
         // Return a service context. Allocate a new entry if service not found.
         ServiceContextPtr getService(uint16_t service_id);
 
-        // Analyze the various PSI tables
-        void analyzePAT(const PAT&);
-        void analyzeCAT(const CAT&);
-        void analyzePMT(PID pid, const PMT&);
-        void analyzeSDT(const SDT&);
+        // Analyze the various PSI tables.
+        // PAT, CAT, PMT and SDT are analyzed in place, using views of their sections.
+        void analyzePAT(const BinaryTable&);
+        void analyzeCAT(const BinaryTable&);
+        void analyzePMT(PID pid, const BinaryTable&);
+        void analyzeSDT(const BinaryTable&);
         void analyzeTDT(const TDT&);
         void analyzeTOT(const TOT&);
 
         // Analyse a list of descriptors.
         // If svp is not 0, we are in the PMT of the specified service.
         // If ps is not 0, we are in the description of this PID in a PMT.
-        void analyzeDescriptors(const DescriptorList& descs, ServiceContext* svp = 0, PIDContext* ps = 0);
+        void analyzeDescriptors(const DescriptorLoopView& descs, ServiceContext* svp = 0, PIDContext* ps = 0);
 
         // Analyse one CA descriptor, either from the CAT or a PMT.
         // If svp is not 0, we are in the PMT of the specified service.
         // If ps is not 0, we are in the description of this PID in a PMT.
         // If svp is 0, we are in the CAT.
-        void analyzeCADescriptor(const Descriptor& desc, ServiceContext* svp = 0, PIDContext* ps = 0);
+        void analyzeCADescriptor(const DescriptorView& desc, ServiceContext* svp = 0, PIDContext* ps = 0);
 
         // Implementation of TableHandlerInterface
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
@@ -488,6 +510,7 @@ namespace ts {
         uint64_t     _preceding_suspects;        // Number of contiguous suspects packets before current packet
         uint64_t     _min_error_before_suspect;  // Required number of invalid packets before starting suspect
         uint64_t     _max_consecutive_suspects;  // Max number of consecutive suspect packets before clearing suspect
+        PIDSlotVector _slots;                   // Dispatch table, indexed by PID
         SectionDemux _demux;                     // PSI tables analysis
         PESDemux     _pes_demux;                 // Audio/video analysis
         T2MIDemux    _t2mi_demux;                // T2-MI analysis
@@ -34,8 +34,181 @@
 #include "tsTSFileInput.h"
 #include "tsNullReport.h"
 #include "tsSysUtils.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
+const size_t ts::TSFileInput::READ_AHEAD_PACKETS;
+const size_t ts::TSFileInput::READ_AHEAD_BUFFERS;
+const size_t ts::TSFileInput::MMAP_WINDOW_SIZE;
+
+// Interval in milliseconds to check thread termination while waiting for input on a pipe.
+#define READ_AHEAD_POLL_MS 100
+
+
+//----------------------------------------------------------------------------
+// Background read-ahead thread (READ_AHEAD mode).
+// A ring of buffers is filled by the thread and read by the application.
+//----------------------------------------------------------------------------
+
+class ts::TSFileInput::ReadAhead: public Thread, private AbortInterface
+{
+public:
+    // Constructor and destructor.
+    ReadAhead(TSFileInput* input);
+    virtual ~ReadAhead() override;
+
+    // Get packets from the first filled buffer, wait for it if necessary.
+    // Return zero at end of file or on error, with error_code and seek_error set.
+    size_t get(const TSPacket*& packets, size_t max_packets, ErrorCode& error_code, bool& seek_error);
+
+    // Terminate the thread and wait for its termination.
+    void stop();
+
+private:
+    TSFileInput*   _input;
+    mutable Mutex  _mutex;
+    Condition      _not_empty;   // Signaled when a buffer is filled or at end.
+    Condition      _not_full;    // Signaled when a buffer is released or on stop.
+    TSPacketVector _buffers[READ_AHEAD_BUFFERS];
+    size_t         _counts[READ_AHEAD_BUFFERS];
+    size_t         _first;       // Index of first filled buffer, read by the application.
+    size_t         _filled;      // Number of filled buffers.
+    size_t         _offset;      // Index of next packet to return in first buffer.
+    bool           _end;         // No more buffer will be filled.
+    bool           _terminate;   // Request to terminate the thread.
+    ErrorCode      _error_code;  // Error from the thread.
+    bool           _seek_error;  // The error occured when rewinding the file.
+
+    // Thread main code.
+    virtual void main() override;
+
+    // Implementation of AbortInterface, check if the thread shall terminate while reading a pipe.
+    virtual bool aborting() const override;
+
+    // Inaccessible operations
+    ReadAhead() = delete;
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+};
+
+ts::TSFileInput::ReadAhead::ReadAhead(TSFileInput* input) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetHighPriority())),
+    _input(input),
+    _mutex(),
+    _not_empty(),
+    _not_full(),
+    _buffers(),
+    _counts(),
+    _first(0),
+    _filled(0),
+    _offset(0),
+    _end(false),
+    _terminate(false),
+    _error_code(0),
+    _seek_error(false)
+{
+    for (size_t i = 0; i < READ_AHEAD_BUFFERS; ++i) {
+        _buffers[i].resize(READ_AHEAD_PACKETS);
+        _counts[i] = 0;
+    }
+}
+
+ts::TSFileInput::ReadAhead::~ReadAhead()
+{
+    stop();
+}
+
+void ts::TSFileInput::ReadAhead::stop()
+{
+    {
+        GuardCondition lock(_mutex, _not_full);
+        _terminate = true;
+        lock.signal();
+    }
+    waitForTermination();
+}
+
+bool ts::TSFileInput::ReadAhead::aborting() const
+{
+    Guard lock(_mutex);
+    return _terminate;
+}
+
+void ts::TSFileInput::ReadAhead::main()
+{
+    for (;;) {
+        size_t index = 0;
+
+        // Wait for a free buffer.
+        {
+            GuardCondition lock(_mutex, _not_full);
+            while (_filled >= READ_AHEAD_BUFFERS && !_terminate) {
+                lock.waitCondition();
+            }
+            if (_terminate) {
+                break;
+            }
+            index = (_first + _filled) % READ_AHEAD_BUFFERS;
+        }
+
+        // Fill the buffer without holding the mutex. The application does not
+        // use this buffer and does not access the file while the thread runs.
+        ErrorCode error_code = 0;
+        bool seek_error = false;
+        const size_t count = _input->readRaw(&_buffers[index][0], READ_AHEAD_PACKETS, error_code, seek_error, this);
+
+        // Publish the buffer.
+        GuardCondition lock(_mutex, _not_empty);
+        _counts[index] = count;
+        if (count > 0) {
+            _filled++;
+        }
+        else {
+            _end = true;
+            _error_code = error_code;
+            _seek_error = seek_error;
+        }
+        lock.signal();
+        if (_end) {
+            break;
+        }
+    }
+}
+
+size_t ts::TSFileInput::ReadAhead::get(const TSPacket*& packets, size_t max_packets, ErrorCode& error_code, bool& seek_error)
+{
+    GuardCondition lock(_mutex, _not_empty);
+
+    // Release the first buffer when all its packets were returned in previous calls.
+    if (_filled > 0 && _offset >= _counts[_first]) {
+        _first = (_first + 1) % READ_AHEAD_BUFFERS;
+        _filled--;
+        _offset = 0;
+        _not_full.signal();
+    }
+
+    // Wait for a filled buffer.
+    while (_filled == 0 && !_end) {
+        lock.waitCondition();
+    }
+    if (_filled == 0) {
+        error_code = _error_code;
+        seek_error = _seek_error;
+        return 0;
+    }
+
+    // Return packets from the first buffer. The buffer is not released
+    // now since the application is going to read the packets.
+    const size_t count = std::min(max_packets, _counts[_first] - _offset);
+    packets = &_buffers[_first][_offset];
+    _offset += count;
+    return count;
+}
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -51,11 +224,21 @@ ts::TSFileInput::TSFileInput() :
     _severity(Severity::Error),
     _at_eof(false),
     _rewindable(false),
+    _regular(false),
+    _mode(READ_PLAIN),
+    _active_mode(READ_PLAIN),
 #if defined(TS_WINDOWS)
-    _handle(INVALID_HANDLE_VALUE)
+    _handle(INVALID_HANDLE_VALUE),
 #else
-    _fd(-1)
+    _fd(-1),
 #endif
+    _position(0),
+    _file_size(0),
+    _map_offset(0),
+    _map_base(0),
+    _map_size(0),
+    _buffer(),
+    _read_ahead(0)
 {
 }
 
@@ -211,10 +394,46 @@ bool ts::TSFileInput::openInternal (Report& report)
         return false;
     }
 
+#endif
+
+    // Pipes and terminals may block the read-ahead thread and cannot be mapped.
+#if defined(TS_WINDOWS)
+    _regular = ::GetFileType(_handle) == FILE_TYPE_DISK;
+#else
+    struct stat st;
+    _regular = ::fstat(_fd, &st) == 0 && S_ISREG(st.st_mode);
+#endif
+
+    // Select the read mode.
+    _active_mode = _mode;
+    if (_mode == READ_MMAP) {
+#if defined(TS_WINDOWS)
+        report.verbose(u"memory-mapped input not supported on this platform, using plain reads");
+        _active_mode = READ_PLAIN;
+#else
+        if (!_regular) {
+            report.verbose(u"%s is not a regular file, cannot be memory-mapped, using plain reads", {_filename.empty() ? u"standard input" : _filename});
+            _active_mode = READ_PLAIN;
+        }
+        else {
+            _file_size = uint64_t(st.st_size);
+            _position = _start_offset;
+        }
+#endif
+    }
+
+#if defined(TS_LINUX)
+    // Tell the kernel that the file is read sequentially (larger read-ahead window).
+    // This is just an hint, errors are ignored. Fail silently on pipes.
+    ::posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 #endif
 
     _is_open = true;
     _total_packets = 0;
+
+    if (_active_mode == READ_AHEAD) {
+        startReadAhead();
+    }
     return true;
 }
 
@@ -225,6 +444,33 @@ bool ts::TSFileInput::openInternal (Report& report)
 
 bool ts::TSFileInput::seekInternal(uint64_t index, Report& report)
 {
+    // The read-ahead thread must not access the file while we seek.
+    const bool read_ahead = _read_ahead != 0;
+    if (read_ahead) {
+        stopReadAhead();
+    }
+
+    ErrorCode error_code = 0;
+    if (!seekRaw(index, error_code)) {
+        report.log(_severity, u"error seeking input file %s: %s", {_filename, ErrorCodeMessage(error_code)});
+        return false;
+    }
+
+    if (read_ahead) {
+        startReadAhead();
+    }
+    return true;
+}
+
+bool ts::TSFileInput::seekRaw(uint64_t index, ErrorCode& error_code)
+{
+    if (_active_mode == READ_MMAP) {
+        // No system call, simply move the read position.
+        _position = _start_offset + index;
+        _at_eof = false;
+        return true;
+    }
+
 #if defined (TS_WINDOWS)
     // In Win32, LARGE_INTEGER is a 64-bit structure, not an integer type
     uint64_t where = _start_offset + index;
@@ -233,8 +479,7 @@ bool ts::TSFileInput::seekInternal(uint64_t index, Report& report)
 #else
     if (::lseek(_fd, off_t(_start_offset + index), SEEK_SET) == off_t(-1)) {
 #endif
-        ErrorCode error_code = LastErrorCode();
-        report.log(_severity, u"error seeking input file %s: %s", {_filename, ErrorCodeMessage(error_code)});
+        error_code = LastErrorCode();
         return false;
     }
     else {
@@ -276,6 +521,9 @@ bool ts::TSFileInput::close(Report& report)
         return false;
     }
 
+    stopReadAhead();
+    unmapWindow();
+
     if (!_filename.empty()) {
 #if defined (TS_WINDOWS)
         ::CloseHandle(_handle);
@@ -287,6 +535,7 @@ bool ts::TSFileInput::close(Report& report)
     _is_open = false;
     _total_packets = 0;
     _filename.clear();
+    _buffer.clear();
 
     return true;
 }
@@ -304,6 +553,88 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
         return 0;
     }
 
+    if (_active_mode == READ_PLAIN) {
+        // Directly read into the user's buffer.
+        ErrorCode error_code = 0;
+        bool seek_error = false;
+        const size_t count = readRaw(buffer, max_packets, error_code, seek_error);
+        if (count == 0 && error_code != 0) {
+            report.log(_severity, u"error %s file %s: %s (%d)", {seek_error ? u"seeking input" : u"reading", _filename, ErrorCodeMessage(error_code), error_code});
+        }
+        _total_packets += count;
+        return count;
+    }
+
+    // Copy packets from the memory-mapped file or the read-ahead buffers.
+    size_t count = 0;
+    while (count < max_packets) {
+        const TSPacket* packets = 0;
+        const size_t got = readInPlace(packets, max_packets - count, report);
+        if (got == 0) {
+            break;
+        }
+        ::memcpy(buffer + count, packets, got * PKT_SIZE);
+        count += got;
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Read TS packets without copying them in a user buffer.
+//----------------------------------------------------------------------------
+
+size_t ts::TSFileInput::readInPlace(const TSPacket*& packets, size_t max_packets, Report& report)
+{
+    if (!_is_open) {
+        report.log(_severity, u"not open");
+        return 0;
+    }
+
+    size_t count = 0;
+    ErrorCode error_code = 0;
+    bool seek_error = false;
+
+    switch (_active_mode) {
+        case READ_MMAP: {
+            return readMapped(packets, max_packets, report);
+        }
+        case READ_AHEAD: {
+            assert(_read_ahead != 0);
+            count = _read_ahead->get(packets, max_packets, error_code, seek_error);
+            break;
+        }
+        case READ_PLAIN:
+        default: {
+            // Read in internal buffer.
+            if (_buffer.size() < max_packets) {
+                _buffer.resize(max_packets);
+            }
+            count = max_packets == 0 ? 0 : readRaw(&_buffer[0], max_packets, error_code, seek_error);
+            packets = count == 0 ? 0 : &_buffer[0];
+            break;
+        }
+    }
+
+    if (count == 0 && error_code != 0) {
+        report.log(_severity, u"error %s file %s: %s (%d)", {seek_error ? u"seeking input" : u"reading", _filename, ErrorCodeMessage(error_code), error_code});
+    }
+    _total_packets += count;
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Read TS packets using system calls. Return the actual number of read packets.
+// Returning zero means error or end of file repetition. Errors are not
+// reported, they are returned in error_code.
+//----------------------------------------------------------------------------
+
+size_t ts::TSFileInput::readRaw(TSPacket* buffer, size_t max_packets, ErrorCode& error_code, bool& seek_error, const AbortInterface* abort)
+{
+    error_code = 0;
+    seek_error = false;
+
     if (_at_eof) {
         return 0;
     }
@@ -312,7 +643,6 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
     const size_t req_size = max_packets * PKT_SIZE;
     size_t got_size = 0;
     bool got_error = false;
-    ErrorCode error_code = 0;
 
     // Loop on read until we get enough
     while (got_size < req_size && !_at_eof && !got_error) {
@@ -333,6 +663,21 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
         }
 #else
         // UNIX implementation
+        // On pipes and terminals, wait for input data with a timeout so that the read can be
+        // aborted. When the input stalls, return the complete packets which were already read.
+        if (abort != 0 && !_regular) {
+            ::pollfd pfd;
+            pfd.fd = _fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            const int ready = ::poll(&pfd, 1, READ_AHEAD_POLL_MS);
+            if (ready == 0 || (ready < 0 && errno == EINTR)) {
+                if (abort->aborting() || (got_size > 0 && got_size % PKT_SIZE == 0)) {
+                    break;
+                }
+                continue;
+            }
+        }
         ssize_t insize = ::read (_fd, data + got_size, req_size - got_size);
         if (insize > 0) {
             // Normal case: some data were read
@@ -356,18 +701,189 @@ size_t ts::TSFileInput::read(TSPacket* buffer, size_t max_packets, Report& repor
         // At end of file, if the file must be repeated a finite number of times,
         // check if this was the last time. If the file must be repeated again,
         // rewind to original start offset.
-        if (_at_eof && (_repeat == 0 || ++_counter < _repeat) && !seekInternal (0, report)) {
+        if (_at_eof && (_repeat == 0 || ++_counter < _repeat) && !seekRaw(0, error_code)) {
+            seek_error = true;
             return 0; // rewind error
         }
     }
 
     if (got_error) {
-        report.log(_severity, u"error reading file %s: %s (%d)", {_filename, ErrorCodeMessage(error_code), error_code});
         return 0;
     }
 
     // Return the number of input packets.
-    const size_t count = got_size / PKT_SIZE;
+    error_code = 0;
+    return got_size / PKT_SIZE;
+}
+
+
+//----------------------------------------------------------------------------
+// Read TS packets from the memory-mapped file (READ_MMAP mode).
+//----------------------------------------------------------------------------
+
+size_t ts::TSFileInput::readMapped(const TSPacket*& packets, size_t max_packets, Report& report)
+{
+    if (_at_eof || max_packets == 0) {
+        return 0;
+    }
+
+#if !defined(TS_WINDOWS)
+    // Accessing the pages of a mapped file beyond its end raises SIGBUS. The current
+    // window never extends beyond the last known file size. Check that the file was not
+    // truncated since, before returning packets from the window.
+    if (_map_base != 0) {
+        struct stat st;
+        if (::fstat(_fd, &st) < 0) {
+            ErrorCode error_code = LastErrorCode();
+            report.log(_severity, u"cannot stat input file %s: %s", {_filename, ErrorCodeMessage(error_code)});
+            return 0;
+        }
+        if (uint64_t(st.st_size) < _file_size) {
+            report.log(_severity, u"input file %s was truncated while being read", {_filename});
+            unmapWindow();
+            _at_eof = true;
+            return 0;
+        }
+    }
+#endif
+
+    // Map a new window when there is no complete packet in the current one.
+    // If the file cannot be mapped, continue with plain reads.
+    if (_map_base == 0 || _position < _map_offset || _position + PKT_SIZE > _map_offset + _map_size) {
+        if (!mapWindow(report)) {
+            return 0;
+        }
+        if (_active_mode != READ_MMAP) {
+            return readInPlace(packets, max_packets, report);
+        }
+        // At end of file, loop back to the start offset if the file must be repeated.
+        while (_map_base == 0) {
+            if (_repeat != 0 && ++_counter >= _repeat) {
+                _at_eof = true;
+                return 0;
+            }
+            _position = _start_offset;
+            if (!mapWindow(report)) {
+                return 0;
+            }
+            if (_active_mode != READ_MMAP) {
+                return readInPlace(packets, max_packets, report);
+            }
+            if (_map_base == 0 && _file_size < _start_offset + PKT_SIZE) {
+                // Nothing to read at all in the file, do not loop forever.
+                _at_eof = true;
+                return 0;
+            }
+        }
+    }
+
+    // Return all complete packets from the current position in the window.
+    const size_t count = std::min(max_packets, size_t((_map_offset + _map_size - _position) / PKT_SIZE));
+    packets = reinterpret_cast<const TSPacket*>(_map_base + (_position - _map_offset));
+    _position += count * PKT_SIZE;
     _total_packets += count;
     return count;
 }
+
+
+//----------------------------------------------------------------------------
+// Map the file window at the current position (READ_MMAP mode).
+// At end of file, return true without mapped window.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileInput::mapWindow(Report& report)
+{
+    unmapWindow();
+
+#if !defined(TS_WINDOWS)
+
+    // Get the current file size before each mapping, the window never extends beyond it.
+    struct stat st;
+    if (::fstat(_fd, &st) < 0) {
+        ErrorCode error_code = LastErrorCode();
+        report.log(_severity, u"cannot stat input file %s: %s", {_filename, ErrorCodeMessage(error_code)});
+        return false;
+    }
+    if (uint64_t(st.st_size) < _file_size && _position < _file_size) {
+        report.log(_severity, u"input file %s was truncated while being read", {_filename});
+        _at_eof = true;
+        return false;
+    }
+    _file_size = uint64_t(st.st_size);
+    if (_position + PKT_SIZE > _file_size) {
+        return true; // end of file, no mapped window.
+    }
+
+    // Map from the page containing the current position, up to the end of file.
+    static const uint64_t page_size = uint64_t(::sysconf(_SC_PAGESIZE));
+    const uint64_t offset = _position - _position % page_size;
+    const size_t size = size_t(std::min<uint64_t>(_file_size - offset, MMAP_WINDOW_SIZE));
+    void* base = ::mmap(0, size, PROT_READ, MAP_SHARED, _fd, off_t(offset));
+    if (base == MAP_FAILED) {
+        // Some regular files cannot be mapped (special file systems for instance).
+        // Switch to plain reads from the current position.
+        ErrorCode error_code = LastErrorCode();
+        report.verbose(u"cannot map input file %s: %s, using plain reads", {_filename, ErrorCodeMessage(error_code)});
+        if (::lseek(_fd, off_t(_position), SEEK_SET) == off_t(-1)) {
+            error_code = LastErrorCode();
+            report.log(_severity, u"error seeking input file %s: %s", {_filename, ErrorCodeMessage(error_code)});
+            return false;
+        }
+        _active_mode = READ_PLAIN;
+        return true;
+    }
+
+    // Hints: the window is read once, sequentially. These are just hints, errors are ignored.
+    ::madvise(base, size, MADV_SEQUENTIAL);
+    ::madvise(base, size, MADV_WILLNEED);
+#if defined(MADV_HUGEPAGE)
+    ::madvise(base, size, MADV_HUGEPAGE);
+#endif
+
+    _map_base = reinterpret_cast<uint8_t*>(base);
+    _map_size = size;
+    _map_offset = offset;
+
+#endif
+
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Unmap the current file window, if any (READ_MMAP mode).
+//----------------------------------------------------------------------------
+
+void ts::TSFileInput::unmapWindow()
+{
+#if !defined(TS_WINDOWS)
+    if (_map_base != 0) {
+        ::munmap(_map_base, _map_size);
+    }
+#endif
+    _map_base = 0;
+    _map_size = 0;
+    _map_offset = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Start and stop the read-ahead thread (READ_AHEAD mode).
+//----------------------------------------------------------------------------
+
+void ts::TSFileInput::startReadAhead()
+{
+    if (_read_ahead == 0) {
+        _read_ahead = new ReadAhead(this);
+        _read_ahead->start();
+    }
+}
+
+void ts::TSFileInput::stopReadAhead()
+{
+    if (_read_ahead != 0) {
+        _read_ahead->stop();
+        delete _read_ahead;
+        _read_ahead = 0;
+    }
+}
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsTSPacket.h"
 #include "tsReport.h"
+#include "tsAbortInterface.h"
 
 namespace ts {
     //!
@@ -43,6 +44,30 @@ namespace ts {
     class TSDUCKDLL TSFileInput
     {
     public:
+        //!
+        //! How the content of the file is read.
+        //!
+        enum ReadMode {
+            READ_PLAIN,      //!< Plain read system calls (default).
+            READ_MMAP,       //!< Memory-mapped file, regular files only, plain read otherwise or when the file cannot be mapped.
+            READ_AHEAD,      //!< A background thread reads the file ahead of the application.
+        };
+
+        //!
+        //! Size in packets of each buffer which is read ahead in READ_AHEAD mode.
+        //!
+        static const size_t READ_AHEAD_PACKETS = 8192;
+
+        //!
+        //! Number of buffers which are read ahead in READ_AHEAD mode.
+        //!
+        static const size_t READ_AHEAD_BUFFERS = 4;
+
+        //!
+        //! Size in bytes of the file window which is memory-mapped at a time in READ_MMAP mode.
+        //!
+        static const size_t MMAP_WINDOW_SIZE = 64 * 1024 * 1024;
+
         //!
         //! Default constructor.
         //!
@@ -108,6 +133,33 @@ namespace ts {
             _severity = level;
         }
 
+        //!
+        //! Set the read mode of the file.
+        //! Must be called before open(), the mode is used by all subsequent opens.
+        //! In READ_MMAP mode, the file should not be truncated while it is read. The size
+        //! of the file is checked before each read and a truncation is reported as an error.
+        //! However, on UNIX systems, if the file is truncated after a read and before the
+        //! application accesses the returned packets, the application gets a SIGBUS signal.
+        //! In READ_AHEAD mode on a pipe, closing the file does not wait for the next input
+        //! data (UNIX systems).
+        //! @param [in] mode The read mode to use. The default is READ_PLAIN.
+        //!
+        void setReadMode(ReadMode mode)
+        {
+            _mode = mode;
+        }
+
+        //!
+        //! Get the read mode of the file.
+        //! @return The read mode which is actually used when the file is open
+        //! (READ_MMAP falls back to READ_PLAIN on pipes or when the file cannot be mapped),
+        //! the requested mode otherwise.
+        //!
+        ReadMode getReadMode() const
+        {
+            return _is_open ? _active_mode : _mode;
+        }
+
         //!
         //! Get the file name.
         //! @return The file name.
@@ -136,6 +188,20 @@ namespace ts {
         //!
         size_t read(TSPacket* buffer, size_t max_packets, Report& report);
 
+        //!
+        //! Read TS packets without copying them in a user buffer.
+        //! The packets are returned inside the memory-mapped file or the read-ahead
+        //! buffers when possible and inside an internal buffer in READ_PLAIN mode.
+        //! @param [out] packets Address of the first returned packet. The returned packets
+        //! remain valid until the next call to read(), readInPlace(), seek() or close().
+        //! @param [in] max_packets Maximum number of packets to return. Fewer packets
+        //! may be returned, even before the end of file.
+        //! @param [in,out] report Where to report errors.
+        //! @return The actual number of returned packets. Returning zero means
+        //! error or end of file repetition.
+        //!
+        size_t readInPlace(const TSPacket*& packets, size_t max_packets, Report& report);
+
         //!
         //! Rewind the file.
         //! The file must have been opened in rewindable mode.
@@ -180,11 +246,24 @@ namespace ts {
         int      _severity;      //!< Severity level for error reporting
         bool     _at_eof;        //!< End of file has been reached
         bool     _rewindable;    //!< Opened in rewindable mode
+        bool     _regular;       //!< The file is a regular file
+        ReadMode _mode;          //!< Requested read mode
+        ReadMode _active_mode;   //!< Read mode of the open file
 #if defined(TS_WINDOWS)
         ::HANDLE _handle;        //!< File handle
 #else
         int      _fd;            //!< File descriptor
 #endif
+        uint64_t _position;      //!< Current byte offset in file (READ_MMAP)
+        uint64_t _file_size;     //!< Last known file size (READ_MMAP)
+        uint64_t _map_offset;    //!< Byte offset in file of mapped window (READ_MMAP)
+        uint8_t* _map_base;      //!< Address of mapped window, null if none (READ_MMAP)
+        size_t   _map_size;      //!< Size in bytes of mapped window (READ_MMAP)
+        TSPacketVector _buffer;  //!< Internal buffer for readInPlace() (READ_PLAIN)
+
+        // Background read-ahead thread (READ_AHEAD), defined in implementation.
+        class ReadAhead;
+        ReadAhead* _read_ahead;
 
         // Inaccessible operations
         TSFileInput(const TSFileInput&) = delete;
@@ -193,5 +272,12 @@ namespace ts {
         // Internal methods
         bool openInternal(Report& report);
         bool seekInternal(uint64_t, Report& report);
+        bool seekRaw(uint64_t, ErrorCode&);
+        size_t readRaw(TSPacket* buffer, size_t max_packets, ErrorCode& error_code, bool& seek_error, const AbortInterface* abort = 0);
+        size_t readMapped(const TSPacket*& packets, size_t max_packets, Report& report);
+        bool mapWindow(Report& report);
+        void unmapWindow();
+        void startReadAhead();
+        void stopReadAhead();
     };
 }
@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Command line arguments to read a TS file in commands.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileInputArgs.h"
+TSDUCK_SOURCE;
+
+// Number of packets which are read and processed at a time.
+#define READ_PACKETS 1024
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::TSFileInputArgs::TSFileInputArgs() :
+    read_mode(TSFileInput::READ_PLAIN)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Add help about command line options in an Args
+//----------------------------------------------------------------------------
+
+void ts::TSFileInputArgs::addHelp(Args& args) const
+{
+    const UString help =
+        u"\n"
+        u"Input file options:\n"
+        u"\n"
+        u"  --mmap\n"
+        u"      Map the input file in memory instead of reading it with system calls.\n"
+        u"      This option is ignored if the input file is not a regular file. The\n"
+        u"      file should not be truncated while it is read.\n"
+        u"\n"
+        u"  --read-ahead\n"
+        u"      Read the input file in a background thread, ahead of the processing.\n"
+        u"      Useful when the input file is on a slow device.\n";
+
+    args.setHelp(args.getHelp() + help);
+}
+
+
+//----------------------------------------------------------------------------
+// Define command line options in an Args.
+//----------------------------------------------------------------------------
+
+void ts::TSFileInputArgs::defineOptions(Args& args) const
+{
+    args.option(u"mmap",       0);
+    args.option(u"read-ahead", 0);
+}
+
+
+//----------------------------------------------------------------------------
+// Load arguments from command line.
+// Args error indicator is set in case of incorrect arguments
+//----------------------------------------------------------------------------
+
+void ts::TSFileInputArgs::load(Args& args)
+{
+    if (args.present(u"mmap") && args.present(u"read-ahead")) {
+        args.error(u"--mmap and --read-ahead are mutually exclusive");
+    }
+    read_mode = args.present(u"mmap") ? TSFileInput::READ_MMAP : (args.present(u"read-ahead") ? TSFileInput::READ_AHEAD : TSFileInput::READ_PLAIN);
+}
+
+
+//----------------------------------------------------------------------------
+// Read all packets of a file and pass them to a handler.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileInputArgs::readPackets(const UString& filename, TSPacketHandlerInterface& handler, Report& report) const
+{
+    TSFileInput file;
+    file.setReadMode(read_mode);
+    if (!file.open(filename, 1, 0, report)) {
+        return false;
+    }
+
+    // Read packets by blocks, without copy.
+    const TSPacket* pkt = 0;
+    size_t count = 0;
+    bool more = true;
+    while (more && (count = file.readInPlace(pkt, READ_PACKETS, report)) > 0) {
+        for (size_t i = 0; more && i < count; ++i) {
+            if (!pkt[i].hasValidSync()) {
+                report.error(u"synchronization lost after %'d packets, got 0x%X instead of 0x%X at start of TS packet", {file.getPacketCount() - count + i, pkt[i].b[0], SYNC_BYTE});
+                more = false;
+            }
+            else {
+                more = handler.handleTSPacket(pkt[i]);
+            }
+        }
+    }
+
+    file.close(report);
+    return true;
+}
@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Command line arguments to read a TS file in commands.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsArgs.h"
+#include "tsTSFileInput.h"
+#include "tsTSPacketHandlerInterface.h"
+
+namespace ts {
+    //!
+    //! Command line arguments to read a TS file in commands.
+    //!
+    //! The options --mmap and --read-ahead select the read mode of the file.
+    //! All packets are then read by blocks, without copy, and passed to a handler.
+    //!
+    class TSDUCKDLL TSFileInputArgs
+    {
+    public:
+        //!
+        //! Constructor.
+        //!
+        TSFileInputArgs();
+
+        //!
+        //! Virtual destructor.
+        //!
+        virtual ~TSFileInputArgs() {}
+
+        // Public fields, by options.
+        TSFileInput::ReadMode read_mode;  //!< How to read the input file.
+
+        //!
+        //! Define command line options in an Args.
+        //! @param [in,out] args Command line arguments to update.
+        //!
+        virtual void defineOptions(Args& args) const;
+
+        //!
+        //! Add help about command line options in an Args.
+        //! @param [in,out] args Command line arguments to update.
+        //!
+        virtual void addHelp(Args& args) const;
+
+        //!
+        //! Load arguments from command line.
+        //! Args error indicator is set in case of incorrect arguments.
+        //! @param [in,out] args Command line arguments.
+        //!
+        virtual void load(Args& args);
+
+        //!
+        //! Read all packets of a file and pass them to a handler.
+        //! Reading stops at end of file, on read error, on loss of synchronization
+        //! (reported as an error) or when the handler returns false.
+        //! @param [in] filename File name. If empty, use standard input.
+        //! @param [in,out] handler The object to invoke for each packet.
+        //! @param [in,out] report Where to report errors.
+        //! @return False if the file cannot be opened, true otherwise.
+        //!
+        bool readPackets(const UString& filename, TSPacketHandlerInterface& handler, Report& report) const;
+    };
+}
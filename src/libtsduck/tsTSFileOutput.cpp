@@ -34,8 +34,190 @@
 #include "tsTSFileOutput.h"
 #include "tsNullReport.h"
 #include "tsSysUtils.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
 TSDUCK_SOURCE;
 
+const size_t ts::TSFileOutput::ASYNC_BUFFER_PACKETS;
+const size_t ts::TSFileOutput::DEFAULT_ASYNC_BUFFERS;
+
+// Alignment of buffers, file offsets and sizes in direct I/O.
+#define DIRECT_IO_ALIGN 4096
+
+
+//----------------------------------------------------------------------------
+// Background writer thread (asynchronous mode).
+// A ring of buffers is filled by the application and written by the thread.
+//----------------------------------------------------------------------------
+
+class ts::TSFileOutput::AsyncWriter: public Thread
+{
+public:
+    // Constructor and destructor.
+    AsyncWriter(TSFileOutput* output, size_t buffer_count, Report& report);
+    virtual ~AsyncWriter() override;
+
+    // Copy packets in buffers, wait for free buffers if necessary.
+    // Return false if a previous write failed, with error_code set.
+    bool write(const TSPacket* packets, size_t count, ErrorCode& error_code);
+
+    // Write all buffered packets, terminate the thread and wait for its termination.
+    // Return false if a write failed, with error_code set.
+    bool flushAndStop(ErrorCode& error_code);
+
+private:
+    TSFileOutput*        _output;
+    Report&              _report;      // Where to report messages from the thread.
+    const size_t         _count;       // Number of buffers.
+    std::vector<uint8_t> _memory;      // Memory of all buffers, plus alignment margin.
+    TSPacket*            _base;        // Address of first buffer, aligned for direct I/O.
+    std::vector<size_t>  _sizes;       // Number of packets in each buffer.
+    Mutex                _mutex;
+    Condition            _not_empty;   // Signaled when a buffer is filled or on stop.
+    Condition            _not_full;    // Signaled when a buffer is written or on error.
+    size_t               _first;       // Index of first filled buffer, written by the thread.
+    size_t               _filled;      // Number of filled buffers, not including the current one.
+    bool                 _terminate;   // Request to terminate the thread after writing filled buffers.
+    bool                 _failed;      // A write error occured.
+    ErrorCode            _error_code;  // Error from the thread.
+
+    // Address of a buffer.
+    TSPacket* buffer(size_t index) {return _base + index * ASYNC_BUFFER_PACKETS;}
+
+    // Thread main code.
+    virtual void main() override;
+
+    // Inaccessible operations
+    AsyncWriter() = delete;
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+};
+
+ts::TSFileOutput::AsyncWriter::AsyncWriter(TSFileOutput* output, size_t buffer_count, Report& report) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetHighPriority())),
+    _output(output),
+    _report(report),
+    _count(std::max<size_t>(buffer_count, 2)),
+    _memory(_count * ASYNC_BUFFER_PACKETS * PKT_SIZE + DIRECT_IO_ALIGN),
+    _base(0),
+    _sizes(_count, 0),
+    _mutex(),
+    _not_empty(),
+    _not_full(),
+    _first(0),
+    _filled(0),
+    _terminate(false),
+    _failed(false),
+    _error_code(SYS_SUCCESS)
+{
+    const size_t misalign = size_t(reinterpret_cast<uintptr_t>(&_memory[0]) % DIRECT_IO_ALIGN);
+    _base = reinterpret_cast<TSPacket*>(&_memory[misalign == 0 ? 0 : DIRECT_IO_ALIGN - misalign]);
+}
+
+ts::TSFileOutput::AsyncWriter::~AsyncWriter()
+{
+    ErrorCode error_code = SYS_SUCCESS;
+    flushAndStop(error_code);
+}
+
+bool ts::TSFileOutput::AsyncWriter::write(const TSPacket* packets, size_t count, ErrorCode& error_code)
+{
+    while (count > 0) {
+        // The current buffer is the one after all filled buffers. It is never
+        // accessed by the thread. Wait until it is not the first filled one.
+        size_t index = 0;
+        {
+            GuardCondition lock(_mutex, _not_full);
+            while (_filled >= _count - 1 && !_failed) {
+                lock.waitCondition();
+            }
+            if (_failed) {
+                break;
+            }
+            index = (_first + _filled) % _count;
+        }
+
+        // Copy as many packets as possible in current buffer, without holding the mutex.
+        const size_t size = std::min(count, ASYNC_BUFFER_PACKETS - _sizes[index]);
+        ::memcpy(buffer(index) + _sizes[index], packets, size * PKT_SIZE);
+        _sizes[index] += size;
+        packets += size;
+        count -= size;
+
+        // Pass the buffer to the thread when full.
+        if (_sizes[index] >= ASYNC_BUFFER_PACKETS) {
+            GuardCondition lock(_mutex, _not_empty);
+            _filled++;
+            lock.signal();
+        }
+    }
+
+    Guard lock(_mutex);
+    error_code = _error_code;
+    return !_failed;
+}
+
+bool ts::TSFileOutput::AsyncWriter::flushAndStop(ErrorCode& error_code)
+{
+    {
+        GuardCondition lock(_mutex, _not_empty);
+        if (!_terminate) {
+            // Pass the current partial buffer to the thread.
+            const size_t index = (_first + _filled) % _count;
+            if (_sizes[index] > 0) {
+                _filled++;
+            }
+            _terminate = true;
+            lock.signal();
+        }
+    }
+    waitForTermination();
+    error_code = _error_code;
+    return !_failed;
+}
+
+void ts::TSFileOutput::AsyncWriter::main()
+{
+    for (;;) {
+        size_t index = 0;
+        size_t size = 0;
+
+        // Wait for a filled buffer.
+        {
+            GuardCondition lock(_mutex, _not_empty);
+            while (_filled == 0 && !_terminate) {
+                lock.waitCondition();
+            }
+            if (_filled == 0) {
+                break; // terminated, all buffers written
+            }
+            index = _first;
+            size = _sizes[index];
+        }
+
+        // Write the buffer without holding the mutex.
+        ErrorCode error_code = SYS_SUCCESS;
+        const bool success = _output->writeRaw(buffer(index), size * PKT_SIZE, error_code, _report);
+
+        // Release the buffer.
+        GuardCondition lock(_mutex, _not_full);
+        _sizes[index] = 0;
+        _first = (_first + 1) % _count;
+        _filled--;
+        if (!success) {
+            _failed = true;
+            _error_code = error_code;
+        }
+        lock.signal();
+        if (_failed) {
+            break;
+        }
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -46,11 +228,20 @@ ts::TSFileOutput::TSFileOutput() :
     _is_open(false),
     _severity(Severity::Error),
     _total_packets(0),
+    _async_buffers(0),
+    _direct_io(false),
+    _prealloc_size(0),
+    _sync_interval(0),
 #if defined(TS_WINDOWS)
-    _handle(INVALID_HANDLE_VALUE)
+    _handle(INVALID_HANDLE_VALUE),
 #else
-    _fd(-1)
+    _fd(-1),
 #endif
+    _direct_active(false),
+    _write_offset(0),
+    _prealloc_end(0),
+    _next_sync(),
+    _writer(0)
 {
 }
 
@@ -117,21 +308,47 @@ bool ts::TSFileOutput::open(const UString& filename, bool append, bool keep, Rep
         flags |= O_TRUNC;
     }
 
+    _direct_active = false;
     if (_filename.empty()) {
         _fd = STDOUT_FILENO;
     }
     else {
-        _fd = ::open(_filename.toUTF8().c_str(), flags, mode);
+#if defined(TS_LINUX)
+        if (_direct_io) {
+            _fd = ::open(_filename.toUTF8().c_str(), flags | O_DIRECT, mode);
+            _direct_active = _fd >= 0;
+            if (_fd < 0 && LastErrorCode() == EINVAL) {
+                report.verbose(u"direct I/O not supported on %s, using system cache", {_filename});
+            }
+        }
+#endif
+        if (!_direct_active) {
+            _fd = ::open(_filename.toUTF8().c_str(), flags, mode);
+        }
         got_error = _fd < 0;
         error_code = LastErrorCode();
         report.debug(u"creating file %s, fd=%d, error_code=%d", {filename, _fd, error_code});
     }
 
+    // Get initial write offset for preallocation. Fails on pipes, no preallocation then.
+    if (!got_error) {
+        const off_t offset = ::lseek(_fd, 0, append ? SEEK_END : SEEK_CUR);
+        _write_offset = offset == off_t(-1) ? 0 : uint64_t(offset);
+        _prealloc_end = offset == off_t(-1) ? 0 : _write_offset;
+    }
+
 #endif
 
     if (got_error) {
         report.log(_severity, u"cannot create output file %s: %s", {_filename, ErrorCodeMessage(error_code)});
     }
+    else {
+        _next_sync = Time::CurrentUTC() + _sync_interval;
+        if (_async_buffers > 0 || _direct_io) {
+            _writer = new AsyncWriter(this, _async_buffers > 0 ? _async_buffers : DEFAULT_ASYNC_BUFFERS, report);
+            _writer->start();
+        }
+    }
 
     _total_packets = 0;
     return _is_open = !got_error;
@@ -149,6 +366,27 @@ bool ts::TSFileOutput::close(Report& report)
         return false;
     }
 
+    // Write all pending data in asynchronous mode.
+    bool success = true;
+    if (_writer != 0) {
+        ErrorCode error_code = SYS_SUCCESS;
+        success = _writer->flushAndStop(error_code);
+        if (!success && error_code != SYS_SUCCESS) {
+            report.log(_severity, u"error writing output file %s: %s (%d)", {_filename, ErrorCodeMessage(error_code), error_code});
+        }
+        delete _writer;
+        _writer = 0;
+    }
+
+#if defined(TS_LINUX)
+    // Release preallocated space beyond the end of file.
+    // Truncating a file at its current size frees the blocks after the end.
+    struct stat st;
+    if (_prealloc_end > _write_offset && ::fstat(_fd, &st) == 0 && ::ftruncate(_fd, st.st_size) < 0) {
+        report.warning(u"cannot release preallocated space in %s: %s", {_filename, ErrorCodeMessage(LastErrorCode())});
+    }
+#endif
+
     if (!_filename.empty()) {
 #if defined (TS_WINDOWS)
         ::CloseHandle(_handle);
@@ -158,7 +396,7 @@ bool ts::TSFileOutput::close(Report& report)
     }
 
     _is_open = false;
-    return true;
+    return success;
 }
 
 
@@ -185,18 +423,60 @@ bool ts::TSFileOutput::write(const TSPacket* buffer, size_t packet_count, Report
         return false;
     }
 
+    ErrorCode error_code = SYS_SUCCESS;
+    bool success = false;
+
+    if (_writer != 0) {
+        // Asynchronous mode, copy in buffers, written later.
+        success = _writer->write(buffer, packet_count, error_code);
+        if (success) {
+            _total_packets += packet_count;
+        }
+    }
+    else {
+        // Synchronous mode, direct write.
+        const uint64_t start = _write_offset;
+        success = writeRaw(buffer, packet_count * PKT_SIZE, error_code, report);
+        _total_packets += (_write_offset - start) / PKT_SIZE;
+    }
+
+    if (!success && error_code != SYS_SUCCESS) {
+        report.log(_severity, u"error writing output file %s: %s (%d)", {_filename, ErrorCodeMessage(error_code), error_code});
+    }
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Stop using direct I/O on the file.
+//----------------------------------------------------------------------------
+
+#if defined(TS_LINUX)
+void ts::TSFileOutput::disableDirectIO()
+{
+    ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) & ~O_DIRECT);
+    _direct_active = false;
+}
+#endif
+
+
+//----------------------------------------------------------------------------
+// Write data to the file, with preallocation and periodic synchronization.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutput::writeRaw(const void* data_buffer, size_t size, ErrorCode& error_code, Report& report)
+{
     // Loop on write until everything is gone
 
     bool got_error = false;
-    ErrorCode error_code = SYS_SUCCESS;
-    const char* const data_buffer = reinterpret_cast <const char*> (buffer);
-    const char* data = data_buffer;
+    error_code = SYS_SUCCESS;
+    const char* data = reinterpret_cast <const char*> (data_buffer);
 
 #if defined (TS_WINDOWS)
 
     // Windows implementation
 
-    ::DWORD remain = ::DWORD (packet_count) * PKT_SIZE;
+    ::DWORD remain = ::DWORD (size);
     ::DWORD outsize;
 
     while (remain > 0 && !got_error) {
@@ -204,7 +484,7 @@ bool ts::TSFileOutput::write(const TSPacket* buffer, size_t packet_count, Report
             // Normal case, some data were written
             outsize = std::min (outsize, remain);
             data += outsize;
-            remain -= std::max (remain, outsize);
+            remain -= outsize;
         }
         else if ((error_code = LastErrorCode()) == ERROR_BROKEN_PIPE || error_code == ERROR_NO_DATA) {
             // Broken pipe: error state but don't report error.
@@ -224,17 +504,60 @@ bool ts::TSFileOutput::write(const TSPacket* buffer, size_t packet_count, Report
 
     // UNIX implementation
 
-    size_t remain = packet_count * PKT_SIZE;
+#if defined(TS_LINUX)
+    // Reserve disk space ahead of written data. Errors are ignored, this is just an optimization.
+    if (_prealloc_size > 0 && _prealloc_end > 0 && _write_offset + size > _prealloc_end) {
+        const uint64_t end = _write_offset + size + _prealloc_size;
+        if (::fallocate(_fd, FALLOC_FL_KEEP_SIZE, off_t(_prealloc_end), off_t(end - _prealloc_end)) == 0) {
+            _prealloc_end = end;
+        }
+        else {
+            report.debug(u"preallocation error on %s: %s", {_filename, ErrorCodeMessage(LastErrorCode())});
+            _prealloc_size = 0;
+        }
+    }
+
+    // Direct I/O is possible only with aligned file offsets and sizes. The aligned part
+    // of the data is written with direct I/O, the rest through the system cache. Typically,
+    // only the last partial buffer before closing is written through the cache.
+    size_t direct_size = 0;
+    if (_direct_active) {
+        if (_write_offset % DIRECT_IO_ALIGN != 0) {
+            report.verbose(u"unaligned offset %'d in %s, direct I/O disabled, using system cache", {_write_offset, _filename});
+            disableDirectIO();
+        }
+        else {
+            direct_size = size - size % DIRECT_IO_ALIGN;
+        }
+    }
+#endif
+
+    size_t remain = size;
     ssize_t outsize;
 
     while (remain > 0 && !got_error) {
-        outsize = ::write (_fd, data, remain);
+#if defined(TS_LINUX)
+        if (_direct_active && size - remain >= direct_size) {
+            report.debug(u"writing last %'d bytes of %s through system cache", {remain, _filename});
+            disableDirectIO();
+        }
+        outsize = ::write(_fd, data, _direct_active ? direct_size - (size - remain) : remain);
+#else
+        outsize = ::write(_fd, data, remain);
+#endif
         if (outsize > 0) {
             // Normal case, some data were written
             assert (size_t (outsize) <= remain);
             data += outsize;
-            remain -= std::max (remain, size_t (outsize));
+            remain -= size_t (outsize);
+        }
+#if defined(TS_LINUX)
+        else if (_direct_active && LastErrorCode() == EINVAL) {
+            // Direct I/O refused on this file, continue through the system cache.
+            report.verbose(u"direct I/O refused on %s, using system cache", {_filename});
+            disableDirectIO();
         }
+#endif
         else if ((error_code = LastErrorCode()) != EINTR) {
             // Actual error (not an interrupt)
             report.debug(u"write error on %s, fd=%d, error_code=%d", {_filename, _fd, error_code});
@@ -248,10 +571,32 @@ bool ts::TSFileOutput::write(const TSPacket* buffer, size_t packet_count, Report
 
 #endif
 
-    if (got_error && error_code != SYS_SUCCESS) {
-        report.log(_severity, u"error writing output file %s: %s (%d)", {_filename, ErrorCodeMessage(error_code), error_code});
+    _write_offset += size - remain;
+
+    // Periodic synchronization of data on disk.
+    if (!got_error && _sync_interval > 0) {
+        const Time now(Time::CurrentUTC());
+        if (now >= _next_sync) {
+            syncData();
+            _next_sync = now + _sync_interval;
+        }
     }
 
-    _total_packets += (data - data_buffer) / PKT_SIZE;
     return !got_error;
 }
+
+
+//----------------------------------------------------------------------------
+// Synchronize the file data on disk.
+//----------------------------------------------------------------------------
+
+void ts::TSFileOutput::syncData()
+{
+#if defined(TS_WINDOWS)
+    ::FlushFileBuffers(_handle);
+#elif defined(TS_LINUX)
+    ::fdatasync(_fd);
+#else
+    ::fsync(_fd);
+#endif
+}
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsTSPacket.h"
 #include "tsReport.h"
+#include "tsTime.h"
 
 namespace ts {
     //!
@@ -43,6 +44,17 @@ namespace ts {
     class TSDUCKDLL TSFileOutput
     {
     public:
+        //!
+        //! Size in packets of each buffer in asynchronous mode.
+        //! This is a multiple of 4096 bytes, as required for direct I/O.
+        //!
+        static const size_t ASYNC_BUFFER_PACKETS = 4 * 1024;
+
+        //!
+        //! Default number of buffers in asynchronous mode.
+        //!
+        static const size_t DEFAULT_ASYNC_BUFFERS = 16;
+
         //!
         //! Default constructor.
         //!
@@ -58,7 +70,9 @@ namespace ts {
         //! @param [in] filename File name. If empty, use standard output.
         //! @param [in] append Append packets to an existing file.
         //! @param [in] keep Keep previous file with same name. Fail if it already exists.
-        //! @param [in,out] report Where to report errors.
+        //! @param [in,out] report Where to report errors. In asynchronous mode, the messages
+        //! from the background thread are also reported there, the report must remain
+        //! valid until close().
         //! @return True on success, false on error.
         //!
         virtual bool open(const UString& filename, bool append, bool keep, Report& report);
@@ -79,6 +93,94 @@ namespace ts {
         //!
         bool write(const TSPacket* buffer, size_t packet_count, Report& report);
 
+        //!
+        //! Set the asynchronous mode.
+        //! In asynchronous mode, write() copies the packets in internal buffers which are
+        //! written to the file by a background thread. A slow disk does not block the
+        //! application, as long as free buffers remain. Must be called before open().
+        //! @param [in] buffer_count Number of buffers of ASYNC_BUFFER_PACKETS packets.
+        //! Zero means synchronous mode (the default).
+        //!
+        void setAsynchronous(size_t buffer_count)
+        {
+            _async_buffers = buffer_count;
+        }
+
+        //!
+        //! Get the number of buffers in asynchronous mode.
+        //! @return The number of buffers in asynchronous mode, zero in synchronous mode.
+        //!
+        size_t getAsynchronous() const
+        {
+            return _async_buffers;
+        }
+
+        //!
+        //! Set the direct I/O mode, bypassing the system cache (O_DIRECT, Linux only).
+        //! Direct I/O implies the asynchronous mode (with DEFAULT_ASYNC_BUFFERS buffers
+        //! if not specified) since it needs aligned buffers. When direct I/O is not
+        //! supported by the file system or when the file offset is not aligned (append
+        //! mode), the file is written through the cache and a verbose message is reported.
+        //! The last partial buffer before close() is always written through the cache.
+        //! Must be called before open().
+        //! @param [in] on True to use direct I/O.
+        //!
+        void setDirectIO(bool on)
+        {
+            _direct_io = on;
+        }
+
+        //!
+        //! Check if direct I/O is requested.
+        //! @return True if direct I/O is requested.
+        //!
+        bool getDirectIO() const
+        {
+            return _direct_io;
+        }
+
+        //!
+        //! Set the preallocation size (Linux only).
+        //! Disk space is reserved by chunks of this size ahead of the written data,
+        //! reducing fragmentation and file system metadata updates. The apparent size
+        //! of the file is not modified. Must be called before open().
+        //! @param [in] size Preallocation chunk size in bytes. Zero means no preallocation (the default).
+        //!
+        void setPreallocation(uint64_t size)
+        {
+            _prealloc_size = size;
+        }
+
+        //!
+        //! Get the preallocation size.
+        //! @return The preallocation chunk size in bytes, zero if no preallocation.
+        //!
+        uint64_t getPreallocation() const
+        {
+            return _prealloc_size;
+        }
+
+        //!
+        //! Set the interval of periodic data synchronization on disk.
+        //! Limits the amount of dirty data in the system cache, avoiding long flushes.
+        //! Must be called before open().
+        //! @param [in] interval Interval in milliseconds between two synchronizations.
+        //! Zero means no periodic synchronization (the default).
+        //!
+        void setSyncInterval(MilliSecond interval)
+        {
+            _sync_interval = interval;
+        }
+
+        //!
+        //! Get the interval of periodic data synchronization on disk.
+        //! @return The interval in milliseconds, zero if no periodic synchronization.
+        //!
+        MilliSecond getSyncInterval() const
+        {
+            return _sync_interval;
+        }
+
         //!
         //! Check if the file is open.
         //! @return True if the file is open.
@@ -126,13 +228,36 @@ namespace ts {
         bool          _is_open;       // Check if file is actually open
         int           _severity;      // Severity level for error reporting
         PacketCounter _total_packets; // Total written packets
+        size_t        _async_buffers; // Number of buffers in asynchronous mode, zero if synchronous
+        bool          _direct_io;     // Use direct I/O
+        uint64_t      _prealloc_size; // Preallocation chunk size
+        MilliSecond   _sync_interval; // Interval between data synchronizations
 #if defined(TS_WINDOWS)
         ::HANDLE      _handle;        // File handle
 #else
         int           _fd;            // File descriptor
 #endif
+        bool          _direct_active; // Direct I/O is currently used on the file
+        uint64_t      _write_offset;  // Current write offset in file
+        uint64_t      _prealloc_end;  // End of preallocated area in file, zero if none
+        Time          _next_sync;     // Next time to synchronize data on disk
+
+        // Background writer thread (asynchronous mode), defined in implementation.
+        class AsyncWriter;
+        AsyncWriter* _writer;
+
         // Inaccessible operations
         TSFileOutput(const TSFileOutput&) = delete;
         TSFileOutput& operator=(const TSFileOutput&) = delete;
+
+        // Write data to the file, with preallocation and periodic synchronization.
+        // Return false on error. On broken pipe, return false with error_code set to SYS_SUCCESS.
+        bool writeRaw(const void* data, size_t size, ErrorCode& error_code, Report& report);
+
+        // Synchronize the file data on disk.
+        void syncData();
+
+        // Stop using direct I/O on the file, write through the system cache (Linux only).
+        void disableDirectIO();
     };
 }
@@ -0,0 +1,431 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "tsTSFileOutputSegmented.h"
+#include "tsBinaryTable.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+const ts::UChar* const ts::TSFileOutputSegmented::PART_SUFFIX = u".part";
+
+// PCR values wrap up at this value.
+#define PCR_WRAP (PTS_DTS_SCALE * SYSTEM_CLOCK_SUBFACTOR)
+
+// When no split point is found, force a split when the segment exceeds its maximum by this factor.
+#define FORCE_SPLIT_FACTOR 2
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::TSFileOutputSegmented::TSFileOutputSegmented() :
+    _template(),
+    _max_size(0),
+    _max_duration(0),
+    _use_pcr(false),
+    _split(SPLIT_ANYWHERE),
+    _max_files(0),
+    _filename(),
+    _is_open(false),
+    _report(0),
+    _total_packets(0),
+    _segment_index(0),
+    _current(),
+    _open_index(0),
+    _segment_size(0),
+    _segment_start(),
+    _pcr_pid(PID_NULL),
+    _segment_pcr(0),
+    _segment_pcr_ok(false),
+    _split_pending(false),
+    _split_forced(false),
+    _demux(this),
+    _video_pid(PID_NULL),
+    _video_service(0),
+    _queue(),
+    _ready(),
+    _closer(0),
+    _closer_failed(false)
+{
+}
+
+ts::TSFileOutputSegmented::~TSFileOutputSegmented()
+{
+    if (_is_open) {
+        close(NULLREP);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build the name of a segment file.
+//----------------------------------------------------------------------------
+
+ts::UString ts::TSFileOutputSegmented::SegmentName(const UString& filename, size_t index)
+{
+    const UString ext(PathSuffix(filename));
+    return PathPrefix(filename) + UString::Format(u"-%06d", {index}) + ext;
+}
+
+
+//----------------------------------------------------------------------------
+// Open the first segment file.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputSegmented::open(const UString& filename, Report& report)
+{
+    if (_is_open) {
+        report.log(_template.getErrorSeverityLevel(), u"already open");
+        return false;
+    }
+    if (filename.empty()) {
+        report.log(_template.getErrorSeverityLevel(), u"segmented output requires a file name");
+        return false;
+    }
+
+    _filename = filename;
+    _report = &report;
+    _total_packets = 0;
+    _segment_index = 0;
+    _open_index = 0;
+    _pcr_pid = PID_NULL;
+    _video_pid = PID_NULL;
+    _closer_failed = false;
+    _current.clear();
+
+    // With SPLIT_AT_KEYFRAME, the video PID is found in the PMT's.
+    _demux.reset();
+    _demux.setPIDFilter(NoPID);
+    _demux.addPID(PID_PAT);
+
+    // Start the closing thread, which pre-opens the segments, then get the first segment.
+    _closer = new Closer(this);
+    _closer->start();
+    _is_open = true;
+
+    if (!nextSegment(false, report)) {
+        close(NULLREP);
+        return false;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the current segment and wait for all segments to be completed.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputSegmented::close(Report& report)
+{
+    if (!_is_open) {
+        report.log(_template.getErrorSeverityLevel(), u"not open");
+        return false;
+    }
+
+    // Pass the last segment to the closing thread and wait for its termination.
+    nextSegment(true, report);
+    delete _closer;
+    _closer = 0;
+
+    _is_open = false;
+    _report = 0;
+    return !_closer_failed;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the current segment (asynchronously) and switch to the next one (if not last).
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputSegmented::nextSegment(bool last, Report& report)
+{
+    // Pass the current segment to the closing thread.
+    // After the last segment, the thread terminates.
+    if (!_current.isNull()) {
+        _current->last = last;
+        _queue.forceEnqueue(_current);
+        _current.clear();
+    }
+    else if (last) {
+        _queue.forceEnqueue(SegmentPtr());
+    }
+    if (last) {
+        return true;
+    }
+
+    // Get the next segment, opened in advance by the closing thread.
+    // A null pointer means that the closing thread failed to open it (error already reported).
+    if (!_ready.dequeue(_current) || _current.isNull()) {
+        _current.clear();
+        return false;
+    }
+
+    _segment_index++;
+    report.debug(u"starting segment %s", {_current->name});
+    _segment_size = 0;
+    _segment_start = Time::CurrentUTC();
+    _segment_pcr_ok = false;
+    _split_pending = false;
+    _split_forced = false;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Open a new segment file, in the closing thread.
+//----------------------------------------------------------------------------
+
+ts::TSFileOutputSegmented::SegmentPtr ts::TSFileOutputSegmented::openSegment(Report& report)
+{
+    // Open the segment with the options of the template.
+    SegmentPtr seg(new Segment);
+    seg->name = SegmentName(_filename, _open_index++);
+    TSFileOutput& file(seg->file);
+    file.setErrorSeverityLevel(_template.getErrorSeverityLevel());
+    file.setAsynchronous(_template.getAsynchronous());
+    file.setDirectIO(_template.getDirectIO());
+    file.setPreallocation(_template.getPreallocation());
+    file.setSyncInterval(_template.getSyncInterval());
+    if (!file.open(seg->name + PART_SUFFIX, false, false, report)) {
+        seg.clear();
+    }
+    return seg;
+}
+
+
+//----------------------------------------------------------------------------
+// Invoked by the demux when a complete table is available.
+//----------------------------------------------------------------------------
+
+void ts::TSFileOutputSegmented::handleTable(SectionDemux& demux, const BinaryTable& table)
+{
+    switch (table.tableId()) {
+
+        case TID_PAT: {
+            const PAT pat(table);
+            if (pat.isValid()) {
+                for (PAT::ServiceMap::const_iterator it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
+                    demux.addPID(it->second);
+                }
+            }
+            break;
+        }
+
+        case TID_PMT: {
+            // The first video PID of the first service with video is used.
+            // Keep it until the PMT of the same service no longer contains video.
+            const PMT pmt(table);
+            if (pmt.isValid() && (_video_pid == PID_NULL || pmt.service_id == _video_service)) {
+                PID pid = PID_NULL;
+                for (PMT::StreamMap::const_iterator it = pmt.streams.begin(); pid == PID_NULL && it != pmt.streams.end(); ++it) {
+                    if (it->second.isVideo()) {
+                        pid = it->first;
+                    }
+                }
+                if (pid != _video_pid && _report != 0) {
+                    _report->debug(u"segments split on keyframes of PID 0x%X (%d), service 0x%X (%d)", {pid, pid, pmt.service_id, pmt.service_id});
+                }
+                _video_pid = pid;
+                _video_service = pmt.service_id;
+            }
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a split can occur before a packet.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputSegmented::isSplitPoint(const TSPacket& pkt) const
+{
+    switch (_split) {
+        case SPLIT_AT_PAT:
+            return pkt.getPID() == PID_PAT && pkt.getPUSI();
+        case SPLIT_AT_KEYFRAME:
+            return pkt.getPID() == _video_pid && pkt.getPUSI() && pkt.getRandomAccessIndicator();
+        case SPLIT_ANYWHERE:
+        default:
+            return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Write TS packets, starting new segments when necessary.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileOutputSegmented::write(const TSPacket* buffer, size_t packet_count, Report& report)
+{
+    if (!_is_open || _current.isNull()) {
+        report.log(_template.getErrorSeverityLevel(), u"not open");
+        return false;
+    }
+
+    // With the system clock, the duration is checked once per call.
+    if (_max_duration > 0 && !_use_pcr) {
+        const MilliSecond duration = Time::CurrentUTC() - _segment_start;
+        _split_pending = _split_pending || duration >= _max_duration;
+        _split_forced = _split_forced || duration >= FORCE_SPLIT_FACTOR * _max_duration;
+    }
+
+    // Write packets by contiguous blocks, split between blocks.
+    size_t start = 0;
+    for (size_t i = 0; i < packet_count; ++i) {
+        const TSPacket& pkt(buffer[i]);
+        const uint64_t size = _segment_size + (i - start) * PKT_SIZE;
+
+        // Collect the PAT and PMT's to find the video PID.
+        if (_split == SPLIT_AT_KEYFRAME) {
+            _demux.feedPacket(pkt);
+        }
+
+        // Split before this packet, when requested and possible, never in an empty segment.
+        // When no split point is found for too long, split anywhere.
+        if (_max_size > 0 && size + PKT_SIZE > _max_size) {
+            _split_pending = true;
+            _split_forced = _split_forced || size + PKT_SIZE > FORCE_SPLIT_FACTOR * _max_size;
+        }
+        if (_split_pending && size > 0 && (_split_forced || isSplitPoint(pkt))) {
+            if (!_current->file.write(buffer + start, i - start, report)) {
+                return false;
+            }
+            if (_split_forced && _split != SPLIT_ANYWHERE) {
+                report.debug(u"no split point found in segment %s, splitting anyway", {_current->name});
+            }
+            _total_packets += i - start;
+            start = i;
+            if (!nextSegment(false, report)) {
+                return false;
+            }
+        }
+
+        // Compute the duration of the segment from the PCR's of the reference PID.
+        if (_max_duration > 0 && _use_pcr && pkt.hasPCR()) {
+            const PID pid = pkt.getPID();
+            if (_pcr_pid == PID_NULL) {
+                _pcr_pid = pid;
+            }
+            if (pid == _pcr_pid) {
+                const uint64_t pcr = pkt.getPCR();
+                if (!_segment_pcr_ok) {
+                    _segment_pcr = pcr;
+                    _segment_pcr_ok = true;
+                }
+                else {
+                    const MilliSecond duration = MilliSecond(((pcr + PCR_WRAP - _segment_pcr) % PCR_WRAP) / (SYSTEM_CLOCK_FREQ / MilliSecPerSec));
+                    _split_pending = _split_pending || duration >= _max_duration;
+                    _split_forced = _split_forced || duration >= FORCE_SPLIT_FACTOR * _max_duration;
+                }
+            }
+        }
+    }
+
+    // Write the last block.
+    if (!_current->file.write(buffer + start, packet_count - start, report)) {
+        return false;
+    }
+    _total_packets += packet_count - start;
+    _segment_size += (packet_count - start) * PKT_SIZE;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Background thread which opens, closes, renames and deletes segment files.
+//----------------------------------------------------------------------------
+
+ts::TSFileOutputSegmented::Closer::Closer(TSFileOutputSegmented* output) :
+    Thread(),
+    _output(output)
+{
+}
+
+ts::TSFileOutputSegmented::Closer::~Closer()
+{
+    waitForTermination();
+}
+
+void ts::TSFileOutputSegmented::Closer::main()
+{
+    Report& report(*_output->_report);
+    std::deque<UString> completed;
+    SegmentPtr seg;
+
+    // Open the first segment and the next one in advance. Then, each time a segment
+    // is completed, open a new one. The writer always finds an open segment at split.
+    seg = _output->openSegment(report);
+    _output->_ready.forceEnqueue(seg);
+    if (!seg.isNull()) {
+        _output->_ready.forceEnqueue(_output->openSegment(report));
+    }
+
+    // A null pointer means end of output, without last segment.
+    while (_output->_queue.dequeue(seg) && !seg.isNull()) {
+
+        // Close the segment file, flushing pending data, then give its final name.
+        bool success = seg->file.close(report);
+        const ErrorCode error = RenameFile(seg->name + PART_SUFFIX, seg->name);
+        if (error != SYS_SUCCESS) {
+            report.error(u"error renaming %s: %s", {seg->name + PART_SUFFIX, ErrorCodeMessage(error)});
+            success = false;
+        }
+        if (!success) {
+            _output->_closer_failed = true;
+        }
+        completed.push_back(seg->name);
+
+        // Delete the oldest segments, keep room for the current one (if not the last).
+        while (_output->_max_files > 0 && completed.size() + (seg->last ? 0 : 1) > _output->_max_files) {
+            report.debug(u"deleting segment %s", {completed.front()});
+            DeleteFile(completed.front());
+            completed.pop_front();
+        }
+        if (seg->last) {
+            break;
+        }
+        _output->_ready.forceEnqueue(_output->openSegment(report));
+    }
+
+    // Delete the segments which were opened in advance but never used.
+    while (_output->_ready.dequeue(seg, 0)) {
+        if (!seg.isNull()) {
+            seg->file.close(NULLREP);
+            DeleteFile(seg->name + PART_SUFFIX);
+        }
+    }
+}
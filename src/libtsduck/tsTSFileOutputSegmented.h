@@ -0,0 +1,257 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//!
+//!  @file
+//!  Transport stream output file, split into segments.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSFileOutput.h"
+#include "tsSectionDemux.h"
+#include "tsTableHandlerInterface.h"
+#include "tsMessageQueue.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+
+namespace ts {
+    //!
+    //! Transport stream output file, split into segments.
+    //!
+    //! The output is split into several files, each of them containing a segment of
+    //! the stream. A new segment is started when the current one reaches a maximum
+    //! size or a maximum duration, optionally delayed until the next PAT or the next
+    //! random access point, so that each segment is independently usable. If no split
+    //! point is found before the segment reaches twice its maximum size or duration
+    //! (no PAT or no keyframe in the stream), the segment is split on any packet.
+    //!
+    //! The segment which is currently written has a temporary name. A background thread
+    //! opens the next segment in advance, closes the completed segments (which may involve
+    //! flushing buffers), renames them and deletes the oldest ones, so that the rotation
+    //! never blocks the writer. The concatenation of all segments is exactly the written stream.
+    //!
+    class TSDUCKDLL TSFileOutputSegmented: private TableHandlerInterface
+    {
+    public:
+        //!
+        //! Where a segment can be split, once its maximum size or duration is reached.
+        //!
+        enum SplitPoint {
+            SPLIT_ANYWHERE,   //!< Split on any packet.
+            SPLIT_AT_PAT,     //!< Split on the first packet of a PAT.
+            SPLIT_AT_KEYFRAME //!< Split on a random access point (unit start with random access indicator) of the video PID.
+        };
+
+        //!
+        //! Suffix which is added to the name of the segment which is currently written.
+        //!
+        static const UChar* const PART_SUFFIX;
+
+        //!
+        //! Default constructor.
+        //!
+        TSFileOutputSegmented();
+
+        //!
+        //! Destructor.
+        //!
+        virtual ~TSFileOutputSegmented();
+
+        //!
+        //! Set the maximum size of segments. Must be called before open().
+        //! @param [in] size Maximum size in bytes of each segment. Zero means unlimited.
+        //!
+        void setMaxSize(uint64_t size)
+        {
+            _max_size = size;
+        }
+
+        //!
+        //! Set the maximum duration of segments. Must be called before open().
+        //! @param [in] duration Maximum duration in milliseconds of each segment. Zero means unlimited.
+        //! @param [in] use_pcr If true, the duration is computed from the PCR's of the first PCR PID
+        //! in the stream. If false, the duration is computed from the system clock.
+        //!
+        void setMaxDuration(MilliSecond duration, bool use_pcr)
+        {
+            _max_duration = duration;
+            _use_pcr = use_pcr;
+        }
+
+        //!
+        //! Set where a segment can be split. Must be called before open().
+        //! @param [in] split Where a segment can be split. The default is SPLIT_ANYWHERE.
+        //!
+        void setSplitPoint(SplitPoint split)
+        {
+            _split = split;
+        }
+
+        //!
+        //! Set the maximum number of segment files to keep. Must be called before open().
+        //! @param [in] count Maximum number of segment files, including the current one.
+        //! The oldest segments are deleted. Zero means unlimited (the default).
+        //!
+        void setMaxFiles(size_t count)
+        {
+            _max_files = count;
+        }
+
+        //!
+        //! Access the segment file template.
+        //! The options of this object (asynchronous mode, direct I/O, etc.) are applied to all
+        //! segment files. This object itself is never opened.
+        //! @return A reference to the segment file template.
+        //!
+        TSFileOutput& fileTemplate()
+        {
+            return _template;
+        }
+
+        //!
+        //! Build the name of a segment file.
+        //! @param [in] filename Base file name, as specified in open().
+        //! @param [in] index Segment index, starting at zero.
+        //! @return The name of the segment file, with the index inserted before the file extension.
+        //!
+        static UString SegmentName(const UString& filename, size_t index);
+
+        //!
+        //! Open the first segment file.
+        //! @param [in] filename Base file name. The segment index is inserted before the extension.
+        //! @param [in,out] report Where to report errors. Also used by the background thread
+        //! until close(), must be thread-safe.
+        //! @return True on success, false on error.
+        //!
+        bool open(const UString& filename, Report& report);
+
+        //!
+        //! Close the current segment and wait for all segments to be completed.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Write TS packets, starting new segments when necessary.
+        //! @param [in] buffer Address of first packet to write.
+        //! @param [in] packet_count Number of packets to write.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool write(const TSPacket* buffer, size_t packet_count, Report& report);
+
+        //!
+        //! Check if the file is open.
+        //! @return True if the file is open.
+        //!
+        bool isOpen() const {return _is_open;}
+
+        //!
+        //! Get the number of written packets in all segments.
+        //! @return The number of written packets.
+        //!
+        PacketCounter getPacketCount() const {return _total_packets;}
+
+        //!
+        //! Get the number of segments which were created since open().
+        //! @return The number of segments.
+        //!
+        size_t getSegmentCount() const {return _segment_index;}
+
+    private:
+        // A segment file.
+        struct Segment
+        {
+            TSFileOutput file;       // Output file.
+            UString      name;       // Final segment file name.
+            bool         last;       // Last segment, the output is closed.
+            Segment() : file(), name(), last(false) {}
+        };
+        typedef SafePtr<Segment, Mutex> SegmentPtr;
+        typedef MessageQueue<Segment, Mutex> SegmentQueue;
+
+        // Background thread which opens, closes, renames and deletes segment files.
+        class Closer : public Thread
+        {
+        public:
+            Closer(TSFileOutputSegmented* output);
+            virtual ~Closer() override;
+        private:
+            TSFileOutputSegmented* _output;
+            virtual void main() override;
+            Closer() = delete;
+            Closer(const Closer&) = delete;
+            Closer& operator=(const Closer&) = delete;
+        };
+
+        TSFileOutput  _template;       // Template for segment files options.
+        uint64_t      _max_size;       // Maximum segment size in bytes.
+        MilliSecond   _max_duration;   // Maximum segment duration.
+        bool          _use_pcr;        // Use PCR to compute the duration.
+        SplitPoint    _split;          // Where to split segments.
+        size_t        _max_files;      // Maximum number of segment files.
+        UString       _filename;       // Base file name.
+        bool          _is_open;        // Check if file is actually open.
+        Report*       _report;         // Where to report errors from the background thread.
+        PacketCounter _total_packets;  // Total written packets.
+        size_t        _segment_index;  // Index of next segment.
+        SegmentPtr    _current;        // Current segment.
+        size_t        _open_index;     // Index of next segment to open in the closing thread.
+        uint64_t      _segment_size;   // Current segment size in bytes.
+        Time          _segment_start;  // System time of start of current segment.
+        PID           _pcr_pid;        // Reference PCR PID.
+        uint64_t      _segment_pcr;    // First PCR in current segment.
+        bool          _segment_pcr_ok; // First PCR in current segment is known.
+        bool          _split_pending;  // Maximum reached, split at next split point.
+        bool          _split_forced;   // No split point found, split at next packet.
+        SectionDemux  _demux;          // Demux for PAT and PMT's, with SPLIT_AT_KEYFRAME.
+        PID           _video_pid;      // Video PID for SPLIT_AT_KEYFRAME.
+        uint16_t      _video_service;  // Service id of the video PID.
+        SegmentQueue  _queue;          // Segments to close.
+        SegmentQueue  _ready;          // Pre-opened segments, null pointer on open error.
+        Closer*       _closer;         // Closing thread.
+        bool          _closer_failed;  // An error occured in the closing thread.
+
+        // Check if a split can occur before a packet.
+        bool isSplitPoint(const TSPacket& pkt) const;
+
+        // Close the current segment (asynchronously) and switch to the next pre-opened one (if not last).
+        bool nextSegment(bool last, Report& report);
+
+        // Open a new segment file, in the closing thread. Return a null pointer on error.
+        SegmentPtr openSegment(Report& report);
+
+        // Implementation of TableHandlerInterface.
+        virtual void handleTable(SectionDemux&, const BinaryTable&) override;
+
+        // Inaccessible operations
+        TSFileOutputSegmented(const TSFileOutputSegmented&) = delete;
+        TSFileOutputSegmented& operator=(const TSFileOutputSegmented&) = delete;
+    };
+}
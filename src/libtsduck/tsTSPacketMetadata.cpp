@@ -0,0 +1,72 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Metadata which are associated with a TS packet during processing.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSPacketMetadata.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::TSPacketMetadata::LABEL_COUNT;
+const size_t ts::TSPacketMetadata::MAX_LABEL;
+const uint64_t ts::TSPacketMetadata::INVALID_TIMESTAMP;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Reset the content of an array of metadata.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketMetadata::Reset(TSPacketMetadata* mdata, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        mdata[i].reset();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Set the input time stamp of the packet.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketMetadata::setInputTimeStamp(uint64_t time_stamp, uint64_t ticks_per_second)
+{
+    if (ticks_per_second == 0) {
+        _input_time = INVALID_TIMESTAMP;
+    }
+    else if (ticks_per_second == SYSTEM_CLOCK_FREQ) {
+        _input_time = time_stamp;
+    }
+    else {
+        // Split the computation to avoid overflow on large time stamps.
+        _input_time = (time_stamp / ticks_per_second) * SYSTEM_CLOCK_FREQ + ((time_stamp % ticks_per_second) * SYSTEM_CLOCK_FREQ) / ticks_per_second;
+    }
+}
@@ -0,0 +1,226 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Metadata which are associated with a TS packet during processing.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+
+namespace ts {
+    //!
+    //! Metadata which are associated with a TS packet during processing.
+    //!
+    //! Some applications such as tsp manage arrays of TS packets. Each packet
+    //! may come with facts which are not part of the packet content: when it
+    //! was received, whether it was dropped by a processor, etc. These facts
+    //! are stored in a parallel array of TSPacketMetadata, using the same index
+    //! as the packet in its own array.
+    //!
+    //! For performance reason, there is no constructor. Uninitialized objects
+    //! have undefined content, use reset() before use. An object of this class
+    //! is small and can be safely copied using memcpy().
+    //!
+    class TSDUCKDLL TSPacketMetadata
+    {
+    public:
+        //!
+        //! Maximum number of labels per packet.
+        //! Labels are identified by an integer value in the range 0 to MAX_LABEL.
+        //!
+        static const size_t LABEL_COUNT = 32;
+
+        //!
+        //! Highest valid label value.
+        //!
+        static const size_t MAX_LABEL = LABEL_COUNT - 1;
+
+        //!
+        //! Value of an invalid or absent input time stamp.
+        //!
+        static const uint64_t INVALID_TIMESTAMP = TS_UCONST64(0xFFFFFFFFFFFFFFFF);
+
+        //!
+        //! Reset the content of this instance.
+        //! All labels are cleared, the packet is not dropped and has no input time stamp.
+        //!
+        void reset()
+        {
+            _input_time = INVALID_TIMESTAMP;
+            _labels = 0;
+            _flags = 0;
+        }
+
+        //!
+        //! Reset the content of an array of metadata.
+        //! @param [out] mdata Address of an array of metadata.
+        //! @param [in] count Number of elements in @a mdata.
+        //!
+        static void Reset(TSPacketMetadata* mdata, size_t count);
+
+        //!
+        //! Check if the packet was dropped by a packet processor.
+        //! @return True if the packet was dropped and shall be ignored.
+        //!
+        bool getDropped() const
+        {
+            return (_flags & DROPPED) != 0;
+        }
+
+        //!
+        //! Mark the packet as dropped or not.
+        //! @param [in] on True if the packet is dropped.
+        //!
+        void setDropped(bool on)
+        {
+            setFlag(DROPPED, on);
+        }
+
+        //!
+        //! Check if the packet is a null packet which was artificially inserted
+        //! in the input stream (tsp option -\-add-input-stuffing for instance).
+        //! @return True if the packet was artificially inserted as input stuffing.
+        //!
+        bool getInputStuffing() const
+        {
+            return (_flags & INPUT_STUFFING) != 0;
+        }
+
+        //!
+        //! Mark the packet as input stuffing or not.
+        //! @param [in] on True if the packet was artificially inserted as input stuffing.
+        //!
+        void setInputStuffing(bool on)
+        {
+            setFlag(INPUT_STUFFING, on);
+        }
+
+        //!
+        //! Check if the packet has an input time stamp.
+        //! @return True if the packet has an input time stamp.
+        //!
+        bool hasInputTimeStamp() const
+        {
+            return _input_time != INVALID_TIMESTAMP;
+        }
+
+        //!
+        //! Get the input time stamp of the packet.
+        //! The input time stamp is the time when the packet was received by the
+        //! application, relative to an arbitrary origin (typically the start of
+        //! the input). It is expressed in PCR units (@link SYSTEM_CLOCK_FREQ @endlink).
+        //! @return The input time stamp or INVALID_TIMESTAMP if there is none.
+        //!
+        uint64_t getInputTimeStamp() const
+        {
+            return _input_time;
+        }
+
+        //!
+        //! Set the input time stamp of the packet.
+        //! @param [in] time_stamp Input time stamp in units of @a ticks_per_second.
+        //! @param [in] ticks_per_second Number of @a time_stamp units per second.
+        //! The time stamp is internally converted to PCR units.
+        //!
+        void setInputTimeStamp(uint64_t time_stamp, uint64_t ticks_per_second);
+
+        //!
+        //! Clear the input time stamp of the packet.
+        //!
+        void clearInputTimeStamp()
+        {
+            _input_time = INVALID_TIMESTAMP;
+        }
+
+        //!
+        //! Check if the packet has a label.
+        //! @param [in] label The label to check (0 to MAX_LABEL).
+        //! @return True if the packet has the label.
+        //!
+        bool hasLabel(size_t label) const
+        {
+            return label < LABEL_COUNT && (_labels & (uint32_t(1) << label)) != 0;
+        }
+
+        //!
+        //! Set a label on the packet.
+        //! @param [in] label The label to set (0 to MAX_LABEL). Ignored when out of range.
+        //!
+        void setLabel(size_t label)
+        {
+            if (label < LABEL_COUNT) {
+                _labels |= uint32_t(1) << label;
+            }
+        }
+
+        //!
+        //! Clear a label on the packet.
+        //! @param [in] label The label to clear (0 to MAX_LABEL). Ignored when out of range.
+        //!
+        void clearLabel(size_t label)
+        {
+            if (label < LABEL_COUNT) {
+                _labels &= ~(uint32_t(1) << label);
+            }
+        }
+
+        //!
+        //! Get all labels of the packet as a bit mask.
+        //! @return A bit mask where bit N is set when label N is set.
+        //!
+        uint32_t getLabels() const
+        {
+            return _labels;
+        }
+
+    private:
+        // Bit masks in _flags.
+        enum : uint32_t {
+            DROPPED        = 0x0001,
+            INPUT_STUFFING = 0x0002,
+        };
+
+        uint64_t _input_time;  // Input time stamp in PCR units, INVALID_TIMESTAMP if none.
+        uint32_t _labels;      // Bit mask of labels.
+        uint32_t _flags;       // Bit mask of flags.
+
+        // Set or clear a flag.
+        void setFlag(uint32_t flag, bool on)
+        {
+            if (on) {
+                _flags |= flag;
+            }
+            else {
+                _flags &= ~flag;
+            }
+        }
+    };
+}
@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Read-only views of PSI/SI sections, without copy or allocation.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTableViews.h"
+#include "tsMJD.h"
+#include "tsBCD.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Search a descriptor in a descriptor loop.
+//----------------------------------------------------------------------------
+
+ts::DescriptorLoopView::const_iterator ts::DescriptorLoopView::search(DID tag, const_iterator start) const
+{
+    const const_iterator last(end());
+    while (start != last && start->tag() != tag) {
+        ++start;
+    }
+    return start;
+}
+
+
+//----------------------------------------------------------------------------
+// PAT view.
+//----------------------------------------------------------------------------
+
+ts::PATView::PATView(const Section& section) :
+    _valid(section.isValid() && section.tableId() == TID_PAT),
+    _tid_ext(_valid ? section.tableIdExtension() : 0),
+    _programs()
+{
+    if (_valid) {
+        _programs = ProgramLoop(section.payload(), section.payloadSize());
+    }
+}
+
+ts::PID ts::PATView::pmtPID(uint16_t service_id) const
+{
+    for (ProgramLoop::const_iterator it = _programs.begin(); it != _programs.end(); ++it) {
+        if (it->serviceId() == service_id) {
+            return it->pmtPID();
+        }
+    }
+    return PID_NULL;
+}
+
+
+//----------------------------------------------------------------------------
+// PMT view.
+//----------------------------------------------------------------------------
+
+ts::PMTView::PMTView(const Section& section) :
+    _valid(section.isValid() && section.tableId() == TID_PMT && section.payloadSize() >= 4),
+    _tid_ext(_valid ? section.tableIdExtension() : 0),
+    _pcr_pid(PID_NULL),
+    _descs(),
+    _streams()
+{
+    if (_valid) {
+        const uint8_t* data = section.payload();
+        size_t remain = section.payloadSize();
+        _pcr_pid = GetUInt16(data) & 0x1FFF;
+        const size_t info_length = std::min<size_t>(GetUInt16(data + 2) & 0x0FFF, remain - 4);
+        _descs = DescriptorLoopView(data + 4, info_length);
+        _streams = StreamLoop(data + 4 + info_length, remain - 4 - info_length);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// SDT view.
+//----------------------------------------------------------------------------
+
+ts::SDTView::SDTView(const Section& section) :
+    _valid(section.isValid() && (section.tableId() == TID_SDT_ACT || section.tableId() == TID_SDT_OTH) && section.payloadSize() >= 3),
+    _tid(section.tableId()),
+    _tid_ext(_valid ? section.tableIdExtension() : 0),
+    _onetw_id(_valid ? GetUInt16(section.payload()) : 0),
+    _services()
+{
+    if (_valid) {
+        // Note that there is one trailing reserved byte after original_network_id.
+        _services = ServiceLoop(section.payload() + 3, section.payloadSize() - 3);
+    }
+}
+
+// Same rules as ts::ServiceDescriptor, without building a ts::Descriptor.
+bool ts::SDTView::Service::decodeServiceDescriptor(uint8_t* type, UString* provider, UString* name, const DVBCharset* charset) const
+{
+    const DescriptorLoopView descs(descriptors());
+    const DescriptorLoopView::const_iterator it(descs.search(DID_SERVICE));
+    if (it == descs.end() || it->payloadSize() < 3) {
+        return false;
+    }
+    const uint8_t* data = it->payload();
+    size_t size = it->payloadSize();
+    if (type != 0) {
+        *type = data[0];
+    }
+    data++; size--;
+    UString prov(UString::FromDVBWithByteLength(data, size, charset));
+    UString serv(UString::FromDVBWithByteLength(data, size, charset));
+    if (size != 0) {
+        return false;
+    }
+    if (provider != 0) {
+        provider->swap(prov);
+    }
+    if (name != 0) {
+        name->swap(serv);
+    }
+    return true;
+}
+
+uint8_t ts::SDTView::Service::serviceType() const
+{
+    uint8_t type = 0;
+    return decodeServiceDescriptor(&type, 0, 0, 0) ? type : 0; // 0 is a "reserved" service_type value
+}
+
+ts::UString ts::SDTView::Service::serviceName(const DVBCharset* charset) const
+{
+    UString name;
+    decodeServiceDescriptor(0, 0, &name, charset);
+    return name;
+}
+
+ts::UString ts::SDTView::Service::providerName(const DVBCharset* charset) const
+{
+    UString provider;
+    decodeServiceDescriptor(0, &provider, 0, charset);
+    return provider;
+}
+
+
+//----------------------------------------------------------------------------
+// NIT or BAT view.
+//----------------------------------------------------------------------------
+
+ts::NITView::NITView(const Section& section) :
+    _valid(section.isValid() && (section.tableId() == TID_NIT_ACT || section.tableId() == TID_NIT_OTH || section.tableId() == TID_BAT) && section.payloadSize() >= 2),
+    _tid(section.tableId()),
+    _tid_ext(_valid ? section.tableIdExtension() : 0),
+    _descs(),
+    _transports()
+{
+    if (_valid) {
+        const uint8_t* data = section.payload();
+        size_t remain = section.payloadSize();
+        const size_t info_length = std::min<size_t>(GetUInt16(data) & 0x0FFF, remain - 2);
+        _descs = DescriptorLoopView(data + 2, info_length);
+        data += 2 + info_length;
+        remain -= 2 + info_length;
+        // A missing transport stream loop length makes the section invalid, as in the NIT class.
+        if (remain < 2) {
+            _valid = false;
+        }
+        else {
+            const size_t ts_length = std::min<size_t>(GetUInt16(data) & 0x0FFF, remain - 2);
+            _transports = TransportLoop(data + 2, ts_length);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// EIT view.
+//----------------------------------------------------------------------------
+
+ts::EITView::EITView(const Section& section) :
+    _valid(section.isValid() && section.tableId() >= TID_EIT_MIN && section.tableId() <= TID_EIT_MAX && section.payloadSize() >= 6),
+    _tid(section.tableId()),
+    _tid_ext(_valid ? section.tableIdExtension() : 0),
+    _data(_valid ? section.payload() : 0),
+    _events()
+{
+    if (_valid) {
+        _events = EventLoop(_data + 6, section.payloadSize() - 6);
+    }
+}
+
+ts::Time ts::EITView::Event::startTime() const
+{
+    Time start;
+    DecodeMJD(_data + 2, 5, start);
+    return start;
+}
+
+ts::Second ts::EITView::Event::duration() const
+{
+    return (DecodeBCD(_data[7]) * 3600) + (DecodeBCD(_data[8]) * 60) + DecodeBCD(_data[9]);
+}
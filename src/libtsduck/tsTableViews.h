@@ -0,0 +1,704 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Read-only views of PSI/SI sections, without copy or allocation.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsSection.h"
+#include "tsMPEG.h"
+#include "tsTime.h"
+#include "tsUString.h"
+
+namespace ts {
+
+    class DVBCharset;
+
+    //!
+    //! Base class of all views of an entry inside a section (a descriptor,
+    //! a service in an SDT, a stream in a PMT, etc.)
+    //!
+    //! A view is a pair of pointer and size which refers to the section data,
+    //! it is only valid as long as the section is not modified or deleted.
+    //! When an entry does not fit in the remaining data, its size is zero.
+    //!
+    class TSDUCKDLL SectionEntryView
+    {
+    public:
+        //!
+        //! Address of the entry in the section.
+        //! @return Address of the entry in the section.
+        //!
+        const uint8_t* data() const
+        {
+            return _data;
+        }
+
+        //!
+        //! Size of the entry in bytes.
+        //! @return Size of the entry in bytes, zero if the entry is invalid.
+        //!
+        size_t size() const
+        {
+            return _size;
+        }
+
+        //!
+        //! Check if the entry is valid.
+        //! @return True if the entry is valid.
+        //!
+        bool isValid() const
+        {
+            return _size > 0;
+        }
+
+    protected:
+        const uint8_t* _data;  //!< Address of the entry.
+        size_t         _size;  //!< Size of the entry, zero if invalid.
+
+        //!
+        //! Constructor for subclasses.
+        //! @param [in] data Address of the entry.
+        //! @param [in] size Size of the entry, zero if invalid.
+        //!
+        SectionEntryView(const uint8_t* data = 0, size_t size = 0) :
+            _data(data),
+            _size(size)
+        {
+        }
+
+        //!
+        //! Compute the size of an entry made of a fixed part followed by a descriptor loop.
+        //! The descriptor loop length is in the 12 LSB of a 16-bit field. As in the table
+        //! classes, a descriptor loop which overflows the section is truncated.
+        //! @param [in] data Address of the entry.
+        //! @param [in] remain Number of bytes from @a data to the end of the loop.
+        //! @param [in] fixed_size Size of the fixed part of the entry.
+        //! @param [in] length_offset Offset of the descriptor loop length in the fixed part.
+        //! @return Size of the entry, zero if the fixed part does not fit.
+        //!
+        static size_t EntrySize(const uint8_t* data, size_t remain, size_t fixed_size, size_t length_offset)
+        {
+            return remain < fixed_size ? 0 : fixed_size + std::min<size_t>(GetUInt16(data + length_offset) & 0x0FFF, remain - fixed_size);
+        }
+    };
+
+    //!
+    //! View of a loop of entries inside a section.
+    //! @tparam ENTRY A subclass of SectionEntryView which can be constructed
+    //! from the address of the entry and the number of remaining bytes in the loop.
+    //!
+    template <class ENTRY>
+    class SectionLoopView
+    {
+    public:
+        //!
+        //! Forward iterator over the entries of the loop.
+        //! The iteration stops at the first entry which does not fit in the loop.
+        //!
+        class const_iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;  //!< Iterator category.
+            typedef const ENTRY value_type;                       //!< Type of the entries.
+            typedef std::ptrdiff_t difference_type;               //!< Difference between iterators.
+            typedef const ENTRY* pointer;                         //!< Pointer to an entry.
+            typedef const ENTRY& reference;                       //!< Reference to an entry.
+
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] end End of the loop.
+            //!
+            const_iterator(const uint8_t* data = 0, const uint8_t* end = 0) :
+                _end(end),
+                _entry()
+            {
+                locate(data);
+            }
+
+            //!
+            //! Access the current entry.
+            //! @return A constant reference to the current entry.
+            //!
+            const ENTRY& operator*() const
+            {
+                return _entry;
+            }
+
+            //!
+            //! Access the current entry.
+            //! @return A constant pointer to the current entry.
+            //!
+            const ENTRY* operator->() const
+            {
+                return &_entry;
+            }
+
+            //!
+            //! Move to next entry.
+            //! @return A reference to this object.
+            //!
+            const_iterator& operator++()
+            {
+                locate(_entry.data() + _entry.size());
+                return *this;
+            }
+
+            //!
+            //! Move to next entry.
+            //! @return A copy of this object before moving.
+            //!
+            const_iterator operator++(int)
+            {
+                const_iterator previous(*this);
+                ++*this;
+                return previous;
+            }
+
+            //!
+            //! Equality operator.
+            //! @param [in] other Another iterator to compare.
+            //! @return True if the two iterators point to the same entry.
+            //!
+            bool operator==(const const_iterator& other) const
+            {
+                return _entry.data() == other._entry.data();
+            }
+
+            //!
+            //! Unequality operator.
+            //! @param [in] other Another iterator to compare.
+            //! @return True if the two iterators point to different entries.
+            //!
+            bool operator!=(const const_iterator& other) const
+            {
+                return _entry.data() != other._entry.data();
+            }
+
+        private:
+            const uint8_t* _end;
+            ENTRY          _entry;
+
+            // Locate the entry at the specified address, move to end if there is none.
+            void locate(const uint8_t* data)
+            {
+                _entry = data < _end ? ENTRY(data, _end - data) : ENTRY(_end, 0);
+                if (!_entry.isValid()) {
+                    _entry = ENTRY(_end, 0);
+                }
+            }
+        };
+
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the loop.
+        //! @param [in] size Size of the loop in bytes.
+        //!
+        SectionLoopView(const uint8_t* data = 0, size_t size = 0) :
+            _data(data),
+            _size(data == 0 ? 0 : size)
+        {
+        }
+
+        //!
+        //! Address of the loop in the section.
+        //! @return Address of the loop in the section.
+        //!
+        const uint8_t* data() const
+        {
+            return _data;
+        }
+
+        //!
+        //! Size of the loop in bytes.
+        //! @return Size of the loop in bytes.
+        //!
+        size_t size() const
+        {
+            return _size;
+        }
+
+        //!
+        //! Get an iterator to the first entry.
+        //! @return An iterator to the first entry.
+        //!
+        const_iterator begin() const
+        {
+            return const_iterator(_data, _data + _size);
+        }
+
+        //!
+        //! Get an iterator after the last entry.
+        //! @return An iterator after the last entry.
+        //!
+        const_iterator end() const
+        {
+            return const_iterator(_data + _size, _data + _size);
+        }
+
+        //!
+        //! Check if the loop contains no valid entry.
+        //! @return True if the loop is empty.
+        //!
+        bool empty() const
+        {
+            return begin() == end();
+        }
+
+    private:
+        const uint8_t* _data;
+        size_t         _size;
+    };
+
+    //!
+    //! View of a descriptor inside a section.
+    //!
+    class TSDUCKDLL DescriptorView : public SectionEntryView
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the descriptor.
+        //! @param [in] remain Number of bytes from @a data to the end of the descriptor loop.
+        //! The view is invalid if the descriptor does not fit.
+        //!
+        DescriptorView(const uint8_t* data = 0, size_t remain = 0) :
+            SectionEntryView(data, remain >= 2 && size_t(data[1]) + 2 <= remain ? size_t(data[1]) + 2 : 0)
+        {
+        }
+
+        //!
+        //! Get the descriptor tag.
+        //! @return The descriptor tag.
+        //!
+        DID tag() const
+        {
+            return _data[0];
+        }
+
+        //!
+        //! Access to the payload of the descriptor.
+        //! @return Address of the payload of the descriptor.
+        //!
+        const uint8_t* payload() const
+        {
+            return _data + 2;
+        }
+
+        //!
+        //! Size of the payload of the descriptor.
+        //! @return Size in bytes of the payload of the descriptor.
+        //!
+        size_t payloadSize() const
+        {
+            return _size - 2;
+        }
+    };
+
+    //!
+    //! View of a descriptor loop inside a section.
+    //! As in ts::DescriptorList, the loop ends at the first truncated descriptor.
+    //!
+    class TSDUCKDLL DescriptorLoopView : public SectionLoopView<DescriptorView>
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] data Address of the descriptor loop.
+        //! @param [in] size Size of the descriptor loop in bytes.
+        //!
+        DescriptorLoopView(const uint8_t* data = 0, size_t size = 0) :
+            SectionLoopView<DescriptorView>(data, size)
+        {
+        }
+
+        //!
+        //! Search a descriptor with the specified tag.
+        //! Private descriptors (tag 0x80 and above) are searched without checking
+        //! the private data specifier.
+        //! @param [in] tag Tag of descriptor to search.
+        //! @param [in] start Start searching at this position.
+        //! @return An iterator to the descriptor or end() if not found.
+        //!
+        const_iterator search(DID tag, const_iterator start) const;
+
+        //!
+        //! Search the first descriptor with the specified tag.
+        //! @param [in] tag Tag of descriptor to search.
+        //! @return An iterator to the descriptor or end() if not found.
+        //!
+        const_iterator search(DID tag) const
+        {
+            return search(tag, begin());
+        }
+    };
+
+    //!
+    //! View of one section of a Program Association Table (PAT).
+    //!
+    class TSDUCKDLL PATView
+    {
+    public:
+        //!
+        //! View of one program in a PAT.
+        //!
+        class TSDUCKDLL Program : public SectionEntryView
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] remain Number of bytes from @a data to the end of the loop.
+            //!
+            Program(const uint8_t* data = 0, size_t remain = 0) : SectionEntryView(data, remain < 4 ? 0 : 4) {}
+            //! @return The service id, zero for the NIT entry.
+            uint16_t serviceId() const { return GetUInt16(_data); }
+            //! @return The PMT PID (or NIT PID for service id zero).
+            PID pmtPID() const { return GetUInt16(_data + 2) & 0x1FFF; }
+        };
+
+        //!
+        //! Loop of programs.
+        //!
+        typedef SectionLoopView<Program> ProgramLoop;
+
+        //!
+        //! Constructor.
+        //! @param [in] section A section of a PAT. The section must not be modified
+        //! or deleted while the view is used.
+        //!
+        explicit PATView(const Section& section);
+
+        //! @return True if the section is a valid PAT section.
+        bool isValid() const { return _valid; }
+        //! @return The transport stream id.
+        uint16_t tsId() const { return _tid_ext; }
+        //! @return The list of programs, including the NIT entry (service id zero) if present.
+        ProgramLoop programs() const { return _programs; }
+
+        //!
+        //! Get the NIT PID.
+        //! @return The NIT PID or PID_NULL if there is none in this section.
+        //!
+        PID nitPID() const
+        {
+            return pmtPID(0);
+        }
+
+        //!
+        //! Get the PMT PID of a service.
+        //! @param [in] service_id The service id to search.
+        //! @return The PMT PID or PID_NULL if the service is not in this section.
+        //!
+        PID pmtPID(uint16_t service_id) const;
+
+    private:
+        bool        _valid;
+        uint16_t    _tid_ext;
+        ProgramLoop _programs;
+    };
+
+    //!
+    //! View of one section of a Program Map Table (PMT).
+    //!
+    class TSDUCKDLL PMTView
+    {
+    public:
+        //!
+        //! View of one elementary stream in a PMT.
+        //!
+        class TSDUCKDLL Stream : public SectionEntryView
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] remain Number of bytes from @a data to the end of the loop.
+            //!
+            Stream(const uint8_t* data = 0, size_t remain = 0) : SectionEntryView(data, EntrySize(data, remain, 5, 3)) {}
+            //! @return The stream type.
+            uint8_t streamType() const { return _data[0]; }
+            //! @return The elementary stream PID.
+            PID pid() const { return GetUInt16(_data + 1) & 0x1FFF; }
+            //! @return The descriptor loop of the stream.
+            DescriptorLoopView descriptors() const { return DescriptorLoopView(_data + 5, _size - 5); }
+        };
+
+        //!
+        //! Loop of elementary streams.
+        //!
+        typedef SectionLoopView<Stream> StreamLoop;
+
+        //!
+        //! Constructor.
+        //! @param [in] section A section of a PMT. The section must not be modified
+        //! or deleted while the view is used.
+        //!
+        explicit PMTView(const Section& section);
+
+        //! @return True if the section is a valid PMT section.
+        bool isValid() const { return _valid; }
+        //! @return The service id.
+        uint16_t serviceId() const { return _tid_ext; }
+        //! @return The PCR PID.
+        PID pcrPID() const { return _pcr_pid; }
+        //! @return The program-level descriptor loop.
+        DescriptorLoopView descriptors() const { return _descs; }
+        //! @return The list of elementary streams.
+        StreamLoop streams() const { return _streams; }
+
+    private:
+        bool               _valid;
+        uint16_t           _tid_ext;
+        PID                _pcr_pid;
+        DescriptorLoopView _descs;
+        StreamLoop         _streams;
+    };
+
+    //!
+    //! View of one section of a Service Description Table (SDT).
+    //!
+    class TSDUCKDLL SDTView
+    {
+    public:
+        //!
+        //! View of one service in an SDT.
+        //!
+        class TSDUCKDLL Service : public SectionEntryView
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] remain Number of bytes from @a data to the end of the loop.
+            //!
+            Service(const uint8_t* data = 0, size_t remain = 0) : SectionEntryView(data, EntrySize(data, remain, 5, 3)) {}
+            //! @return The service id.
+            uint16_t serviceId() const { return GetUInt16(_data); }
+            //! @return True if EIT schedule are present.
+            bool EITsPresent() const { return (_data[2] & 0x02) != 0; }
+            //! @return True if EIT present/following are present.
+            bool EITpfPresent() const { return (_data[2] & 0x01) != 0; }
+            //! @return The running status.
+            uint8_t runningStatus() const { return _data[3] >> 5; }
+            //! @return True if the service is controlled by a CA system.
+            bool CAControlled() const { return (_data[3] & 0x10) != 0; }
+            //! @return The descriptor loop of the service.
+            DescriptorLoopView descriptors() const { return DescriptorLoopView(_data + 5, _size - 5); }
+
+            //!
+            //! Get the service type from the first service descriptor, as in ts::SDT::Service.
+            //! @return The service type or zero if there is no valid service descriptor.
+            //!
+            uint8_t serviceType() const;
+
+            //!
+            //! Get the service name from the first service descriptor, as in ts::SDT::Service.
+            //! @param [in] charset If not zero, character set to use without explicit table code.
+            //! @return The service name or an empty string if there is no valid service descriptor.
+            //!
+            UString serviceName(const DVBCharset* charset = 0) const;
+
+            //!
+            //! Get the provider name from the first service descriptor, as in ts::SDT::Service.
+            //! @param [in] charset If not zero, character set to use without explicit table code.
+            //! @return The provider name or an empty string if there is no valid service descriptor.
+            //!
+            UString providerName(const DVBCharset* charset = 0) const;
+
+        private:
+            // Decode the first service descriptor, return false if there is no valid one.
+            bool decodeServiceDescriptor(uint8_t* type, UString* provider, UString* name, const DVBCharset* charset) const;
+        };
+
+        //!
+        //! Loop of services.
+        //!
+        typedef SectionLoopView<Service> ServiceLoop;
+
+        //!
+        //! Constructor.
+        //! @param [in] section A section of an SDT Actual or Other. The section must
+        //! not be modified or deleted while the view is used.
+        //!
+        explicit SDTView(const Section& section);
+
+        //! @return True if the section is a valid SDT section.
+        bool isValid() const { return _valid; }
+        //! @return True for SDT Actual TS, false for SDT Other TS.
+        bool isActual() const { return _tid == TID_SDT_ACT; }
+        //! @return The transport stream id.
+        uint16_t tsId() const { return _tid_ext; }
+        //! @return The original network id.
+        uint16_t originalNetworkId() const { return _onetw_id; }
+        //! @return The list of services.
+        ServiceLoop services() const { return _services; }
+
+    private:
+        bool        _valid;
+        TID         _tid;
+        uint16_t    _tid_ext;
+        uint16_t    _onetw_id;
+        ServiceLoop _services;
+    };
+
+    //!
+    //! View of one section of a Network Information Table (NIT) or a Bouquet
+    //! Association Table (BAT). Both tables share the same layout.
+    //!
+    class TSDUCKDLL NITView
+    {
+    public:
+        //!
+        //! View of one transport stream in a NIT or BAT.
+        //!
+        class TSDUCKDLL Transport : public SectionEntryView
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] remain Number of bytes from @a data to the end of the loop.
+            //!
+            Transport(const uint8_t* data = 0, size_t remain = 0) : SectionEntryView(data, EntrySize(data, remain, 6, 4)) {}
+            //! @return The transport stream id.
+            uint16_t tsId() const { return GetUInt16(_data); }
+            //! @return The original network id.
+            uint16_t originalNetworkId() const { return GetUInt16(_data + 2); }
+            //! @return The descriptor loop of the transport stream.
+            DescriptorLoopView descriptors() const { return DescriptorLoopView(_data + 6, _size - 6); }
+        };
+
+        //!
+        //! Loop of transport streams.
+        //!
+        typedef SectionLoopView<Transport> TransportLoop;
+
+        //!
+        //! Constructor.
+        //! @param [in] section A section of a NIT Actual, NIT Other or BAT. The section
+        //! must not be modified or deleted while the view is used.
+        //!
+        explicit NITView(const Section& section);
+
+        //! @return True if the section is a valid NIT or BAT section.
+        bool isValid() const { return _valid; }
+        //! @return The table id.
+        TID tableId() const { return _tid; }
+        //! @return The network id (bouquet id in a BAT).
+        uint16_t networkId() const { return _tid_ext; }
+        //! @return The network-level (or bouquet-level) descriptor loop.
+        DescriptorLoopView descriptors() const { return _descs; }
+        //! @return The list of transport streams.
+        TransportLoop transports() const { return _transports; }
+
+    private:
+        bool               _valid;
+        TID                _tid;
+        uint16_t           _tid_ext;
+        DescriptorLoopView _descs;
+        TransportLoop      _transports;
+    };
+
+    //!
+    //! View of one section of an Event Information Table (EIT).
+    //!
+    class TSDUCKDLL EITView
+    {
+    public:
+        //!
+        //! View of one event in an EIT.
+        //!
+        class TSDUCKDLL Event : public SectionEntryView
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the entry.
+            //! @param [in] remain Number of bytes from @a data to the end of the loop.
+            //!
+            Event(const uint8_t* data = 0, size_t remain = 0) : SectionEntryView(data, EntrySize(data, remain, 12, 10)) {}
+            //! @return The event id.
+            uint16_t eventId() const { return GetUInt16(_data); }
+            //! @return The event start time in UTC.
+            Time startTime() const;
+            //! @return The event duration in seconds.
+            Second duration() const;
+            //! @return The running status.
+            uint8_t runningStatus() const { return (_data[10] >> 5) & 0x07; }
+            //! @return True if the event is controlled by a CA system.
+            bool CAControlled() const { return (_data[10] & 0x10) != 0; }
+            //! @return The descriptor loop of the event.
+            DescriptorLoopView descriptors() const { return DescriptorLoopView(_data + 12, _size - 12); }
+        };
+
+        //!
+        //! Loop of events.
+        //!
+        typedef SectionLoopView<Event> EventLoop;
+
+        //!
+        //! Constructor.
+        //! @param [in] section A section of an EIT. The section must not be modified
+        //! or deleted while the view is used.
+        //!
+        explicit EITView(const Section& section);
+
+        //! @return True if the section is a valid EIT section.
+        bool isValid() const { return _valid; }
+        //! @return The table id.
+        TID tableId() const { return _tid; }
+        //! @return True for an EIT Actual TS, false for an EIT Other TS.
+        bool isActual() const { return _tid == TID_EIT_PF_ACT || (_tid >= TID_EIT_S_ACT_MIN && _tid <= TID_EIT_S_ACT_MAX); }
+        //! @return True for an EIT present/following, false for an EIT schedule.
+        bool isPresentFollowing() const { return _tid == TID_EIT_PF_ACT || _tid == TID_EIT_PF_OTH; }
+        //! @return The service id.
+        uint16_t serviceId() const { return _tid_ext; }
+        //! @return The transport stream id.
+        uint16_t tsId() const { return _valid ? GetUInt16(_data) : 0; }
+        //! @return The original network id.
+        uint16_t originalNetworkId() const { return _valid ? GetUInt16(_data + 2) : 0; }
+        //! @return The segment last section number.
+        uint8_t segmentLastSectionNumber() const { return _valid ? _data[4] : 0; }
+        //! @return The last table id.
+        TID lastTableId() const { return _valid ? _data[5] : _tid; }
+        //! @return The list of events.
+        EventLoop events() const { return _events; }
+
+    private:
+        bool           _valid;
+        TID            _tid;
+        uint16_t       _tid_ext;
+        const uint8_t* _data;
+        EventLoop      _events;
+    };
+}
@@ -64,9 +64,11 @@ ts::TablesLogger::TablesLogger(const TablesLoggerArgs& opt, TablesDisplay& displ
     _sock(false, report),
     _shortSections()
 {
-    // Set either a table or section handler, depending on --all-sections
+    // Set either a table or section handler, depending on --all-sections.
+    // When all sections are logged, avoid reallocating each section.
     if (_opt.all_sections) {
         _demux.setSectionHandler(this);
+        _demux.setHighThroughput(true);
     }
     else {
         _demux.setTableHandler(this);
@@ -179,13 +179,31 @@ bool ts::Thread::start()
         return false;
     }
 
-    // Set the thread priority
-    ::BOOL status = ::SetThreadPriority(_handle, ThreadAttributes::Win32Priority(_attributes._priority));
+    // Set the thread priority. There is no per-thread real-time policy on Windows,
+    // a real-time thread gets the highest priority.
+    const int priority = _attributes._policy == ThreadAttributes::POLICY_DEFAULT ?
+        ThreadAttributes::Win32Priority(_attributes._priority) :
+        THREAD_PRIORITY_TIME_CRITICAL;
+    ::BOOL status = ::SetThreadPriority(_handle, priority);
     if (status == 0) {
         ::CloseHandle(_handle);
         return false;
     }
 
+    // Set the CPU affinity. Only the first 64 CPU's can be used.
+    if (!_attributes._affinity.empty()) {
+        ::DWORD_PTR mask = 0;
+        for (std::set<size_t>::const_iterator it = _attributes._affinity.begin(); it != _attributes._affinity.end(); ++it) {
+            if (*it < 8 * sizeof(mask)) {
+                mask |= ::DWORD_PTR(1) << *it;
+            }
+        }
+        if (mask != 0 && ::SetThreadAffinityMask(_handle, mask) == 0) {
+            ::CloseHandle(_handle);
+            return false;
+        }
+    }
+
     // Release the thread
     if (::ResumeThread(_handle) == ::DWORD(-1)) {
         ::CloseHandle(_handle);
@@ -209,20 +227,31 @@ bool ts::Thread::start()
             return false;
         }
     }
-    // Set scheduling policy identical as current process.
+    // Set scheduling policy identical as current process or a real-time policy.
+    int policy = ThreadAttributes::PthreadSchedulingPolicy();
+    int priority = _attributes._priority;
+#if !defined(TS_MAC)
+    // A real-time policy has its own range of priorities.
+    if (_attributes._policy != ThreadAttributes::POLICY_DEFAULT) {
+        policy = _attributes._policy == ThreadAttributes::POLICY_FIFO ? SCHED_FIFO : SCHED_RR;
+        const int prioMin = ::sched_get_priority_min(policy);
+        const int prioMax = ::sched_get_priority_max(policy);
+        priority = _attributes._rtPriority == 0 ? (prioMin + prioMax) / 2 : std::max(prioMin, std::min(prioMax, _attributes._rtPriority));
+    }
+#endif
     // Note: Coverity seems out of its mind here:
     //   CID 158305 (#1 of 1): Argument cannot be negative (NEGATIVE_RETURNS)
     //   6. negative_returns: ts::ThreadAttributes::PthreadSchedulingPolicy() is passed to a parameter that cannot be negative
     // But pthread_attr_setschedpolicy second argument is signed:
     //   int pthread_attr_setschedpolicy(pthread_attr_t *attr, int policy);
     // coverity[NEGATIVE_RETURNS]
-    if (::pthread_attr_setschedpolicy(&attr, ThreadAttributes::PthreadSchedulingPolicy()) != 0) {
+    if (::pthread_attr_setschedpolicy(&attr, policy) != 0) {
         ::pthread_attr_destroy(&attr);
         return false;
     }
     // Set scheduling priority.
     ::sched_param sparam;
-    sparam.sched_priority = _attributes._priority;
+    sparam.sched_priority = priority;
     if (::pthread_attr_setschedparam(&attr, &sparam) != 0) {
         ::pthread_attr_destroy(&attr);
         return false;
@@ -232,6 +261,22 @@ bool ts::Thread::start()
         ::pthread_attr_destroy(&attr);
         return false;
     }
+#if defined(TS_LINUX)
+    // Set the CPU affinity.
+    if (!_attributes._affinity.empty()) {
+        ::cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (std::set<size_t>::const_iterator it = _attributes._affinity.begin(); it != _attributes._affinity.end(); ++it) {
+            if (*it < CPU_SETSIZE) {
+                CPU_SET(*it, &cpus);
+            }
+        }
+        if (::pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) != 0) {
+            ::pthread_attr_destroy(&attr);
+            return false;
+        }
+    }
+#endif
     // Create the thread
     if (::pthread_create(&_pthread, &attr, Thread::ThreadProc, this) != 0) {
         ::pthread_attr_destroy(&attr);
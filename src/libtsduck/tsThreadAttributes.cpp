@@ -152,7 +152,10 @@ int ts::ThreadAttributes::Win32Priority(int priority)
 ts::ThreadAttributes::ThreadAttributes() :
     _stackSize(0),
     _deleteWhenTerminated(false),
-    _priority(0)
+    _priority(0),
+    _policy(POLICY_DEFAULT),
+    _rtPriority(0),
+    _affinity()
 {
     if (!_priorityInitialized) {
         InitializePriorities();
@@ -184,6 +184,92 @@ namespace ts {
             return _priority;
         }
 
+        //!
+        //! Scheduling policy of a thread.
+        //!
+        enum SchedulingPolicy {
+            POLICY_DEFAULT,      //!< Same scheduling policy as the current process.
+            POLICY_FIFO,         //!< Real-time, first-in first-out (SCHED_FIFO on Linux).
+            POLICY_ROUND_ROBIN,  //!< Real-time, round-robin (SCHED_RR on Linux).
+        };
+
+        //!
+        //! Set the scheduling policy for the thread.
+        //!
+        //! With the real-time policies, the priority of the thread is specified using
+        //! setRealTimePriority() instead of setPriority(). On Linux, creating a thread
+        //! with a real-time policy requires privileges (root or capability CAP_SYS_NICE)
+        //! and ts::Thread::start() fails otherwise. On Windows, there is no per-thread
+        //! scheduling policy and a real-time thread uses the time critical priority.
+        //! On MacOS, the real-time policies are ignored.
+        //!
+        //! @param [in] policy The scheduling policy for the thread.
+        //! @return A reference to this object.
+        //!
+        ThreadAttributes& setSchedulingPolicy(SchedulingPolicy policy)
+        {
+            _policy = policy;
+            return *this;
+        }
+
+        //!
+        //! Get the scheduling policy for the thread.
+        //! @return The scheduling policy for the thread.
+        //!
+        SchedulingPolicy getSchedulingPolicy() const
+        {
+            return _policy;
+        }
+
+        //!
+        //! Set the real-time priority for the thread.
+        //! This priority is used with the real-time scheduling policies only.
+        //! @param [in] priority The real-time priority, in the operating system
+        //! range for the policy (1 to 99 on Linux). It is forced within the allowed
+        //! range when the thread is started. Zero means the middle of the range.
+        //! @return A reference to this object.
+        //! @see setSchedulingPolicy()
+        //!
+        ThreadAttributes& setRealTimePriority(int priority)
+        {
+            _rtPriority = priority;
+            return *this;
+        }
+
+        //!
+        //! Get the real-time priority for the thread.
+        //! @return The real-time priority for the thread, zero for the middle of the range.
+        //!
+        int getRealTimePriority() const
+        {
+            return _rtPriority;
+        }
+
+        //!
+        //! Set the CPU affinity of the thread.
+        //! The thread is allowed to run only on the specified CPU's.
+        //! On Windows, CPU's after the 64th one are ignored. On MacOS, there is no
+        //! thread affinity and this attribute is ignored.
+        //! @param [in] cpus Set of CPU indexes, starting at zero. When empty (the default),
+        //! the thread can run on any CPU.
+        //! @return A reference to this object.
+        //!
+        ThreadAttributes& setAffinity(const std::set<size_t>& cpus)
+        {
+            _affinity = cpus;
+            return *this;
+        }
+
+        //!
+        //! Get the CPU affinity of the thread.
+        //! @return The set of CPU indexes on which the thread can run. When empty,
+        //! the thread can run on any CPU.
+        //!
+        const std::set<size_t>& getAffinity() const
+        {
+            return _affinity;
+        }
+
         //!
         //! Get the minimum priority for a thread in this context of the operating system.
         //! @return The minimum priority for a thread.
@@ -241,6 +327,9 @@ namespace ts {
         size_t _stackSize;
         bool _deleteWhenTerminated;
         int _priority;
+        SchedulingPolicy _policy;
+        int _rtPriority;
+        std::set<size_t> _affinity;
 
         //
         // These fields describe the operating system priority range.
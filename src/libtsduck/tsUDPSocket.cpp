@@ -32,8 +32,28 @@
 //----------------------------------------------------------------------------
 
 #include "tsUDPSocket.h"
+#include "tsTime.h"
+#if defined(TS_LINUX)
+#include <netinet/udp.h>
+#endif
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::UDPSocket::MAX_RECEIVE_MESSAGES;
+const size_t ts::UDPSocket::MAX_SEND_MESSAGES;
+#endif
+
+// UDP segmentation offload, may be missing in older system headers.
+#if defined(TS_LINUX) && !defined(SOL_UDP)
+    #define SOL_UDP 17
+#endif
+#if defined(TS_LINUX) && !defined(UDP_SEGMENT)
+    #define UDP_SEGMENT 103
+#endif
+
+// Maximum size of a buffer in one UDP segmentation offload operation.
+#define MAX_GSO_SIZE 65000
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -42,7 +62,8 @@ TSDUCK_SOURCE;
 ts::UDPSocket::UDPSocket(bool auto_open, Report& report) :
     _sock(TS_SOCKET_T_INVALID),
     _default_destination(),
-    _mcast()
+    _mcast(),
+    _gso(false)
 {
     if (auto_open) {
         // Returned value ignored on purpose, the socket is marked as closed in the object on error.
@@ -156,6 +177,68 @@ bool ts::UDPSocket::reusePort (bool reuse_port, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Enable or disable the kernel receive time stamps.
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::setReceiveTimestamps(bool on, Report& report)
+{
+#if defined(TS_WINDOWS)
+    if (on) {
+        report.error(u"kernel receive time stamps not supported on this system");
+        return false;
+    }
+    return true;
+#else
+    // Actual socket option is an int.
+    int value = int(on);
+
+#if defined(TS_LINUX)
+    const int option = SO_TIMESTAMPNS;
+#else
+    const int option = SO_TIMESTAMP;
+#endif
+
+    if (::setsockopt(_sock, SOL_SOCKET, option, TS_SOCKOPT_T(&value), sizeof(value)) != 0) {
+        report.error(u"error setting socket receive time stamps: " + SocketErrorCodeMessage());
+        return false;
+    }
+    return true;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Enable or disable the UDP segmentation offload.
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::setSendSegmentation(bool on, Report& report)
+{
+#if defined(TS_LINUX)
+    if (on) {
+        // The segment size is specified in each send operation. Setting a zero
+        // default segment size on the socket is only used to check the support.
+        int value = 0;
+        if (::setsockopt(_sock, SOL_UDP, UDP_SEGMENT, TS_SOCKOPT_T(&value), sizeof(value)) != 0) {
+            report.error(u"UDP segmentation offload not supported: " + SocketErrorCodeMessage());
+            return false;
+        }
+    }
+    _gso = on;
+    return true;
+#else
+    if (on) {
+        report.error(u"UDP segmentation offload not supported on this system");
+        return false;
+    }
+    _gso = false;
+    return true;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Bind to a local address and port.
 // Return true on success, false on error.
@@ -348,6 +431,109 @@ bool ts::UDPSocket::send(const void* data, size_t size, const SocketAddress& des
 }
 
 
+//----------------------------------------------------------------------------
+// Send a contiguous area as a sequence of messages of identical size.
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::sendMessages(const void* data, size_t size, size_t msg_size, const SocketAddress& dest, Report& report)
+{
+    if (msg_size == 0) {
+        report.error(u"invalid UDP message size");
+        return false;
+    }
+
+    const char* ptr = reinterpret_cast<const char*>(data);
+
+#if defined(TS_LINUX)
+
+    ::sockaddr addr;
+    dest.copy(addr);
+
+    // With UDP segmentation offload, send large buffers, the kernel splits them.
+    if (_gso && size > msg_size) {
+        const size_t max_chunk = std::max<size_t>(1, std::min<size_t>(MAX_SEND_MESSAGES, MAX_GSO_SIZE / msg_size)) * msg_size;
+        uint64_t control[(CMSG_SPACE(sizeof(uint16_t)) + 7) / 8];
+        while (size > 0) {
+            const size_t chunk = std::min(size, max_chunk);
+            ::iovec iov;
+            iov.iov_base = const_cast<char*>(ptr);
+            iov.iov_len = chunk;
+            ::msghdr hdr;
+            TS_ZERO(hdr);
+            hdr.msg_name = &addr;
+            hdr.msg_namelen = sizeof(addr);
+            hdr.msg_iov = &iov;
+            hdr.msg_iovlen = 1;
+            if (chunk > msg_size) {
+                TS_ZERO(control);
+                hdr.msg_control = control;
+                hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+                ::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t segment = uint16_t(msg_size);
+                ::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+            }
+            if (::sendmsg(_sock, &hdr, 0) < 0) {
+                report.error(u"error sending UDP message: " + SocketErrorCodeMessage());
+                return false;
+            }
+            ptr += chunk;
+            size -= chunk;
+        }
+        return true;
+    }
+
+    // Otherwise, send up to MAX_SEND_MESSAGES messages per system call.
+    ::iovec iov[MAX_SEND_MESSAGES];
+    ::mmsghdr hdr[MAX_SEND_MESSAGES];
+    while (size > 0) {
+        size_t count = 0;
+        TS_ZERO(hdr);
+        for (; count < MAX_SEND_MESSAGES && size > 0; ++count) {
+            const size_t len = std::min(size, msg_size);
+            iov[count].iov_base = const_cast<char*>(ptr);
+            iov[count].iov_len = len;
+            hdr[count].msg_hdr.msg_name = &addr;
+            hdr[count].msg_hdr.msg_namelen = sizeof(addr);
+            hdr[count].msg_hdr.msg_iov = &iov[count];
+            hdr[count].msg_hdr.msg_iovlen = 1;
+            ptr += len;
+            size -= len;
+        }
+        // sendmmsg() may send less messages than requested, loop on remaining ones.
+        for (size_t first = 0; first < count; ) {
+            const int sent = ::sendmmsg(_sock, hdr + first, unsigned(count - first), 0);
+            if (sent < 0 && errno != EINTR) {
+                report.error(u"error sending UDP message: " + SocketErrorCodeMessage());
+                return false;
+            }
+            else if (sent > 0) {
+                first += size_t(sent);
+            }
+        }
+    }
+    return true;
+
+#else
+
+    // No multi-message send, send one message at a time.
+    while (size > 0) {
+        const size_t len = std::min(size, msg_size);
+        if (!send(ptr, len, dest, report)) {
+            return false;
+        }
+        ptr += len;
+        size -= len;
+    }
+    return true;
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Receive a message.
 // If abort interface is non-zero, invoke it when I/O is interrupted
@@ -396,3 +582,226 @@ bool ts::UDPSocket::receive(void* data,
         }
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Default constructor of a message buffer for multi-message receive.
+//----------------------------------------------------------------------------
+
+ts::UDPSocket::Message::Message() :
+    data(0),
+    max_size(0),
+    overflow(0),
+    overflow_size(0),
+    size(0),
+    sender(),
+    timestamp(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Get the current system time in nanoseconds since Time::Epoch.
+// Used as time stamp when no kernel time stamp is available.
+//----------------------------------------------------------------------------
+
+namespace {
+    ts::NanoSecond SystemTimeStamp()
+    {
+#if defined(TS_WINDOWS)
+        // A FILETIME is a number of 100 ns since the Windows epoch.
+        ::FILETIME ft;
+        ::GetSystemTimeAsFileTime(&ft);
+        return 100 * ((ts::NanoSecond(ft.dwHighDateTime) << 32) | ts::NanoSecond(ft.dwLowDateTime));
+#else
+        return ts::Time::UnixClockNanoSeconds(CLOCK_REALTIME);
+#endif
+    }
+
+#if !defined(TS_WINDOWS)
+    // Size of control data for receive time stamps, in 64-bit words for alignment.
+    #if defined(TS_LINUX)
+        const size_t TIMESTAMP_CONTROL_WORDS = (CMSG_SPACE(sizeof(::timespec)) + 7) / 8;
+    #else
+        const size_t TIMESTAMP_CONTROL_WORDS = (CMSG_SPACE(sizeof(::timeval)) + 7) / 8;
+    #endif
+
+    // Extract the kernel receive time stamp from control data (zero if there is none).
+    ts::NanoSecond KernelTimeStamp(::msghdr& hdr)
+    {
+        for (::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != 0; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+    #if defined(TS_LINUX)
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                ::timespec stamp;
+                ::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                return ts::NanoSecond(stamp.tv_sec) * ts::NanoSecPerSec + ts::NanoSecond(stamp.tv_nsec);
+            }
+    #else
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP) {
+                ::timeval stamp;
+                ::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                return ts::NanoSecond(stamp.tv_sec) * ts::NanoSecPerSec + ts::NanoSecond(stamp.tv_usec) * ts::NanoSecPerMicroSec;
+            }
+    #endif
+        }
+        return 0;
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Receive several messages in one operation.
+// Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::receive(Message* messages,
+                            size_t count,
+                            size_t& ret_count,
+                            const AbortInterface* abort,
+                            Report& report)
+{
+    return receiveMessages(messages, count, ret_count, true, abort, report);
+}
+
+bool ts::UDPSocket::receiveAvailable(Message* messages, size_t count, size_t& ret_count, Report& report)
+{
+    return receiveMessages(messages, count, ret_count, false, 0, report);
+}
+
+bool ts::UDPSocket::receiveMessages(Message* messages,
+                                    size_t count,
+                                    size_t& ret_count,
+                                    bool wait,
+                                    const AbortInterface* abort,
+                                    Report& report)
+{
+    ret_count = 0;
+    count = std::min(count, MAX_RECEIVE_MESSAGES);
+
+    if (messages == 0 || count == 0) {
+        return true;
+    }
+
+#if defined(TS_WINDOWS)
+
+    // No multi-message receive on Windows, use a scatter receive of one message.
+    count = 1;
+    ::WSABUF bufs[2];
+    bufs[0].buf = reinterpret_cast<char*>(messages[0].data);
+    bufs[0].len = ::ULONG(messages[0].max_size);
+    bufs[1].buf = reinterpret_cast<char*>(messages[0].overflow);
+    bufs[1].len = ::ULONG(messages[0].overflow_size);
+    const ::DWORD buf_count = messages[0].overflow != 0 && messages[0].overflow_size > 0 ? 2 : 1;
+
+    // Without wait, check if a message is already available.
+    if (!wait) {
+        ::u_long available = 0;
+        if (TS_SOCKET_IOCTL(_sock, FIONREAD, &available) != 0) {
+            report.error(u"error checking UDP socket: " + SocketErrorCodeMessage());
+            return false;
+        }
+        else if (available == 0) {
+            return true;
+        }
+    }
+
+#else
+
+    // Message headers, I/O vectors and control data for all messages.
+    ::sockaddr addr[MAX_RECEIVE_MESSAGES];
+    ::iovec iov[2 * MAX_RECEIVE_MESSAGES];
+    uint64_t control[MAX_RECEIVE_MESSAGES][TIMESTAMP_CONTROL_WORDS];
+#if defined(TS_LINUX)
+    ::mmsghdr hdr[MAX_RECEIVE_MESSAGES];
+    #define TS_MSGHDR(i) (hdr[i].msg_hdr)
+#else
+    ::msghdr hdr[1];
+    count = 1;
+    #define TS_MSGHDR(i) (hdr[i])
+#endif
+
+    TS_ZERO(hdr);
+    for (size_t i = 0; i < count; ++i) {
+        iov[2*i].iov_base = messages[i].data;
+        iov[2*i].iov_len = messages[i].max_size;
+        iov[2*i+1].iov_base = messages[i].overflow;
+        iov[2*i+1].iov_len = messages[i].overflow_size;
+        TS_MSGHDR(i).msg_name = &addr[i];
+        TS_MSGHDR(i).msg_namelen = sizeof(addr[i]);
+        TS_MSGHDR(i).msg_iov = &iov[2*i];
+        TS_MSGHDR(i).msg_iovlen = messages[i].overflow != 0 && messages[i].overflow_size > 0 ? 2 : 1;
+        TS_MSGHDR(i).msg_control = control[i];
+        TS_MSGHDR(i).msg_controllen = sizeof(control[i]);
+    }
+
+#endif
+
+    // Loop on unsollicited interrupts
+    for (;;) {
+
+#if defined(TS_WINDOWS)
+        ::sockaddr sender_sock;
+        int senderlen = sizeof(sender_sock);
+        ::DWORD insize = 0;
+        ::DWORD flags = 0;
+        const bool success = ::WSARecvFrom(_sock, bufs, buf_count, &insize, &flags, &sender_sock, &senderlen, 0, 0) == 0;
+        if (success) {
+            messages[0].size = size_t(insize);
+            messages[0].sender = SocketAddress(sender_sock);
+            messages[0].timestamp = SystemTimeStamp();
+            ret_count = 1;
+            return true;
+        }
+#else
+#if defined(TS_LINUX)
+        // Wait for the first message, then get all available ones.
+        const int received = ::recvmmsg(_sock, hdr, unsigned(count), wait ? MSG_WAITFORONE : MSG_DONTWAIT, 0);
+        const bool success = received >= 0;
+        if (success) {
+            ret_count = size_t(received);
+            for (size_t i = 0; i < ret_count; ++i) {
+                messages[i].size = size_t(hdr[i].msg_len);
+            }
+        }
+#else
+        const TS_SOCKET_SSIZE_T insize = ::recvmsg(_sock, &hdr[0], wait ? 0 : MSG_DONTWAIT);
+        const bool success = insize >= 0;
+        if (success) {
+            ret_count = 1;
+            messages[0].size = size_t(insize);
+        }
+#endif
+        if (success) {
+            const NanoSecond now = SystemTimeStamp();
+            for (size_t i = 0; i < ret_count; ++i) {
+                const NanoSecond stamp = KernelTimeStamp(TS_MSGHDR(i));
+                messages[i].sender = SocketAddress(addr[i]);
+                messages[i].timestamp = stamp != 0 ? stamp : now;
+            }
+            return true;
+        }
+#endif
+        else if (abort != 0 && abort->aborting()) {
+            // User-interrupt, end of processing but no error message
+            return false;
+        }
+#if !defined (TS_WINDOWS)
+        else if (errno == EINTR) {
+            // Got a signal, not a user interrupt, will ignore it
+            report.debug(u"signal, not user interrupt");
+        }
+        else if (!wait && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // No message available.
+            return true;
+        }
+#endif
+        else {
+            // Abort on non-interrupt errors.
+            report.error(u"error receiving from UDP socket: " + SocketErrorCodeMessage());
+            return false;
+        }
+    }
+}
+
+#undef TS_MSGHDR
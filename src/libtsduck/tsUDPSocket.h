@@ -91,6 +91,44 @@ namespace ts {
         //!
         bool setReceiveBufferSize(size_t size, Report& report = CERR);
 
+        //!
+        //! Enable or disable the kernel receive time stamps on incoming messages.
+        //!
+        //! The multi-message version of receive() returns a time stamp for each message.
+        //! When enabled, this is the time at which the message was received by the kernel.
+        //! Otherwise, this is the system time when the message is returned to the
+        //! application, which is less accurate. On Linux, the socket option SO_TIMESTAMPNS is used
+        //! (nanosecond precision). On other UNIX systems, SO_TIMESTAMP is used
+        //! (microsecond precision). Kernel time stamps are not supported on Windows.
+        //!
+        //! @param [in] on If true, enable kernel receive time stamps.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error or if unsupported.
+        //!
+        bool setReceiveTimestamps(bool on, Report& report = CERR);
+
+        //!
+        //! Enable or disable the UDP segmentation offload on outgoing messages.
+        //!
+        //! When enabled, sendMessages() passes large buffers to the kernel in one
+        //! single operation. The kernel, or the network interface when supported,
+        //! splits the buffer into individual UDP messages (Generic Segmentation
+        //! Offload, GSO). This is supported on Linux only (socket option UDP_SEGMENT,
+        //! kernel 4.18 and higher).
+        //!
+        //! @param [in] on If true, enable UDP segmentation offload.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error or if unsupported.
+        //!
+        bool setSendSegmentation(bool on, Report& report = CERR);
+
+        //!
+        //! Check if the UDP segmentation offload is enabled on outgoing messages.
+        //! @return True if the UDP segmentation offload is enabled.
+        //! @see setSendSegmentation()
+        //!
+        bool getSendSegmentation() const {return _gso;}
+
         //!
         //! Set the "reuse port" option.
         //! @param [in] reuse_port If true, the socket is allowed to reuse a local
@@ -275,6 +313,42 @@ namespace ts {
             return send(data, size, _default_destination, report);
         }
 
+        //!
+        //! Send a contiguous area as a sequence of messages of identical size.
+        //!
+        //! The area is split into messages of @a msg_size bytes. The last message
+        //! may be shorter. On Linux, several messages are sent in one single system
+        //! call (sendmmsg), or as one single buffer when the UDP segmentation offload
+        //! is enabled. On other systems, one message is sent at a time.
+        //!
+        //! @param [in] data Address of the area to send.
+        //! @param [in] size Size in bytes of the area to send.
+        //! @param [in] msg_size Size in bytes of each message.
+        //! @param [in] destination Socket address of the destination.
+        //! Both address and port are mandatory in the socket address, they cannot
+        //! be set to @link IPAddress::AnyAddress @endlink or
+        //! @link SocketAddress::AnyPort @endlink.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see setSendSegmentation()
+        //!
+        bool sendMessages(const void* data, size_t size, size_t msg_size, const SocketAddress& destination, Report& report = CERR);
+
+        //!
+        //! Send a contiguous area as a sequence of messages of identical size to the default destination address and port.
+        //!
+        //! @param [in] data Address of the area to send.
+        //! @param [in] size Size in bytes of the area to send.
+        //! @param [in] msg_size Size in bytes of each message.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see setSendSegmentation()
+        //!
+        bool sendMessages(const void* data, size_t size, size_t msg_size, Report& report = CERR)
+        {
+            return sendMessages(data, size, msg_size, _default_destination, report);
+        }
+
         //!
         //! Receive a message.
         //!
@@ -295,6 +369,82 @@ namespace ts {
                      const AbortInterface* abort = 0,
                      Report& report = CERR);
 
+        //!
+        //! Description of one message buffer in a multi-message receive() operation.
+        //!
+        //! Each message is received in a primary buffer. If the message is larger
+        //! than the primary buffer, the rest of the message is stored in an optional
+        //! overflow buffer. This is typically used to receive data directly in their
+        //! final location (the primary buffer) while still being able to receive
+        //! messages of unexpected size.
+        //!
+        struct TSDUCKDLL Message
+        {
+            void*         data;           //!< [in] Address of the primary buffer for the message.
+            size_t        max_size;       //!< [in] Size in bytes of the primary buffer.
+            void*         overflow;       //!< [in] Address of the overflow buffer, can be null.
+            size_t        overflow_size;  //!< [in] Size in bytes of the overflow buffer.
+            size_t        size;           //!< [out] Size in bytes of the received message (primary plus overflow).
+            SocketAddress sender;         //!< [out] Socket address of the sender.
+            NanoSecond    timestamp;      //!< [out] Receive time stamp in nanoseconds since @link Time::Epoch @endlink (see setReceiveTimestamps()).
+
+            //!
+            //! Default constructor.
+            //!
+            Message();
+        };
+
+        //!
+        //! Maximum number of messages in one multi-message receive() operation.
+        //!
+        static const size_t MAX_RECEIVE_MESSAGES = 64;
+
+        //!
+        //! Maximum number of messages in one system call in sendMessages().
+        //!
+        static const size_t MAX_SEND_MESSAGES = 64;
+
+        //!
+        //! Receive several messages in one operation.
+        //!
+        //! The method waits for at least one message. Then all messages which are
+        //! already available are returned, without waiting, up to @a count messages.
+        //! On Linux, this is implemented using one single system call (recvmmsg).
+        //! On other systems, one message is returned at a time.
+        //!
+        //! @param [in,out] messages Address of an array of message buffers.
+        //! @param [in] count Number of elements in @a messages. At most @link MAX_RECEIVE_MESSAGES @endlink
+        //! elements are used.
+        //! @param [out] ret_count Number of received messages, in the first elements of @a messages.
+        //! @param [in] abort If non-zero, invoked when I/O is interrupted
+        //! (in case of user-interrupt, return, otherwise retry).
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see setReceiveTimestamps()
+        //!
+        bool receive(Message* messages,
+                     size_t count,
+                     size_t& ret_count,
+                     const AbortInterface* abort = 0,
+                     Report& report = CERR);
+
+        //!
+        //! Receive the messages which are already available, without waiting.
+        //!
+        //! This is typically used to poll secondary sockets after receiving
+        //! messages on a main socket.
+        //!
+        //! @param [in,out] messages Address of an array of message buffers.
+        //! @param [in] count Number of elements in @a messages. At most @link MAX_RECEIVE_MESSAGES @endlink
+        //! elements are used.
+        //! @param [out] ret_count Number of received messages, in the first elements of @a messages.
+        //! Zero when no message is available.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see receive(Message*, size_t, size_t&, const AbortInterface*, Report&)
+        //!
+        bool receiveAvailable(Message* messages, size_t count, size_t& ret_count, Report& report = CERR);
+
         //!
         //! Get the underlying socket device handle (use with care).
         //!
@@ -341,6 +491,10 @@ namespace ts {
         TS_SOCKET_T   _sock;
         SocketAddress _default_destination;
         MReqSet       _mcast; // Current list of multicast memberships
+        bool          _gso;   // UDP segmentation offload enabled
+
+        // Common code for receive() and receiveAvailable().
+        bool receiveMessages(Message* messages, size_t count, size_t& ret_count, bool wait, const AbortInterface* abort, Report& report);
 
         // Unreachable operations
         UDPSocket(const UDPSocket&) = delete;
@@ -169,6 +169,7 @@
 #include "tsPMT.h"
 #include "tsPSILogger.h"
 #include "tsPSILoggerArgs.h"
+#include "tsPacketPacer.h"
 #include "tsPacketizer.h"
 #include "tsParentalRatingDescriptor.h"
 #include "tsPlatform.h"
@@ -177,6 +178,10 @@
 #include "tsPollFiles.h"
 #include "tsPrivateDataSpecifierDescriptor.h"
 #include "tsRST.h"
+#include "tsRTPFECDecoder.h"
+#include "tsRTPFECEncoder.h"
+#include "tsRTPReorderBuffer.h"
+#include "tsRTPReorderHandlerInterface.h"
 #include "tsRandomGenerator.h"
 #include "tsRegistry.h"
 #include "tsReport.h"
@@ -206,6 +211,7 @@
 #include "tsServiceDescriptor.h"
 #include "tsServiceListDescriptor.h"
 #include "tsSharedLibrary.h"
+#include "tsSharedMemoryRing.h"
 #include "tsShortEventDescriptor.h"
 #include "tsSimulCryptDate.h"
 #include "tsSingletonManager.h"
@@ -235,12 +241,17 @@
 #include "tsTSAnalyzerReport.h"
 #include "tsTSDT.h"
 #include "tsTSFileInput.h"
+#include "tsTSFileInputArgs.h"
 #include "tsTSFileInputBuffered.h"
 #include "tsTSFileOutput.h"
 #include "tsTSFileOutputResync.h"
+#include "tsTSFileOutputSegmented.h"
 #include "tsTSPacket.h"
+#include "tsTSPacketHandlerInterface.h"
+#include "tsTSPacketMetadata.h"
 #include "tsTSScanner.h"
 #include "tsTableHandlerInterface.h"
+#include "tsTableViews.h"
 #include "tsTables.h"
 #include "tsTablesDisplay.h"
 #include "tsTablesDisplayArgs.h"
@@ -51,6 +51,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     private:
         // This structure is used at each --interval.
@@ -326,3 +327,32 @@ ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, bool&
     _current_pkt++;
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::CountPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // Periodic and per-packet reports are processed one packet at a time.
+    if (_report_interval > 0 || _report_all) {
+        return ProcessorPlugin::processPacketBatch(pkts, mdata, count, status, flush, bitrate_changed);
+    }
+
+    // Otherwise, simply count packets.
+    for (size_t n = 0; n < count; ++n) {
+        if (mdata[n].getDropped()) {
+            status[n] = TSP_DROP;
+        }
+        else {
+            const PID pid = pkts[n].getPID();
+            if (_pids[pid] != _negate) {
+                _counters[pid]++;
+            }
+            _current_pkt++;
+            status[n] = TSP_OK;
+        }
+    }
+    return count;
+}
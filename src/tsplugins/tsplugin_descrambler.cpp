@@ -50,6 +50,7 @@ namespace ts {
         DescramblerPlugin (TSP*);
         virtual bool start() override;
         virtual Status processPacket (TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     private:
         Scrambling::EntropyMode        _cw_mode;  // CW entropy mode
@@ -58,6 +59,11 @@ namespace ts {
         Scrambling                     _key;      // Preprocessed current control word
         uint8_t                        _last_scv; // Scrambling_control_value in last packet
         PIDSet                         _pids;     // List of PID's to descramble
+        bool                           _batch_mode; // Accumulate payloads, see processPacketBatch()
+        std::vector<Scrambling::DataBlock> _batch;  // Payloads to descramble with _key
+
+        // Descramble all accumulated payloads with the current control word.
+        void decryptBatch();
 
         // Inaccessible operations
         DescramblerPlugin() = delete;
@@ -81,7 +87,9 @@ ts::DescramblerPlugin::DescramblerPlugin(TSP* tsp_) :
     _next_cw(),
     _key(),
     _last_scv(0),
-    _pids()
+    _pids(),
+    _batch_mode(false),
+    _batch()
 {
     option(u"cw",                   'c', STRING);
     option(u"cw-file",              'f', STRING);
@@ -201,7 +209,8 @@ ts::ProcessorPlugin::Status ts::DescramblerPlugin::processPacket(TSPacket& pkt,
         if (_next_cw == _cw_list.end()) {
             _next_cw = _cw_list.begin();
         }
-        // Set key for DVB-CSA
+        // Descramble pending payloads with the previous key, then set key for DVB-CSA
+        decryptBatch();
         _key.init(_next_cw->data(), _cw_mode);
         tsp->verbose(u"using control word: " + UString::Dump(*_next_cw, UString::SINGLE_LINE));
         // Point to next CW
@@ -210,11 +219,47 @@ ts::ProcessorPlugin::Status ts::DescramblerPlugin::processPacket(TSPacket& pkt,
         _last_scv = scv;
     }
 
-    // Descramble the packet payload
-    _key.decrypt (pkt.getPayload(), pkt.getPayloadSize());
+    // Descramble the packet payload. In batch mode, the payload is descrambled
+    // later, with all other payloads using the same control word.
+    if (_batch_mode) {
+        const Scrambling::DataBlock block = {pkt.getPayload(), pkt.getPayloadSize()};
+        _batch.push_back(block);
+    }
+    else {
+        _key.decrypt (pkt.getPayload(), pkt.getPayloadSize());
+    }
 
     // Reset scrambling_control_value to zero in TS header
     pkt.setScrambling(SC_CLEAR);
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::DescramblerPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // The payloads are accumulated and descrambled together, before each
+    // change of control word and at the end of the batch.
+    _batch_mode = true;
+    const size_t result = ProcessorPlugin::processPacketBatch(pkts, mdata, count, status, flush, bitrate_changed);
+    decryptBatch();
+    _batch_mode = false;
+    return result;
+}
+
+
+//----------------------------------------------------------------------------
+// Descramble all accumulated payloads with the current control word.
+//----------------------------------------------------------------------------
+
+void ts::DescramblerPlugin::decryptBatch()
+{
+    if (!_batch.empty()) {
+        _key.decrypt(&_batch[0], _batch.size());
+        _batch.clear();
+    }
+}
@@ -37,7 +37,7 @@
 #include "tsService.h"
 #include "tsTables.h"
 #include "tsTime.h"
-#include "tsMJD.h"
+#include "tsTableViews.h"
 TSDUCK_SOURCE;
 
 
@@ -204,6 +204,7 @@ bool ts::EITPlugin::start()
     _services.clear();
     _ts_id.reset();
     _demux.reset();
+    _demux.setHighThroughput(true);
     _demux.addPID(PID_PAT);
     _demux.addPID(PID_SDT);
     _demux.addPID(PID_EIT);
@@ -375,28 +376,19 @@ void ts::EITPlugin::handleTable(SectionDemux& demux, const BinaryTable& table)
 
 void ts::EITPlugin::handleSection (SectionDemux& demux, const Section& sect)
 {
-    const TID tid = sect.tableId();
-
-    // Reject non-EIT sections.
-    if (!sect.isValid() || tid < TID_EIT_MIN || tid > TID_EIT_MAX) {
-        return;
-    }
-
-    // The payload of an EIT must be at least 6 bytes long
-    const uint8_t* data = sect.payload();
-    size_t size = sect.payloadSize();
-    if (size < 6) {
+    // Reject non-EIT sections. The payload of an EIT must be at least 6 bytes long.
+    const EITView eit(sect);
+    if (!eit.isValid()) {
         return;
     }
 
     // Get service characteristics
-    ServiceDesc& serv (getServiceDesc (GetUInt16 (data), sect.tableIdExtension()));
-    serv.setONId (GetUInt16 (data + 2));
-    data += 6; size -= 6;
+    ServiceDesc& serv (getServiceDesc (eit.tsId(), eit.serviceId()));
+    serv.setONId (eit.originalNetworkId());
 
     // Get EIT type
-    const bool actual = tid == TID_EIT_PF_ACT || (tid >= TID_EIT_S_ACT_MIN && tid <= TID_EIT_S_ACT_MAX);
-    const bool pf = tid == TID_EIT_PF_ACT || tid == TID_EIT_PF_OTH;
+    const bool actual = eit.isActual();
+    const bool pf = eit.isPresentFollowing();
 
     // Check other/actual TS
     if (_ts_id.set()) {
@@ -434,14 +426,9 @@ void ts::EITPlugin::handleSection (SectionDemux& demux, const Section& sect)
 
     // Loop on all events in EIT schedule, compute time offset in the future
     if (!pf && _last_utc != Time::Epoch) {
-        while (size >= 12) {
-            Time start_time;
-            DecodeMJD(data + 2, 5, start_time);
-            serv.max_time = std::max(serv.max_time, start_time - _last_utc);
-            size_t loop_length = GetUInt16(data + 10) & 0x0FFF;
-            data += 12; size -= 12;
-            loop_length = std::min(loop_length, size);
-            data += loop_length; size -= loop_length;
+        const EITView::EventLoop events(eit.events());
+        for (EITView::EventLoop::const_iterator it = events.begin(); it != events.end(); ++it) {
+            serv.max_time = std::max(serv.max_time, it->startTime() - _last_utc);
         }
     }
 }
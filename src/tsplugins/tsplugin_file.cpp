@@ -34,6 +34,7 @@
 
 #include "tsPlugin.h"
 #include "tsTSFileOutput.h"
+#include "tsTSFileOutputSegmented.h"
 #include "tsTSFileInput.h"
 TSDUCK_SOURCE;
 
@@ -72,7 +73,9 @@ namespace ts {
         virtual bool stop() override;
         virtual bool send(const TSPacket*, size_t) override;
     private:
-        TSFileOutput _file;
+        bool                  _segmented;  // Split output file into segments.
+        TSFileOutput          _file;       // Non-segmented output file.
+        TSFileOutputSegmented _segments;   // Segmented output file.
 
         // Inaccessible operations
         FileOutput() = delete;
@@ -116,7 +119,9 @@ ts::FileInput::FileInput(TSP* tsp_) :
     option(u"",               0,  STRING, 0, 1);
     option(u"byte-offset",   'b', UNSIGNED);
     option(u"infinite",      'i');
+    option(u"mmap",           0);
     option(u"packet-offset", 'p', UNSIGNED);
+    option(u"read-ahead",     0);
     option(u"repeat",        'r', POSITIVE);
 
     setHelp(u"File-name:\n"
@@ -137,11 +142,20 @@ ts::FileInput::FileInput(TSP* tsp_) :
             u"      Repeat the playout of the file infinitely (default: only once).\n"
             u"      This option is allowed only if the input file is a regular file.\n"
             u"\n"
+            u"  --mmap\n"
+            u"      Map the input file in memory instead of reading it with system calls.\n"
+            u"      This option is ignored if the input file is not a regular file. The\n"
+            u"      file shall not be truncated while it is read.\n"
+            u"\n"
             u"  -p value\n"
             u"  --packet-offset value\n"
             u"      Start reading the file at the specified TS packet (default: 0).\n"
             u"      This option is allowed only if the input file is a regular file.\n"
             u"\n"
+            u"  --read-ahead\n"
+            u"      Read the input file in a background thread, ahead of the packet\n"
+            u"      processing. Useful when the input file is on a slow device.\n"
+            u"\n"
             u"  -r count\n"
             u"  --repeat count\n"
             u"      Repeat the playout of the file the specified number of times\n"
@@ -159,11 +173,26 @@ ts::FileInput::FileInput(TSP* tsp_) :
 
 ts::FileOutput::FileOutput(TSP* tsp_) :
     OutputPlugin(tsp_, u"Write packets to a file.", u"[options] [file-name]"),
-    _file()
+    _segmented(false),
+    _file(),
+    _segments()
 {
-    option(u"",        0,  STRING, 0, 1);
-    option(u"append", 'a');
-    option(u"keep",   'k');
+    option(u"",              0,  STRING, 0, 1);
+    option(u"append",       'a');
+    option(u"asynchronous",  0);
+    option(u"async-buffers", 0,  POSITIVE);
+    option(u"direct-io",     0);
+    option(u"keep",         'k');
+    option(u"max-duration",  0,  POSITIVE);
+    option(u"max-files",     0,  POSITIVE);
+    option(u"max-size",      0,  POSITIVE);
+    option(u"pcr-duration",  0);
+    option(u"preallocate",   0,  POSITIVE);
+    option(u"split-at",      0,  Enumeration({
+        {u"pat",      TSFileOutputSegmented::SPLIT_AT_PAT},
+        {u"keyframe", TSFileOutputSegmented::SPLIT_AT_KEYFRAME},
+    }));
+    option(u"sync-interval", 0,  POSITIVE);
 
     setHelp(u"File-name:\n"
             u"  Name of the created output file. Use standard output by default.\n"
@@ -175,6 +204,20 @@ ts::FileOutput::FileOutput(TSP* tsp_) :
             u"      If the file already exists, append to the end of the file.\n"
             u"      By default, existing files are overwritten.\n"
             u"\n"
+            u"  --asynchronous\n"
+            u"      Write the file from a background thread. The packets are buffered\n"
+            u"      in memory and a slow disk does not block the packet processing, as\n"
+            u"      long as the buffers are not full.\n"
+            u"\n"
+            u"  --async-buffers count\n"
+            u"      Number of buffers of 4096 packets in asynchronous mode.\n"
+            u"      Implies --asynchronous. The default is 16 buffers (12 MB).\n"
+            u"\n"
+            u"  --direct-io\n"
+            u"      Write the file using direct I/O, bypassing the system cache (Linux\n"
+            u"      only). Implies --asynchronous. Ignored if the file system does not\n"
+            u"      support direct I/O.\n"
+            u"\n"
             u"  --help\n"
             u"      Display this help text.\n"
             u"\n"
@@ -183,8 +226,52 @@ ts::FileOutput::FileOutput(TSP* tsp_) :
             u"      Keep existing file (abort if the specified file already exists).\n"
             u"      By default, existing files are overwritten.\n"
             u"\n"
+            u"  --max-duration seconds\n"
+            u"      Split the output into segments of the specified maximum duration.\n"
+            u"      See the segmentation section below.\n"
+            u"\n"
+            u"  --max-files count\n"
+            u"      With segmentation, maximum number of segment files to keep, including\n"
+            u"      the one which is currently written. The oldest segments are deleted.\n"
+            u"      By default, all segments are kept.\n"
+            u"\n"
+            u"  --max-size bytes\n"
+            u"      Split the output into segments of the specified maximum size.\n"
+            u"      See the segmentation section below.\n"
+            u"\n"
+            u"  --pcr-duration\n"
+            u"      With --max-duration, compute the duration of segments using the PCR's\n"
+            u"      of the first PCR PID in the stream. By default, use the system clock.\n"
+            u"\n"
+            u"  --preallocate bytes\n"
+            u"      Reserve disk space by chunks of the specified size ahead of the\n"
+            u"      written data (Linux only). This reduces the file fragmentation.\n"
+            u"\n"
+            u"  --sync-interval milliseconds\n"
+            u"      Periodically synchronize the written data on disk. This avoids the\n"
+            u"      accumulation of unwritten data in the system cache and long stalls\n"
+            u"      when the system flushes it.\n"
+            u"\n"
+            u"  --split-at pat|keyframe\n"
+            u"      With segmentation, when the maximum size or duration of a segment is\n"
+            u"      reached, delay the split until the next PAT or the next random access\n"
+            u"      point (a unit start with the random access indicator) of the video PID.\n"
+            u"      The video PID is the first video stream of the first service with video\n"
+            u"      in the PMT's. If no split point is found before the segment reaches twice\n"
+            u"      its maximum size or duration, the segment is split anyway. By default,\n"
+            u"      split on any packet.\n"
+            u"\n"
             u"  --version\n"
-            u"      Display the version number.\n");
+            u"      Display the version number.\n"
+            u"\n"
+            u"Segmentation:\n"
+            u"\n"
+            u"  With --max-size or --max-duration, the output is split into segment files.\n"
+            u"  The segment index is inserted before the extension of the file name, for\n"
+            u"  instance capture-000000.ts, capture-000001.ts, etc. The segment which is\n"
+            u"  currently written has an additional suffix \".part\". The next segment is\n"
+            u"  opened in advance. Completed segments are closed and renamed in the\n"
+            u"  background without blocking the packet flow.\n");
 }
 
 
@@ -229,6 +316,11 @@ ts::FileProcessor::FileProcessor(TSP* tsp_) :
 
 bool ts::FileInput::start()
 {
+    if (present(u"mmap") && present(u"read-ahead")) {
+        tsp->error(u"--mmap and --read-ahead are mutually exclusive");
+        return false;
+    }
+    _file.setReadMode(present(u"mmap") ? TSFileInput::READ_MMAP : (present(u"read-ahead") ? TSFileInput::READ_AHEAD : TSFileInput::READ_PLAIN));
     return _file.open (value(u""),
                        present(u"infinite") ? 0 : intValue<size_t>(u"repeat", 1),
                        intValue<uint64_t>(u"byte-offset", intValue<uint64_t>(u"packet-offset", 0) * PKT_SIZE),
@@ -252,17 +344,39 @@ size_t ts::FileInput::receive (TSPacket* buffer, size_t max_packets)
 
 bool ts::FileOutput::start()
 {
-    return _file.open (value(u""), present(u"append"), present(u"keep"), *tsp);
+    _segmented = present(u"max-size") || present(u"max-duration");
+    if (_segmented && (present(u"append") || present(u"keep"))) {
+        tsp->error(u"--append and --keep are not allowed with segmentation");
+        return false;
+    }
+
+    // With segmentation, the options are applied to all segment files.
+    TSFileOutput& file(_segmented ? _segments.fileTemplate() : _file);
+    file.setAsynchronous(intValue<size_t>(u"async-buffers", present(u"asynchronous") ? TSFileOutput::DEFAULT_ASYNC_BUFFERS : 0));
+    file.setDirectIO(present(u"direct-io"));
+    file.setPreallocation(intValue<uint64_t>(u"preallocate", 0));
+    file.setSyncInterval(intValue<MilliSecond>(u"sync-interval", 0));
+
+    if (_segmented) {
+        _segments.setMaxSize(intValue<uint64_t>(u"max-size", 0));
+        _segments.setMaxDuration(intValue<MilliSecond>(u"max-duration", 0) * MilliSecPerSec, present(u"pcr-duration"));
+        _segments.setSplitPoint(enumValue<TSFileOutputSegmented::SplitPoint>(u"split-at", TSFileOutputSegmented::SPLIT_ANYWHERE));
+        _segments.setMaxFiles(intValue<size_t>(u"max-files", 0));
+        return _segments.open(value(u""), *tsp);
+    }
+    else {
+        return _file.open (value(u""), present(u"append"), present(u"keep"), *tsp);
+    }
 }
 
 bool ts::FileOutput::stop()
 {
-    return _file.close (*tsp);
+    return _segmented ? _segments.close(*tsp) : _file.close (*tsp);
 }
 
 bool ts::FileOutput::send (const TSPacket* buffer, size_t packet_count)
 {
-    return _file.write (buffer, packet_count, *tsp);
+    return _segmented ? _segments.write(buffer, packet_count, *tsp) : _file.write (buffer, packet_count, *tsp);
 }
 
 
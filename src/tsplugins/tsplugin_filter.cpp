@@ -48,6 +48,7 @@ namespace ts {
         FilterPlugin (TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     private:
         int    scrambling_ctrl;  // Scrambling control value (<0: no filter)
@@ -64,6 +65,11 @@ namespace ts {
         int    min_af;           // Minimum adaptation field size (<0: no filter)
         int    max_af;           // Maximum adaptation field size (<0: no filter)
         PIDSet pid;              // PID values to filter
+        bool   pid_only;         // Only PID values are filtered
+        Status excluded;         // Status of excluded packets
+
+        // Check if a packet matches one of the selected criteria.
+        bool isSelected(const TSPacket&) const;
 
         // Inaccessible operations
         FilterPlugin() = delete;
@@ -95,7 +101,9 @@ ts::FilterPlugin::FilterPlugin(TSP* tsp_) :
     max_payload(0),
     min_af(0),
     max_af(0),
-    pid()
+    pid(),
+    pid_only(false),
+    excluded(TSP_DROP)
 {
     option(u"adaptation-field",          0);
     option(u"clear",                    'c');
@@ -203,20 +211,22 @@ bool ts::FilterPlugin::start()
     max_af = intValue<int>(u"max-adaptation-field-size", -1);
     getPIDSet(pid, u"pid");
 
+    // When only PID's are filtered, a simple lookup is enough on each packet.
+    pid_only = scrambling_ctrl < 0 && !with_payload && !with_af && !with_pes && !has_pcr && !unit_start &&
+        !valid && min_payload < 0 && max_payload < 0 && min_af < 0 && max_af < 0;
+    excluded = stuffing ? TSP_NULL : TSP_DROP;
+
     return true;
 }
 
 
 //----------------------------------------------------------------------------
-// Packet processing method
+// Check if a packet matches one of the selected criteria.
 //----------------------------------------------------------------------------
 
-ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket (TSPacket& pkt, bool& flush, bool& bitrate_changed)
+bool ts::FilterPlugin::isSelected(const TSPacket& pkt) const
 {
-
-    // Check if the packet matches one of the selected criteria.
-
-    bool ok = pid[pkt.getPID()] ||
+    return pid[pkt.getPID()] ||
         (with_payload && pkt.hasPayload()) ||
         (with_af && pkt.hasAF()) ||
         (unit_start && pkt.getPUSI()) ||
@@ -243,18 +253,45 @@ ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket (TSPacket& pkt, bool
 
         (with_pes && pkt.hasValidSync() && !pkt.getTEI() && pkt.getPayloadSize() >= 3 &&
          (GetUInt32 (pkt.b + pkt.getHeaderSize() - 1) & 0x00FFFFFF) == 0x000001);
+}
 
-    if (negate) {
-        ok = !ok;
-    }
 
-    if (ok) {
-        return TSP_OK;
-    }
-    else if (stuffing) {
-        return TSP_NULL;
+//----------------------------------------------------------------------------
+// Packet processing method
+//----------------------------------------------------------------------------
+
+ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed)
+{
+    return isSelected(pkt) != negate ? TSP_OK : excluded;
+}
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::FilterPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    if (pid_only) {
+        // Fast path: only a lookup in the PID set.
+        for (size_t n = 0; n < count; ++n) {
+            if (mdata[n].getDropped()) {
+                status[n] = TSP_DROP;
+            }
+            else {
+                status[n] = pid[pkts[n].getPID()] != negate ? TSP_OK : excluded;
+            }
+        }
     }
     else {
-        return TSP_DROP;
+        for (size_t n = 0; n < count; ++n) {
+            if (mdata[n].getDropped()) {
+                status[n] = TSP_DROP;
+            }
+            else {
+                status[n] = isSelected(pkts[n]) != negate ? TSP_OK : excluded;
+            }
+        }
     }
+    return count;
 }
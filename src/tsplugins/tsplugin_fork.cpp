@@ -34,8 +34,11 @@
 
 #include "tsPlugin.h"
 #include "tsForkPipe.h"
+#include "tsSharedMemoryRing.h"
 TSDUCK_SOURCE;
 
+#define DEFAULT_RING_BATCH 128  // packets published at a time in a shared memory ring
+
 
 //----------------------------------------------------------------------------
 // Plugin definition
@@ -57,6 +60,15 @@ namespace ts {
         size_t    _buffer_size;   // Max number of packets in buffer
         size_t    _buffer_count;  // Number of packets currently in buffer
         TSPacket* _buffer;        // Packet buffer
+        bool      _use_ring;      // Use a shared memory ring instead of the pipe
+        bool      _ring_broken;   // The reader of the ring is gone, ignore subsequent packets
+        SharedMemoryRing _ring;   // Shared memory ring to the child process
+        TSPacket* _area;          // Current write area in the ring
+        size_t    _area_size;     // Number of packets in current write area
+        size_t    _area_count;    // Number of packets written in current write area
+
+        // Publish the packets in the current write area of the ring.
+        void commitArea();
 
         // Inaccessible operations
         ForkPlugin() = delete;
@@ -78,12 +90,20 @@ ts::ForkPlugin::ForkPlugin(TSP* tsp_) :
     _pipe(),
     _buffer_size(0),
     _buffer_count(0),
-    _buffer(0)
+    _buffer(0),
+    _use_ring(false),
+    _ring_broken(false),
+    _ring(),
+    _area(0),
+    _area_size(0),
+    _area_count(0)
 {
     option(u"",                  0,  STRING, 1, 1);
     option(u"buffered-packets", 'b', POSITIVE);
     option(u"ignore-abort",     'i');
     option(u"nowait",           'n');
+    option(u"ring-packets",      0,  POSITIVE);
+    option(u"shared-memory",    's');
 
     setHelp(u"Command:\n"
             u"  Specifies the command line to execute in the created process.\n"
@@ -94,7 +114,9 @@ ts::ForkPlugin::ForkPlugin(TSP* tsp_) :
             u"  --buffered-packets value\n"
             u"      Specifies the number of TS packets to buffer before sending them\n"
             u"      through the pipe to the forked process. By default, the packets are\n"
-            u"      not buffered and sent one by one.\n"
+            u"      not buffered and sent one by one. With --shared-memory, this is the\n"
+            u"      number of packets which are published at a time in the ring. The\n"
+            u"      default is " TS_USTRINGIFY(DEFAULT_RING_BATCH) u" packets in that case.\n"
             u"\n"
             u"  --help\n"
             u"      Display this help text.\n"
@@ -108,6 +130,20 @@ ts::ForkPlugin::ForkPlugin(TSP* tsp_) :
             u"  --nowait\n"
             u"      Do not wait for child process termination at end of input.\n"
             u"\n"
+            u"  --ring-packets value\n"
+            u"      With --shared-memory, specify the number of packets in the shared memory\n"
+            u"      ring. The default is 32,768 packets (approximately 6 MB).\n"
+            u"\n"
+            u"  -s\n"
+            u"  --shared-memory\n"
+            u"      Pass the packets to the created process through a ring in shared memory\n"
+            u"      instead of its standard input. The packets are directly written into\n"
+            u"      the shared memory, without copy through a pipe. The created process is\n"
+            u"      typically another tsp using the input plugin \"shm\", for instance:\n"
+            u"        tsp ... -P fork -s 'tsp -I shm -P ... -O ...' ...\n"
+            u"      The name of the ring is passed to the created process in the environment\n"
+            u"      variable TSDUCK_SHM_RING. Not available on Windows.\n"
+            u"\n"
             u"  --version\n"
             u"      Display the version number.\n");
 }
@@ -136,8 +172,31 @@ bool ts::ForkPlugin::start()
     UString command(value());
     bool synchronous = !present(u"nowait");
     _buffer_size = intValue<size_t>(u"buffered-packets", 0);
+    _use_ring = present(u"shared-memory");
+    _ring_broken = false;
     _pipe.setIgnoreAbort(present(u"ignore-abort"));
 
+    // With a shared memory ring, the packets are not buffered locally and the
+    // child process gets the name of the ring in its environment.
+    if (_use_ring) {
+        _area = 0;
+        _area_size = _area_count = 0;
+        if (_buffer_size == 0) {
+            _buffer_size = DEFAULT_RING_BATCH;
+        }
+        if (!_ring.create(UString(), intValue<size_t>(u"ring-packets", SharedMemoryRing::DEFAULT_PACKET_COUNT), *tsp)) {
+            return false;
+        }
+        Environment env;
+        env[SharedMemoryRing::ENV_NAME] = _ring.name();
+        _pipe.setEnvironment(env);
+        if (!_pipe.open(command, synchronous, 0, *tsp)) {
+            _ring.close(*tsp);
+            return false;
+        }
+        return true;
+    }
+
     // If packet buffering is requested, allocate the buffer
     _buffer = 0;
     _buffer_count = 0;
@@ -157,6 +216,14 @@ bool ts::ForkPlugin::start()
 
 bool ts::ForkPlugin::stop()
 {
+    // With a shared memory ring, publish the last packets and signal the end of
+    // stream to the child process before waiting for its termination.
+    if (_use_ring) {
+        commitArea();
+        _ring.close(*tsp);
+        return _pipe.close(*tsp);
+    }
+
     // Flush buffered packets
     if (_buffer_count > 0) {
         _pipe.write(_buffer, PKT_SIZE * _buffer_count, *tsp);
@@ -179,6 +246,31 @@ bool ts::ForkPlugin::stop()
 
 ts::ProcessorPlugin::Status ts::ForkPlugin::processPacket (TSPacket& pkt, bool& flush, bool& bitrate_changed)
 {
+    // With a shared memory ring, write the packet directly in the ring.
+    if (_use_ring) {
+        if (_ring_broken) {
+            return TSP_OK;
+        }
+        if (_area_count >= _area_size) {
+            commitArea();
+            _area_size = std::min(_ring.getWriteArea(_area, *tsp), _buffer_size);
+            if (_area_size == 0) {
+                // The child process no longer reads packets.
+                _ring_broken = true;
+                if (!_pipe.getIgnoreAbort()) {
+                    return TSP_END;
+                }
+                tsp->verbose(u"shared memory ring closed, stopping transmission to forked process");
+                return TSP_OK;
+            }
+        }
+        _area[_area_count++] = pkt;
+        if (_area_count == _area_size) {
+            commitArea();
+        }
+        return TSP_OK;
+    }
+
     // If packets are sent one by one, just send it
     if (_buffer_size == 0) {
         return _pipe.write (&pkt, PKT_SIZE, *tsp) ? TSP_OK : TSP_END;
@@ -196,3 +288,17 @@ ts::ProcessorPlugin::Status ts::ForkPlugin::processPacket (TSPacket& pkt, bool&
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Publish the packets in the current write area of the ring.
+//----------------------------------------------------------------------------
+
+void ts::ForkPlugin::commitArea()
+{
+    if (_area_count > 0) {
+        _ring.commitWrite(_area_count);
+    }
+    _area = 0;
+    _area_size = _area_count = 0;
+}
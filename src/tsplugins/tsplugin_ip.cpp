@@ -35,6 +35,14 @@
 #include "tsPlugin.h"
 #include "tsIPUtils.h"
 #include "tsUDPSocket.h"
+#include "tsRTPFECEncoder.h"
+#include "tsRTPFECDecoder.h"
+#include "tsRTPReorderBuffer.h"
+#include "tsSystemRandomGenerator.h"
+#include "tsMonotonic.h"
+#include "tsPacketPacer.h"
+#include "tsByteBlock.h"
+#include "tsNullReport.h"
 #include "tsSysUtils.h"
 #include "tsTime.h"
 TSDUCK_SOURCE;
@@ -44,6 +52,19 @@ TSDUCK_SOURCE;
 #define DEF_PACKET_BURST     7  // 1316 B, fits (with headers) in Ethernet MTU
 #define MAX_PACKET_BURST   128  // ~ 48 kB
 #define MAX_IP_SIZE      65536
+#define MAX_IP_PACKETS     ((MAX_IP_SIZE + ts::PKT_SIZE - 1) / ts::PKT_SIZE)
+
+// Number of UDP messages per receive operation
+
+#define DEF_RECEIVE_DEPTH   16
+
+// FEC input: number of FEC packets per receive operation on each FEC flow.
+
+#define FEC_RECEIVE_DEPTH   16
+
+// FEC output: default number of rows in the FEC matrix.
+
+#define DEF_FEC_ROWS        FEC_MIN_ROWS
 
 
 //----------------------------------------------------------------------------
@@ -53,7 +74,7 @@ TSDUCK_SOURCE;
 namespace ts {
 
     // Input plugin
-    class IPInput: public InputPlugin
+    class IPInput: public InputPlugin, private RTPReorderHandlerInterface
     {
     public:
         // Implementation of plugin API
@@ -65,19 +86,71 @@ namespace ts {
         virtual size_t receive(TSPacket*, size_t) override;
 
     private:
+        typedef std::vector<UDPSocket::Message> MessageVector;
+
+        // Area in the tsp buffer where the received TS packets are stored.
+        struct OutputArea {
+            uint8_t* base;   // Base of tsp buffer
+            size_t   count;  // Number of TS packets already stored
+            size_t   limit;  // Maximum number of TS packets, do not overwrite the next messages
+        };
+
         UDPSocket     _sock;               // Incoming socket
+        bool          _fec;                // Receive FEC flows and recover lost packets
+        UDPSocket     _fec_col_sock;       // Incoming socket for column FEC
+        UDPSocket     _fec_row_sock;       // Incoming socket for row FEC
+        RTPFECDecoder _fec_decoder;        // FEC decoder
+        MessageVector _fec_msgs;           // Message buffers for FEC packets
+        ByteBlock     _fec_buf;            // Buffer for FEC packets
+        uint8_t       _fec_pt;             // RTP payload type of the last media packet
         MilliSecond   _eval_time;          // Bitrate evaluation interval in milli-seconds
         MilliSecond   _display_time;       // Bitrate display interval in milli-seconds
-        Time          _next_display;       // Next bitrate display time
-        Time          _start;              // UTC date of first received packet
+        NanoSecond    _next_display;       // Next bitrate display time
+        NanoSecond    _start;              // Receive time of first received packet
         PacketCounter _packets;            // Number of received packets since _start
-        Time          _start_0;            // Start of previous bitrate evaluation period
+        NanoSecond    _start_0;            // Start of previous bitrate evaluation period
         PacketCounter _packets_0;          // Number of received packets since _start_0
-        Time          _start_1;            // Start of previous bitrate evaluation period
+        NanoSecond    _start_1;            // Start of previous bitrate evaluation period
         PacketCounter _packets_1;          // Number of received packets since _start_1
+        NanoSecond    _last_time;          // Receive time of last received packet
+        size_t        _slot_pkts;          // Size in TS packets of a message slot in the tsp buffer
+        MessageVector _msgs;               // Message buffers for one receive operation
+        ByteBlock     _overflow;           // Overflow buffers for messages larger than their slot
+        ByteBlock     _msgbuf;             // Work buffer to rebuild a message from its slot and overflow
+        ByteBlock     _inbuf;              // Received TS packets which did not fit in the tsp buffer
         size_t        _inbuf_count;        // Remaining TS packets in inbuf
         size_t        _inbuf_next;         // Index in inbuf of next TS packet to return
-        uint8_t       _inbuf[MAX_IP_SIZE]; // Input buffer
+        RTPReorderBuffer _rtp;             // RTP reordering and loss detection
+        OutputArea*   _rtp_out;            // Output area during RTPReorderBuffer::add()
+        const uint8_t* _rtp_data;          // TS packets of the RTP message in RTPReorderBuffer::add()
+        size_t        _rtp_limit;          // Output limit of the RTP message in RTPReorderBuffer::add()
+
+        // Open and initialize a UDP socket.
+        bool openSocket(UDPSocket& sock, uint16_t port, const SocketAddress& dest_addr, const IPAddress& local_ip, size_t bufsize, bool reuse_port);
+
+        // Receive the available FEC packets on one FEC socket.
+        bool receiveFEC(UDPSocket& sock);
+
+        // Process the media packets which were recovered by FEC.
+        void deliverRecovered(OutputArea& out, size_t& pkt_received);
+
+        // Locate the TS packets inside a UDP message.
+        static bool LocatePackets(const uint8_t* msg, size_t size, size_t& offset, size_t& count);
+
+        // Locate the TS packets inside an RTP message. Return false if this is not an RTP message.
+        static bool LocateRTPPackets(const uint8_t* msg, size_t size, size_t& offset, size_t& count, uint16_t& seq, uint32_t& ssrc);
+
+        // Store TS packets in the tsp buffer or, when full, in the input buffer.
+        void deliver(OutputArea& out, const uint8_t* data, size_t count);
+
+        // Process the TS packets of an RTP message, reorder according to the sequence number.
+        void receiveRTP(OutputArea& out, const uint8_t* data, size_t count, uint16_t seq, uint32_t ssrc);
+
+        // Implementation of RTPReorderHandlerInterface.
+        virtual void handleRTPPayload(RTPReorderBuffer& buffer, uint16_t seq, const uint8_t* payload, size_t size) override;
+
+        // Update bitrate evaluation after receiving packets.
+        void updateBitrate(size_t count);
 
         // Inaccessible operations
         IPInput() = delete;
@@ -97,8 +170,41 @@ namespace ts {
         virtual bool send(const TSPacket*, size_t) override;
 
     private:
-        UDPSocket _sock;        // Outgoing socket
-        size_t    _pkt_burst;   // Number of TS packets per UDP message
+        UDPSocket  _sock;          // Outgoing socket
+        size_t     _pkt_burst;     // Number of TS packets per UDP message
+        bool       _pacing;        // Space UDP messages according to the bitrate
+        BitRate    _pace_bitrate;  // User-specified pacing bitrate (zero means tsp bitrate)
+        BitRate    _cur_bitrate;   // Current pacing bitrate
+        PacketPacer _pacer;        // Pacing of UDP messages
+        bool       _rtp;           // Use RTP encapsulation
+        uint8_t    _rtp_pt;        // RTP payload type
+        uint16_t   _rtp_seq;       // Next RTP sequence number
+        uint32_t   _rtp_ssrc;      // RTP synchronization source
+        PID        _pcr_pid;       // PID carrying the PCR's for RTP time stamps, PID_NULL means first one
+        bool       _pcr_valid;     // A PCR was found
+        uint64_t   _last_pcr;      // Last PCR value
+        PacketCounter _last_pcr_index; // Index of the TS packet containing the last PCR
+        uint64_t   _pcr_per_pkt;   // PCR units per 1000 TS packets, between the last two PCR's (zero if unknown)
+        PacketCounter _pkt_index;  // Index of the next TS packet to send
+        Monotonic  _rtp_origin;    // System time origin of RTP time stamps before the first PCR
+        uint32_t   _rtp_offset;    // Added to the PCR-based RTP time stamps to continue the system time ones
+        ByteBlock  _rtp_buf;       // Work buffer for RTP messages
+        RTPFECEncoder _fec;        // FEC encoder
+        SocketAddress _fec_col_dest; // Destination of column FEC packets
+        SocketAddress _fec_row_dest; // Destination of row FEC packets
+        ByteBlock  _fec_pkt;       // Work buffer for FEC packets
+
+        // Send UDP messages with pacing.
+        bool sendPaced(const TSPacket*, size_t);
+
+        // Send TS packets in UDP messages, without pacing.
+        bool sendPackets(const TSPacket*, size_t);
+
+        // Compute the RTP time stamp of the next TS packet to send.
+        uint32_t rtpTimeStamp();
+
+        // RTP time stamp from the system clock, before the first PCR.
+        uint32_t clockTimeStamp() const;
 
         // Inaccessible operations
         IPOutput() = delete;
@@ -119,24 +225,43 @@ TSPLUGIN_DECLARE_OUTPUT(ts::IPOutput)
 ts::IPInput::IPInput(TSP* tsp_) :
     InputPlugin(tsp_, u"Receive TS packets from UDP/IP, multicast or unicast.", u"[options] [address:]port"),
     _sock(false, *tsp_),
+    _fec(false),
+    _fec_col_sock(false, *tsp_),
+    _fec_row_sock(false, *tsp_),
+    _fec_decoder(),
+    _fec_msgs(),
+    _fec_buf(),
+    _fec_pt(0),
     _eval_time(0),
     _display_time(0),
-    _next_display(Time::Epoch),
-    _start(Time::Epoch),
+    _next_display(0),
+    _start(0),
     _packets(0),
-    _start_0(Time::Epoch),
+    _start_0(0),
     _packets_0(0),
-    _start_1(Time::Epoch),
+    _start_1(0),
     _packets_1(0),
+    _last_time(0),
+    _slot_pkts(DEF_PACKET_BURST),
+    _msgs(),
+    _overflow(),
+    _msgbuf(),
+    _inbuf(),
     _inbuf_count(0),
     _inbuf_next(0),
-    _inbuf()
+    _rtp(this),
+    _rtp_out(0),
+    _rtp_data(0),
+    _rtp_limit(0)
 {
     option(u"",                     0,  STRING, 1, 1);
     option(u"buffer-size",         'b', UNSIGNED);
     option(u"display-interval",    'd', POSITIVE);
     option(u"evaluation-interval", 'e', POSITIVE);
+    option(u"fec",                  0);
     option(u"local-address",       'l', STRING);
+    option(u"receive-depth",        0,  INTEGER, 0, 1, 1, UDPSocket::MAX_RECEIVE_MESSAGES);
+    option(u"reorder-depth",        0,  INTEGER, 0, 1, 0, RTPReorderBuffer::MAX_DEPTH);
     option(u"reuse-port",          'r');
 
     setHelp(u"Parameter:\n"
@@ -146,6 +271,11 @@ ts::IPInput::IPInput(TSP* tsp_) :
             u"  to listen on. It can be also a host name that translates to a multicast\n"
             u"  address.\n"
             u"\n"
+            u"  The UDP packets may contain TS packets only or TS packets encapsulated in\n"
+            u"  RTP (RFC 2250, SMPTE 2022-2). RTP encapsulation is automatically detected.\n"
+            u"  The sequence numbers of RTP packets are checked for lost, duplicated or\n"
+            u"  reordered packets.\n"
+            u"\n"
             u"Options:\n"
             u"\n"
             u"  -b value\n"
@@ -163,7 +293,15 @@ ts::IPInput::IPInput(TSP* tsp_) :
             u"      Specify that the real-time input bitrate shall be evaluated on a regular\n"
             u"      basis. The value specifies the number of seconds between two evaluations.\n"
             u"      By default, the real-time input bitrate is never evaluated and the input\n"
-            u"      bitrate is evaluated from the PCR in the input packets.\n"
+            u"      bitrate is evaluated from the PCR in the input packets. When possible,\n"
+            u"      the evaluation uses the kernel receive time of the UDP packets.\n"
+            u"\n"
+            u"  --fec\n"
+            u"      With RTP encapsulation, recover lost UDP packets using SMPTE 2022-1 FEC.\n"
+            u"      The column FEC packets are received on the UDP port plus " + UString::Decimal(FEC_COLUMN_PORT_OFFSET) + u" and the\n"
+            u"      optional row FEC packets on the UDP port plus " + UString::Decimal(FEC_ROW_PORT_OFFSET) + u". Unless specified\n"
+            u"      otherwise, --reorder-depth is set to its maximum value to wait for the FEC\n"
+            u"      packets when a UDP packet is lost.\n"
             u"\n"
             u"  --help\n"
             u"      Display this help text.\n"
@@ -174,6 +312,20 @@ ts::IPInput::IPInput(TSP* tsp_) :
             u"      It can be also a host name that translates to a local address.\n"
             u"      By default, listen on all local interfaces.\n"
             u"\n"
+            u"  --receive-depth value\n"
+            u"      Specify the maximum number of UDP packets to receive in one system call,\n"
+            u"      when supported by the operating system. UDP packets are received directly\n"
+            u"      in the tsp buffer. The default is " TS_STRINGIFY(DEF_RECEIVE_DEPTH) u", the maximum is " + UString::Decimal(UDPSocket::MAX_RECEIVE_MESSAGES) + u".\n"
+            u"\n"
+            u"  --reorder-depth value\n"
+            u"      With RTP encapsulation, restore the order of the UDP packets according\n"
+            u"      to the RTP sequence numbers. The value specifies how many UDP packets\n"
+            u"      can be held while waiting for a missing one. When this number is reached,\n"
+            u"      the missing UDP packet is declared lost. A larger value accepts more\n"
+            u"      disorder but adds latency when packets are really lost. The default is\n"
+            u"      zero: the UDP packets are passed in reception order, the anomalies are\n"
+            u"      only counted. The maximum is " + UString::Decimal(RTPReorderBuffer::MAX_DEPTH) + u".\n"
+            u"\n"
             u"  -r\n"
             u"  --reuse-port\n"
             u"      Set the reuse port socket option.\n"
@@ -190,12 +342,44 @@ ts::IPInput::IPInput(TSP* tsp_) :
 ts::IPOutput::IPOutput(TSP* tsp_) :
     OutputPlugin(tsp_, u"Send TS packets using UDP/IP, multicast or unicast.", u"[options] address:port"),
     _sock(false, *tsp_),
-    _pkt_burst(DEF_PACKET_BURST)
+    _pkt_burst(DEF_PACKET_BURST),
+    _pacing(false),
+    _pace_bitrate(0),
+    _cur_bitrate(0),
+    _pacer(),
+    _rtp(false),
+    _rtp_pt(RTP_PT_MP2T),
+    _rtp_seq(0),
+    _rtp_ssrc(0),
+    _pcr_pid(PID_NULL),
+    _pcr_valid(false),
+    _last_pcr(0),
+    _last_pcr_index(0),
+    _pcr_per_pkt(0),
+    _pkt_index(0),
+    _rtp_origin(),
+    _rtp_offset(0),
+    _rtp_buf(),
+    _fec(),
+    _fec_col_dest(),
+    _fec_row_dest(),
+    _fec_pkt()
 {
-    option(u"",               0,  STRING, 1, 1);
-    option(u"local-address", 'l', STRING);
-    option(u"packet-burst",  'p', INTEGER, 0, 1, 1, MAX_PACKET_BURST);
-    option(u"ttl",           't', POSITIVE);
+    option(u"",                      0,  STRING, 1, 1);
+    option(u"bitrate",              'b', POSITIVE);
+    option(u"fec-2d",                0);
+    option(u"fec-columns",           0,  INTEGER, 0, 1, 1, FEC_MAX_COLUMNS);
+    option(u"fec-rows",              0,  INTEGER, 0, 1, FEC_MIN_ROWS, FEC_MAX_ROWS);
+    option(u"local-address",        'l', STRING);
+    option(u"packet-burst",         'p', INTEGER, 0, 1, 1, MAX_PACKET_BURST);
+    option(u"pacing",                0);
+    option(u"payload-type",          0,  INTEGER, 0, 1, 0, 127);
+    option(u"pcr-pid",               0,  PIDVAL);
+    option(u"rtp",                  'r');
+    option(u"segmentation-offload",  0);
+    option(u"ssrc-identifier",       0,  UINT32);
+    option(u"start-sequence-number", 0,  UINT16);
+    option(u"ttl",                  't', POSITIVE);
 
     setHelp(u"Parameter:\n"
             u"  The parameter address:port describes the destination for UDP packets.\n"
@@ -205,6 +389,27 @@ ts::IPOutput::IPOutput(TSP* tsp_) :
             u"\n"
             u"Options:\n"
             u"\n"
+            u"  -b value\n"
+            u"  --bitrate value\n"
+            u"      With --pacing, specify the bitrate in bits/second. By default, use the\n"
+            u"      bitrate of the transport stream, as computed by tsp from the PCR's or\n"
+            u"      reported by the input device.\n"
+            u"\n"
+            u"  --fec-2d\n"
+            u"      With --fec-columns, also generate row FEC packets (SMPTE 2022-1 2D FEC).\n"
+            u"      The row FEC packets are sent to the destination UDP port plus " + UString::Decimal(FEC_ROW_PORT_OFFSET) + u".\n"
+            u"      The number of columns must be at least " + UString::Decimal(FEC_MIN_ROWS) + u".\n"
+            u"\n"
+            u"  --fec-columns value\n"
+            u"      With --rtp, generate SMPTE 2022-1 column FEC packets. The value is the\n"
+            u"      number of columns (L parameter) of the FEC matrix, from 1 to " + UString::Decimal(FEC_MAX_COLUMNS) + u". The\n"
+            u"      column FEC packets are sent to the destination UDP port plus " + UString::Decimal(FEC_COLUMN_PORT_OFFSET) + u".\n"
+            u"\n"
+            u"  --fec-rows value\n"
+            u"      With --fec-columns, specify the number of rows (D parameter) of the FEC\n"
+            u"      matrix, from " + UString::Decimal(FEC_MIN_ROWS) + u" to " + UString::Decimal(FEC_MAX_ROWS) + u". The size of the matrix cannot exceed " + UString::Decimal(FEC_MAX_MATRIX) + u"\n"
+            u"      UDP packets. The default is " + UString::Decimal(DEF_FEC_ROWS) + u".\n"
+            u"\n"
             u"  --help\n"
             u"      Display this help text.\n"
             u"\n"
@@ -220,6 +425,39 @@ ts::IPOutput::IPOutput(TSP* tsp_) :
             u"      The default is " TS_STRINGIFY(DEF_PACKET_BURST) u", the maximum is "
             TS_STRINGIFY(MAX_PACKET_BURST) u".\n"
             u"\n"
+            u"  --pacing\n"
+            u"      Space the UDP packets according to the bitrate of the transport stream.\n"
+            u"      By default, the UDP packets are sent as soon as the TS packets are\n"
+            u"      available, which may produce bursts. With --pacing, it is no longer\n"
+            u"      necessary to use the regulate plugin before this output plugin.\n"
+            u"\n"
+            u"  --payload-type value\n"
+            u"      With --rtp, specify the payload type. The default is " + UString::Decimal(RTP_PT_MP2T) + u" (MPEG-2 TS).\n"
+            u"\n"
+            u"  --pcr-pid value\n"
+            u"      With --rtp, specify the PID containing the PCR's which are used to\n"
+            u"      compute the RTP time stamps. By default, use the first PID containing\n"
+            u"      PCR's. Before the first PCR, the RTP time stamps follow the system clock.\n"
+            u"      The time stamps which are derived from the PCR's continue from there,\n"
+            u"      without discontinuity.\n"
+            u"\n"
+            u"  -r\n"
+            u"  --rtp\n"
+            u"      Encapsulate the TS packets in RTP (RFC 2250, SMPTE 2022-2). The RTP\n"
+            u"      time stamps use a 90 kHz clock, derived from the PCR's.\n"
+            u"\n"
+            u"  --segmentation-offload\n"
+            u"      Use UDP segmentation offload: large buffers are passed to the kernel\n"
+            u"      which splits them into UDP packets. This reduces the CPU load at high\n"
+            u"      bitrates. This option is supported on Linux only (kernel 4.18 and higher).\n"
+            u"\n"
+            u"  --ssrc-identifier value\n"
+            u"      With --rtp, specify the RTP synchronization source identifier.\n"
+            u"      By default, a random value is used, as recommended by RFC 3550.\n"
+            u"\n"
+            u"  --start-sequence-number value\n"
+            u"      With --rtp, specify the initial RTP sequence number. The default is zero.\n"
+            u"\n"
             u"  -t value\n"
             u"  --ttl value\n"
             u"      Specifies the TTL (Time-To-Live) socket option. The actual option\n"
@@ -244,6 +482,9 @@ bool ts::IPInput::start()
     UString destination(value(u""));
     UString local(value(u"local-address"));
     size_t recv_bufsize = intValue<size_t>(u"buffer-size", 0);
+    size_t recv_depth = intValue<size_t>(u"receive-depth", DEF_RECEIVE_DEPTH);
+    _fec = present(u"fec");
+    _rtp.setDepth(intValue<size_t>(u"reorder-depth", _fec ? RTPReorderBuffer::MAX_DEPTH : 0));
     bool reuse_port = present(u"reuse-port");
 
     // Resolve specified destination address:port
@@ -270,37 +511,78 @@ bool ts::IPInput::start()
         return false;
     }
 
-    // The local socket address to bind is the optional local IP address and the destination port
-    SocketAddress local_addr(local_ip, dest_addr.port());
-
-    // Create UDP socket
-    if (!_sock.open(*tsp)) {
+    // The FEC flows use the next ports after the media port.
+    if (_fec && dest_addr.port() > 0xFFFF - FEC_ROW_PORT_OFFSET) {
+        tsp->error(u"UDP port %d too large for FEC flows", {dest_addr.port()});
         return false;
     }
 
-    // Initialize socket.
-    // Note: On Windows, bind must be done *before* joining multicast groups.
-    bool ok =
-        (!reuse_port || _sock.reusePort (true, *tsp)) &&
-        (recv_bufsize <= 0 ||_sock.setReceiveBufferSize (recv_bufsize, *tsp)) &&
-        _sock.bind (local_addr, *tsp) &&
-        (!dest_addr.hasAddress() || _sock.addMembership (dest_addr, local_ip, *tsp));
-
-    if (!ok) {
+    // Create and initialize the UDP sockets.
+    if (!openSocket(_sock, dest_addr.port(), dest_addr, local_ip, recv_bufsize, reuse_port)) {
+        return false;
+    }
+    if (_fec &&
+        (!openSocket(_fec_col_sock, uint16_t(dest_addr.port() + FEC_COLUMN_PORT_OFFSET), dest_addr, local_ip, recv_bufsize, reuse_port) ||
+         !openSocket(_fec_row_sock, uint16_t(dest_addr.port() + FEC_ROW_PORT_OFFSET), dest_addr, local_ip, recv_bufsize, reuse_port)))
+    {
         _sock.close();
+        _fec_col_sock.close();
         return false;
     }
 
+    // Use kernel receive time stamps for bitrate evaluation, when supported.
+    if (_eval_time > 0 && !_sock.setReceiveTimestamps(true, NULLREP)) {
+        tsp->verbose(u"kernel receive time stamps not available, using system time");
+    }
+
     // Socket now ready.
     // Initialize working data.
+    _msgs.resize(recv_depth);
+    _overflow.resize(recv_depth * MAX_IP_SIZE);
+    _msgbuf.resize(MAX_IP_SIZE);
+    _inbuf.clear();
     _inbuf_count = _inbuf_next = 0;
-    _start = _start_0 = _start_1 = _next_display = Time::Epoch;
+    _slot_pkts = DEF_PACKET_BURST;
+    _start = _start_0 = _start_1 = _next_display = _last_time = 0;
     _packets = _packets_0 = _packets_1 = 0;
 
+    _fec_decoder.reset();
+    _fec_msgs.resize(_fec ? FEC_RECEIVE_DEPTH : 0);
+    _fec_buf.resize(_fec ? FEC_RECEIVE_DEPTH * MAX_IP_SIZE : 0);
+
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Open and initialize a UDP socket.
+//----------------------------------------------------------------------------
+
+bool ts::IPInput::openSocket(UDPSocket& sock, uint16_t port, const SocketAddress& dest_addr, const IPAddress& local_ip, size_t bufsize, bool reuse_port)
+{
+    // The local socket address to bind is the optional local IP address and the port
+    SocketAddress local_addr(local_ip, port);
+
+    // Create UDP socket
+    if (!sock.open(*tsp)) {
+        return false;
+    }
+
+    // Initialize socket.
+    // Note: On Windows, bind must be done *before* joining multicast groups.
+    bool ok =
+        (!reuse_port || sock.reusePort(true, *tsp)) &&
+        (bufsize <= 0 || sock.setReceiveBufferSize(bufsize, *tsp)) &&
+        sock.bind(local_addr, *tsp) &&
+        (!dest_addr.hasAddress() || sock.addMembership(dest_addr, local_ip, *tsp));
+
+    if (!ok) {
+        sock.close();
+    }
+    return ok;
+}
+
+
 //----------------------------------------------------------------------------
 // Input stop method
 //----------------------------------------------------------------------------
@@ -308,6 +590,17 @@ bool ts::IPInput::start()
 bool ts::IPInput::stop()
 {
     _sock.close();
+    if (_fec) {
+        _fec_col_sock.close();
+        _fec_row_sock.close();
+    }
+    if (_rtp.receivedCount() > 0) {
+        tsp->verbose(u"RTP: %'d packets, %'d lost, %'d reordered, %'d duplicated or late",
+                     {_rtp.receivedCount(), _rtp.lostCount(), _rtp.reorderedCount(), _rtp.lateCount()});
+    }
+    if (_fec) {
+        tsp->verbose(u"FEC: %'d packets recovered", {_fec_decoder.recoveredCount()});
+    }
     return true;
 }
 
@@ -335,63 +628,48 @@ ts::BitRate ts::IPInput::getBitrate()
     else {
         // Evaluate bitrate since start of previous evaluation period.
         // The current period may be too short for correct evaluation.
-        const MilliSecond ms = Time::CurrentUTC() - _start_0;
+        // Use the receive time of the last packet, not the current time.
+        const MilliSecond ms = (_last_time - _start_0) / NanoSecPerMilliSec;
         return ms == 0 ? 0 : BitRate ((_packets_0 * PKT_SIZE * 8 * MilliSecPerSec) / ms);
     }
 }
 
 
 //----------------------------------------------------------------------------
-// Input method
+// Locate the TS packets inside a UDP message.
+// Return false if no TS packet is found.
 //----------------------------------------------------------------------------
 
-size_t ts::IPInput::receive (TSPacket* buffer, size_t max_packets)
+bool ts::IPInput::LocatePackets(const uint8_t* msg, size_t size, size_t& offset, size_t& count)
 {
-    // Check if we receive new packets or process remain of previous buffer.
-    bool new_packets = false;
-
-    // If there is no remaining packet in the input buffer, wait for a UDP
-    // message. Loop until we get some TS packets.
-    while (_inbuf_count <= 0) {
-
-        // Wait for a UDP message
-        SocketAddress sender;
-        size_t insize;
-        if (!_sock.receive (_inbuf, sizeof(_inbuf), insize, sender, tsp, *tsp)) {
-            return 0;
-        }
-
-        // Locate the TS packets inside the UDP message. Basically, we
-        // expect the message to contain only TS packets. However, we
-        // will face the following situations:
-        // - Presence of a header preceeding the first TS packet (typically
-        //   when the TS packets are encapsulated in RTP).
-        // - Presence of a truncated packet at the end of message.
-
-        // To face the first situation, we look backward from the end of
-        // the message, looking for a 0x47 sync byte every 188 bytes, going
-        // backward.
-
-        const uint8_t* p;
-        for (p = _inbuf + insize; p >= _inbuf + PKT_SIZE && p[-int(PKT_SIZE)] == SYNC_BYTE; p -= PKT_SIZE) {}
-
-        if (p < _inbuf + insize) {
-            // Some packets were found
-            _inbuf_next = p - _inbuf;
-            _inbuf_count = (_inbuf + insize - p) / PKT_SIZE;
-            new_packets = true;
-            break; // exit receive loop
-        }
-
-        // If no TS packet is found using the first method, we restart from
-        // the beginning of the message, looking for a 0x47 sync byte every
-        // 188 bytes, going forward. If we find this pattern, followed by
-        // less than 188 bytes, then we have found a sequence of TS packets.
+    // Basically, we expect the message to contain only TS packets. However,
+    // we will face the following situations:
+    // - Presence of a header preceeding the first TS packet (typically
+    //   when the TS packets are encapsulated in RTP).
+    // - Presence of a truncated packet at the end of message.
+
+    // To face the first situation, we look backward from the end of
+    // the message, looking for a 0x47 sync byte every 188 bytes, going
+    // backward.
+
+    const uint8_t* p;
+    for (p = msg + size; p >= msg + PKT_SIZE && p[-int(PKT_SIZE)] == SYNC_BYTE; p -= PKT_SIZE) {}
+
+    if (p < msg + size) {
+        // Some packets were found
+        offset = p - msg;
+        count = (msg + size - p) / PKT_SIZE;
+        return true;
+    }
 
-        const uint8_t* max = _inbuf + insize - PKT_SIZE; // max address for a TS packet
-        _inbuf_count = 0;
+    // If no TS packet is found using the first method, we restart from
+    // the beginning of the message, looking for a 0x47 sync byte every
+    // 188 bytes, going forward. If we find this pattern, followed by
+    // less than 188 bytes, then we have found a sequence of TS packets.
 
-        for (p = _inbuf; p <= max; p++) {
+    if (size >= PKT_SIZE) {
+        const uint8_t* max = msg + size - PKT_SIZE; // max address for a TS packet
+        for (p = msg; p <= max; p++) {
             if (*p == SYNC_BYTE) {
                 // Verify that we get a 0x47 sync byte every 188 bytes up
                 // to the end of message (not leaving more than one truncated
@@ -400,69 +678,345 @@ size_t ts::IPInput::receive (TSPacket* buffer, size_t max_packets)
                 for (end = p; end <= max && *end == SYNC_BYTE; end += PKT_SIZE) {}
                 if (end > max) {
                     // Less than 188 bytes after last packet. Consider we are OK
-                    _inbuf_next = p - _inbuf;
-                    _inbuf_count = (end - p) / PKT_SIZE;
-                    new_packets = true;
-                    break; // exit packet search loop
+                    offset = p - msg;
+                    count = (end - p) / PKT_SIZE;
+                    return true;
                 }
             }
         }
+    }
 
-        if (new_packets) {
-            break; // exit receive loop
+    // No TS packet found in UDP message.
+    offset = count = 0;
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Locate the TS packets inside an RTP message.
+// Return false if this is not an RTP message containing TS packets.
+//----------------------------------------------------------------------------
+
+bool ts::IPInput::LocateRTPPackets(const uint8_t* msg, size_t size, size_t& offset, size_t& count, uint16_t& seq, uint32_t& ssrc)
+{
+    // The first byte of an RTP header contains the version 2 in the two most
+    // significant bits. This is never a TS sync byte (0x47).
+    if (size < RTP_HEADER_SIZE || (msg[0] & 0xC0) != 0x80) {
+        return false;
+    }
+
+    // Skip the CSRC identifiers and the optional header extension.
+    size_t header = RTP_HEADER_SIZE + 4 * (msg[0] & 0x0F);
+    if ((msg[0] & 0x10) != 0) {
+        if (header + 4 > size) {
+            return false;
         }
+        header += 4 + 4 * size_t(GetUInt16(msg + header + 2));
+    }
 
-        // No TS packet found in UDP message, wait for another one.
-        tsp->debug(u"no TS packet in message from %s, %s bytes", {sender.toString(), insize});
+    // Remove the optional padding. The last byte is the padding size.
+    size_t end = size;
+    if ((msg[0] & 0x20) != 0) {
+        end -= std::min<size_t>(size, msg[size - 1]);
     }
 
-    // If new packets were received, we may need to re-evaluate the real-time input bitrate.
-    if (new_packets && _eval_time > 0) {
+    // The payload must be made of complete TS packets.
+    if (header > end || (end - header) % PKT_SIZE != 0 || (end > header && msg[header] != SYNC_BYTE)) {
+        return false;
+    }
+
+    offset = header;
+    count = (end - header) / PKT_SIZE;
+    seq = GetUInt16(msg + 2);
+    ssrc = GetUInt32(msg + 8);
+    return true;
+}
 
-        const Time now (Time::CurrentUTC());
 
-        // Detect start time
-        if (_packets == 0) {
-            _start = _start_0 = _start_1 = now;
-            if (_display_time > 0) {
-                _next_display = now + _display_time;
-            }
+//----------------------------------------------------------------------------
+// Store TS packets in the tsp buffer or, when full, in the input buffer.
+//----------------------------------------------------------------------------
+
+void ts::IPInput::deliver(OutputArea& out, const uint8_t* data, size_t count)
+{
+    // Pack the TS packets in the tsp buffer, without overwriting the next message.
+    // Once some packets are stored in the input buffer, all subsequent packets go there.
+    if (_inbuf_count == 0) {
+        const size_t pkt_cnt = out.count >= out.limit ? 0 : std::min(count, out.limit - out.count);
+        uint8_t* const addr = out.base + out.count * PKT_SIZE;
+        if (pkt_cnt > 0 && addr != data) {
+            ::memmove(addr, data, pkt_cnt * PKT_SIZE);
+        }
+        out.count += pkt_cnt;
+        data += pkt_cnt * PKT_SIZE;
+        count -= pkt_cnt;
+    }
+    if (count > 0) {
+        if (_inbuf_count == 0) {
+            _inbuf.clear();
+            _inbuf_next = 0;
         }
+        _inbuf.append(data, count * PKT_SIZE);
+        _inbuf_count += count;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process the TS packets of an RTP message.
+//----------------------------------------------------------------------------
+
+void ts::IPInput::receiveRTP(OutputArea& out, const uint8_t* data, size_t count, uint16_t seq, uint32_t ssrc)
+{
+    // Held messages which are delivered before this one must not overwrite it
+    // when it is still in the tsp buffer.
+    _rtp_out = &out;
+    _rtp_data = data;
+    _rtp_limit = out.limit;
+    if (data >= out.base && data < out.base + out.limit * PKT_SIZE) {
+        out.limit = std::max(out.count, size_t(data - out.base) / PKT_SIZE);
+    }
+
+    _rtp.add(seq, ssrc, data, count * PKT_SIZE, *tsp);
+
+    out.limit = _rtp_limit;
+    _rtp_out = 0;
+    _rtp_data = 0;
+}
 
-        // Count packets
-        _packets += _inbuf_count;
-        _packets_0 += _inbuf_count;
-        _packets_1 += _inbuf_count;
 
-        // Detect new evaluation period
-        if (now >= _start_1 + _eval_time) {
-            _start_0 = _start_1;
-            _packets_0 = _packets_1;
-            _start_1 = now;
-            _packets_1 = 0;
+//----------------------------------------------------------------------------
+// Receive the RTP payloads in sequence from the reorder buffer.
+//----------------------------------------------------------------------------
+
+void ts::IPInput::handleRTPPayload(RTPReorderBuffer& buffer, uint16_t seq, const uint8_t* payload, size_t size)
+{
+    // The current message can be stored up to the next one.
+    if (payload == _rtp_data) {
+        _rtp_out->limit = _rtp_limit;
+    }
+    deliver(*_rtp_out, payload, size / PKT_SIZE);
+}
+
+
+//----------------------------------------------------------------------------
+// Update bitrate evaluation after receiving packets.
+//----------------------------------------------------------------------------
 
+void ts::IPInput::updateBitrate(size_t count)
+{
+    // Receive time of last packet.
+    const NanoSecond now = _last_time;
+
+    // Detect start time
+    if (_packets == 0) {
+        _start = _start_0 = _start_1 = now;
+        if (_display_time > 0) {
+            _next_display = now + _display_time * NanoSecPerMilliSec;
         }
+    }
 
-        // Check if evaluated bitrate should be displayed
-        if (_display_time > 0 && now >= _next_display) {
-            _next_display += _display_time;
-            const MilliSecond ms_current = Time::CurrentUTC() - _start_0;
-            const MilliSecond ms_total = Time::CurrentUTC() - _start;
-            const BitRate br_current = ms_current == 0 ? 0 : BitRate ((_packets_0 * PKT_SIZE * 8 * MilliSecPerSec) / ms_current);
-            const BitRate br_average = ms_total == 0 ? 0 : BitRate ((_packets * PKT_SIZE * 8 * MilliSecPerSec) / ms_total);
-            tsp->info(u"IP input bitrate: %s, average: %s", {
-                br_current == 0 ? u"undefined" : UString::Decimal(br_current) + u" b/s",
-                br_average == 0 ? u"undefined" : UString::Decimal(br_average) + u" b/s"});
+    // Count packets
+    _packets += count;
+    _packets_0 += count;
+    _packets_1 += count;
+
+    // Detect new evaluation period
+    if (now >= _start_1 + _eval_time * NanoSecPerMilliSec) {
+        _start_0 = _start_1;
+        _packets_0 = _packets_1;
+        _start_1 = now;
+        _packets_1 = 0;
+    }
+
+    // Check if evaluated bitrate should be displayed
+    if (_display_time > 0 && now >= _next_display) {
+        _next_display += _display_time * NanoSecPerMilliSec;
+        const MilliSecond ms_current = (now - _start_0) / NanoSecPerMilliSec;
+        const MilliSecond ms_total = (now - _start) / NanoSecPerMilliSec;
+        const BitRate br_current = ms_current == 0 ? 0 : BitRate ((_packets_0 * PKT_SIZE * 8 * MilliSecPerSec) / ms_current);
+        const BitRate br_average = ms_total == 0 ? 0 : BitRate ((_packets * PKT_SIZE * 8 * MilliSecPerSec) / ms_total);
+        tsp->info(u"IP input bitrate: %s, average: %s", {
+            br_current == 0 ? u"undefined" : UString::Decimal(br_current) + u" b/s",
+            br_average == 0 ? u"undefined" : UString::Decimal(br_average) + u" b/s"});
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Receive the available FEC packets on one FEC socket, without waiting.
+//----------------------------------------------------------------------------
+
+bool ts::IPInput::receiveFEC(UDPSocket& sock)
+{
+    size_t msg_count = 0;
+    do {
+        for (size_t i = 0; i < _fec_msgs.size(); ++i) {
+            UDPSocket::Message& msg(_fec_msgs[i]);
+            msg.data = &_fec_buf[i * MAX_IP_SIZE];
+            msg.max_size = MAX_IP_SIZE;
+            msg.overflow = 0;
+            msg.overflow_size = 0;
+        }
+        if (!sock.receiveAvailable(&_fec_msgs[0], _fec_msgs.size(), msg_count, *tsp)) {
+            return false;
         }
+        for (size_t i = 0; i < msg_count; ++i) {
+            if (!_fec_decoder.addFEC(_fec_msgs[i].data, _fec_msgs[i].size)) {
+                tsp->debug(u"invalid FEC packet from %s, %d bytes", {_fec_msgs[i].sender.toString(), _fec_msgs[i].size});
+            }
+        }
+    } while (msg_count == _fec_msgs.size());
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Process the media packets which were recovered by FEC.
+//----------------------------------------------------------------------------
+
+void ts::IPInput::deliverRecovered(OutputArea& out, size_t& pkt_received)
+{
+    uint16_t seq = 0;
+    uint8_t pt = 0;
+    uint32_t timestamp = 0;
+    const uint8_t* payload = 0;
+    size_t size = 0;
+
+    // The recovered payload is returned from the FEC history, without copy. It is copied
+    // only once, in the tsp buffer or, when not in sequence, in the RTP reorder buffer.
+    while (_fec_decoder.getRecovered(seq, pt, timestamp, payload, size)) {
+        // Only RTP payloads of the same type, made of complete TS packets, can be used.
+        if (_rtp.isSynchronized() && pt == _fec_pt && size > 0 && size % PKT_SIZE == 0 && payload[0] == SYNC_BYTE) {
+            tsp->debug(u"recovered RTP packet %d, time stamp %d", {seq, timestamp});
+            pkt_received += size / PKT_SIZE;
+            receiveRTP(out, payload, size / PKT_SIZE, seq, _rtp.ssrc());
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Input method
+//----------------------------------------------------------------------------
+
+size_t ts::IPInput::receive(TSPacket* buffer, size_t max_packets)
+{
+    // First, return remaining packets from a previous receive operation.
+    if (_inbuf_count > 0) {
+        const size_t pkt_cnt = std::min(_inbuf_count, max_packets);
+        ::memcpy(buffer, &_inbuf[_inbuf_next], pkt_cnt * PKT_SIZE);
+        _inbuf_count -= pkt_cnt;
+        _inbuf_next += pkt_cnt * PKT_SIZE;
+        return pkt_cnt;
     }
 
-    // Return packets from the input buffer
-    size_t pkt_cnt = std::min (_inbuf_count, max_packets);
-    ::memcpy (buffer, _inbuf + _inbuf_next, pkt_cnt * PKT_SIZE);
-    _inbuf_count -= pkt_cnt;
-    _inbuf_next += pkt_cnt * PKT_SIZE;
+    // Loop until we get some TS packets.
+    for (;;) {
+
+        // UDP messages are directly received in the tsp buffer, in consecutive
+        // slots of _slot_pkts TS packets. The part of a message which does not
+        // fit in its slot is received in an overflow buffer. When there is not
+        // enough room for one slot, receive in the overflow buffer only.
+        const size_t slot = _slot_pkts;
+        const size_t msg_max = std::max<size_t>(1, std::min(_msgs.size(), max_packets / slot));
+        for (size_t i = 0; i < msg_max; ++i) {
+            UDPSocket::Message& msg(_msgs[i]);
+            if (max_packets >= slot) {
+                msg.data = buffer + i * slot;
+                msg.max_size = slot * PKT_SIZE;
+                msg.overflow = &_overflow[i * MAX_IP_SIZE];
+                msg.overflow_size = MAX_IP_SIZE;
+            }
+            else {
+                msg.data = &_overflow[i * MAX_IP_SIZE];
+                msg.max_size = MAX_IP_SIZE;
+                msg.overflow = 0;
+                msg.overflow_size = 0;
+            }
+        }
 
-    return pkt_cnt;
+        // Wait for UDP messages.
+        size_t msg_count = 0;
+        if (!_sock.receive(&_msgs[0], msg_max, msg_count, tsp, *tsp)) {
+            return 0;
+        }
+
+        // Move the TS packets of each message at their final location.
+        OutputArea out;
+        out.base = reinterpret_cast<uint8_t*>(buffer);
+        out.count = 0;
+        size_t pkt_received = 0;
+
+        for (size_t i = 0; i < msg_count; ++i) {
+
+            const UDPSocket::Message& msg(_msgs[i]);
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(msg.data);
+
+            // If the message did not fit in its slot, rebuild it in one contiguous work buffer.
+            // Then learn the message size to avoid this in subsequent receive operations.
+            if (msg.size > msg.max_size) {
+                ::memcpy(&_msgbuf[0], msg.data, msg.max_size);
+                ::memcpy(&_msgbuf[msg.max_size], msg.overflow, msg.size - msg.max_size);
+                data = &_msgbuf[0];
+                _slot_pkts = std::min<size_t>(MAX_IP_PACKETS, (msg.size + PKT_SIZE - 1) / PKT_SIZE);
+            }
+
+            // Locate the TS packets inside the UDP message.
+            size_t offset = 0;
+            size_t count = 0;
+            uint16_t seq = 0;
+            uint32_t ssrc = 0;
+            const bool rtp = LocateRTPPackets(data, msg.size, offset, count, seq, ssrc);
+            if (!rtp && !LocatePackets(data, msg.size, offset, count)) {
+                tsp->debug(u"no TS packet in message from %s, %s bytes", {msg.sender.toString(), msg.size});
+                continue;
+            }
+            const uint8_t* const header = data;
+            data += offset;
+            pkt_received += count;
+            _last_time = msg.timestamp;
+
+            // Store the TS packets in the tsp buffer, up to the slot of the next message.
+            out.limit = (i + 1 < msg_count && msg.overflow != 0) ? (i + 1) * slot : max_packets;
+            if (rtp) {
+                if (_fec) {
+                    if (_rtp.isSynchronized() && ssrc != _rtp.ssrc()) {
+                        _fec_decoder.reset();
+                    }
+                    // The payload is copied in the FEC history: the tsp buffer may be overwritten
+                    // by the reorder buffer or the next receive operation before it is used.
+                    _fec_pt = header[1] & 0x7F;
+                    _fec_decoder.addMedia(seq, _fec_pt, GetUInt32(header + 4), data, count * PKT_SIZE);
+                }
+                receiveRTP(out, data, count, seq, ssrc);
+            }
+            else {
+                deliver(out, data, count);
+            }
+        }
+
+        // Recover lost RTP packets using the FEC packets which are already received.
+        if (_fec) {
+            out.limit = max_packets;
+            if (!receiveFEC(_fec_col_sock) || !receiveFEC(_fec_row_sock)) {
+                return 0;
+            }
+            deliverRecovered(out, pkt_received);
+        }
+
+        // If new packets were received, we may need to re-evaluate the real-time input bitrate.
+        if (pkt_received > 0 && _eval_time > 0) {
+            updateBitrate(pkt_received);
+        }
+
+        if (out.count > 0) {
+            return out.count;
+        }
+        else if (_inbuf_count > 0) {
+            return receive(buffer, max_packets);
+        }
+    }
 }
 
 
@@ -476,7 +1030,28 @@ bool ts::IPOutput::start()
     UString dest_name(value(u""));
     UString loc_name(value(u"local-address"));
     int ttl = intValue(u"ttl", 0);
+    bool gso = present(u"segmentation-offload");
     _pkt_burst = intValue(u"packet-burst", DEF_PACKET_BURST);
+    _pacing = present(u"pacing");
+    _pace_bitrate = intValue<BitRate>(u"bitrate", 0);
+    _rtp = present(u"rtp");
+    _rtp_pt = intValue<uint8_t>(u"payload-type", RTP_PT_MP2T);
+    _rtp_seq = intValue<uint16_t>(u"start-sequence-number", 0);
+    _rtp_ssrc = intValue<uint32_t>(u"ssrc-identifier", 0);
+    _rtp_offset = 0;
+    _pcr_pid = intValue<PID>(u"pcr-pid", PID_NULL);
+    _pcr_valid = false;
+    _last_pcr = 0;
+    _last_pcr_index = _pkt_index = 0;
+    _pcr_per_pkt = 0;
+    _rtp_origin.getSystemTime();
+
+    // The default synchronization source is random, see RFC 3550, section 8.1.
+    SystemRandomGenerator random;
+    if (_rtp && !present(u"ssrc-identifier") && !random.read(&_rtp_ssrc, sizeof(_rtp_ssrc))) {
+        tsp->error(u"cannot generate a random RTP synchronization source");
+        return false;
+    }
 
     // Create UDP socket
     bool ok = _sock.open (*tsp);
@@ -484,11 +1059,46 @@ bool ts::IPOutput::start()
     if (ok) {
         ok = _sock.setDefaultDestination (dest_name, *tsp) &&
             (loc_name.empty() || _sock.setOutgoingMulticast (loc_name, *tsp)) &&
-            (ttl <= 0 || _sock.setTTL (ttl, _sock.setTTL (ttl, *tsp)));
+            (ttl <= 0 || _sock.setTTL (ttl, _sock.setTTL (ttl, *tsp))) &&
+            (!gso || _sock.setSendSegmentation (true, *tsp));
+        if (!ok) {
+            _sock.close();
+        }
+    }
+
+    // FEC flows are sent on the next ports after the media port.
+    const size_t fec_columns = intValue<size_t>(u"fec-columns", 0);
+    if (ok && fec_columns > 0) {
+        _fec_col_dest = _fec_row_dest = _sock.getDefaultDestination();
+        if (!_rtp) {
+            tsp->error(u"FEC requires RTP encapsulation, use --rtp");
+            ok = false;
+        }
+        else if (_fec_col_dest.port() > 0xFFFF - FEC_ROW_PORT_OFFSET) {
+            tsp->error(u"UDP port %d too large for FEC flows", {_fec_col_dest.port()});
+            ok = false;
+        }
+        else {
+            _fec_col_dest.setPort(uint16_t(_fec_col_dest.port() + FEC_COLUMN_PORT_OFFSET));
+            _fec_row_dest.setPort(uint16_t(_fec_row_dest.port() + FEC_ROW_PORT_OFFSET));
+        }
+        ok = ok && _fec.setMatrix(fec_columns, intValue<size_t>(u"fec-rows", DEF_FEC_ROWS), present(u"fec-2d"), *tsp);
         if (!ok) {
             _sock.close();
         }
     }
+    else {
+        _fec.setMatrix(0, 0, false, NULLREP);
+    }
+
+    // Pacing state. Request the best timer precision from the operating system.
+    // If the actual precision is worse, the UDP messages which became due while
+    // waiting are sent together.
+    if (ok && _pacing) {
+        Monotonic::SetPrecision(PacketPacer::PRECISION);
+        _cur_bitrate = 0;
+        _pacer.reset();
+    }
 
     return ok;
 }
@@ -519,13 +1129,45 @@ ts::IPOutput::~IPOutput()
 // Output method
 //----------------------------------------------------------------------------
 
-bool ts::IPOutput::send (const TSPacket* pkt, size_t packet_count)
+bool ts::IPOutput::send(const TSPacket* pkt, size_t packet_count)
 {
-    // Send TS packets in UDP messages, grouped according to burst size.
+    if (_pacing) {
+        return sendPaced(pkt, packet_count);
+    }
+    else {
+        return sendPackets(pkt, packet_count);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send UDP messages with pacing.
+//----------------------------------------------------------------------------
+
+bool ts::IPOutput::sendPaced(const TSPacket* pkt, size_t packet_count)
+{
+    // Get current bitrate.
+    const BitRate bitrate = _pace_bitrate != 0 ? _pace_bitrate : tsp->bitrate();
+    if (bitrate != _cur_bitrate) {
+        if (bitrate == 0) {
+            tsp->verbose(u"unknown bitrate, cannot pace output");
+        }
+        else {
+            tsp->verbose(u"output paced at bitrate %'d b/s", {bitrate});
+        }
+        _cur_bitrate = bitrate;
+    }
+
+    // Without known bitrate, send without pacing.
+    if (bitrate == 0) {
+        _pacer.reset();
+        return sendPackets(pkt, packet_count);
+    }
 
+    // Send all UDP messages of _pkt_burst TS packets which are due.
     while (packet_count > 0) {
-        size_t count = std::min (packet_count, _pkt_burst);
-        if (!_sock.send (pkt, count * PKT_SIZE, *tsp)) {
+        const size_t count = _pacer.wait(bitrate, packet_count, _pkt_burst);
+        if (!sendPackets(pkt, count)) {
             return false;
         }
         pkt += count;
@@ -534,3 +1176,117 @@ bool ts::IPOutput::send (const TSPacket* pkt, size_t packet_count)
 
     return true;
 }
+
+
+//----------------------------------------------------------------------------
+// Send TS packets in UDP messages, without pacing.
+//----------------------------------------------------------------------------
+
+bool ts::IPOutput::sendPackets(const TSPacket* pkt, size_t packet_count)
+{
+    // Without RTP, the TS packets are directly sent, grouped according to burst size.
+    if (!_rtp) {
+        return _sock.sendMessages(pkt, packet_count * PKT_SIZE, _pkt_burst * PKT_SIZE, *tsp);
+    }
+
+    // Build all RTP messages in a work buffer. The last one may be shorter.
+    const size_t msg_size = RTP_HEADER_SIZE + _pkt_burst * PKT_SIZE;
+    _rtp_buf.resize(((packet_count + _pkt_burst - 1) / _pkt_burst) * msg_size);
+    uint8_t* out = _rtp_buf.data();
+
+    while (packet_count > 0) {
+        const size_t count = std::min(packet_count, _pkt_burst);
+
+        // RTP header, see RFC 3550: version 2, no padding, no extension, no CSRC, no marker.
+        out[0] = 0x80;
+        out[1] = _rtp_pt & 0x7F;
+        PutUInt16(out + 2, _rtp_seq++);
+        PutUInt32(out + 4, rtpTimeStamp());
+        PutUInt32(out + 8, _rtp_ssrc);
+        ::memcpy(out + RTP_HEADER_SIZE, pkt, count * PKT_SIZE);
+        if (_fec.isEnabled()) {
+            _fec.addMedia(GetUInt16(out + 2), out[1], GetUInt32(out + 4), out + RTP_HEADER_SIZE, count * PKT_SIZE);
+        }
+        out += RTP_HEADER_SIZE + count * PKT_SIZE;
+
+        // Collect PCR's for the time stamps of the next messages.
+        for (size_t i = 0; i < count; ++i, ++_pkt_index) {
+            if (pkt[i].hasPCR()) {
+                const PID pid = pkt[i].getPID();
+                if (_pcr_pid == PID_NULL) {
+                    _pcr_pid = pid;
+                    tsp->verbose(u"using PCR's from PID 0x%X (%d) for RTP time stamps", {pid, pid});
+                }
+                if (pid == _pcr_pid) {
+                    // Evaluate the PCR progression per packet, ignoring discontinuities and wrap up.
+                    const uint64_t pcr = pkt[i].getPCR();
+                    if (!_pcr_valid) {
+                        // Switch from the system clock to the PCR's without discontinuity.
+                        _rtp_offset = clockTimeStamp() - uint32_t(pcr / SYSTEM_CLOCK_SUBFACTOR);
+                    }
+                    _pcr_per_pkt = _pcr_valid && pcr > _last_pcr ? ((pcr - _last_pcr) * 1000) / (_pkt_index - _last_pcr_index) : 0;
+                    _pcr_valid = true;
+                    _last_pcr = pcr;
+                    _last_pcr_index = _pkt_index;
+                }
+            }
+        }
+        pkt += count;
+        packet_count -= count;
+    }
+
+    if (!_sock.sendMessages(_rtp_buf.data(), out - _rtp_buf.data(), msg_size, *tsp)) {
+        return false;
+    }
+
+    // Send the FEC packets which became available.
+    while (_fec.getColumnFEC(_fec_pkt)) {
+        if (!_sock.send(_fec_pkt.data(), _fec_pkt.size(), _fec_col_dest, *tsp)) {
+            return false;
+        }
+    }
+    while (_fec.getRowFEC(_fec_pkt)) {
+        if (!_sock.send(_fec_pkt.data(), _fec_pkt.size(), _fec_row_dest, *tsp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the RTP time stamp of the next TS packet to send.
+//----------------------------------------------------------------------------
+
+uint32_t ts::IPOutput::rtpTimeStamp()
+{
+    if (!_pcr_valid) {
+        return clockTimeStamp();
+    }
+
+    // Extrapolate the last PCR at the rate of the last two PCR's or at the TS bitrate,
+    // then convert to 90 kHz.
+    const PacketCounter distance = _pkt_index - _last_pcr_index;
+    const BitRate bitrate = tsp->bitrate();
+    uint64_t pcr = _last_pcr;
+    if (_pcr_per_pkt != 0) {
+        pcr += (distance * _pcr_per_pkt) / 1000;
+    }
+    else if (bitrate != 0) {
+        pcr += (distance * PKT_SIZE * 8 * SYSTEM_CLOCK_FREQ) / bitrate;
+    }
+    return uint32_t(pcr / SYSTEM_CLOCK_SUBFACTOR) + _rtp_offset;
+}
+
+
+//----------------------------------------------------------------------------
+// RTP time stamp from the system clock, before the first PCR.
+//----------------------------------------------------------------------------
+
+uint32_t ts::IPOutput::clockTimeStamp() const
+{
+    // System clock in micro-seconds, converted to 90 kHz.
+    Monotonic now;
+    now.getSystemTime();
+    return uint32_t((((now - _rtp_origin) / NanoSecPerMicroSec) * RTP_RATE_MP2T) / MicroSecPerSec);
+}
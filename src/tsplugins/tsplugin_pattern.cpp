@@ -49,6 +49,7 @@ namespace ts {
         PatternPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     private:
         uint8_t   _offset_pusi;      // Start offset in packets with PUSI
@@ -56,6 +57,9 @@ namespace ts {
         ByteBlock _pattern;          // Binary pattern to apply
         PIDSet    _pid_list;         // Array of pid values to filter
 
+        // Replace the payload of a packet with the pattern.
+        void applyPattern(TSPacket&);
+
         // Inaccessible operations
         PatternPlugin() = delete;
         PatternPlugin(const PatternPlugin&) = delete;
@@ -152,10 +156,40 @@ bool ts::PatternPlugin::start()
 ts::ProcessorPlugin::Status ts::PatternPlugin::processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed)
 {
     // If the packet has no payload, or not in a selected PID, leave it unmodified
-    if (!pkt.hasPayload() || !_pid_list[pkt.getPID()]) {
-        return TSP_OK;
+    if (pkt.hasPayload() && _pid_list[pkt.getPID()]) {
+        applyPattern(pkt);
+    }
+    return TSP_OK;
+}
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::PatternPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    for (size_t n = 0; n < count; ++n) {
+        if (mdata[n].getDropped()) {
+            status[n] = TSP_DROP;
+        }
+        else {
+            if (pkts[n].hasPayload() && _pid_list[pkts[n].getPID()]) {
+                applyPattern(pkts[n]);
+            }
+            status[n] = TSP_OK;
+        }
     }
+    return count;
+}
+
 
+//----------------------------------------------------------------------------
+// Replace the payload of a packet with the pattern.
+//----------------------------------------------------------------------------
+
+void ts::PatternPlugin::applyPattern(TSPacket& pkt)
+{
     // Compute start of payload area to replace
     uint8_t* pl = pkt.b + pkt.getHeaderSize() + (pkt.getPUSI() ? _offset_pusi : _offset_non_pusi);
 
@@ -169,6 +203,4 @@ ts::ProcessorPlugin::Status ts::PatternPlugin::processPacket(TSPacket& pkt, bool
         pl += cursize;
         remain -= cursize;
     }
-
-    return TSP_OK;
 }
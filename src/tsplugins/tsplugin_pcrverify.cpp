@@ -50,6 +50,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     private:
         // Description of one PID
@@ -57,11 +58,13 @@ namespace ts {
         {
             uint64_t      last_pcr_value;   // Last PCR value in this PID
             PacketCounter last_pcr_packet;  // Packet index containing last PCR
+            uint64_t      last_pcr_input;   // Input time stamp of packet containing last PCR
 
             // Constructor
             PIDContext() :
                 last_pcr_value(0),
-                last_pcr_packet(0)
+                last_pcr_packet(0),
+                last_pcr_input(TSPacketMetadata::INVALID_TIMESTAMP)
             {
             }
         };
@@ -71,6 +74,7 @@ namespace ts {
         BitRate       _bitrate;          // Expected bitrate (0 if unknown)
         int64_t       _jitter_max;       // Max jitter in PCR units
         bool          _time_stamp;       // Display time stamps
+        bool          _input_synchronous; // Verify PCR's against input time stamps
         PIDSet        _pid_list;         // Array of pid values to filter
         PacketCounter _packet_count;     // Global packets count
         PacketCounter _nb_pcr_ok;        // Number of PCR without jitter
@@ -78,6 +82,9 @@ namespace ts {
         PacketCounter _nb_pcr_unchecked; // Number of unchecked PCR (no previous ref)
         PIDContext    _stats[PID_MAX];   // Per-PID statistics
 
+        // Verify one packet, mdata may be null.
+        void verifyPacket(const TSPacket& pkt, const TSPacketMetadata* mdata);
+
         // PCR units per micro-second
         static const int64_t PCR_PER_MICRO_SEC = int64_t (SYSTEM_CLOCK_FREQ) / MicroSecPerSec;
         static const int64_t DEFAULT_JITTER_MAX_US = 1000; // 1000 us = 1 ms
@@ -110,6 +117,7 @@ ts::PCRVerifyPlugin::PCRVerifyPlugin(TSP* tsp_) :
     _bitrate(0),
     _jitter_max(0),
     _time_stamp(false),
+    _input_synchronous(false),
     _pid_list(),
     _packet_count(0),
     _nb_pcr_ok(0),
@@ -119,6 +127,7 @@ ts::PCRVerifyPlugin::PCRVerifyPlugin(TSP* tsp_) :
 {
     option(u"absolute",   'a');
     option(u"bitrate",    'b', POSITIVE);
+    option(u"input-synchronous", 'i');
     option(u"jitter-max", 'j', UNSIGNED);
     option(u"pid",        'p', PIDVAL, 0, UNLIMITED_COUNT);
     option(u"time-stamp", 't');
@@ -138,6 +147,13 @@ ts::PCRVerifyPlugin::PCRVerifyPlugin(TSP* tsp_) :
             u"  --help\n"
             u"      Display this help text.\n"
             u"\n"
+            u"  -i\n"
+            u"  --input-synchronous\n"
+            u"      Verify that the PCR's are synchronous with the input time stamps of the\n"
+            u"      packets, as set by tsp when the packets were received. This is useful\n"
+            u"      with real-time input devices. Without this option, the PCR's are verified\n"
+            u"      according to the transport bitrate.\n"
+            u"\n"
             u"  -j value\n"
             u"  --jitter-max value\n"
             u"      Maximum allowed jitter. PCR's with a higher jitter are reported, others\n"
@@ -170,6 +186,7 @@ bool ts::PCRVerifyPlugin::start()
     _jitter_max = intValue<int64_t>(u"jitter-max", _absolute ? DEFAULT_JITTER_MAX : DEFAULT_JITTER_MAX_US);
     _bitrate = intValue<BitRate>(u"bitrate", 0);
     _time_stamp = present(u"time-stamp");
+    _input_synchronous = present(u"input-synchronous");
     getPIDSet(_pid_list, u"pid", true);
 
     if (!_absolute) {
@@ -186,6 +203,7 @@ bool ts::PCRVerifyPlugin::start()
     for (size_t i = 0; i < PID_MAX; ++i) {
         _stats[i].last_pcr_value = 0;
         _stats[i].last_pcr_packet = 0;
+        _stats[i].last_pcr_input = TSPacketMetadata::INVALID_TIMESTAMP;
     }
 
     return true;
@@ -244,10 +262,35 @@ namespace {
 
 
 //----------------------------------------------------------------------------
-// Packet processing method
+// Packet processing methods
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::PCRVerifyPlugin::processPacket(TSPacket& pkt, bool& flush, bool& bitrate_changed)
+{
+    verifyPacket(pkt, 0);
+    return TSP_OK;
+}
+
+size_t ts::PCRVerifyPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    for (size_t n = 0; n < count; ++n) {
+        if (mdata[n].getDropped()) {
+            status[n] = TSP_DROP;
+        }
+        else {
+            verifyPacket(pkts[n], &mdata[n]);
+            status[n] = TSP_OK;
+        }
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Verify one packet.
+//----------------------------------------------------------------------------
+
+void ts::PCRVerifyPlugin::verifyPacket(const TSPacket& pkt, const TSPacketMetadata* mdata)
 {
     const size_t pid = pkt.getPID();
 
@@ -255,21 +298,24 @@ ts::ProcessorPlugin::Status ts::PCRVerifyPlugin::processPacket(TSPacket& pkt, bo
     if (_pid_list[pid] && pkt.hasPCR()) {
 
         const uint64_t pcr = pkt.getPCR();
+        const uint64_t input = mdata == 0 ? TSPacketMetadata::INVALID_TIMESTAMP : mdata->getInputTimeStamp();
         PIDContext& pc(_stats[pid]);
 
         // Compare PCR with previous one (if there is one)
-        if (pc.last_pcr_value == 0) {
+        if (pc.last_pcr_value == 0 || (_input_synchronous && (input == TSPacketMetadata::INVALID_TIMESTAMP || pc.last_pcr_input == TSPacketMetadata::INVALID_TIMESTAMP))) {
             _nb_pcr_unchecked++;
         }
         else {
             // Current bitrate:
             int64_t bitrate = int64_t(_bitrate != 0 ? _bitrate : tsp->bitrate());
-            // PCR jitter:
-            int64_t jit = jitter(int64_t(pc.last_pcr_value),
-                                 int64_t(pc.last_pcr_packet),
-                                 int64_t(pcr),
-                                 int64_t(_packet_count),
-                                 bitrate);
+            // PCR jitter: either against input time stamps or according to bitrate.
+            int64_t jit = _input_synchronous ?
+                (int64_t(pcr) - int64_t(pc.last_pcr_value)) - (int64_t(input) - int64_t(pc.last_pcr_input)) :
+                jitter(int64_t(pc.last_pcr_value),
+                       int64_t(pc.last_pcr_packet),
+                       int64_t(pcr),
+                       int64_t(_packet_count),
+                       bitrate);
             // Absolute value of PCR jitter:
             int64_t ajit = jit >= 0 ? jit : -jit;
             if (ajit <= _jitter_max) {
@@ -288,10 +334,9 @@ ts::ProcessorPlugin::Status ts::PCRVerifyPlugin::processPacket(TSPacket& pkt, bo
         // Remember PCR position
         pc.last_pcr_value = pcr;
         pc.last_pcr_packet = _packet_count;
+        pc.last_pcr_input = input;
     }
 
     // Count packets on TS
     _packet_count++;
-
-    return TSP_OK;
 }
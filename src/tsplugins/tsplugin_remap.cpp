@@ -56,6 +56,7 @@ namespace ts {
         RemapPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     private:
         typedef SafePtr<CyclingPacketizer, NullMutex> CyclingPacketizerPtr;
@@ -68,6 +69,7 @@ namespace ts {
         SectionDemux  _demux;           // Section demux
         PIDSet        _new_pids;        // New (remapped) PID values
         PIDMap        _pid_map;         // Key = input pid, value = output pid
+        PID           _pid_table[PID_MAX]; // Output pid, indexed by input pid, built from _pid_map
         PacketizerMap _pzer;            // Packetizer for sections
 
         // Invoked by the demux when a complete table is available.
@@ -105,6 +107,7 @@ ts::RemapPlugin::RemapPlugin (TSP* tsp_) :
     _demux(this),
     _new_pids(),
     _pid_map(),
+    _pid_table(),
     _pzer()
 {
     option(u"");
@@ -225,6 +228,14 @@ bool ts::RemapPlugin::start()
         }
     }
 
+    // Build the direct lookup table of remapped PID's
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        _pid_table[pid] = pid;
+    }
+    for (PIDMap::const_iterator it = _pid_map.begin(); it != _pid_map.end(); ++it) {
+        _pid_table[it->first] = it->second;
+    }
+
     // Clear the list of packetizers
     _pzer.clear();
 
@@ -251,8 +262,7 @@ bool ts::RemapPlugin::start()
 
 ts::PID ts::RemapPlugin::remap(PID pid)
 {
-    const PIDMap::const_iterator it = _pid_map.find(pid);
-    return it == _pid_map.end() ? pid : it->second;
+    return pid < PID_MAX ? _pid_table[pid] : pid;
 }
 
 
@@ -392,3 +402,34 @@ ts::ProcessorPlugin::Status ts::RemapPlugin::processPacket (TSPacket& pkt, bool&
     pkt.setPID(new_pid);
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::RemapPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // PSI updates are processed one packet at a time.
+    if (_update_psi) {
+        return ProcessorPlugin::processPacketBatch(pkts, mdata, count, status, flush, bitrate_changed);
+    }
+
+    // Otherwise, simply remap PID's.
+    for (size_t n = 0; n < count; ++n) {
+        if (mdata[n].getDropped()) {
+            status[n] = TSP_DROP;
+            continue;
+        }
+        const PID pid = pkts[n].getPID();
+        const PID new_pid = _pid_table[pid];
+        if (_check_integrity && new_pid == pid && _new_pids.test(pid)) {
+            tsp->error(u"PID conflict: PID %d (0x%X) present both in input and remap", {pid, pid});
+            status[n] = TSP_END;
+            return n + 1;
+        }
+        pkts[n].setPID(new_pid);
+        status[n] = TSP_OK;
+    }
+    return count;
+}
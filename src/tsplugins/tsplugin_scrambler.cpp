@@ -102,6 +102,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, bool&, bool&) override;
+        virtual size_t processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*, bool&, bool&) override;
 
     private:
         // Description of a crypto-period.
@@ -199,6 +200,8 @@ namespace ts {
         size_t            _current_cw;         // Index to current CW (current crypto period)
         size_t            _current_ecm;        // Index to current ECM (ECM being broadcast)
         Scrambling        _current_key;        // Preprocessed current control word
+        bool              _batch_mode;         // Accumulate payloads, see processPacketBatch()
+        std::vector<Scrambling::DataBlock> _batch; // Payloads to scramble with _current_key
         SectionDemux      _demux;              // Section demux
         CyclingPacketizer _pzer_pmt;           // Packetizer for modified PMT
         SystemRandomGenerator _cw_gen;         // Control word generator
@@ -209,6 +212,9 @@ namespace ts {
         CryptoPeriod& currentECM() {return _cp[_current_ecm];}
         CryptoPeriod& nextECM()    {return _cp[(_current_ecm + 1) & 0x01];}
 
+        // Scramble all accumulated payloads with the current control word.
+        void encryptBatch();
+
         // Perform CW and ECM transition
         void changeCW();
         void changeECM();
@@ -283,6 +289,8 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
     _current_cw(0),
     _current_ecm(0),
     _current_key(),
+    _batch_mode(false),
+    _batch(),
     _demux(this),
     _pzer_pmt(),
     _cw_gen()
@@ -821,6 +829,8 @@ void ts::ScramblerPlugin::changeCW()
 {
     // Allowed to change CW only if not in degraded mode
     if (!inDegradedMode()) {
+        // Scramble pending payloads with the previous control word
+        encryptBatch();
         // Point to next crypto-period
         _current_cw = (_current_cw + 1) & 0x01;
         // Use new control word
@@ -956,8 +966,15 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket (TSPacket& pkt, b
         _partial_clear = _partial_scrambling - 1;
     }
 
-    // Scramble the packet payload.
-    _current_key.encrypt(pkt.getPayload(), pkt.getPayloadSize());
+    // Scramble the packet payload. In batch mode, the payload is scrambled
+    // later, with all other payloads using the same control word.
+    if (_batch_mode) {
+        const Scrambling::DataBlock block = {pkt.getPayload(), pkt.getPayloadSize()};
+        _batch.push_back(block);
+    }
+    else {
+        _current_key.encrypt(pkt.getPayload(), pkt.getPayloadSize());
+    }
     _scrambled_count++;
 
     // Set scrambling_control_value in TS header.
@@ -973,6 +990,36 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket (TSPacket& pkt, b
 }
 
 
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+size_t ts::ScramblerPlugin::processPacketBatch(TSPacket* pkts, TSPacketMetadata* mdata, size_t count, Status* status, bool& flush, bool& bitrate_changed)
+{
+    // The packets are processed one by one but the payloads are accumulated and
+    // scrambled together, before each change of control word and at the end of
+    // the batch, before the packets are passed to the next plugin.
+    _batch_mode = true;
+    const size_t result = ProcessorPlugin::processPacketBatch(pkts, mdata, count, status, flush, bitrate_changed);
+    encryptBatch();
+    _batch_mode = false;
+    return result;
+}
+
+
+//----------------------------------------------------------------------------
+// Scramble all accumulated payloads with the current control word.
+//----------------------------------------------------------------------------
+
+void ts::ScramblerPlugin::encryptBatch()
+{
+    if (!_batch.empty()) {
+        _current_key.encrypt(&_batch[0], _batch.size());
+        _batch.clear();
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // CryptoPeriod default constructor.
 //----------------------------------------------------------------------------
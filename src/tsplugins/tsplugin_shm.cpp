@@ -0,0 +1,139 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor shared library:
+//  Shared memory ring input (from another tsp using "fork --shared-memory")
+//
+//----------------------------------------------------------------------------
+
+#include "tsPlugin.h"
+#include "tsSharedMemoryRing.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Plugin definition
+//----------------------------------------------------------------------------
+
+namespace ts {
+    class SharedMemoryInput: public InputPlugin
+    {
+    public:
+        // Implementation of plugin API
+        SharedMemoryInput(TSP*);
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual size_t receive(TSPacket*, size_t) override;
+
+    private:
+        SharedMemoryRing _ring;
+
+        // Inaccessible operations
+        SharedMemoryInput() = delete;
+        SharedMemoryInput(const SharedMemoryInput&) = delete;
+        SharedMemoryInput& operator=(const SharedMemoryInput&) = delete;
+    };
+}
+
+TSPLUGIN_DECLARE_VERSION
+TSPLUGIN_DECLARE_INPUT(ts::SharedMemoryInput)
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryInput::SharedMemoryInput(TSP* tsp_) :
+    InputPlugin(tsp_, u"Receive TS packets from a shared memory ring.", u"[options] [name]"),
+    _ring()
+{
+    option(u"", 0, STRING, 0, 1);
+
+    setHelp(u"Name:\n"
+            u"  Name of the shared memory ring. The ring is created by another tsp using\n"
+            u"  the plugin \"fork\" with option --shared-memory. By default, the name of the\n"
+            u"  ring is read from the environment variable TSDUCK_SHM_RING, as set by the\n"
+            u"  plugin \"fork\" in the created process. Example:\n"
+            u"    tsp ... -P fork --shared-memory 'tsp -I shm -P ... -O ...' ...\n"
+            u"\n"
+            u"  The input terminates when the writer of the ring terminates. This plugin\n"
+            u"  is not available on Windows.\n"
+            u"\n"
+            u"Options:\n"
+            u"\n"
+            u"  --help\n"
+            u"      Display this help text.\n"
+            u"\n"
+            u"  --version\n"
+            u"      Display the version number.\n");
+}
+
+
+//----------------------------------------------------------------------------
+// Start method
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryInput::start()
+{
+    const UString name(value(u"", GetEnvironment(SharedMemoryRing::ENV_NAME).c_str()));
+    if (name.empty()) {
+        tsp->error(u"no shared memory ring specified and %s not set", {SharedMemoryRing::ENV_NAME});
+        return false;
+    }
+    return _ring.attach(name, *tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Stop method
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryInput::stop()
+{
+    return _ring.close(*tsp);
+}
+
+
+//----------------------------------------------------------------------------
+// Input method
+//----------------------------------------------------------------------------
+
+size_t ts::SharedMemoryInput::receive(TSPacket* buffer, size_t max_packets)
+{
+    // Wait for some packets in the ring and copy one contiguous area.
+    // Zero means end of stream or error.
+    const TSPacket* area = 0;
+    const size_t count = std::min(_ring.getReadArea(area, *tsp), max_packets);
+    if (count > 0) {
+        ::memcpy(buffer, area, count * PKT_SIZE);  // Flawfinder: ignore: memcpy()
+        _ring.commitRead(count);
+    }
+    return count;
+}
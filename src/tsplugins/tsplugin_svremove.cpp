@@ -38,6 +38,7 @@
 #include "tsCyclingPacketizer.h"
 #include "tsNames.h"
 #include "tsTables.h"
+#include "tsTableViews.h"
 TSDUCK_SOURCE;
 
 
@@ -76,12 +77,12 @@ namespace ts {
         // Process specific tables and descriptors
         void processPAT(PAT&);
         void processSDT(SDT&);
-        void processPMT(PMT&);
+        void processPMT(const PMTView&);
         void processNITBAT(AbstractTransportListTable&);
         void processNITBATDescriptorList (DescriptorList&);
 
         // Mark all ECM PIDs from the specified descriptor list in the specified PID set
-        void addECMPID(const DescriptorList&, PIDSet&);
+        void addECMPID(const DescriptorLoopView&, PIDSet&);
 
         // Inaccessible operations
         SVRemovePlugin() = delete;
@@ -242,9 +243,12 @@ void ts::SVRemovePlugin::handleTable (SectionDemux& demux, const BinaryTable& ta
         }
 
         case TID_PMT: {
-            PMT pmt(table);
-            if (pmt.isValid()) {
-                processPMT(pmt);
+            // The PMT is only read, analyze its sections in place.
+            for (size_t si = 0; si < table.sectionCount(); ++si) {
+                const PMTView pmt(*table.sectionAt(si));
+                if (pmt.isValid()) {
+                    processPMT(pmt);
+                }
             }
             break;
         }
@@ -442,26 +446,27 @@ void ts::SVRemovePlugin::processPAT(PAT& pat)
 //  This method processes a Program Map Table (PMT).
 //----------------------------------------------------------------------------
 
-void ts::SVRemovePlugin::processPMT(PMT& pmt)
+void ts::SVRemovePlugin::processPMT(const PMTView& pmt)
 {
     // Is this the PMT of the service to remove?
-    const bool removed_service = pmt.service_id == _service.getId();
+    const bool removed_service = pmt.serviceId() == _service.getId();
 
     // Mark PIDs as dropped or referenced.
     PIDSet& pid_set(removed_service ? _drop_pids : _ref_pids);
 
     // Mark all program-level ECM PID's
-    addECMPID(pmt.descs, pid_set);
+    addECMPID(pmt.descriptors(), pid_set);
 
     // Mark service's PCR PID (usually a referenced component or null PID)
-    pid_set.set(pmt.pcr_pid);
+    pid_set.set(pmt.pcrPID());
 
     // Loop on all elementary streams
-    for (PMT::StreamMap::const_iterator it = pmt.streams.begin(); it != pmt.streams.end(); ++it) {
+    const PMTView::StreamLoop streams(pmt.streams());
+    for (PMTView::StreamLoop::const_iterator it = streams.begin(); it != streams.end(); ++it) {
         // Mark component's PID
-        pid_set.set(it->first);
+        pid_set.set(it->pid());
         // Mark all component-level ECM PID's
-        addECMPID(it->second.descs, pid_set);
+        addECMPID(it->descriptors(), pid_set);
     }
 
     // When the service to remove has been analyzed, we are ready to filter PIDs
@@ -473,17 +478,14 @@ void ts::SVRemovePlugin::processPMT(PMT& pmt)
 // Mark all ECM PIDs from the descriptor list in the PID set
 //----------------------------------------------------------------------------
 
-void ts::SVRemovePlugin::addECMPID (const DescriptorList& dlist, PIDSet& pid_set)
+void ts::SVRemovePlugin::addECMPID(const DescriptorLoopView& dlist, PIDSet& pid_set)
 {
     // Loop on all CA descriptors
-    for (size_t index = dlist.search(DID_CA); index < dlist.count(); index = dlist.search(DID_CA, index + 1)) {
-        CADescriptor ca(*dlist[index]);
-        if (!ca.isValid()) {
-            // Cannot deserialize a valid CA descriptor, ignore it
-        }
-        else {
-            // Standard CAS, only one PID in CA descriptor
-            pid_set.set(ca.ca_pid);
+    for (DescriptorLoopView::const_iterator it = dlist.search(DID_CA); it != dlist.end(); it = dlist.search(DID_CA, ++it)) {
+        // Standard CAS, only one PID in CA descriptor (same layout as ts::CADescriptor).
+        // A CA descriptor with less than 4 bytes is invalid, ignore it.
+        if (it->payloadSize() >= 4) {
+            pid_set.set(GetUInt16(it->payload() + 2) & 0x1FFF);
         }
     }
 }
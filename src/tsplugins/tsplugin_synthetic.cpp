@@ -0,0 +1,405 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor shared library:
+//  Synthetic transport stream input, typically for benchmarks
+//
+//----------------------------------------------------------------------------
+
+#include "tsPlugin.h"
+#include "tsOneShotPacketizer.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsPCR.h"
+TSDUCK_SOURCE;
+
+#define DEFAULT_BITRATE       38000000  // Nominal bitrate in b/s
+#define DEFAULT_SERVICES             1  // Number of services
+#define DEFAULT_STREAMS              2  // Number of elementary streams per service
+#define DEFAULT_VIDEO_PERCENT       80  // Percentage of video packets in elementary streams
+#define DEFAULT_PSI_INTERVAL       100  // PSI repetition interval in milliseconds
+#define DEFAULT_PCR_INTERVAL        40  // PCR interval in milliseconds
+#define MAX_SERVICES               100  // Maximum number of services
+#define MAX_STREAMS                 16  // Maximum number of elementary streams per service
+#define VIDEO_PES_PACKETS           32  // Number of TS packets per video PES packet
+#define AUDIO_PES_PACKETS            4  // Number of TS packets per audio PES packet
+
+
+//----------------------------------------------------------------------------
+// Plugin definition
+//----------------------------------------------------------------------------
+
+namespace ts {
+    class SyntheticInput: public InputPlugin
+    {
+    public:
+        // Implementation of plugin API
+        SyntheticInput(TSP*);
+        virtual bool start() override;
+        virtual BitRate getBitrate() override;
+        virtual size_t receive(TSPacket*, size_t) override;
+
+    private:
+        // Description of an elementary stream.
+        struct Stream
+        {
+            PID      pid;          // Elementary stream PID
+            uint8_t  stream_id;    // PES stream id
+            bool     pcr;          // This PID carries the PCR of its service
+            size_t   pes_packets;  // Number of TS packets per PES packet
+            size_t   pes_index;    // Index of next TS packet in current PES packet
+            uint8_t  cc;           // Next continuity counter
+            int      weight;       // Weight in the PID mix
+            int      current;      // Current weight in the smooth weighted round robin
+            uint64_t next_pcr;     // Time of next PCR, in PCR units
+            Stream();
+        };
+        typedef std::vector<Stream> StreamVector;
+
+        PacketCounter  _max_count;      // Number of packets to generate
+        PacketCounter  _count;          // Number of generated packets
+        BitRate        _bitrate;        // Nominal bitrate
+        int            _null_percent;   // Percentage of null packets
+        uint64_t       _psi_interval;   // PSI interval in PCR units
+        uint64_t       _pcr_interval;   // PCR interval in PCR units
+        uint64_t       _next_psi;       // Time of next PSI cycle, in PCR units
+        int            _null_acc;       // Accumulator for null packets distribution
+        int            _total_weight;   // Sum of all stream weights
+        TSPacketVector _psi;            // Packets of a PSI cycle: PAT and all PMT's
+        size_t         _psi_index;      // Index of next PSI packet to insert, _psi.size() if none
+        uint8_t        _psi_cc[PID_MAX];// Continuity counters of PSI PID's
+        StreamVector   _streams;        // All elementary streams
+
+        // Current time in PCR units of the next packet to generate.
+        uint64_t currentPCR() const;
+
+        // Build the next elementary stream packet.
+        void buildStreamPacket(TSPacket& pkt, uint64_t pcr);
+
+        // Inaccessible operations
+        SyntheticInput() = delete;
+        SyntheticInput(const SyntheticInput&) = delete;
+        SyntheticInput& operator=(const SyntheticInput&) = delete;
+    };
+}
+
+TSPLUGIN_DECLARE_VERSION
+TSPLUGIN_DECLARE_INPUT(ts::SyntheticInput)
+
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+ts::SyntheticInput::SyntheticInput(TSP* tsp_) :
+    InputPlugin(tsp_, u"Generate a synthetic transport stream, typically for benchmarks.", u"[options] [count]"),
+    _max_count(0),
+    _count(0),
+    _bitrate(0),
+    _null_percent(0),
+    _psi_interval(0),
+    _pcr_interval(0),
+    _next_psi(0),
+    _null_acc(0),
+    _total_weight(0),
+    _psi(),
+    _psi_index(0),
+    _psi_cc(),
+    _streams()
+{
+    option(u"",                   0,  UNSIGNED, 0, 1);
+    option(u"bitrate",           'b', POSITIVE);
+    option(u"joint-termination", 'j');
+    option(u"null-percent",       0,  INTEGER, 0, 1, 0, 99);
+    option(u"pcr-interval",       0,  POSITIVE);
+    option(u"psi-interval",       0,  POSITIVE);
+    option(u"services",          's', INTEGER, 0, 1, 1, MAX_SERVICES);
+    option(u"streams",            0,  INTEGER, 0, 1, 1, MAX_STREAMS);
+    option(u"video-percent",      0,  INTEGER, 0, 1, 1, 100);
+
+    setHelp(u"Count:\n"
+            u"  Specify the number of packets to generate. After the last packet, an\n"
+            u"  end-of-file condition is generated. By default, if count is not specified,\n"
+            u"  packets are generated endlessly.\n"
+            u"\n"
+            u"The generated transport stream contains a PAT, one PMT per service and the\n"
+            u"elementary streams of all services. In each service, the first elementary\n"
+            u"stream is a video stream which carries the PCR. The other ones are audio\n"
+            u"streams. The elementary streams contain PES packets with a PTS and dummy\n"
+            u"content. The packets are generated as fast as possible. The PCR, PTS and\n"
+            u"PSI repetition are computed from the nominal bitrate.\n"
+            u"\n"
+            u"Options:\n"
+            u"\n"
+            u"  -b value\n"
+            u"  --bitrate value\n"
+            u"      Nominal bitrate of the generated transport stream in bits/second.\n"
+            u"      The default is " TS_USTRINGIFY(DEFAULT_BITRATE) u" b/s.\n"
+            u"\n"
+            u"  --help\n"
+            u"      Display this help text.\n"
+            u"\n"
+            u"  -j\n"
+            u"  --joint-termination\n"
+            u"      When the number of packets is specified, perform a \"joint termination\"\n"
+            u"      when completed instead of unconditional termination.\n"
+            u"      See \"tsp --help\" for more details on \"joint termination\".\n"
+            u"\n"
+            u"  --null-percent value\n"
+            u"      Percentage of null packets in the transport stream. The default is 0.\n"
+            u"\n"
+            u"  --pcr-interval milliseconds\n"
+            u"      Interval between two PCR in each service. The default is " TS_USTRINGIFY(DEFAULT_PCR_INTERVAL) u" ms.\n"
+            u"\n"
+            u"  --psi-interval milliseconds\n"
+            u"      Repetition interval of the PAT and PMT's. The default is " TS_USTRINGIFY(DEFAULT_PSI_INTERVAL) u" ms.\n"
+            u"\n"
+            u"  -s value\n"
+            u"  --services value\n"
+            u"      Number of services in the transport stream. The default is " TS_USTRINGIFY(DEFAULT_SERVICES) u".\n"
+            u"\n"
+            u"  --streams value\n"
+            u"      Number of elementary streams per service. The default is " TS_USTRINGIFY(DEFAULT_STREAMS) u".\n"
+            u"\n"
+            u"  --version\n"
+            u"      Display the version number.\n"
+            u"\n"
+            u"  --video-percent value\n"
+            u"      Percentage of video packets in the elementary streams. The rest is equally\n"
+            u"      distributed among the audio streams. The default is " TS_USTRINGIFY(DEFAULT_VIDEO_PERCENT) u"%.\n");
+}
+
+ts::SyntheticInput::Stream::Stream() :
+    pid(PID_NULL),
+    stream_id(0),
+    pcr(false),
+    pes_packets(0),
+    pes_index(0),
+    cc(0),
+    weight(0),
+    current(0),
+    next_pcr(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Start method
+//----------------------------------------------------------------------------
+
+bool ts::SyntheticInput::start()
+{
+    tsp->useJointTermination(present(u"joint-termination"));
+    _max_count = intValue<PacketCounter>(u"", std::numeric_limits<PacketCounter>::max());
+    _bitrate = intValue<BitRate>(u"bitrate", DEFAULT_BITRATE);
+    _null_percent = intValue<int>(u"null-percent", 0);
+    _psi_interval = (intValue<uint64_t>(u"psi-interval", DEFAULT_PSI_INTERVAL) * SYSTEM_CLOCK_FREQ) / MilliSecPerSec;
+    _pcr_interval = (intValue<uint64_t>(u"pcr-interval", DEFAULT_PCR_INTERVAL) * SYSTEM_CLOCK_FREQ) / MilliSecPerSec;
+    const size_t services = intValue<size_t>(u"services", DEFAULT_SERVICES);
+    const size_t streams = intValue<size_t>(u"streams", DEFAULT_STREAMS);
+    const int video_percent = intValue<int>(u"video-percent", DEFAULT_VIDEO_PERCENT);
+
+    _count = 0;
+    _next_psi = 0;
+    _null_acc = 0;
+    _total_weight = 0;
+    _streams.clear();
+    ::memset(_psi_cc, 0, sizeof(_psi_cc));
+
+    // Build the PAT, the PMT's and the description of all elementary streams.
+    // Service ids start at 1, PMT PID's at 0x0100, elementary streams PID's at 0x1000.
+    // The weights of the streams in a service distribute the video percentage.
+    PAT pat(0, true, 1);
+    TSPacketVector pmt_packets;
+    for (size_t srv = 0; srv < services; ++srv) {
+        const uint16_t service_id = uint16_t(srv + 1);
+        const PID pmt_pid = PID(0x0100 + srv);
+        PMT pmt(0, true, service_id);
+        pat.pmts[service_id] = pmt_pid;
+        for (size_t es = 0; es < streams; ++es) {
+            Stream st;
+            st.pid = PID(0x1000 + srv * MAX_STREAMS + es);
+            st.pcr = es == 0;
+            st.stream_id = uint8_t(es == 0 ? int(SID_VIDEO) : int(SID_AUDIO + es - 1));
+            st.pes_packets = es == 0 ? VIDEO_PES_PACKETS : AUDIO_PES_PACKETS;
+            st.weight = streams == 1 ? 1 : (es == 0 ? video_percent * int(streams - 1) : 100 - video_percent);
+            _total_weight += st.weight;
+            pmt.streams[st.pid].stream_type = es == 0 ? ST_AVC_VIDEO : ST_MPEG2_AUDIO;
+            if (st.pcr) {
+                pmt.pcr_pid = st.pid;
+            }
+            _streams.push_back(st);
+        }
+        OneShotPacketizer pzer(pmt_pid);
+        pzer.addTable(pmt);
+        TSPacketVector packets;
+        pzer.getPackets(packets);
+        pmt_packets.insert(pmt_packets.end(), packets.begin(), packets.end());
+    }
+
+    // A PSI cycle is the PAT, followed by all PMT's.
+    OneShotPacketizer pzer(PID_PAT);
+    pzer.addTable(pat);
+    pzer.getPackets(_psi);
+    _psi.insert(_psi.end(), pmt_packets.begin(), pmt_packets.end());
+    _psi_index = _psi.size();
+
+    tsp->verbose(u"generating %d services, %d PID's, %d PSI packets per cycle", {services, _streams.size(), _psi.size()});
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the nominal bitrate.
+//----------------------------------------------------------------------------
+
+ts::BitRate ts::SyntheticInput::getBitrate()
+{
+    return _bitrate;
+}
+
+
+//----------------------------------------------------------------------------
+// Current time in PCR units of the next packet to generate.
+//----------------------------------------------------------------------------
+
+uint64_t ts::SyntheticInput::currentPCR() const
+{
+    // Split the computation to avoid overflows.
+    const uint64_t bits = _count * PKT_SIZE * 8;
+    return (bits / _bitrate) * SYSTEM_CLOCK_FREQ + ((bits % _bitrate) * SYSTEM_CLOCK_FREQ) / _bitrate;
+}
+
+
+//----------------------------------------------------------------------------
+// Build the next elementary stream packet.
+//----------------------------------------------------------------------------
+
+void ts::SyntheticInput::buildStreamPacket(TSPacket& pkt, uint64_t pcr)
+{
+    // Select the PID using a smooth weighted round robin on all streams.
+    Stream* st = &_streams[0];
+    for (StreamVector::iterator it = _streams.begin(); it != _streams.end(); ++it) {
+        it->current += it->weight;
+        if (it->current > st->current) {
+            st = &*it;
+        }
+    }
+    st->current -= _total_weight;
+
+    // Packet header.
+    const bool start = st->pes_index == 0;
+    const bool with_pcr = st->pcr && pcr >= st->next_pcr;
+    uint8_t* data = pkt.b;
+    data[0] = SYNC_BYTE;
+    data[1] = uint8_t((start ? 0x40 : 0x00) | (st->pid >> 8));
+    data[2] = uint8_t(st->pid);
+    data[3] = uint8_t((with_pcr ? 0x30 : 0x10) | st->cc);
+    st->cc = (st->cc + 1) & CC_MASK;
+    data += 4;
+
+    // Optional adaptation field with a PCR.
+    if (with_pcr) {
+        *data++ = 1 + PCR_SIZE;  // adaptation_field_length
+        *data++ = 0x10;          // PCR_flag
+        PutPCR(data, pcr);
+        data += PCR_SIZE;
+        st->next_pcr = pcr + _pcr_interval;
+    }
+
+    // Optional PES header with a PTS, unbounded PES packet length.
+    if (start) {
+        const uint64_t pts = (pcr / SYSTEM_CLOCK_SUBFACTOR) & PTS_DTS_MASK;
+        *data++ = 0x00;
+        *data++ = 0x00;
+        *data++ = 0x01;
+        *data++ = st->stream_id;
+        *data++ = 0x00;  // PES_packet_length
+        *data++ = 0x00;
+        *data++ = 0x80;  // '10', flags
+        *data++ = 0x80;  // PTS_DTS_flags = '10'
+        *data++ = 0x05;  // PES_header_data_length
+        *data++ = uint8_t(0x21 | ((pts >> 29) & 0x0E));
+        *data++ = uint8_t(pts >> 22);
+        *data++ = uint8_t(0x01 | ((pts >> 14) & 0xFE));
+        *data++ = uint8_t(pts >> 7);
+        *data++ = uint8_t(0x01 | ((pts << 1) & 0xFE));
+    }
+    st->pes_index = (st->pes_index + 1) % st->pes_packets;
+
+    // Dummy payload.
+    ::memset(data, 0xFF, pkt.b + PKT_SIZE - data);
+}
+
+
+//----------------------------------------------------------------------------
+// Input method
+//----------------------------------------------------------------------------
+
+size_t ts::SyntheticInput::receive(TSPacket* buffer, size_t max_packets)
+{
+    // If "joint termination" reached for this plugin
+    if (_count >= _max_count && tsp->useJointTermination()) {
+        // Declare terminated
+        tsp->jointTerminate();
+        // Continue generating packets until completion of tsp (suppress max packet count)
+        _max_count = std::numeric_limits<PacketCounter>::max();
+    }
+
+    size_t n = 0;
+    for (; n < max_packets && _count < _max_count; ++n, ++_count) {
+        const uint64_t pcr = currentPCR();
+
+        // Start a new PSI cycle when due.
+        if (_psi_index >= _psi.size() && pcr >= _next_psi) {
+            _psi_index = 0;
+            _next_psi = pcr + _psi_interval;
+        }
+
+        if (_psi_index < _psi.size()) {
+            // Insert the next PSI packet with the continuity counter of its PID.
+            buffer[n] = _psi[_psi_index++];
+            const PID pid = buffer[n].getPID();
+            buffer[n].setCC(_psi_cc[pid]);
+            _psi_cc[pid] = (_psi_cc[pid] + 1) & CC_MASK;
+        }
+        else {
+            // Distribute the null packets evenly.
+            _null_acc += _null_percent;
+            if (_null_acc >= 100) {
+                _null_acc -= 100;
+                buffer[n] = NullPacket;
+            }
+            else {
+                buildStreamPacket(buffer[n], pcr);
+            }
+        }
+    }
+    return n;
+}
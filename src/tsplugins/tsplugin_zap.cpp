@@ -41,6 +41,7 @@
 #include "tsPMT.h"
 #include "tsCAT.h"
 #include "tsSDT.h"
+#include "tsTableViews.h"
 TSDUCK_SOURCE;
 
 
@@ -90,10 +91,10 @@ namespace ts {
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
 
         // Process specific tables
-        void processPAT(PAT&);
+        void processPAT(const BinaryTable&);
         void processCAT(CAT&);
         void processPMT(PMT&);
-        void processSDT(SDT&);
+        void processSDT(const BinaryTable&);
 
         // Analyze a list of descriptors, looking for CA descriptors.
         // All PIDs which are referenced in CA descriptors are set with the specified state.
@@ -253,10 +254,7 @@ void ts::ZapPlugin::handleTable (SectionDemux& demux, const BinaryTable& table)
 
         case TID_PAT: {
             if (table.sourcePID() == PID_PAT) {
-                PAT pat(table);
-                if (pat.isValid()) {
-                    processPAT(pat);
-                }
+                processPAT(table);
             }
             break;
         }
@@ -273,18 +271,18 @@ void ts::ZapPlugin::handleTable (SectionDemux& demux, const BinaryTable& table)
 
         case TID_SDT_ACT: {
             if (table.sourcePID() == PID_SDT) {
-                SDT sdt(table);
-                if (sdt.isValid()) {
-                    processSDT(sdt);
-                }
+                processSDT(table);
             }
             break;
         }
 
         case TID_PMT: {
-            PMT pmt(table);
-            if (pmt.isValid() && _service.hasId(pmt.service_id)) {
-                processPMT(pmt);
+            // Deserialize the PMT of the zap service only.
+            if (_service.hasId(table.tableIdExtension())) {
+                PMT pmt(table);
+                if (pmt.isValid()) {
+                    processPMT(pmt);
+                }
             }
             break;
         }
@@ -303,19 +301,25 @@ void ts::ZapPlugin::handleTable (SectionDemux& demux, const BinaryTable& table)
 //  all descriptors for the service).
 //----------------------------------------------------------------------------
 
-void ts::ZapPlugin::processSDT (SDT& sdt)
+void ts::ZapPlugin::processSDT(const BinaryTable& table)
 {
-    // Look for the service by name or by service
-
-    bool found;
-    uint16_t service_id;
-
-    if (_service.hasName()) {
-        found = sdt.findService(_service.getName(), service_id);
-    }
-    else {
-        service_id = _service.getId();
-        found = sdt.services.find(service_id) != sdt.services.end();
+    // Look for the service by name or by service id, directly in the
+    // SDT sections. The other services are never deserialized.
+
+    bool found = false;
+    uint16_t service_id = _service.hasName() ? 0 : _service.getId();
+    SDTView::Service service;
+
+    for (size_t si = 0; !found && si < table.sectionCount(); ++si) {
+        const SDTView sdt(*table.sectionAt(si));
+        const SDTView::ServiceLoop services(sdt.services());
+        for (SDTView::ServiceLoop::const_iterator it = services.begin(); !found && it != services.end(); ++it) {
+            found = _service.hasName() ? it->serviceName().similar(_service.getName()) : it->serviceId() == service_id;
+            if (found) {
+                service_id = it->serviceId();
+                service = *it;
+            }
+        }
     }
 
     // If service not found in SDT and not already found in PAT, error
@@ -360,22 +364,17 @@ void ts::ZapPlugin::processSDT (SDT& sdt)
         tsp->verbose(u"found service \"%s\", service id is 0x%X", {_service.getName(), _service.getId()});
     }
 
-    // Remove all other services from the SDT
-
-    SDT::ServiceMap::iterator it(sdt.services.find(_service.getId()));
-    if (it == sdt.services.end()) {
-        // Service not present in SDT
-        sdt.services.clear();
-    }
-    else {
-        // Remove other services before zap service
-        sdt.services.erase(sdt.services.begin(), it);
-        // Remove other services after zap service
-        it = sdt.services.begin();
-        assert(it != sdt.services.end());
-        assert(it->first == _service.getId());
-        sdt.services.erase(++it, sdt.services.end());
-        assert (sdt.services.size() == 1);
+    // Build a new SDT containing the zap service only (or no service if not present).
+
+    const Section& sect(*table.sectionAt(0));
+    SDT sdt(true, sect.version(), sect.isCurrent(), sect.tableIdExtension(), SDTView(sect).originalNetworkId());
+    if (found) {
+        SDT::Service& serv(sdt.services[service_id]);
+        serv.EITs_present = service.EITsPresent();
+        serv.EITpf_present = service.EITpfPresent();
+        serv.running_status = service.runningStatus();
+        serv.CA_controlled = service.CAControlled();
+        serv.descs.add(service.descriptors().data(), service.descriptors().size());
     }
 
     // Build the list of TS packets containing the new SDT.
@@ -394,16 +393,19 @@ void ts::ZapPlugin::processSDT (SDT& sdt)
 //  This method processes a Program Association Table (PAT).
 //----------------------------------------------------------------------------
 
-void ts::ZapPlugin::processPAT (PAT& pat)
+void ts::ZapPlugin::processPAT(const BinaryTable& table)
 {
-    // Locate the service in the PAT
+    // Locate the service in the PAT sections.
 
     assert (_service.hasId());
-    PAT::ServiceMap::iterator it = pat.pmts.find (_service.getId());
+    PID pmt_pid = PID_NULL;
+    for (size_t si = 0; pmt_pid == PID_NULL && si < table.sectionCount(); ++si) {
+        pmt_pid = PATView(*table.sectionAt(si)).pmtPID(_service.getId());
+    }
 
     // If service not found, error
 
-    if (it == pat.pmts.end()) {
+    if (pmt_pid == PID_NULL) {
         tsp->error(u"service id 0x%X not found in PAT", {_service.getId()});
         _abort = true;
         return;
@@ -412,7 +414,7 @@ void ts::ZapPlugin::processPAT (PAT& pat)
     // If the PMT PID was previously unknown wait for the PMT.
     // If the PMT PID was known but was different, we need to rescan the PMT.
 
-    if (!_service.hasPMTPID (it->second)) {
+    if (!_service.hasPMTPID (pmt_pid)) {
 
         if (_service.hasPMTPID()) {
             // The PMT PID was previously known but has changed.
@@ -430,21 +432,17 @@ void ts::ZapPlugin::processPAT (PAT& pat)
             }
         }
 
-        _service.setPMTPID(it->second);
-        _demux.addPID(it->second);
+        _service.setPMTPID(pmt_pid);
+        _demux.addPID(pmt_pid);
 
         tsp->verbose(u"found service id 0x%X, PMT PID is 0x%X", {_service.getId(), _service.getPMTPID()});
     }
 
-    // Remove all other services from the PAT
+    // Build a new PAT containing the zap service only, without NIT.
 
-    pat.pmts.erase (pat.pmts.begin(), it);
-    it = pat.pmts.begin();
-    assert (it != pat.pmts.end());
-    assert (it->first == _service.getId());
-    pat.pmts.erase (++it, pat.pmts.end());
-    assert (pat.pmts.size() == 1);
-    pat.nit_pid = PID_NULL;
+    const Section& sect(*table.sectionAt(0));
+    PAT pat(sect.version(), sect.isCurrent(), sect.tableIdExtension(), PID_NULL);
+    pat.pmts[_service.getId()] = pmt_pid;
 
     // Build the list of TS packets containing the new PAT.
     // These packets will replace everything on the PAT PID.
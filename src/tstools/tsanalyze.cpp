@@ -33,7 +33,7 @@
 
 #include "tsTSAnalyzerReport.h"
 #include "tsTSAnalyzerOptions.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileInputArgs.h"
 #include "tsVersionInfo.h"
 TSDUCK_SOURCE;
 
@@ -48,15 +48,18 @@ struct Options: public ts::TSAnalyzerOptions
 
     ts::BitRate bitrate;  // Expected bitrate (188-byte packets)
     ts::UString infile;   // Input file name
+    ts::TSFileInputArgs input;  // Input file options
 };
 
 Options::Options(int argc, char *argv[]) :
     ts::TSAnalyzerOptions(u"MPEG Transport Stream Analysis Utility.", u"[options] [filename]"),
     bitrate(0),
-    infile()
+    infile(),
+    input()
 {
     option(u"",         0,  Args::STRING, 0, 1);
     option(u"bitrate", 'b', Args::UNSIGNED);
+    input.defineOptions(*this);
 
     setHelp(u"Input file:\n"
             u"\n"
@@ -79,16 +82,38 @@ Options::Options(int argc, char *argv[]) :
             u"\n"
             u"  --version\n"
             u"      Display the version number.\n");
+    input.addHelp(*this);
 
     analyze(argc, argv);
 
     infile = value(u"");
     bitrate = intValue<ts::BitRate>(u"bitrate");
+    input.load(*this);
 
     exitOnError();
 }
 
 
+//----------------------------------------------------------------------------
+//  Pass all packets to the analyzer.
+//----------------------------------------------------------------------------
+
+class AnalyzerHandler: public ts::TSPacketHandlerInterface
+{
+public:
+    AnalyzerHandler(ts::TSAnalyzer& analyzer) : _analyzer(analyzer) {}
+
+    virtual bool handleTSPacket(const ts::TSPacket& pkt) override
+    {
+        _analyzer.feedPacket(pkt);
+        return true;
+    }
+
+private:
+    ts::TSAnalyzer& _analyzer;
+};
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -98,13 +123,13 @@ int main(int argc, char *argv[])
     TSDuckLibCheckVersion();
     Options opt(argc, argv);
     ts::TSAnalyzerReport analyzer(opt.bitrate);
-    ts::InputRedirector input(opt.infile, opt);
-    ts::TSPacket pkt;
 
     analyzer.setAnalysisOptions(opt);
 
-    while (pkt.read(std::cin, true, opt)) {
-        analyzer.feedPacket(pkt);
+    // Read all packets in the file and pass them to the analyzer.
+    AnalyzerHandler handler(analyzer);
+    if (!opt.input.readPackets(opt.infile, handler, opt)) {
+        return EXIT_FAILURE;
     }
 
     analyzer.report(std::cout, opt);
@@ -32,7 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsArgs.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileInputArgs.h"
 #include "tsPCRAnalyzer.h"
 #include "tsVersionInfo.h"
 TSDUCK_SOURCE;
@@ -54,6 +54,7 @@ struct Options: public ts::Args
     bool        full;        // Full analysis
     bool        value_only;  // Output value only
     ts::UString infile;      // Input file name
+    ts::TSFileInputArgs input;  // Input file options
 };
 
 Options::Options(int argc, char *argv[]) :
@@ -65,7 +66,8 @@ Options::Options(int argc, char *argv[]) :
     all(false),
     full(false),
     value_only(false),
-    infile()
+    infile(),
+    input()
 {
     option(u"",            0, Args::STRING, 0, 1);
     option(u"all",        'a');
@@ -74,6 +76,7 @@ Options::Options(int argc, char *argv[]) :
     option(u"min-pcr",     0, Args::POSITIVE);
     option(u"min-pid",     0, Args::INTEGER, 0, 1, 1, ts::PID_MAX);
     option(u"value-only", 'v');
+    input.defineOptions(*this);
 
     setHelp(u"Input file:\n"
             u"\n"
@@ -116,6 +119,7 @@ Options::Options(int argc, char *argv[]) :
             u"\n"
             u"  --version\n"
             u"      Display the version number.\n");
+    input.addHelp(*this);
 
     analyze(argc, argv);
 
@@ -127,11 +131,32 @@ Options::Options(int argc, char *argv[]) :
     min_pid = intValue<uint16_t>(u"min-pid", 1);
     use_dts = present(u"dts");
     pcr_name = use_dts ? u"DTS" : u"PCR";
+    input.load(*this);
 
     exitOnError();
 }
 
 
+//----------------------------------------------------------------------------
+//  Pass packets to the PCR analyzer until enough PCR are collected.
+//----------------------------------------------------------------------------
+
+class BitrateHandler: public ts::TSPacketHandlerInterface
+{
+public:
+    BitrateHandler(ts::PCRAnalyzer& zer, bool all) : _zer(zer), _all(all) {}
+
+    virtual bool handleTSPacket(const ts::TSPacket& pkt) override
+    {
+        return !_zer.feedPacket(pkt) || _all;
+    }
+
+private:
+    ts::PCRAnalyzer& _zer;
+    bool _all;
+};
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -141,16 +166,16 @@ int main(int argc, char *argv[])
     TSDuckLibCheckVersion();
     Options opt(argc, argv);
     ts::PCRAnalyzer zer(opt.min_pid, opt.min_pcr);
-    ts::InputRedirector input(opt.infile, opt);
-    ts::TSPacket pkt;
-
     // Reset analyzer for DTS with --dts
     if (opt.use_dts) {
         zer.resetAndUseDTS (opt.min_pid, opt.min_pcr);
     }
 
     // Read all packets in the file and pass them to the PCR analyzer.
-    while (pkt.read(std::cin, true, opt) && (!zer.feedPacket(pkt) || opt.all)) {}
+    BitrateHandler handler(zer, opt.all);
+    if (!opt.input.readPackets(opt.infile, handler, opt)) {
+        return EXIT_FAILURE;
+    }
 
     // Display results.
     ts::PCRAnalyzer::Status status;
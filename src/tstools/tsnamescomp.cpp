@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Names configuration files compiler
+//
+//----------------------------------------------------------------------------
+
+#include "tsArgs.h"
+#include "tsNames.h"
+#include "tsSysUtils.h"
+#include "tsReportWithPrefix.h"
+#include "tsVersionInfo.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+//  Command line options
+//----------------------------------------------------------------------------
+
+struct Options: public ts::Args
+{
+    Options(int argc, char *argv[]);
+
+    ts::UStringVector infiles;  // Input file names.
+    ts::UString       outfile;  // Output file path.
+    bool              outdir;   // Output name is a directory.
+};
+
+Options::Options(int argc, char *argv[]) :
+    ts::Args(u"Names configuration files compiler.", u"[options] filename ..."),
+    infiles(),
+    outfile(),
+    outdir(false)
+{
+    option(u"",        0,  ts::Args::STRING, 1, ts::Args::UNLIMITED_COUNT);
+    option(u"output", 'o', ts::Args::STRING);
+
+    setHelp(u"Input files:\n"
+            u"\n"
+            u"  Names configuration files, typically tsduck.dvb.names and tsduck.oui.names,\n"
+            u"  to compile into binary index files. A binary index is used by all TSDuck\n"
+            u"  commands instead of the text file with the same name, unless the text\n"
+            u"  file is more recent than the index.\n"
+            u"\n"
+            u"Options:\n"
+            u"\n"
+            u"  --help\n"
+            u"      Display this help text.\n"
+            u"\n"
+            u"  -o filepath\n"
+            u"  --output filepath\n"
+            u"      Specify the output file name. By default, the output file has the same\n"
+            u"      name as the input with an additional extension .bin. If the specified\n"
+            u"      path is a directory, the output file is built from this directory and\n"
+            u"      default file name. If more than one input file is specified, the output\n"
+            u"      path, if present, must be a directory name.\n"
+            u"\n"
+            u"  -v\n"
+            u"  --verbose\n"
+            u"      Produce verbose output.\n"
+            u"\n"
+            u"  --version\n"
+            u"      Display the version number.\n");
+
+    analyze(argc, argv);
+
+    getValues(infiles, u"");
+    getValue(outfile, u"output");
+    outdir = !outfile.empty() && ts::IsDirectory(outfile);
+
+    if (infiles.size() > 1 && !outfile.empty() && !outdir) {
+        error(u"with more than one input file, --output must be a directory");
+    }
+
+    exitOnError();
+}
+
+
+//----------------------------------------------------------------------------
+//  Compile one file. Return true on success, false on error.
+//----------------------------------------------------------------------------
+
+bool CompileFile(Options& opt, const ts::UString& infile)
+{
+    // Compute output file name.
+    ts::UString outname(opt.outfile);
+    if (outname.empty()) {
+        outname = infile + ts::Names::INDEX_SUFFIX;
+    }
+    else if (opt.outdir) {
+        outname += ts::PathSeparator + ts::BaseName(infile) + ts::Names::INDEX_SUFFIX;
+    }
+
+    opt.verbose(u"Compiling %s to %s", {infile, outname});
+    ts::ReportWithPrefix report(opt, ts::BaseName(infile) + u": ");
+
+    // The input must be loaded as a text file, not from an existing index.
+    if (!ts::FileExists(infile)) {
+        report.error(u"file not found");
+        return false;
+    }
+    ts::Names names(infile, false);
+    if (names.errorCount() > 0) {
+        report.error(u"%d errors in file, not compiled", {names.errorCount()});
+        return false;
+    }
+    return names.saveIndex(outname, report);
+}
+
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    TSDuckLibCheckVersion();
+    Options opt(argc, argv);
+    bool ok = true;
+    for (size_t i = 0; i < opt.infiles.size(); ++i) {
+        if (!opt.infiles[i].empty()) {
+            ok = CompileFile(opt, opt.infiles[i]) && ok;
+        }
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -36,10 +36,13 @@
 #include "tspInputExecutor.h"
 #include "tspOutputExecutor.h"
 #include "tspProcessorExecutor.h"
+#include "tspMetrics.h"
 #include "tsAsyncReport.h"
 #include "tsSystemMonitor.h"
 #include "tsMonotonic.h"
 #include "tsResidentBuffer.h"
+#include "tsSysUtils.h"
+#include "tsSafePtr.h"
 #include "tsIPUtils.h"
 #include "tsVersionInfo.h"
 TSDUCK_SOURCE;
@@ -87,6 +90,35 @@ void ts::tsp::TSPInterruptHandler::handleInterrupt()
 }
 
 
+//----------------------------------------------------------------------------
+//  Report the throughput and CPU time of all plugins (option --benchmark).
+//----------------------------------------------------------------------------
+
+namespace {
+    void BenchmarkReport(ts::Report& report, ts::tsp::PluginExecutor* input, ts::NanoSecond duration)
+    {
+        // The initial load of the buffer is not passed by the input. All packets are passed by each output.
+        const ts::PacketCounter packets = input->ringPrevious<ts::tsp::PluginExecutor>()->passedPackets();
+        const ts::NanoSecond elapsed = std::max<ts::NanoSecond>(1, duration);
+
+        report.info(u"tsp: benchmark: %'d packets in %'d ms, %'d packets/s, %'d b/s",
+                    {packets, duration / ts::NanoSecPerMilliSec,
+                     uint64_t((double(packets) * double(ts::NanoSecPerSec)) / double(elapsed)),
+                     uint64_t((double(packets * ts::PKT_SIZE * 8) * double(ts::NanoSecPerSec)) / double(elapsed))});
+
+        size_t index = 0;
+        ts::tsp::PluginExecutor* proc = input;
+        do {
+            const ts::NanoSecond cpu = proc->cpuTime();
+            report.info(u"tsp: benchmark: plugin %d (%s): CPU time: %'d ms, %s of elapsed time, %'d ns/packet",
+                        {index++, proc->pluginName(), cpu / ts::NanoSecPerMilliSec,
+                         ts::UString::Percentage(cpu, elapsed),
+                         packets == 0 ? 0 : cpu / ts::NanoSecond(packets)});
+        } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -130,12 +162,30 @@ int main(int argc, char *argv[])
     // high as the input which must remain the top-most priority?
 
     ts::tsp::InputExecutor* input = new ts::tsp::InputExecutor(&opt, &opt.input, ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()), global_mutex);
-    ts::tsp::OutputExecutor* output = new ts::tsp::OutputExecutor(&opt, &opt.output, ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), global_mutex);
-    output->ringInsertAfter(input);
+    std::vector<ts::tsp::OutputExecutor*> outputs;
+
+    // The main chain of processors and output is the first branch. All branches start
+    // after the input and terminate in the input. All executors are in one single ring,
+    // one branch after the other, in the order of the command line.
+
+    for (size_t branch = 0; branch <= opt.branches.size(); ++branch) {
+
+        const ts::tsp::Options::PluginOptionsVector& plugins(branch == 0 ? opt.plugins : opt.branches[branch - 1].plugins);
+        const ts::tsp::Options::PluginOptions& output_options(branch == 0 ? opt.output : opt.branches[branch - 1].output);
+        ts::tsp::PluginExecutor* previous = input;
+
+        for (ts::tsp::Options::PluginOptionsVector::const_iterator it = plugins.begin(); it != plugins.end(); ++it) {
+            ts::tsp::PluginExecutor* p = new ts::tsp::ProcessorExecutor(&opt, &*it, ts::ThreadAttributes(), global_mutex);
+            p->ringInsertBefore(input);
+            p->connectAfter(previous);
+            previous = p;
+        }
 
-    for (ts::tsp::Options::PluginOptionsVector::const_iterator it = opt.plugins.begin(); it != opt.plugins.end(); ++it) {
-        ts::tsp::PluginExecutor* p = new ts::tsp::ProcessorExecutor(&opt, &*it, ts::ThreadAttributes(), global_mutex);
-        p->ringInsertBefore(output);
+        ts::tsp::OutputExecutor* output = new ts::tsp::OutputExecutor(&opt, &output_options, ts::ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), global_mutex);
+        output->ringInsertBefore(input);
+        output->connectAfter(previous);
+        input->connectAfter(output);
+        outputs.push_back(output);
     }
 
     // Exit on error when initializing the plugins
@@ -153,37 +203,90 @@ int main(int argc, char *argv[])
         proc->setMaxSeverity(report.maxSeverity());
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
+    // With --numa-buffer, the buffers are allocated on the NUMA node of the input plugin thread.
+
+    int numa_node = -1;
+    if (opt.numa_buffer) {
+        if (opt.input.affinity.empty()) {
+            report.warning(u"tsp: --numa-buffer ignored, no --affinity for the input plugin");
+        }
+        else {
+            numa_node = ts::NUMANodeOfCPU(*opt.input.affinity.begin());
+            report.verbose(u"tsp: allocating buffers on NUMA node %d", {numa_node});
+        }
+    }
+
     // Allocate a memory-resident buffer of TS packets
 
-    ts::ResidentBuffer<ts::TSPacket> packet_buffer(opt.bufsize / ts::PKT_SIZE);
+    ts::ResidentBuffer<ts::TSPacket> packet_buffer(opt.bufsize / ts::PKT_SIZE, numa_node);
 
     if (!packet_buffer.isLocked()) {
         report.verbose(u"tsp: buffer failed to lock into physical memory (%d: %s), risk of real-time issue",
                        {packet_buffer.lockErrorCode(), ts::ErrorCodeMessage(packet_buffer.lockErrorCode())});
     }
+    if (packet_buffer.numaErrorCode() != ts::SYS_SUCCESS) {
+        report.warning(u"tsp: cannot allocate buffer on NUMA node %d (%d: %s)",
+                       {numa_node, packet_buffer.numaErrorCode(), ts::ErrorCodeMessage(packet_buffer.numaErrorCode())});
+    }
     report.debug(u"tsp: buffer size: %'d TS packets, %'d bytes", {packet_buffer.count(), packet_buffer.count() * ts::PKT_SIZE});
 
-    // Start all processors, except output, in reverse order (input last).
+    // Each additional branch has its own copy of the packets, so that the processors
+    // of a branch can modify them without interfering with the other branches.
+
+    std::vector<ts::SafePtr<ts::ResidentBuffer<ts::TSPacket>>> branch_buffers;
+    std::vector<ts::tsp::PluginExecutor::PacketBuffer*> packets;
+    packets.push_back(&packet_buffer);
+
+    for (size_t branch = 1; branch < outputs.size(); ++branch) {
+        branch_buffers.push_back(new ts::ResidentBuffer<ts::TSPacket>(packet_buffer.count(), numa_node));
+        packets.push_back(branch_buffers.back().pointer());
+        if (!packets.back()->isLocked()) {
+            report.verbose(u"tsp: branch buffer failed to lock into physical memory (%d: %s), risk of real-time issue",
+                           {packets.back()->lockErrorCode(), ts::ErrorCodeMessage(packets.back()->lockErrorCode())});
+        }
+    }
+
+    // Allocate memory-resident buffers of packet metadata, parallel to the packet buffer.
+    // There is one metadata buffer per branch.
+
+    std::vector<ts::SafePtr<ts::ResidentBuffer<ts::TSPacketMetadata>>> metadata_buffers;
+    std::vector<ts::tsp::PluginExecutor::PacketMetadataBuffer*> metadata;
+
+    for (size_t branch = 0; branch < outputs.size(); ++branch) {
+        metadata_buffers.push_back(new ts::ResidentBuffer<ts::TSPacketMetadata>(packet_buffer.count(), numa_node));
+        metadata.push_back(metadata_buffers.back().pointer());
+        if (!metadata.back()->isLocked()) {
+            report.verbose(u"tsp: metadata buffer failed to lock into physical memory (%d: %s), risk of real-time issue",
+                           {metadata.back()->lockErrorCode(), ts::ErrorCodeMessage(metadata.back()->lockErrorCode())});
+        }
+    }
+
+    // Start all processors, except outputs, in reverse order (input last).
     // Exit application in case of error.
 
-    for (proc = output->ringPrevious<ts::tsp::PluginExecutor>(); proc != output; proc = proc->ringPrevious<ts::tsp::PluginExecutor>()) {
-        if (!proc->plugin()->start()) {
+    for (proc = input->ringPrevious<ts::tsp::PluginExecutor>(); ; proc = proc->ringPrevious<ts::tsp::PluginExecutor>()) {
+        if (std::find(outputs.begin(), outputs.end(), proc) == outputs.end() && !proc->plugin()->start()) {
             return EXIT_FAILURE;
         }
+        if (proc == input) {
+            break;
+        }
     }
 
     // Initialize packet buffer in the ring of executors.
     // Exit application in case of error.
 
-    if (!input->initAllBuffers(&packet_buffer)) {
+    if (!input->initAllBuffers(packets, metadata)) {
         return EXIT_FAILURE;
     }
 
-    // Start the output device (we now have an idea of the bitrate).
+    // Start the output devices (we now have an idea of the bitrate).
     // Exit application in case of error.
 
-    if (!output->plugin()->start()) {
-        return EXIT_FAILURE;
+    for (size_t branch = 0; branch < outputs.size(); ++branch) {
+        if (!outputs[branch]->plugin()->start()) {
+            return EXIT_FAILURE;
+        }
     }
 
     // Use a Ctrl+C interrupt handler
@@ -198,13 +301,35 @@ int main(int argc, char *argv[])
         monitor.start();
     }
 
-    // Create all plugin executors threads.
+    // Start the metrics of the plugins if required.
+
+    ts::tsp::Metrics metrics(opt, input, packet_buffer.count(), report);
+    if (!metrics.start()) {
+        return EXIT_FAILURE;
+    }
+
+    // Create all plugin executors threads. If a thread cannot be created (typically
+    // a real-time scheduling without the required privileges), abort all threads.
+
+    ts::Monotonic start_time;
+    start_time.getSystemTime();
 
+    bool success = true;
     proc = input;
     do {
-        proc->start();
+        if (!proc->start()) {
+            report.error(u"tsp: cannot start the thread of plugin %s, check --affinity and --realtime", {proc->pluginName()});
+            success = false;
+        }
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
+    if (!success) {
+        proc = input;
+        do {
+            proc->setAbort();
+        } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
+    }
+
     // Wait for threads to terminate
 
     proc = input;
@@ -212,6 +337,18 @@ int main(int argc, char *argv[])
         proc->waitForTermination();
     } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != input);
 
+    // Stop the metrics before deallocating the plugin executors.
+
+    metrics.stop();
+
+    // Report the benchmark results.
+
+    if (opt.benchmark && success) {
+        ts::Monotonic end_time;
+        end_time.getSystemTime();
+        BenchmarkReport(report, input, end_time - start_time);
+    }
+
     // Deallocate all plugins and plugin executor
 
     bool last;
@@ -224,5 +361,5 @@ int main(int argc, char *argv[])
         proc = next;
     } while (!last);
 
-    return EXIT_SUCCESS;
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
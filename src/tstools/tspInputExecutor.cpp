@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tspInputExecutor.h"
+#include "tsSysUtils.h"
 #include "tsPCRAnalyzer.h"
 #include "tsTime.h"
 TSDUCK_SOURCE;
@@ -56,7 +57,8 @@ ts::tsp::InputExecutor::InputExecutor(Options* options,
     _total_in_packets(0),
     _in_sync_lost(false),
     _instuff_nullpkt_remain(0),
-    _instuff_inpkt_remain(0)
+    _instuff_inpkt_remain(0),
+    _start_time()
 {
     assert(!isLoaded() || _input != 0);
 }
@@ -71,10 +73,18 @@ ts::tsp::InputExecutor::InputExecutor(Options* options,
 // Return true on success, false on error.
 //----------------------------------------------------------------------------
 
-bool ts::tsp::InputExecutor::initAllBuffers(PacketBuffer* buffer)
+bool ts::tsp::InputExecutor::initAllBuffers(const std::vector<PacketBuffer*>& buffers, const std::vector<PacketMetadataBuffer*>& metadata)
 {
+    assert(buffers.size() == successorCount());
+    assert(metadata.size() == successorCount());
+    PacketBuffer* const buffer = buffers[0];
+
+    // Input time stamps are relative to the start of the input.
+    _start_time.getSystemTime();
+
     // Pre-load half of the buffer with packets from the input device.
-    const size_t pkt_read = receiveAndStuff(buffer->base(), buffer->count() / 2);
+    // The input executor uses the packet and metadata buffers of the first branch.
+    const size_t pkt_read = receiveAndStuff(buffer->base(), metadata[0]->base(), buffer->count() / 2);
 
     if (pkt_read == 0) {
         return false; // receive error
@@ -115,19 +125,21 @@ bool ts::tsp::InputExecutor::initAllBuffers(PacketBuffer* buffer)
         verbose(u"input bitrate is %'d b/s", {init_bitrate});
     }
 
-    // Indicate that the loaded packets are now available to the next packet processor.
-    PluginExecutor* next = ringNext<PluginExecutor>();
-    next->initBuffer(buffer, 0, pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
-
     // The rest of the buffer belongs to this input processor for reading
-    // additional packets. All other processors have an implicit empty buffer
-    // (_pkt_first and _pkt_cnt are zero).
-    initBuffer(buffer, pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
-
-    // Propagate initial input bitrate to all processors
-    while ((next = next->ringNext<PluginExecutor>()) != this) {
-        next->initBuffer(buffer, 0, 0, pkt_read == 0, pkt_read == 0, init_bitrate);
+    // additional packets.
+    initBuffer(buffer, metadata[0], pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate, &_start_time);
+
+    // Indicate that the loaded packets are now available to the first packet processor
+    // of each branch. All other processors have an implicit empty buffer (_pkt_first and
+    // _pkt_cnt are zero). Propagate initial input bitrate to all processors.
+    for (size_t i = 0; i < successorCount(); ++i) {
+        size_t pkt_cnt = pkt_read;
+        for (PluginExecutor* next = successor(i); next != this; next = next->successor(0)) {
+            next->initBuffer(buffers[i], metadata[i], 0, pkt_cnt, pkt_read == 0, pkt_read == 0, init_bitrate, &_start_time);
+            pkt_cnt = 0;
+        }
     }
+    replicatePackets(0, pkt_read);
 
     return true;
 }
@@ -155,10 +167,10 @@ ts::BitRate ts::tsp::InputExecutor::getBitrate()
 
 //----------------------------------------------------------------------------
 // Encapsulation of the plugin's receive() method,
-// checking the validity of the input.
+// checking the validity of the input and setting the metadata.
 //----------------------------------------------------------------------------
 
-size_t ts::tsp::InputExecutor::receiveAndValidate(TSPacket* buffer, size_t max_packets)
+size_t ts::tsp::InputExecutor::receiveAndValidate(TSPacket* buffer, TSPacketMetadata* mdata, size_t max_packets)
 {
     // If synchronization lost, report an error
     if (_in_sync_lost) {
@@ -166,7 +178,21 @@ size_t ts::tsp::InputExecutor::receiveAndValidate(TSPacket* buffer, size_t max_p
     }
 
     // Invoke the plugin receive method
+    startPluginCall();
     size_t count = _input->receive(buffer, max_packets);
+    endPluginCall(count);
+
+    // All packets from one receive operation get the same input time stamp.
+    // This is one clock read per receive, not per packet.
+    if (count > 0) {
+        Monotonic now;
+        now.getSystemTime();
+        const uint64_t time_stamp = uint64_t(now - _start_time);
+        for (size_t n = 0; n < count; ++n) {
+            mdata[n].reset();
+            mdata[n].setInputTimeStamp(time_stamp, NanoSecPerSec);
+        }
+    }
 
     // Validate sync byte (0x47) at beginning of each packet
     for (size_t n = 0; n < count; ++n) {
@@ -203,11 +229,11 @@ size_t ts::tsp::InputExecutor::receiveAndValidate(TSPacket* buffer, size_t max_p
 // taking into account the tsp input stuffing options.
 //----------------------------------------------------------------------------
 
-size_t ts::tsp::InputExecutor::receiveAndStuff(TSPacket* buffer, size_t max_packets)
+size_t ts::tsp::InputExecutor::receiveAndStuff(TSPacket* buffer, TSPacketMetadata* mdata, size_t max_packets)
 {
     // If there is no --add-input-stuffing option, simply call the plugin
     if (_instuff_inpkt == 0) {
-        const size_t count = receiveAndValidate(buffer, max_packets);
+        const size_t count = receiveAndValidate(buffer, mdata, max_packets);
         addTotalPackets(count);
         return count;
     }
@@ -222,6 +248,9 @@ size_t ts::tsp::InputExecutor::receiveAndStuff(TSPacket* buffer, size_t max_pack
         // Stuff null packets.
         while (_instuff_nullpkt_remain > 0 && pkt_remain > 0) {
             *buffer++ = NullPacket;
+            mdata->reset();
+            mdata->setInputStuffing(true);
+            mdata++;
             _instuff_nullpkt_remain--;
             pkt_remain--;
             pkt_done++;
@@ -238,13 +267,14 @@ size_t ts::tsp::InputExecutor::receiveAndStuff(TSPacket* buffer, size_t max_pack
         // Read input packets from the plugin
         max_packets = pkt_remain < _instuff_inpkt_remain ? pkt_remain : _instuff_inpkt_remain;
 
-        size_t pkt_in = receiveAndValidate(buffer, max_packets);
+        size_t pkt_in = receiveAndValidate(buffer, mdata, max_packets);
 
         assert(pkt_in <= pkt_remain);
         assert(pkt_in <= _instuff_inpkt_remain);
         assert(pkt_in <= max_packets);
 
         buffer += pkt_in;
+        mdata += pkt_in;
         pkt_remain -= pkt_in;
         pkt_done += pkt_in;
         pkt_from_input += pkt_in;
@@ -290,8 +320,12 @@ void ts::tsp::InputExecutor::main()
         waitWork(pkt_first, pkt_max, bitrate, input_end, aborted);
 
         // If the next thread has given up, give up too since our packets are now useless.
+        // With branches, the other branches must be notified of the end of input.
 
         if (aborted) {
+            if (successorCount() > 1) {
+                passPackets(0, _tsp_bitrate, true, false);
+            }
             break;
         }
 
@@ -303,11 +337,14 @@ void ts::tsp::InputExecutor::main()
 
         // Now read at most the specified number of packets
 
-        size_t pkt_read = receiveAndStuff(_buffer->base() + pkt_first, pkt_max);
+        size_t pkt_read = receiveAndStuff(_buffer->base() + pkt_first, _metadata->base() + pkt_first, pkt_max);
 
         if (pkt_read == 0) {
             input_end = true;
         }
+        else if (_branches) {
+            replicatePackets(pkt_first, pkt_read);
+        }
 
         // Process periodic bitrate adjustment: get current input bitrate.
         if (_input_bitrate == 0 && (current_time = Time::CurrentUTC()) > bitrate_due_time) {
@@ -333,5 +370,6 @@ void ts::tsp::InputExecutor::main()
     // Close the input processor
     _input->stop();
 
+    _cpu_time = GetThreadCPUTime();
     debug(u"input thread %s after %'d packets", {aborted ? u"aborted" : u"terminated", totalPackets()});
 }
@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tspPluginExecutor.h"
+#include "tsMonotonic.h"
 
 namespace ts {
     namespace tsp {
@@ -64,10 +65,14 @@ namespace ts {
             //!
             //! Must be executed in synchronous environment, before starting all executor threads.
             //!
-            //! @param [out] buffer Packet buffer address.
+            //! @param [out] buffers Packet buffer addresses, one per branch, in the order of the
+            //! successors of this input executor (see connectAfter()). The input executor reads
+            //! the packets in the first one and copies them in the others.
+            //! @param [out] metadata Packet metadata buffer addresses, one per branch, in the
+            //! same order.
             //! @return True on success, false on error.
             //!
-            bool initAllBuffers(PacketBuffer* buffer);
+            bool initAllBuffers(const std::vector<PacketBuffer*>& buffers, const std::vector<PacketMetadataBuffer*>& metadata);
 
         private:
             InputPlugin*      _input;             // Plugin API
@@ -80,17 +85,18 @@ namespace ts {
             bool              _in_sync_lost;      // Input synchronization lost (no 0x47 at start of packet)
             size_t            _instuff_nullpkt_remain;
             size_t            _instuff_inpkt_remain;
+            Monotonic         _start_time;        // Origin of input time stamps
 
             // Inherited from Thread
             virtual void main() override;
 
             // Encapsulation of the plugin's receive() method,
-            // checking the validity of the input.
-            size_t receiveAndValidate (TSPacket* buffer, size_t max_packets);
+            // checking the validity of the input and setting the metadata.
+            size_t receiveAndValidate (TSPacket* buffer, TSPacketMetadata* mdata, size_t max_packets);
 
             // Encapsulation of receiveAndValidate() method,
             // taking into account the tsp input stuffing options.
-            size_t receiveAndStuff (TSPacket* buffer, size_t max_packets);
+            size_t receiveAndStuff (TSPacket* buffer, TSPacketMetadata* mdata, size_t max_packets);
 
             // Encapsulation of the plugin's getBitrate() method,
             // taking into account the tsp input stuffing options.
@@ -0,0 +1,367 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor: Metrics of the plugins
+//
+//----------------------------------------------------------------------------
+
+#include "tspMetrics.h"
+#include "tsGuard.h"
+#include "tsGuardCondition.h"
+#include "tsNullReport.h"
+TSDUCK_SOURCE;
+
+const size_t ts::tsp::Metrics::MAX_REQUEST_SIZE;
+const ts::MilliSecond ts::tsp::Metrics::REQUEST_TIMEOUT;
+
+// Stack size for the metrics threads
+#define METRICS_STACK_SIZE (128 * 1024)
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructor.
+//----------------------------------------------------------------------------
+
+ts::tsp::Metrics::Metrics(const Options& options, PluginExecutor* first, size_t buffer_packets, Report& report) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetMinimumPriority()).setStackSize(METRICS_STACK_SIZE)),
+    _options(options),
+    _first(first),
+    _buffer_packets(buffer_packets),
+    _report(report),
+    _mutex(),
+    _wake_up(),
+    _terminate(false),
+    _logging(false),
+    _server(),
+    _server_thread(this),
+    _client(0)
+{
+}
+
+ts::tsp::Metrics::~Metrics()
+{
+    stop();
+}
+
+ts::tsp::Metrics::Server::Server(Metrics* metrics) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetMinimumPriority()).setStackSize(METRICS_STACK_SIZE)),
+    _metrics(metrics)
+{
+}
+
+ts::tsp::Metrics::Snapshot::Snapshot() :
+    packets(0),
+    busy_ns(0),
+    call_ns(0),
+    wait_ns(0),
+    windows(0),
+    window_packets(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Start the metrics activity.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::Metrics::start()
+{
+    // Start the metrics server.
+    if (!_options.metrics_address.empty()) {
+        SocketAddress addr;
+        if (!addr.resolve(_options.metrics_address, _report)) {
+            return false;
+        }
+        if (!addr.hasPort()) {
+            _report.error(u"tsp: no TCP port specified in --metrics-port %s", {_options.metrics_address});
+            return false;
+        }
+        if (!addr.hasAddress()) {
+            // Listen on the local host only by default.
+            addr.setAddress(IPAddress::LocalHost.address());
+        }
+        if (!_server.open(_report) ||
+            !_server.reusePort(true, _report) ||
+            !_server.bind(addr, _report) ||
+            !_server.listen(5, _report))
+        {
+            _server.close(NULLREP);
+            return false;
+        }
+        _report.verbose(u"tsp: serving metrics on %s", {addr.toString()});
+        if (!_server_thread.start()) {
+            _report.error(u"tsp: cannot start metrics server thread");
+            _server.close(NULLREP);
+            return false;
+        }
+    }
+
+    // Start the periodic logs.
+    if (_options.metrics_interval > 0) {
+        if (!Thread::start()) {
+            _report.error(u"tsp: cannot start metrics thread");
+            return false;
+        }
+        _logging = true;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Stop the metrics activity.
+//----------------------------------------------------------------------------
+
+void ts::tsp::Metrics::stop()
+{
+    if (_logging) {
+        {
+            GuardCondition lock(_mutex, _wake_up);
+            _terminate = true;
+            lock.signal();
+        }
+        waitForTermination();
+        _logging = false;
+    }
+    if (_server.isOpen()) {
+        // Shutting down the current client connection unblocks the server thread in receive() or send().
+        {
+            Guard lock(_mutex);
+            _terminate = true;
+            if (_client != 0) {
+                _client->disconnect(NULLREP);
+            }
+        }
+        // Closing the server socket unblocks the server thread in accept().
+        _server.close(NULLREP);
+        _server_thread.waitForTermination();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Periodic logs, in the Metrics thread.
+//----------------------------------------------------------------------------
+
+void ts::tsp::Metrics::main()
+{
+    std::vector<Snapshot> last;
+    Monotonic last_time;
+    last_time.getSystemTime();
+
+    for (;;) {
+
+        // Wait until due time or termination request.
+        {
+            GuardCondition lock(_mutex, _wake_up);
+            if (!_terminate) {
+                lock.waitCondition(_options.metrics_interval);
+            }
+            if (_terminate) {
+                break;
+            }
+        }
+
+        Monotonic now;
+        now.getSystemTime();
+        const NanoSecond duration = now - last_time;
+        last_time = now;
+
+        // Log one line per plugin, with the difference since the previous log.
+        size_t index = 0;
+        PluginExecutor* proc = _first;
+        do {
+            if (last.size() <= index) {
+                last.resize(index + 1);
+            }
+            const PluginExecutor::Statistics& stats(proc->statistics());
+            Snapshot current;
+            current.packets = proc->passedPackets();
+            current.busy_ns = stats.busy_ns.load(std::memory_order_relaxed);
+            current.call_ns = stats.call_ns.load(std::memory_order_relaxed);
+            current.wait_ns = stats.wait_ns.load(std::memory_order_relaxed);
+            current.windows = stats.windows.load(std::memory_order_relaxed);
+            current.window_packets = stats.window_packets.load(std::memory_order_relaxed);
+
+            const Snapshot& previous(last[index]);
+            const uint64_t windows = current.windows - previous.windows;
+            const PacketCounter packets = current.packets - previous.packets;
+
+            _report.info(u"[METRICS] %d %s: %'d packets/s, busy: %s, in plugin: %s, waiting: %s, window: %s",
+                         {index, proc->pluginName(),
+                          duration <= 0 ? 0 : (packets * NanoSecPerSec) / duration,
+                          UString::Percentage(current.busy_ns - previous.busy_ns, uint64_t(duration)),
+                          UString::Percentage(current.call_ns - previous.call_ns, uint64_t(duration)),
+                          UString::Percentage(current.wait_ns - previous.wait_ns, uint64_t(duration)),
+                          UString::Percentage(current.window_packets - previous.window_packets, windows * uint64_t(_buffer_packets))});
+
+            last[index++] = current;
+        } while ((proc = proc->ringNext<PluginExecutor>()) != _first);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Serve the metrics on the TCP port, in the Server thread.
+//----------------------------------------------------------------------------
+
+void ts::tsp::Metrics::Server::main()
+{
+    _metrics->serve();
+}
+
+void ts::tsp::Metrics::serve()
+{
+    _report.debug(u"tsp: metrics server thread started");
+
+    // Accept connections until the server socket is closed.
+    TCPConnection client;
+    SocketAddress client_addr;
+    while (_server.accept(client, client_addr, NULLREP)) {
+
+        // Register the client so that stop() can interrupt it.
+        {
+            Guard lock(_mutex);
+            if (_terminate) {
+                client.close(NULLREP);
+                break;
+            }
+            _client = &client;
+        }
+
+        // Read the request header, until an empty line. The content of the request is ignored.
+        // A client which does not send its request in time is disconnected.
+        client.setReceiveTimeout(REQUEST_TIMEOUT, NULLREP);
+        std::string request;
+        char buffer[512];
+        size_t size = 0;
+        while (request.find("\r\n\r\n") == std::string::npos &&
+               request.find("\n\n") == std::string::npos &&
+               request.size() < MAX_REQUEST_SIZE &&
+               client.receive(buffer, sizeof(buffer), size, 0, NULLREP))
+        {
+            request.append(buffer, size);
+        }
+        _report.debug(u"tsp: metrics request from %s", {client_addr.toString()});
+
+        // Send the response and close the connection.
+        const std::string body(prometheusText());
+        const std::string header(UString::Format(u"HTTP/1.0 200 OK\r\n"
+                                                 u"Content-Type: text/plain; version=0.0.4\r\n"
+                                                 u"Content-Length: %d\r\n"
+                                                 u"Connection: close\r\n"
+                                                 u"\r\n", {body.size()}).toUTF8());
+        client.send(header.data(), header.size(), NULLREP) && client.send(body.data(), body.size(), NULLREP);
+        client.closeWriter(NULLREP);
+        client.disconnect(NULLREP);
+        {
+            Guard lock(_mutex);
+            _client = 0;
+        }
+        client.close(NULLREP);
+    }
+
+    _report.debug(u"tsp: metrics server thread terminated");
+}
+
+
+//----------------------------------------------------------------------------
+// Format the current metrics of all plugins in Prometheus text format.
+//----------------------------------------------------------------------------
+
+std::string ts::tsp::Metrics::prometheusText() const
+{
+    // Build the labels of each plugin first.
+    UStringVector labels;
+    std::vector<const PluginExecutor*> procs;
+    const PluginExecutor* proc = _first;
+    do {
+        const Options::PluginType type = proc->pluginType();
+        labels.push_back(UString::Format(u"index=\"%d\",plugin=\"%s\",type=\"%s\"",
+                                         {labels.size(), proc->pluginName(),
+                                          type == Options::INPUT ? u"input" : (type == Options::OUTPUT ? u"output" : u"processor")}));
+        procs.push_back(proc);
+    } while ((proc = proc->ringNext<PluginExecutor>()) != _first);
+
+    UString text;
+
+    text.append(u"# HELP tsp_plugin_packets_total Number of packets which were passed to the next plugin.\n");
+    text.append(u"# TYPE tsp_plugin_packets_total counter\n");
+    for (size_t i = 0; i < procs.size(); ++i) {
+        text.append(UString::Format(u"tsp_plugin_packets_total{%s} %d\n", {labels[i], procs[i]->passedPackets()}));
+    }
+
+    text.append(u"# HELP tsp_plugin_packets_in_total Number of packets which were passed to the plugin (received from the plugin for the input).\n");
+    text.append(u"# TYPE tsp_plugin_packets_in_total counter\n");
+    for (size_t i = 0; i < procs.size(); ++i) {
+        text.append(UString::Format(u"tsp_plugin_packets_in_total{%s} %d\n", {labels[i], procs[i]->statistics().packets_in.load(std::memory_order_relaxed)}));
+    }
+
+    text.append(u"# HELP tsp_plugin_busy_seconds_total Time spent outside waits, in the plugin and passing packets to the next plugin.\n");
+    text.append(u"# TYPE tsp_plugin_busy_seconds_total counter\n");
+    for (size_t i = 0; i < procs.size(); ++i) {
+        const uint64_t ns = procs[i]->statistics().busy_ns.load(std::memory_order_relaxed);
+        text.append(UString::Format(u"tsp_plugin_busy_seconds_total{%s} %d.%09d\n", {labels[i], ns / NanoSecPerSec, ns % NanoSecPerSec}));
+    }
+
+    text.append(u"# HELP tsp_plugin_call_seconds_total Time spent in the plugin calls only: receive, processPacketBatch or send.\n");
+    text.append(u"# TYPE tsp_plugin_call_seconds_total counter\n");
+    for (size_t i = 0; i < procs.size(); ++i) {
+        const uint64_t ns = procs[i]->statistics().call_ns.load(std::memory_order_relaxed);
+        text.append(UString::Format(u"tsp_plugin_call_seconds_total{%s} %d.%09d\n", {labels[i], ns / NanoSecPerSec, ns % NanoSecPerSec}));
+    }
+
+    text.append(u"# HELP tsp_plugin_wait_seconds_total Time spent waiting for packets or free buffer space.\n");
+    text.append(u"# TYPE tsp_plugin_wait_seconds_total counter\n");
+    for (size_t i = 0; i < procs.size(); ++i) {
+        const uint64_t ns = procs[i]->statistics().wait_ns.load(std::memory_order_relaxed);
+        text.append(UString::Format(u"tsp_plugin_wait_seconds_total{%s} %d.%09d\n", {labels[i], ns / NanoSecPerSec, ns % NanoSecPerSec}));
+    }
+
+    text.append(u"# HELP tsp_plugin_window Size of the packet windows which are returned to the plugin, relative to the buffer size.\n");
+    text.append(u"# TYPE tsp_plugin_window histogram\n");
+    for (size_t i = 0; i < procs.size(); ++i) {
+        const PluginExecutor::Statistics& stats(procs[i]->statistics());
+        uint64_t cumul = 0;
+        for (size_t b = 0; b < PluginExecutor::WINDOW_BUCKETS; ++b) {
+            cumul += stats.window_buckets[b].load(std::memory_order_relaxed);
+            const size_t le = (b + 1) * 100 / PluginExecutor::WINDOW_BUCKETS;
+            text.append(UString::Format(u"tsp_plugin_window_bucket{%s,le=\"%d.%02d\"} %d\n", {labels[i], le / 100, le % 100, cumul}));
+        }
+        // The windows counter may have been incremented after the buckets were read.
+        const uint64_t windows = std::max(cumul, stats.windows.load(std::memory_order_relaxed));
+        const uint64_t packets = stats.window_packets.load(std::memory_order_relaxed);
+        text.append(UString::Format(u"tsp_plugin_window_bucket{%s,le=\"+Inf\"} %d\n", {labels[i], windows}));
+        text.append(UString::Format(u"tsp_plugin_window_sum{%s} %d.%06d\n",
+                                    {labels[i], packets / _buffer_packets, ((packets % _buffer_packets) * 1000000) / _buffer_packets}));
+        text.append(UString::Format(u"tsp_plugin_window_count{%s} %d\n", {labels[i], windows}));
+    }
+
+    return text.toUTF8();
+}
@@ -0,0 +1,145 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Transport stream processor: Metrics of the plugins
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tspPluginExecutor.h"
+#include "tsTCPServer.h"
+#include "tsTCPConnection.h"
+#include "tsCondition.h"
+
+namespace ts {
+    namespace tsp {
+        //!
+        //! Metrics of all plugins of tsp (options --metrics-interval and --metrics-port).
+        //!
+        //! The instrumentation counters of all plugin executors are periodically
+        //! logged and/or served on a TCP port in Prometheus text format. The counters
+        //! are read without synchronization with the plugin executors.
+        //!
+        class Metrics: private Thread
+        {
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] options Command line options for tsp.
+            //! @param [in] first First plugin executor in the ring (the input).
+            //! @param [in] buffer_packets Size in packets of the packet buffer.
+            //! @param [in,out] report Where to report messages. Must be thread-safe.
+            //!
+            Metrics(const Options& options, PluginExecutor* first, size_t buffer_packets, Report& report);
+
+            //!
+            //! Destructor, stop the metrics threads.
+            //!
+            virtual ~Metrics();
+
+            //!
+            //! Start the metrics activity, as specified in the tsp options.
+            //! @return True on success, false on error.
+            //!
+            bool start();
+
+            //!
+            //! Stop the metrics activity and wait for the termination of the threads.
+            //!
+            void stop();
+
+            //!
+            //! Format the current metrics of all plugins in Prometheus text format.
+            //! @return The metrics in Prometheus text format (UTF-8).
+            //!
+            std::string prometheusText() const;
+
+            //!
+            //! Maximum size of an HTTP request on the metrics server.
+            //!
+            static const size_t MAX_REQUEST_SIZE = 4096;
+
+            //!
+            //! Maximum time to receive an HTTP request on the metrics server.
+            //!
+            static const MilliSecond REQUEST_TIMEOUT = 5000;
+
+        private:
+            // Thread which serves the metrics on a TCP port.
+            class Server: public Thread
+            {
+            public:
+                Server(Metrics* metrics);
+                virtual ~Server() {}
+            private:
+                Metrics* _metrics;
+                virtual void main() override;
+                Server() = delete;
+                Server(const Server&) = delete;
+                Server& operator=(const Server&) = delete;
+            };
+
+            // Snapshot of the counters of one plugin, for periodic logs.
+            struct Snapshot
+            {
+                PacketCounter packets;
+                uint64_t      busy_ns;
+                uint64_t      call_ns;
+                uint64_t      wait_ns;
+                uint64_t      windows;
+                uint64_t      window_packets;
+                Snapshot();
+            };
+
+            const Options&  _options;
+            PluginExecutor* _first;
+            const size_t    _buffer_packets;
+            Report&         _report;
+            Mutex           _mutex;
+            Condition       _wake_up;    // accessed under mutex
+            bool            _terminate;  // accessed under mutex
+            bool            _logging;    // Periodic log thread is started
+            TCPServer       _server;
+            Server          _server_thread;
+            TCPConnection*  _client;     // Client being served, accessed under mutex
+
+            // Periodic logs, in the Metrics thread.
+            virtual void main() override;
+
+            // Serve the metrics on the TCP port, in the Server thread.
+            void serve();
+
+            // Inaccessible operations
+            Metrics() = delete;
+            Metrics(const Metrics&) = delete;
+            Metrics& operator=(const Metrics&) = delete;
+        };
+    }
+}
@@ -56,6 +56,12 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     list_proc(false),
     monitor(false),
     ignore_jt(false),
+    lock_free(false),
+    numa_buffer(false),
+    latency_report(false),
+    benchmark(false),
+    metrics_interval(0),
+    metrics_address(),
     bufsize(0),
     max_flush_pkt(0),
     max_input_pkt(0),
@@ -65,18 +71,27 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     bitrate_adj(0),
     input(),
     output(),
-    plugins()
+    plugins(),
+    branches()
 {
     option(u"add-input-stuffing",       'a', Args::STRING);
+    option(u"affinity",                  0,  Args::STRING, 0, Args::UNLIMITED_COUNT);
+    option(u"benchmark",                 0);
     option(u"bitrate",                  'b', Args::POSITIVE);
     option(u"bitrate-adjust-interval",   0,  Args::POSITIVE);
     option(u"buffer-size-mb",            0,  Args::POSITIVE);
     option(u"ignore-joint-termination", 'i');
+    option(u"latency-report",            0);
     option(u"list-processors",          'l');
+    option(u"lock-free",                 0);
     option(u"max-flushed-packets",       0,  Args::POSITIVE);
     option(u"max-input-packets",         0,  Args::POSITIVE);
+    option(u"metrics-interval",          0,  Args::POSITIVE);
+    option(u"metrics-port",              0,  Args::STRING);
     option(u"no-realtime-clock",         0); // was a temporary workaround, now ignored
     option(u"monitor",                  'm');
+    option(u"numa-buffer",               0);
+    option(u"realtime",                  0,  Args::STRING, 0, Args::UNLIMITED_COUNT);
     option(u"timed-log",                't');
 
 #if defined(TS_WINDOWS)
@@ -101,7 +116,8 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     setSyntax(u" [tsp-options] \\\n"
               u"    [-I input-name [input-options]] \\\n"
               u"    [-P processor-name [processor-options]] ... \\\n"
-              u"    [-O output-name [output-options]]");
+              u"    [-O output-name [output-options]] \\\n"
+              u"    [-B [-P processor-name [processor-options]] ... -O output-name [output-options]] ...");
 
     setHelp(u"All tsp-options must be placed on the command line before the input,\n"
             u"processors and output specifications. The tsp-options are:\n"
@@ -116,6 +132,21 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"      turning a 24 Mb/s input stream (terrestrial) into a 38 Mb/s stream\n"
             u"      (satellite).\n"
             u"\n"
+            u"  --affinity plugin=cpu-list\n"
+            u"      Bind the thread of a plugin to a set of CPU's. The <plugin> is either\n"
+            u"      \"input\", \"output\" (all outputs, including in branches), \"all\" or a\n"
+            u"      plugin number (see \"Plugin numbers\" below). The <cpu-list> is a list\n"
+            u"      of CPU indexes or ranges, for instance \"0,2,4-7\". Several --affinity\n"
+            u"      options may be specified. By default, the threads may run on any CPU.\n"
+            u"\n"
+            u"  --benchmark\n"
+            u"      At the end of the processing, report the throughput of tsp in packets\n"
+            u"      per second and the CPU time of the thread of each plugin, in a format\n"
+            u"      which is suitable for automated comparisons. This option implies\n"
+            u"      --latency-report. Typically used with the input plugin \"synthetic\"\n"
+            u"      and the output plugin \"drop\" to measure the performance of a chain of\n"
+            u"      packet processors.\n"
+            u"\n"
             u"  -b value\n"
             u"  --bitrate value\n"
             u"      Specify the input bitrate, in bits/seconds. By default, the input\n"
@@ -152,10 +183,25 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"      --ignore-joint-termination disables the termination of tsp when all\n"
             u"      plugins have reached their joint termination condition.\n"
             u"\n"
+            u"  --latency-report\n"
+            u"      At the end of the processing, report the latency of the packets between\n"
+            u"      the input and each output plugin: minimum, mean, maximum, standard\n"
+            u"      deviation (jitter) and percentiles. The latency is measured on each\n"
+            u"      output packet, from its input to the end of the output operation which\n"
+            u"      sent it. In verbose mode, the distribution of the latency is also\n"
+            u"      displayed.\n"
+            u"\n"
             u"  -l\n"
             u"  --list-processors\n"
             u"      List all available processors.\n"
             u"\n"
+            u"  --lock-free\n"
+            u"      Pass packets from one plugin to the next one without using the global\n"
+            u"      mutex. Each plugin publishes its processed packets using atomic counters\n"
+            u"      and an idle plugin briefly polls its predecessor before sleeping. This\n"
+            u"      reduces the lock contention and context switches with long chains of\n"
+            u"      plugins at high bitrates.\n"
+            u"\n"
             u"  --max-flushed-packets value\n"
             u"      Specify the maximum number of packets to be processed before flushing\n"
             u"      them to the next processor or the output. When the processing time\n"
@@ -167,12 +213,44 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"      the input plug-in. By default, tsp reads as many packets as it can,\n"
             u"      depending on the free space in the buffer.\n"
             u"\n"
+            u"  --metrics-interval seconds\n"
+            u"      Periodically log the activity of each plugin, at the specified interval in\n"
+            u"      seconds: number of packets per second, percentage of busy time (outside\n"
+            u"      waits, including the handoff of packets to the next plugin), percentage of\n"
+            u"      time in the plugin itself (processing, receiving or sending packets),\n"
+            u"      percentage of time waiting for packets and mean size of the packet window\n"
+            u"      which is available to the plugin, relative to the buffer size. A plugin\n"
+            u"      which is always busy with a large window is the bottleneck of the\n"
+            u"      processing chain.\n"
+            u"\n"
+            u"  --metrics-port [address:]port\n"
+            u"      Serve the metrics of all plugins on the specified TCP port in Prometheus\n"
+            u"      text format. Any HTTP request on this port returns all metrics, including\n"
+            u"      the number of packets in and out of each plugin. By default, the server\n"
+            u"      listens on the local host only. Specify an IP address to serve the metrics\n"
+            u"      on another interface.\n"
+            u"\n"
             u"  -m\n"
             u"  --monitor\n"
             u"      Continuously monitor the system resources which are used by tsp.\n"
             u"      This includes CPU load, virtual memory usage. Useful to verify the\n"
             u"      stability of the application.\n"
             u"\n"
+            u"  --numa-buffer\n"
+            u"      Allocate the packet buffer on the NUMA node of the first CPU of the input\n"
+            u"      plugin. This option is useful only when the input plugin is bound to some\n"
+            u"      CPU's using --affinity. On systems without NUMA, this option has no\n"
+            u"      effect.\n"
+            u"\n"
+            u"  --realtime plugin=fifo|rr[:priority]\n"
+            u"      Run the thread of a plugin with a real-time scheduling policy, either\n"
+            u"      \"fifo\" or \"rr\" (round-robin). The <plugin> designation is the same as\n"
+            u"      in --affinity. The optional <priority> is the system-specific real-time\n"
+            u"      priority, in the range 1 to 99 on Linux. By default, use a middle\n"
+            u"      real-time priority. Real-time scheduling usually requires specific\n"
+            u"      privileges. On Windows, the thread priority is simply raised to the\n"
+            u"      highest level. Several --realtime options may be specified.\n"
+            u"\n"
             u"  -t\n"
             u"  --timed-log\n"
             u"      Each logged message contains a time stamp.\n"
@@ -186,6 +264,13 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"\n"
             u"The following options activate the user-specified plug-in's.\n"
             u"\n"
+            u"  -B\n"
+            u"  --branch\n"
+            u"      Start an additional branch of packet processors and output. All plugins\n"
+            u"      after this option, up to the next -B, form an independent branch: zero\n"
+            u"      or more packet processors followed by exactly one output. The input must\n"
+            u"      be specified before the first branch. See \"Branches\" below.\n"
+            u"\n"
             u"  -I name\n"
             u"  --input name\n"
             u"      Designate the " HELP_SHLIB u" plug-in for packet input.\n"
@@ -216,13 +301,33 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
             u"  . Finally, the standard system algorithm is applied to locate the " HELP_SHLIB u"\n"
             u"    file." HELP_SEEMAN u"\n"
             u"\n"
+            u"Branches:\n"
+            u"\n"
+            u"  With -B, the packets from the input plugin are processed concurrently by\n"
+            u"  the main chain of processors and output and by all branches, each plugin\n"
+            u"  in its own thread. Each branch has its own copy of the packets and of their\n"
+            u"  metadata: the processors of a branch may modify, nullify, drop or label\n"
+            u"  packets without any effect on the other branches. A packet is reused by\n"
+            u"  the input plugin only when all branches have released it. Each additional\n"
+            u"  branch allocates a packet buffer of the same size as the main one (see\n"
+            u"  --buffer-size-mb). When a plugin fails or terminates the processing in one\n"
+            u"  branch, tsp terminates all branches.\n"
+            u"\n"
+            u"Plugin numbers:\n"
+            u"\n"
+            u"  In --affinity and --realtime, the plugins are numbered in the order of the\n"
+            u"  processing chain: 0 is the input plugin, 1 is the first packet processor,\n"
+            u"  etc. The output plugin of the main chain follows its last packet processor.\n"
+            u"  The plugins of the branches follow, in the order of the command line.\n"
+            u"\n"
             u"Input-options, processor-options and output-options are specific to their\n"
             u"corresponding plug-in. Try \"tsp {-I|-O|-P} name --help\" to display the\n"
             u"help text for a specific plug-in.\n");
 
     // Locate the first processor option. All preceeding options are tsp options and must be analyzed.
     PluginType plugin_type;
-    int plugin_index = nextProcOpt(argc, argv, 0, plugin_type);
+    bool is_branch = false;
+    int plugin_index = nextProcOpt(argc, argv, 0, plugin_type, is_branch);
 
     // Analyze the tsp command, not including the plugin options
     analyze(plugin_index, argv);
@@ -235,7 +340,13 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     bitrate_adj = MilliSecPerSec * intValue(u"bitrate-adjust-interval", DEF_BITRATE_INTERVAL);
     max_flush_pkt = intValue<size_t>(u"max-flushed-packets", DEF_MAX_FLUSH_PKT);
     max_input_pkt = intValue<size_t>(u"max-input-packets", 0);
+    metrics_interval = MilliSecPerSec * intValue<MilliSecond>(u"metrics-interval", 0);
+    metrics_address = value(u"metrics-port");
     ignore_jt = present(u"ignore-joint-termination");
+    lock_free = present(u"lock-free");
+    numa_buffer = present(u"numa-buffer");
+    benchmark = present(u"benchmark");
+    latency_report = benchmark || present(u"latency-report");
 
     if (present(u"add-input-stuffing")) {
         UString stuff(value(u"add-input-stuffing"));
@@ -261,11 +372,14 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
     output.name = u"file";
     output.args.clear();
 
-    // Locate all plugins
+    // Locate all plugins. The processors and output are first stored in the main
+    // chain, then in the current branch after each -B option.
 
     plugins.reserve(argc);
     bool got_input = false;
     bool got_output = false;
+    PluginOptionsVector* procs = &plugins;
+    PluginOptions* out = &output;
 
     while (plugin_index < argc) {
 
@@ -273,9 +387,27 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
 
         int start = plugin_index;
         PluginType type = plugin_type;
-        plugin_index = nextProcOpt(argc, argv, plugin_index, plugin_type);
+        const bool branch = is_branch;
+        plugin_index = nextProcOpt(argc, argv, plugin_index, plugin_type, is_branch);
         PluginOptions* opt = 0;
 
+        // Start a new branch. The output of the previous one must have been specified.
+
+        if (branch) {
+            if (!branches.empty() && !got_output) {
+                error(u"missing output plugin in branch %d", {branches.size()});
+            }
+            if (plugin_index != start + 1) {
+                error(u"unexpected argument after option %s", {argv[start]});
+            }
+            branches.resize(branches.size() + 1);
+            procs = &branches.back().plugins;
+            procs->reserve(argc);
+            out = &branches.back().output;
+            got_output = false;
+            continue;
+        }
+
         if (start >= argc - 1) {
             error(u"missing plugin name for option %s", {argv[start]});
             break;
@@ -283,22 +415,25 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
 
         switch (type) {
             case PROCESSOR:
-                plugins.resize(plugins.size() + 1);
-                opt = &plugins[plugins.size() - 1];
+                procs->resize(procs->size() + 1);
+                opt = &procs->back();
                 break;
             case INPUT:
                 if (got_input) {
                     error(u"do not specify more than one input plugin");
                 }
+                if (!branches.empty()) {
+                    error(u"the input plugin must be specified before the first branch");
+                }
                 got_input = true;
                 opt = &input;
                 break;
             case OUTPUT:
                 if (got_output) {
-                    error(u"do not specify more than one output plugin");
+                    error(branches.empty() ? u"do not specify more than one output plugin" : u"do not specify more than one output plugin per branch");
                 }
                 got_output = true;
-                opt = &output;
+                opt = out;
                 break;
             default:
                 // Should not get there
@@ -310,6 +445,66 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
         UString::Assign(opt->args, plugin_index - start - 2, argv + start + 2);
     }
 
+    // There is no default output in branches.
+    if (!branches.empty() && !got_output) {
+        error(u"missing output plugin in branch %d", {branches.size()});
+    }
+
+    // Thread affinity of plugins.
+    UStringVector specs;
+    getValues(specs, u"affinity");
+    for (UStringVector::const_iterator it = specs.begin(); it != specs.end(); ++it) {
+        const UString::size_type eq = it->find(u"=");
+        std::vector<PluginOptions*> selected;
+        std::set<size_t> cpus;
+        if (eq == UString::NPOS || !selectPlugins(it->substr(0, eq), selected) || !DecodeCPUList(it->substr(eq + 1), cpus)) {
+            error(u"invalid value \"%s\" for --affinity, use \"plugin=cpu-list\"", {*it});
+        }
+        else {
+            for (std::vector<PluginOptions*>::const_iterator p = selected.begin(); p != selected.end(); ++p) {
+                (*p)->affinity = cpus;
+            }
+        }
+    }
+
+    // Real-time scheduling of plugins.
+    getValues(specs, u"realtime");
+    for (UStringVector::const_iterator it = specs.begin(); it != specs.end(); ++it) {
+        const UString::size_type eq = it->find(u"=");
+        const UString::size_type colon = it->find(u":");
+        std::vector<PluginOptions*> selected;
+        UString policy_name;
+        int priority = 0;
+        bool valid = eq != UString::NPOS && selectPlugins(it->substr(0, eq), selected);
+        if (valid && colon != UString::NPOS && colon > eq) {
+            policy_name = it->substr(eq + 1, colon - eq - 1);
+            valid = it->substr(colon + 1).toInteger(priority) && priority > 0;
+        }
+        else if (valid) {
+            policy_name = it->substr(eq + 1);
+        }
+        policy_name.convertToLower();
+        ThreadAttributes::SchedulingPolicy policy = ThreadAttributes::POLICY_DEFAULT;
+        if (policy_name == u"fifo") {
+            policy = ThreadAttributes::POLICY_FIFO;
+        }
+        else if (policy_name == u"rr") {
+            policy = ThreadAttributes::POLICY_ROUND_ROBIN;
+        }
+        else {
+            valid = false;
+        }
+        if (!valid) {
+            error(u"invalid value \"%s\" for --realtime, use \"plugin=fifo|rr[:priority]\"", {*it});
+        }
+        else {
+            for (std::vector<PluginOptions*>::const_iterator p = selected.begin(); p != selected.end(); ++p) {
+                (*p)->policy = policy;
+                (*p)->rt_priority = priority;
+            }
+        }
+    }
+
     // Debug display
     if (maxSeverity() >= 2) {
         display(std::cerr);
@@ -324,10 +519,15 @@ ts::tsp::Options::Options(int argc, char *argv[]) :
 // Search the next plugin option.
 //----------------------------------------------------------------------------
 
-int ts::tsp::Options::nextProcOpt(int argc, char *argv[], int index, PluginType& type)
+int ts::tsp::Options::nextProcOpt(int argc, char *argv[], int index, PluginType& type, bool& branch)
 {
+    branch = false;
     while (++index < argc) {
         const std::string arg(argv[index]);
+        if (arg == "-B" || arg == "--branch") {
+            branch = true;
+            return index;
+        }
         if (arg == "-I" || arg == "--input") {
             type = INPUT;
             return index;
@@ -345,6 +545,80 @@ int ts::tsp::Options::nextProcOpt(int argc, char *argv[], int index, PluginType&
 }
 
 
+//----------------------------------------------------------------------------
+// Get the list of plugins which are designated by a selector.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::Options::selectPlugins(const UString& selector, std::vector<PluginOptions*>& selected)
+{
+    selected.clear();
+
+    // Build the list of all plugins, in the order of the processing chain.
+    std::vector<PluginOptions*> chain;
+    chain.push_back(&input);
+    for (size_t i = 0; i < plugins.size(); ++i) {
+        chain.push_back(&plugins[i]);
+    }
+    chain.push_back(&output);
+    for (size_t b = 0; b < branches.size(); ++b) {
+        for (size_t i = 0; i < branches[b].plugins.size(); ++i) {
+            chain.push_back(&branches[b].plugins[i]);
+        }
+        chain.push_back(&branches[b].output);
+    }
+
+    const UString sel(selector.toTrimmed().toLower());
+    size_t index = 0;
+    if (sel == u"all") {
+        selected = chain;
+    }
+    else if (sel == u"input") {
+        selected.push_back(&input);
+    }
+    else if (sel == u"output") {
+        for (size_t i = 0; i < chain.size(); ++i) {
+            if (chain[i]->type == OUTPUT) {
+                selected.push_back(chain[i]);
+            }
+        }
+    }
+    else if (sel.toInteger(index) && index < chain.size()) {
+        selected.push_back(chain[index]);
+    }
+    return !selected.empty();
+}
+
+
+//----------------------------------------------------------------------------
+// Decode a CPU list.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::Options::DecodeCPUList(const UString& list, std::set<size_t>& cpus)
+{
+    cpus.clear();
+    UStringVector fields;
+    list.split(fields, u',');
+    for (UStringVector::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+        const UString::size_type dash = it->find(u"-");
+        size_t first = 0;
+        size_t last = 0;
+        if (dash == UString::NPOS) {
+            if (!it->toInteger(first)) {
+                return false;
+            }
+            last = first;
+        }
+        else if (!it->substr(0, dash).toInteger(first) || !it->substr(dash + 1).toInteger(last) || last < first) {
+            return false;
+        }
+        for (size_t cpu = first; cpu <= last; ++cpu) {
+            cpus.insert(cpu);
+        }
+    }
+    return !cpus.empty();
+}
+
+
 //----------------------------------------------------------------------------
 // Display the content of the object to a stream
 //----------------------------------------------------------------------------
@@ -355,14 +629,20 @@ std::ostream& ts::tsp::Options::display(std::ostream& strm, int indent) const
     strm << margin << "* tsp options:" << std::endl
          << margin << "  --add-input-stuffing: " << UString::Decimal(instuff_nullpkt)
          << "/" << UString::Decimal(instuff_inpkt) << std::endl
+         << margin << "  --benchmark: " << benchmark << std::endl
          << margin << "  --bitrate: " << UString::Decimal(bitrate) << " b/s" << std::endl
          << margin << "  --bitrate-adjust-interval: " << UString::Decimal(bitrate_adj) << " milliseconds" << std::endl
          << margin << "  --buffer-size-mb: " << UString::Decimal(bufsize) << " bytes" << std::endl
          << margin << "  --debug: " << maxSeverity() << std::endl
          << margin << "  --list-processors: " << list_proc << std::endl
+         << margin << "  --latency-report: " << latency_report << std::endl
+         << margin << "  --lock-free: " << lock_free << std::endl
          << margin << "  --max-flushed-packets: " << UString::Decimal(max_flush_pkt) << std::endl
          << margin << "  --max-input-packets: " << UString::Decimal(max_input_pkt) << std::endl
+         << margin << "  --metrics-interval: " << UString::Decimal(metrics_interval) << " milliseconds" << std::endl
+         << margin << "  --metrics-port: " << metrics_address << std::endl
          << margin << "  --monitor: " << monitor << std::endl
+         << margin << "  --numa-buffer: " << numa_buffer << std::endl
          << margin << "  --verbose: " << verbose() << std::endl
          << margin << "  Number of packet processors: " << plugins.size() << std::endl
          << margin << "  Input plugin:" << std::endl;
@@ -373,6 +653,14 @@ std::ostream& ts::tsp::Options::display(std::ostream& strm, int indent) const
     }
     strm << margin << "  Output plugin:" << std::endl;
     output.display(strm, indent + 4);
+    for (size_t b = 0; b < branches.size(); ++b) {
+        for (size_t i = 0; i < branches[b].plugins.size(); ++i) {
+            strm << margin << "  Branch " << (b+1) << ", packet processor plugin " << (i+1) << ":" << std::endl;
+            branches[b].plugins[i].display(strm, indent + 4);
+        }
+        strm << margin << "  Branch " << (b+1) << ", output plugin:" << std::endl;
+        branches[b].output.display(strm, indent + 4);
+    }
     return strm;
 }
 
@@ -384,7 +672,10 @@ std::ostream& ts::tsp::Options::display(std::ostream& strm, int indent) const
 ts::tsp::Options::PluginOptions::PluginOptions() :
     type(PROCESSOR),
     name(),
-    args()
+    args(),
+    affinity(),
+    policy(ThreadAttributes::POLICY_DEFAULT),
+    rt_priority(0)
 {
 }
 
@@ -401,5 +692,27 @@ std::ostream& ts::tsp::Options::PluginOptions::display(std::ostream& strm, int i
     for (size_t i = 0; i < args.size(); ++i) {
         strm << margin << "Arg[" << i << "]: \"" << args[i] << "\"" << std::endl;
     }
+    if (!affinity.empty()) {
+        strm << margin << "Affinity:";
+        for (std::set<size_t>::const_iterator it = affinity.begin(); it != affinity.end(); ++it) {
+            strm << " " << *it;
+        }
+        strm << std::endl;
+    }
+    if (policy != ThreadAttributes::POLICY_DEFAULT) {
+        strm << margin << "Real-time: " << (policy == ThreadAttributes::POLICY_FIFO ? "fifo" : "rr") << ", priority " << rt_priority << std::endl;
+    }
     return strm;
 }
+
+
+//----------------------------------------------------------------------------
+// Default constructor for branch options.
+//----------------------------------------------------------------------------
+
+ts::tsp::Options::BranchOptions::BranchOptions() :
+    plugins(),
+    output()
+{
+    output.type = OUTPUT;
+}
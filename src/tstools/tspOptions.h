@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsArgs.h"
+#include "tsThreadAttributes.h"
 
 namespace ts {
     //!
@@ -72,9 +73,12 @@ namespace ts {
             //!
             struct PluginOptions
             {
-                PluginType    type;  //!< Plugin type.
-                UString       name;  //!< Plugin name.
-                UStringVector args;  //!< Plugin options.
+                PluginType       type;         //!< Plugin type.
+                UString          name;         //!< Plugin name.
+                UStringVector    args;         //!< Plugin options.
+                std::set<size_t> affinity;     //!< CPU affinity of the plugin thread (option --affinity), empty means all CPU's.
+                ThreadAttributes::SchedulingPolicy policy;  //!< Scheduling policy of the plugin thread (option --realtime).
+                int              rt_priority;  //!< Real-time priority of the plugin thread, zero means default.
 
                 //!
                 //! Default constructor.
@@ -95,11 +99,37 @@ namespace ts {
             //!
             typedef std::vector<PluginOptions> PluginOptionsVector;
 
+            //!
+            //! Class containing the options for one additional branch (option -B).
+            //! A branch is a sequence of packet processors followed by one output.
+            //!
+            struct BranchOptions
+            {
+                PluginOptionsVector plugins;  //!< List of packet processor plugins in the branch.
+                PluginOptions       output;   //!< Output plugin of the branch.
+
+                //!
+                //! Default constructor.
+                //!
+                BranchOptions();
+            };
+
+            //!
+            //! A vector of additional branches.
+            //!
+            typedef std::vector<BranchOptions> BranchOptionsVector;
+
             // Option values
             bool          timed_log;       //!< Add time stamps in log messages.
             bool          list_proc;       //!< List processors.
             bool          monitor;         //!< Run a resource monitoring thread.
             bool          ignore_jt;       //!< Ignore "joint termination" options in plugins.
+            bool          lock_free;       //!< Use lock-free packet window handoff between plugins.
+            bool          numa_buffer;     //!< Allocate the packet buffer on the NUMA node of the input plugin thread.
+            bool          latency_report;  //!< Report the input-to-output latency and jitter at the end.
+            bool          benchmark;       //!< Report the throughput and CPU time of each plugin at the end.
+            MilliSecond   metrics_interval; //!< Interval between logs of the plugin metrics, zero means none.
+            UString       metrics_address; //!< Socket address of the metrics server (Prometheus format), empty means none.
             size_t        bufsize;         //!< Buffer size.
             size_t        max_flush_pkt;   //!< Max processed packets before flush.
             size_t        max_input_pkt;   //!< Max packets per input operation.
@@ -110,6 +140,7 @@ namespace ts {
             PluginOptions input;           //!< Input plugin.
             PluginOptions output;          //!< Output plugin.
             PluginOptionsVector plugins;   //!< List of packet processor plugins.
+            BranchOptionsVector branches;  //!< Additional branches of packet processors and output.
 
             //!
             //! Display the content of this object to a stream.
@@ -130,9 +161,26 @@ namespace ts {
             //! @param [in] argv Arguments from command line.
             //! @param [in] index Start searching at index + 1.
             //! @param [out] type Plugin type.
+            //! @param [out] branch Set to true if the option is a branch (option -B), not a plugin.
             //! @return Index of plugin option or @a argc if not found.
             //!
-            static int nextProcOpt(int argc, char *argv[], int index, PluginType& type);
+            static int nextProcOpt(int argc, char *argv[], int index, PluginType& type, bool& branch);
+
+            //!
+            //! Get the list of plugins which are designated by a selector in --affinity or --realtime.
+            //! @param [in] selector Plugin selector: "input", "output", "all" or a plugin number.
+            //! @param [out] selected Selected plugins.
+            //! @return True on success, false if the selector is invalid.
+            //!
+            bool selectPlugins(const UString& selector, std::vector<PluginOptions*>& selected);
+
+            //!
+            //! Decode the CPU list of an --affinity option, for instance "0,2,4-7".
+            //! @param [in] list CPU list.
+            //! @param [out] cpus Set of CPU indexes.
+            //! @return True on success, false if the list is invalid.
+            //!
+            static bool DecodeCPUList(const UString& list, std::set<size_t>& cpus);
         };
     }
 }
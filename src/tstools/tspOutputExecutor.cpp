@@ -32,8 +32,12 @@
 //----------------------------------------------------------------------------
 
 #include "tspOutputExecutor.h"
+#include "tsSysUtils.h"
+#include <cmath>
 TSDUCK_SOURCE;
 
+const size_t ts::tsp::OutputExecutor::LATENCY_BUCKETS;
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -45,7 +49,14 @@ ts::tsp::OutputExecutor::OutputExecutor(Options* options,
                                         Mutex& global_mutex) :
 
     PluginExecutor(options, pl_options, attributes, global_mutex),
-    _output(dynamic_cast<OutputPlugin*> (_shlib))
+    _output(dynamic_cast<OutputPlugin*> (_shlib)),
+    _latency_report(options->latency_report),
+    _lat_count(0),
+    _lat_min(std::numeric_limits<uint64_t>::max()),
+    _lat_max(0),
+    _lat_sum(0),
+    _lat_sum_sq(0.0),
+    _lat_buckets(LATENCY_BUCKETS, 0)
 {
     assert (!isLoaded() || _output != 0);
 }
@@ -86,32 +97,42 @@ void ts::tsp::OutputExecutor::main()
         }
 
         // Output the packets. Output may be segmented if dropped packets
-        // (ie. starting with a zero byte) are in the middle of the buffer.
+        // are in the middle of the buffer. Dropped packets are found using
+        // the metadata buffer only, without touching the packets themselves.
 
         TSPacket* pkt = _buffer->base() + pkt_first;
+        const TSPacketMetadata* mdata = _metadata->base() + pkt_first;
         size_t pkt_remain = pkt_cnt;
 
         while (pkt_remain > 0) {
 
             // Skip dropped packets
             size_t drop_cnt;
-            for (drop_cnt = 0; drop_cnt < pkt_remain && pkt[drop_cnt].b[0] == 0; drop_cnt++) {}
+            for (drop_cnt = 0; drop_cnt < pkt_remain && mdata[drop_cnt].getDropped(); drop_cnt++) {}
 
             pkt += drop_cnt;
+            mdata += drop_cnt;
             pkt_remain -= drop_cnt;
             addTotalPackets (drop_cnt);
 
             // Find last non-dropped packet
             size_t out_cnt;
-            for (out_cnt = 0; out_cnt < pkt_remain && pkt[out_cnt].b[0] != 0; out_cnt++) {}
+            for (out_cnt = 0; out_cnt < pkt_remain && !mdata[out_cnt].getDropped(); out_cnt++) {}
 
             // Output a contiguous range of non-dropped packets.
             if (out_cnt > 0) {
-                if (!_output->send (pkt, out_cnt)) {
+                startPluginCall();
+                const bool sent = _output->send(pkt, out_cnt);
+                endPluginCall(out_cnt);
+                if (!sent) {
                     aborted = true;
                     break;
                 }
+                if (_latency_report) {
+                    addLatency(mdata, out_cnt);
+                }
                 pkt += out_cnt;
+                mdata += out_cnt;
                 pkt_remain -= out_cnt;
                 output_packets += out_cnt;
                 addTotalPackets (out_cnt);
@@ -127,5 +148,97 @@ void ts::tsp::OutputExecutor::main()
     // Close the output processor
     _output->stop();
 
+    if (_latency_report) {
+        reportLatency();
+    }
+
+    _cpu_time = GetThreadCPUTime();
     debug(u"output thread %s after %'d packets (%'d output)", {aborted ? u"aborted" : u"terminated", totalPackets(), output_packets});
 }
+
+
+//----------------------------------------------------------------------------
+// Account the latency of each packet in a range of output packets.
+// All packets of an output operation leave at the same time, their latency
+// is the time since their own input: one sample per output packet.
+//----------------------------------------------------------------------------
+
+void ts::tsp::OutputExecutor::addLatency(const TSPacketMetadata* mdata, size_t count)
+{
+    if (_time_origin == 0 || count == 0) {
+        return;
+    }
+
+    // Output time in units of the input time stamps, one clock read per output operation.
+    // Split the conversion to avoid overflows.
+    Monotonic now;
+    now.getSystemTime();
+    const uint64_t elapsed = uint64_t(std::max<NanoSecond>(0, now - *_time_origin));
+    const uint64_t output = (elapsed / NanoSecPerSec) * SYSTEM_CLOCK_FREQ + ((elapsed % NanoSecPerSec) * SYSTEM_CLOCK_FREQ) / NanoSecPerSec;
+
+    for (size_t i = 0; i < count; ++i) {
+
+        // Stuffing packets which are added by tsp have no input time stamp.
+        if (!mdata[i].hasInputTimeStamp()) {
+            continue;
+        }
+
+        const uint64_t input = mdata[i].getInputTimeStamp();
+        const uint64_t latency = output > input ? (output - input) / (SYSTEM_CLOCK_FREQ / MicroSecPerSec) : 0;
+
+        _lat_count++;
+        _lat_min = std::min(_lat_min, latency);
+        _lat_max = std::max(_lat_max, latency);
+        _lat_sum += latency;
+        _lat_sum_sq += double(latency) * double(latency);
+
+        size_t bucket = 0;
+        for (uint64_t value = latency; value != 0 && bucket < LATENCY_BUCKETS - 1; value >>= 1) {
+            bucket++;
+        }
+        _lat_buckets[bucket]++;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Report the latency statistics.
+//----------------------------------------------------------------------------
+
+void ts::tsp::OutputExecutor::reportLatency()
+{
+    if (_lat_count == 0) {
+        info(u"input to output latency: no measurement");
+        return;
+    }
+
+    const double mean = double(_lat_sum) / double(_lat_count);
+    const double variance = std::max(0.0, _lat_sum_sq / double(_lat_count) - mean * mean);
+
+    // Percentiles are upper bounds of the buckets.
+    static const double ratios[] = {0.50, 0.99, 0.999};
+    uint64_t percentiles[3] = {0, 0, 0};
+    for (size_t p = 0; p < 3; ++p) {
+        const double threshold = ratios[p] * double(_lat_count);
+        PacketCounter cumul = 0;
+        size_t bucket = 0;
+        while (bucket < LATENCY_BUCKETS - 1 && double(cumul + _lat_buckets[bucket]) < threshold) {
+            cumul += _lat_buckets[bucket++];
+        }
+        percentiles[p] = bucket < LATENCY_BUCKETS - 1 ? uint64_t(1) << bucket : _lat_max;
+    }
+
+    info(u"input to output latency: %'d samples, min: %'d us, mean: %'d us, max: %'d us, jitter (std dev): %'d us",
+         {_lat_count, _lat_min, uint64_t(mean), _lat_max, uint64_t(std::sqrt(variance))});
+    info(u"input to output latency percentiles: 50%%: < %'d us, 99%%: < %'d us, 99.9%%: < %'d us",
+         {percentiles[0], percentiles[1], percentiles[2]});
+
+    // Display the distribution of latencies in verbose mode.
+    for (size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        if (_lat_buckets[bucket] > 0) {
+            verbose(u"  latency %s %'d us: %'d (%s)",
+                    {bucket < LATENCY_BUCKETS - 1 ? u"<" : u">=", uint64_t(1) << (bucket < LATENCY_BUCKETS - 1 ? bucket : bucket - 1),
+                     _lat_buckets[bucket], UString::Percentage(_lat_buckets[bucket], _lat_count)});
+        }
+    }
+}
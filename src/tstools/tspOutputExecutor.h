@@ -62,8 +62,30 @@ namespace ts {
             //!
             OutputPlugin* plugin() {return _output;}
 
+            //!
+            //! Number of logarithmic buckets in the distribution of latencies (tsp --latency-report).
+            //! Bucket 0 counts latencies under 1 microsecond, bucket N > 0 counts latencies
+            //! from 2^(N-1) to 2^N microseconds, the last bucket counts all larger latencies.
+            //!
+            static const size_t LATENCY_BUCKETS = 40;
+
         private:
-            OutputPlugin* _output;
+            OutputPlugin*     _output;
+
+            // Input-to-output latency statistics (tsp --latency-report), in microseconds.
+            const bool        _latency_report;
+            PacketCounter     _lat_count;
+            uint64_t          _lat_min;
+            uint64_t          _lat_max;
+            uint64_t          _lat_sum;
+            double            _lat_sum_sq;
+            std::vector<PacketCounter> _lat_buckets;
+
+            // Account the latency of each packet in a range of output packets, just after output.
+            void addLatency(const TSPacketMetadata* mdata, size_t count);
+
+            // Report the latency statistics.
+            void reportLatency();
 
             // Inherited from Thread
             virtual void main() override;
@@ -36,6 +36,8 @@
 #include "tsGuard.h"
 TSDUCK_SOURCE;
 
+const size_t ts::tsp::PluginExecutor::WINDOW_BUCKETS;
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -52,12 +54,30 @@ ts::tsp::PluginExecutor::PluginExecutor(Options* options,
     _name(pl_options->name),
     _shlib(0),
     _buffer(0),
+    _metadata(0),
+    _branches(!options->branches.empty()),
+    _time_origin(0),
+    _cpu_time(-1),
     _report(options),
     _to_do(),
+    _lock_free(options->lock_free),
+    _plugin_type(pl_options->type),
+    _instrument(options->metrics_interval > 0 || !options->metrics_address.empty()),
+    _stat_time(),
+    _call_time(),
+    _stats(),
+    _predecessors(),
+    _successors(),
     _pkt_first(0),
     _pkt_cnt(0),
     _input_end(false),
-    _bitrate(0)
+    _bitrate(0),
+    _pkt_passed(0),
+    _sleep_mutex(),
+    _sleeping(false),
+    _lf_input_end(false),
+    _lf_bitrate(0),
+    _lf_pkt_init(0)
 {
     const UChar* shell = 0;
 
@@ -107,14 +127,35 @@ ts::tsp::PluginExecutor::PluginExecutor(Options* options,
     _shlib->analyze(pl_options->name, pl_options->args);
     assert(_shlib->valid());
 
-    // Define thread stack size
+    // Define thread stack size, CPU affinity and real-time scheduling.
     ThreadAttributes attr;
     Thread::getAttributes(attr);
     attr.setStackSize(STACK_SIZE_OVERHEAD + _shlib->stackUsage());
+    attr.setAffinity(pl_options->affinity);
+    attr.setSchedulingPolicy(pl_options->policy);
+    attr.setRealTimePriority(pl_options->rt_priority);
     Thread::setAttributes(attr);
 }
 
 
+//----------------------------------------------------------------------------
+// Instrumentation counters constructor.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginExecutor::Statistics::Statistics() :
+    busy_ns(0),
+    call_ns(0),
+    wait_ns(0),
+    packets_in(0),
+    windows(0),
+    window_packets(0)
+{
+    for (size_t i = 0; i < WINDOW_BUCKETS; ++i) {
+        window_buckets[i] = 0;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Destructor
 //----------------------------------------------------------------------------
@@ -129,25 +170,87 @@ ts::tsp::PluginExecutor::~PluginExecutor()
 }
 
 
+//----------------------------------------------------------------------------
+// Connect this plugin executor after another one in the flow of packets.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::connectAfter(PluginExecutor* previous)
+{
+    assert(previous != 0);
+    previous->_successors.push_back(this);
+    _predecessors.push_back(previous);
+}
+
+
+//----------------------------------------------------------------------------
+// Copy packets and metadata into the buffers of all other branches.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::replicatePackets(size_t pkt_first, size_t pkt_cnt)
+{
+    assert(pkt_first + pkt_cnt <= _buffer->count());
+    assert(pkt_first + pkt_cnt <= _metadata->count());
+    const TSPacket* const pkt = _buffer->base() + pkt_first;
+    const TSPacketMetadata* const mdata = _metadata->base() + pkt_first;
+    for (size_t i = 0; i < _successors.size(); ++i) {
+        PluginExecutor* const next = _successors[i];
+        if (next->_buffer != _buffer) {
+            ::memcpy(next->_buffer->base() + pkt_first, pkt, pkt_cnt * PKT_SIZE);
+        }
+        if (next->_metadata != _metadata) {
+            std::copy(mdata, mdata + pkt_cnt, next->_metadata->base() + pkt_first);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if any successor has aborted.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::successorAborting() const
+{
+    for (size_t i = 0; i < _successors.size(); ++i) {
+        if (_successors[i]->_tsp_aborting) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
 //----------------------------------------------------------------------------
 // Set the initial state of the buffer. Must be executed in
 // synchronous environment, before starting all executor threads.
 //----------------------------------------------------------------------------
 
-void ts::tsp::PluginExecutor::initBuffer(PacketBuffer* buffer,
-                                         size_t        pkt_first,
-                                         size_t        pkt_cnt,
-                                         bool          input_end,
-                                         bool          aborted,
-                                         BitRate       bitrate)
+void ts::tsp::PluginExecutor::initBuffer(PacketBuffer*         buffer,
+                                         PacketMetadataBuffer* metadata,
+                                         size_t                pkt_first,
+                                         size_t                pkt_cnt,
+                                         bool                  input_end,
+                                         bool                  aborted,
+                                         BitRate               bitrate,
+                                         const Monotonic*      time_origin)
 {
+    assert(metadata != 0 && metadata->count() == buffer->count());
     _buffer = buffer;
+    _metadata = metadata;
     _pkt_first = pkt_first;
     _pkt_cnt = pkt_cnt;
     _input_end = input_end;
     _tsp_aborting = aborted;
     _bitrate = bitrate;
     _tsp_bitrate = bitrate;
+    _time_origin = time_origin;
+    _stat_time.getSystemTime();
+
+    // In lock-free mode, the size of the packet area is computed from the packet
+    // counters. Initially, all counters are zero and the size of the area is pkt_cnt.
+    _pkt_passed = 0;
+    _lf_input_end = input_end;
+    _lf_bitrate = bitrate;
+    _lf_pkt_init = pkt_cnt;
 }
 
 
@@ -182,11 +285,17 @@ void ts::tsp::PluginExecutor::passPackets(size_t count,     // of packets to pas
                                           bool aborted)     // set to current processor
 
 {
-    assert(count <= _pkt_cnt);
     assert(_pkt_first + count <= _buffer->count());
 
     log(10, u"passPackets (count = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {count, bitrate, input_end, aborted});
 
+    if (_lock_free) {
+        passPacketsLockFree(count, bitrate, input_end, aborted);
+        return;
+    }
+
+    assert(count <= _pkt_cnt);
+
     // We access data under the protection of the global mutex.
 
     Guard lock(_global_mutex);
@@ -195,25 +304,36 @@ void ts::tsp::PluginExecutor::passPackets(size_t count,     // of packets to pas
 
     _pkt_first = (_pkt_first + count) % _buffer->count();
     _pkt_cnt -= count;
-
-    // Update next processor's buffer.
-
-    PluginExecutor* next = ringNext<PluginExecutor>();
-    next->_pkt_cnt += count;
-    next->_input_end = next->_input_end || input_end;
-    next->_bitrate = bitrate;
-
-    // Wake the next processor when there is some data
-
-    if (count > 0 || input_end) {
-        next->_to_do.signal();
+    _pkt_passed += count;
+
+    // Update next processors' buffers. With branches, the input has several
+    // predecessors and its area is computed from the counters of all of them.
+
+    for (size_t i = 0; i < _successors.size(); ++i) {
+        PluginExecutor* next = _successors[i];
+        if (next->_predecessors.size() > 1) {
+            next->_pkt_cnt = next->countFromPassed();
+        }
+        else {
+            next->_pkt_cnt += count;
+        }
+        next->_input_end = next->_input_end || input_end;
+        next->_bitrate = bitrate;
+
+        // Wake the next processor when there is some data
+
+        if (count > 0 || input_end) {
+            next->_to_do.signal();
+        }
     }
 
-    // Wake the previous processor when we abort
+    // Wake the previous processors when we abort
 
     if (aborted) {
         _tsp_aborting = true; // volatile bool in TSP superclass
-        ringPrevious<PluginExecutor>()->_to_do.signal();
+        for (size_t i = 0; i < _predecessors.size(); ++i) {
+            _predecessors[i]->_to_do.signal();
+        }
     }
 }
 
@@ -226,7 +346,14 @@ void ts::tsp::PluginExecutor::setAbort()
 {
     Guard lock(_global_mutex);
     _tsp_aborting = true;
-    ringPrevious<PluginExecutor>()->_to_do.signal();
+    for (size_t i = 0; i < _predecessors.size(); ++i) {
+        if (_lock_free) {
+            _predecessors[i]->wakeUp();
+        }
+        else {
+            _predecessors[i]->_to_do.signal();
+        }
+    }
 }
 
 
@@ -246,11 +373,64 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first,
 {
     log(10, u"waitWork(...)");
 
+    if (!_instrument) {
+        if (_lock_free) {
+            waitWorkLockFree(pkt_first, pkt_cnt, bitrate, input_end, aborted);
+        }
+        else {
+            waitWorkGlobal(pkt_first, pkt_cnt, bitrate, input_end, aborted);
+        }
+        return;
+    }
+
+    // With instrumentation, the time since the end of the previous wait was spent in the plugin.
+    // The counters are written by this thread only, there is no need for atomic increments.
+    Monotonic start;
+    start.getSystemTime();
+    _stats.busy_ns.store(_stats.busy_ns.load(std::memory_order_relaxed) + uint64_t(start - _stat_time), std::memory_order_relaxed);
+
+    if (_lock_free) {
+        waitWorkLockFree(pkt_first, pkt_cnt, bitrate, input_end, aborted);
+    }
+    else {
+        waitWorkGlobal(pkt_first, pkt_cnt, bitrate, input_end, aborted);
+    }
+
+    _stat_time.getSystemTime();
+    _stats.wait_ns.store(_stats.wait_ns.load(std::memory_order_relaxed) + uint64_t(_stat_time - start), std::memory_order_relaxed);
+    _stats.windows.store(_stats.windows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _stats.window_packets.store(_stats.window_packets.load(std::memory_order_relaxed) + pkt_cnt, std::memory_order_relaxed);
+    std::atomic<uint64_t>& bucket(_stats.window_buckets[std::min(WINDOW_BUCKETS - 1, (pkt_cnt * WINDOW_BUCKETS) / _buffer->count())]);
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+//----------------------------------------------------------------------------
+// Account a plugin call in the instrumentation counters.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::endPluginCall(size_t packets)
+{
+    if (_instrument) {
+        Monotonic end;
+        end.getSystemTime();
+        _stats.call_ns.store(_stats.call_ns.load(std::memory_order_relaxed) + uint64_t(end - _call_time), std::memory_order_relaxed);
+        _stats.packets_in.store(_stats.packets_in.load(std::memory_order_relaxed) + packets, std::memory_order_relaxed);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Implementation of waitWork() in global mutex mode.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitWorkGlobal(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted)
+{
     // We access data under the protection of the global mutex.
 
     GuardCondition lock(_global_mutex, _to_do);
 
-    while (_pkt_cnt == 0 && !_input_end && !ringNext<PluginExecutor>()->_tsp_aborting) {
+    while (_pkt_cnt == 0 && !_input_end && !successorAborting()) {
 
         // If packet area for this processor is empty, wait for some packet.
         // The mutex is implicitely released, we wait for the condition
@@ -264,7 +444,124 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first,
     pkt_cnt = std::min(_pkt_cnt, _buffer->count() - _pkt_first);
     bitrate = _bitrate;
     input_end = _input_end && pkt_cnt == _pkt_cnt;
-    aborted = ringNext<PluginExecutor>()->_tsp_aborting;
+    aborted = successorAborting();
+
+    log(10, u"waitWork (pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {pkt_first, pkt_cnt, bitrate, input_end, aborted});
+}
+
+
+//----------------------------------------------------------------------------
+// Get the current size of the packet area from the packet counters.
+// The counters of the previous processors are written by other threads.
+// With several predecessors, a packet is available when all of them
+// have passed it.
+//----------------------------------------------------------------------------
+
+size_t ts::tsp::PluginExecutor::countFromPassed() const
+{
+    const PacketCounter passed = _pkt_passed.load(std::memory_order_relaxed);
+    PacketCounter prev = _predecessors[0]->_pkt_passed.load();
+    for (size_t i = 1; i < _predecessors.size(); ++i) {
+        prev = std::min(prev, _predecessors[i]->_pkt_passed.load());
+    }
+    return size_t(prev + _lf_pkt_init - passed);
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free mode: wake up the processor thread if it is sleeping.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::wakeUp()
+{
+    Guard lock(_sleep_mutex);
+    _to_do.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free mode: pass processed packets to the next processor.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted)
+{
+    // Our first packet index is private to this thread.
+    _pkt_first = (_pkt_first + count) % _buffer->count();
+
+    // The bitrate and end of input must be visible by the next processors
+    // as soon as they see the new packets. The next processors check
+    // _lf_input_end before the packet counter.
+    for (size_t i = 0; i < _successors.size(); ++i) {
+        _successors[i]->_lf_bitrate = bitrate;
+    }
+    _pkt_passed += count;
+    if (input_end) {
+        for (size_t i = 0; i < _successors.size(); ++i) {
+            _successors[i]->_lf_input_end = true;
+        }
+    }
+
+    // Wake the next processors only if they sleep. Since _sleeping is set before
+    // a sleeping processor checks our counter, either it sees our new packets
+    // or we see it sleeping.
+    if (count > 0 || input_end) {
+        for (size_t i = 0; i < _successors.size(); ++i) {
+            if (_successors[i]->_sleeping) {
+                _successors[i]->wakeUp();
+            }
+        }
+    }
+
+    // Wake the previous processor when we abort. The abort state is set
+    // under the protection of the global mutex, as with setAbort().
+    if (aborted) {
+        setAbort();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free mode: wait for something to do.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitWorkLockFree(size_t& pkt_first,
+                                               size_t& pkt_cnt,
+                                               BitRate& bitrate,
+                                               bool& input_end,
+                                               bool& aborted)
+{
+    size_t avail = 0;
+
+    // Spin a short time, polling the previous processor.
+    for (size_t spin = 0; spin < LOCK_FREE_SPIN_COUNT; ++spin) {
+        input_end = _lf_input_end;
+        avail = countFromPassed();
+        aborted = successorAborting();
+        if (avail > 0 || input_end || aborted) {
+            break;
+        }
+    }
+
+    // Still nothing to do, sleep until notified.
+    if (avail == 0 && !input_end && !aborted) {
+        GuardCondition lock(_sleep_mutex, _to_do);
+        _sleeping = true;
+        for (;;) {
+            input_end = _lf_input_end;
+            avail = countFromPassed();
+            aborted = successorAborting();
+            if (avail > 0 || input_end || aborted) {
+                break;
+            }
+            lock.waitCondition();
+        }
+        _sleeping = false;
+    }
+
+    pkt_first = _pkt_first;
+    pkt_cnt = std::min(avail, _buffer->count() - _pkt_first);
+    bitrate = _lf_bitrate;
+    input_end = input_end && pkt_cnt == avail;
 
     log(10, u"waitWork (pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %'d, aborted = %'d)", {pkt_first, pkt_cnt, bitrate, input_end, aborted});
 }
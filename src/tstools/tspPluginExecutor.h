@@ -38,11 +38,14 @@
 #include "tsPlugin.h"
 #include "tsPluginSharedLibrary.h"
 #include "tsResidentBuffer.h"
+#include "tsTSPacketMetadata.h"
 #include "tsUserInterrupt.h"
 #include "tsRingNode.h"
 #include "tsCondition.h"
 #include "tsMutex.h"
 #include "tsThread.h"
+#include "tsMonotonic.h"
+#include <atomic>
 
 namespace ts {
     namespace tsp {
@@ -96,10 +99,15 @@ namespace ts {
         //!  window of the next processor), it must notify the _to_do condition variable
         //!  of the next thread.
         //!
-        //!  When a packet processor decides to drop a packet, the synchronization
-        //!  byte (first byte of the packet, normally 0x47) is reset to zero. When
-        //!  a packet processor or the output processor encounters a packet starting
-        //!  with a zero byte, it ignores it.
+        //!  There is a parallel buffer of ts::TSPacketMetadata, with the same size
+        //!  and the same sliding windows. The metadata of the packet at index N in
+        //!  the packet buffer is at index N in the metadata buffer. The input thread
+        //!  resets the metadata of incoming packets and sets their input time stamp.
+        //!
+        //!  When a packet processor decides to drop a packet, the packet is marked
+        //!  as dropped in its metadata. The packet content is left untouched. When
+        //!  a packet processor or the output processor encounters a dropped packet,
+        //!  it ignores it.
         //!
         //!  All PluginExecutors are chained in a ring. The first one is input and
         //!  the last one is output. The output points back to the input so that the
@@ -118,6 +126,46 @@ namespace ts {
         //!  condition. In case of error, all processors should also declare an
         //!  "_input_end" to their successor.
         //!
+        //!  Lock-free mode
+        //!  --------------
+        //!  With the tsp option -\-lock-free, the global mutex is no longer used to
+        //!  move packets from one processor to the next one. Each processor maintains
+        //!  an atomic counter of all packets it has ever passed to its successor. The
+        //!  size of the sliding window of a processor is the difference between the
+        //!  counter of its predecessor and its own counter. Each counter is written by
+        //!  one single thread and read by one single other thread (single producer,
+        //!  single consumer). The index of the first packet in the window is private
+        //!  to the processor thread.
+        //!
+        //!  When its window is empty, a processor first spins a short time, polling
+        //!  the counter of its predecessor. If still nothing arrives, the thread
+        //!  declares itself as sleeping and waits on its "_to_do" condition variable,
+        //!  using a private mutex. A processor which passes packets to a sleeping
+        //!  successor notifies it. The global mutex remains used for "joint
+        //!  termination" and abort only.
+        //!
+        //!  Branches
+        //!  --------
+        //!  With the tsp option -B, additional branches of processors and output
+        //!  are defined. The flow of packets is no longer a simple ring. The input
+        //!  processor has several successors, the first processor (or output) of
+        //!  each branch, and several predecessors, the output of each branch. The
+        //!  ring of executors is still used to enumerate all executors.
+        //!
+        //!  The packets which are passed by the input processor are made available
+        //!  to all branches at the same time. Each processor maintains a counter
+        //!  of all packets it has ever passed to its successors (including in
+        //!  global mutex mode). The free area of the input processor is computed
+        //!  from the minimum of the counters of all branch outputs: a packet is
+        //!  reused by the input processor only when all branches have released it.
+        //!
+        //!  Each additional branch has its own packet buffer and metadata buffer,
+        //!  parallel to the main buffers: a packet has the same index in all of
+        //!  them. The input processor reads the packets in the buffers of the main
+        //!  chain and copies them, with their metadata, in the buffers of the other
+        //!  branches before passing them. Thus, the processors of a branch may
+        //!  modify, nullify or drop packets without any effect on other branches.
+        //!
         class PluginExecutor:
             public RingNode,
             public JointTermination,
@@ -130,6 +178,11 @@ namespace ts {
             //!
             typedef ResidentBuffer<TSPacket> PacketBuffer;
 
+            //!
+            //! Metadata of TS packet are accessed in a memory-resident buffer, parallel to the packet buffer.
+            //!
+            typedef ResidentBuffer<TSPacketMetadata> PacketMetadataBuffer;
+
             //!
             //! Constructor.
             //! @param [in,out] options Command line options for tsp.
@@ -151,18 +204,121 @@ namespace ts {
             //! Set the initial state of the buffer for this plugin.
             //! Must be executed in synchronous environment, before starting all executor threads.
             //! @param [in] buffer Address of the packet buffer.
+            //! @param [in] metadata Address of the packet metadata buffer.
             //! @param [in] pkt_first Starting index of packets area for this plugin.
             //! @param [in] pkt_cnt Size of packets area for this plugin.
             //! @param [in] input_end If true, there is no more packet after current ones.
             //! @param [in] aborted If true, there was a packet processor error, aborted.
             //! @param [in] bitrate Input bitrate (set by previous packet processor).
+            //! @param [in] time_origin Origin of the input time stamps of the packets.
+            //!
+            void initBuffer(PacketBuffer*         buffer,
+                            PacketMetadataBuffer* metadata,
+                            size_t                pkt_first,
+                            size_t                pkt_cnt,
+                            bool                  input_end,
+                            bool                  aborted,
+                            BitRate               bitrate,
+                            const Monotonic*      time_origin);
+
+            //!
+            //! Connect this plugin executor after another one in the flow of packets.
+            //! Must be executed in synchronous environment, before initializing the buffers.
+            //! @param [in,out] previous The previous plugin executor in the flow of packets.
+            //!
+            void connectAfter(PluginExecutor* previous);
+
+            //!
+            //! Number of successors in the flow of packets.
+            //! @return The number of successors, the number of branches for the input executor.
+            //!
+            size_t successorCount() const
+            {
+                return _successors.size();
+            }
+
+            //!
+            //! Get a successor in the flow of packets.
+            //! @param [in] index Index of the successor, from 0 to successorCount() - 1.
+            //! @return The successor at @a index.
+            //!
+            PluginExecutor* successor(size_t index) const
+            {
+                return _successors[index];
+            }
+
+            //!
+            //! Number of buckets in the histogram of the size of the packet windows which
+            //! are returned to the plugin (tsp instrumentation). Bucket N counts the windows
+            //! from N/10 to (N+1)/10 of the buffer size.
+            //!
+            static const size_t WINDOW_BUCKETS = 10;
+
+            //!
+            //! Instrumentation counters of a plugin executor (tsp options --metrics-interval and --metrics-port).
+            //! All counters are written by the executor thread only and can be read by any thread.
+            //!
+            struct Statistics
+            {
+                std::atomic<uint64_t> busy_ns;         //!< Nanoseconds spent outside waits: plugin calls and packet handoff to the next plugin.
+                std::atomic<uint64_t> call_ns;         //!< Nanoseconds spent in the plugin calls only (receive, processPacketBatch or send).
+                std::atomic<uint64_t> wait_ns;         //!< Nanoseconds spent waiting for packets (or free buffer space for the input).
+                std::atomic<uint64_t> packets_in;      //!< Number of packets which were passed to the plugin (received from the plugin for the input).
+                std::atomic<uint64_t> windows;         //!< Number of packet windows which were returned to the plugin.
+                std::atomic<uint64_t> window_packets;  //!< Total number of packets in all windows.
+                std::atomic<uint64_t> window_buckets[WINDOW_BUCKETS];  //!< Histogram of the window sizes, relative to the buffer size.
+
+                //!
+                //! Default constructor.
+                //!
+                Statistics();
+            };
+
+            //!
+            //! Get the instrumentation counters of the plugin executor.
+            //! @return A constant reference to the counters, all zero when the instrumentation is disabled.
+            //!
+            const Statistics& statistics() const
+            {
+                return _stats;
+            }
+
+            //!
+            //! Get the total number of packets which were passed to the next plugins.
+            //! Can be called from any thread.
+            //! @return The total number of passed packets.
+            //!
+            PacketCounter passedPackets() const
+            {
+                return _pkt_passed.load(std::memory_order_relaxed);
+            }
+
+            //!
+            //! Get the type of the plugin.
+            //! @return The plugin type.
+            //!
+            Options::PluginType pluginType() const
+            {
+                return _plugin_type;
+            }
+
+            //!
+            //! Get the name of the plugin.
+            //! @return The plugin name, as specified on the command line.
+            //!
+            const UString& pluginName() const
+            {
+                return _name;
+            }
+
             //!
-            void initBuffer(PacketBuffer* buffer,
-                            size_t        pkt_first,
-                            size_t        pkt_cnt,
-                            bool          input_end,
-                            bool          aborted,
-                            BitRate       bitrate);
+            //! Get the CPU time which was used by the thread of the plugin.
+            //! @return The CPU time of the plugin thread in nanoseconds, -1 if the thread is not terminated.
+            //!
+            NanoSecond cpuTime() const
+            {
+                return _cpu_time;
+            }
 
             //!
             //! Change the report method.
@@ -185,6 +341,12 @@ namespace ts {
             //!
             static const size_t STACK_SIZE_OVERHEAD = 32 * 1024; // 32 kB
 
+            //!
+            //! In lock-free mode, number of times a processor polls its predecessor
+            //! before sleeping on its condition variable.
+            //!
+            static const size_t LOCK_FREE_SPIN_COUNT = 256;
+
             //!
             //! Access the shared library API.
             //! @return Address of the plugin interface.
@@ -195,9 +357,13 @@ namespace ts {
             }
 
         protected:
-            UString       _name;   //!< Plugin name.
-            Plugin*       _shlib;  //!< Shared library API.
-            PacketBuffer* _buffer; //!< Description of shared packet buffer.
+            UString               _name;         //!< Plugin name.
+            Plugin*               _shlib;        //!< Shared library API.
+            PacketBuffer*         _buffer;       //!< Description of shared packet buffer.
+            PacketMetadataBuffer* _metadata;     //!< Description of shared packet metadata buffer.
+            const bool            _branches;     //!< Packets are copied to several branches (tsp -B).
+            const Monotonic*      _time_origin;  //!< Origin of the input time stamps of the packets.
+            NanoSecond            _cpu_time;     //!< CPU time of the plugin thread, set by the thread at the end.
 
             //!
             //! Pass processed packets to the next packet processor.
@@ -235,20 +401,91 @@ namespace ts {
                           bool& input_end,
                           bool& aborted);
 
+            //!
+            //! Copy packets and their metadata into the buffers of all other branches.
+            //! Used by the input executor on incoming packets when tsp uses branches.
+            //! @param [in] pkt_first Index of first packet in the buffer.
+            //! @param [in] pkt_cnt Number of packets.
+            //!
+            void replicatePackets(size_t pkt_first, size_t pkt_cnt);
+
+            //!
+            //! Start the measurement of a plugin call (tsp instrumentation).
+            //! Does nothing when the instrumentation is disabled.
+            //!
+            void startPluginCall()
+            {
+                if (_instrument) {
+                    _call_time.getSystemTime();
+                }
+            }
+
+            //!
+            //! Account a plugin call in the instrumentation counters, since startPluginCall().
+            //! Does nothing when the instrumentation is disabled.
+            //! @param [in] packets Number of packets which were passed to the plugin (or received from the input plugin).
+            //!
+            void endPluginCall(size_t packets);
+
             // Inherited from Report (via TSP)
             virtual void writeLog(int severity, const UString& msg) override;
 
         private:
-            Report*   _report;   // Common report interface for all plugins
-            Condition _to_do;    // Notify processor to do something
+            Report*    _report;     // Common report interface for all plugins
+            Condition  _to_do;      // Notify processor to do something
+            const bool _lock_free;  // Use lock-free packet window handoff (tsp --lock-free)
+            const Options::PluginType _plugin_type;
+
+            // Instrumentation (tsp --metrics-interval, --metrics-port). The time stamp is
+            // the end of the last wait, the processing time is accounted at the next wait.
+            const bool _instrument;
+            Monotonic  _stat_time;
+            Monotonic  _call_time;  // Start of the current plugin call
+            Statistics _stats;
+
+            // Flow of packets. There are several predecessors and successors for the input
+            // executor when tsp uses branches. Otherwise, this is the ring order.
+            std::vector<PluginExecutor*> _predecessors;
+            std::vector<PluginExecutor*> _successors;
 
             // The following private data must be accessed exclusively under the
-            // protection of the global mutex.
+            // protection of the global mutex. In lock-free mode, _pkt_first is
+            // private to the processor thread and the other fields are unused.
             size_t  _pkt_first;  // Starting index of packets area
             size_t  _pkt_cnt;    // Size of packets area
             bool    _input_end;  // No more packet after current ones
             BitRate _bitrate;    // Input bitrate (set by previous plugin)
 
+            // Total packets passed to successors (written by this thread). In global mutex
+            // mode, used only to compute the packet area of an executor with several
+            // predecessors (the input with branches).
+            std::atomic<PacketCounter> _pkt_passed;
+
+            // The following private data are used in lock-free mode only.
+            // Each atomic variable is written by one single thread only.
+            Mutex                      _sleep_mutex;   // Protect _to_do when sleeping
+            std::atomic<bool>          _sleeping;      // Waiting on _to_do (written by this thread)
+            std::atomic<bool>          _lf_input_end;  // No more packet after current ones (written by previous)
+            std::atomic<BitRate>       _lf_bitrate;    // Input bitrate (written by previous)
+            size_t                     _lf_pkt_init;   // Initial size of packet area, see initBuffer()
+
+            // Implementation of passPackets() and waitWork() in lock-free mode.
+            void passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted);
+            void waitWorkLockFree(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted);
+
+            // Implementation of waitWork() in global mutex mode.
+            void waitWorkGlobal(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted);
+
+            // Get the current size of the packet area from the packet counters. Used in lock-free
+            // mode and, for an executor with several predecessors, in global mutex mode.
+            size_t countFromPassed() const;
+
+            // Check if any successor has aborted.
+            bool successorAborting() const;
+
+            // In lock-free mode, wake up the processor thread.
+            void wakeUp();
+
             // Inaccessible operations.
             PluginExecutor() = delete;
             PluginExecutor(const PluginExecutor&) = delete;
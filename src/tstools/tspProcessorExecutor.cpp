@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tspProcessorExecutor.h"
+#include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
 
@@ -68,6 +69,10 @@ void ts::tsp::ProcessorExecutor::main()
     bool input_end = false;
     bool aborted = false;
 
+    // Processing status of a batch of packets. A batch never exceeds the
+    // maximum number of packets before flush.
+    std::vector<ProcessorPlugin::Status> status(std::min(_max_flush_pkt, _buffer->count()));
+
     do {
         // Wait for packets to process
 
@@ -98,7 +103,8 @@ void ts::tsp::ProcessorExecutor::main()
             break;
         }
 
-        // Now process the packets.
+        // Now process the packets. The plugin is invoked on contiguous batches
+        // of packets. A batch never crosses a periodic flush point.
 
         size_t pkt_done = 0;
         size_t pkt_flush = 0;
@@ -106,61 +112,63 @@ void ts::tsp::ProcessorExecutor::main()
         while (pkt_done < pkt_cnt) {
 
             bool flush_request = false;
+            bool bitrate_changed = false;
             TSPacket* pkt = _buffer->base() + pkt_first + pkt_done;
+            TSPacketMetadata* mdata = _metadata->base() + pkt_first + pkt_done;
+            const size_t batch = std::min(pkt_cnt - pkt_done, _max_flush_pkt - pkt_flush);
 
-            pkt_done++;
-            pkt_flush++;
-
-            // If the packet has not already been dropped by a previous
-            // packet processor, apply the processing routine to the packet
-
-            if (pkt->b[0] != 0) {
+            startPluginCall();
+            size_t processed = _processor->processPacketBatch(pkt, mdata, batch, &status[0], flush_request, bitrate_changed);
+            assert(processed > 0 && processed <= batch);
+            endPluginCall(processed);
 
-                bool bitrate_changed = false;
-                ProcessorPlugin::Status status = _processor->processPacket (*pkt, flush_request, bitrate_changed);
+            addTotalPackets(processed);
 
-                // Use the returned status
-                switch (status) {
+            // Use the returned status
+            for (size_t n = 0; n < processed; ++n) {
+                switch (status[n]) {
                     case ProcessorPlugin::TSP_OK:
                         // Normal case, pass packet
                         passed_packets++;
                         break;
                     case ProcessorPlugin::TSP_NULL:
-                        // Replace the packet with a complete null packet
-                        *pkt = NullPacket;
+                        // Replace the packet with a complete null packet.
+                        pkt[n] = NullPacket;
                         nullified_packets++;
                         break;
                     case ProcessorPlugin::TSP_DROP:
-                        // Drop this packet.
-                        pkt->b[0] = 0;
-                        dropped_packets++;
+                        // Drop this packet, unless already dropped by a previous processor.
+                        if (!mdata[n].getDropped()) {
+                            mdata[n].setDropped(true);
+                            dropped_packets++;
+                        }
                         break;
                     case ProcessorPlugin::TSP_END:
                         // Signal end of input to successors and abort
-                        // to predecessors
+                        // to predecessors. This packet is not passed.
                         input_end = aborted = true;
-                        pkt_done--;
-                        pkt_flush--;
-                        pkt_cnt = pkt_done;
+                        processed = n;
+                        pkt_cnt = pkt_done + n;
                         break;
                     default:
                         // Invalid status, report error and accept packet.
-                        error(u"invalid packet processing status %d", {status});
+                        error(u"invalid packet processing status %d", {status[n]});
                         break;
                 }
+            }
+
+            pkt_done += processed;
+            pkt_flush += processed;
 
-                // If the packet processor has signaled a new bitrate, get it.
-                if (bitrate_changed) {
-                    BitRate new_bitrate = _processor->getBitrate();
-                    if (new_bitrate != 0) {
-                        bitrate_never_modified = false;
-                        output_bitrate = new_bitrate;
-                    }
+            // If the packet processor has signaled a new bitrate, get it.
+            if (bitrate_changed) {
+                BitRate new_bitrate = _processor->getBitrate();
+                if (new_bitrate != 0) {
+                    bitrate_never_modified = false;
+                    output_bitrate = new_bitrate;
                 }
             }
 
-            addTotalPackets (1);
-
             // Do not wait to process pkt_cnt packets before notifying
             // the next processor. Perform periodic flush to avoid waiting
             // too long before two output operations.
@@ -176,6 +184,7 @@ void ts::tsp::ProcessorExecutor::main()
     // Close the packet processor
     _processor->stop();
 
+    _cpu_time = GetThreadCPUTime();
     debug(u"packet processing thread %s after %'d packets, %'d passed, %'d dropped, %'d nullified",
           {aborted ? u"aborted" : u"terminated", totalPackets(), passed_packets, dropped_packets, nullified_packets});
 }
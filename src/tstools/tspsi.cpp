@@ -32,7 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsArgs.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileInputArgs.h"
 #include "tsPSILogger.h"
 #include "tsVersionInfo.h"
 TSDUCK_SOURCE;
@@ -49,34 +49,59 @@ struct Options: public ts::Args
     ts::UString           infile;   // Input file name
     ts::PSILoggerArgs     logger;   // Table logging options
     ts::TablesDisplayArgs display;  // Table formatting options.
+    ts::TSFileInputArgs   input;    // Input file options.
 };
 
 Options::Options(int argc, char *argv[]) :
     ts::Args(u"MPEG Transport Stream PSI Extraction Utility.", u"[options] [filename]"),
     infile(),
     logger(),
-    display()
+    display(),
+    input()
 {
     option(u"", 0, STRING, 0, 1);
     logger.defineOptions(*this);
     display.defineOptions(*this);
+    input.defineOptions(*this);
 
     setHelp(u"Input file:\n"
             u"\n"
             u"  MPEG capture file (standard input if omitted).\n");
     logger.addHelp(*this);
     display.addHelp(*this);
+    input.addHelp(*this);
 
     analyze(argc, argv);
 
     infile = value(u"");
     logger.load(*this);
     display.load(*this);
+    input.load(*this);
 
     exitOnError();
 }
 
 
+//----------------------------------------------------------------------------
+//  Pass packets to the PSI logger until all expected tables are logged.
+//----------------------------------------------------------------------------
+
+class PSIHandler: public ts::TSPacketHandlerInterface
+{
+public:
+    PSIHandler(ts::PSILogger& logger) : _logger(logger) {}
+
+    virtual bool handleTSPacket(const ts::TSPacket& pkt) override
+    {
+        _logger.feedPacket(pkt);
+        return !_logger.completed();
+    }
+
+private:
+    ts::PSILogger& _logger;
+};
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -85,14 +110,13 @@ int main (int argc, char *argv[])
 {
     TSDuckLibCheckVersion();
     Options opt(argc, argv);
-    ts::InputRedirector input(opt.infile, opt);
     ts::TablesDisplay display(opt.display, opt);
     ts::PSILogger logger(opt.logger, display, opt);
-    ts::TSPacket pkt;
 
-    // Read all packets in the file and pass them to the logger
-    while (!logger.completed() && pkt.read(std::cin, true, opt)) {
-        logger.feedPacket(pkt);
+    // Read all packets in the file and pass them to the logger.
+    PSIHandler handler(logger);
+    if (!opt.input.readPackets(opt.infile, handler, opt)) {
+        return EXIT_FAILURE;
     }
 
     // Report errors
@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  Helpers for performance measurements in unitary tests.
+//
+//----------------------------------------------------------------------------
+
+#include "utestBenchmark.h"
+
+
+//----------------------------------------------------------------------------
+// Fill a byte block with pseudo-random bytes.
+//----------------------------------------------------------------------------
+
+void utest::Random::fill(ts::ByteBlock& data, size_t size)
+{
+    data.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = uint8_t(next() >> 16);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Chronometer.
+//----------------------------------------------------------------------------
+
+utest::Chronometer::Chronometer() :
+    _start()
+{
+    restart();
+}
+
+void utest::Chronometer::restart()
+{
+    _start.getSystemTime();
+}
+
+ts::NanoSecond utest::Chronometer::elapsed() const
+{
+    ts::Monotonic now;
+    now.getSystemTime();
+    return std::max<ts::NanoSecond>(1, now - _start);
+}
+
+int64_t utest::Chronometer::perSecond(int64_t count) const
+{
+    return count * ts::NanoSecPerSec / elapsed();
+}
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Helpers for performance measurements in unitary tests.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "utestCppUnitTest.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
+
+namespace utest {
+    //!
+    //! Reproducible pseudo-random generator for test data.
+    //!
+    //! This is a simple linear congruential generator. It is not random at all
+    //! but the same sequence is produced on all systems, which makes test failures
+    //! and performance measurements reproducible.
+    //!
+    class Random
+    {
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] seed Initial seed of the sequence.
+        //!
+        explicit Random(uint32_t seed = 0x12345678) : _state(seed) {}
+
+        //!
+        //! Get the next value in the sequence.
+        //! @return The complete 32-bit state of the generator. The low-order bits
+        //! are poorly distributed, use the high-order bits.
+        //!
+        uint32_t next()
+        {
+            return _state = _state * 1103515245 + 12345;
+        }
+
+        //!
+        //! Get the next value in the sequence, within a range.
+        //! @param [in] modulo The returned value is in the range 0 to @a modulo - 1.
+        //! @return The next pseudo-random value.
+        //!
+        uint32_t next(uint32_t modulo)
+        {
+            return (next() >> 8) % modulo;
+        }
+
+        //!
+        //! Fill a byte block with pseudo-random bytes.
+        //! @param [out] data The byte block to fill.
+        //! @param [in] size Size in bytes of @a data after filling.
+        //!
+        void fill(ts::ByteBlock& data, size_t size);
+
+    private:
+        uint32_t _state;
+    };
+
+    //!
+    //! Chronometer for performance measurements.
+    //!
+    //! The time is measured using the monotonic system clock. The chronometer
+    //! is started when it is created.
+    //!
+    class Chronometer
+    {
+    public:
+        //!
+        //! Constructor, start the chronometer.
+        //!
+        Chronometer();
+
+        //!
+        //! Restart the chronometer.
+        //!
+        void restart();
+
+        //!
+        //! Get the elapsed time since the start of the chronometer.
+        //! @return The elapsed time in nanoseconds, at least 1 nanosecond.
+        //!
+        ts::NanoSecond elapsed() const;
+
+        //!
+        //! Compute a throughput since the start of the chronometer.
+        //! @param [in] count Number of items (packets, bytes, sections) which were processed.
+        //! @return Number of items per second.
+        //!
+        int64_t perSecond(int64_t count) const;
+
+    private:
+        ts::Monotonic _start;
+    };
+}
@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::CRC32
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32.h"
+#include "tsByteBlock.h"
+#include "utestBenchmark.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class CRC32Test: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testReference();
+    void testAlgorithms();
+    void testBenchmark();
+
+    CPPUNIT_TEST_SUITE(CRC32Test);
+    CPPUNIT_TEST(testReference);
+    CPPUNIT_TEST(testAlgorithms);
+    CPPUNIT_TEST(testBenchmark);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    static const ts::CRC32::Algorithm _algos[];
+    static const char* const _names[];
+    static const size_t _algoCount;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CRC32Test);
+
+const ts::CRC32::Algorithm CRC32Test::_algos[] = {ts::CRC32::BYTEWISE, ts::CRC32::SLICING8, ts::CRC32::PCLMUL, ts::CRC32::DEFAULT};
+const char* const CRC32Test::_names[] = {"bytewise", "slicing-by-8", "pclmul", "default"};
+const size_t CRC32Test::_algoCount = sizeof(_algos) / sizeof(_algos[0]);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void CRC32Test::setUp()
+{
+}
+
+// Test suite cleanup method.
+void CRC32Test::tearDown()
+{
+}
+
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void CRC32Test::testReference()
+{
+    // Check value of CRC-32/MPEG-2.
+    for (size_t i = 0; i < _algoCount; ++i) {
+        ts::CRC32 crc;
+        crc.add("123456789", 9, _algos[i]);
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0x0376E6E7), crc.value());
+    }
+
+    // The CRC32 of a complete section, including its CRC32 field, is zero.
+    ts::ByteBlock section;
+    utest::Random().fill(section, 1000);
+    for (size_t i = 0; i < _algoCount; ++i) {
+        ts::CRC32 crc;
+        crc.add(section.data(), section.size() - 4, _algos[i]);
+        ts::PutUInt32(section.data() + section.size() - 4, crc.value());
+        crc.reset();
+        crc.add(section.data(), section.size(), _algos[i]);
+        CPPUNIT_ASSERT_EQUAL(uint32_t(0), crc.value());
+    }
+
+    CPPUNIT_ASSERT(ts::CRC32::IsAvailable(ts::CRC32::DEFAULT));
+    CPPUNIT_ASSERT(ts::CRC32::IsAvailable(ts::CRC32::BYTEWISE));
+    CPPUNIT_ASSERT(ts::CRC32::IsAvailable(ts::CRC32::SLICING8));
+    utest::Out() << "CRC32Test: PCLMUL " << (ts::CRC32::IsAvailable(ts::CRC32::PCLMUL) ? "" : "not ") << "available" << std::endl;
+}
+
+void CRC32Test::testAlgorithms()
+{
+    // All algorithms, all sizes up to 300 bytes, all alignments, in one or two parts.
+    ts::ByteBlock data;
+    utest::Random().fill(data, 4096 + 16);
+
+    for (size_t size = 0; size <= 300; ++size) {
+        for (size_t offset = 0; offset < 8; ++offset) {
+            const ts::CRC32 ref(data.data() + offset, size);
+            for (size_t i = 0; i < _algoCount; ++i) {
+                ts::CRC32 crc;
+                crc.add(data.data() + offset, size, _algos[i]);
+                CPPUNIT_ASSERT_EQUAL(ref.value(), crc.value());
+                ts::CRC32 crc2;
+                crc2.add(data.data() + offset, size / 3, _algos[i]);
+                crc2.add(data.data() + offset + size / 3, size - size / 3, _algos[i]);
+                CPPUNIT_ASSERT_EQUAL(ref.value(), crc2.value());
+            }
+        }
+    }
+
+    // Large sizes.
+    for (size_t size = 1000; size <= 4096; size += 517) {
+        ts::CRC32 ref;
+        ref.add(data.data() + 3, size, ts::CRC32::BYTEWISE);
+        for (size_t i = 0; i < _algoCount; ++i) {
+            ts::CRC32 crc;
+            crc.add(data.data() + 3, size, _algos[i]);
+            CPPUNIT_ASSERT_EQUAL(ref.value(), crc.value());
+        }
+    }
+}
+
+void CRC32Test::testBenchmark()
+{
+    if (!utest::BenchmarkMode()) {
+        return;
+    }
+
+    // Throughput on 4 KB sections, the maximum size of private sections.
+    const size_t sectionSize = 4096;
+    const size_t sectionCount = 64;
+    const size_t iterations = 40;
+
+    ts::ByteBlock data;
+    utest::Random().fill(data, sectionSize * sectionCount);
+
+    // Reference sum of all CRC32, to check the results.
+    uint32_t refSum = 0;
+    for (size_t sec = 0; sec < sectionCount; ++sec) {
+        refSum += ts::CRC32(data.data() + sec * sectionSize, sectionSize).value();
+    }
+
+    for (size_t i = 0; i < _algoCount; ++i) {
+        if (!ts::CRC32::IsAvailable(_algos[i])) {
+            continue;
+        }
+        uint32_t sum = 0;
+        utest::Chronometer chrono;
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            for (size_t sec = 0; sec < sectionCount; ++sec) {
+                ts::CRC32 crc;
+                crc.add(data.data() + sec * sectionSize, sectionSize, _algos[i]);
+                sum += crc.value();
+            }
+        }
+        const int64_t rate = chrono.perSecond(iterations * sectionCount * sectionSize);
+        CPPUNIT_ASSERT_EQUAL(uint32_t(refSum * iterations), sum);
+        utest::Out() << "CRC32Test: " << _names[i] << ": " << (rate / 1000000) << " MB/s" << std::endl;
+    }
+}
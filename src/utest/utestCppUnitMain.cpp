@@ -79,6 +79,9 @@ utest::CppUnitMain::CppUnitMain(int argc, char* argv[], const char* outName) :
             case 'v':
                 _runMode = opt[1];
                 break;
+            case 'b':
+                SetBenchmarkMode(true);
+                break;
             case 'd':
                 _debug = true;
                 break;
@@ -127,6 +130,7 @@ int utest::CppUnitMain::usage()
               << std::endl
               << "The available options are:" << std::endl
               << "  -a : Automated test mode, default XML file: " << _outName << _outSuffix << std::endl
+              << "  -b : Run the performance measurements, results are debug messages" << std::endl
               << "  -d : Debug messages are output on standard error" << std::endl
               << "  -l : List all tests but do not execute them" << std::endl
               << "  -n : Normal basic mode (default)" << std::endl
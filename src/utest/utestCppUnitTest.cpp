@@ -38,6 +38,7 @@
 
 namespace {
     std::ofstream _debugStream;
+    bool _benchmarkMode = false;
 }
 
 //----------------------------------------------------------------------------
@@ -50,6 +51,21 @@ bool utest::DebugMode()
 }
 
 
+//----------------------------------------------------------------------------
+// Benchmark mode (performance measurements).
+//----------------------------------------------------------------------------
+
+bool utest::BenchmarkMode()
+{
+    return _benchmarkMode;
+}
+
+void utest::SetBenchmarkMode(bool on)
+{
+    _benchmarkMode = on;
+}
+
+
 //----------------------------------------------------------------------------
 // This static method returns a reference to the actual output file
 // stream used to report debug messages.
@@ -66,6 +66,18 @@ namespace utest {
     //!
     bool DebugMode();
 
+    //!
+    //! This static method checks if benchmark mode is active.
+    //!
+    //! Performance measurements are long and their results depend on the
+    //! system. They are run only when the option -b (benchmark) is specified
+    //! on the command line of the unitary test driver. The results are
+    //! reported as debug messages, use option -d to display them.
+    //!
+    //! @return True if benchmark mode is active, false otherwise.
+    //!
+    bool BenchmarkMode();
+
     //!
     //! This static method returns a reference to an output stream
     //! which can be used by unitary tests to log messages.
@@ -97,5 +109,12 @@ namespace utest {
     //! @return A reference to the output file stream.
     //!
     std::ofstream& DebugStream();
+
+    //!
+    //! This static method sets the benchmark mode.
+    //!
+    //! @param [in] on True to run the performance measurements.
+    //!
+    void SetBenchmarkMode(bool on);
 #endif
 }
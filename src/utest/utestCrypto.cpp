@@ -46,7 +46,7 @@
 #include "tsCTS4.h"
 #include "tsDVS042.h"
 #include "tsSystemRandomGenerator.h"
-#include "utestCppUnitTest.h"
+#include "utestBenchmark.h"
 TSDUCK_SOURCE;
 
 #include "crypto/tv_aes.h"
@@ -79,6 +79,9 @@ public:
     void testAES_CTS3();
     void testAES_CTS4();
     void testAES_DVS042();
+    void testAESBlocks();
+    void testAES_CBCInPlace();
+    void testAESBenchmark();
     void testDES();
     void testTDES();
     void testTDES_CBC();
@@ -97,6 +100,9 @@ public:
     CPPUNIT_TEST(testAES_CTS3);
     CPPUNIT_TEST(testAES_CTS4);
     CPPUNIT_TEST(testAES_DVS042);
+    CPPUNIT_TEST(testAESBlocks);
+    CPPUNIT_TEST(testAES_CBCInPlace);
+    CPPUNIT_TEST(testAESBenchmark);
     CPPUNIT_TEST(testDES);
     CPPUNIT_TEST(testTDES);
     CPPUNIT_TEST(testTDES_CBC);
@@ -363,6 +369,153 @@ void CryptoTest::testAES_DVS042()
     testChainingSizes(dvs042_aes, 16, 17, 23, 31, 32, 33, 45, 64, 67, 184, 12345, 0);
 }
 
+void CryptoTest::testAESBlocks()
+{
+    // Compare multi-block processing (hardware-accelerated if available) with the software implementation.
+    utest::Out() << "CryptoTest: AES hardware acceleration: " << ts::UString::YesNo(ts::AES::IsAccelerated()) << std::endl;
+
+    ts::SystemRandomGenerator prng;
+    ts::AES soft;
+    ts::AES fast;
+    soft.setAcceleration(false);
+    CPPUNIT_ASSERT(!soft.getAcceleration());
+    CPPUNIT_ASSERT_EQUAL(ts::AES::IsAccelerated(), fast.getAcceleration());
+
+    const size_t key_sizes[] = {16, 24, 32};
+    for (size_t ki = 0; ki < sizeof(key_sizes) / sizeof(key_sizes[0]); ++ki) {
+        for (size_t count = 0; count <= 21; ++count) {
+            const size_t size = count * ts::AES::BLOCK_SIZE;
+            ts::ByteBlock key(key_sizes[ki]);
+            ts::ByteBlock plain(size);
+            ts::ByteBlock ref(size);
+            ts::ByteBlock cipher(size);
+            ts::ByteBlock decipher(size);
+
+            CPPUNIT_ASSERT(prng.read(key.data(), key.size()));
+            CPPUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+            CPPUNIT_ASSERT(soft.setKey(key.data(), key.size()));
+            CPPUNIT_ASSERT(fast.setKey(key.data(), key.size()));
+
+            // Reference: one block at a time in software.
+            for (size_t i = 0; i < size; i += ts::AES::BLOCK_SIZE) {
+                CPPUNIT_ASSERT(soft.encrypt(&plain[i], ts::AES::BLOCK_SIZE, &ref[i], ts::AES::BLOCK_SIZE));
+            }
+
+            CPPUNIT_ASSERT(fast.encryptBlocks(plain.data(), cipher.data(), count));
+            CPPUNIT_ASSERT(cipher == ref);
+            CPPUNIT_ASSERT(fast.decryptBlocks(cipher.data(), decipher.data(), count));
+            CPPUNIT_ASSERT(decipher == plain);
+
+            // In-place.
+            CPPUNIT_ASSERT(fast.encryptBlocks(decipher.data(), decipher.data(), count));
+            CPPUNIT_ASSERT(decipher == ref);
+            CPPUNIT_ASSERT(soft.decryptBlocks(decipher.data(), decipher.data(), count));
+            CPPUNIT_ASSERT(decipher == plain);
+
+            // Single block interface.
+            if (count > 0) {
+                CPPUNIT_ASSERT(fast.encrypt(&plain[0], ts::AES::BLOCK_SIZE, &cipher[0], ts::AES::BLOCK_SIZE));
+                CPPUNIT_ASSERT(::memcmp(&cipher[0], &ref[0], ts::AES::BLOCK_SIZE) == 0);
+                CPPUNIT_ASSERT(fast.decrypt(&ref[0], ts::AES::BLOCK_SIZE, &decipher[0], ts::AES::BLOCK_SIZE));
+                CPPUNIT_ASSERT(::memcmp(&decipher[0], &plain[0], ts::AES::BLOCK_SIZE) == 0);
+            }
+        }
+    }
+}
+
+void CryptoTest::testAES_CBCInPlace()
+{
+    // CBC and DVS042 decryption are pipelined, check in-place decryption across pipeline boundaries.
+    ts::SystemRandomGenerator prng;
+    ts::CBC<ts::AES> cbc;
+    ts::DVS042<ts::AES> dvs;
+    ts::ByteBlock key(16);
+    ts::ByteBlock iv(16);
+    CPPUNIT_ASSERT(prng.read(key.data(), key.size()));
+    CPPUNIT_ASSERT(prng.read(iv.data(), iv.size()));
+    CPPUNIT_ASSERT(cbc.setKey(key.data(), key.size()));
+    CPPUNIT_ASSERT(cbc.setIV(iv.data(), iv.size()));
+    CPPUNIT_ASSERT(dvs.setKey(key.data(), key.size()));
+    CPPUNIT_ASSERT(dvs.setIV(iv.data(), iv.size()));
+
+    const size_t sizes[] = {16, 32, 128, 144, 184, 256, 1024, 1040};
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+        const size_t size = sizes[si];
+        ts::ByteBlock plain(size);
+        ts::ByteBlock data(size);
+        CPPUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+
+        if (size % 16 == 0) {
+            CPPUNIT_ASSERT(cbc.encrypt(plain.data(), size, data.data(), size));
+            CPPUNIT_ASSERT(cbc.decrypt(data.data(), size, data.data(), size));
+            CPPUNIT_ASSERT(data == plain);
+        }
+
+        CPPUNIT_ASSERT(dvs.encrypt(plain.data(), size, data.data(), size));
+        CPPUNIT_ASSERT(dvs.decrypt(data.data(), size, data.data(), size));
+        CPPUNIT_ASSERT(data == plain);
+    }
+}
+
+void CryptoTest::testAESBenchmark()
+{
+    if (!utest::BenchmarkMode()) {
+        return;
+    }
+
+    // Throughput of AES on large buffers, software and hardware-accelerated.
+    const size_t size = 64 * 1024;
+    const size_t iterations = 16;
+    const bool accel[] = {false, true};
+
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock key(16);
+    ts::ByteBlock iv(16);
+    ts::ByteBlock data(size);
+    CPPUNIT_ASSERT(prng.read(key.data(), key.size()));
+    CPPUNIT_ASSERT(prng.read(iv.data(), iv.size()));
+    CPPUNIT_ASSERT(prng.read(data.data(), data.size()));
+
+    for (size_t ai = 0; ai < sizeof(accel) / sizeof(accel[0]); ++ai) {
+        if (accel[ai] && !ts::AES::IsAccelerated()) {
+            continue;
+        }
+        ts::AES aes;
+        aes.setAcceleration(accel[ai]);
+        CPPUNIT_ASSERT(aes.setKey(key.data(), key.size()));
+
+        utest::Chronometer chrono;
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            CPPUNIT_ASSERT(aes.encryptBlocks(data.data(), data.data(), size / ts::AES::BLOCK_SIZE));
+        }
+        const int64_t encrypt = chrono.perSecond(iterations * size);
+        chrono.restart();
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            CPPUNIT_ASSERT(aes.decryptBlocks(data.data(), data.data(), size / ts::AES::BLOCK_SIZE));
+        }
+        const int64_t decrypt = chrono.perSecond(iterations * size);
+        utest::Out() << "CryptoTest: AES-128 " << (accel[ai] ? "AES-NI" : "software") << ": encrypt: "
+                     << (encrypt / (1024 * 1024)) << " MB/s, decrypt: " << (decrypt / (1024 * 1024)) << " MB/s" << std::endl;
+    }
+
+    // CBC decryption uses the pipeline, CBC encryption is sequential by nature.
+    ts::CBC<ts::AES> cbc;
+    CPPUNIT_ASSERT(cbc.setKey(key.data(), key.size()));
+    CPPUNIT_ASSERT(cbc.setIV(iv.data(), iv.size()));
+    utest::Chronometer chrono;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        CPPUNIT_ASSERT(cbc.encrypt(data.data(), size, data.data(), size));
+    }
+    const int64_t encrypt = chrono.perSecond(iterations * size);
+    chrono.restart();
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        CPPUNIT_ASSERT(cbc.decrypt(data.data(), size, data.data(), size));
+    }
+    const int64_t decrypt = chrono.perSecond(iterations * size);
+    utest::Out() << "CryptoTest: AES-128-CBC default: encrypt: "
+                 << (encrypt / (1024 * 1024)) << " MB/s, decrypt: " << (decrypt / (1024 * 1024)) << " MB/s" << std::endl;
+}
+
 void CryptoTest::testDES()
 {
     ts::DES des;
@@ -43,7 +43,7 @@
 #include "tsTOT.h"
 #include "tsTDT.h"
 #include "tsNames.h"
-#include "utestCppUnitTest.h"
+#include "utestBenchmark.h"
 TSDUCK_SOURCE;
 
 #include "tables/psi_bat_cplus_packets.h"
@@ -88,6 +88,10 @@ public:
     void testBATCanalPlus();
     void testTDT();
     void testTOT();
+    void testVersionChange();
+    void testRepeatedPackets();
+    void testHighThroughput();
+    void testEITBenchmark();
 
     CPPUNIT_TEST_SUITE(DemuxTest);
     CPPUNIT_TEST(testPAT);
@@ -100,6 +104,10 @@ public:
     CPPUNIT_TEST(testBATCanalPlus);
     CPPUNIT_TEST(testTDT);
     CPPUNIT_TEST(testTOT);
+    CPPUNIT_TEST(testVersionChange);
+    CPPUNIT_TEST(testRepeatedPackets);
+    CPPUNIT_TEST(testHighThroughput);
+    CPPUNIT_TEST(testEITBenchmark);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -111,6 +119,34 @@ private:
 
     // Unitary test for one table.
     void testTable(const char* name, const uint8_t* ref_packets, size_t ref_packets_size, const uint8_t* ref_sections, size_t ref_sections_size);
+
+    // Build a stream of EIT sections for many services.
+    static void BuildEITStream(ts::TSPacketVector& packets, size_t services);
+
+    // Section and table handler, accumulate statistics on demuxed sections and tables.
+    class SectionCounter: public ts::SectionHandlerInterface, public ts::TableHandlerInterface
+    {
+    public:
+        SectionCounter() : sections(0), tables(0), bytes(0), crc() {}
+        size_t     sections;
+        size_t     tables;
+        size_t     bytes;
+        ts::CRC32  crc;
+        virtual void handleSection(ts::SectionDemux& demux, const ts::Section& section) override;
+        virtual void handleTable(ts::SectionDemux& demux, const ts::BinaryTable& table) override;
+    };
+
+    // Table handler which keeps the sections of all demuxed tables.
+    class SectionKeeper: public ts::TableHandlerInterface
+    {
+    public:
+        SectionKeeper() : sections() {}
+        ts::SectionPtrVector sections;
+        virtual void handleTable(ts::SectionDemux& demux, const ts::BinaryTable& table) override;
+    };
+
+    // Demux a stream, repeated several times, return the section counter.
+    static void Demux(SectionCounter& counter, const ts::TSPacketVector& packets, size_t repeat, bool high_throughput);
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DemuxTest);
@@ -487,3 +523,185 @@ void DemuxTest::testTOT()
          psi_tot_tnt_packets, sizeof(psi_tot_tnt_packets),
          psi_tot_tnt_sections, sizeof(psi_tot_tnt_sections));
 }
+
+// Section and table handler, accumulate statistics on demuxed sections and tables.
+void DemuxTest::SectionCounter::handleSection(ts::SectionDemux& demux, const ts::Section& section)
+{
+    sections++;
+    bytes += section.size();
+    crc.add(section.content(), section.size());
+}
+
+void DemuxTest::SectionCounter::handleTable(ts::SectionDemux& demux, const ts::BinaryTable& table)
+{
+    tables++;
+}
+
+void DemuxTest::SectionKeeper::handleTable(ts::SectionDemux& demux, const ts::BinaryTable& table)
+{
+    for (size_t i = 0; i < table.sectionCount(); ++i) {
+        sections.push_back(table.sectionAt(i));
+    }
+}
+
+void DemuxTest::testVersionChange()
+{
+    // The sections of a table which are kept by the application must remain
+    // valid when the demux receives a new version of the table.
+    uint8_t payload[100];
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = uint8_t(i);
+    }
+    ts::OneShotPacketizer pzer(0x0100);
+    for (uint8_t version = 1; version <= 3; ++version) {
+        for (uint8_t sn = 0; sn < 2; ++sn) {
+            pzer.addSection(new ts::Section(0x80, true, 0x1234, version, true, sn, 1, payload, sizeof(payload)));
+        }
+    }
+    ts::TSPacketVector packets;
+    pzer.getPackets(packets);
+
+    SectionKeeper keeper;
+    ts::SectionDemux demux(&keeper, 0, ts::AllPIDs);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux.feedPacket(packets[i]);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(size_t(6), keeper.sections.size());
+    for (size_t i = 0; i < keeper.sections.size(); ++i) {
+        CPPUNIT_ASSERT(!keeper.sections[i].isNull());
+        CPPUNIT_ASSERT(keeper.sections[i]->isValid());
+        CPPUNIT_ASSERT_EQUAL(uint8_t(1 + i / 2), keeper.sections[i]->version());
+        CPPUNIT_ASSERT_EQUAL(uint8_t(i % 2), keeper.sections[i]->sectionNumber());
+    }
+}
+
+void DemuxTest::testRepeatedPackets()
+{
+    // Repeated packets are skipped by the demux but a table which changes
+    // and short sections must be reported each time.
+    uint8_t payload[100];
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = uint8_t(i);
+    }
+    ts::TSPacketVector v1;
+    ts::TSPacketVector v2;
+    ts::OneShotPacketizer pzer(0x0100);
+    pzer.addSection(new ts::Section(0x80, true, 0x1234, 1, true, 0, 0, payload, sizeof(payload)));
+    pzer.getPackets(v1);
+    pzer.removeAll();
+    pzer.addSection(new ts::Section(0x80, true, 0x1234, 2, true, 0, 0, payload, sizeof(payload)));
+    pzer.getPackets(v2);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), v1.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), v2.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(ts::PKT_SIZE), sizeof(psi_tdt_tnt_packets));
+
+    ts::TSPacket tdt;
+    ::memcpy(tdt.b, psi_tdt_tnt_packets, ts::PKT_SIZE);  // Flawfinder: ignore: memcpy()
+    tdt.setPID(0x0100);
+
+    const ts::TSPacket* const stream[] = {&v1[0], &v1[0], &v1[0], &v2[0], &v2[0], &v1[0], &v1[0], &tdt, &tdt, &tdt};
+    const size_t count = sizeof(stream) / sizeof(stream[0]);
+
+    SectionKeeper keeper;
+    ts::SectionDemux demux(&keeper, 0, ts::AllPIDs);
+    ts::TSPacket pkt;
+    for (size_t i = 0; i < count; ++i) {
+        pkt = *stream[i];
+        pkt.setCC(uint8_t(i % ts::CC_MAX));
+        demux.feedPacket(pkt);
+    }
+    CPPUNIT_ASSERT(!demux.hasErrors());
+
+    CPPUNIT_ASSERT_EQUAL(size_t(6), keeper.sections.size());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(1), keeper.sections[0]->version());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(2), keeper.sections[1]->version());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(1), keeper.sections[2]->version());
+    for (size_t i = 3; i < keeper.sections.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(ts::TID(ts::TID_TDT), keeper.sections[i]->tableId());
+    }
+}
+
+// Build a stream of EIT sections for many services: EIT p/f (two sections)
+// and EIT schedule (eight sections) with various sizes.
+void DemuxTest::BuildEITStream(ts::TSPacketVector& packets, size_t services)
+{
+    ts::OneShotPacketizer pzer(ts::PID_EIT);
+    uint8_t payload[ts::MAX_PRIVATE_LONG_SECTION_PAYLOAD_SIZE];
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = uint8_t(i * 7 + 3);
+    }
+    for (size_t srv = 0; srv < services; ++srv) {
+        const uint16_t service_id = uint16_t(0x0100 + srv);
+        for (uint8_t sn = 0; sn < 2; ++sn) {
+            const size_t size = 20 + (srv * 37 + sn * 101) % 400;
+            pzer.addSection(new ts::Section(ts::TID_EIT_PF_ACT, true, service_id, 1, true, sn, 1, payload, size));
+        }
+        for (uint8_t sn = 0; sn < 8; ++sn) {
+            const size_t size = 100 + (srv * 53 + sn * 211) % 1500;
+            pzer.addSection(new ts::Section(ts::TID_EIT_S_ACT_MIN, true, service_id, 3, true, sn, 7, payload, size));
+        }
+    }
+    pzer.getPackets(packets);
+}
+
+// Demux a stream, repeated several times, with continuous continuity counters.
+void DemuxTest::Demux(SectionCounter& counter, const ts::TSPacketVector& packets, size_t repeat, bool high_throughput)
+{
+    ts::SectionDemux demux(&counter, &counter, ts::AllPIDs);
+    demux.setHighThroughput(high_throughput);
+    CPPUNIT_ASSERT_EQUAL(high_throughput, demux.highThroughput());
+
+    uint8_t cc = 0;
+    ts::TSPacket pkt;
+    for (size_t r = 0; r < repeat; ++r) {
+        for (size_t i = 0; i < packets.size(); ++i) {
+            pkt = packets[i];
+            pkt.setCC(cc);
+            cc = (cc + 1) % ts::CC_MAX;
+            demux.feedPacket(pkt);
+        }
+    }
+    CPPUNIT_ASSERT(!demux.hasErrors());
+}
+
+void DemuxTest::testHighThroughput()
+{
+    // Both modes must demux exactly the same sections and tables.
+    ts::TSPacketVector packets;
+    BuildEITStream(packets, 50);
+
+    SectionCounter normal;
+    SectionCounter fast;
+    Demux(normal, packets, 3, false);
+    Demux(fast, packets, 3, true);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3 * 50 * 10), normal.sections);
+    CPPUNIT_ASSERT_EQUAL(size_t(50 * 2), normal.tables);
+    CPPUNIT_ASSERT_EQUAL(normal.sections, fast.sections);
+    CPPUNIT_ASSERT_EQUAL(normal.tables, fast.tables);
+    CPPUNIT_ASSERT_EQUAL(normal.bytes, fast.bytes);
+    CPPUNIT_ASSERT(normal.crc.value() == fast.crc.value());
+}
+
+void DemuxTest::testEITBenchmark()
+{
+    if (!utest::BenchmarkMode()) {
+        return;
+    }
+
+    // Throughput of the section demux on an EIT-heavy stream.
+    ts::TSPacketVector packets;
+    BuildEITStream(packets, 200);
+    const size_t repeat = 10;
+
+    for (int mode = 0; mode < 2; ++mode) {
+        SectionCounter counter;
+        utest::Chronometer chrono;
+        Demux(counter, packets, repeat, mode != 0);
+        const ts::NanoSecond duration = chrono.elapsed();
+        utest::Out() << "DemuxTest: EIT demux, " << (mode != 0 ? "high-throughput" : "normal") << " mode: "
+                     << (ts::NanoSecond(counter.sections) * ts::NanoSecPerSec / duration) << " sections/s, "
+                     << (ts::NanoSecond(repeat * packets.size()) * ts::NanoSecPerSec / duration) << " packets/s" << std::endl;
+    }
+}
@@ -0,0 +1,218 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for tsMemoryUtils.h
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemoryUtils.h"
+#include "tsByteBlock.h"
+#include "utestBenchmark.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class MemoryUtilsTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testLocatePattern();
+    void testLocateStartCodePrefix();
+    void testLocateNALUnitEnd();
+    void testLocateLastBlock();
+    void testLocateBenchmark();
+
+    CPPUNIT_TEST_SUITE(MemoryUtilsTest);
+    CPPUNIT_TEST(testLocatePattern);
+    CPPUNIT_TEST(testLocateStartCodePrefix);
+    CPPUNIT_TEST(testLocateNALUnitEnd);
+    CPPUNIT_TEST(testLocateLastBlock);
+    CPPUNIT_TEST(testLocateBenchmark);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MemoryUtilsTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void MemoryUtilsTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void MemoryUtilsTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+namespace {
+    // Build a buffer of mostly zeroes, ones and other values, to have many
+    // candidate sequences, using a simple deterministic generator.
+    void BuildBuffer(ts::ByteBlock& data, size_t size, uint32_t seed)
+    {
+        utest::Random random(seed);
+        data.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            const uint32_t x = random.next();
+            const uint32_t r = (x >> 16) % 16;
+            data[i] = r < 9 ? 0x00 : (r < 11 ? 0x01 : uint8_t(x >> 8));
+        }
+    }
+
+    // Reference implementation: first sequence 00 00 xx with xx in [low, high].
+    const uint8_t* Reference(const uint8_t* area, size_t size, uint8_t low, uint8_t high)
+    {
+        for (size_t i = 0; i + 2 < size; ++i) {
+            if (area[i] == 0 && area[i + 1] == 0 && area[i + 2] >= low && area[i + 2] <= high) {
+                return area + i;
+            }
+        }
+        return 0;
+    }
+}
+
+void MemoryUtilsTest::testLocatePattern()
+{
+    static const uint8_t data[] = {0x10, 0x00, 0x00, 0x02, 0x00, 0x00, 0x01, 0xB3, 0x00, 0x00, 0x01};
+    static const uint8_t prefix[] = {0x00, 0x00, 0x01};
+
+    CPPUNIT_ASSERT(ts::LocatePattern(data, sizeof(data), prefix, sizeof(prefix)) == data + 4);
+    CPPUNIT_ASSERT(ts::LocatePattern(data + 5, sizeof(data) - 5, prefix, sizeof(prefix)) == data + 8);
+    CPPUNIT_ASSERT(ts::LocatePattern(data + 9, sizeof(data) - 9, prefix, sizeof(prefix)) == 0);
+    CPPUNIT_ASSERT(ts::LocatePattern(data, sizeof(data), prefix, 0) == 0);
+}
+
+void MemoryUtilsTest::testLocateStartCodePrefix()
+{
+    static const uint8_t data[] = {0x10, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0xB3, 0x00, 0x00, 0x01};
+
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(data, sizeof(data)) == data + 5);
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(data + 6, sizeof(data) - 6) == data + 9);
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(data + 10, sizeof(data) - 10) == 0);
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(data, 0) == 0);
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(0, 10) == 0);
+
+    // Compare with the reference implementation on all sizes and alignments, with and without SIMD.
+    ts::ByteBlock buf;
+    BuildBuffer(buf, 300, 7);
+    for (size_t start = 0; start < 40; ++start) {
+        for (size_t size = 0; start + size <= buf.size(); ++size) {
+            CPPUNIT_ASSERT(ts::LocateStartCodePrefix(&buf[start], size) == Reference(&buf[start], size, 1, 1));
+        }
+    }
+
+    // Long area without any start code, then one at the end.
+    buf.assign(1000, 0x47);
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(buf.data(), buf.size()) == 0);
+    buf[997] = buf[998] = 0x00;
+    buf[999] = 0x01;
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(buf.data(), buf.size()) == buf.data() + 997);
+    CPPUNIT_ASSERT(ts::LocateStartCodePrefix(buf.data(), buf.size() - 1) == 0);
+}
+
+void MemoryUtilsTest::testLocateNALUnitEnd()
+{
+    static const uint8_t data[] = {0x67, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x68, 0x00, 0x00, 0x01};
+
+    CPPUNIT_ASSERT(ts::LocateNALUnitEnd(data, sizeof(data)) == data + 4);
+    CPPUNIT_ASSERT(ts::LocateNALUnitEnd(data + 5, sizeof(data) - 5) == data + 5);
+    CPPUNIT_ASSERT(ts::LocateNALUnitEnd(data + 6, sizeof(data) - 6) == data + 9);
+    CPPUNIT_ASSERT(ts::LocateNALUnitEnd(data + 10, sizeof(data) - 10) == 0);
+
+    ts::ByteBlock buf;
+    BuildBuffer(buf, 300, 11);
+    for (size_t start = 0; start < 40; ++start) {
+        for (size_t size = 0; start + size <= buf.size(); ++size) {
+            CPPUNIT_ASSERT(ts::LocateNALUnitEnd(&buf[start], size) == Reference(&buf[start], size, 0, 1));
+        }
+    }
+}
+
+// The SIMD versions process the end of the area in one last block which overlaps
+// the previous one. Check one start code at each position of areas of all sizes
+// up to several blocks, in the overlap and in the last three bytes.
+void MemoryUtilsTest::testLocateLastBlock()
+{
+    ts::ByteBlock buf;
+    for (size_t size = 0; size <= 3 * 32 + 2; ++size) {
+        buf.assign(size, 0x47);
+        CPPUNIT_ASSERT(ts::LocateStartCodePrefix(buf.data(), size) == 0);
+        for (size_t pos = 0; pos + 3 <= size; ++pos) {
+            buf.assign(size, 0x47);
+            buf[pos] = buf[pos + 1] = 0x00;
+            buf[pos + 2] = 0x01;
+            CPPUNIT_ASSERT(ts::LocateStartCodePrefix(buf.data(), size) == buf.data() + pos);
+            CPPUNIT_ASSERT(ts::LocateNALUnitEnd(buf.data(), size) == buf.data() + pos);
+            // Truncated start code prefix at the end of the area.
+            CPPUNIT_ASSERT(ts::LocateStartCodePrefix(buf.data(), pos + 2) == 0);
+        }
+    }
+}
+
+// Throughput on long areas and on TS payloads. The short areas are the case
+// of the PES demux in streaming mode, where the processing of the last bytes
+// of each area matters (with AVX2, no transition to legacy SSE code).
+void MemoryUtilsTest::testLocateBenchmark()
+{
+    if (!utest::BenchmarkMode()) {
+        return;
+    }
+
+    ts::ByteBlock buf(1024 * 1024, 0x47);
+    const size_t iterations = 100;
+    const size_t sizes[] = {buf.size(), 184, 40};
+
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+        const size_t size = sizes[si];
+        const size_t count = buf.size() / size;
+        size_t found = 0;
+        utest::Chronometer chrono;
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            for (size_t i = 0; i < count; ++i) {
+                found += ts::LocateStartCodePrefix(buf.data() + i * size, size) != 0;
+            }
+        }
+        const int64_t rate = chrono.perSecond(iterations * count * size);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), found);
+        utest::Out() << "MemoryUtilsTest: start code scan, " << size << "-byte areas: " << (rate / 1000000) << " MB/s" << std::endl;
+    }
+}
@@ -34,6 +34,8 @@
 #include "tsNames.h"
 #include "tsMPEG.h"
 #include "tsSysUtils.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
@@ -82,6 +84,7 @@ public:
     void testRunningStatus();
     void testAudioType();
     void testT2MIPacketType();
+    void testIndex();
 
     CPPUNIT_TEST_SUITE(NamesTest);
     CPPUNIT_TEST(testConfigFile);
@@ -118,6 +121,7 @@ public:
     CPPUNIT_TEST(testRunningStatus);
     CPPUNIT_TEST(testAudioType);
     CPPUNIT_TEST(testT2MIPacketType);
+    CPPUNIT_TEST(testIndex);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -366,3 +370,45 @@ void NamesTest::testT2MIPacketType()
 {
     CPPUNIT_ASSERT_USTRINGS_EQUAL(u"Individual addressing", ts::names::T2MIPacketType(0x21));
 }
+
+void NamesTest::testIndex()
+{
+    // Compile the text files into temporary binary indexes and compare all lookups.
+    const ts::UString dvbFile(ts::TempFile(u".names"));
+    const ts::UString ouiFile(ts::TempFile(u".names"));
+
+    const ts::Names dvbText(ts::SearchConfigurationFile(u"tsduck.dvb.names"), false);
+    const ts::Names ouiText(ts::SearchConfigurationFile(u"tsduck.oui.names"), false);
+    CPPUNIT_ASSERT(!dvbText.isIndexed());
+    CPPUNIT_ASSERT(!ouiText.isIndexed());
+    CPPUNIT_ASSERT(dvbText.saveIndex(dvbFile + ts::Names::INDEX_SUFFIX, CERR));
+    CPPUNIT_ASSERT(ouiText.saveIndex(ouiFile + ts::Names::INDEX_SUFFIX, CERR));
+
+    // The text files do not exist, the indexes are used.
+    const ts::Names dvbIndex(dvbFile);
+    const ts::Names ouiIndex(ouiFile);
+    CPPUNIT_ASSERT(dvbIndex.isIndexed());
+    CPPUNIT_ASSERT(ouiIndex.isIndexed());
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(dvbFile + ts::Names::INDEX_SUFFIX, dvbIndex.configurationFile());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), dvbIndex.errorCount());
+    CPPUNIT_ASSERT(!dvbIndex.saveIndex(dvbFile, NULLREP));
+
+    const ts::UChar* const sections[] = {
+        u"TableId", u"DescriptorId", u"StreamType", u"StreamId", u"CASystemId", u"CASFamily", u"ServiceType",
+        u"PrivateDataSpecifier", u"DataBroadcastId", u"ComponentType", u"NetworkId", u"NoSuchSection", 0
+    };
+    for (const ts::UChar* const* sec = sections; *sec != 0; ++sec) {
+        for (ts::Names::Value value = 0; value < 0x10000; ++value) {
+            CPPUNIT_ASSERT_USTRINGS_EQUAL(dvbText.nameFromSection(*sec, value, ts::names::VALUE), dvbIndex.nameFromSection(*sec, value, ts::names::VALUE));
+        }
+    }
+    for (ts::Names::Value value = 0; value < 0x1000000; value += 0x3F) {
+        CPPUNIT_ASSERT_USTRINGS_EQUAL(ouiText.nameFromSection(u"OUI", value), ouiIndex.nameFromSection(u"OUI", value));
+    }
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"CAT", dvbIndex.nameFromSection(u" tableid ", ts::TID_CAT));
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"Viaccess EMM-U", dvbIndex.nameFromSectionWithFallback(u"TableId", (ts::Names::Value(ts::CAS_VIACCESS) << 8) | ts::TID_VIA_EMM_U, ts::TID_VIA_EMM_U));
+    CPPUNIT_ASSERT_USTRINGS_EQUAL(u"PMT", dvbIndex.nameFromSectionWithFallback(u"TableId", (ts::Names::Value(ts::CAS_VIACCESS) << 8) | ts::TID_PMT, ts::TID_PMT));
+
+    ts::DeleteFile(dvbFile + ts::Names::INDEX_SUFFIX);
+    ts::DeleteFile(ouiFile + ts::Names::INDEX_SUFFIX);
+}
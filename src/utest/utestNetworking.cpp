@@ -36,10 +36,15 @@
 #include "tsTCPConnection.h"
 #include "tsTCPServer.h"
 #include "tsUDPSocket.h"
+#include "tsPacketPacer.h"
 #include "tsThread.h"
+#include "tsByteBlock.h"
 #include "tsSysUtils.h"
 #include "tsCerrReport.h"
+#include "tsNullReport.h"
 #include "utestCppUnitThread.h"
+#include "utestBenchmark.h"
+#include <cmath>
 TSDUCK_SOURCE;
 
 
@@ -61,7 +66,11 @@ public:
     void testSocketAddressConstructors();
     void testSocketAddress();
     void testTCPSocket();
+    void testTCPReceiveTimeout();
     void testUDPSocket();
+    void testUDPReceiveMultiple();
+    void testUDPSendMessages();
+    void testUDPPacing();
 
     CPPUNIT_TEST_SUITE(NetworkingTest);
     CPPUNIT_TEST(testIPAddressConstructors);
@@ -70,7 +79,11 @@ public:
     CPPUNIT_TEST(testSocketAddressConstructors);
     CPPUNIT_TEST(testSocketAddress);
     CPPUNIT_TEST(testTCPSocket);
+    CPPUNIT_TEST(testTCPReceiveTimeout);
     CPPUNIT_TEST(testUDPSocket);
+    CPPUNIT_TEST(testUDPReceiveMultiple);
+    CPPUNIT_TEST(testUDPSendMessages);
+    CPPUNIT_TEST(testUDPPacing);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -482,6 +495,47 @@ void NetworkingTest::testTCPSocket()
     CERR.debug(u"TCPSocketTest: main thread: terminated");
 }
 
+void NetworkingTest::testTCPReceiveTimeout()
+{
+    const uint16_t portNumber = 12346;
+    const ts::SocketAddress serverAddress(ts::IPAddress::LocalHost, portNumber);
+
+    ts::TCPServer server;
+    CPPUNIT_ASSERT(server.open(CERR));
+    CPPUNIT_ASSERT(server.reusePort(true, CERR));
+    CPPUNIT_ASSERT(server.bind(serverAddress, CERR));
+    CPPUNIT_ASSERT(server.listen(5, CERR));
+
+    // The connection is established in the listen backlog, before accept().
+    ts::TCPConnection client;
+    CPPUNIT_ASSERT(client.open(CERR));
+    CPPUNIT_ASSERT(client.connect(serverAddress, CERR));
+
+    ts::TCPConnection session;
+    ts::SocketAddress clientAddress;
+    CPPUNIT_ASSERT(server.accept(session, clientAddress, CERR));
+    CPPUNIT_ASSERT(session.setReceiveTimeout(200, CERR));
+
+    // The client sends nothing, the receive operation fails after the timeout.
+    char buffer[16];
+    size_t size = 0;
+    utest::Chronometer chrono;
+    CPPUNIT_ASSERT(!session.receive(buffer, sizeof(buffer), size, 0, NULLREP));
+    const ts::NanoSecond duration = chrono.elapsed();
+    utest::Out() << "NetworkingTest::testTCPReceiveTimeout: timeout after " << (duration / ts::NanoSecPerMilliSec) << " ms" << std::endl;
+    CPPUNIT_ASSERT(duration >= 150 * ts::NanoSecPerMilliSec);
+    CPPUNIT_ASSERT(duration < 5 * ts::NanoSecPerSec);
+
+    // Data which are sent in time are received.
+    CPPUNIT_ASSERT(client.send("x", 1, CERR));
+    CPPUNIT_ASSERT(session.receive(buffer, sizeof(buffer), size, 0, CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), size);
+
+    client.close(NULLREP);
+    session.close(NULLREP);
+    CPPUNIT_ASSERT(server.close(CERR));
+}
+
 // A thread class which sends one UDP message and wait from the same message to be replied.
 namespace {
     class UDPClient: public utest::CppUnitThread
@@ -570,3 +624,253 @@ void NetworkingTest::testUDPSocket()
     CPPUNIT_ASSERT(sock.send(buffer, size, sender, CERR));
     CERR.debug(u"UDPSocketTest: main thread: reply sent");
 }
+
+void NetworkingTest::testUDPReceiveMultiple()
+{
+    const uint16_t portNumber = 12346;
+    const ts::SocketAddress destination(ts::IPAddress::LocalHost, portNumber);
+
+    // Create server socket
+    ts::UDPSocket sock;
+    CPPUNIT_ASSERT(sock.open(CERR));
+    CPPUNIT_ASSERT(sock.reusePort(true, CERR));
+    CPPUNIT_ASSERT(sock.bind(destination, CERR));
+
+    // Kernel time stamps are optional, use system time when not supported.
+    sock.setReceiveTimestamps(true, NULLREP);
+
+    // Send three messages. Since the messages are queued in the socket, no thread is needed.
+    ts::UDPSocket client;
+    CPPUNIT_ASSERT(client.open(CERR));
+    uint8_t data[64];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = uint8_t(i);
+    }
+    const size_t sizes[3] = {10, 30, 5};
+    for (size_t i = 0; i < 3; ++i) {
+        CPPUNIT_ASSERT(client.send(data, sizes[i], destination, CERR));
+    }
+
+    // Receive the three messages, possibly in several operations.
+    // The primary buffers have 20 bytes, the second message overflows.
+    uint8_t primary[3][20];
+    uint8_t overflow[3][64];
+    ts::UDPSocket::Message msgs[3];
+    size_t received = 0;
+    ts::NanoSecond previous = 0;
+
+    while (received < 3) {
+        for (size_t i = received; i < 3; ++i) {
+            msgs[i].data = primary[i];
+            msgs[i].max_size = sizeof(primary[i]);
+            msgs[i].overflow = overflow[i];
+            msgs[i].overflow_size = sizeof(overflow[i]);
+        }
+        size_t count = 0;
+        CPPUNIT_ASSERT(sock.receive(msgs + received, 3 - received, count, 0, CERR));
+        CPPUNIT_ASSERT(count >= 1);
+        CPPUNIT_ASSERT(received + count <= 3);
+        for (size_t i = received; i < received + count; ++i) {
+            CPPUNIT_ASSERT_EQUAL(sizes[i], msgs[i].size);
+            CPPUNIT_ASSERT(ts::IPAddress(msgs[i].sender) == ts::IPAddress::LocalHost);
+            CPPUNIT_ASSERT(msgs[i].timestamp > 0);
+            CPPUNIT_ASSERT(msgs[i].timestamp >= previous);
+            previous = msgs[i].timestamp;
+            const size_t first = std::min(msgs[i].size, msgs[i].max_size);
+            CPPUNIT_ASSERT(::memcmp(primary[i], data, first) == 0);
+            CPPUNIT_ASSERT(::memcmp(overflow[i], data + first, msgs[i].size - first) == 0);
+        }
+        received += count;
+    }
+}
+
+// Loopback test of sendMessages() and multi-message receive().
+// In benchmark mode, report the throughput and the gaps between kernel time stamps of received datagrams.
+void NetworkingTest::testUDPSendMessages()
+{
+    const uint16_t portNumber = 12347;
+    const ts::SocketAddress destination(ts::IPAddress::LocalHost, portNumber);
+
+    // Messages are sent in rounds which fit in a default socket receive buffer.
+    const size_t msgSize = 7 * 188;
+    const size_t roundCount = 16;
+    const size_t rounds = utest::BenchmarkMode() ? 128 : 2;
+
+    ts::UDPSocket sock;
+    CPPUNIT_ASSERT(sock.open(CERR));
+    CPPUNIT_ASSERT(sock.reusePort(true, CERR));
+    CPPUNIT_ASSERT(sock.bind(destination, CERR));
+    sock.setReceiveTimestamps(true, NULLREP);
+
+    for (int gso = 0; gso < 2; ++gso) {
+
+        ts::UDPSocket client;
+        CPPUNIT_ASSERT(client.open(CERR));
+        CPPUNIT_ASSERT(client.setDefaultDestination(destination, CERR));
+        if (gso != 0 && !client.setSendSegmentation(true, NULLREP)) {
+            utest::Out() << "NetworkingTest: UDP segmentation offload not supported" << std::endl;
+            break;
+        }
+
+        // Each message contains its index in the round.
+        ts::ByteBlock data(roundCount * msgSize);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = uint8_t(i / msgSize + i % msgSize);
+        }
+
+        ts::ByteBlock buffer(roundCount * msgSize);
+        ts::UDPSocket::Message msgs[roundCount];
+        size_t total = 0;
+        double gapSum = 0;
+        double gapSquareSum = 0;
+        ts::NanoSecond gapMax = 0;
+        size_t gapCount = 0;
+
+        utest::Chronometer chrono;
+        for (size_t r = 0; r < rounds; ++r) {
+            CPPUNIT_ASSERT(client.sendMessages(data.data(), data.size(), msgSize, CERR));
+            size_t received = 0;
+            while (received < roundCount) {
+                for (size_t i = received; i < roundCount; ++i) {
+                    msgs[i].data = buffer.data() + i * msgSize;
+                    msgs[i].max_size = msgSize;
+                }
+                size_t count = 0;
+                CPPUNIT_ASSERT(sock.receive(msgs + received, roundCount - received, count, 0, CERR));
+                CPPUNIT_ASSERT(count >= 1);
+                received += count;
+            }
+            for (size_t i = 0; i < roundCount; ++i) {
+                CPPUNIT_ASSERT_EQUAL(msgSize, msgs[i].size);
+                if (i > 0) {
+                    const ts::NanoSecond gap = msgs[i].timestamp - msgs[i-1].timestamp;
+                    gapSum += double(gap);
+                    gapSquareSum += double(gap) * double(gap);
+                    gapMax = std::max(gapMax, gap);
+                    gapCount++;
+                }
+            }
+            CPPUNIT_ASSERT(buffer == data);
+            total += roundCount;
+        }
+        const int64_t rate = chrono.perSecond(total);
+
+        CPPUNIT_ASSERT_EQUAL(rounds * roundCount, total);
+        if (!utest::BenchmarkMode()) {
+            continue;
+        }
+        const double gapMean = gapSum / double(gapCount);
+        const double gapDev = std::sqrt(std::max(0.0, gapSquareSum / double(gapCount) - gapMean * gapMean));
+        utest::Out() << "NetworkingTest: sendMessages" << (gso != 0 ? " with segmentation offload" : "")
+                     << ": " << total << " messages, " << rate << " messages/s"
+                     << ", gap mean: " << ts::NanoSecond(gapMean) << " ns, stdev: " << ts::NanoSecond(gapDev)
+                     << " ns, max: " << gapMax << " ns" << std::endl;
+    }
+}
+
+// Paced sending of UDP messages, as in the ip output plugin with --pacing.
+// Check the timing of the messages and the batching of messages which are due within the timer precision.
+// Only the properties which do not depend on the system load are checked: a message is never sent more
+// than the precision before its due time, and messages are grouped only when they are due within the
+// precision or when the sender is late.
+void NetworkingTest::testUDPPacing()
+{
+    const uint16_t portNumber = 12348;
+    const ts::SocketAddress destination(ts::IPAddress::LocalHost, portNumber);
+    const size_t burst = 7;
+    const size_t msgSize = burst * ts::PKT_SIZE;
+
+    // All messages are received after sending and must fit in a default socket receive buffer.
+    const size_t msgCount = 16;
+
+    ts::UDPSocket sock;
+    CPPUNIT_ASSERT(sock.open(CERR));
+    CPPUNIT_ASSERT(sock.reusePort(true, CERR));
+    CPPUNIT_ASSERT(sock.bind(destination, CERR));
+    sock.setReceiveTimestamps(true, NULLREP);
+
+    ts::UDPSocket client;
+    CPPUNIT_ASSERT(client.open(CERR));
+    CPPUNIT_ASSERT(client.setDefaultDestination(destination, CERR));
+    ts::Monotonic::SetPrecision(ts::PacketPacer::PRECISION);
+
+    // Each message contains its index.
+    ts::ByteBlock data(msgCount * msgSize);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t(i / msgSize);
+    }
+    ts::ByteBlock buffer(msgCount * msgSize);
+    ts::UDPSocket::Message msgs[msgCount];
+
+    // At 10 Mb/s, one message every 1.05 ms, sent one by one when the system is not late.
+    // At 1 Gb/s, one message every 10.5 us, less than the timer precision, several messages
+    // are sent in each batch.
+    const ts::BitRate bitrates[2] = {10000000, 1000000000};
+    for (size_t b = 0; b < 2; ++b) {
+        const ts::BitRate bitrate = bitrates[b];
+        const ts::NanoSecond interval = (ts::NanoSecPerSec * msgSize * 8) / bitrate;
+
+        ts::PacketPacer pacer;
+        size_t sent = 0;
+        size_t batches = 0;
+        utest::Chronometer chrono;
+        while (sent < msgCount * burst) {
+            const size_t count = pacer.wait(bitrate, msgCount * burst - sent, burst);
+            const ts::NanoSecond now = chrono.elapsed();
+            CPPUNIT_ASSERT(count > 0);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), count % burst);
+
+            // Index of the first and last message in this batch.
+            const size_t first = sent / burst;
+            const size_t last = (sent + count) / burst - 1;
+
+            // The last message is not sent earlier than its due time minus the precision.
+            CPPUNIT_ASSERT(now >= ts::NanoSecond(last) * interval - ts::PacketPacer::PRECISION);
+
+            // Only the messages which are due within the precision are grouped, plus the late ones.
+            CPPUNIT_ASSERT(ts::NanoSecond(last - first) * interval <= std::max<ts::NanoSecond>(0, now - ts::NanoSecond(first) * interval) + ts::PacketPacer::PRECISION);
+
+            // The first batch is never late.
+            if (batches == 0) {
+                CPPUNIT_ASSERT_EQUAL(std::min<size_t>(msgCount, 1 + size_t(ts::PacketPacer::PRECISION / interval)), last + 1);
+            }
+
+            CPPUNIT_ASSERT(client.sendMessages(data.data() + sent * ts::PKT_SIZE, count * ts::PKT_SIZE, msgSize, CERR));
+            sent += count;
+            batches++;
+        }
+        const ts::NanoSecond duration = chrono.elapsed();
+
+        // The last message is due after msgCount - 1 intervals, minus the precision.
+        CPPUNIT_ASSERT(duration >= ts::NanoSecond(msgCount - 1) * interval - ts::PacketPacer::PRECISION);
+        CPPUNIT_ASSERT(duration < ts::NanoSecond(3 * msgCount) * interval + ts::PacketPacer::MAX_LATE);
+
+        // Receive all messages.
+        size_t received = 0;
+        while (received < msgCount) {
+            for (size_t i = received; i < msgCount; ++i) {
+                msgs[i].data = buffer.data() + i * msgSize;
+                msgs[i].max_size = msgSize;
+            }
+            size_t count = 0;
+            CPPUNIT_ASSERT(sock.receive(msgs + received, msgCount - received, count, 0, CERR));
+            CPPUNIT_ASSERT(count >= 1);
+            received += count;
+        }
+        CPPUNIT_ASSERT(buffer == data);
+
+        // The kernel receive time stamps are only reported. On loopback, the reception may
+        // be deferred to a kernel thread, they do not reliably reflect the send times.
+        utest::Out() << "NetworkingTest: paced at " << bitrate << " b/s: " << msgCount << " messages in "
+                     << batches << " batches, " << (duration / 1000) << " us";
+        if (msgs[0].timestamp > 0) {
+            utest::Out() << ", receive time stamps span " << ((msgs[msgCount - 1].timestamp - msgs[0].timestamp) / 1000) << " us";
+        }
+        utest::Out() << std::endl;
+
+        // Batches of the messages which are due within the precision.
+        if (interval < ts::PacketPacer::PRECISION) {
+            CPPUNIT_ASSERT(batches < msgCount / 2);
+        }
+    }
+}
@@ -0,0 +1,545 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::PESDemux
+//
+//----------------------------------------------------------------------------
+
+#include "tsPESDemux.h"
+#include "tsCRC32.h"
+#include "utestBenchmark.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PESDemuxTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testPTS();
+    void testStreaming();
+    void testTruncatedStartCode();
+    void testThroughput();
+
+    CPPUNIT_TEST_SUITE(PESDemuxTest);
+    CPPUNIT_TEST(testPTS);
+    CPPUNIT_TEST(testStreaming);
+    CPPUNIT_TEST(testTruncatedStartCode);
+    CPPUNIT_TEST(testThroughput);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    // Simple deterministic generator.
+    utest::Random _random;
+
+    // Build a PES header with PTS and DTS (if non zero) and some stuffing in the header.
+    void buildHeader(ts::ByteBlock& pes, uint8_t stream_id, uint64_t pts, uint64_t dts, size_t stuffing);
+
+    // Append random data. When dense, with many zeroes, hence many accidental start codes.
+    // Otherwise, uniformly distributed bytes, almost no start code, as in real video slices.
+    void appendRandom(ts::ByteBlock& data, size_t size, bool dense);
+
+    // Append a PES packet in TS packets of random payload sizes.
+    void packetize(ts::TSPacketVector& packets, ts::PID pid, uint8_t& cc, const ts::ByteBlock& pes);
+
+    // Build an interleaved stream with MPEG-2 video, AVC, AC-3 and MPEG audio PID's.
+    void buildStream(ts::TSPacketVector& packets, size_t pes_count, bool dense = true);
+
+    // A PES handler which logs all events per PID.
+    class Logger: public ts::PESHandlerInterface
+    {
+    public:
+        Logger(size_t max_unit_size) : log(), _max_unit_size(max_unit_size) {}
+        std::map<ts::PID, ts::UStringList> log;
+
+        virtual void handlePESPacket(ts::PESDemux&, const ts::PESPacket&) override;
+        virtual void handlePESHeader(ts::PESDemux&, const ts::PESPacket&) override;
+        virtual void handleVideoStartCode(ts::PESDemux&, const ts::PESPacket&, uint8_t, size_t, size_t) override;
+        virtual void handleAVCAccessUnit(ts::PESDemux&, const ts::PESPacket&, uint8_t, size_t, size_t) override;
+        virtual void handleNewVideoAttributes(ts::PESDemux&, const ts::PESPacket&, const ts::VideoAttributes&) override;
+        virtual void handleNewAVCAttributes(ts::PESDemux&, const ts::PESPacket&, const ts::AVCAttributes&) override;
+        virtual void handleNewAudioAttributes(ts::PESDemux&, const ts::PESPacket&, const ts::AudioAttributes&) override;
+        virtual void handleNewAC3Attributes(ts::PESDemux&, const ts::PESPacket&, const ts::AC3Attributes&) override;
+
+    private:
+        size_t _max_unit_size;
+        void logHeader(const ts::PESPacket&);
+        void logUnit(ts::PESDemux&, const ts::PESPacket&, const ts::UString&, uint8_t, size_t, size_t);
+    };
+
+    // A PES handler which only counts the video units, for performance measurements.
+    class Counter: public ts::PESHandlerInterface
+    {
+    public:
+        Counter() : units(0) {}
+        size_t units;
+
+        virtual void handleVideoStartCode(ts::PESDemux&, const ts::PESPacket&, uint8_t, size_t, size_t) override { units++; }
+        virtual void handleAVCAccessUnit(ts::PESDemux&, const ts::PESPacket&, uint8_t, size_t, size_t) override { units++; }
+    };
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PESDemuxTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PESDemuxTest::setUp()
+{
+    _random = utest::Random(1);
+}
+
+// Test suite cleanup method.
+void PESDemuxTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Stream generation.
+//----------------------------------------------------------------------------
+
+void PESDemuxTest::buildHeader(ts::ByteBlock& pes, uint8_t stream_id, uint64_t pts, uint64_t dts, size_t stuffing)
+{
+    const size_t ts_size = dts != 0 ? 10 : 5;
+    pes.clear();
+    pes.appendUInt24(0x000001);
+    pes.appendUInt8(stream_id);
+    pes.appendUInt16(0);  // PES_packet_length, unbounded
+    pes.appendUInt8(0x80);
+    pes.appendUInt8(dts != 0 ? 0xC0 : 0x80);
+    pes.appendUInt8(uint8_t(ts_size + stuffing));
+    for (int i = 0; i < (dts != 0 ? 2 : 1); ++i) {
+        const uint64_t value = i == 0 ? pts : dts;
+        const uint8_t prefix = dts == 0 ? 0x20 : (i == 0 ? 0x30 : 0x10);
+        pes.appendUInt8(prefix | uint8_t((value >> 29) & 0x0E) | 0x01);
+        pes.appendUInt16(uint16_t(((value >> 14) & 0xFFFE) | 0x0001));
+        pes.appendUInt16(uint16_t(((value << 1) & 0xFFFE) | 0x0001));
+    }
+    pes.append(ts::ByteBlock(stuffing, 0xFF));
+}
+
+void PESDemuxTest::appendRandom(ts::ByteBlock& data, size_t size, bool dense)
+{
+    for (size_t i = 0; i < size; ++i) {
+        const uint32_t r = dense ? _random.next(16) : 16;
+        data.appendUInt8(r < 8 ? 0x00 : (r < 10 ? 0x01 : uint8_t(_random.next(256))));
+    }
+}
+
+void PESDemuxTest::packetize(ts::TSPacketVector& packets, ts::PID pid, uint8_t& cc, const ts::ByteBlock& pes)
+{
+    for (size_t offset = 0; offset < pes.size(); ) {
+        // Random payload size, often a full TS payload, sometimes very short.
+        // The first TS packet contains at least the fixed part of the PES header.
+        const size_t max_size = std::min<size_t>(184, pes.size() - offset);
+        const size_t min_size = offset == 0 ? std::min<size_t>(9, max_size) : 1;
+        const size_t size = _random.next(2) == 0 ? max_size : min_size + _random.next(uint32_t(max_size - min_size + 1));
+        ts::TSPacket pkt;
+        pkt.b[0] = ts::SYNC_BYTE;
+        pkt.b[1] = uint8_t(pid >> 8) & 0x1F;
+        pkt.b[2] = uint8_t(pid);
+        pkt.b[3] = cc;
+        if (offset == 0) {
+            pkt.setPUSI();
+        }
+        if (size < 184) {
+            // Adaptation field with stuffing.
+            pkt.b[3] |= 0x30;
+            pkt.b[4] = uint8_t(183 - size);
+            if (size < 183) {
+                pkt.b[5] = 0x00;
+                ::memset(pkt.b + 6, 0xFF, 182 - size);
+            }
+        }
+        else {
+            pkt.b[3] |= 0x10;
+        }
+        ::memcpy(pkt.b + 188 - size, pes.data() + offset, size);
+        packets.push_back(pkt);
+        offset += size;
+        cc = (cc + 1) & 0x0F;
+    }
+}
+
+void PESDemuxTest::buildStream(ts::TSPacketVector& packets, size_t pes_count, bool dense)
+{
+    static const ts::PID pids[] = {0x0100, 0x0101, 0x0200, 0x0201};
+    static const uint8_t stream_ids[] = {0xE0, 0xE1, 0xBD, 0xC0};
+    static const uint8_t seq_header[] = {0x00, 0x00, 0x01, 0xB3, 0x2D, 0x02, 0x40, 0x33, 0xFF, 0xFF, 0xE0, 0x18};
+    static const uint8_t seq_extension[] = {0x00, 0x00, 0x01, 0xB5, 0x14, 0x8A, 0x00, 0x01, 0x00, 0x00};
+    static const uint8_t avc_start[] = {0x00, 0x00, 0x00, 0x01, 0x09, 0xF0, 0x00, 0x00, 0x00, 0x01};
+    static const uint8_t avc_sps[] = {0x67, 0x64, 0x00, 0x28, 0xAC, 0xD9, 0x40, 0x78, 0x02, 0x27, 0xE5, 0xC0, 0x44, 0x00, 0x00, 0x03,
+                                      0x00, 0x04, 0x00, 0x00, 0x03, 0x00, 0xC8, 0x3C, 0x60, 0xC6, 0x58, 0x00, 0x00, 0x01};
+    static const uint8_t ac3_frame[] = {0x0B, 0x77, 0x3A, 0x6C, 0x50, 0x40, 0x43};
+    static const uint8_t mpa_frame[] = {0xFF, 0xFD, 0xA4, 0x04};
+
+    ts::TSPacketVector streams[4];
+    uint8_t cc[4] = {0, 0, 0, 0};
+    uint64_t pts = 900000;
+
+    for (size_t count = 0; count < pes_count; ++count) {
+        for (size_t si = 0; si < 4; ++si) {
+            ts::ByteBlock pes;
+            // Sometimes a large header which spans several TS packets.
+            const size_t stuffing = _random.next(8) == 0 ? _random.next(200) : 0;
+            switch (si) {
+                case 0:
+                    // MPEG-2 video: sequence header, extension, then random units.
+                    buildHeader(pes, stream_ids[si], pts + 3600, pts, stuffing);
+                    pes.append(seq_header, sizeof(seq_header));
+                    pes.append(seq_extension, sizeof(seq_extension));
+                    pes.appendUInt32(0x00000100);
+                    appendRandom(pes, _random.next(4000), dense);
+                    break;
+                case 1:
+                    // AVC: access unit delimiter, SPS, then random NAL units with trailing zeroes.
+                    buildHeader(pes, stream_ids[si], pts, 0, stuffing);
+                    pes.append(avc_start, sizeof(avc_start));
+                    pes.append(avc_sps, sizeof(avc_sps));
+                    pes.appendUInt8(0x65);
+                    appendRandom(pes, _random.next(4000), dense);
+                    break;
+                case 2:
+                    // AC-3 audio.
+                    buildHeader(pes, stream_ids[si], pts, 0, stuffing);
+                    pes.append(ac3_frame, sizeof(ac3_frame));
+                    appendRandom(pes, _random.next(1500), dense);
+                    break;
+                default:
+                    // MPEG audio.
+                    buildHeader(pes, stream_ids[si], pts, 0, stuffing);
+                    pes.append(mpa_frame, sizeof(mpa_frame));
+                    appendRandom(pes, _random.next(600), dense);
+                    break;
+            }
+            packetize(streams[si], pids[si], cc[si], pes);
+        }
+        pts += 3600;
+    }
+
+    // Terminate each PID with an empty PES packet without PTS so that the last real PES packet is complete.
+    for (size_t si = 0; si < 4; ++si) {
+        ts::ByteBlock pes;
+        buildHeader(pes, stream_ids[si], 0, 0, 0);
+        pes[7] = 0x00;  // no PTS
+        pes[8] = 0x00;
+        pes.resize(9);
+        packetize(streams[si], pids[si], cc[si], pes);
+    }
+
+    // Interleave the PID's in random order.
+    size_t next[4] = {0, 0, 0, 0};
+    packets.clear();
+    for (;;) {
+        size_t remain = 0;
+        for (size_t si = 0; si < 4; ++si) {
+            remain += streams[si].size() - next[si];
+        }
+        if (remain == 0) {
+            break;
+        }
+        size_t si = _random.next(4);
+        while (next[si] >= streams[si].size()) {
+            si = (si + 1) % 4;
+        }
+        packets.push_back(streams[si][next[si]++]);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// PES handler, log all events. In buffered mode, the units are located in
+// the complete PES payload. In streaming mode, the payload is the unit.
+//----------------------------------------------------------------------------
+
+void PESDemuxTest::Logger::logHeader(const ts::PESPacket& pkt)
+{
+    if (pkt.hasPTS()) {
+        log[pkt.getSourcePID()].push_back(ts::UString::Format(u"PES stream_id 0x%X, PTS %d, DTS %d",
+                                                              {pkt.getStreamId(), pkt.hasPTS() ? pkt.getPTS() : 0, pkt.hasDTS() ? pkt.getDTS() : 0}));
+    }
+}
+
+void PESDemuxTest::Logger::logUnit(ts::PESDemux& demux, const ts::PESPacket& pkt, const ts::UString& name, uint8_t type, size_t offset, size_t size)
+{
+    const uint8_t* data = pkt.payload();
+    size_t data_size = pkt.payloadSize();
+    if (demux.isStreaming()) {
+        // Only the beginning of the unit is kept.
+        CPPUNIT_ASSERT_EQUAL(std::min(size, _max_unit_size), data_size);
+    }
+    else {
+        CPPUNIT_ASSERT(offset + size <= data_size);
+        data += offset;
+        data_size = std::min(size, _max_unit_size);
+    }
+    log[pkt.getSourcePID()].push_back(ts::UString::Format(u"%s 0x%X, offset %d, size %d, CRC 0x%X",
+                                                          {name, type, offset, size, ts::CRC32(data, data_size).value()}));
+}
+
+void PESDemuxTest::Logger::handlePESPacket(ts::PESDemux&, const ts::PESPacket& pkt)
+{
+    logHeader(pkt);
+}
+
+void PESDemuxTest::Logger::handlePESHeader(ts::PESDemux&, const ts::PESPacket& pkt)
+{
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pkt.payloadSize());
+    logHeader(pkt);
+}
+
+void PESDemuxTest::Logger::handleVideoStartCode(ts::PESDemux& demux, const ts::PESPacket& pkt, uint8_t start_code, size_t offset, size_t size)
+{
+    logUnit(demux, pkt, u"start code", start_code, offset, size);
+}
+
+void PESDemuxTest::Logger::handleAVCAccessUnit(ts::PESDemux& demux, const ts::PESPacket& pkt, uint8_t nal_unit_type, size_t offset, size_t size)
+{
+    logUnit(demux, pkt, u"AVC access unit", nal_unit_type, offset, size);
+}
+
+void PESDemuxTest::Logger::handleNewVideoAttributes(ts::PESDemux&, const ts::PESPacket& pkt, const ts::VideoAttributes& attr)
+{
+    log[pkt.getSourcePID()].push_back(u"video: " + attr.toString());
+}
+
+void PESDemuxTest::Logger::handleNewAVCAttributes(ts::PESDemux&, const ts::PESPacket& pkt, const ts::AVCAttributes& attr)
+{
+    log[pkt.getSourcePID()].push_back(u"AVC: " + attr.toString());
+}
+
+void PESDemuxTest::Logger::handleNewAudioAttributes(ts::PESDemux&, const ts::PESPacket& pkt, const ts::AudioAttributes& attr)
+{
+    log[pkt.getSourcePID()].push_back(u"audio: " + attr.toString());
+}
+
+void PESDemuxTest::Logger::handleNewAC3Attributes(ts::PESDemux&, const ts::PESPacket& pkt, const ts::AC3Attributes& attr)
+{
+    log[pkt.getSourcePID()].push_back(u"AC-3: " + attr.toString());
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void PESDemuxTest::testPTS()
+{
+    ts::ByteBlock data;
+    buildHeader(data, 0xE0, TS_UCONST64(0x1FEDCBA98), TS_UCONST64(0x123456789), 3);
+    ts::PESPacket pes1(data);
+    CPPUNIT_ASSERT(pes1.isValid());
+    CPPUNIT_ASSERT_EQUAL(size_t(22), pes1.headerSize());
+    CPPUNIT_ASSERT(pes1.hasPTS());
+    CPPUNIT_ASSERT(pes1.hasDTS());
+    CPPUNIT_ASSERT_EQUAL(TS_UCONST64(0x1FEDCBA98), pes1.getPTS());
+    CPPUNIT_ASSERT_EQUAL(TS_UCONST64(0x123456789), pes1.getDTS());
+
+    buildHeader(data, 0xC0, 12345678, 0, 0);
+    ts::PESPacket pes2(data);
+    CPPUNIT_ASSERT(pes2.isValid());
+    CPPUNIT_ASSERT(pes2.hasPTS());
+    CPPUNIT_ASSERT(!pes2.hasDTS());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(12345678), pes2.getPTS());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), pes2.getDTS());
+
+    static const uint8_t padding[] = {0x00, 0x00, 0x01, 0xBE, 0x00, 0x02, 0xFF, 0xFF};
+    ts::PESPacket pes3(padding, sizeof(padding));
+    CPPUNIT_ASSERT(pes3.isValid());
+    CPPUNIT_ASSERT(!pes3.hasPTS());
+    CPPUNIT_ASSERT(!pes3.hasDTS());
+}
+
+void PESDemuxTest::testStreaming()
+{
+    const size_t max_unit_size = 256;
+
+    for (uint32_t seed = 1; seed <= 4; ++seed) {
+        _random = utest::Random(seed);
+        ts::TSPacketVector packets;
+        buildStream(packets, 50);
+
+        // Same stream in buffered and streaming modes.
+        Logger buffered(max_unit_size);
+        Logger streaming(max_unit_size);
+        ts::PESDemux demux1(&buffered);
+        ts::PESDemux demux2(&streaming);
+        demux2.setStreaming(true, max_unit_size);
+        CPPUNIT_ASSERT(!demux1.isStreaming());
+        CPPUNIT_ASSERT(demux2.isStreaming());
+
+        for (size_t i = 0; i < packets.size(); ++i) {
+            demux1.feedPacket(packets[i]);
+            demux2.feedPacket(packets[i]);
+        }
+
+        utest::Out() << "PESDemuxTest: seed " << seed << ", " << packets.size() << " packets, events per PID:";
+        CPPUNIT_ASSERT_EQUAL(size_t(4), buffered.log.size());
+        CPPUNIT_ASSERT_EQUAL(size_t(4), streaming.log.size());
+        for (std::map<ts::PID, ts::UStringList>::const_iterator it = buffered.log.begin(); it != buffered.log.end(); ++it) {
+            const ts::UStringList& ref(it->second);
+            const ts::UStringList& log(streaming.log[it->first]);
+            utest::Out() << " " << ref.size();
+            CPPUNIT_ASSERT(ref.size() > 50);
+            CPPUNIT_ASSERT_EQUAL(ref.size(), log.size());
+            ts::UStringList::const_iterator it1 = ref.begin();
+            ts::UStringList::const_iterator it2 = log.begin();
+            for (; it1 != ref.end(); ++it1, ++it2) {
+                CPPUNIT_ASSERT_USTRINGS_EQUAL(*it1, *it2);
+            }
+        }
+        utest::Out() << std::endl;
+
+        // The attributes are identical.
+        ts::VideoAttributes video1, video2;
+        demux1.getVideoAttributes(0x0100, video1);
+        demux2.getVideoAttributes(0x0100, video2);
+        CPPUNIT_ASSERT(video1.isValid());
+        CPPUNIT_ASSERT_USTRINGS_EQUAL(video1.toString(), video2.toString());
+        ts::AC3Attributes ac3_1, ac3_2;
+        demux1.getAC3Attributes(0x0200, ac3_1);
+        demux2.getAC3Attributes(0x0200, ac3_2);
+        CPPUNIT_ASSERT(ac3_1.isValid());
+        CPPUNIT_ASSERT_USTRINGS_EQUAL(ac3_1.toString(), ac3_2.toString());
+        CPPUNIT_ASSERT(demux1.allAC3(0x0200));
+        CPPUNIT_ASSERT(demux2.allAC3(0x0200));
+    }
+}
+
+// PES payloads which end with a start code prefix (00 00 01), without the start code value
+// or the NAL unit header. The missing byte is reported as zero, it must not be read after
+// the end of the payload.
+void PESDemuxTest::testTruncatedStartCode()
+{
+    static const uint8_t mpeg2[] = {
+        0x00, 0x00, 0x01, 0xB3, 0x2D, 0x02, 0x40, 0x33, 0xFF, 0xFF, 0xE0, 0x18,
+        0x00, 0x00, 0x01, 0x00, 0x12, 0x34, 0x56, 0x00, 0x00, 0x01,
+    };
+    static const uint8_t avc[] = {
+        0x00, 0x00, 0x00, 0x01, 0x09, 0xF0, 0x00, 0x00, 0x00, 0x01,
+        0x65, 0x88, 0x84, 0x21, 0x00, 0x00, 0x01,
+    };
+    static const ts::PID pids[] = {0x0100, 0x0101};
+    static const uint8_t stream_ids[] = {0xE0, 0xE1};
+    static const uint8_t* const payloads[] = {mpeg2, avc};
+    static const size_t payload_sizes[] = {sizeof(mpeg2), sizeof(avc)};
+
+    ts::TSPacketVector packets;
+    for (size_t si = 0; si < 2; ++si) {
+        uint8_t cc = 0;
+        ts::ByteBlock pes;
+        buildHeader(pes, stream_ids[si], 900000, 0, 0);
+        pes.append(payloads[si], payload_sizes[si]);
+        packetize(packets, pids[si], cc, pes);
+        // Empty PES packet without PTS to terminate the previous one.
+        buildHeader(pes, stream_ids[si], 0, 0, 0);
+        pes[7] = 0x00;
+        pes[8] = 0x00;
+        pes.resize(9);
+        packetize(packets, pids[si], cc, pes);
+    }
+
+    const size_t max_unit_size = 256;
+    Logger buffered(max_unit_size);
+    Logger streaming(max_unit_size);
+    ts::PESDemux demux1(&buffered);
+    ts::PESDemux demux2(&streaming);
+    demux2.setStreaming(true, max_unit_size);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux1.feedPacket(packets[i]);
+        demux2.feedPacket(packets[i]);
+    }
+
+    // The last unit of the first PES packet is the truncated one.
+    const ts::UString last[] = {
+        ts::UString::Format(u"start code 0x00, offset %d, size 3, CRC ", {sizeof(mpeg2) - 3}),
+        ts::UString::Format(u"AVC access unit 0x00, offset %d, size 0, CRC ", {sizeof(avc)}),
+    };
+    for (size_t si = 0; si < 2; ++si) {
+        const ts::UStringList& log1(buffered.log[pids[si]]);
+        const ts::UStringList& log2(streaming.log[pids[si]]);
+        bool found = false;
+        for (ts::UStringList::const_iterator it = log1.begin(); !found && it != log1.end(); ++it) {
+            utest::Out() << "PESDemuxTest: PID " << pids[si] << ": " << *it << std::endl;
+            found = it->startWith(last[si]);
+        }
+        CPPUNIT_ASSERT(found);
+        CPPUNIT_ASSERT_EQUAL(log1.size(), log2.size());
+        ts::UStringList::const_iterator it1 = log1.begin();
+        ts::UStringList::const_iterator it2 = log2.begin();
+        for (; it1 != log1.end(); ++it1, ++it2) {
+            CPPUNIT_ASSERT_USTRINGS_EQUAL(*it1, *it2);
+        }
+    }
+}
+
+// Throughput of the PES demux in buffered and streaming modes, on the same streams.
+// This is the main cost of the TS analyzer on video streams (see TSAnalyzerTest::testThroughput).
+// The dense stream has a start code every few tens of bytes, the sparse stream only has the
+// start codes of the headers, as real video streams.
+void PESDemuxTest::testThroughput()
+{
+    if (!utest::BenchmarkMode()) {
+        return;
+    }
+
+    const size_t repeat = 20;
+    for (int dense = 0; dense < 2; ++dense) {
+        ts::TSPacketVector packets;
+        buildStream(packets, 500, dense != 0);
+        size_t units[2] = {0, 0};
+        for (int mode = 0; mode < 2; ++mode) {
+            Counter counter;
+            ts::PESDemux demux(&counter);
+            demux.setStreaming(mode != 0);
+            utest::Chronometer chrono;
+            for (size_t r = 0; r < repeat; ++r) {
+                for (ts::TSPacketVector::const_iterator it = packets.begin(); it != packets.end(); ++it) {
+                    demux.feedPacket(*it);
+                }
+            }
+            const int64_t rate = chrono.perSecond(repeat * packets.size());
+            units[mode] = counter.units;
+            utest::Out() << "PESDemuxTest: " << (dense != 0 ? "dense" : "sparse") << " stream, "
+                         << (mode != 0 ? "streaming" : "buffered") << " mode: " << counter.units << " units, "
+                         << rate << " packets/s, " << (rate * ts::PKT_SIZE * 8 / 1000000) << " Mb/s" << std::endl;
+        }
+        CPPUNIT_ASSERT(units[0] > 0);
+        CPPUNIT_ASSERT_EQUAL(units[0], units[1]);
+    }
+}
@@ -57,9 +57,11 @@ public:
     virtual void tearDown() override;
 
     void testPacketizer();
+    void testCycleReuse();
 
     CPPUNIT_TEST_SUITE(PacketizerTest);
     CPPUNIT_TEST(testPacketizer);
+    CPPUNIT_TEST(testCycleReuse);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -174,3 +176,76 @@ void PacketizerTest::testPacketizer()
     CPPUNIT_ASSERT(pmt_count == 4);
     CPPUNIT_ASSERT(sdt_count >= 15 && sdt_count <= 17);
 }
+
+void PacketizerTest::testCycleReuse()
+{
+    ts::BinaryTablePtr binpat;
+    ts::BinaryTablePtr binpmt;
+    ts::BinaryTablePtr binsdt;
+
+    DemuxTable(binpat, "PAT", psi_pat_r4_packets, sizeof(psi_pat_r4_packets));
+    DemuxTable(binpmt, "PMT", psi_pmt_planete_packets, sizeof(psi_pmt_planete_packets));
+    DemuxTable(binsdt, "SDT", psi_sdt_r3_packets, sizeof(psi_sdt_r3_packets));
+
+    // The reference packetizer always uses the regular packetization of the superclass.
+    ts::CyclingPacketizer pzer(ts::PID_PAT, ts::CyclingPacketizer::AT_END);
+    ts::CyclingPacketizer ref(ts::PID_PAT, ts::CyclingPacketizer::AT_END);
+    pzer.addTable(*binpat);
+    pzer.addTable(*binpmt);
+    pzer.addTable(*binsdt);
+    ref.addTable(*binpat);
+    ref.addTable(*binpmt);
+    ref.addTable(*binsdt);
+
+    // Modify both packetizers from time to time, the output must be identical.
+    uint32_t rnd = 1;
+    for (int pi = 0; pi < 5000; ++pi) {
+        rnd = rnd * 1103515245 + 12345;
+        switch ((rnd >> 16) % 128) {
+            case 0:
+                pzer.removeSections(ts::TID_PMT);
+                ref.removeSections(ts::TID_PMT);
+                break;
+            case 1:
+                pzer.addTable(*binpmt);
+                ref.addTable(*binpmt);
+                break;
+            case 2:
+                pzer.setStuffingPolicy(ts::CyclingPacketizer::ALWAYS);
+                ref.setStuffingPolicy(ts::CyclingPacketizer::ALWAYS);
+                break;
+            case 3:
+                pzer.setStuffingPolicy(ts::CyclingPacketizer::AT_END);
+                ref.setStuffingPolicy(ts::CyclingPacketizer::AT_END);
+                break;
+            case 4:
+                pzer.setPID(pi & 0x1FFF);
+                ref.setPID(pi & 0x1FFF);
+                break;
+            case 5:
+                pzer.addSection(binsdt->sectionAt(0), 100);
+                ref.addSection(binsdt->sectionAt(0), 100);
+                break;
+            case 6:
+                pzer.removeSections(ts::TID_SDT_ACT);
+                ref.removeSections(ts::TID_SDT_ACT);
+                break;
+            case 7:
+                pzer.setBitRate(pzer.bitRate() == 0 ? ts::PKT_SIZE * 8 * 100 : 0);
+                ref.setBitRate(ref.bitRate() == 0 ? ts::PKT_SIZE * 8 * 100 : 0);
+                break;
+            default:
+                break;
+        }
+        ts::TSPacket pkt1;
+        ts::TSPacket pkt2;
+        pzer.getNextPacket(pkt1);
+        ref.Packetizer::getNextPacket(pkt2);
+        CPPUNIT_ASSERT(pkt1 == pkt2);
+        CPPUNIT_ASSERT_EQUAL(ref.packetCount(), pzer.packetCount());
+        CPPUNIT_ASSERT_EQUAL(ref.sectionCount(), pzer.sectionCount());
+        CPPUNIT_ASSERT_EQUAL(ref.nextContinuityCounter(), pzer.nextContinuityCounter());
+        CPPUNIT_ASSERT_EQUAL(ref.atSectionBoundary(), pzer.atSectionBoundary());
+        CPPUNIT_ASSERT_EQUAL(ref.atCycleBoundary(), pzer.atCycleBoundary());
+    }
+}
@@ -0,0 +1,379 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for SMPTE 2022-1 FEC classes.
+//
+//----------------------------------------------------------------------------
+
+#include "tsRTPFECEncoder.h"
+#include "tsRTPFECDecoder.h"
+#include "tsUDPSocket.h"
+#include "tsByteBlock.h"
+#include "tsMPEG.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestBenchmark.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class RTPFECTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testMatrix();
+    void testColumn();
+    void testRow();
+    void testLength();
+    void testLoopback();
+
+    CPPUNIT_TEST_SUITE(RTPFECTest);
+    CPPUNIT_TEST(testMatrix);
+    CPPUNIT_TEST(testColumn);
+    CPPUNIT_TEST(testRow);
+    CPPUNIT_TEST(testLength);
+    CPPUNIT_TEST(testLoopback);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    // Build the payload of a media packet.
+    static void MediaPayload(ts::ByteBlock& payload, uint16_t seq, size_t size = 7 * ts::PKT_SIZE);
+
+    // Send media packets through an encoder and a decoder, dropping some of them.
+    // Check that the lost packets are recovered. Return the number of recovered packets.
+    static size_t Transmit(ts::RTPFECEncoder& encoder, size_t count, const std::set<uint16_t>& lost, uint16_t seq0 = 0);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RTPFECTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void RTPFECTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void RTPFECTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test utilities.
+//----------------------------------------------------------------------------
+
+void RTPFECTest::MediaPayload(ts::ByteBlock& payload, uint16_t seq, size_t size)
+{
+    payload.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        payload[i] = uint8_t(seq * 7 + i * 13 + (i >> 8));
+    }
+}
+
+size_t RTPFECTest::Transmit(ts::RTPFECEncoder& encoder, size_t count, const std::set<uint16_t>& lost, uint16_t seq0)
+{
+    ts::RTPFECDecoder decoder;
+    ts::ByteBlock payload;
+    ts::ByteBlock fec;
+    std::set<uint16_t> recovered;
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint16_t seq = uint16_t(seq0 + i);
+        MediaPayload(payload, seq);
+        encoder.addMedia(seq, ts::RTP_PT_MP2T, uint32_t(i * 100), payload.data(), payload.size());
+        if (lost.find(seq) == lost.end()) {
+            decoder.addMedia(seq, ts::RTP_PT_MP2T, uint32_t(i * 100), payload.data(), payload.size());
+        }
+        while (encoder.getColumnFEC(fec)) {
+            CPPUNIT_ASSERT(decoder.addFEC(fec.data(), fec.size()));
+        }
+        while (encoder.getRowFEC(fec)) {
+            CPPUNIT_ASSERT(decoder.addFEC(fec.data(), fec.size()));
+        }
+
+        uint16_t rseq = 0;
+        uint8_t rpt = 0;
+        uint32_t rtime = 0;
+        const uint8_t* rdata = 0;
+        size_t rsize = 0;
+        while (decoder.getRecovered(rseq, rpt, rtime, rdata, rsize)) {
+            CPPUNIT_ASSERT(lost.find(rseq) != lost.end());
+            CPPUNIT_ASSERT(recovered.find(rseq) == recovered.end());
+            CPPUNIT_ASSERT_EQUAL(ts::RTP_PT_MP2T, rpt);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(uint16_t(rseq - seq0) * 100), rtime);
+            MediaPayload(payload, rseq);
+            CPPUNIT_ASSERT_EQUAL(payload.size(), rsize);
+            CPPUNIT_ASSERT(::memcmp(payload.data(), rdata, rsize) == 0);
+            recovered.insert(rseq);
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(recovered.size(), decoder.recoveredCount());
+    return recovered.size();
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void RTPFECTest::testMatrix()
+{
+    ts::RTPFECEncoder encoder;
+    CPPUNIT_ASSERT(!encoder.isEnabled());
+
+    CPPUNIT_ASSERT(encoder.setMatrix(10, 10, false, NULLREP));
+    CPPUNIT_ASSERT(encoder.isEnabled());
+    CPPUNIT_ASSERT_EQUAL(size_t(10), encoder.columns());
+    CPPUNIT_ASSERT_EQUAL(size_t(10), encoder.rows());
+    CPPUNIT_ASSERT(!encoder.rowFEC());
+
+    CPPUNIT_ASSERT(encoder.setMatrix(1, 4, false, NULLREP));
+    CPPUNIT_ASSERT(encoder.setMatrix(20, 5, true, NULLREP));
+    CPPUNIT_ASSERT(encoder.rowFEC());
+
+    CPPUNIT_ASSERT(!encoder.setMatrix(21, 4, false, NULLREP));
+    CPPUNIT_ASSERT(!encoder.setMatrix(10, 3, false, NULLREP));
+    CPPUNIT_ASSERT(!encoder.setMatrix(10, 11, false, NULLREP));
+    CPPUNIT_ASSERT(!encoder.setMatrix(3, 10, true, NULLREP));
+
+    CPPUNIT_ASSERT(encoder.setMatrix(0, 0, false, NULLREP));
+    CPPUNIT_ASSERT(!encoder.isEnabled());
+}
+
+void RTPFECTest::testColumn()
+{
+    // One loss per column in the first matrix, a burst of L losses in the second one.
+    ts::RTPFECEncoder encoder;
+    CPPUNIT_ASSERT(encoder.setMatrix(5, 4, false, CERR));
+    std::set<uint16_t> lost {0, 6, 12, 18, 9, 25, 26, 27, 28, 29};
+    CPPUNIT_ASSERT_EQUAL(lost.size(), Transmit(encoder, 80, lost));
+
+    // Two losses in the same column cannot be recovered by column FEC only.
+    CPPUNIT_ASSERT(encoder.setMatrix(5, 4, false, CERR));
+    lost = {2, 7};
+    CPPUNIT_ASSERT_EQUAL(size_t(0), Transmit(encoder, 80, lost));
+
+    // Sequence numbers wrap around.
+    CPPUNIT_ASSERT(encoder.setMatrix(10, 10, false, CERR));
+    lost = {0xFFFF, 0, 1, 2};
+    CPPUNIT_ASSERT_EQUAL(lost.size(), Transmit(encoder, 400, lost, 0xFF00));
+}
+
+void RTPFECTest::testRow()
+{
+    // Two losses in the same column are recovered by row FEC.
+    ts::RTPFECEncoder encoder;
+    CPPUNIT_ASSERT(encoder.setMatrix(4, 4, true, CERR));
+    std::set<uint16_t> lost {2, 6};
+    CPPUNIT_ASSERT_EQUAL(lost.size(), Transmit(encoder, 64, lost));
+
+    // Losses at end of rows, the row FEC packet is received before the next media packet.
+    CPPUNIT_ASSERT(encoder.setMatrix(4, 4, true, CERR));
+    lost = {3, 7, 9};
+    CPPUNIT_ASSERT_EQUAL(lost.size(), Transmit(encoder, 64, lost));
+
+    // Cross pattern: the middle row is recovered after the column FEC packets
+    // of the other columns are received.
+    CPPUNIT_ASSERT(encoder.setMatrix(4, 4, true, CERR));
+    lost = {1, 4, 5, 6, 9};
+    CPPUNIT_ASSERT_EQUAL(lost.size(), Transmit(encoder, 64, lost));
+}
+
+void RTPFECTest::testLength()
+{
+    // Media packets of different sizes.
+    ts::RTPFECEncoder encoder;
+    CPPUNIT_ASSERT(encoder.setMatrix(4, 4, false, CERR));
+
+    ts::RTPFECDecoder decoder;
+    ts::ByteBlock payload;
+    ts::ByteBlock fec;
+    for (uint16_t seq = 0; seq < 32; ++seq) {
+        MediaPayload(payload, seq, ts::PKT_SIZE * (1 + seq % 7));
+        // Payload types and time stamps also vary.
+        encoder.addMedia(seq, uint8_t(96 + seq % 3), uint32_t(seq * 1000 + 7), payload.data(), payload.size());
+        if (seq != 5) {
+            decoder.addMedia(seq, uint8_t(96 + seq % 3), uint32_t(seq * 1000 + 7), payload.data(), payload.size());
+        }
+        while (encoder.getColumnFEC(fec)) {
+            CPPUNIT_ASSERT(decoder.addFEC(fec.data(), fec.size()));
+        }
+    }
+
+    uint16_t seq = 0;
+    uint8_t pt = 0;
+    uint32_t timestamp = 0;
+    const uint8_t* data = 0;
+    size_t size = 0;
+    CPPUNIT_ASSERT(decoder.getRecovered(seq, pt, timestamp, data, size));
+    CPPUNIT_ASSERT_EQUAL(uint16_t(5), seq);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(98), pt);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(5007), timestamp);
+    MediaPayload(payload, 5, ts::PKT_SIZE * 6);
+    CPPUNIT_ASSERT_EQUAL(payload.size(), size);
+    CPPUNIT_ASSERT(::memcmp(payload.data(), data, size) == 0);
+    CPPUNIT_ASSERT(!decoder.getRecovered(seq, pt, timestamp, data, size));
+
+    // Invalid FEC packets.
+    CPPUNIT_ASSERT(!decoder.addFEC(fec.data(), 10));
+    payload.resize(100);
+    CPPUNIT_ASSERT(!decoder.addFEC(payload.data(), payload.size()));
+}
+
+void RTPFECTest::testLoopback()
+{
+    // Media and FEC packets through UDP on the local host, with periodic losses.
+    const uint16_t portNumber = 12350;
+    const ts::SocketAddress mediaAddress(ts::IPAddress::LocalHost, portNumber);
+    const ts::SocketAddress fecAddress(ts::IPAddress::LocalHost, portNumber + ts::FEC_COLUMN_PORT_OFFSET);
+    const size_t rounds = 200;
+    const size_t roundCount = 10;
+    const size_t lossInterval = 97;
+    const size_t maxSize = 2048;
+
+    ts::UDPSocket mediaSock;
+    ts::UDPSocket fecSock;
+    ts::UDPSocket client;
+    CPPUNIT_ASSERT(mediaSock.open(CERR));
+    CPPUNIT_ASSERT(mediaSock.reusePort(true, CERR));
+    CPPUNIT_ASSERT(mediaSock.bind(mediaAddress, CERR));
+    CPPUNIT_ASSERT(fecSock.open(CERR));
+    CPPUNIT_ASSERT(fecSock.reusePort(true, CERR));
+    CPPUNIT_ASSERT(fecSock.bind(fecAddress, CERR));
+    CPPUNIT_ASSERT(client.open(CERR));
+
+    ts::RTPFECEncoder encoder;
+    ts::RTPFECDecoder decoder;
+    CPPUNIT_ASSERT(encoder.setMatrix(10, 10, false, CERR));
+
+    const size_t msgSize = ts::RTP_HEADER_SIZE + 7 * ts::PKT_SIZE;
+    ts::ByteBlock payload;
+    ts::ByteBlock message(msgSize);
+    ts::ByteBlock fec;
+    ts::ByteBlock buffer(roundCount * maxSize);
+    ts::UDPSocket::Message msgs[roundCount];
+    size_t sent = 0;
+    size_t lost = 0;
+    size_t received = 0;
+    uint16_t seq = 0;
+
+    utest::Chronometer chrono;
+    for (size_t r = 0; r < rounds; ++r) {
+        // Send one round of media packets, dropping some of them, and the FEC packets.
+        size_t roundSent = 0;
+        size_t fecSent = 0;
+        for (size_t i = 0; i < roundCount; ++i, ++seq) {
+            MediaPayload(payload, seq);
+            message[0] = 0x80;
+            message[1] = ts::RTP_PT_MP2T;
+            ts::PutUInt16(message.data() + 2, seq);
+            ts::PutUInt32(message.data() + 4, 0);
+            ts::PutUInt32(message.data() + 8, 0);
+            ::memcpy(message.data() + ts::RTP_HEADER_SIZE, payload.data(), payload.size());
+            encoder.addMedia(seq, ts::RTP_PT_MP2T, 0, payload.data(), payload.size());
+            sent++;
+            if (sent % lossInterval == 0) {
+                lost++;
+            }
+            else {
+                CPPUNIT_ASSERT(client.send(message.data(), message.size(), mediaAddress, CERR));
+                roundSent++;
+            }
+            while (encoder.getColumnFEC(fec)) {
+                CPPUNIT_ASSERT(client.send(fec.data(), fec.size(), fecAddress, CERR));
+                fecSent++;
+            }
+        }
+
+        // Receive the media packets, then the FEC packets.
+        for (size_t count = 0; count < roundSent; ) {
+            for (size_t i = 0; i < roundCount; ++i) {
+                msgs[i].data = buffer.data() + i * maxSize;
+                msgs[i].max_size = maxSize;
+            }
+            size_t n = 0;
+            CPPUNIT_ASSERT(mediaSock.receive(msgs, roundSent - count, n, 0, CERR));
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t* data = reinterpret_cast<const uint8_t*>(msgs[i].data);
+                CPPUNIT_ASSERT_EQUAL(msgSize, msgs[i].size);
+                decoder.addMedia(ts::GetUInt16(data + 2), data[1], ts::GetUInt32(data + 4), data + ts::RTP_HEADER_SIZE, msgs[i].size - ts::RTP_HEADER_SIZE);
+            }
+            count += n;
+            received += n;
+        }
+        for (size_t count = 0; count < fecSent; ) {
+            for (size_t i = 0; i < roundCount; ++i) {
+                msgs[i].data = buffer.data() + i * maxSize;
+                msgs[i].max_size = maxSize;
+            }
+            size_t n = 0;
+            CPPUNIT_ASSERT(fecSock.receive(msgs, fecSent - count, n, 0, CERR));
+            for (size_t i = 0; i < n; ++i) {
+                CPPUNIT_ASSERT(decoder.addFEC(msgs[i].data, msgs[i].size));
+            }
+            count += n;
+        }
+
+        // Nothing more to receive.
+        size_t n = 0;
+        CPPUNIT_ASSERT(fecSock.receiveAvailable(msgs, roundCount, n, CERR));
+        CPPUNIT_ASSERT_EQUAL(size_t(0), n);
+
+        // Check the recovered packets.
+        uint16_t rseq = 0;
+        uint8_t rpt = 0;
+        uint32_t rtime = 0;
+        const uint8_t* rdata = 0;
+        size_t rsize = 0;
+        while (decoder.getRecovered(rseq, rpt, rtime, rdata, rsize)) {
+            CPPUNIT_ASSERT_EQUAL(ts::RTP_PT_MP2T, rpt);
+            MediaPayload(payload, rseq);
+            CPPUNIT_ASSERT_EQUAL(payload.size(), rsize);
+            CPPUNIT_ASSERT(::memcmp(payload.data(), rdata, rsize) == 0);
+        }
+    }
+    const int64_t bitrate = chrono.perSecond(sent * msgSize * 8);
+
+    // The losses in the last matrix and a half are not yet protected by received FEC packets.
+    CPPUNIT_ASSERT_EQUAL(sent - lost, received);
+    CPPUNIT_ASSERT(decoder.recoveredCount() + 2 >= lost);
+    CPPUNIT_ASSERT(decoder.recoveredCount() <= lost);
+
+    utest::Out() << "RTPFECTest: " << sent << " packets, " << lost << " lost, " << decoder.recoveredCount() << " recovered, "
+                 << (bitrate / 1000000) << " Mb/s" << std::endl;
+}
@@ -0,0 +1,251 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::RTPReorderBuffer
+//
+//----------------------------------------------------------------------------
+
+#include "tsRTPReorderBuffer.h"
+#include "tsNullReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class RTPReorderBufferTest: public CppUnit::TestFixture, private ts::RTPReorderHandlerInterface
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testInOrder();
+    void testReorder();
+    void testDuplicate();
+    void testLoss();
+    void testWrap();
+    void testNoReorder();
+    void testResync();
+
+    CPPUNIT_TEST_SUITE(RTPReorderBufferTest);
+    CPPUNIT_TEST(testInOrder);
+    CPPUNIT_TEST(testReorder);
+    CPPUNIT_TEST(testDuplicate);
+    CPPUNIT_TEST(testLoss);
+    CPPUNIT_TEST(testWrap);
+    CPPUNIT_TEST(testNoReorder);
+    CPPUNIT_TEST(testResync);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    // Sequence numbers of the delivered payloads, in delivery order.
+    std::vector<uint16_t> _delivered;
+
+    // Implementation of RTPReorderHandlerInterface. Check that the payload matches the sequence number.
+    virtual void handleRTPPayload(ts::RTPReorderBuffer& buffer, uint16_t seq, const uint8_t* payload, size_t size) override;
+
+    // Add messages with the specified sequence numbers. The payload is the sequence number.
+    static void Add(ts::RTPReorderBuffer& buffer, const uint16_t* seqs, size_t count, uint32_t ssrc = 1);
+
+    // Check the delivered sequence numbers.
+    void checkDelivered(const uint16_t* seqs, size_t count);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RTPReorderBufferTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void RTPReorderBufferTest::setUp()
+{
+    _delivered.clear();
+}
+
+// Test suite cleanup method.
+void RTPReorderBufferTest::tearDown()
+{
+}
+
+void RTPReorderBufferTest::handleRTPPayload(ts::RTPReorderBuffer& buffer, uint16_t seq, const uint8_t* payload, size_t size)
+{
+    CPPUNIT_ASSERT_EQUAL(size_t(2), size);
+    CPPUNIT_ASSERT_EQUAL(seq, uint16_t((payload[0] << 8) | payload[1]));
+    _delivered.push_back(seq);
+}
+
+void RTPReorderBufferTest::Add(ts::RTPReorderBuffer& buffer, const uint16_t* seqs, size_t count, uint32_t ssrc)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t payload[2] = {uint8_t(seqs[i] >> 8), uint8_t(seqs[i])};
+        buffer.add(seqs[i], ssrc, payload, sizeof(payload), NULLREP);
+    }
+}
+
+void RTPReorderBufferTest::checkDelivered(const uint16_t* seqs, size_t count)
+{
+    CPPUNIT_ASSERT_EQUAL(count, _delivered.size());
+    for (size_t i = 0; i < count; ++i) {
+        CPPUNIT_ASSERT_EQUAL(seqs[i], _delivered[i]);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+void RTPReorderBufferTest::testInOrder()
+{
+    ts::RTPReorderBuffer buffer(this, 4);
+    const uint16_t seqs[] = {100, 101, 102, 103, 104};
+    Add(buffer, seqs, 5);
+    checkDelivered(seqs, 5);
+    CPPUNIT_ASSERT(buffer.isSynchronized());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(1), buffer.ssrc());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(5), buffer.receivedCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.reorderedCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.lateCount());
+}
+
+void RTPReorderBufferTest::testReorder()
+{
+    ts::RTPReorderBuffer buffer(this, 4);
+    const uint16_t seqs[] = {10, 12, 13, 11, 14, 16, 15};
+    Add(buffer, seqs, 3);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), buffer.heldCount());
+    Add(buffer, seqs + 3, 4);
+
+    const uint16_t expected[] = {10, 11, 12, 13, 14, 15, 16};
+    checkDelivered(expected, 7);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.heldCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(2), buffer.reorderedCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.lateCount());
+}
+
+void RTPReorderBufferTest::testDuplicate()
+{
+    ts::RTPReorderBuffer buffer(this, 4);
+    // 20 is delivered twice, 23 is held twice.
+    const uint16_t seqs[] = {20, 21, 20, 23, 23, 22};
+    Add(buffer, seqs, 6);
+
+    const uint16_t expected[] = {20, 21, 22, 23};
+    checkDelivered(expected, 4);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1), buffer.reorderedCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(2), buffer.lateCount());
+}
+
+void RTPReorderBufferTest::testLoss()
+{
+    ts::RTPReorderBuffer buffer(this, 3);
+    // 31 is lost: declared lost when 35 arrives (more than 3 messages after it).
+    // Then it arrives late and is dropped.
+    const uint16_t seqs[] = {30, 32, 33, 34, 35, 31, 36};
+    Add(buffer, seqs, 4);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.heldCount());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), _delivered.size());
+    Add(buffer, seqs + 4, 3);
+
+    const uint16_t expected[] = {30, 32, 33, 34, 35, 36};
+    checkDelivered(expected, 6);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.reorderedCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1), buffer.lateCount());
+
+    // A gap larger than the depth, without held message.
+    const uint16_t gap[] = {50};
+    Add(buffer, gap, 1);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1 + 10), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), buffer.heldCount());
+
+    // Flush the held message, the missing ones are lost.
+    buffer.flush();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.heldCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1 + 13), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(uint16_t(50), _delivered.back());
+}
+
+void RTPReorderBufferTest::testWrap()
+{
+    ts::RTPReorderBuffer buffer(this, 8);
+    const uint16_t seqs[] = {65533, 65535, 1, 0, 65534, 2, 4, 3};
+    Add(buffer, seqs, 8);
+
+    const uint16_t expected[] = {65533, 65534, 65535, 0, 1, 2, 3, 4};
+    checkDelivered(expected, 8);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), buffer.heldCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(2), buffer.reorderedCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.lateCount());
+}
+
+void RTPReorderBufferTest::testNoReorder()
+{
+    // Without reordering, all messages are delivered in reception order, anomalies are counted.
+    ts::RTPReorderBuffer buffer(this, 0);
+    const uint16_t seqs[] = {65534, 65535, 2, 1, 3, 3};
+    Add(buffer, seqs, 6);
+    checkDelivered(seqs, 6);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(2), buffer.lostCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.reorderedCount());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(2), buffer.lateCount());
+}
+
+void RTPReorderBufferTest::testResync()
+{
+    ts::RTPReorderBuffer buffer(this, 4);
+
+    // A very large gap is a restart, the held messages are flushed first.
+    const uint16_t seqs1[] = {1000, 1002, 30000, 30001};
+    Add(buffer, seqs1, 4);
+    const uint16_t expected1[] = {1000, 1002, 30000, 30001};
+    checkDelivered(expected1, 4);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1), buffer.lostCount());
+
+    // A new synchronization source restarts the sequence.
+    _delivered.clear();
+    const uint16_t seqs2[] = {5, 6};
+    Add(buffer, seqs2, 2, 2);
+    checkDelivered(seqs2, 2);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(2), buffer.ssrc());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(1), buffer.lostCount());
+
+    // Reset.
+    buffer.reset();
+    CPPUNIT_ASSERT(!buffer.isSynchronized());
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(0), buffer.receivedCount());
+}
@@ -32,9 +32,15 @@
 //----------------------------------------------------------------------------
 
 #include "tsResidentBuffer.h"
+#include "tsSysUtils.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_LINUX)
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
 
 //----------------------------------------------------------------------------
 // The test fixture
@@ -47,9 +53,11 @@ public:
     virtual void tearDown() override;
 
     void testResidentBuffer();
+    void testNUMANode();
 
     CPPUNIT_TEST_SUITE(ResidentBufferTest);
     CPPUNIT_TEST(testResidentBuffer);
+    CPPUNIT_TEST(testNUMANode);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -87,3 +95,34 @@ void ResidentBufferTest::testResidentBuffer()
     CPPUNIT_ASSERT(buf.isLocked());
     CPPUNIT_ASSERT(buf.count() >= buf_size);
 }
+
+void ResidentBufferTest::testNUMANode()
+{
+#if defined(TS_LINUX)
+    // The node of the current CPU, as tsp --numa-buffer does for the input plugin.
+    const int cpu = ::sched_getcpu();
+    CPPUNIT_ASSERT(cpu >= 0);
+    const int node = ts::NUMANodeOfCPU(size_t(cpu));
+    utest::Out() << "ResidentBufferTest: CPU " << cpu << ", NUMA node " << node << std::endl;
+    if (node < 0) {
+        return; // no NUMA support in this system
+    }
+
+    const size_t buf_size = 16 * ts::MemoryPageSize();
+    ts::ResidentBuffer<uint8_t> buf(buf_size, node);
+    const ts::ErrorCode err = buf.numaErrorCode();
+    utest::Out() << "ResidentBufferTest: NUMA placement: " << ts::ErrorCodeMessage(err) << std::endl;
+    if (err == ENOSYS || err == EPERM) {
+        return; // mbind() not allowed, typically in a container
+    }
+    CPPUNIT_ASSERT_EQUAL(ts::SYS_SUCCESS, err);
+
+    // Populate the pages and check the node of each of them.
+    ::memset(buf.base(), 0xA5, buf.count());
+    for (size_t offset = 0; offset < buf.count(); offset += ts::MemoryPageSize()) {
+        int page_node = -1;
+        CPPUNIT_ASSERT(::syscall(SYS_get_mempolicy, &page_node, 0, 0, buf.base() + offset, MPOL_F_NODE | MPOL_F_ADDR) == 0);
+        CPPUNIT_ASSERT_EQUAL(node, page_node);
+    }
+#endif
+}
@@ -34,7 +34,8 @@
 #include "tsScrambling.h"
 #include "tsTSPacket.h"
 #include "tsNames.h"
-#include "utestCppUnitTest.h"
+#include "tsByteBlock.h"
+#include "utestBenchmark.h"
 TSDUCK_SOURCE;
 
 
@@ -49,10 +50,19 @@ public:
     virtual void tearDown() override;
 
     void testScrambling();
+    void testBatch();
+    void testBenchmark();
 
     CPPUNIT_TEST_SUITE(ScramblingTest);
     CPPUNIT_TEST(testScrambling);
+    CPPUNIT_TEST(testBatch);
+    CPPUNIT_TEST(testBenchmark);
     CPPUNIT_TEST_SUITE_END();
+
+private:
+    static const ts::Scrambling::Engine _engines[];
+    static const char* const _names[];
+    static const size_t _engineCount;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ScramblingTest);
@@ -72,6 +82,18 @@ void ScramblingTest::tearDown()
 {
 }
 
+// All batch engines.
+const ts::Scrambling::Engine ScramblingTest::_engines[] = {
+    ts::Scrambling::SCALAR,
+    ts::Scrambling::BITSLICE64,
+    ts::Scrambling::BITSLICE128,
+    ts::Scrambling::BITSLICE256,
+    ts::Scrambling::DEFAULT,
+};
+const char* const ScramblingTest::_names[] = {"scalar", "bitslice64", "bitslice128", "bitslice256", "default"};
+const size_t ScramblingTest::_engineCount = sizeof(_engines) / sizeof(_engines[0]);
+
+
 
 //----------------------------------------------------------------------------
 // Unitary tests.
@@ -211,3 +233,90 @@ void ScramblingTest::testScrambling()
         CPPUNIT_ASSERT(::memcmp(pkt.b + header_size, vec->cipher.b + header_size, payload_size) == 0);
     }
 }
+
+void ScramblingTest::testBatch()
+{
+    // Data blocks of all sizes from 0 to 184 bytes, more than 256 to use several chunks in all engines.
+    const size_t blockCount = 300;
+    ts::ByteBlock cw;
+    ts::ByteBlock plain;
+    utest::Random(27).fill(cw, ts::Scrambling::KEY_SIZE);
+    utest::Random(1).fill(plain, blockCount * ts::PKT_SIZE);
+
+    std::vector<ts::Scrambling::DataBlock> blocks(blockCount);
+    for (size_t i = 0; i < blockCount; ++i) {
+        blocks[i].size = i % 185;
+    }
+
+    ts::Scrambling scrambler;
+    scrambler.init(cw.data(), ts::Scrambling::REDUCE_ENTROPY);
+
+    // Reference: one data block at a time.
+    ts::ByteBlock ref(plain);
+    for (size_t i = 0; i < blockCount; ++i) {
+        scrambler.encrypt(ref.data() + i * ts::PKT_SIZE, blocks[i].size);
+    }
+
+    for (size_t e = 0; e < _engineCount; ++e) {
+        if (!ts::Scrambling::IsAvailable(_engines[e])) {
+            utest::Out() << "ScramblingTest: " << _names[e] << " not available" << std::endl;
+            continue;
+        }
+        for (size_t count = 1; count <= blockCount; count = count < 8 ? count + 1 : count * 3) {
+            ts::ByteBlock data(plain);
+            for (size_t i = 0; i < blockCount; ++i) {
+                blocks[i].data = data.data() + i * ts::PKT_SIZE;
+            }
+            scrambler.encrypt(&blocks[0], count, _engines[e]);
+            CPPUNIT_ASSERT(::memcmp(data.data(), ref.data(), count * ts::PKT_SIZE) == 0);
+            CPPUNIT_ASSERT(::memcmp(data.data() + count * ts::PKT_SIZE, plain.data() + count * ts::PKT_SIZE, (blockCount - count) * ts::PKT_SIZE) == 0);
+            scrambler.decrypt(&blocks[0], count, _engines[e]);
+            CPPUNIT_ASSERT(data == plain);
+        }
+    }
+}
+
+void ScramblingTest::testBenchmark()
+{
+    if (!utest::BenchmarkMode()) {
+        return;
+    }
+
+    // Throughput on full TS packets payloads, 184 bytes.
+    const size_t packetCount = 1024;
+    const size_t iterations = 20;
+
+    ts::ByteBlock cw;
+    ts::ByteBlock data;
+    utest::Random(5).fill(cw, ts::Scrambling::KEY_SIZE);
+    utest::Random(7).fill(data, packetCount * ts::PKT_SIZE);
+    const ts::ByteBlock plain(data);
+
+    ts::Scrambling scrambler;
+    scrambler.init(cw.data(), ts::Scrambling::REDUCE_ENTROPY);
+
+    std::vector<ts::Scrambling::DataBlock> blocks(packetCount);
+    for (size_t i = 0; i < packetCount; ++i) {
+        blocks[i].data = data.data() + i * ts::PKT_SIZE + 4;
+        blocks[i].size = ts::PKT_SIZE - 4;
+    }
+
+    for (size_t e = 0; e < _engineCount; ++e) {
+        if (!ts::Scrambling::IsAvailable(_engines[e])) {
+            continue;
+        }
+        utest::Chronometer chrono;
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            scrambler.encrypt(&blocks[0], packetCount, _engines[e]);
+        }
+        const int64_t encrypt = chrono.perSecond(iterations * packetCount);
+        chrono.restart();
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            scrambler.decrypt(&blocks[0], packetCount, _engines[e]);
+        }
+        const int64_t decrypt = chrono.perSecond(iterations * packetCount);
+        CPPUNIT_ASSERT(data == plain);
+        utest::Out() << "ScramblingTest: " << _names[e] << ": encrypt: " << encrypt
+                     << " packets/s, decrypt: " << decrypt << " packets/s" << std::endl;
+    }
+}
@@ -0,0 +1,221 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for class ts::SharedMemoryRing
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedMemoryRing.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class SharedMemoryRingTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testTransfer();
+    void testReaderClosed();
+    void testLateReader();
+
+    CPPUNIT_TEST_SUITE(SharedMemoryRingTest);
+    CPPUNIT_TEST(testTransfer);
+    CPPUNIT_TEST(testReaderClosed);
+    CPPUNIT_TEST(testLateReader);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedMemoryRingTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void SharedMemoryRingTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void SharedMemoryRingTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+// The writer and the reader are in the same process here, the ring is
+// used exactly as between two processes.
+
+void SharedMemoryRingTest::testTransfer()
+{
+#if !defined(TS_WINDOWS)
+    ts::SharedMemoryRing writer;
+    ts::SharedMemoryRing reader;
+
+    CPPUNIT_ASSERT(writer.create(ts::UString(), 10, CERR));
+    CPPUNIT_ASSERT(writer.isOpen());
+    CPPUNIT_ASSERT(writer.name().startWith(u"/"));
+    CPPUNIT_ASSERT(reader.attach(writer.name(), CERR));
+
+    // Write 7 packets with a counter in the payload.
+    ts::TSPacket* warea = 0;
+    CPPUNIT_ASSERT_EQUAL(size_t(10), writer.getWriteArea(warea, CERR));
+    for (size_t i = 0; i < 7; ++i) {
+        warea[i] = ts::NullPacket;
+        warea[i].b[4] = uint8_t(i);
+    }
+    writer.commitWrite(7);
+
+    const ts::TSPacket* rarea = 0;
+    CPPUNIT_ASSERT_EQUAL(size_t(7), reader.getReadArea(rarea, CERR));
+    for (size_t i = 0; i < 7; ++i) {
+        CPPUNIT_ASSERT_EQUAL(uint8_t(i), rarea[i].b[4]);
+    }
+    reader.commitRead(7);
+
+    // The free area wraps at the end of the ring.
+    CPPUNIT_ASSERT_EQUAL(size_t(3), writer.getWriteArea(warea, CERR));
+    for (size_t i = 0; i < 3; ++i) {
+        warea[i] = ts::NullPacket;
+        warea[i].b[4] = uint8_t(7 + i);
+    }
+    writer.commitWrite(3);
+    CPPUNIT_ASSERT_EQUAL(size_t(7), writer.getWriteArea(warea, CERR));
+    warea[0] = ts::NullPacket;
+    warea[0].b[4] = 10;
+    writer.commitWrite(1);
+
+    // End of stream after the remaining packets.
+    CPPUNIT_ASSERT(writer.close(CERR));
+    CPPUNIT_ASSERT(!writer.isOpen());
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3), reader.getReadArea(rarea, CERR));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(7), rarea[0].b[4]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(9), rarea[2].b[4]);
+    reader.commitRead(3);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), reader.getReadArea(rarea, CERR));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(10), rarea[0].b[4]);
+    reader.commitRead(1);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), reader.getReadArea(rarea, CERR));
+    CPPUNIT_ASSERT(reader.close(CERR));
+
+    // The name of the shared memory was removed when the reader attached.
+    ts::SharedMemoryRing other;
+    CPPUNIT_ASSERT(!other.attach(writer.name(), NULLREP));
+#endif
+}
+
+void SharedMemoryRingTest::testReaderClosed()
+{
+#if !defined(TS_WINDOWS)
+    ts::SharedMemoryRing writer;
+    ts::SharedMemoryRing reader;
+
+    CPPUNIT_ASSERT(writer.create(ts::UString(), 4, CERR));
+    CPPUNIT_ASSERT(reader.attach(writer.name(), CERR));
+
+    // Only one reader is allowed.
+    ts::SharedMemoryRing other;
+    CPPUNIT_ASSERT(!other.attach(writer.name(), NULLREP));
+
+    ts::TSPacket* warea = 0;
+    CPPUNIT_ASSERT_EQUAL(size_t(4), writer.getWriteArea(warea, CERR));
+    writer.commitWrite(4);
+
+    // The writer does not block when the reader is gone.
+    CPPUNIT_ASSERT(reader.close(CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), writer.getWriteArea(warea, NULLREP));
+    CPPUNIT_ASSERT(writer.close(CERR));
+#endif
+}
+
+// The writer closes the ring before the reader process attaches. This is
+// what happens with a short stream in "tsp -P fork --shared-memory".
+
+void SharedMemoryRingTest::testLateReader()
+{
+#if !defined(TS_WINDOWS)
+    ts::SharedMemoryRing writer;
+    CPPUNIT_ASSERT(writer.create(ts::UString(), 10, CERR));
+
+    const ::pid_t pid = ::fork();
+    CPPUNIT_ASSERT(pid >= 0);
+    if (pid == 0) {
+        // Child process: attach late, read all packets, return the number of packets.
+        ::usleep(300000);
+        ts::SharedMemoryRing reader;
+        int count = 0;
+        if (reader.attach(writer.name(), CERR)) {
+            const ts::TSPacket* area = 0;
+            size_t size = 0;
+            while ((size = reader.getReadArea(area, CERR)) > 0) {
+                for (size_t i = 0; i < size; ++i) {
+                    if (area[i].b[4] == count) {
+                        count++;
+                    }
+                }
+                reader.commitRead(size);
+            }
+            reader.close(CERR);
+        }
+        ::_exit(count);
+    }
+
+    // Parent process: write 5 packets and close immediately.
+    ts::TSPacket* warea = 0;
+    CPPUNIT_ASSERT_EQUAL(size_t(10), writer.getWriteArea(warea, CERR));
+    for (size_t i = 0; i < 5; ++i) {
+        warea[i] = ts::NullPacket;
+        warea[i].b[4] = uint8_t(i);
+    }
+    writer.commitWrite(5);
+    CPPUNIT_ASSERT(writer.close(CERR));
+
+    int status = 0;
+    CPPUNIT_ASSERT_EQUAL(pid, ::waitpid(pid, &status, 0));
+    CPPUNIT_ASSERT(WIFEXITED(status));
+    CPPUNIT_ASSERT_EQUAL(5, WEXITSTATUS(status));
+
+    // The name of the shared memory was removed.
+    ts::SharedMemoryRing other;
+    CPPUNIT_ASSERT(!other.attach(writer.name(), NULLREP));
+#endif
+}
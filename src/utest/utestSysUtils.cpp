@@ -69,6 +69,7 @@ public:
     void testWildcard();
     void testHomeDirectory();
     void testProcessMetrics();
+    void testThreadCPUTime();
     void testMemory();
 
     CPPUNIT_TEST_SUITE(SysUtilsTest);
@@ -89,6 +90,7 @@ public:
     CPPUNIT_TEST(testWildcard);
     CPPUNIT_TEST(testHomeDirectory);
     CPPUNIT_TEST(testProcessMetrics);
+    CPPUNIT_TEST(testThreadCPUTime);
     CPPUNIT_TEST(testMemory);
     CPPUNIT_TEST_SUITE_END();
 private:
@@ -637,6 +639,23 @@ void SysUtilsTest::testProcessMetrics()
     CPPUNIT_ASSERT(pm2.vmem_size > 0);
 }
 
+void SysUtilsTest::testThreadCPUTime()
+{
+    const ts::NanoSecond t1 = ts::GetThreadCPUTime();
+    utest::Out() << "ThreadCPUTimeTest: CPU time (1) = " << t1 << " ns" << std::endl;
+    CPPUNIT_ASSERT(t1 >= 0);
+
+    // Consume some milliseconds of CPU time
+    volatile uint64_t counter = 7;
+    for (uint64_t i = 0; i < 10000000L; ++i) {
+        counter = counter * counter;
+    }
+
+    const ts::NanoSecond t2 = ts::GetThreadCPUTime();
+    utest::Out() << "ThreadCPUTimeTest: CPU time (2) = " << t2 << " ns" << std::endl;
+    CPPUNIT_ASSERT(t2 > t1);
+}
+
 void SysUtilsTest::testMemory()
 {
     // We can't predict the memory page size, except that it must be a multiple of 256.
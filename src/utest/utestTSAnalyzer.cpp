@@ -0,0 +1,370 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  CppUnit test suite for class ts::TSAnalyzer
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSAnalyzerReport.h"
+#include "tsCyclingPacketizer.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsTDT.h"
+#include "tsServiceDescriptor.h"
+#include "tsISO639LanguageDescriptor.h"
+#include "utestBenchmark.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSAnalyzerTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testReport();
+    void testThroughput();
+
+    CPPUNIT_TEST_SUITE(TSAnalyzerTest);
+    CPPUNIT_TEST(testReport);
+    CPPUNIT_TEST(testThroughput);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    // Bitrate of the test stream, as defined by the PCR's.
+    static const ts::BitRate BITRATE = 10000000;
+
+    // Build a TS packet with an optional PCR and a payload which starts with some data.
+    static void BuildPacket(ts::TSPacket& pkt, ts::PID pid, uint8_t& cc, bool pusi, bool has_pcr, uint64_t pcr, const ts::ByteBlock& data);
+
+    // Build a PES header with PTS and DTS (if non zero).
+    static void BuildPESHeader(ts::ByteBlock& pes, uint8_t stream_id, uint64_t pts, uint64_t dts);
+
+    // Build a fixed stream with two services, PSI/SI, some errors and unreferenced PID's.
+    static void BuildStream(ts::TSPacketVector& packets, size_t count);
+
+    // Get the normalized analysis report of a stream, without the system time.
+    static std::string Analyze(const ts::TSPacketVector& packets);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSAnalyzerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TSAnalyzerTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void TSAnalyzerTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Stream generation.
+//----------------------------------------------------------------------------
+
+void TSAnalyzerTest::BuildPacket(ts::TSPacket& pkt, ts::PID pid, uint8_t& cc, bool pusi, bool has_pcr, uint64_t pcr, const ts::ByteBlock& data)
+{
+    uint8_t* const b = pkt.b;
+    b[0] = ts::SYNC_BYTE;
+    ts::PutUInt16(b + 1, (pusi ? 0x4000 : 0x0000) | pid);
+    b[3] = 0x10 | cc;
+    cc = (cc + 1) & ts::CC_MASK;
+
+    size_t header = 4;
+    if (has_pcr) {
+        b[3] |= 0x20;
+        b[4] = 7;
+        b[5] = 0x10;
+        ts::PutUInt32(b + 6, uint32_t((pcr / ts::SYSTEM_CLOCK_SUBFACTOR) >> 1));
+        ts::PutUInt16(b + 10, uint16_t(((pcr / ts::SYSTEM_CLOCK_SUBFACTOR) & 1) << 15) | 0x7E00 | uint16_t(pcr % ts::SYSTEM_CLOCK_SUBFACTOR));
+        header += 8;
+    }
+
+    // The rest of the payload is a pattern without start code.
+    const size_t size = std::min(data.size(), ts::PKT_SIZE - header);
+    ::memcpy(b + header, data.data(), size);
+    ::memset(b + header + size, 0xAA, ts::PKT_SIZE - header - size);
+}
+
+void TSAnalyzerTest::BuildPESHeader(ts::ByteBlock& pes, uint8_t stream_id, uint64_t pts, uint64_t dts)
+{
+    pes.resize(dts == 0 ? 14 : 19);
+    uint8_t* const b = pes.data();
+    ts::PutUInt24(b, 0x000001);
+    b[3] = stream_id;
+    ts::PutUInt16(b + 4, 0);
+    b[6] = 0x80;
+    b[7] = dts == 0 ? 0x80 : 0xC0;
+    b[8] = dts == 0 ? 5 : 10;
+    b[9] = uint8_t((dts == 0 ? 0x21 : 0x31) | ((pts >> 29) & 0x0E));
+    ts::PutUInt16(b + 10, uint16_t(((pts >> 14) & 0xFFFE) | 0x0001));
+    ts::PutUInt16(b + 12, uint16_t(((pts << 1) & 0xFFFE) | 0x0001));
+    if (dts != 0) {
+        b[14] = uint8_t(0x11 | ((dts >> 29) & 0x0E));
+        ts::PutUInt16(b + 15, uint16_t(((dts >> 14) & 0xFFFE) | 0x0001));
+        ts::PutUInt16(b + 17, uint16_t(((dts << 1) & 0xFFFE) | 0x0001));
+    }
+}
+
+void TSAnalyzerTest::BuildStream(ts::TSPacketVector& packets, size_t count)
+{
+    // Service 1: MPEG-2 video and audio. Service 2: AVC video and a scrambled private stream.
+    ts::PAT pat(1, true, 100);
+    pat.pmts[1] = 0x0100;
+    pat.pmts[2] = 0x0200;
+
+    ts::PMT pmt1(2, true, 1, 0x0101);
+    pmt1.streams[0x0101].stream_type = ts::ST_MPEG2_VIDEO;
+    pmt1.streams[0x0102].stream_type = ts::ST_MPEG2_AUDIO;
+    pmt1.streams[0x0102].descs.add(ts::ISO639LanguageDescriptor(u"fre", 0));
+
+    ts::PMT pmt2(3, true, 2, 0x0201);
+    pmt2.streams[0x0201].stream_type = ts::ST_AVC_VIDEO;
+    pmt2.streams[0x0202].stream_type = ts::ST_PES_PRIV;
+
+    ts::SDT sdt(true, 4, true, 100, 200);
+    sdt.services[1].descs.add(ts::ServiceDescriptor(0x01, u"Provider", u"Service One"));
+    sdt.services[2].descs.add(ts::ServiceDescriptor(0x19, u"Provider", u"Service Two"));
+    sdt.services[2].CA_controlled = true;
+
+    ts::CyclingPacketizer psi[4];
+    psi[0].setPID(ts::PID_PAT);
+    psi[0].addTable(pat);
+    psi[1].setPID(0x0100);
+    psi[1].addTable(pmt1);
+    psi[2].setPID(0x0200);
+    psi[2].addTable(pmt2);
+    psi[3].setPID(ts::PID_SDT);
+    psi[3].addTable(sdt);
+    ts::CyclingPacketizer tdt(ts::PID_TDT);
+    tdt.addTable(ts::TDT(ts::Time(2020, 6, 1, 12, 30, 0)));
+
+    // MPEG-2 sequence header, 720x576, 4:3, 25 fps, 6 Mb/s.
+    static const uint8_t seq_header[] = {0x00, 0x00, 0x01, 0xB3, 0x2D, 0x02, 0x40, 0x23, 0x3A, 0x98, 0x23, 0x80};
+    // MPEG-1 layer II audio frame header, 192 kb/s, 48 kHz, stereo.
+    static const uint8_t audio_header[] = {0xFF, 0xFD, 0x94, 0x04};
+    // AVC access unit delimiter.
+    static const uint8_t avc_header[] = {0x00, 0x00, 0x00, 0x01, 0x09, 0xF0};
+
+    uint8_t cc_vid = 0, cc_aud = 0, cc_avc = 0, cc_priv = 0, cc_unref = 0, cc_null = 0;
+    size_t n_vid = 0, n_aud = 0, n_avc = 0, n_psi = 0;
+    uint64_t pts = 900000;
+    ts::ByteBlock data;
+
+    packets.resize(count);
+    for (size_t n = 0; n < count; ++n) {
+        ts::TSPacket& pkt(packets[n]);
+        const uint64_t pcr = (uint64_t(n) * ts::PKT_SIZE * 8 * ts::SYSTEM_CLOCK_FREQ) / BITRATE;
+        const size_t slot = n % 20;
+        data.clear();
+
+        if (n % 5000 == 5) {
+            tdt.getNextPacket(pkt);
+        }
+        else if (slot == 0) {
+            psi[n_psi++ % 4].getNextPacket(pkt);
+        }
+        else if (slot <= 8) {
+            // MPEG-2 video, one PES packet every 12 TS packets, PCR every 10 TS packets.
+            const bool pusi = n_vid % 12 == 0;
+            if (pusi) {
+                pts += 3600;
+                BuildPESHeader(data, 0xE0, pts + 7200, pts);
+                if (n_vid % 48 == 0) {
+                    data.append(seq_header, sizeof(seq_header));
+                }
+            }
+            if (n == 12345) {
+                // Duplicated packet: same continuity counter.
+                pkt = packets[n - 1];
+            }
+            else {
+                BuildPacket(pkt, 0x0101, cc_vid, pusi, n_vid % 10 == 0, pcr, data);
+            }
+            n_vid++;
+        }
+        else if (slot <= 10) {
+            // MPEG audio, one PES packet every 4 TS packets, one discontinuity.
+            const bool pusi = n_aud % 4 == 0;
+            if (pusi) {
+                BuildPESHeader(data, 0xC0, pts, 0);
+                data.append(audio_header, sizeof(audio_header));
+            }
+            if (n == 20009) {
+                cc_aud = (cc_aud + 3) & ts::CC_MASK;
+            }
+            BuildPacket(pkt, 0x0102, cc_aud, pusi, false, 0, data);
+            n_aud++;
+        }
+        else if (slot <= 14) {
+            // AVC video, PCR every 8 TS packets, one invalid PES start code.
+            const bool pusi = n_avc % 8 == 0;
+            if (pusi) {
+                BuildPESHeader(data, 0xE0, pts, 0);
+                data.append(avc_header, sizeof(avc_header));
+                if (n_avc == 800) {
+                    data[2] = 0x02;
+                }
+            }
+            BuildPacket(pkt, 0x0201, cc_avc, pusi, n_avc % 8 == 0, pcr, data);
+            n_avc++;
+        }
+        else if (slot == 15) {
+            // Scrambled private stream.
+            BuildPacket(pkt, 0x0202, cc_priv, false, false, 0, data);
+            pkt.setScrambling(n % 40 < 20 ? ts::SC_EVEN_KEY : ts::SC_ODD_KEY);
+        }
+        else if (slot == 16) {
+            // Unreferenced PID.
+            BuildPacket(pkt, 0x0300, cc_unref, false, false, 0, data);
+        }
+        else {
+            // Null packets, one with a transport error.
+            BuildPacket(pkt, ts::PID_NULL, cc_null, false, false, 0, data);
+            if (n == 30017) {
+                pkt.setTEI();
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the normalized analysis report of a stream, without the system time.
+//----------------------------------------------------------------------------
+
+std::string TSAnalyzerTest::Analyze(const ts::TSPacketVector& packets)
+{
+    ts::TSAnalyzerReport analyzer;
+    for (ts::TSPacketVector::const_iterator it = packets.begin(); it != packets.end(); ++it) {
+        analyzer.feedPacket(*it);
+    }
+
+    std::stringstream report;
+    analyzer.reportNormalized(report);
+    analyzer.reportErrors(report);
+
+    std::string result;
+    std::string line;
+    while (std::getline(report, line)) {
+        if (line.find(":system:") == std::string::npos) {
+            result += line;
+            result += '\n';
+        }
+    }
+    return result;
+}
+
+
+//----------------------------------------------------------------------------
+// Test cases
+//----------------------------------------------------------------------------
+
+// Reference report, built with the original TSAnalyzer, where each PID context
+// was searched in a map and each packet was passed to all demux.
+static const char* const referenceReport =
+    "title:\n"
+    "ts:id=100:services=2:clearservices=1:scrambledservices=1:pids=11:clearpids=10:scrambledpids=1:pcrpids=2:unreferencedpids=1:packets=40000:invalidsyncs=0:transporterrors=1:suspectignored=0:bytes=7520000:bitrate=9999998:bitrate204=10851061:userbitrate=0:userbitrate204=0:pcrbitrate=9999998:pcrbitrate204=10851062:duration=6:\n"
+    "time:utc:tdt:first:date=01/06/2020:time=12h30m00s:secondsince2000=644329800:\n"
+    "time:utc:tdt:last:date=01/06/2020:time=12h30m00s:secondsince2000=644329800:\n"
+    "global:pids=4:clearpids=4:scrambledpids=0:packets=7007:bitrate=1751749:bitrate204=1900834:access=clear:pidlist=0,17,20,8191:\n"
+    "unreferenced:pids=1:clearpids=1:scrambledpids=0:packets=2000:bitrate=499999:bitrate204=542552:access=clear:pidlist=768:\n"
+    "service:id=1:tsid=100:orignetwid=200:access=clear:pids=3:clearpids=3:scrambledpids=0:packets=20492:bitrate=5122998:bitrate204=5558997:servtype=1:pmtpid=256:pcrpid=257:pidlist=256,257,258:provider=Provider:name=Service One\n"
+    "service:id=2:tsid=100:orignetwid=200:access=scrambled:pids=3:clearpids=2:scrambledpids=1:packets=10500:bitrate=2624999:bitrate204=2848403:servtype=25:pmtpid=512:pcrpid=513:pidlist=512,513,514:provider=Provider:name=Service Two\n"
+    "pid:pid=0:access=clear:servcount=0:global:bitrate=124999:bitrate204=135637:packets=500:clear=500:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:unitstart=500:description=PAT\n"
+    "pid:pid=17:access=clear:servcount=0:global:bitrate=124999:bitrate204=135637:packets=500:clear=500:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:unitstart=500:description=SDT/BAT\n"
+    "pid:pid=20:access=clear:servcount=0:global:bitrate=1999:bitrate204=2169:packets=8:clear=8:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:unitstart=8:description=TDT/TOT\n"
+    "pid:pid=256:pmt:access=clear:servcount=1:servlist=1:bitrate=124999:bitrate204=135637:packets=500:clear=500:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:unitstart=500:description=PMT\n"
+    "pid:pid=257:access=clear:streamid=224:video:servcount=1:servlist=1:bitrate=3997999:bitrate204=4338254:packets=15992:clear=15992:scrambled=0:invalidscrambling=0:af=1600:pcr=1600:discontinuities=0:duplicated=1:pes=1333:invalidpesprefix=0:description=MPEG-2 Video\n"
+    "pid:pid=258:access=clear:streamid=192:audio:language=fre:servcount=1:servlist=1:bitrate=999999:bitrate204=1085105:packets=4000:clear=4000:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=1:duplicated=0:pes=1000:invalidpesprefix=0:description=MPEG-2 Audio (fre, Audio layer II, 160 kb/s, @48,000 Hz, stereo)\n"
+    "pid:pid=512:pmt:access=clear:servcount=1:servlist=2:bitrate=124999:bitrate204=135637:packets=500:clear=500:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:unitstart=500:description=PMT\n"
+    "pid:pid=513:access=clear:streamid=224:video:servcount=1:servlist=2:bitrate=1999999:bitrate204=2170211:packets=8000:clear=8000:scrambled=0:invalidscrambling=0:af=1000:pcr=1000:discontinuities=0:duplicated=0:pes=1000:invalidpesprefix=1:description=AVC video\n"
+    "pid:pid=514:access=scrambled:cryptoperiod=0:servcount=1:servlist=2:bitrate=499999:bitrate204=542552:packets=2000:clear=0:scrambled=2000:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:pes=0:invalidpesprefix=0:description=MPEG-2 PES private data\n"
+    "pid:pid=768:access=clear:servcount=0:unreferenced:bitrate=499999:bitrate204=542552:packets=2000:clear=2000:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:unitstart=0:description=Unreferenced\n"
+    "pid:pid=8191:access=clear:servcount=0:global:bitrate=1499749:bitrate204=1627387:packets=5999:clear=5999:scrambled=0:invalidscrambling=0:af=0:pcr=0:discontinuities=0:duplicated=0:unitstart=0:description=Stuffing\n"
+    "table:pid=0:tid=0:tidext=100:tables=500:sections=500:repetitionpkt=80:minrepetitionpkt=80:maxrepetitionpkt=80:repetitionms=12:minrepetitionms=12:maxrepetitionms=12:firstversion=1:lastversion=1:versions=1:\n"
+    "table:pid=17:tid=66:tidext=100:tables=500:sections=500:repetitionpkt=80:minrepetitionpkt=80:maxrepetitionpkt=80:repetitionms=12:minrepetitionms=12:maxrepetitionms=12:firstversion=4:lastversion=4:versions=4:\n"
+    "table:pid=20:tid=112:tables=8:sections=8:repetitionpkt=5000:minrepetitionpkt=5000:maxrepetitionpkt=5000:repetitionms=752:minrepetitionms=752:maxrepetitionms=752:\n"
+    "table:pid=256:tid=2:tidext=1:tables=500:sections=500:repetitionpkt=80:minrepetitionpkt=80:maxrepetitionpkt=80:repetitionms=12:minrepetitionms=12:maxrepetitionms=12:firstversion=2:lastversion=2:versions=2:\n"
+    "table:pid=512:tid=2:tidext=2:tables=500:sections=500:repetitionpkt=80:minrepetitionpkt=80:maxrepetitionpkt=80:repetitionms=12:minrepetitionms=12:maxrepetitionms=12:firstversion=3:lastversion=3:versions=3:\n"
+    "TITLE: ERROR ANALYSIS REPORT\n"
+    "INFO: Transport Stream Identifier: 100 (0x0064)\n"
+    "TS:100:0x0064: TS packets with transport error indicator: 1\n"
+    "TS:100:0x0064: Unreferenced PID's: 1\n"
+    "TS:100:0x0064: No CAT (1 scrambled PID's)\n"
+    "TS:100:0x0064: No BAT\n"
+    "TS:100:0x0064: No TOT\n"
+    "PID:257:0x0101: Duplicated TS packets: 1\n"
+    "PID:258:0x0102: Discontinuities (unexpected): 1\n"
+    "PID:513:0x0201: Invalid PES header start codes: 1\n"
+    "SUMMARY: Error count: 8\n";
+
+void TSAnalyzerTest::testReport()
+{
+    ts::TSPacketVector packets;
+    BuildStream(packets, 40000);
+    const std::string report(Analyze(packets));
+    utest::Out() << "TSAnalyzerTest::testReport:" << std::endl << report;
+    CPPUNIT_ASSERT_STRINGS_EQUAL(referenceReport, report);
+}
+
+void TSAnalyzerTest::testThroughput()
+{
+    if (!utest::BenchmarkMode()) {
+        return;
+    }
+
+    ts::TSPacketVector packets;
+    BuildStream(packets, 40000);
+
+    const size_t repeat = 50;
+    ts::TSAnalyzerReport analyzer;
+    utest::Chronometer chrono;
+    for (size_t i = 0; i < repeat; ++i) {
+        for (ts::TSPacketVector::const_iterator it = packets.begin(); it != packets.end(); ++it) {
+            analyzer.feedPacket(*it);
+        }
+    }
+    const ts::NanoSecond duration = chrono.elapsed();
+
+    const uint64_t total = uint64_t(repeat) * packets.size();
+    utest::Out() << "TSAnalyzerTest::testThroughput: " << total << " packets in " << (duration / ts::NanoSecPerMilliSec)
+                 << " ms, " << (total * ts::NanoSecPerSec / duration) << " packets/s" << std::endl;
+}
@@ -0,0 +1,570 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for TS file input and output classes.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileInput.h"
+#include "tsTSFileOutput.h"
+#include "tsTSFileOutputSegmented.h"
+#include "tsCyclingPacketizer.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSysUtils.h"
+#include "tsMonotonic.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "utestBenchmark.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSFileTest: public CppUnit::TestFixture
+{
+public:
+    TSFileTest();
+
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testReadPlain();
+    void testReadMapped();
+    void testReadAhead();
+    void testReadAheadPipe();
+    void testReadMappedTruncated();
+    void testWriteModes();
+    void testWriteLatency();
+    void testSegments();
+    void testSegmentsRetention();
+    void testSegmentsFallback();
+    void testSegmentsPreopen();
+
+    CPPUNIT_TEST_SUITE(TSFileTest);
+    CPPUNIT_TEST(testReadPlain);
+    CPPUNIT_TEST(testReadMapped);
+    CPPUNIT_TEST(testReadAhead);
+    CPPUNIT_TEST(testReadAheadPipe);
+    CPPUNIT_TEST(testReadMappedTruncated);
+    CPPUNIT_TEST(testWriteModes);
+    CPPUNIT_TEST(testWriteLatency);
+    CPPUNIT_TEST(testSegments);
+    CPPUNIT_TEST(testSegmentsRetention);
+    CPPUNIT_TEST(testSegmentsFallback);
+    CPPUNIT_TEST(testSegmentsPreopen);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    ts::UString _tempFileName;
+
+    // Number of packets in test file, larger than several read-ahead buffers.
+    static const uint32_t FILE_PACKETS = 3 * ts::TSFileInput::READ_AHEAD_PACKETS + 100;
+
+    // Create the test file, packet index in the first payload bytes.
+    void createFile();
+
+    // Check the content of the test file, as created by createFile(), possibly several times.
+    void checkFile(uint32_t repeat);
+
+    // Write the test file in a given mode.
+    void writeFile(size_t async_buffers, bool direct_io, uint64_t prealloc, bool append);
+
+    // Write at 200 Mb/s during one second, return the worst write latency.
+    ts::NanoSecond writeLatency(size_t async_buffers);
+
+    // Get the packet index in a packet of the test file.
+    static uint32_t index(const ts::TSPacket& pkt) { return ts::GetUInt32(pkt.b + 4); }
+
+    // Test reading the file in a given mode.
+    void testRead(ts::TSFileInput::ReadMode mode);
+
+    // Write the test file as segments, one PAT, one PMT and one video keyframe every 1000 packets,
+    // plus a keyframe on a non-video PID. Without PSI, the PAT and PMT are replaced by null packets.
+    // Return the number of segments.
+    size_t writeSegments(ts::TSFileOutputSegmented::SplitPoint split, uint64_t max_size, size_t max_files, size_t async_buffers, bool psi = true);
+
+    // Concatenate segments first..last and check that they contain the packets from the
+    // first segment index in sequence, without loss or duplication. Return the number of packets.
+    uint32_t checkSegments(size_t first, size_t last, ts::TSFileOutputSegmented::SplitPoint split);
+
+    // Delete all segments of the test file.
+    void deleteSegments();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TSFileTest);
+
+const uint32_t TSFileTest::FILE_PACKETS;
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSFileTest::TSFileTest() :
+    _tempFileName(ts::TempFile(u".ts"))
+{
+}
+
+// Test suite initialization method.
+void TSFileTest::setUp()
+{
+    ts::DeleteFile(_tempFileName);
+}
+
+// Test suite cleanup method.
+void TSFileTest::tearDown()
+{
+    ts::DeleteFile(_tempFileName);
+    deleteSegments();
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSFileTest::createFile()
+{
+    ts::TSFileOutput file;
+    CPPUNIT_ASSERT(file.open(_tempFileName, false, false, CERR));
+
+    ts::TSPacket pkt(ts::NullPacket);
+    for (uint32_t i = 0; i < FILE_PACKETS; ++i) {
+        ts::PutUInt32(pkt.b + 4, i);
+        CPPUNIT_ASSERT(file.write(&pkt, 1, CERR));
+    }
+    CPPUNIT_ASSERT(file.close(CERR));
+}
+
+void TSFileTest::checkFile(uint32_t repeat)
+{
+    ts::TSFileInput file;
+    CPPUNIT_ASSERT(file.open(_tempFileName, 1, 0, CERR));
+    ts::TSPacket buffer[1000];
+    uint32_t expected = 0;
+    size_t count = 0;
+    while ((count = file.read(buffer, 1000, CERR)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT_EQUAL(expected % FILE_PACKETS, index(buffer[i]));
+            expected++;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(repeat * FILE_PACKETS, expected);
+    CPPUNIT_ASSERT(file.close(CERR));
+}
+
+void TSFileTest::writeFile(size_t async_buffers, bool direct_io, uint64_t prealloc, bool append)
+{
+    ts::TSFileOutput file;
+    file.setAsynchronous(async_buffers);
+    file.setDirectIO(direct_io);
+    file.setPreallocation(prealloc);
+    file.setSyncInterval(direct_io ? 0 : 10);
+    CPPUNIT_ASSERT(file.open(_tempFileName, append, false, CERR));
+
+    // Write with odd block sizes.
+    ts::TSPacket buffer[333];
+    uint32_t next = 0;
+    while (next < FILE_PACKETS) {
+        const uint32_t count = std::min<uint32_t>(333, FILE_PACKETS - next);
+        for (uint32_t i = 0; i < count; ++i) {
+            buffer[i] = ts::NullPacket;
+            ts::PutUInt32(buffer[i].b + 4, next++);
+        }
+        CPPUNIT_ASSERT(file.write(buffer, count, CERR));
+    }
+    CPPUNIT_ASSERT(file.close(CERR));
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(FILE_PACKETS), file.getPacketCount());
+}
+
+void TSFileTest::testWriteModes()
+{
+    writeFile(0, false, 0, false);
+    checkFile(1);
+    writeFile(3, false, 0, false);
+    checkFile(1);
+    writeFile(0, false, 1000000, true);
+    checkFile(2);
+    writeFile(0, true, 0, false);
+    checkFile(1);
+    writeFile(4, true, 1000000, true);
+    checkFile(2);
+    CPPUNIT_ASSERT_EQUAL(int64_t(2 * FILE_PACKETS * ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+}
+
+ts::NanoSecond TSFileTest::writeLatency(size_t async_buffers)
+{
+    // 200 Mb/s with blocks of 128 packets.
+    const size_t block_packets = 128;
+    const ts::NanoSecond block_duration = (ts::NanoSecPerSec * block_packets * ts::PKT_SIZE * 8) / 200000000;
+    const size_t block_count = size_t(ts::NanoSecPerSec / block_duration);
+
+    ts::TSFileOutput file;
+    file.setAsynchronous(async_buffers);
+    file.setSyncInterval(50);
+    CPPUNIT_ASSERT(file.open(_tempFileName, false, false, CERR));
+
+    ts::TSPacket buffer[block_packets];
+    for (size_t i = 0; i < block_packets; ++i) {
+        buffer[i] = ts::NullPacket;
+    }
+
+    ts::NanoSecond worst = 0;
+    ts::Monotonic next;
+    next.getSystemTime();
+    for (size_t i = 0; i < block_count; ++i) {
+        utest::Chronometer chrono;
+        CPPUNIT_ASSERT(file.write(buffer, block_packets, CERR));
+        worst = std::max(worst, chrono.elapsed());
+        next += block_duration;
+        next.wait();
+    }
+    CPPUNIT_ASSERT(file.close(CERR));
+    CPPUNIT_ASSERT_EQUAL(int64_t(block_count * block_packets * ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+    return worst;
+}
+
+void TSFileTest::testWriteLatency()
+{
+    const ts::NanoSecond sync_latency = writeLatency(0);
+    const ts::NanoSecond async_latency = writeLatency(ts::TSFileOutput::DEFAULT_ASYNC_BUFFERS);
+    utest::Out() << "TSFileTest: worst write latency at 200 Mb/s with periodic sync: "
+                 << "synchronous: " << ts::UString::Decimal(sync_latency / 1000) << " us, "
+                 << "asynchronous: " << ts::UString::Decimal(async_latency / 1000) << " us" << std::endl;
+}
+
+void TSFileTest::testRead(ts::TSFileInput::ReadMode mode)
+{
+    createFile();
+
+    ts::TSFileInput file;
+    file.setReadMode(mode);
+    CPPUNIT_ASSERT_EQUAL(mode, file.getReadMode());
+
+    // Read twice, starting at packet 3, with odd block sizes, copy in user's buffer.
+    CPPUNIT_ASSERT(file.open(_tempFileName, 2, 3 * ts::PKT_SIZE, CERR));
+    CPPUNIT_ASSERT_EQUAL(mode, file.getReadMode());
+    ts::TSPacket buffer[1000];
+    uint32_t expected = 3;
+    size_t total = 0;
+    size_t count = 0;
+    while ((count = file.read(buffer, 997, CERR)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT_EQUAL(expected, index(buffer[i]));
+            expected = expected + 1 < FILE_PACKETS ? expected + 1 : 3;
+        }
+        total += count;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(2 * (FILE_PACKETS - 3)), total);
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(total), file.getPacketCount());
+    CPPUNIT_ASSERT(file.close(CERR));
+
+    // Read in place in rewindable mode, seek back in the middle of the file.
+    CPPUNIT_ASSERT(file.open(_tempFileName, 0, CERR));
+    const ts::TSPacket* pkt = 0;
+    expected = 0;
+    total = 0;
+    while ((count = file.readInPlace(pkt, 5000, CERR)) > 0) {
+        CPPUNIT_ASSERT(pkt != 0);
+        CPPUNIT_ASSERT(count <= 5000);
+        for (size_t i = 0; i < count; ++i) {
+            CPPUNIT_ASSERT_EQUAL(expected++, index(pkt[i]));
+        }
+        total += count;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(FILE_PACKETS), total);
+    CPPUNIT_ASSERT(file.seek(12345, CERR));
+    CPPUNIT_ASSERT(file.readInPlace(pkt, 1, CERR) == 1);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(12345), index(*pkt));
+    CPPUNIT_ASSERT(file.close(CERR));
+}
+
+void TSFileTest::testReadPlain()
+{
+    testRead(ts::TSFileInput::READ_PLAIN);
+}
+
+void TSFileTest::testReadMapped()
+{
+    testRead(ts::TSFileInput::READ_MMAP);
+}
+
+void TSFileTest::testReadAhead()
+{
+    testRead(ts::TSFileInput::READ_AHEAD);
+}
+
+void TSFileTest::testReadAheadPipe()
+{
+#if defined(TS_UNIX)
+    // Keep a writer on the pipe, so that the reader does not get an end of file.
+    const ts::UString fifo(ts::TempFile(u".fifo"));
+    CPPUNIT_ASSERT(::mkfifo(fifo.toUTF8().c_str(), 0600) == 0);
+    const int fd = ::open(fifo.toUTF8().c_str(), O_RDWR);
+    CPPUNIT_ASSERT(fd >= 0);
+
+    ts::TSFileInput file;
+    file.setReadMode(ts::TSFileInput::READ_AHEAD);
+    CPPUNIT_ASSERT(file.open(fifo, 1, 0, CERR));
+
+    // The packets are returned when the input stalls, without waiting for a full buffer.
+    ts::TSPacket buffer[10];
+    for (uint32_t i = 0; i < 10; ++i) {
+        buffer[i] = ts::NullPacket;
+        ts::PutUInt32(buffer[i].b + 4, i);
+    }
+    CPPUNIT_ASSERT_EQUAL(ssize_t(sizeof(buffer)), ::write(fd, buffer, sizeof(buffer)));
+    const ts::TSPacket* pkt = 0;
+    CPPUNIT_ASSERT_EQUAL(size_t(10), file.readInPlace(pkt, 1000, CERR));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(9), index(pkt[9]));
+
+    // Closing the file does not wait for more input.
+    utest::Chronometer chrono;
+    CPPUNIT_ASSERT(file.close(CERR));
+    CPPUNIT_ASSERT(chrono.elapsed() < ts::NanoSecPerSec);
+
+    ::close(fd);
+    ts::DeleteFile(fifo);
+#endif
+}
+
+void TSFileTest::testReadMappedTruncated()
+{
+#if defined(TS_UNIX)
+    createFile();
+
+    ts::TSFileInput file;
+    file.setReadMode(ts::TSFileInput::READ_MMAP);
+    CPPUNIT_ASSERT(file.open(_tempFileName, 1, 0, CERR));
+    const ts::TSPacket* pkt = 0;
+    CPPUNIT_ASSERT_EQUAL(size_t(1000), file.readInPlace(pkt, 1000, CERR));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(999), index(pkt[999]));
+
+    // Truncate the file while it is mapped. The truncation is reported by the next
+    // read, which does not return packets from the truncated part of the window.
+    CPPUNIT_ASSERT(::truncate(_tempFileName.toUTF8().c_str(), 100 * ts::PKT_SIZE) == 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), file.readInPlace(pkt, 1000, NULLREP));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), file.readInPlace(pkt, 1000, NULLREP));
+    CPPUNIT_ASSERT(file.close(CERR));
+#endif
+}
+
+size_t TSFileTest::writeSegments(ts::TSFileOutputSegmented::SplitPoint split, uint64_t max_size, size_t max_files, size_t async_buffers, bool psi)
+{
+    // Service 1: video PID 0x0100, audio PID 0x0200.
+    ts::PAT pat(1, true, 100);
+    pat.pmts[1] = 0x0050;
+    ts::PMT pmt(1, true, 1, 0x0100);
+    pmt.streams[0x0100].stream_type = ts::ST_AVC_VIDEO;
+    pmt.streams[0x0200].stream_type = ts::ST_MPEG2_AUDIO;
+    ts::CyclingPacketizer pzpat(ts::PID_PAT);
+    pzpat.addTable(pat);
+    ts::CyclingPacketizer pzpmt(0x0050);
+    pzpmt.addTable(pmt);
+
+    ts::TSFileOutputSegmented file;
+    file.fileTemplate().setAsynchronous(async_buffers);
+    file.setMaxSize(max_size);
+    file.setMaxFiles(max_files);
+    file.setSplitPoint(split);
+    CPPUNIT_ASSERT(file.open(_tempFileName, CERR));
+
+    // The packet index is stored at the end of the packet, after a possible adaptation field.
+    ts::TSPacket buffer[333];
+    uint32_t next = 0;
+    while (next < FILE_PACKETS) {
+        const uint32_t count = std::min<uint32_t>(333, FILE_PACKETS - next);
+        for (uint32_t i = 0; i < count; ++i) {
+            buffer[i] = ts::NullPacket;
+            if (psi && next % 1000 == 0) {
+                pzpat.getNextPacket(buffer[i]);
+            }
+            else if (psi && next % 1000 == 1) {
+                pzpmt.getNextPacket(buffer[i]);
+            }
+            else if (next % 1000 == 250 || next % 1000 == 500) {
+                // Random access points on the audio PID (ignored) and the video PID.
+                buffer[i].setPID(next % 1000 == 250 ? 0x0200 : 0x0100);
+                buffer[i].setPUSI();
+                buffer[i].b[3] |= 0x20;  // adaptation field present
+                buffer[i].b[4] = 1;      // adaptation field length
+                buffer[i].b[5] = 0x40;   // random access indicator
+            }
+            // Overwrite the last stuffing bytes of the PSI packets.
+            ts::PutUInt32(buffer[i].b + ts::PKT_SIZE - 4, next++);
+        }
+        CPPUNIT_ASSERT(file.write(buffer, count, CERR));
+    }
+    CPPUNIT_ASSERT(file.close(CERR));
+    CPPUNIT_ASSERT_EQUAL(ts::PacketCounter(FILE_PACKETS), file.getPacketCount());
+    return file.getSegmentCount();
+}
+
+uint32_t TSFileTest::checkSegments(size_t first, size_t last, ts::TSFileOutputSegmented::SplitPoint split)
+{
+    ts::TSPacket buffer[1000];
+    uint32_t expected = 0;
+    uint32_t total = 0;
+    for (size_t seg = first; seg <= last; ++seg) {
+        const ts::UString name(ts::TSFileOutputSegmented::SegmentName(_tempFileName, seg));
+        CPPUNIT_ASSERT(ts::FileExists(name));
+        CPPUNIT_ASSERT(!ts::FileExists(name + ts::TSFileOutputSegmented::PART_SUFFIX));
+        ts::TSFileInput file;
+        CPPUNIT_ASSERT(file.open(name, 1, 0, CERR));
+        size_t count = 0;
+        bool start = true;
+        while ((count = file.read(buffer, 1000, CERR)) > 0) {
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t idx = ts::GetUInt32(buffer[i].b + ts::PKT_SIZE - 4);
+                if (start) {
+                    // Each segment starts at a split point.
+                    switch (split) {
+                        case ts::TSFileOutputSegmented::SPLIT_AT_PAT:
+                            CPPUNIT_ASSERT_EQUAL(uint32_t(0), idx % 1000);
+                            break;
+                        case ts::TSFileOutputSegmented::SPLIT_AT_KEYFRAME:
+                            CPPUNIT_ASSERT(idx == 0 || idx % 1000 == 500);
+                            break;
+                        case ts::TSFileOutputSegmented::SPLIT_ANYWHERE:
+                        default:
+                            break;
+                    }
+                    if (seg == first) {
+                        expected = idx;
+                    }
+                    start = false;
+                }
+                CPPUNIT_ASSERT_EQUAL(expected, idx);
+                expected++;
+                total++;
+            }
+        }
+        CPPUNIT_ASSERT(!start);
+        CPPUNIT_ASSERT(file.close(CERR));
+    }
+    CPPUNIT_ASSERT(!ts::FileExists(ts::TSFileOutputSegmented::SegmentName(_tempFileName, last + 1)));
+    CPPUNIT_ASSERT(!ts::FileExists(ts::TSFileOutputSegmented::SegmentName(_tempFileName, last + 1) + ts::TSFileOutputSegmented::PART_SUFFIX));
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS, expected);
+    return total;
+}
+
+void TSFileTest::deleteSegments()
+{
+    for (size_t seg = 0; ; ++seg) {
+        const ts::UString name(ts::TSFileOutputSegmented::SegmentName(_tempFileName, seg));
+        ts::DeleteFile(name + ts::TSFileOutputSegmented::PART_SUFFIX);
+        if (!ts::FileExists(name)) {
+            break;
+        }
+        ts::DeleteFile(name);
+    }
+}
+
+void TSFileTest::testSegments()
+{
+    // Split anywhere: exact segment size.
+    size_t count = writeSegments(ts::TSFileOutputSegmented::SPLIT_ANYWHERE, 1024 * ts::PKT_SIZE, 0, 0);
+    CPPUNIT_ASSERT_EQUAL(size_t((FILE_PACKETS + 1023) / 1024), count);
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS, checkSegments(0, count - 1, ts::TSFileOutputSegmented::SPLIT_ANYWHERE));
+    CPPUNIT_ASSERT_EQUAL(int64_t(1024 * ts::PKT_SIZE), ts::GetFileSize(ts::TSFileOutputSegmented::SegmentName(_tempFileName, 0)));
+    deleteSegments();
+
+    // Split at PAT, with asynchronous segments.
+    count = writeSegments(ts::TSFileOutputSegmented::SPLIT_AT_PAT, 2500 * ts::PKT_SIZE, 0, 4);
+    CPPUNIT_ASSERT_EQUAL(size_t((FILE_PACKETS + 2999) / 3000), count);
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS, checkSegments(0, count - 1, ts::TSFileOutputSegmented::SPLIT_AT_PAT));
+    deleteSegments();
+
+    // Split at keyframe of the video PID, not the audio PID. The maximum size is large
+    // enough to always find a keyframe before the split is forced.
+    count = writeSegments(ts::TSFileOutputSegmented::SPLIT_AT_KEYFRAME, 800 * ts::PKT_SIZE, 0, 0);
+    CPPUNIT_ASSERT_EQUAL(size_t((FILE_PACKETS + 499) / 1000), count);
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS, checkSegments(0, count - 1, ts::TSFileOutputSegmented::SPLIT_AT_KEYFRAME));
+    deleteSegments();
+}
+
+void TSFileTest::testSegmentsRetention()
+{
+    const size_t count = writeSegments(ts::TSFileOutputSegmented::SPLIT_ANYWHERE, 1000 * ts::PKT_SIZE, 3, 0);
+    CPPUNIT_ASSERT(count > 3);
+    for (size_t seg = 0; seg < count - 3; ++seg) {
+        CPPUNIT_ASSERT(!ts::FileExists(ts::TSFileOutputSegmented::SegmentName(_tempFileName, seg)));
+    }
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS - uint32_t(1000 * (count - 3)), checkSegments(count - 3, count - 1, ts::TSFileOutputSegmented::SPLIT_ANYWHERE));
+}
+
+void TSFileTest::testSegmentsFallback()
+{
+    // Keyframes exist but no PMT gives the video PID, no PAT: split at twice the maximum size.
+    size_t count = writeSegments(ts::TSFileOutputSegmented::SPLIT_AT_KEYFRAME, 1000 * ts::PKT_SIZE, 0, 0, false);
+    CPPUNIT_ASSERT_EQUAL(size_t((FILE_PACKETS + 1999) / 2000), count);
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS, checkSegments(0, count - 1, ts::TSFileOutputSegmented::SPLIT_ANYWHERE));
+    CPPUNIT_ASSERT_EQUAL(int64_t(2000 * ts::PKT_SIZE), ts::GetFileSize(ts::TSFileOutputSegmented::SegmentName(_tempFileName, 0)));
+    deleteSegments();
+
+    count = writeSegments(ts::TSFileOutputSegmented::SPLIT_AT_PAT, 1000 * ts::PKT_SIZE, 0, 0, false);
+    CPPUNIT_ASSERT_EQUAL(size_t((FILE_PACKETS + 1999) / 2000), count);
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS, checkSegments(0, count - 1, ts::TSFileOutputSegmented::SPLIT_ANYWHERE));
+    deleteSegments();
+
+    // PAT every 1000 packets, too far: split at twice the maximum size, or at the PAT if earlier.
+    count = writeSegments(ts::TSFileOutputSegmented::SPLIT_AT_PAT, 300 * ts::PKT_SIZE, 0, 0);
+    CPPUNIT_ASSERT(count > (FILE_PACKETS + 999) / 1000);
+    CPPUNIT_ASSERT_EQUAL(FILE_PACKETS, checkSegments(0, count - 1, ts::TSFileOutputSegmented::SPLIT_ANYWHERE));
+    CPPUNIT_ASSERT_EQUAL(int64_t(600 * ts::PKT_SIZE), ts::GetFileSize(ts::TSFileOutputSegmented::SegmentName(_tempFileName, 0)));
+    deleteSegments();
+}
+
+void TSFileTest::testSegmentsPreopen()
+{
+    ts::TSFileOutputSegmented file;
+    file.setMaxSize(1000 * ts::PKT_SIZE);
+    CPPUNIT_ASSERT(file.open(_tempFileName, CERR));
+    const ts::UString name0(ts::TSFileOutputSegmented::SegmentName(_tempFileName, 0));
+    const ts::UString name1(ts::TSFileOutputSegmented::SegmentName(_tempFileName, 1));
+    CPPUNIT_ASSERT(ts::FileExists(name0 + ts::TSFileOutputSegmented::PART_SUFFIX));
+
+    // The next segment is opened in advance, in the background.
+    for (int i = 0; i < 100 && !ts::FileExists(name1 + ts::TSFileOutputSegmented::PART_SUFFIX); ++i) {
+        ts::SleepThread(10);
+    }
+    CPPUNIT_ASSERT(ts::FileExists(name1 + ts::TSFileOutputSegmented::PART_SUFFIX));
+
+    // The unused segment is deleted on close.
+    CPPUNIT_ASSERT(file.close(CERR));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), file.getSegmentCount());
+    CPPUNIT_ASSERT(ts::FileExists(name0));
+    CPPUNIT_ASSERT(!ts::FileExists(name0 + ts::TSFileOutputSegmented::PART_SUFFIX));
+    CPPUNIT_ASSERT(!ts::FileExists(name1));
+    CPPUNIT_ASSERT(!ts::FileExists(name1 + ts::TSFileOutputSegmented::PART_SUFFIX));
+}
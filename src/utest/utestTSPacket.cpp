@@ -27,11 +27,12 @@
 //
 //----------------------------------------------------------------------------
 //
-//  CppUnit test suite for class ts::TSPacket
+//  CppUnit test suite for class ts::TSPacket and ts::TSPacketMetadata
 //
 //----------------------------------------------------------------------------
 
 #include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
 #include "tsMemoryUtils.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
@@ -48,9 +49,11 @@ public:
     virtual void tearDown() override;
 
     void testPacket();
+    void testMetadata();
 
     CPPUNIT_TEST_SUITE(TSPacketTest);
     CPPUNIT_TEST(testPacket);
+    CPPUNIT_TEST(testMetadata);
     CPPUNIT_TEST_SUITE_END();
 };
 
@@ -88,3 +91,50 @@ void TSPacketTest::testPacket()
 
     CPPUNIT_ASSERT_EQUAL(size_t(7 * ts::PKT_SIZE), sizeof(packets));
 }
+
+void TSPacketTest::testMetadata()
+{
+    ts::TSPacketMetadata mdata[3];
+    ts::TSPacketMetadata::Reset(mdata, 3);
+
+    CPPUNIT_ASSERT(!mdata[0].getDropped());
+    CPPUNIT_ASSERT(!mdata[0].getInputStuffing());
+    CPPUNIT_ASSERT(!mdata[0].hasInputTimeStamp());
+    CPPUNIT_ASSERT_EQUAL(ts::TSPacketMetadata::INVALID_TIMESTAMP, mdata[0].getInputTimeStamp());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0), mdata[0].getLabels());
+
+    mdata[1].setDropped(true);
+    CPPUNIT_ASSERT(mdata[1].getDropped());
+    CPPUNIT_ASSERT(!mdata[1].getInputStuffing());
+    mdata[1].setInputStuffing(true);
+    mdata[1].setDropped(false);
+    CPPUNIT_ASSERT(!mdata[1].getDropped());
+    CPPUNIT_ASSERT(mdata[1].getInputStuffing());
+    mdata[1].reset();
+    CPPUNIT_ASSERT(!mdata[1].getInputStuffing());
+
+    mdata[2].setLabel(0);
+    mdata[2].setLabel(ts::TSPacketMetadata::MAX_LABEL);
+    mdata[2].setLabel(ts::TSPacketMetadata::LABEL_COUNT); // out of range, ignored
+    CPPUNIT_ASSERT(mdata[2].hasLabel(0));
+    CPPUNIT_ASSERT(!mdata[2].hasLabel(1));
+    CPPUNIT_ASSERT(mdata[2].hasLabel(ts::TSPacketMetadata::MAX_LABEL));
+    CPPUNIT_ASSERT(!mdata[2].hasLabel(ts::TSPacketMetadata::LABEL_COUNT));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x80000001), mdata[2].getLabels());
+    mdata[2].clearLabel(0);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x80000000), mdata[2].getLabels());
+
+    // Time stamps are converted in PCR units.
+    mdata[0].setInputTimeStamp(1000, ts::SYSTEM_CLOCK_FREQ);
+    CPPUNIT_ASSERT(mdata[0].hasInputTimeStamp());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), mdata[0].getInputTimeStamp());
+    mdata[0].setInputTimeStamp(2000000000, ts::NanoSecPerSec);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2) * ts::SYSTEM_CLOCK_FREQ, mdata[0].getInputTimeStamp());
+    mdata[0].setInputTimeStamp(TS_UCONST64(3600000000001), ts::NanoSecPerSec);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3600) * ts::SYSTEM_CLOCK_FREQ, mdata[0].getInputTimeStamp());
+    mdata[0].clearInputTimeStamp();
+    CPPUNIT_ASSERT(!mdata[0].hasInputTimeStamp());
+
+    mdata[2].reset();
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0), mdata[2].getLabels());
+}
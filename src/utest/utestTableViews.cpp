@@ -0,0 +1,412 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2017, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  CppUnit test suite for the section views (tsTableViews.h)
+//
+//----------------------------------------------------------------------------
+
+#include "tsTableViews.h"
+#include "tsBinaryTable.h"
+#include "tsTables.h"
+#include "tsCerrReport.h"
+#include "utestCppUnitTest.h"
+TSDUCK_SOURCE;
+
+#include "tables/psi_all_sections.h"
+#include "tables/psi_bat_tvnum_sections.h"
+#include "tables/psi_nit_tntv23_sections.h"
+#include "tables/psi_pat_r4_sections.h"
+#include "tables/psi_pmt_planete_sections.h"
+#include "tables/psi_sdt_r3_sections.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TableViewsTest: public CppUnit::TestFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testPAT();
+    void testPMT();
+    void testSDT();
+    void testNIT();
+    void testEIT();
+    void testAllTables();
+    void testTruncated();
+    void testInvalid();
+
+    CPPUNIT_TEST_SUITE(TableViewsTest);
+    CPPUNIT_TEST(testPAT);
+    CPPUNIT_TEST(testPMT);
+    CPPUNIT_TEST(testSDT);
+    CPPUNIT_TEST(testNIT);
+    CPPUNIT_TEST(testEIT);
+    CPPUNIT_TEST(testAllTables);
+    CPPUNIT_TEST(testTruncated);
+    CPPUNIT_TEST(testInvalid);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    // Load the binary tables from section data.
+    static void loadTables(ts::BinaryTablePtrVector& tables, const uint8_t* data, size_t size);
+
+    // Check that views and deserialized tables have the same content.
+    static void checkDescriptors(const ts::DescriptorList& descs, const ts::DescriptorLoopView& view);
+    static void checkPAT(const ts::BinaryTable& table);
+    static void checkPMT(const ts::BinaryTable& table);
+    static void checkSDT(const ts::BinaryTable& table);
+    static void checkNIT(const ts::BinaryTable& table);
+    static void checkEIT(const ts::BinaryTable& table);
+    static size_t checkAll(const uint8_t* data, size_t size);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TableViewsTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TableViewsTest::setUp()
+{
+}
+
+// Test suite cleanup method.
+void TableViewsTest::tearDown()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Utilities.
+//----------------------------------------------------------------------------
+
+void TableViewsTest::loadTables(ts::BinaryTablePtrVector& tables, const uint8_t* data, size_t size)
+{
+    std::istringstream strm(std::string(reinterpret_cast<const char*>(data), size));
+    CPPUNIT_ASSERT(ts::BinaryTable::LoadFile(tables, strm, ts::CRC32::CHECK, CERR));
+    CPPUNIT_ASSERT(!tables.empty());
+}
+
+void TableViewsTest::checkDescriptors(const ts::DescriptorList& descs, const ts::DescriptorLoopView& view)
+{
+    size_t index = 0;
+    for (ts::DescriptorLoopView::const_iterator it = view.begin(); it != view.end(); ++it, ++index) {
+        CPPUNIT_ASSERT(index < descs.count());
+        CPPUNIT_ASSERT_EQUAL(descs[index]->tag(), it->tag());
+        CPPUNIT_ASSERT_EQUAL(descs[index]->size(), it->size());
+        CPPUNIT_ASSERT_EQUAL(0, ::memcmp(descs[index]->content(), it->data(), it->size()));
+    }
+    CPPUNIT_ASSERT_EQUAL(descs.count(), index);
+    CPPUNIT_ASSERT_EQUAL(descs.count() == 0, view.empty());
+}
+
+void TableViewsTest::checkPAT(const ts::BinaryTable& table)
+{
+    const ts::PAT pat(table);
+    CPPUNIT_ASSERT(pat.isValid());
+
+    ts::PAT::ServiceMap pmts;
+    ts::PID nit_pid = ts::PID_NULL;
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
+        const ts::PATView view(*table.sectionAt(si));
+        CPPUNIT_ASSERT(view.isValid());
+        CPPUNIT_ASSERT_EQUAL(pat.ts_id, view.tsId());
+        if (view.nitPID() != ts::PID_NULL) {
+            nit_pid = view.nitPID();
+        }
+        const ts::PATView::ProgramLoop programs(view.programs());
+        for (ts::PATView::ProgramLoop::const_iterator it = programs.begin(); it != programs.end(); ++it) {
+            if (it->serviceId() != 0) {
+                pmts[it->serviceId()] = it->pmtPID();
+                CPPUNIT_ASSERT_EQUAL(it->pmtPID(), view.pmtPID(it->serviceId()));
+            }
+        }
+    }
+    CPPUNIT_ASSERT(pmts == pat.pmts);
+    if (nit_pid != ts::PID_NULL) {
+        CPPUNIT_ASSERT_EQUAL(pat.nit_pid, nit_pid);
+    }
+}
+
+void TableViewsTest::checkPMT(const ts::BinaryTable& table)
+{
+    const ts::PMT pmt(table);
+    CPPUNIT_ASSERT(pmt.isValid());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), table.sectionCount());
+
+    const ts::PMTView view(*table.sectionAt(0));
+    CPPUNIT_ASSERT(view.isValid());
+    CPPUNIT_ASSERT_EQUAL(pmt.service_id, view.serviceId());
+    CPPUNIT_ASSERT_EQUAL(pmt.pcr_pid, view.pcrPID());
+    checkDescriptors(pmt.descs, view.descriptors());
+
+    size_t count = 0;
+    const ts::PMTView::StreamLoop streams(view.streams());
+    for (ts::PMTView::StreamLoop::const_iterator it = streams.begin(); it != streams.end(); ++it, ++count) {
+        const ts::PMT::StreamMap::const_iterator ref(pmt.streams.find(it->pid()));
+        CPPUNIT_ASSERT(ref != pmt.streams.end());
+        CPPUNIT_ASSERT_EQUAL(ref->second.stream_type, it->streamType());
+        checkDescriptors(ref->second.descs, it->descriptors());
+    }
+    CPPUNIT_ASSERT_EQUAL(pmt.streams.size(), count);
+}
+
+void TableViewsTest::checkSDT(const ts::BinaryTable& table)
+{
+    const ts::SDT sdt(table);
+    CPPUNIT_ASSERT(sdt.isValid());
+
+    size_t count = 0;
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
+        const ts::SDTView view(*table.sectionAt(si));
+        CPPUNIT_ASSERT(view.isValid());
+        CPPUNIT_ASSERT_EQUAL(sdt.isActual(), view.isActual());
+        CPPUNIT_ASSERT_EQUAL(sdt.ts_id, view.tsId());
+        CPPUNIT_ASSERT_EQUAL(sdt.onetw_id, view.originalNetworkId());
+        const ts::SDTView::ServiceLoop services(view.services());
+        for (ts::SDTView::ServiceLoop::const_iterator it = services.begin(); it != services.end(); ++it, ++count) {
+            const ts::SDT::ServiceMap::const_iterator ref(sdt.services.find(it->serviceId()));
+            CPPUNIT_ASSERT(ref != sdt.services.end());
+            CPPUNIT_ASSERT_EQUAL(ref->second.EITs_present, it->EITsPresent());
+            CPPUNIT_ASSERT_EQUAL(ref->second.EITpf_present, it->EITpfPresent());
+            CPPUNIT_ASSERT_EQUAL(ref->second.running_status, it->runningStatus());
+            CPPUNIT_ASSERT_EQUAL(ref->second.CA_controlled, it->CAControlled());
+            CPPUNIT_ASSERT_EQUAL(ref->second.serviceType(), it->serviceType());
+            CPPUNIT_ASSERT_USTRINGS_EQUAL(ref->second.serviceName(), it->serviceName());
+            CPPUNIT_ASSERT_USTRINGS_EQUAL(ref->second.providerName(), it->providerName());
+            checkDescriptors(ref->second.descs, it->descriptors());
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(sdt.services.size(), count);
+}
+
+void TableViewsTest::checkNIT(const ts::BinaryTable& table)
+{
+    // The NIT and BAT have the same layout, the BAT is used as a NIT with the same table id.
+    const ts::NIT nit(table);
+    const ts::BAT bat(table);
+    const ts::AbstractTransportListTable& ref(table.tableId() == ts::TID_BAT ? static_cast<const ts::AbstractTransportListTable&>(bat) : nit);
+    CPPUNIT_ASSERT(ref.isValid());
+
+    ts::DescriptorList descs;
+    ts::AbstractTransportListTable::TransportMap transports;
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
+        const ts::NITView view(*table.sectionAt(si));
+        CPPUNIT_ASSERT(view.isValid());
+        CPPUNIT_ASSERT_EQUAL(table.tableId(), view.tableId());
+        CPPUNIT_ASSERT_EQUAL(table.tableIdExtension(), view.networkId());
+        descs.add(view.descriptors().data(), view.descriptors().size());
+        const ts::NITView::TransportLoop loop(view.transports());
+        for (ts::NITView::TransportLoop::const_iterator it = loop.begin(); it != loop.end(); ++it) {
+            transports[ts::TransportStreamId(it->tsId(), it->originalNetworkId())].add(it->descriptors().data(), it->descriptors().size());
+        }
+    }
+    CPPUNIT_ASSERT(descs == ref.descs);
+    CPPUNIT_ASSERT(transports == ref.transports);
+}
+
+void TableViewsTest::checkEIT(const ts::BinaryTable& table)
+{
+    const ts::EIT eit(table);
+    CPPUNIT_ASSERT(eit.isValid());
+
+    size_t count = 0;
+    for (size_t si = 0; si < table.sectionCount(); ++si) {
+        const ts::EITView view(*table.sectionAt(si));
+        CPPUNIT_ASSERT(view.isValid());
+        CPPUNIT_ASSERT_EQUAL(eit.isActual(), view.isActual());
+        CPPUNIT_ASSERT_EQUAL(eit.isPresentFollowing(), view.isPresentFollowing());
+        CPPUNIT_ASSERT_EQUAL(eit.service_id, view.serviceId());
+        CPPUNIT_ASSERT_EQUAL(eit.ts_id, view.tsId());
+        CPPUNIT_ASSERT_EQUAL(eit.onetw_id, view.originalNetworkId());
+        CPPUNIT_ASSERT_EQUAL(eit.segment_last, view.segmentLastSectionNumber());
+        CPPUNIT_ASSERT_EQUAL(eit.last_table_id, view.lastTableId());
+        const ts::EITView::EventLoop events(view.events());
+        for (ts::EITView::EventLoop::const_iterator it = events.begin(); it != events.end(); ++it, ++count) {
+            const ts::EIT::EventMap::const_iterator ref(eit.events.find(it->eventId()));
+            CPPUNIT_ASSERT(ref != eit.events.end());
+            CPPUNIT_ASSERT(ref->second.start_time == it->startTime());
+            CPPUNIT_ASSERT_EQUAL(ref->second.duration, it->duration());
+            CPPUNIT_ASSERT_EQUAL(ref->second.running_status, it->runningStatus());
+            CPPUNIT_ASSERT_EQUAL(ref->second.CA_controlled, it->CAControlled());
+            checkDescriptors(ref->second.descs, it->descriptors());
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(eit.events.size(), count);
+}
+
+size_t TableViewsTest::checkAll(const uint8_t* data, size_t size)
+{
+    ts::BinaryTablePtrVector tables;
+    loadTables(tables, data, size);
+
+    size_t count = 0;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        const ts::BinaryTable& table(*tables[i]);
+        const ts::TID tid = table.tableId();
+        if (tid == ts::TID_PAT) {
+            checkPAT(table);
+        }
+        else if (tid == ts::TID_PMT) {
+            checkPMT(table);
+        }
+        else if (tid == ts::TID_SDT_ACT || tid == ts::TID_SDT_OTH) {
+            checkSDT(table);
+        }
+        else if (tid == ts::TID_NIT_ACT || tid == ts::TID_NIT_OTH || tid == ts::TID_BAT) {
+            checkNIT(table);
+        }
+        else if (tid >= ts::TID_EIT_MIN && tid <= ts::TID_EIT_MAX) {
+            checkEIT(table);
+        }
+        else {
+            continue;
+        }
+        count++;
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TableViewsTest::testPAT()
+{
+    CPPUNIT_ASSERT_EQUAL(size_t(1), checkAll(psi_pat_r4_sections, sizeof(psi_pat_r4_sections)));
+}
+
+void TableViewsTest::testPMT()
+{
+    CPPUNIT_ASSERT_EQUAL(size_t(1), checkAll(psi_pmt_planete_sections, sizeof(psi_pmt_planete_sections)));
+}
+
+void TableViewsTest::testSDT()
+{
+    CPPUNIT_ASSERT_EQUAL(size_t(1), checkAll(psi_sdt_r3_sections, sizeof(psi_sdt_r3_sections)));
+}
+
+void TableViewsTest::testNIT()
+{
+    CPPUNIT_ASSERT_EQUAL(size_t(1), checkAll(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections)));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), checkAll(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections)));
+}
+
+void TableViewsTest::testEIT()
+{
+    ts::BinaryTablePtrVector tables;
+    loadTables(tables, psi_all_sections, sizeof(psi_all_sections));
+
+    size_t count = 0;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        const ts::TID tid = tables[i]->tableId();
+        if (tid >= ts::TID_EIT_MIN && tid <= ts::TID_EIT_MAX) {
+            checkEIT(*tables[i]);
+            count++;
+        }
+    }
+    CPPUNIT_ASSERT(count > 0);
+}
+
+void TableViewsTest::testAllTables()
+{
+    // PAT, PMT, SDT, 2 NIT, BAT, 2 EIT.
+    CPPUNIT_ASSERT_EQUAL(size_t(8), checkAll(psi_all_sections, sizeof(psi_all_sections)));
+}
+
+void TableViewsTest::testTruncated()
+{
+    // PMT with a program info length and an ES info length which overflow the
+    // section and a last descriptor which overflows its loop.
+    static const uint8_t payload[] = {
+        0xE1, 0x00,                               // PCR PID 0x0100
+        0xF0, 0x04,                               // program_info_length = 4
+        0x09, 0x04, 0x05, 0x00,                   // CA descriptor, truncated
+        0x1B, 0xE1, 0x01, 0xF0, 0x03,             // stream type 0x1B, PID 0x0101, es_info_length = 3
+        0x52, 0x01, 0x07,                         // stream identifier descriptor
+        0x04, 0xE1, 0x02, 0xF0, 0x20,             // stream type 0x04, PID 0x0102, es_info_length = 32 (overflow)
+        0x0A, 0x04, 0x66, 0x72, 0x61, 0x00,       // language descriptor
+        0x52, 0x05, 0x01,                         // truncated descriptor
+    };
+    const ts::SectionPtr section(new ts::Section(ts::TID_PMT, false, 0x1234, 7, true, 0, 0, payload, sizeof(payload)));
+    CPPUNIT_ASSERT(section->isValid());
+    ts::BinaryTable table;
+    CPPUNIT_ASSERT(table.addSection(section));
+    CPPUNIT_ASSERT(table.isValid());
+    checkPMT(table);
+
+    const ts::PMTView view(*section);
+    CPPUNIT_ASSERT_EQUAL(uint16_t(0x1234), view.serviceId());
+    CPPUNIT_ASSERT_EQUAL(ts::PID(0x0100), view.pcrPID());
+    CPPUNIT_ASSERT(view.descriptors().empty());
+    const ts::PMTView::StreamLoop streams(view.streams());
+    ts::PMTView::StreamLoop::const_iterator it(streams.begin());
+    CPPUNIT_ASSERT(it != streams.end());
+    CPPUNIT_ASSERT_EQUAL(ts::PID(0x0101), it->pid());
+    CPPUNIT_ASSERT_EQUAL(size_t(8), it->size());
+    ++it;
+    CPPUNIT_ASSERT(it != streams.end());
+    CPPUNIT_ASSERT_EQUAL(ts::PID(0x0102), it->pid());
+    CPPUNIT_ASSERT_EQUAL(size_t(14), it->size());
+    const ts::DescriptorLoopView descs(it->descriptors());
+    CPPUNIT_ASSERT(descs.search(ts::DID_LANGUAGE) == descs.begin());
+    CPPUNIT_ASSERT(descs.search(ts::DID_STREAM_ID) == descs.end());
+    it++;
+    CPPUNIT_ASSERT(it == streams.end());
+}
+
+void TableViewsTest::testInvalid()
+{
+    // A PAT section is neither a valid PMT, SDT, NIT or EIT.
+    ts::BinaryTablePtrVector tables;
+    loadTables(tables, psi_pat_r4_sections, sizeof(psi_pat_r4_sections));
+    const ts::Section& section(*tables[0]->sectionAt(0));
+
+    CPPUNIT_ASSERT(ts::PATView(section).isValid());
+    CPPUNIT_ASSERT(!ts::PMTView(section).isValid());
+    CPPUNIT_ASSERT(ts::PMTView(section).streams().empty());
+    CPPUNIT_ASSERT(!ts::SDTView(section).isValid());
+    CPPUNIT_ASSERT(ts::SDTView(section).services().empty());
+    CPPUNIT_ASSERT(!ts::NITView(section).isValid());
+    CPPUNIT_ASSERT(ts::NITView(section).transports().empty());
+    CPPUNIT_ASSERT(!ts::EITView(section).isValid());
+    CPPUNIT_ASSERT(ts::EITView(section).events().empty());
+
+    // Default views are empty.
+    const ts::DescriptorLoopView descs;
+    CPPUNIT_ASSERT(descs.empty());
+    CPPUNIT_ASSERT(descs.search(ts::DID_CA) == descs.end());
+}
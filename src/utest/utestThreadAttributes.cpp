@@ -44,6 +44,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsThreadAttributes.h"
+#include "tsThread.h"
 #include "utestCppUnitTest.h"
 TSDUCK_SOURCE;
 
@@ -61,11 +62,17 @@ public:
     void testStackSize();
     void testDeleteWhenTerminated();
     void testPriority();
+    void testSchedulingPolicy();
+    void testAffinity();
+    void testAffinityPlacement();
 
     CPPUNIT_TEST_SUITE (ThreadAttributesTest);
     CPPUNIT_TEST (testStackSize);
     CPPUNIT_TEST (testDeleteWhenTerminated);
     CPPUNIT_TEST (testPriority);
+    CPPUNIT_TEST (testSchedulingPolicy);
+    CPPUNIT_TEST (testAffinity);
+    CPPUNIT_TEST (testAffinityPlacement);
     CPPUNIT_TEST_SUITE_END ();
 };
 
@@ -134,3 +141,96 @@ void ThreadAttributesTest::testPriority()
     attr.setPriority (ts::ThreadAttributes::GetNormalPriority());
     CPPUNIT_ASSERT(attr.getPriority() == ts::ThreadAttributes::GetNormalPriority());
 }
+
+void ThreadAttributesTest::testSchedulingPolicy()
+{
+    ts::ThreadAttributes attr;
+    CPPUNIT_ASSERT(attr.getSchedulingPolicy() == ts::ThreadAttributes::POLICY_DEFAULT); // default value
+    CPPUNIT_ASSERT(attr.getRealTimePriority() == 0); // default value
+    CPPUNIT_ASSERT(attr.setSchedulingPolicy(ts::ThreadAttributes::POLICY_FIFO).getSchedulingPolicy() == ts::ThreadAttributes::POLICY_FIFO);
+    CPPUNIT_ASSERT(attr.setSchedulingPolicy(ts::ThreadAttributes::POLICY_ROUND_ROBIN).getSchedulingPolicy() == ts::ThreadAttributes::POLICY_ROUND_ROBIN);
+    CPPUNIT_ASSERT(attr.setRealTimePriority(20).getRealTimePriority() == 20);
+}
+
+void ThreadAttributesTest::testAffinity()
+{
+    ts::ThreadAttributes attr;
+    CPPUNIT_ASSERT(attr.getAffinity().empty()); // default value
+
+    std::set<size_t> cpus;
+    cpus.insert(0);
+    cpus.insert(3);
+    attr.setAffinity(cpus);
+    CPPUNIT_ASSERT(attr.getAffinity() == cpus);
+
+    attr.setAffinity(std::set<size_t>());
+    CPPUNIT_ASSERT(attr.getAffinity().empty());
+}
+
+//
+// Test case: a thread which is started with a CPU affinity actually runs on that CPU.
+//
+namespace {
+    class AffinityThread: public ts::Thread
+    {
+    public:
+        explicit AffinityThread(const ts::ThreadAttributes& attributes) :
+            ts::Thread(attributes),
+            cpu(-1),
+            allowed()
+        {
+        }
+        virtual ~AffinityThread()
+        {
+            waitForTermination();
+        }
+        int cpu;                  // CPU on which the thread ran, -1 if unknown.
+        std::set<size_t> allowed; // CPU's on which the thread was allowed to run.
+    private:
+        virtual void main() override
+        {
+#if defined(TS_LINUX)
+            cpu = ::sched_getcpu();
+            ::cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            if (::pthread_getaffinity_np(::pthread_self(), sizeof(cpus), &cpus) == 0) {
+                for (size_t i = 0; i < CPU_SETSIZE; ++i) {
+                    if (CPU_ISSET(i, &cpus)) {
+                        allowed.insert(i);
+                    }
+                }
+            }
+#endif
+        }
+    };
+}
+
+void ThreadAttributesTest::testAffinityPlacement()
+{
+#if defined(TS_LINUX)
+    // Use the last CPU on which the process may run, the process may be restricted to a subset.
+    ::cpu_set_t process_cpus;
+    CPU_ZERO(&process_cpus);
+    CPPUNIT_ASSERT(::sched_getaffinity(0, sizeof(process_cpus), &process_cpus) == 0);
+    int target = -1;
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+        if (CPU_ISSET(i, &process_cpus)) {
+            target = i;
+        }
+    }
+    CPPUNIT_ASSERT(target >= 0);
+
+    std::set<size_t> cpus;
+    cpus.insert(size_t(target));
+
+    AffinityThread thread(ts::ThreadAttributes().setAffinity(cpus));
+    CPPUNIT_ASSERT(thread.start());
+    CPPUNIT_ASSERT(thread.waitForTermination());
+
+    utest::Out() << "ThreadAttributesTest: affinity CPU " << target << ", thread ran on CPU " << thread.cpu
+                 << ", allowed on " << thread.allowed.size() << " CPU's" << std::endl;
+
+    CPPUNIT_ASSERT(thread.allowed == cpus);
+    CPPUNIT_ASSERT_EQUAL(target, thread.cpu);
+#endif
+}